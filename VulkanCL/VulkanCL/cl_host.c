@@ -0,0 +1,473 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "cl_host.h"
+#include "host_parallel.h"
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // !WIN32_LEAN_AND_MEAN
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // !NOMINMAX
+
+#include <Windows.h>
+
+#else
+
+#include <ucontext.h>
+
+#endif // _WIN32
+
+struct ClHostWorkItem
+{
+    size_t localID[3];
+    size_t localLinearID;
+    bool finished;
+#ifdef _WIN32
+    LPVOID fiber;
+#else
+    ucontext_t context;
+    void* stack;
+#endif // _WIN32
+};
+
+struct ClHostLaunch
+{
+    struct ClHostNDRange range;
+    size_t numGroups[3];
+    size_t localLinearSize;
+    size_t firstGroup;
+    ClHostKernelEntry entry;
+    void* args;
+    uint32_t flags;
+};
+
+// The state of the workgroup that runs on a thread
+struct ClHostThreadState
+{
+    const struct ClHostLaunch* pLaunch;
+    size_t groupID[3];
+    struct ClHostWorkItem* pCurrent;
+    // The fibers of the work-items, with CL_HOST_KERNEL_USES_BARRIERS
+    struct ClHostWorkItem* items;
+#ifdef _WIN32
+    LPVOID schedulerFiber;
+#else
+    ucontext_t schedulerContext;
+#endif // _WIN32
+};
+
+static CL_HOST_THREAD_LOCAL struct ClHostThreadState* s_pThreadState;
+
+static void ClHostSetLocalID(const struct ClHostLaunch* pLaunch, struct ClHostWorkItem* pItem, size_t localLinearID)
+{
+    const size_t* localSize = pLaunch->range.localSize;
+    pItem->localLinearID = localLinearID;
+    pItem->localID[0] = localLinearID % localSize[0];
+    pItem->localID[1] = (localLinearID / localSize[0]) % localSize[1];
+    pItem->localID[2] = localLinearID / (localSize[0] * localSize[1]);
+}
+
+static void ClHostSetGroupID(struct ClHostThreadState* pState, size_t groupLinearID)
+{
+    const size_t* numGroups = pState->pLaunch->numGroups;
+    pState->groupID[0] = groupLinearID % numGroups[0];
+    pState->groupID[1] = (groupLinearID / numGroups[0]) % numGroups[1];
+    pState->groupID[2] = groupLinearID / (numGroups[0] * numGroups[1]);
+}
+
+// MARK: Fibers of the work-items
+
+#ifdef _WIN32
+
+static VOID CALLBACK ClHostFiberMain(LPVOID parameter)
+{
+    (void)parameter;
+    // Runs the kernel once per workgroup, and parks at the scheduler in between
+    while (true)
+    {
+        struct ClHostThreadState* pState = s_pThreadState;
+        pState->pLaunch->entry(pState->pLaunch->args);
+        pState->pCurrent->finished = true;
+        SwitchToFiber(pState->schedulerFiber);
+    }
+}
+
+static inline void ClHostSwitchToWorkItem(struct ClHostThreadState* pState, struct ClHostWorkItem* pItem)
+{
+    SwitchToFiber(pItem->fiber);
+    (void)pState;
+}
+
+static inline void ClHostSwitchToScheduler(struct ClHostThreadState* pState)
+{
+    SwitchToFiber(pState->schedulerFiber);
+}
+
+#else
+
+static void ClHostFiberMain(void)
+{
+    while (true)
+    {
+        struct ClHostThreadState* pState = s_pThreadState;
+        pState->pLaunch->entry(pState->pLaunch->args);
+        pState->pCurrent->finished = true;
+        swapcontext(&pState->pCurrent->context, &pState->schedulerContext);
+    }
+}
+
+static inline void ClHostSwitchToWorkItem(struct ClHostThreadState* pState, struct ClHostWorkItem* pItem)
+{
+    swapcontext(&pState->schedulerContext, &pItem->context);
+}
+
+static inline void ClHostSwitchToScheduler(struct ClHostThreadState* pState)
+{
+    swapcontext(&pState->pCurrent->context, &pState->schedulerContext);
+}
+
+#endif // _WIN32
+
+static void ClHostDestroyFibers(struct ClHostThreadState* pState, size_t itemCount, bool convertedThread)
+{
+    for (size_t i = 0; i < itemCount; i++)
+    {
+#ifdef _WIN32
+        if (pState->items[i].fiber != NULL) {
+            DeleteFiber(pState->items[i].fiber);
+        }
+#else
+        free(pState->items[i].stack);
+#endif // _WIN32
+    }
+#ifdef _WIN32
+    if (convertedThread) {
+        ConvertFiberToThread();
+    }
+#else
+    (void)convertedThread;
+#endif // _WIN32
+    free(pState->items);
+    pState->items = NULL;
+}
+
+// Out of the loop of ClHostCreateFibers, since getcontext returns twice and would leave the loop index clobbered
+static bool ClHostCreateFiber(struct ClHostWorkItem* pItem)
+{
+#ifdef _WIN32
+    pItem->fiber = CreateFiber(CL_HOST_FIBER_STACK_SIZE, ClHostFiberMain, NULL);
+    return pItem->fiber != NULL;
+#else
+    pItem->stack = malloc(CL_HOST_FIBER_STACK_SIZE);
+    if (pItem->stack == NULL || getcontext(&pItem->context) != 0) return false;
+
+    pItem->context.uc_stack.ss_sp = pItem->stack;
+    pItem->context.uc_stack.ss_size = CL_HOST_FIBER_STACK_SIZE;
+    pItem->context.uc_link = NULL;
+    makecontext(&pItem->context, ClHostFiberMain, 0);
+    return true;
+#endif // _WIN32
+}
+
+// Returns false if it is out of memory. `pConvertedThread` tells whether the thread has been converted to a fiber for the scheduler.
+static bool ClHostCreateFibers(struct ClHostThreadState* pState, size_t itemCount, bool* pConvertedThread)
+{
+    *pConvertedThread = false;
+    pState->items = calloc(itemCount, sizeof(*pState->items));
+    if (pState->items == NULL) return false;
+
+#ifdef _WIN32
+    if (IsThreadAFiber()) {
+        pState->schedulerFiber = GetCurrentFiber();
+    }
+    else
+    {
+        pState->schedulerFiber = ConvertThreadToFiber(NULL);
+        if (pState->schedulerFiber == NULL)
+        {
+            ClHostDestroyFibers(pState, 0, false);
+            return false;
+        }
+        *pConvertedThread = true;
+    }
+#endif // _WIN32
+
+    for (size_t i = 0; i < itemCount; i++)
+    {
+        if (!ClHostCreateFiber(&pState->items[i]))
+        {
+            ClHostDestroyFibers(pState, itemCount, *pConvertedThread);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Resumes the unfinished work-items round-robin. Each of them runs up to its next barrier or to its end,
+// so no work-item passes a barrier before all of the others have arrived at it.
+static void ClHostRunGroupOnFibers(struct ClHostThreadState* pState)
+{
+    const size_t itemCount = pState->pLaunch->localLinearSize;
+    for (size_t i = 0; i < itemCount; i++)
+    {
+        ClHostSetLocalID(pState->pLaunch, &pState->items[i], i);
+        pState->items[i].finished = false;
+    }
+
+    size_t remainingCount = itemCount;
+    while (remainingCount > 0)
+    {
+        for (size_t i = 0; i < itemCount; i++)
+        {
+            struct ClHostWorkItem* pItem = &pState->items[i];
+            if (pItem->finished) continue;
+
+            pState->pCurrent = pItem;
+            ClHostSwitchToWorkItem(pState, pItem);
+            if (pItem->finished) {
+                remainingCount--;
+            }
+        }
+    }
+    pState->pCurrent = NULL;
+}
+
+// MARK: NDRange
+
+static void ClHostGroupTask(void* context, size_t begin, size_t end)
+{
+    const struct ClHostLaunch* pLaunch = context;
+
+    // A kernel may enqueue another NDRange, which runs serially on this thread
+    struct ClHostThreadState* pOuterState = s_pThreadState;
+    struct ClHostThreadState state = { .pLaunch = pLaunch };
+    s_pThreadState = &state;
+
+    if ((pLaunch->flags & CL_HOST_KERNEL_USES_BARRIERS) != 0)
+    {
+        bool convertedThread = false;
+        if (!ClHostCreateFibers(&state, pLaunch->localLinearSize, &convertedThread))
+        {
+            fprintf(stderr, "Failed to create the fibers of %zu work-items!\n", pLaunch->localLinearSize);
+            abort();
+        }
+        for (size_t group = begin; group < end; group++)
+        {
+            ClHostSetGroupID(&state, pLaunch->firstGroup + group);
+            ClHostRunGroupOnFibers(&state);
+        }
+        ClHostDestroyFibers(&state, pLaunch->localLinearSize, convertedThread);
+    }
+    else
+    {
+        struct ClHostWorkItem item = { 0 };
+        state.pCurrent = &item;
+        for (size_t group = begin; group < end; group++)
+        {
+            ClHostSetGroupID(&state, pLaunch->firstGroup + group);
+            for (size_t i = 0; i < pLaunch->localLinearSize; i++)
+            {
+                ClHostSetLocalID(pLaunch, &item, i);
+                pLaunch->entry(pLaunch->args);
+            }
+        }
+    }
+
+    s_pThreadState = pOuterState;
+}
+
+bool ClHostEnqueueNDRange(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount, ClHostKernelEntry entry,
+    void* args, uint32_t flags)
+{
+    if (pRange == NULL || entry == NULL || pRange->workDim < 1 || pRange->workDim > 3) return false;
+
+    struct ClHostLaunch launch = {
+        .range = *pRange,
+        .localLinearSize = 1,
+        .firstGroup = firstGroup,
+        .entry = entry,
+        .args = args,
+        .flags = flags
+    };
+    size_t totalGroupCount = 1;
+    for (uint32_t dim = 0; dim < 3; dim++)
+    {
+        // The dimensions beyond workDim are 1, as get_global_size() and get_local_size() return for them
+        if (dim >= pRange->workDim)
+        {
+            launch.range.globalSize[dim] = 1;
+            launch.range.localSize[dim] = 1;
+        }
+        const size_t globalSize = launch.range.globalSize[dim];
+        const size_t localSize = launch.range.localSize[dim];
+        if (localSize == 0 || globalSize % localSize != 0) return false;
+
+        launch.numGroups[dim] = globalSize / localSize;
+        launch.localLinearSize *= localSize;
+        totalGroupCount *= launch.numGroups[dim];
+    }
+    if (launch.localLinearSize > CL_HOST_MAX_WORKGROUP_SIZE) return false;
+    if (firstGroup > totalGroupCount || groupCount > totalGroupCount - firstGroup) return false;
+    if (groupCount == 0) return true;
+
+    // Several batches per thread, so that a thread that gets ahead takes over the groups of a slower one
+    size_t minBatchSize = groupCount / ((size_t)HostParallelGetThreadCount() * 4);
+    if (minBatchSize == 0) {
+        minBatchSize = 1;
+    }
+    HostParallelFor(groupCount, minBatchSize, ClHostGroupTask, &launch);
+    return true;
+}
+
+// MARK: Work-item functions
+
+uint32_t ClHostGetWorkDim(void)
+{
+    return s_pThreadState->pLaunch->range.workDim;
+}
+
+size_t ClHostGetGlobalID(uint32_t dim)
+{
+    if (dim >= 3) return 0;
+    const struct ClHostThreadState* pState = s_pThreadState;
+    return pState->groupID[dim] * pState->pLaunch->range.localSize[dim] + pState->pCurrent->localID[dim];
+}
+
+size_t ClHostGetLocalID(uint32_t dim)
+{
+    return dim < 3 ? s_pThreadState->pCurrent->localID[dim] : 0;
+}
+
+size_t ClHostGetGroupID(uint32_t dim)
+{
+    return dim < 3 ? s_pThreadState->groupID[dim] : 0;
+}
+
+size_t ClHostGetGlobalSize(uint32_t dim)
+{
+    return dim < 3 ? s_pThreadState->pLaunch->range.globalSize[dim] : 1;
+}
+
+size_t ClHostGetLocalSize(uint32_t dim)
+{
+    return dim < 3 ? s_pThreadState->pLaunch->range.localSize[dim] : 1;
+}
+
+size_t ClHostGetNumGroups(uint32_t dim)
+{
+    return dim < 3 ? s_pThreadState->pLaunch->numGroups[dim] : 1;
+}
+
+size_t ClHostGetLocalLinearID(void)
+{
+    return s_pThreadState->pCurrent->localLinearID;
+}
+
+size_t ClHostGetLocalLinearSize(void)
+{
+    return s_pThreadState->pLaunch->localLinearSize;
+}
+
+void ClHostBarrier(void)
+{
+    struct ClHostThreadState* pState = s_pThreadState;
+    if (pState->items == NULL)
+    {
+        // A single work-item per workgroup synchronizes with nothing
+        if (pState->pLaunch->localLinearSize == 1) return;
+
+        fprintf(stderr, "barrier() is called by a kernel enqueued without CL_HOST_KERNEL_USES_BARRIERS!\n");
+        abort();
+    }
+    ClHostSwitchToScheduler(pState);
+}
+
+// MARK: Atomic functions
+
+uint32_t ClHostAtomicAdd(volatile uint32_t* p, uint32_t value)
+{
+    return HostAtomicFetchAddUInt32(p, value);
+}
+
+uint32_t ClHostAtomicXchg(volatile uint32_t* p, uint32_t value)
+{
+    return HostAtomicExchangeUInt32(p, value);
+}
+
+uint32_t ClHostAtomicCmpXchg(volatile uint32_t* p, uint32_t comparand, uint32_t value)
+{
+    return HostAtomicCompareExchangeUInt32(p, comparand, value);
+}
+
+uint32_t ClHostAtomicAnd(volatile uint32_t* p, uint32_t value)
+{
+    return HostAtomicFetchAndUInt32(p, value);
+}
+
+uint32_t ClHostAtomicOr(volatile uint32_t* p, uint32_t value)
+{
+    return HostAtomicFetchOrUInt32(p, value);
+}
+
+uint32_t ClHostAtomicXor(volatile uint32_t* p, uint32_t value)
+{
+    return HostAtomicFetchXorUInt32(p, value);
+}
+
+// The minimum and the maximum are compare-exchange loops that stop as soon as the stored value needs no update
+
+uint32_t ClHostAtomicMinU(volatile uint32_t* p, uint32_t value)
+{
+    uint32_t old = *p;
+    while (value < old)
+    {
+        const uint32_t current = ClHostAtomicCmpXchg(p, old, value);
+        if (current == old) break;
+        old = current;
+    }
+    return old;
+}
+
+uint32_t ClHostAtomicMaxU(volatile uint32_t* p, uint32_t value)
+{
+    uint32_t old = *p;
+    while (value > old)
+    {
+        const uint32_t current = ClHostAtomicCmpXchg(p, old, value);
+        if (current == old) break;
+        old = current;
+    }
+    return old;
+}
+
+int32_t ClHostAtomicMinI(volatile int32_t* p, int32_t value)
+{
+    int32_t old = *p;
+    while (value < old)
+    {
+        const int32_t current = (int32_t)ClHostAtomicCmpXchg((volatile uint32_t*)p, (uint32_t)old, (uint32_t)value);
+        if (current == old) break;
+        old = current;
+    }
+    return old;
+}
+
+int32_t ClHostAtomicMaxI(volatile int32_t* p, int32_t value)
+{
+    int32_t old = *p;
+    while (value > old)
+    {
+        const int32_t current = (int32_t)ClHostAtomicCmpXchg((volatile uint32_t*)p, (uint32_t)old, (uint32_t)value);
+        if (current == old) break;
+        old = current;
+    }
+    return old;
+}
@@ -0,0 +1,205 @@
+#ifndef CL_HOST_H
+#define CL_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+// A host backend for the OpenCL C kernels of shaders/*/*.cl. A C translation unit defines CL_HOST_KERNEL_SOURCE, includes this header
+// and then the .cl sources, which turns the OpenCL C keywords and built-in functions into C, and the kernels into plain C functions.
+// ClHostEnqueueNDRange runs a range of workgroups of an NDRange on the worker threads of host_parallel.h, one workgroup at a time per thread.
+//
+// The work-items of a workgroup run one after another on their thread. A kernel that calls barrier() is enqueued with
+// CL_HOST_KERNEL_USES_BARRIERS, and then every work-item runs on a fiber of its own, switching to the next one at each barrier.
+// `local` variables declared in the kernel body are thread local statics, shared by the work-items of the workgroup the thread runs.
+// A sub-group is a single work-item, which the OpenCL C specification allows.
+//
+// Limitations: `local` pointer arguments, vector literals such as (uint4)(x, y, z, w), and the vector operators are not supported.
+// MSVC has no `__auto_type`, so the kernels for the host spell out their types rather than using `let`.
+
+enum
+{
+    CL_HOST_MAX_WORKGROUP_SIZE = 1024,
+    // The stack of the fiber of a work-item
+    CL_HOST_FIBER_STACK_SIZE = 64 * 1024
+};
+
+enum ClHostKernelFlags
+{
+    // The kernel calls barrier() or sub_group_barrier()
+    CL_HOST_KERNEL_USES_BARRIERS = 1
+};
+
+struct ClHostNDRange
+{
+    uint32_t workDim;
+    // Each global size must be a multiple of the local size
+    size_t globalSize[3];
+    size_t localSize[3];
+};
+
+// Unpacks `args` and calls the kernel function, once per work-item
+typedef void (*ClHostKernelEntry)(void* args);
+
+static inline size_t ClHostGetGroupCount(const struct ClHostNDRange* pRange)
+{
+    return (pRange->globalSize[0] / pRange->localSize[0]) * (pRange->globalSize[1] / pRange->localSize[1]) *
+        (pRange->globalSize[2] / pRange->localSize[2]);
+}
+
+// Runs the workgroups [firstGroup, firstGroup + groupCount) of `pRange`, in the order of their linear group IDs, and returns after all of them.
+// The work-items see the IDs and the sizes of the whole NDRange. Returns false if the range is invalid.
+extern bool ClHostEnqueueNDRange(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount, ClHostKernelEntry entry,
+    void* args, uint32_t flags);
+
+// The built-in functions of the work-item that runs on the calling thread
+extern uint32_t ClHostGetWorkDim(void);
+extern size_t ClHostGetGlobalID(uint32_t dim);
+extern size_t ClHostGetLocalID(uint32_t dim);
+extern size_t ClHostGetGroupID(uint32_t dim);
+extern size_t ClHostGetGlobalSize(uint32_t dim);
+extern size_t ClHostGetLocalSize(uint32_t dim);
+extern size_t ClHostGetNumGroups(uint32_t dim);
+extern size_t ClHostGetLocalLinearID(void);
+extern size_t ClHostGetLocalLinearSize(void);
+extern void ClHostBarrier(void);
+
+// 32-bit atomic functions, which return the old value
+extern uint32_t ClHostAtomicAdd(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicXchg(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicCmpXchg(volatile uint32_t* p, uint32_t comparand, uint32_t value);
+extern uint32_t ClHostAtomicAnd(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicOr(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicXor(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicMinU(volatile uint32_t* p, uint32_t value);
+extern uint32_t ClHostAtomicMaxU(volatile uint32_t* p, uint32_t value);
+extern int32_t ClHostAtomicMinI(volatile int32_t* p, int32_t value);
+extern int32_t ClHostAtomicMaxI(volatile int32_t* p, int32_t value);
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CL_HOST_THREAD_LOCAL    __declspec(thread)
+#else
+#define CL_HOST_THREAD_LOCAL    _Thread_local
+#endif
+
+#ifdef CL_HOST_KERNEL_SOURCE
+
+#if !defined(let) && (defined(__GNUC__) || defined(__clang__))
+#define let __auto_type
+#endif
+
+// ---- Address space and function qualifiers ----
+#define kernel
+#define __kernel
+#define global
+#define __global
+#define constant    const
+#define __constant  const
+#define private
+#define __private
+#define local       static CL_HOST_THREAD_LOCAL
+#define __local     local
+
+// ---- Scalar and vector types ----
+typedef uint8_t uchar;
+typedef uint16_t ushort;
+typedef uint32_t uint;
+typedef uint64_t ulong;
+
+typedef struct { uint x, y; } uint2;
+typedef struct { uint x, y, z, w; } uint4;
+typedef struct { int x, y; } int2;
+typedef struct { int x, y, z, w; } int4;
+typedef struct { float x, y; } float2;
+typedef struct { float x, y, z, w; } float4;
+
+// ---- Work-item functions ----
+#define get_work_dim()          ClHostGetWorkDim()
+#define get_global_id(dim)      ClHostGetGlobalID((uint32_t)(dim))
+#define get_local_id(dim)       ClHostGetLocalID((uint32_t)(dim))
+#define get_group_id(dim)       ClHostGetGroupID((uint32_t)(dim))
+#define get_global_size(dim)    ClHostGetGlobalSize((uint32_t)(dim))
+#define get_local_size(dim)     ClHostGetLocalSize((uint32_t)(dim))
+#define get_num_groups(dim)     ClHostGetNumGroups((uint32_t)(dim))
+#define get_global_offset(dim)  ((size_t)0)
+
+// ---- Synchronization ----
+#define CLK_LOCAL_MEM_FENCE     1
+#define CLK_GLOBAL_MEM_FENCE    2
+#define barrier(flags)          ((void)(flags), ClHostBarrier())
+#define mem_fence(flags)        ((void)(flags))
+#define read_mem_fence(flags)   ((void)(flags))
+#define write_mem_fence(flags)  ((void)(flags))
+
+// ---- Common and integer functions. The arguments may be evaluated more than once. ----
+#define min(a, b)               ((a) < (b) ? (a) : (b))
+#define max(a, b)               ((a) > (b) ? (a) : (b))
+#define clamp(x, lo, hi)        min(max((x), (lo)), (hi))
+#define mad(a, b, c)            ((a) * (b) + (c))
+#define mad24(a, b, c)          ((a) * (b) + (c))
+#define mul24(a, b)             ((a) * (b))
+
+static inline uint as_uint(float value)
+{
+    uint result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+static inline int as_int(float value)
+{
+    int result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+static inline float as_float(uint value)
+{
+    float result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+}
+
+// ---- 32-bit atomic functions on global and local int and uint ----
+#define atomic_add(p, value)    ClHostAtomicAdd((volatile uint32_t*)(p), (uint32_t)(value))
+#define atomic_sub(p, value)    ClHostAtomicAdd((volatile uint32_t*)(p), 0U - (uint32_t)(value))
+#define atomic_inc(p)           ClHostAtomicAdd((volatile uint32_t*)(p), 1U)
+#define atomic_dec(p)           ClHostAtomicAdd((volatile uint32_t*)(p), UINT32_MAX)
+#define atomic_xchg(p, value)   ClHostAtomicXchg((volatile uint32_t*)(p), (uint32_t)(value))
+#define atomic_cmpxchg(p, cmp, value)   ClHostAtomicCmpXchg((volatile uint32_t*)(p), (uint32_t)(cmp), (uint32_t)(value))
+#define atomic_and(p, value)    ClHostAtomicAnd((volatile uint32_t*)(p), (uint32_t)(value))
+#define atomic_or(p, value)     ClHostAtomicOr((volatile uint32_t*)(p), (uint32_t)(value))
+#define atomic_xor(p, value)    ClHostAtomicXor((volatile uint32_t*)(p), (uint32_t)(value))
+#define atomic_min(p, value)    _Generic((p),   \
+    int*: ClHostAtomicMinI((volatile int32_t*)(p), (int32_t)(value)),   \
+    volatile int*: ClHostAtomicMinI((volatile int32_t*)(p), (int32_t)(value)), \
+    default: ClHostAtomicMinU((volatile uint32_t*)(p), (uint32_t)(value)))
+#define atomic_max(p, value)    _Generic((p),   \
+    int*: ClHostAtomicMaxI((volatile int32_t*)(p), (int32_t)(value)),   \
+    volatile int*: ClHostAtomicMaxI((volatile int32_t*)(p), (int32_t)(value)), \
+    default: ClHostAtomicMaxU((volatile uint32_t*)(p), (uint32_t)(value)))
+
+// ---- Sub-group functions, with a sub-group of a single work-item ----
+#define get_sub_group_size()            1U
+#define get_max_sub_group_size()        1U
+#define get_num_sub_groups()            ((uint)ClHostGetLocalLinearSize())
+#define get_enqueued_num_sub_groups()   ((uint)ClHostGetLocalLinearSize())
+#define get_sub_group_id()              ((uint)ClHostGetLocalLinearID())
+#define get_sub_group_local_id()        0U
+#define sub_group_barrier(flags)        ((void)(flags))
+#define sub_group_all(predicate)        ((predicate) != 0)
+#define sub_group_any(predicate)        ((predicate) != 0)
+#define sub_group_broadcast(x, id)      ((void)(id), (x))
+#define sub_group_reduce_add(x)         (x)
+#define sub_group_reduce_min(x)         (x)
+#define sub_group_reduce_max(x)         (x)
+#define sub_group_scan_inclusive_add(x) (x)
+#define sub_group_scan_inclusive_min(x) (x)
+#define sub_group_scan_inclusive_max(x) (x)
+#define sub_group_scan_exclusive_add(x) ((x) - (x))
+
+#endif // CL_HOST_KERNEL_SOURCE
+
+#endif // !CL_HOST_H
@@ -0,0 +1,489 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "vk_common.h"
+#include "pipeline_variants.h"
+#include "clspv_reflection.h"
+
+enum
+{
+    SPIRV_MAGIC_NUMBER = 0x07230203,
+    SPIRV_HEADER_WORD_COUNT = 5,
+
+    SPIRV_OP_STRING = 7,
+    SPIRV_OP_EXT_INST_IMPORT = 11,
+    SPIRV_OP_EXT_INST = 12,
+    SPIRV_OP_TYPE_INT = 21,
+    SPIRV_OP_TYPE_FLOAT = 22,
+    SPIRV_OP_TYPE_VECTOR = 23,
+    SPIRV_OP_TYPE_ARRAY = 28,
+    SPIRV_OP_TYPE_STRUCT = 30,
+    SPIRV_OP_TYPE_POINTER = 32,
+    SPIRV_OP_CONSTANT = 43,
+    SPIRV_OP_FUNCTION = 54,
+    SPIRV_OP_FUNCTION_END = 56,
+    SPIRV_OP_VARIABLE = 59,
+
+    SPIRV_STORAGE_CLASS_WORKGROUP = 4,
+
+    // The instructions of NonSemantic.ClspvReflection
+    CLSPV_REFLECTION_KERNEL = 1,
+    CLSPV_REFLECTION_ARGUMENT_STORAGE_BUFFER = 3,
+    CLSPV_REFLECTION_ARGUMENT_UNIFORM = 4,
+    CLSPV_REFLECTION_ARGUMENT_POD_STORAGE_BUFFER = 5,
+    CLSPV_REFLECTION_ARGUMENT_POD_UNIFORM = 6,
+    CLSPV_REFLECTION_ARGUMENT_POD_PUSH_CONSTANT = 7,
+    CLSPV_REFLECTION_ARGUMENT_SAMPLED_IMAGE = 8,
+    CLSPV_REFLECTION_ARGUMENT_STORAGE_IMAGE = 9,
+    CLSPV_REFLECTION_ARGUMENT_SAMPLER = 10,
+    CLSPV_REFLECTION_ARGUMENT_WORKGROUP = 11
+};
+
+static const char s_clspvReflectionSetPrefix[] = "NonSemantic.ClspvReflection.";
+
+// What the reflection needs to know about a SPIR-V result ID
+struct SpirvIdInfo
+{
+    const char* string;
+    // The value of a 32-bit OpConstant
+    uint32_t constant;
+    // The size in bytes of a type, the pointee of a Workgroup pointer type or a Workgroup variable.
+    // It is 0 for the arrays sized by a specialization constant, which are the local pointer arguments.
+    uint32_t size;
+    // The word offset of OpFunction + 1, or 0
+    uint32_t functionOffset;
+    bool isKernelDecl;
+    bool isWorkgroupVariable;
+};
+
+// Returns the literal string of an instruction whose literal starts at `firstWord`, or NULL if it is not terminated inside the instruction.
+static const char* GetLiteralString(const uint32_t* code, uint32_t firstWord, uint32_t endWord)
+{
+    if (firstWord >= endWord) {
+        return NULL;
+    }
+    const char* str = (const char*)&code[firstWord];
+    return memchr(str, '\0', (endWord - firstWord) * sizeof(uint32_t)) != NULL ? str : NULL;
+}
+
+// Reads the operands of an Argument* reflection instruction other than ArgumentWorkgroup, after %decl:
+// `%ordinal %set %binding` of the descriptor kinds, `%ordinal %set %binding %offset %size` of the POD buffer kinds
+// and `%ordinal %offset %size` of ArgumentPodPushConstant, each followed by an optional %argInfo.
+// Returns false if the instruction is not such one or is too short.
+static bool ReadClspvArgument(const uint32_t* inst, uint32_t instWordCount, const struct SpirvIdInfo* idInfos, uint32_t idBound,
+    struct ClspvArgument* pArgument)
+{
+    uint32_t operandCount = 3;
+    switch (inst[4])
+    {
+    case CLSPV_REFLECTION_ARGUMENT_STORAGE_BUFFER: pArgument->kind = CLSPV_ARGUMENT_STORAGE_BUFFER; break;
+    case CLSPV_REFLECTION_ARGUMENT_UNIFORM: pArgument->kind = CLSPV_ARGUMENT_UNIFORM; break;
+    case CLSPV_REFLECTION_ARGUMENT_POD_STORAGE_BUFFER: pArgument->kind = CLSPV_ARGUMENT_POD_STORAGE_BUFFER; operandCount = 5; break;
+    case CLSPV_REFLECTION_ARGUMENT_POD_UNIFORM: pArgument->kind = CLSPV_ARGUMENT_POD_UNIFORM; operandCount = 5; break;
+    case CLSPV_REFLECTION_ARGUMENT_POD_PUSH_CONSTANT: pArgument->kind = CLSPV_ARGUMENT_POD_PUSH_CONSTANT; break;
+    case CLSPV_REFLECTION_ARGUMENT_SAMPLED_IMAGE: pArgument->kind = CLSPV_ARGUMENT_SAMPLED_IMAGE; break;
+    case CLSPV_REFLECTION_ARGUMENT_STORAGE_IMAGE: pArgument->kind = CLSPV_ARGUMENT_STORAGE_IMAGE; break;
+    case CLSPV_REFLECTION_ARGUMENT_SAMPLER: pArgument->kind = CLSPV_ARGUMENT_SAMPLER; break;
+    default:
+        return false;
+    }
+
+    // The header of OpExtInst and %decl take 6 words
+    if (instWordCount < 6 + operandCount) {
+        return false;
+    }
+    uint32_t operands[5];
+    for (uint32_t i = 0; i < operandCount; i++)
+    {
+        if (inst[6 + i] >= idBound) {
+            return false;
+        }
+        operands[i] = idInfos[inst[6 + i]].constant;
+    }
+
+    pArgument->ordinal = operands[0];
+    if (pArgument->kind == CLSPV_ARGUMENT_POD_PUSH_CONSTANT)
+    {
+        pArgument->offset = operands[1];
+        pArgument->size = operands[2];
+    }
+    else
+    {
+        pArgument->descriptorSet = operands[1];
+        pArgument->binding = operands[2];
+        if (operandCount == 5)
+        {
+            pArgument->offset = operands[3];
+            pArgument->size = operands[4];
+        }
+    }
+    return true;
+}
+
+// Sums the Workgroup variables the function at `functionOffset` refers to.
+// clspv inlines all the functions the kernel calls, so the kernel function itself refers to all the local arrays it uses.
+static uint32_t GetFunctionLocalMemorySize(const uint32_t* code, size_t wordCount, size_t functionOffset, struct SpirvIdInfo* idInfos, uint32_t idBound)
+{
+    uint32_t totalSize = 0;
+    for (size_t offset = functionOffset; offset < wordCount; )
+    {
+        const uint32_t instWordCount = code[offset] >> 16;
+        const uint32_t opcode = code[offset] & 0xffffU;
+        if (opcode == SPIRV_OP_FUNCTION_END || instWordCount == 0 || offset + instWordCount > wordCount) break;
+
+        // Any operand may be the ID of a variable. A literal that happens to equal such an ID only overestimates the size.
+        for (uint32_t i = 1; i < instWordCount; i++)
+        {
+            const uint32_t id = code[offset + i];
+            if (id < idBound && idInfos[id].isWorkgroupVariable)
+            {
+                totalSize += idInfos[id].size;
+                // Count every variable once
+                idInfos[id].isWorkgroupVariable = false;
+            }
+        }
+        offset += instWordCount;
+    }
+    return totalSize;
+}
+
+bool GetClspvKernelReflection(const uint32_t* code, size_t codeSize, const char* kernelName, struct ClspvKernelReflection* pReflection)
+{
+    memset(pReflection, 0, sizeof(*pReflection));
+
+    const size_t wordCount = codeSize / sizeof(uint32_t);
+    if (code == NULL || wordCount < SPIRV_HEADER_WORD_COUNT || code[0] != SPIRV_MAGIC_NUMBER) {
+        return false;
+    }
+
+    // Every ID is less than the bound
+    const uint32_t idBound = code[3];
+    struct SpirvIdInfo* idInfos = calloc(idBound, sizeof(*idInfos));
+    if (idInfos == NULL) {
+        return false;
+    }
+
+    bool hasKernel = false;
+    bool isValid = true;
+    uint32_t reflectionSetId = UINT32_MAX;
+    uint32_t kernelFunctionId = UINT32_MAX;
+    for (size_t offset = SPIRV_HEADER_WORD_COUNT; offset < wordCount && isValid; )
+    {
+        const uint32_t instWordCount = code[offset] >> 16;
+        const uint32_t opcode = code[offset] & 0xffffU;
+        if (instWordCount == 0 || offset + instWordCount > wordCount)
+        {
+            isValid = false;
+            break;
+        }
+        const uint32_t* inst = &code[offset];
+        const uint32_t endWord = (uint32_t)(offset + instWordCount);
+
+        switch (opcode)
+        {
+        case SPIRV_OP_STRING:
+            if (instWordCount >= 3 && inst[1] < idBound) {
+                idInfos[inst[1]].string = GetLiteralString(code, (uint32_t)offset + 2, endWord);
+            }
+            break;
+
+        case SPIRV_OP_EXT_INST_IMPORT:
+        {
+            const char* setName = instWordCount >= 3 ? GetLiteralString(code, (uint32_t)offset + 2, endWord) : NULL;
+            if (setName != NULL && strncmp(setName, s_clspvReflectionSetPrefix, sizeof(s_clspvReflectionSetPrefix) - 1) == 0) {
+                reflectionSetId = inst[1];
+            }
+            break;
+        }
+
+        case SPIRV_OP_TYPE_INT:
+        case SPIRV_OP_TYPE_FLOAT:
+            // OpTypeInt %result width [signedness], OpTypeFloat %result width
+            if (instWordCount >= 3 && inst[1] < idBound) {
+                idInfos[inst[1]].size = inst[2] / 8;
+            }
+            break;
+
+        case SPIRV_OP_TYPE_VECTOR:
+            // OpTypeVector %result %component count
+            if (instWordCount >= 4 && inst[1] < idBound && inst[2] < idBound) {
+                idInfos[inst[1]].size = idInfos[inst[2]].size * inst[3];
+            }
+            break;
+
+        case SPIRV_OP_TYPE_ARRAY:
+            // OpTypeArray %result %element %length, where a length from OpSpecConstant gives 0
+            if (instWordCount >= 4 && inst[1] < idBound && inst[2] < idBound && inst[3] < idBound) {
+                idInfos[inst[1]].size = idInfos[inst[2]].size * idInfos[inst[3]].constant;
+            }
+            break;
+
+        case SPIRV_OP_TYPE_STRUCT:
+            // OpTypeStruct %result %members..., ignoring the padding the Offset decorations may add
+            if (instWordCount >= 2 && inst[1] < idBound)
+            {
+                uint32_t size = 0;
+                for (uint32_t i = 2; i < instWordCount; i++) {
+                    size += inst[i] < idBound ? idInfos[inst[i]].size : 0;
+                }
+                idInfos[inst[1]].size = size;
+            }
+            break;
+
+        case SPIRV_OP_TYPE_POINTER:
+            // OpTypePointer %result storageClass %pointee
+            if (instWordCount >= 4 && inst[1] < idBound && inst[2] == SPIRV_STORAGE_CLASS_WORKGROUP && inst[3] < idBound) {
+                idInfos[inst[1]].size = idInfos[inst[3]].size;
+            }
+            break;
+
+        case SPIRV_OP_VARIABLE:
+            // OpVariable %type %result storageClass
+            if (instWordCount >= 4 && inst[1] < idBound && inst[2] < idBound && inst[3] == SPIRV_STORAGE_CLASS_WORKGROUP)
+            {
+                idInfos[inst[2]].size = idInfos[inst[1]].size;
+                idInfos[inst[2]].isWorkgroupVariable = idInfos[inst[2]].size > 0;
+            }
+            break;
+
+        case SPIRV_OP_FUNCTION:
+            // OpFunction %type %result control %functionType
+            if (instWordCount >= 3 && inst[2] < idBound) {
+                idInfos[inst[2]].functionOffset = (uint32_t)offset + 1;
+            }
+            break;
+
+        case SPIRV_OP_CONSTANT:
+            // Only the 32-bit integer constants matter, whose value is the first literal word
+            if (instWordCount >= 4 && inst[2] < idBound) {
+                idInfos[inst[2]].constant = inst[3];
+            }
+            break;
+
+        case SPIRV_OP_EXT_INST:
+            // OpExtInst %void %set instruction operands...
+            if (instWordCount < 5 || inst[3] != reflectionSetId) break;
+
+            if (inst[4] == CLSPV_REFLECTION_KERNEL && instWordCount >= 7)
+            {
+                // Kernel %function %name ...
+                const char* name = inst[6] < idBound ? idInfos[inst[6]].string : NULL;
+                if (inst[2] < idBound && name != NULL && strcmp(name, kernelName) == 0)
+                {
+                    idInfos[inst[2]].isKernelDecl = true;
+                    kernelFunctionId = inst[5];
+                    hasKernel = true;
+                }
+            }
+            else if (inst[4] == CLSPV_REFLECTION_ARGUMENT_WORKGROUP && instWordCount >= 9)
+            {
+                // ArgumentWorkgroup %decl %ordinal %specId %elemSize [%argInfo]
+                if (inst[5] >= idBound || !idInfos[inst[5]].isKernelDecl || inst[6] >= idBound || inst[7] >= idBound || inst[8] >= idBound) break;
+
+                if (pReflection->localArgumentCount == CLSPV_MAX_LOCAL_ARGUMENT_COUNT)
+                {
+                    fprintf(stderr, "%s has more than %d local pointer arguments!\n", kernelName, CLSPV_MAX_LOCAL_ARGUMENT_COUNT);
+                    isValid = false;
+                    break;
+                }
+
+                // Insert in the order of the ordinals
+                const struct ClspvLocalArgument argument = { idInfos[inst[6]].constant, idInfos[inst[7]].constant, idInfos[inst[8]].constant };
+                uint32_t index = pReflection->localArgumentCount++;
+                while (index > 0 && pReflection->localArguments[index - 1].ordinal > argument.ordinal)
+                {
+                    pReflection->localArguments[index] = pReflection->localArguments[index - 1];
+                    index--;
+                }
+                pReflection->localArguments[index] = argument;
+            }
+            else if (instWordCount >= 6 && inst[5] < idBound && idInfos[inst[5]].isKernelDecl)
+            {
+                struct ClspvArgument argument = { 0 };
+                if (!ReadClspvArgument(inst, instWordCount, idInfos, idBound, &argument)) break;
+
+                if (pReflection->argumentCount == CLSPV_MAX_ARGUMENT_COUNT)
+                {
+                    fprintf(stderr, "%s has more than %d arguments!\n", kernelName, CLSPV_MAX_ARGUMENT_COUNT);
+                    isValid = false;
+                    break;
+                }
+
+                uint32_t index = pReflection->argumentCount++;
+                while (index > 0 && pReflection->arguments[index - 1].ordinal > argument.ordinal)
+                {
+                    pReflection->arguments[index] = pReflection->arguments[index - 1];
+                    index--;
+                }
+                pReflection->arguments[index] = argument;
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        offset += instWordCount;
+    }
+
+    // The reflection instructions follow the functions, so the kernel function is known only now
+    if (isValid && hasKernel && kernelFunctionId < idBound && idInfos[kernelFunctionId].functionOffset != 0)
+    {
+        pReflection->staticLocalMemorySize = GetFunctionLocalMemorySize(code, wordCount, idInfos[kernelFunctionId].functionOffset - 1U,
+            idInfos, idBound);
+    }
+
+    free(idInfos);
+
+    return isValid && hasKernel;
+}
+
+bool LoadClspvKernelReflection(const char* fileName, const char* kernelName, struct ClspvKernelReflection* pReflection)
+{
+    size_t codeSize = 0;
+    uint32_t* code = LoadSpirvCode(fileName, &codeSize);
+    if (code == NULL) {
+        return false;
+    }
+
+    const bool found = GetClspvKernelReflection(code, codeSize, kernelName, pReflection);
+    free(code);
+    return found;
+}
+
+VkResult CheckClspvKernelLayout(const char* kernelName, const struct ClspvKernelReflection* pReflection,
+    const VkDescriptorSetLayoutBinding bindings[], uint32_t bindingCount, const uint32_t podOffsets[], uint32_t podCount, uint32_t pushConstantSize)
+{
+    static const VkDescriptorType descriptorTypes[] = {
+        [CLSPV_ARGUMENT_STORAGE_BUFFER] = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        [CLSPV_ARGUMENT_UNIFORM] = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        [CLSPV_ARGUMENT_SAMPLED_IMAGE] = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        [CLSPV_ARGUMENT_STORAGE_IMAGE] = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        [CLSPV_ARGUMENT_SAMPLER] = VK_DESCRIPTOR_TYPE_SAMPLER
+    };
+
+    uint32_t podIndex = 0;
+    for (uint32_t i = 0; i < pReflection->argumentCount; i++)
+    {
+        const struct ClspvArgument* pArgument = &pReflection->arguments[i];
+        switch (pArgument->kind)
+        {
+        case CLSPV_ARGUMENT_POD_STORAGE_BUFFER:
+        case CLSPV_ARGUMENT_POD_UNIFORM:
+            fprintf(stderr, "%s: argument %u is passed in a POD buffer at binding %u rather than in push constants!\n", kernelName,
+                pArgument->ordinal, pArgument->binding);
+            return VK_ERROR_INITIALIZATION_FAILED;
+
+        case CLSPV_ARGUMENT_POD_PUSH_CONSTANT:
+            if (podIndex == podCount || pArgument->offset != podOffsets[podIndex] || pArgument->offset + pArgument->size > pushConstantSize)
+            {
+                fprintf(stderr, "%s: push constant argument %u at offset %u (%u bytes) does not match the host layout!\n", kernelName,
+                    pArgument->ordinal, pArgument->offset, pArgument->size);
+                return VK_ERROR_INITIALIZATION_FAILED;
+            }
+            podIndex++;
+            break;
+
+        default:
+        {
+            uint32_t b = 0;
+            while (b < bindingCount && bindings[b].binding != pArgument->binding) b++;
+            if (pArgument->descriptorSet != 0 || b == bindingCount || bindings[b].descriptorType != descriptorTypes[pArgument->kind])
+            {
+                fprintf(stderr, "%s: argument %u at set %u binding %u does not match the descriptor set layout!\n", kernelName,
+                    pArgument->ordinal, pArgument->descriptorSet, pArgument->binding);
+                return VK_ERROR_INITIALIZATION_FAILED;
+            }
+            break;
+        }
+        }
+    }
+
+    if (podIndex != podCount)
+    {
+        fprintf(stderr, "%s has %u push constant arguments, but the host layout has %u!\n", kernelName, podIndex, podCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult GetClspvKernelSpecConstants(const char* kernelName, const struct ClspvKernelReflection* pReflection, const uint32_t workgroupSize[3],
+    const uint32_t localArgumentSizes[], uint32_t localArgumentCount, const VkPhysicalDeviceLimits* pLimits,
+    uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT], uint32_t* pSpecConstantCount)
+{
+    if (localArgumentCount != pReflection->localArgumentCount)
+    {
+        fprintf(stderr, "%s has %u local pointer arguments, but %u sizes are given!\n", kernelName, pReflection->localArgumentCount, localArgumentCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // IDs 0 ~ 2 are the workgroup size. The IDs in between that do not belong to a local pointer argument get 1,
+    // the default value clspv gives to the workgroup array sizes.
+    uint32_t specConstantCount = 3;
+    specConstants[0] = workgroupSize[0];
+    specConstants[1] = workgroupSize[1];
+    specConstants[2] = workgroupSize[2];
+
+    uint64_t totalSize = 0;
+    for (uint32_t i = 0; i < localArgumentCount; i++)
+    {
+        const struct ClspvLocalArgument* pArgument = &pReflection->localArguments[i];
+        const uint32_t size = localArgumentSizes[i];
+        if (size == 0 || pArgument->elemSize == 0 || size % pArgument->elemSize != 0)
+        {
+            fprintf(stderr, "%s: %u bytes of argument %u is not a non-zero multiple of its element size %u!\n", kernelName,
+                size, pArgument->ordinal, pArgument->elemSize);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        if (pArgument->specId < 3 || pArgument->specId >= CLSPV_MAX_SPEC_CONSTANT_COUNT)
+        {
+            fprintf(stderr, "%s: specialization constant ID %u of argument %u is not supported!\n", kernelName, pArgument->specId, pArgument->ordinal);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        totalSize += size;
+
+        while (specConstantCount <= pArgument->specId) {
+            specConstants[specConstantCount++] = 1U;
+        }
+        specConstants[pArgument->specId] = size / pArgument->elemSize;
+    }
+
+    if (totalSize > pLimits->maxComputeSharedMemorySize)
+    {
+        fprintf(stderr, "%s: %llu bytes of local memory arguments exceed maxComputeSharedMemorySize %u!\n", kernelName,
+            (unsigned long long)totalSize, pLimits->maxComputeSharedMemorySize);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *pSpecConstantCount = specConstantCount;
+    return VK_SUCCESS;
+}
+
+VkResult GetClspvKernelPipeline(struct PipelineVariantCache* pCache, VkShaderModule shaderModule, const char* kernelName,
+    VkPipelineLayout pipelineLayout, const struct ClspvKernelReflection* pReflection, const uint32_t workgroupSize[3],
+    const uint32_t localArgumentSizes[], uint32_t localArgumentCount, const VkPhysicalDeviceLimits* pLimits, VkPipeline* pPipeline,
+    uint32_t pElemCounts[])
+{
+    uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT];
+    uint32_t specConstantCount = 0;
+    VkResult result = GetClspvKernelSpecConstants(kernelName, pReflection, workgroupSize, localArgumentSizes, localArgumentCount, pLimits,
+        specConstants, &specConstantCount);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    if (pElemCounts != NULL)
+    {
+        for (uint32_t i = 0; i < localArgumentCount; i++) {
+            pElemCounts[i] = specConstants[pReflection->localArguments[i].specId];
+        }
+    }
+
+    return GetPipelineVariant(pCache, shaderModule, kernelName, pipelineLayout, specConstants, specConstantCount, pPipeline);
+}
+
@@ -0,0 +1,102 @@
+#ifndef CLSPV_REFLECTION_H
+#define CLSPV_REFLECTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct PipelineVariantCache;
+
+// Local memory kernel arguments of clspv generated modules.
+// clspv turns every `local T*` kernel argument into a workgroup array whose element count is a specialization constant,
+// and describes the mapping with the ArgumentWorkgroup instruction of the NonSemantic.ClspvReflection extended instruction set.
+// The host passes a byte size per local pointer argument instead of the specialization constant IDs and element counts.
+
+enum
+{
+    CLSPV_MAX_LOCAL_ARGUMENT_COUNT = 8,
+    CLSPV_MAX_ARGUMENT_COUNT = 32,
+    // Specialization constant IDs from it on are not supported
+    CLSPV_MAX_SPEC_CONSTANT_COUNT = 64
+};
+
+struct ClspvLocalArgument
+{
+    // The index of the argument in the kernel signature
+    uint32_t ordinal;
+    uint32_t specId;
+    // The size in bytes of the pointee type
+    uint32_t elemSize;
+};
+
+// How clspv passes a global, constant, image, sampler or POD kernel argument
+enum ClspvArgumentKind
+{
+    CLSPV_ARGUMENT_STORAGE_BUFFER,
+    CLSPV_ARGUMENT_UNIFORM,
+    CLSPV_ARGUMENT_POD_STORAGE_BUFFER,
+    CLSPV_ARGUMENT_POD_UNIFORM,
+    CLSPV_ARGUMENT_POD_PUSH_CONSTANT,
+    CLSPV_ARGUMENT_SAMPLED_IMAGE,
+    CLSPV_ARGUMENT_STORAGE_IMAGE,
+    CLSPV_ARGUMENT_SAMPLER
+};
+
+struct ClspvArgument
+{
+    uint32_t ordinal;
+    enum ClspvArgumentKind kind;
+    // Of the descriptor kinds
+    uint32_t descriptorSet;
+    uint32_t binding;
+    // Of the POD kinds, in bytes from the beginning of the push constant block or the POD buffer
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct ClspvKernelReflection
+{
+    // In the order of the ordinals, without the local pointer arguments
+    struct ClspvArgument arguments[CLSPV_MAX_ARGUMENT_COUNT];
+    uint32_t argumentCount;
+    // In the order of the ordinals
+    struct ClspvLocalArgument localArguments[CLSPV_MAX_LOCAL_ARGUMENT_COUNT];
+    uint32_t localArgumentCount;
+    // The size in bytes of the `local` arrays declared inside the kernel, which every workgroup occupies besides the local pointer arguments
+    uint32_t staticLocalMemorySize;
+};
+
+// Collects the local pointer arguments and the other arguments of `kernelName` from the reflection instructions of `code`,
+// and the size of the local arrays the kernel function refers to.
+// Returns false if the module has no reflection information for the kernel or the module is malformed.
+extern bool GetClspvKernelReflection(const uint32_t* code, size_t codeSize, const char* kernelName, struct ClspvKernelReflection* pReflection);
+
+// Loads `fileName` with LoadSpirvCode and reflects `kernelName` of it.
+extern bool LoadClspvKernelReflection(const char* fileName, const char* kernelName, struct ClspvKernelReflection* pReflection);
+
+// Checks the layout the host has hard-coded for `kernelName` against the one clspv generated:
+// every descriptor argument must be in set 0 at a binding of `bindings` with the matching descriptor type, and the POD arguments
+// must be push constants at podOffsets[0 ~ podCount - 1] in the order of the ordinals, inside `pushConstantSize` bytes.
+// Prints the first mismatch and returns VK_ERROR_INITIALIZATION_FAILED.
+extern VkResult CheckClspvKernelLayout(const char* kernelName, const struct ClspvKernelReflection* pReflection,
+    const VkDescriptorSetLayoutBinding bindings[], uint32_t bindingCount, const uint32_t podOffsets[], uint32_t podCount, uint32_t pushConstantSize);
+
+// Fills specConstants[0 ~ (*pSpecConstantCount - 1)] for CreateComputePipelineWithSpecConstants with `workgroupSize`
+// and localArgumentSizes[i] bytes for the i-th local pointer argument of `pReflection`. Every size must be a non-zero multiple
+// of the element size of its argument, and the sum of them must not exceed maxComputeSharedMemorySize,
+// which has to leave room for the local arrays declared inside the kernel as well.
+extern VkResult GetClspvKernelSpecConstants(const char* kernelName, const struct ClspvKernelReflection* pReflection, const uint32_t workgroupSize[3],
+    const uint32_t localArgumentSizes[], uint32_t localArgumentCount, const VkPhysicalDeviceLimits* pLimits,
+    uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT], uint32_t* pSpecConstantCount);
+
+// Returns the pipeline of the kernel from `pCache`, specialized as GetClspvKernelSpecConstants does.
+// @param pElemCounts: optional, receives the element count of every local pointer argument, e.g. to pass them as kernel arguments as well.
+extern VkResult GetClspvKernelPipeline(struct PipelineVariantCache* pCache, VkShaderModule shaderModule, const char* kernelName,
+    VkPipelineLayout pipelineLayout, const struct ClspvKernelReflection* pReflection, const uint32_t workgroupSize[3],
+    const uint32_t localArgumentSizes[], uint32_t localArgumentCount, const VkPhysicalDeviceLimits* pLimits, VkPipeline* pPipeline,
+    uint32_t pElemCounts[]);
+
+#endif // !CLSPV_REFLECTION_H
+
@@ -0,0 +1,703 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "elementwise_fusion.h"
+#include "command_recorder.h"
+
+enum
+{
+    COMMAND_RECORDER_INITIAL_SECONDARY_CAPACITY = 16,
+
+    PARALLEL_RECORDING_ELEM_COUNT = 4096,
+    PARALLEL_RECORDING_DISPATCH_COUNT = 512,
+    PARALLEL_RECORDING_CHUNK_DISPATCH_COUNT = 16,
+    PARALLEL_RECORDING_IN_FLIGHT_FRAME_COUNT = 3,
+    PARALLEL_RECORDING_MEASURED_FRAME_COUNT = 32,
+    PARALLEL_RECORDING_MAX_THREAD_COUNT = 8
+};
+
+// The command pool of one recording thread in one frame, and the secondary command buffers it has allocated so far
+struct CommandRecorderThreadPool
+{
+    VkCommandPool commandPool;
+    VkCommandBuffer* commandBuffers;
+    uint32_t capacity;
+    uint32_t allocatedCount;
+    // The command buffers recorded in the current frame, which are the first ones of `commandBuffers`
+    uint32_t usedCount;
+    VkResult result;
+
+    uint64_t recycledCount;
+};
+
+struct CommandRecorderFrame
+{
+    VkCommandPool primaryCommandPool;
+    VkCommandBuffer primaryCommandBuffer;
+    VkFence fence;
+    bool submitted;
+    struct CommandRecorderThreadPool* threadPools;
+};
+
+struct CommandRecorder
+{
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    uint32_t threadCount;
+    uint32_t frameCount;
+    uint32_t currentFrameIndex;
+    bool recording;
+    struct CommandRecorderFrame* frames;
+
+    // The secondary command buffer of every chunk of the current call, in chunk order
+    VkCommandBuffer* chunkCommandBuffers;
+    uint32_t chunkCapacity;
+
+    uint64_t submittedFrameCount;
+    uint64_t poolResetCount;
+};
+
+struct CommandRecordingJob
+{
+    struct CommandRecorder* pRecorder;
+    struct CommandRecorderFrame* pFrame;
+    uint32_t chunkCount;
+    RecordCommandChunk recordChunk;
+    void* context;
+    volatile uint32_t nextChunkIndex;
+};
+
+// MARK: Recorder
+
+static VkResult WaitCommandRecorderFrame(struct CommandRecorder* pRecorder, struct CommandRecorderFrame* pFrame)
+{
+    if (!pFrame->submitted) {
+        return VK_SUCCESS;
+    }
+
+    VkResult result = vkWaitForFences(pRecorder->device, 1, &pFrame->fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+        return result;
+    }
+    vkResetFences(pRecorder->device, 1, &pFrame->fence);
+    pFrame->submitted = false;
+    return VK_SUCCESS;
+}
+
+VkResult CreateCommandRecorder(VkDevice device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t frameCount,
+    struct CommandRecorder** ppRecorder)
+{
+    if (threadCount == 0 || frameCount == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct CommandRecorder* pRecorder = calloc(1, sizeof(*pRecorder));
+    if (pRecorder == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pRecorder->device = device;
+    pRecorder->queueFamilyIndex = queueFamilyIndex;
+    pRecorder->threadCount = threadCount;
+    pRecorder->frameCount = frameCount;
+    // The first BeginCommandRecorderFrame moves on to frame 0
+    pRecorder->currentFrameIndex = frameCount - 1;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        pRecorder->frames = calloc(frameCount, sizeof(pRecorder->frames[0]));
+        if (pRecorder->frames == NULL)
+        {
+            result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            break;
+        }
+
+        const VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0
+        };
+        const VkCommandPoolCreateInfo threadPoolCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = NULL,
+            // Reset as a whole every frame, and never a command buffer on its own
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = queueFamilyIndex
+        };
+        for (uint32_t f = 0; f < frameCount && result == VK_SUCCESS; f++)
+        {
+            struct CommandRecorderFrame* const pFrame = &pRecorder->frames[f];
+            result = InitializeCommandBufferWithFlags(queueFamilyIndex, device, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                VK_COMMAND_BUFFER_LEVEL_PRIMARY, &pFrame->primaryCommandPool, &pFrame->primaryCommandBuffer, 1);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "InitializeCommandBufferWithFlags failed!\n");
+                break;
+            }
+
+            result = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), &pFrame->fence);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "vkCreateFence failed: %d\n", result);
+                break;
+            }
+
+            pFrame->threadPools = calloc(threadCount, sizeof(pFrame->threadPools[0]));
+            if (pFrame->threadPools == NULL)
+            {
+                result = VK_ERROR_OUT_OF_HOST_MEMORY;
+                break;
+            }
+            for (uint32_t t = 0; t < threadCount; t++)
+            {
+                result = vkCreateCommandPool(device, &threadPoolCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL),
+                    &pFrame->threadPools[t].commandPool);
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "vkCreateCommandPool failed: %d\n", result);
+                    break;
+                }
+            }
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyCommandRecorder(pRecorder);
+        return result;
+    }
+
+    *ppRecorder = pRecorder;
+    return VK_SUCCESS;
+}
+
+void DestroyCommandRecorder(struct CommandRecorder* pRecorder)
+{
+    if (pRecorder == NULL) {
+        return;
+    }
+
+    const VkDevice device = pRecorder->device;
+    if (pRecorder->frames != NULL)
+    {
+        WaitCommandRecorderIdle(pRecorder);
+        for (uint32_t f = 0; f < pRecorder->frameCount; f++)
+        {
+            struct CommandRecorderFrame* const pFrame = &pRecorder->frames[f];
+            if (pFrame->threadPools != NULL)
+            {
+                for (uint32_t t = 0; t < pRecorder->threadCount; t++)
+                {
+                    struct CommandRecorderThreadPool* const pPool = &pFrame->threadPools[t];
+                    if (pPool->commandPool != VK_NULL_HANDLE)
+                    {
+                        // Frees the command buffers of the pool as well
+                        vkDestroyCommandPool(device, pPool->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+                    }
+                    free(pPool->commandBuffers);
+                }
+                free(pFrame->threadPools);
+            }
+            if (pFrame->fence != VK_NULL_HANDLE) {
+                vkDestroyFence(device, pFrame->fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+            }
+            if (pFrame->primaryCommandPool != VK_NULL_HANDLE)
+            {
+                vkFreeCommandBuffers(device, pFrame->primaryCommandPool, 1, &pFrame->primaryCommandBuffer);
+                vkDestroyCommandPool(device, pFrame->primaryCommandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+            }
+        }
+        free(pRecorder->frames);
+    }
+    free(pRecorder->chunkCommandBuffers);
+    free(pRecorder);
+}
+
+VkResult BeginCommandRecorderFrame(struct CommandRecorder* pRecorder, VkCommandBuffer* pPrimaryCommandBuffer)
+{
+    if (pRecorder->recording) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    pRecorder->currentFrameIndex = (pRecorder->currentFrameIndex + 1) % pRecorder->frameCount;
+    struct CommandRecorderFrame* const pFrame = &pRecorder->frames[pRecorder->currentFrameIndex];
+    VkResult result = WaitCommandRecorderFrame(pRecorder, pFrame);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    // The device is done with the command buffers of the frame, which are recycled rather than freed
+    for (uint32_t t = 0; t < pRecorder->threadCount; t++)
+    {
+        struct CommandRecorderThreadPool* const pPool = &pFrame->threadPools[t];
+        if (pPool->usedCount == 0) continue;
+
+        result = vkResetCommandPool(pRecorder->device, pPool->commandPool, 0);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkResetCommandPool failed: %d\n", result);
+            return result;
+        }
+        pPool->usedCount = 0;
+        pRecorder->poolResetCount++;
+    }
+
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+    // Resets the primary of the previous submission implicitly, as its pool allows
+    result = vkBeginCommandBuffer(pFrame->primaryCommandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", result);
+        return result;
+    }
+
+    pRecorder->recording = true;
+    if (pPrimaryCommandBuffer != NULL) {
+        *pPrimaryCommandBuffer = pFrame->primaryCommandBuffer;
+    }
+    return VK_SUCCESS;
+}
+
+// Returns a secondary command buffer of the pool that has not been recorded in this frame, or VK_NULL_HANDLE if it cannot be allocated
+static VkCommandBuffer AcquireSecondaryCommandBuffer(VkDevice device, struct CommandRecorderThreadPool* pPool)
+{
+    if (pPool->usedCount < pPool->allocatedCount)
+    {
+        pPool->recycledCount++;
+        return pPool->commandBuffers[pPool->usedCount++];
+    }
+
+    if (pPool->allocatedCount == pPool->capacity)
+    {
+        const uint32_t capacity = pPool->capacity > 0 ? pPool->capacity * 2 : COMMAND_RECORDER_INITIAL_SECONDARY_CAPACITY;
+        VkCommandBuffer* commandBuffers = realloc(pPool->commandBuffers, sizeof(commandBuffers[0]) * capacity);
+        if (commandBuffers == NULL) {
+            return VK_NULL_HANDLE;
+        }
+        pPool->commandBuffers = commandBuffers;
+        pPool->capacity = capacity;
+    }
+
+    const VkCommandBufferAllocateInfo allocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pPool->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1
+    };
+    const VkResult result = vkAllocateCommandBuffers(device, &allocateInfo, &pPool->commandBuffers[pPool->allocatedCount]);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateCommandBuffers failed: %d\n", result);
+        return VK_NULL_HANDLE;
+    }
+    pPool->allocatedCount++;
+    return pPool->commandBuffers[pPool->usedCount++];
+}
+
+// The recording thread `threadIndex` takes the next chunk until there is none left
+static void RecordCommandChunksOnThread(struct CommandRecordingJob* pJob, uint32_t threadIndex)
+{
+    struct CommandRecorder* const pRecorder = pJob->pRecorder;
+    struct CommandRecorderThreadPool* const pPool = &pJob->pFrame->threadPools[threadIndex];
+
+    // A secondary command buffer of a compute job is used outside any render pass, and inherits nothing
+    const VkCommandBufferInheritanceInfo inheritanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .pNext = NULL,
+        .renderPass = VK_NULL_HANDLE,
+        .subpass = 0,
+        .framebuffer = VK_NULL_HANDLE,
+        .occlusionQueryEnable = VK_FALSE,
+        .queryFlags = 0,
+        .pipelineStatistics = 0
+    };
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = &inheritanceInfo
+    };
+
+    pPool->result = VK_SUCCESS;
+    for (;;)
+    {
+        const uint32_t chunkIndex = HostAtomicFetchAddUInt32(&pJob->nextChunkIndex, 1);
+        if (chunkIndex >= pJob->chunkCount) break;
+
+        const VkCommandBuffer commandBuffer = AcquireSecondaryCommandBuffer(pRecorder->device, pPool);
+        if (commandBuffer == VK_NULL_HANDLE)
+        {
+            pPool->result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+            break;
+        }
+        pPool->result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        if (pPool->result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", pPool->result);
+            break;
+        }
+        pJob->recordChunk(pJob->context, commandBuffer, chunkIndex);
+        pPool->result = vkEndCommandBuffer(commandBuffer);
+        if (pPool->result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkEndCommandBuffer failed: %d\n", pPool->result);
+            break;
+        }
+        pRecorder->chunkCommandBuffers[chunkIndex] = commandBuffer;
+    }
+}
+
+static void RecordCommandChunksTask(void* context, size_t begin, size_t end)
+{
+    struct CommandRecordingJob* const pJob = context;
+    for (size_t t = begin; t < end; t++) {
+        RecordCommandChunksOnThread(pJob, (uint32_t)t);
+    }
+}
+
+VkResult RecordCommandChunksInParallel(struct CommandRecorder* pRecorder, uint32_t chunkCount, uint32_t threadCount,
+    RecordCommandChunk recordChunk, void* context)
+{
+    if (!pRecorder->recording) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    if (chunkCount == 0) {
+        return VK_SUCCESS;
+    }
+
+    if (chunkCount > pRecorder->chunkCapacity)
+    {
+        VkCommandBuffer* chunkCommandBuffers = realloc(pRecorder->chunkCommandBuffers, sizeof(chunkCommandBuffers[0]) * chunkCount);
+        if (chunkCommandBuffers == NULL) {
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        pRecorder->chunkCommandBuffers = chunkCommandBuffers;
+        pRecorder->chunkCapacity = chunkCount;
+    }
+
+    if (threadCount == 0 || threadCount > pRecorder->threadCount) {
+        threadCount = pRecorder->threadCount;
+    }
+    if (threadCount > chunkCount) {
+        threadCount = chunkCount;
+    }
+
+    struct CommandRecorderFrame* const pFrame = &pRecorder->frames[pRecorder->currentFrameIndex];
+    struct CommandRecordingJob job = {
+        .pRecorder = pRecorder,
+        .pFrame = pFrame,
+        .chunkCount = chunkCount,
+        .recordChunk = recordChunk,
+        .context = context,
+        .nextChunkIndex = 0
+    };
+    // One task per recording thread, whose index selects its command pool. If the host thread pool has fewer threads,
+    // a thread runs several tasks one after another, each with the pool of its task.
+    HostParallelForEach(threadCount, threadCount, RecordCommandChunksTask, &job);
+
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        if (pFrame->threadPools[t].result != VK_SUCCESS) {
+            return pFrame->threadPools[t].result;
+        }
+    }
+
+    vkCmdExecuteCommands(pFrame->primaryCommandBuffer, chunkCount, pRecorder->chunkCommandBuffers);
+    return VK_SUCCESS;
+}
+
+VkResult RecordCommandChunksInline(struct CommandRecorder* pRecorder, uint32_t chunkCount, RecordCommandChunk recordChunk, void* context)
+{
+    if (!pRecorder->recording) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const VkCommandBuffer primaryCommandBuffer = pRecorder->frames[pRecorder->currentFrameIndex].primaryCommandBuffer;
+    for (uint32_t c = 0; c < chunkCount; c++) {
+        recordChunk(context, primaryCommandBuffer, c);
+    }
+    return VK_SUCCESS;
+}
+
+VkResult SubmitCommandRecorderFrame(struct CommandRecorder* pRecorder, VkQueue queue)
+{
+    if (!pRecorder->recording) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    pRecorder->recording = false;
+
+    struct CommandRecorderFrame* const pFrame = &pRecorder->frames[pRecorder->currentFrameIndex];
+    VkResult result = vkEndCommandBuffer(pFrame->primaryCommandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+        return result;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pFrame->primaryCommandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    result = vkQueueSubmit(queue, 1, &submitInfo, pFrame->fence);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+        return result;
+    }
+    pFrame->submitted = true;
+    pRecorder->submittedFrameCount++;
+    return VK_SUCCESS;
+}
+
+VkResult WaitCommandRecorderIdle(struct CommandRecorder* pRecorder)
+{
+    VkResult result = VK_SUCCESS;
+    for (uint32_t f = 0; f < pRecorder->frameCount; f++)
+    {
+        const VkResult frameResult = WaitCommandRecorderFrame(pRecorder, &pRecorder->frames[f]);
+        if (frameResult != VK_SUCCESS) {
+            result = frameResult;
+        }
+    }
+    return result;
+}
+
+void GetCommandRecorderStats(const struct CommandRecorder* pRecorder, struct CommandRecorderStats* pStats)
+{
+    memset(pStats, 0, sizeof(*pStats));
+    pStats->frameCount = pRecorder->submittedFrameCount;
+    pStats->poolResetCount = pRecorder->poolResetCount;
+    for (uint32_t f = 0; f < pRecorder->frameCount; f++)
+    {
+        for (uint32_t t = 0; t < pRecorder->threadCount; t++)
+        {
+            pStats->allocatedSecondaryCount += pRecorder->frames[f].threadPools[t].allocatedCount;
+            pStats->recycledSecondaryCount += pRecorder->frames[f].threadPools[t].recycledCount;
+        }
+    }
+}
+
+// MARK: Benchmark
+
+// The dispatches ping-pong between the two buffers: dispatch k runs plans[k % 2]
+struct ParallelRecordingJob
+{
+    struct ElementwiseChainPlan* pPlans[2];
+};
+
+static void RecordParallelRecordingChunk(void* context, VkCommandBuffer commandBuffer, uint32_t chunkIndex)
+{
+    const struct ParallelRecordingJob* pJob = context;
+    const uint32_t firstDispatch = chunkIndex * PARALLEL_RECORDING_CHUNK_DISPATCH_COUNT;
+    for (uint32_t k = firstDispatch; k < firstDispatch + PARALLEL_RECORDING_CHUNK_DISPATCH_COUNT; k++)
+    {
+        RecordElementwiseChain(commandBuffer, pJob->pPlans[k % 2], PARALLEL_RECORDING_ELEM_COUNT);
+        RecordComputeToComputeBarrier(commandBuffer);
+    }
+}
+
+// Records and submits `frameCount` frames with `threadCount` threads, or inline if it is 0. Returns the average recording time in nanoseconds.
+static VkResult RunParallelRecordingFrames(struct CommandRecorder* pRecorder, VkQueue queue, struct ParallelRecordingJob* pJob,
+    uint32_t threadCount, uint32_t frameCount, double* pAverageTime)
+{
+    const uint32_t chunkCount = PARALLEL_RECORDING_DISPATCH_COUNT / PARALLEL_RECORDING_CHUNK_DISPATCH_COUNT;
+    uint64_t totalTime = 0;
+    for (uint32_t f = 0; f < frameCount; f++)
+    {
+        VkCommandBuffer primaryCommandBuffer = VK_NULL_HANDLE;
+        VkResult result = BeginCommandRecorderFrame(pRecorder, &primaryCommandBuffer);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+
+        // Orders the dispatches after the ones of the previous frame
+        RecordComputeToComputeBarrier(primaryCommandBuffer);
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        result = threadCount == 0 ? RecordCommandChunksInline(pRecorder, chunkCount, RecordParallelRecordingChunk, pJob) :
+            RecordCommandChunksInParallel(pRecorder, chunkCount, threadCount, RecordParallelRecordingChunk, pJob);
+        totalTime += HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+        RecordComputeToHostBarrier(primaryCommandBuffer);
+
+        result = SubmitCommandRecorderFrame(pRecorder, queue);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+    }
+    *pAverageTime = (double)totalTime / (double)frameCount;
+    return VK_SUCCESS;
+}
+
+void ParallelRecordingBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin parallel command recording benchmark ================\n");
+
+    struct ElementwiseContext* pElementwiseContext = NULL;
+    struct ParallelRecordingJob job = { { NULL, NULL } };
+    struct CommandRecorder* pRecorder = NULL;
+    VkBuffer buffers[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    VkDeviceMemory memories[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+
+    // Every dispatch adds 1
+    const struct ElementwiseChain chain = { 1, { ELEMENTWISE_OP_ADD }, { 1 } };
+
+    do
+    {
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        const VkDeviceSize bufferSize = PARALLEL_RECORDING_ELEM_COUNT * sizeof(uint32_t);
+        VkResult result = VK_SUCCESS;
+        for (int i = 0; i < 2 && result == VK_SUCCESS; i++)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &buffers[i], &memories[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        int* hostPtr = NULL;
+        result = vkMapMemory(specDevice, memories[0], 0, VK_WHOLE_SIZE, 0, (void**)&hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        HostParallelFillSequence(hostPtr, PARALLEL_RECORDING_ELEM_COUNT, 0);
+
+        if (CreateElementwiseContext(specDevice, pLimits, &pElementwiseContext) != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            vkUnmapMemory(specDevice, memories[0]);
+            break;
+        }
+        result = CreateElementwiseChainPlan(pElementwiseContext, &chain, ELEMENTWISE_FUSION_AUTO, buffers[0], buffers[1], &job.pPlans[0]);
+        if (result == VK_SUCCESS) {
+            result = CreateElementwiseChainPlan(pElementwiseContext, &chain, ELEMENTWISE_FUSION_AUTO, buffers[1], buffers[0], &job.pPlans[1]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+            vkUnmapMemory(specDevice, memories[0]);
+            break;
+        }
+
+        uint32_t maxThreadCount = HostParallelGetThreadCount();
+        if (maxThreadCount > PARALLEL_RECORDING_MAX_THREAD_COUNT) {
+            maxThreadCount = PARALLEL_RECORDING_MAX_THREAD_COUNT;
+        }
+        result = CreateCommandRecorder(specDevice, specQueueFamilyIndex, maxThreadCount, PARALLEL_RECORDING_IN_FLIGHT_FRAME_COUNT, &pRecorder);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateCommandRecorder failed: %d\n", result);
+            vkUnmapMemory(specDevice, memories[0]);
+            break;
+        }
+
+        printf("A job of %d dispatches in %d chunks, %d frames in flight, %d frames measured per configuration\n", PARALLEL_RECORDING_DISPATCH_COUNT,
+            PARALLEL_RECORDING_DISPATCH_COUNT / PARALLEL_RECORDING_CHUNK_DISPATCH_COUNT, PARALLEL_RECORDING_IN_FLIGHT_FRAME_COUNT,
+            PARALLEL_RECORDING_MEASURED_FRAME_COUNT);
+
+        // 0 threads is the inline recording into the primary
+        uint32_t threadCounts[2 + PARALLEL_RECORDING_MAX_THREAD_COUNT];
+        uint32_t configCount = 0;
+        threadCounts[configCount++] = 0;
+        for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+            threadCounts[configCount++] = threadCount;
+        }
+
+        uint64_t frameCount = 0;
+        double inlineTime = 0.0;
+        for (uint32_t i = 0; i < configCount && result == VK_SUCCESS; i++)
+        {
+            // The first frames of every frame slot allocate the secondary command buffers, which the measured frames recycle
+            double averageTime = 0.0;
+            result = RunParallelRecordingFrames(pRecorder, queue, &job, threadCounts[i], PARALLEL_RECORDING_IN_FLIGHT_FRAME_COUNT, &averageTime);
+            if (result == VK_SUCCESS) {
+                result = RunParallelRecordingFrames(pRecorder, queue, &job, threadCounts[i], PARALLEL_RECORDING_MEASURED_FRAME_COUNT, &averageTime);
+            }
+            if (result != VK_SUCCESS) break;
+            frameCount += PARALLEL_RECORDING_IN_FLIGHT_FRAME_COUNT + PARALLEL_RECORDING_MEASURED_FRAME_COUNT;
+
+            char title[32];
+            if (threadCounts[i] == 0)
+            {
+                inlineTime = averageTime;
+                snprintf(title, sizeof(title), "Inline, 1 thread");
+            }
+            else {
+                snprintf(title, sizeof(title), "Secondary, %u thread(s)", threadCounts[i]);
+            }
+            printf("%-24s recording: %9.2f us per job, %6.3f us per dispatch, %5.2fx the inline recording\n", title, averageTime / 1000.0,
+                averageTime / 1000.0 / PARALLEL_RECORDING_DISPATCH_COUNT, averageTime > 0.0 ? inlineTime / averageTime : 0.0);
+        }
+
+        if (result == VK_SUCCESS) {
+            result = WaitCommandRecorderIdle(pRecorder);
+        }
+        if (result == VK_SUCCESS)
+        {
+            struct CommandRecorderStats stats;
+            GetCommandRecorderStats(pRecorder, &stats);
+            printf("%llu frames: %llu secondary command buffers allocated, %llu recycled, %llu command pool resets\n",
+                (unsigned long long)stats.frameCount, (unsigned long long)stats.allocatedSecondaryCount,
+                (unsigned long long)stats.recycledSecondaryCount, (unsigned long long)stats.poolResetCount);
+
+            // Every frame adds PARALLEL_RECORDING_DISPATCH_COUNT, and an even number of dispatches leaves the result in buffers[0]
+            const uint32_t addend = (uint32_t)(frameCount * PARALLEL_RECORDING_DISPATCH_COUNT);
+            bool verified = true;
+            for (uint32_t i = 0; i < PARALLEL_RECORDING_ELEM_COUNT; i++)
+            {
+                if ((uint32_t)hostPtr[i] != i + addend)
+                {
+                    fprintf(stderr, "Result mismatch @%u: %u, expected %u\n", i, (uint32_t)hostPtr[i], i + addend);
+                    verified = false;
+                    break;
+                }
+            }
+            printf("Parallel recording results: %s\n", verified ? "verify OK" : "verify FAILED");
+        }
+        else {
+            fprintf(stderr, "The parallel recording benchmark failed: %d\n", result);
+        }
+        vkUnmapMemory(specDevice, memories[0]);
+    } while (false);
+
+    DestroyCommandRecorder(pRecorder);
+    DestroyElementwiseChainPlan(job.pPlans[0]);
+    DestroyElementwiseChainPlan(job.pPlans[1]);
+    DestroyElementwiseContext(pElementwiseContext);
+    DestroyBufferWithMemory(specDevice, buffers[0], memories[0]);
+    DestroyBufferWithMemory(specDevice, buffers[1], memories[1]);
+
+    puts("\n================ Complete parallel command recording benchmark ================\n");
+}
@@ -0,0 +1,67 @@
+#ifndef COMMAND_RECORDER_H
+#define COMMAND_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Parallel recording of a large job of many dispatches. The job is split into chunks, which the threads of the host thread pool record
+// into secondary command buffers concurrently, and one primary command buffer executes them in chunk order.
+// A command pool may only be used by one thread at a time, so every recording thread has a command pool of its own.
+//
+// The pools are organized in frames as a renderer does: each of the `frameCount` frames has a pool per thread and a primary command buffer,
+// and is recorded again only after the fence of its previous submission has been signaled. The thread pools are created transient and reset
+// as a whole at the beginning of the frame, which recycles their secondary command buffers instead of freeing them. The primary comes from
+// a pool with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, so it is reset implicitly when it is begun again.
+//
+// A secondary command buffer inherits no state from the primary: every chunk binds its own pipeline and descriptor sets, and records
+// the barriers between its dispatches. The barriers between chunks are the ones at the end of the previous chunk.
+
+// Records the chunk `chunkIndex` into `commandBuffer`, which is a secondary command buffer being recorded, or the primary when recorded inline.
+typedef void (*RecordCommandChunk)(void* context, VkCommandBuffer commandBuffer, uint32_t chunkIndex);
+
+struct CommandRecorderStats
+{
+    uint64_t frameCount;
+    // The secondary command buffers allocated, and the ones reused after a reset of their pool
+    uint64_t allocatedSecondaryCount;
+    uint64_t recycledSecondaryCount;
+    uint64_t poolResetCount;
+};
+
+struct CommandRecorder;
+
+// @param threadCount: the most threads that record a frame, each with a command pool of its own per frame
+// @param frameCount: the frames that may be in flight at the same time
+extern VkResult CreateCommandRecorder(VkDevice device, uint32_t queueFamilyIndex, uint32_t threadCount, uint32_t frameCount,
+    struct CommandRecorder** ppRecorder);
+// Waits for the frames in flight.
+extern void DestroyCommandRecorder(struct CommandRecorder* pRecorder);
+
+// Moves on to the next frame: waits for its previous submission, resets its pools and begins its primary command buffer.
+// @param pPrimaryCommandBuffer: receives the primary, into which the caller may record before and after the chunks. It may be NULL.
+extern VkResult BeginCommandRecorderFrame(struct CommandRecorder* pRecorder, VkCommandBuffer* pPrimaryCommandBuffer);
+
+// Records `chunkCount` chunks into secondary command buffers on up to `threadCount` threads of the host thread pool, and executes them
+// in the primary in chunk order. The chunks are handed out one at a time, so the threads balance chunks of uneven cost.
+// 0 threads means the `threadCount` of the recorder.
+extern VkResult RecordCommandChunksInParallel(struct CommandRecorder* pRecorder, uint32_t chunkCount, uint32_t threadCount,
+    RecordCommandChunk recordChunk, void* context);
+// Records the chunks on the calling thread directly into the primary, as a single-threaded job does
+extern VkResult RecordCommandChunksInline(struct CommandRecorder* pRecorder, uint32_t chunkCount, RecordCommandChunk recordChunk, void* context);
+
+// Ends the primary of the current frame and submits it with the fence of the frame.
+extern VkResult SubmitCommandRecorderFrame(struct CommandRecorder* pRecorder, VkQueue queue);
+// Waits for all the frames that have been submitted.
+extern VkResult WaitCommandRecorderIdle(struct CommandRecorder* pRecorder);
+
+extern void GetCommandRecorderStats(const struct CommandRecorder* pRecorder, struct CommandRecorderStats* pStats);
+
+// Measures the CPU time of recording jobs of hundreds of dispatches against the number of recording threads,
+// compared with recording them inline on one thread.
+extern void ParallelRecordingBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !COMMAND_RECORDER_H
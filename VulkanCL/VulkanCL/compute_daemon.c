@@ -0,0 +1,1211 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif // !_WIN32
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "elementwise_fusion.h"
+#include "scan.h"
+#include "external_memory.h"
+#include "job_queue.h"
+#include "object_pool.h"
+#include "compute_daemon.h"
+
+#ifndef _WIN32
+
+enum
+{
+    COMPUTE_DAEMON_MESSAGE_MAGIC = 0x564b4344U,     // 'VKCD'
+
+    COMPUTE_DAEMON_MAX_CONNECTION_COUNT = 64,
+    COMPUTE_DAEMON_LISTEN_BACKLOG = 16,
+    // How often the accepting thread and the device thread look at the stop flag
+    COMPUTE_DAEMON_POLL_INTERVAL_MILLISECONDS = 100,
+
+    // The warm buffers hold this many elements at first, and grow by powers of 2
+    COMPUTE_DAEMON_INITIAL_ELEM_COUNT = 1024 * 1024,
+    COMPUTE_DAEMON_PLAN_CACHE_SIZE = 16,
+
+    // The latencies of the last jobs, of which the percentiles are reported every COMPUTE_DAEMON_REPORT_INTERVAL jobs
+    COMPUTE_DAEMON_LATENCY_WINDOW = 4096,
+    COMPUTE_DAEMON_REPORT_INTERVAL = 1024,
+
+    COMPUTE_DAEMON_TEST_CLIENT_COUNT = 4,
+    COMPUTE_DAEMON_TEST_JOB_COUNT = 256,
+    COMPUTE_DAEMON_TEST_BASE_ELEM_COUNT = 16 * 1024,
+    COMPUTE_DAEMON_CONNECT_TIMEOUT_MILLISECONDS = 10000
+};
+
+enum ComputeDaemonRequestKind
+{
+    COMPUTE_DAEMON_REQUEST_JOB,
+    COMPUTE_DAEMON_REQUEST_SHUTDOWN
+};
+
+enum ComputeDaemonKernel
+{
+    COMPUTE_DAEMON_KERNEL_ELEMENTWISE_CHAIN,
+    COMPUTE_DAEMON_KERNEL_INCLUSIVE_SCAN,
+    COMPUTE_DAEMON_KERNEL_EXCLUSIVE_SCAN,
+    COMPUTE_DAEMON_KERNEL_COUNT
+};
+
+static const char* const s_kernelNames[COMPUTE_DAEMON_KERNEL_COUNT] = {
+    "elementwise_chain",
+    "inclusive_scan",
+    "exclusive_scan"
+};
+
+// Sent with the fd of the shared memory segment
+struct ComputeDaemonRequest
+{
+    uint32_t magic;
+    uint32_t kind;
+    char kernelName[COMPUTE_DAEMON_MAX_KERNEL_NAME_LENGTH];
+    uint32_t elemCount;
+    uint64_t segmentSize;
+    // Echoed in the reply
+    uint64_t tag;
+    struct ElementwiseChain chain;
+};
+
+struct ComputeDaemonReply
+{
+    uint32_t magic;
+    int32_t result;
+    uint64_t tag;
+    uint64_t queueTime;
+    uint64_t executeTime;
+    uint64_t totalTime;
+};
+
+struct ComputeDaemon;
+
+struct ComputeDaemonConnection
+{
+    struct ComputeDaemon* pDaemon;
+    int socket;
+    pthread_t thread;
+    // The jobs of the connection the device thread has not replied to. The socket is closed once the thread has finished and they are done.
+    volatile uint32_t pendingJobCount;
+    volatile uint32_t finished;
+    // Only accessed by the accepting thread
+    bool inUse;
+};
+
+// The queue node comes first, so that a node is its job
+struct ComputeDaemonJob
+{
+    struct JobQueueNode node;
+    struct ComputeDaemonConnection* pConnection;
+    struct ComputeDaemonRequest request;
+    int segmentFd;
+    uint64_t receiveTime;
+};
+
+struct ComputeDaemonPlanEntry
+{
+    struct ElementwiseChain chain;
+    struct ElementwiseChainPlan* pPlan;
+    uint64_t lastUse;
+};
+
+struct ComputeDaemon
+{
+    VkDevice device;
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties;
+    uint32_t queueFamilyIndex;
+    const VkPhysicalDeviceLimits* pLimits;
+    VkQueue queue;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    // From the shared fence pool, and replaced by another one of it after a failed wait
+    struct FencePool* pFencePool;
+    VkFence fence;
+
+    struct ElementwiseContext* pElementwiseContext;
+    struct ScanContext* pScanContext;
+    // Bound to the warm buffers, and created again when they grow
+    struct ScanPlan* pScanPlan;
+    struct ComputeDaemonPlanEntry planCache[COMPUTE_DAEMON_PLAN_CACHE_SIZE];
+    uint64_t planUseCounter;
+
+    uint32_t capacity;
+    VkBuffer srcBuffer;
+    VkDeviceMemory srcMemory;
+    VkBuffer dstBuffer;
+    VkDeviceMemory dstMemory;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    uint32_t* stagingPtr;
+
+    int listenSocket;
+    pthread_t acceptThread;
+    bool acceptThreadStarted;
+    volatile uint32_t stopping;
+    struct ComputeDaemonConnection connections[COMPUTE_DAEMON_MAX_CONNECTION_COUNT];
+    struct JobQueue* pQueue;
+
+    uint64_t latencies[COMPUTE_DAEMON_LATENCY_WINDOW];
+    uint64_t jobCount;
+    uint64_t failedJobCount;
+};
+
+static int CompareLatency(const void* a, const void* b)
+{
+    const uint64_t lhs = *(const uint64_t*)a;
+    const uint64_t rhs = *(const uint64_t*)b;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+// Sorts `latencies` and prints the percentiles in microseconds.
+static void PrintLatencyPercentiles(const char* title, uint64_t latencies[], uint32_t count)
+{
+    if (count == 0) return;
+
+    qsort(latencies, count, sizeof(latencies[0]), CompareLatency);
+    const double p50 = (double)latencies[(count - 1) * 50 / 100] / 1000.0;
+    const double p90 = (double)latencies[(count - 1) * 90 / 100] / 1000.0;
+    const double p99 = (double)latencies[(count - 1) * 99 / 100] / 1000.0;
+    const double maximum = (double)latencies[count - 1] / 1000.0;
+    printf("%-24s p50: %9.2f us, p90: %9.2f us, p99: %9.2f us, max: %9.2f us\n", title, p50, p90, p99, maximum);
+}
+
+// MARK: Warm state
+
+static void DestroyComputeDaemonPlans(struct ComputeDaemon* pDaemon)
+{
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_PLAN_CACHE_SIZE; i++)
+    {
+        DestroyElementwiseChainPlan(pDaemon->planCache[i].pPlan);
+        pDaemon->planCache[i].pPlan = NULL;
+    }
+    DestroyScanPlan(pDaemon->pScanPlan);
+    pDaemon->pScanPlan = NULL;
+}
+
+static void DestroyComputeDaemonBuffers(struct ComputeDaemon* pDaemon)
+{
+    DestroyComputeDaemonPlans(pDaemon);
+    if (pDaemon->stagingPtr != NULL) {
+        vkUnmapMemory(pDaemon->device, pDaemon->stagingMemory);
+    }
+    DestroyBufferWithMemory(pDaemon->device, pDaemon->stagingBuffer, pDaemon->stagingMemory);
+    DestroyBufferWithMemory(pDaemon->device, pDaemon->dstBuffer, pDaemon->dstMemory);
+    DestroyBufferWithMemory(pDaemon->device, pDaemon->srcBuffer, pDaemon->srcMemory);
+    pDaemon->stagingPtr = NULL;
+    pDaemon->stagingBuffer = VK_NULL_HANDLE;
+    pDaemon->stagingMemory = VK_NULL_HANDLE;
+    pDaemon->dstBuffer = VK_NULL_HANDLE;
+    pDaemon->dstMemory = VK_NULL_HANDLE;
+    pDaemon->srcBuffer = VK_NULL_HANDLE;
+    pDaemon->srcMemory = VK_NULL_HANDLE;
+    pDaemon->capacity = 0;
+}
+
+// Grows the warm buffers to hold `elemCount` elements. The plans bound to them are created again on demand.
+static VkResult ReserveComputeDaemonBuffers(struct ComputeDaemon* pDaemon, uint32_t elemCount)
+{
+    if (elemCount <= pDaemon->capacity) {
+        return VK_SUCCESS;
+    }
+
+    uint32_t capacity = pDaemon->capacity > 0 ? pDaemon->capacity : COMPUTE_DAEMON_INITIAL_ELEM_COUNT;
+    while (capacity < elemCount) {
+        capacity = capacity > UINT32_MAX / 2 ? elemCount : capacity * 2;
+    }
+    if ((uint64_t)capacity * sizeof(uint32_t) > pDaemon->pLimits->maxStorageBufferRange) {
+        capacity = elemCount;
+    }
+    if ((uint64_t)capacity * sizeof(uint32_t) > pDaemon->pLimits->maxStorageBufferRange) {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    DestroyComputeDaemonBuffers(pDaemon);
+
+    const VkDevice device = pDaemon->device;
+    const VkDeviceSize bufferSize = (VkDeviceSize)capacity * sizeof(uint32_t);
+    VkResult result = CreateBufferWithMemory(device, pDaemon->pMemoryProperties, bufferSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pDaemon->queueFamilyIndex,
+        &pDaemon->srcBuffer, &pDaemon->srcMemory);
+    if (result == VK_SUCCESS)
+    {
+        result = CreateBufferWithMemory(device, pDaemon->pMemoryProperties, bufferSize,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pDaemon->queueFamilyIndex,
+            &pDaemon->dstBuffer, &pDaemon->dstMemory);
+    }
+    if (result == VK_SUCCESS)
+    {
+        result = CreateBufferWithMemory(device, pDaemon->pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pDaemon->queueFamilyIndex,
+            &pDaemon->stagingBuffer, &pDaemon->stagingMemory);
+    }
+    if (result == VK_SUCCESS)
+    {
+        result = vkMapMemory(device, pDaemon->stagingMemory, 0, VK_WHOLE_SIZE, 0, (void**)&pDaemon->stagingPtr);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+        }
+    }
+    if (result == VK_SUCCESS)
+    {
+        result = CreateScanPlan(pDaemon->pScanContext, pDaemon->pMemoryProperties, pDaemon->queueFamilyIndex, capacity, pDaemon->srcBuffer,
+            pDaemon->dstBuffer, VK_NULL_HANDLE, &pDaemon->pScanPlan);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "CreateScanPlan failed!\n");
+        }
+    }
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "The warm buffers of %u elements cannot be created: %d\n", capacity, result);
+        DestroyComputeDaemonBuffers(pDaemon);
+        return result;
+    }
+
+    pDaemon->capacity = capacity;
+    return VK_SUCCESS;
+}
+
+// Returns the plan of `pChain` on the warm buffers, replacing the least recently used one of the cache if it is not there
+static struct ElementwiseChainPlan* FindComputeDaemonChainPlan(struct ComputeDaemon* pDaemon, const struct ElementwiseChain* pChain)
+{
+    struct ComputeDaemonPlanEntry* pVictim = &pDaemon->planCache[0];
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_PLAN_CACHE_SIZE; i++)
+    {
+        struct ComputeDaemonPlanEntry* const pEntry = &pDaemon->planCache[i];
+        if (pEntry->pPlan != NULL && pEntry->chain.opCount == pChain->opCount &&
+            memcmp(pEntry->chain.ops, pChain->ops, sizeof(pChain->ops[0]) * pChain->opCount) == 0 &&
+            memcmp(pEntry->chain.operands, pChain->operands, sizeof(pChain->operands[0]) * pChain->opCount) == 0)
+        {
+            pEntry->lastUse = ++pDaemon->planUseCounter;
+            return pEntry->pPlan;
+        }
+        if (pVictim->pPlan != NULL && (pEntry->pPlan == NULL || pEntry->lastUse < pVictim->lastUse)) {
+            pVictim = pEntry;
+        }
+    }
+
+    DestroyElementwiseChainPlan(pVictim->pPlan);
+    pVictim->pPlan = NULL;
+    if (CreateElementwiseChainPlan(pDaemon->pElementwiseContext, pChain, ELEMENTWISE_FUSION_AUTO, pDaemon->srcBuffer, pDaemon->dstBuffer,
+        &pVictim->pPlan) != VK_SUCCESS) {
+        return NULL;
+    }
+    pVictim->chain = *pChain;
+    pVictim->lastUse = ++pDaemon->planUseCounter;
+    return pVictim->pPlan;
+}
+
+static void DestroyComputeDaemonWarmState(struct ComputeDaemon* pDaemon)
+{
+    DestroyComputeDaemonBuffers(pDaemon);
+    DestroyScanContext(pDaemon->pScanContext);
+    DestroyElementwiseContext(pDaemon->pElementwiseContext);
+    if (pDaemon->fence != VK_NULL_HANDLE) {
+        ReleasePooledFence(pDaemon->pFencePool, pDaemon->fence);
+    }
+    if (pDaemon->commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(pDaemon->device, pDaemon->commandPool, 1, &pDaemon->commandBuffer);
+        vkDestroyCommandPool(pDaemon->device, pDaemon->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+}
+
+// Everything a job needs but its data: the pipelines, the buffers, the command buffer and the fence
+static VkResult CreateComputeDaemonWarmState(struct ComputeDaemon* pDaemon, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    const VkDevice device = pDaemon->device;
+    vkGetDeviceQueue(device, pDaemon->queueFamilyIndex, 0, &pDaemon->queue);
+
+    VkResult result = InitializeCommandBuffer(pDaemon->queueFamilyIndex, device, &pDaemon->commandPool, &pDaemon->commandBuffer, 1);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "InitializeCommandBuffer failed!\n");
+        return result;
+    }
+
+    // The daemon runs on the selected device, whose shared pool hands out the fence
+    pDaemon->pFencePool = GetSharedFencePool();
+    if (pDaemon->pFencePool == NULL || GetFencePoolDevice(pDaemon->pFencePool) != device)
+    {
+        fprintf(stderr, "The shared fence pool does not belong to the device of the daemon!\n");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    result = AcquirePooledFence(pDaemon->pFencePool, &pDaemon->fence);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
+        return result;
+    }
+
+    result = CreateElementwiseContext(device, pDaemon->pLimits, &pDaemon->pElementwiseContext);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateElementwiseContext failed!\n");
+        return result;
+    }
+    result = CreateScanContext(device, pDaemon->pLimits, pSubgroupProperties, &pDaemon->pScanContext);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateScanContext failed!\n");
+        return result;
+    }
+
+    return ReserveComputeDaemonBuffers(pDaemon, COMPUTE_DAEMON_INITIAL_ELEM_COUNT);
+}
+
+// MARK: Jobs
+
+static VkResult SubmitComputeDaemonCommandBuffer(struct ComputeDaemon* pDaemon)
+{
+    VkResult result = vkEndCommandBuffer(pDaemon->commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+        return result;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pDaemon->commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    // A failed wait may have left the daemon without a fence
+    if (pDaemon->fence == VK_NULL_HANDLE)
+    {
+        result = AcquirePooledFence(pDaemon->pFencePool, &pDaemon->fence);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
+            return result;
+        }
+    }
+    result = vkQueueSubmit(pDaemon->queue, 1, &submitInfo, pDaemon->fence);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+        return result;
+    }
+    result = vkWaitForFences(pDaemon->device, 1, &pDaemon->fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+        ReplacePooledFence(pDaemon->pFencePool, &pDaemon->fence);
+        return result;
+    }
+    // The fence is reused by the next job rather than acquired again
+    vkResetFences(pDaemon->device, 1, &pDaemon->fence);
+    return result;
+}
+
+static int FindComputeDaemonKernel(const char kernelName[COMPUTE_DAEMON_MAX_KERNEL_NAME_LENGTH])
+{
+    for (int i = 0; i < COMPUTE_DAEMON_KERNEL_COUNT; i++)
+    {
+        if (strncmp(kernelName, s_kernelNames[i], COMPUTE_DAEMON_MAX_KERNEL_NAME_LENGTH) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static VkResult ExecuteComputeDaemonJob(struct ComputeDaemon* pDaemon, const struct ComputeDaemonJob* pJob)
+{
+    const struct ComputeDaemonRequest* pRequest = &pJob->request;
+    const uint32_t elemCount = pRequest->elemCount;
+    const size_t dataSize = (size_t)elemCount * sizeof(uint32_t);
+
+    const int kernel = FindComputeDaemonKernel(pRequest->kernelName);
+    if (kernel < 0 || elemCount == 0 || pJob->segmentFd < 0 || pRequest->segmentSize < dataSize ||
+        (kernel == COMPUTE_DAEMON_KERNEL_ELEMENTWISE_CHAIN && (pRequest->chain.opCount == 0 || pRequest->chain.opCount > ELEMENTWISE_MAX_CHAIN_LENGTH))) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    // A segment shorter than the request claims would fault on access rather than fail here
+    struct stat segmentStat;
+    if (fstat(pJob->segmentFd, &segmentStat) != 0 || (uint64_t)segmentStat.st_size < pRequest->segmentSize) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    VkResult result = ReserveComputeDaemonBuffers(pDaemon, elemCount);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    struct ElementwiseChainPlan* pChainPlan = NULL;
+    if (kernel == COMPUTE_DAEMON_KERNEL_ELEMENTWISE_CHAIN)
+    {
+        pChainPlan = FindComputeDaemonChainPlan(pDaemon, &pRequest->chain);
+        if (pChainPlan == NULL) {
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
+    uint32_t* segment = mmap(NULL, (size_t)pRequest->segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, pJob->segmentFd, 0);
+    if (segment == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap failed: %d\n", errno);
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+
+    do
+    {
+        memcpy(pDaemon->stagingPtr, segment, dataSize);
+
+        result = BeginOneTimeCommandBuffer(pDaemon->device, pDaemon->commandPool, pDaemon->commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const VkCommandBuffer commandBuffer = pDaemon->commandBuffer;
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = dataSize };
+        vkCmdCopyBuffer(commandBuffer, pDaemon->stagingBuffer, pDaemon->srcBuffer, 1, &copyRegion);
+        RecordTransferToComputeBarrier(commandBuffer);
+        if (pChainPlan != NULL) {
+            RecordElementwiseChain(commandBuffer, pChainPlan, elemCount);
+        }
+        else {
+            RecordScan(commandBuffer, pDaemon->pScanPlan, elemCount, kernel == COMPUTE_DAEMON_KERNEL_INCLUSIVE_SCAN);
+        }
+        RecordComputeToTransferBarrier(commandBuffer);
+        vkCmdCopyBuffer(commandBuffer, pDaemon->dstBuffer, pDaemon->stagingBuffer, 1, &copyRegion);
+
+        result = SubmitComputeDaemonCommandBuffer(pDaemon);
+        if (result != VK_SUCCESS) break;
+
+        memcpy(segment, pDaemon->stagingPtr, dataSize);
+    } while (false);
+
+    munmap(segment, (size_t)pRequest->segmentSize);
+    return result;
+}
+
+// Runs the job, replies to its connection and frees it
+static void CompleteComputeDaemonJob(struct ComputeDaemon* pDaemon, struct ComputeDaemonJob* pJob)
+{
+    const uint64_t dequeueTime = HostGetTimeNanoseconds();
+    struct ComputeDaemonReply reply = {
+        .magic = COMPUTE_DAEMON_MESSAGE_MAGIC,
+        .result = VK_SUCCESS,
+        .tag = pJob->request.tag,
+        .queueTime = dequeueTime - pJob->receiveTime
+    };
+    if (pJob->request.kind == COMPUTE_DAEMON_REQUEST_JOB)
+    {
+        reply.result = ExecuteComputeDaemonJob(pDaemon, pJob);
+        reply.executeTime = HostGetTimeNanoseconds() - dequeueTime;
+        reply.totalTime = HostGetTimeNanoseconds() - pJob->receiveTime;
+
+        if (reply.result == VK_SUCCESS) {
+            pDaemon->latencies[pDaemon->jobCount++ % COMPUTE_DAEMON_LATENCY_WINDOW] = reply.totalTime;
+        }
+        else {
+            pDaemon->failedJobCount++;
+        }
+    }
+
+    struct ComputeDaemonConnection* const pConnection = pJob->pConnection;
+    SendExternalMemoryMessage(pConnection->socket, &reply, sizeof(reply), NULL, 0);
+    if (pJob->segmentFd >= 0) {
+        close(pJob->segmentFd);
+    }
+    const bool served = pJob->request.kind == COMPUTE_DAEMON_REQUEST_JOB && reply.result == VK_SUCCESS;
+    free(pJob);
+    HostAtomicFetchAddUInt32(&pConnection->pendingJobCount, UINT32_MAX);
+
+    if (served && pDaemon->jobCount % COMPUTE_DAEMON_REPORT_INTERVAL == 0)
+    {
+        // Sorted in a copy, since the window keeps the order of the jobs
+        static uint64_t latencies[COMPUTE_DAEMON_LATENCY_WINDOW];
+        const uint32_t count = pDaemon->jobCount < COMPUTE_DAEMON_LATENCY_WINDOW ? (uint32_t)pDaemon->jobCount : COMPUTE_DAEMON_LATENCY_WINDOW;
+        memcpy(latencies, pDaemon->latencies, sizeof(latencies[0]) * count);
+        printf("Compute daemon: %llu jobs served.\n", (unsigned long long)pDaemon->jobCount);
+        PrintLatencyPercentiles("Last jobs", latencies, count);
+        fflush(stdout);
+    }
+}
+
+// MARK: Connections
+
+static void* ComputeDaemonConnectionThreadProc(void* param)
+{
+    struct ComputeDaemonConnection* const pConnection = param;
+    struct ComputeDaemon* const pDaemon = pConnection->pDaemon;
+
+    for (;;)
+    {
+        struct ComputeDaemonJob* pJob = malloc(sizeof(*pJob));
+        if (pJob == NULL) break;
+
+        int fd = -1;
+        uint32_t fdCount = 0;
+        if (!ReceiveExternalMemoryMessage(pConnection->socket, &pJob->request, sizeof(pJob->request), &fd, 1, &fdCount) ||
+            pJob->request.magic != COMPUTE_DAEMON_MESSAGE_MAGIC)
+        {
+            if (fdCount > 0) {
+                close(fd);
+            }
+            free(pJob);
+            break;
+        }
+        pJob->receiveTime = HostGetTimeNanoseconds();
+        pJob->pConnection = pConnection;
+        pJob->segmentFd = fdCount > 0 ? fd : -1;
+
+        // Even the malformed requests go through the queue, so that only the device thread writes the replies
+        HostAtomicFetchAddUInt32(&pConnection->pendingJobCount, 1);
+        PushJobQueueNode(pDaemon->pQueue, &pJob->node);
+    }
+
+    HostAtomicStoreUInt32(&pConnection->finished, 1);
+    return NULL;
+}
+
+// Joins the connections whose thread has finished and whose jobs are done, and frees their slots
+static void ReapComputeDaemonConnections(struct ComputeDaemon* pDaemon)
+{
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_MAX_CONNECTION_COUNT; i++)
+    {
+        struct ComputeDaemonConnection* const pConnection = &pDaemon->connections[i];
+        if (!pConnection->inUse || HostAtomicLoadUInt32(&pConnection->finished) == 0 ||
+            HostAtomicLoadUInt32(&pConnection->pendingJobCount) != 0) continue;
+
+        pthread_join(pConnection->thread, NULL);
+        close(pConnection->socket);
+        pConnection->inUse = false;
+    }
+}
+
+static void* ComputeDaemonAcceptThreadProc(void* param)
+{
+    struct ComputeDaemon* const pDaemon = param;
+
+    while (HostAtomicLoadUInt32(&pDaemon->stopping) == 0)
+    {
+        ReapComputeDaemonConnections(pDaemon);
+
+        struct pollfd pollFd = { .fd = pDaemon->listenSocket, .events = POLLIN, .revents = 0 };
+        if (poll(&pollFd, 1, COMPUTE_DAEMON_POLL_INTERVAL_MILLISECONDS) <= 0) continue;
+
+        const int socket = accept(pDaemon->listenSocket, NULL, NULL);
+        if (socket < 0) continue;
+
+        struct ComputeDaemonConnection* pConnection = NULL;
+        for (uint32_t i = 0; i < COMPUTE_DAEMON_MAX_CONNECTION_COUNT && pConnection == NULL; i++)
+        {
+            if (!pDaemon->connections[i].inUse) {
+                pConnection = &pDaemon->connections[i];
+            }
+        }
+        if (pConnection == NULL)
+        {
+            fprintf(stderr, "The compute daemon has no room for another connection!\n");
+            close(socket);
+            continue;
+        }
+
+        pConnection->pDaemon = pDaemon;
+        pConnection->socket = socket;
+        pConnection->pendingJobCount = 0;
+        pConnection->finished = 0;
+        if (pthread_create(&pConnection->thread, NULL, ComputeDaemonConnectionThreadProc, pConnection) != 0)
+        {
+            fprintf(stderr, "Failed to create the thread of a connection!\n");
+            close(socket);
+            continue;
+        }
+        pConnection->inUse = true;
+    }
+
+    // The connection threads stop receiving, while their sockets stay open for the replies of the jobs that are left
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_MAX_CONNECTION_COUNT; i++)
+    {
+        if (pDaemon->connections[i].inUse) {
+            shutdown(pDaemon->connections[i].socket, SHUT_RD);
+        }
+    }
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_MAX_CONNECTION_COUNT; i++)
+    {
+        if (pDaemon->connections[i].inUse) {
+            pthread_join(pDaemon->connections[i].thread, NULL);
+        }
+    }
+    return NULL;
+}
+
+static int CreateComputeDaemonListenSocket(const char* socketPath)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(socketPath) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "The socket path is too long: %s\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    const int listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenSocket < 0)
+    {
+        fprintf(stderr, "socket failed: %d\n", errno);
+        return -1;
+    }
+    // A socket left behind by a daemon that did not exit cleanly
+    unlink(socketPath);
+    if (bind(listenSocket, (const struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenSocket, COMPUTE_DAEMON_LISTEN_BACKLOG) != 0)
+    {
+        fprintf(stderr, "Failed to listen on %s: %d\n", socketPath, errno);
+        close(listenSocket);
+        return -1;
+    }
+    return listenSocket;
+}
+
+int RunComputeDaemon(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, const char* socketPath,
+    uint32_t maxJobCount)
+{
+    struct ComputeDaemon* pDaemon = calloc(1, sizeof(*pDaemon));
+    if (pDaemon == NULL) {
+        return 1;
+    }
+    pDaemon->device = device;
+    pDaemon->pMemoryProperties = pMemoryProperties;
+    pDaemon->queueFamilyIndex = queueFamilyIndex;
+    pDaemon->pLimits = pLimits;
+    pDaemon->listenSocket = -1;
+
+    int exitCode = 1;
+    do
+    {
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        if (CreateComputeDaemonWarmState(pDaemon, pSubgroupProperties) != VK_SUCCESS) break;
+        const uint64_t warmUpTime = HostGetTimeNanoseconds() - beginTime;
+
+        pDaemon->pQueue = CreateJobQueue();
+        if (pDaemon->pQueue == NULL) break;
+
+        pDaemon->listenSocket = CreateComputeDaemonListenSocket(socketPath);
+        if (pDaemon->listenSocket < 0) break;
+        if (pthread_create(&pDaemon->acceptThread, NULL, ComputeDaemonAcceptThreadProc, pDaemon) != 0)
+        {
+            fprintf(stderr, "Failed to create the accepting thread!\n");
+            break;
+        }
+        pDaemon->acceptThreadStarted = true;
+
+        printf("Compute daemon: listening on %s, warmed up in %.3f ms with buffers of %u elements.\n", socketPath,
+            (double)warmUpTime / 1000000.0, pDaemon->capacity);
+        fflush(stdout);
+
+        bool shutdownRequested = false;
+        while (!shutdownRequested && (maxJobCount == 0 || pDaemon->jobCount + pDaemon->failedJobCount < maxJobCount))
+        {
+            struct JobQueueNode* pNode = WaitJobQueueNode(pDaemon->pQueue, (uint64_t)COMPUTE_DAEMON_POLL_INTERVAL_MILLISECONDS * 1000000U);
+            if (pNode == NULL) continue;
+
+            struct ComputeDaemonJob* const pJob = (struct ComputeDaemonJob*)pNode;
+            shutdownRequested = pJob->request.kind == COMPUTE_DAEMON_REQUEST_SHUTDOWN;
+            CompleteComputeDaemonJob(pDaemon, pJob);
+        }
+        exitCode = 0;
+    } while (false);
+
+    HostAtomicStoreUInt32(&pDaemon->stopping, 1);
+    if (pDaemon->acceptThreadStarted) {
+        pthread_join(pDaemon->acceptThread, NULL);
+    }
+    // No connection pushes any more. The jobs received before the shutdown still get their replies.
+    if (pDaemon->pQueue != NULL)
+    {
+        struct JobQueueNode* pNode;
+        while ((pNode = PopJobQueueNode(pDaemon->pQueue)) != NULL) {
+            CompleteComputeDaemonJob(pDaemon, (struct ComputeDaemonJob*)pNode);
+        }
+    }
+    // The connection threads have been joined by the accepting thread
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_MAX_CONNECTION_COUNT; i++)
+    {
+        if (pDaemon->connections[i].inUse) {
+            close(pDaemon->connections[i].socket);
+        }
+    }
+    if (pDaemon->listenSocket >= 0)
+    {
+        close(pDaemon->listenSocket);
+        unlink(socketPath);
+    }
+
+    if (pDaemon->jobCount > 0)
+    {
+        const uint32_t count = pDaemon->jobCount < COMPUTE_DAEMON_LATENCY_WINDOW ? (uint32_t)pDaemon->jobCount : COMPUTE_DAEMON_LATENCY_WINDOW;
+        printf("Compute daemon: %llu jobs served, %llu failed. The consumer parked %llu times.\n", (unsigned long long)pDaemon->jobCount,
+            (unsigned long long)pDaemon->failedJobCount, (unsigned long long)GetJobQueueParkCount(pDaemon->pQueue));
+        PrintLatencyPercentiles("Daemon job latency", pDaemon->latencies, count);
+    }
+
+    DestroyJobQueue(pDaemon->pQueue);
+    DestroyComputeDaemonWarmState(pDaemon);
+    free(pDaemon);
+    return exitCode;
+}
+
+// MARK: Client
+
+struct ComputeDaemonClient
+{
+    int socket;
+    int segmentFd;
+    uint32_t* segment;
+    size_t segmentSize;
+    uint64_t nextTag;
+};
+
+static volatile uint32_t s_segmentCounter = 0;
+
+bool ConnectComputeDaemon(const char* socketPath, struct ComputeDaemonClient** ppClient)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        return false;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    struct ComputeDaemonClient* pClient = calloc(1, sizeof(*pClient));
+    if (pClient == NULL) {
+        return false;
+    }
+    pClient->segmentFd = -1;
+
+    pClient->socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (pClient->socket < 0 || connect(pClient->socket, (const struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        if (pClient->socket >= 0) {
+            close(pClient->socket);
+        }
+        free(pClient);
+        return false;
+    }
+
+    *ppClient = pClient;
+    return true;
+}
+
+void DisconnectComputeDaemon(struct ComputeDaemonClient* pClient)
+{
+    if (pClient == NULL) {
+        return;
+    }
+
+    if (pClient->segment != NULL) {
+        munmap(pClient->segment, pClient->segmentSize);
+    }
+    if (pClient->segmentFd >= 0) {
+        close(pClient->segmentFd);
+    }
+    close(pClient->socket);
+    free(pClient);
+}
+
+uint32_t* GetComputeDaemonClientData(struct ComputeDaemonClient* pClient, uint32_t elemCount)
+{
+    const size_t size = (size_t)elemCount * sizeof(uint32_t);
+    if (size <= pClient->segmentSize) {
+        return pClient->segment;
+    }
+
+    if (pClient->segmentFd < 0)
+    {
+        // An anonymous segment: the name is removed as soon as it is created, and the fd is all that refers to it
+        char name[64];
+        snprintf(name, sizeof(name), "/vulkancl-daemon-%d-%u", (int)getpid(), HostAtomicFetchAddUInt32(&s_segmentCounter, 1));
+        pClient->segmentFd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if (pClient->segmentFd < 0)
+        {
+            fprintf(stderr, "shm_open failed: %d\n", errno);
+            return NULL;
+        }
+        shm_unlink(name);
+        fcntl(pClient->segmentFd, F_SETFD, FD_CLOEXEC);
+    }
+
+    if (pClient->segment != NULL)
+    {
+        munmap(pClient->segment, pClient->segmentSize);
+        pClient->segment = NULL;
+        pClient->segmentSize = 0;
+    }
+    if (ftruncate(pClient->segmentFd, (off_t)size) != 0)
+    {
+        fprintf(stderr, "ftruncate failed: %d\n", errno);
+        return NULL;
+    }
+    void* segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, pClient->segmentFd, 0);
+    if (segment == MAP_FAILED)
+    {
+        fprintf(stderr, "mmap failed: %d\n", errno);
+        return NULL;
+    }
+    pClient->segment = segment;
+    pClient->segmentSize = size;
+    return pClient->segment;
+}
+
+static VkResult SendComputeDaemonRequest(struct ComputeDaemonClient* pClient, struct ComputeDaemonRequest* pRequest, struct ComputeDaemonReply* pReply)
+{
+    pRequest->magic = COMPUTE_DAEMON_MESSAGE_MAGIC;
+    pRequest->tag = pClient->nextTag++;
+    pRequest->segmentSize = pClient->segmentSize;
+
+    const int fds[1] = { pClient->segmentFd };
+    if (!SendExternalMemoryMessage(pClient->socket, pRequest, sizeof(*pRequest), fds, pClient->segmentFd >= 0 ? 1 : 0)) {
+        return VK_ERROR_DEVICE_LOST;
+    }
+    uint32_t fdCount = 0;
+    if (!ReceiveExternalMemoryMessage(pClient->socket, pReply, sizeof(*pReply), NULL, 0, &fdCount) ||
+        pReply->magic != COMPUTE_DAEMON_MESSAGE_MAGIC || pReply->tag != pRequest->tag) {
+        return VK_ERROR_DEVICE_LOST;
+    }
+    return (VkResult)pReply->result;
+}
+
+VkResult RunComputeDaemonJob(struct ComputeDaemonClient* pClient, const char* kernelName, const struct ElementwiseChain* pChain,
+    uint32_t elemCount, struct ComputeDaemonJobTimes* pTimes)
+{
+    if (strlen(kernelName) >= COMPUTE_DAEMON_MAX_KERNEL_NAME_LENGTH || (size_t)elemCount * sizeof(uint32_t) > pClient->segmentSize) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct ComputeDaemonRequest request = {
+        .kind = COMPUTE_DAEMON_REQUEST_JOB,
+        .elemCount = elemCount
+    };
+    strcpy(request.kernelName, kernelName);
+    if (pChain != NULL) {
+        request.chain = *pChain;
+    }
+
+    struct ComputeDaemonReply reply = { 0 };
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    const VkResult result = SendComputeDaemonRequest(pClient, &request, &reply);
+    if (pTimes != NULL)
+    {
+        pTimes->roundTripTime = HostGetTimeNanoseconds() - beginTime;
+        pTimes->queueTime = reply.queueTime;
+        pTimes->executeTime = reply.executeTime;
+        pTimes->totalTime = reply.totalTime;
+    }
+    return result;
+}
+
+VkResult RequestComputeDaemonShutdown(struct ComputeDaemonClient* pClient)
+{
+    struct ComputeDaemonRequest request = { .kind = COMPUTE_DAEMON_REQUEST_SHUTDOWN };
+    struct ComputeDaemonReply reply = { 0 };
+    return SendComputeDaemonRequest(pClient, &request, &reply);
+}
+
+// MARK: Test
+
+struct ComputeDaemonClientThread
+{
+    const char* socketPath;
+    uint32_t clientIndex;
+    pthread_t thread;
+    // COMPUTE_DAEMON_TEST_JOB_COUNT entries
+    uint64_t* roundTripTimes;
+    uint64_t* daemonTimes;
+    uint32_t completedJobCount;
+    bool verified;
+};
+
+static bool VerifyComputeDaemonJob(int kernel, const struct ElementwiseChain* pChain, const uint32_t* data, uint32_t elemCount, uint32_t seed)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        const uint32_t src = seed + i;
+        uint32_t expected;
+        switch (kernel)
+        {
+        case COMPUTE_DAEMON_KERNEL_ELEMENTWISE_CHAIN:
+            expected = ApplyElementwiseChainOnHost(pChain, src);
+            break;
+        case COMPUTE_DAEMON_KERNEL_INCLUSIVE_SCAN:
+            sum += src;
+            expected = sum;
+            break;
+        default:
+            expected = sum;
+            sum += src;
+            break;
+        }
+        if (data[i] != expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the jobs of one client one after another, cycling through the kernels and a few sizes
+static void* ComputeDaemonClientThreadProc(void* param)
+{
+    struct ComputeDaemonClientThread* const pThread = param;
+    pThread->verified = true;
+
+    struct ComputeDaemonClient* pClient = NULL;
+    if (!ConnectComputeDaemon(pThread->socketPath, &pClient))
+    {
+        fprintf(stderr, "Client %u failed to connect to %s!\n", pThread->clientIndex, pThread->socketPath);
+        pThread->verified = false;
+        return NULL;
+    }
+
+    const struct ElementwiseChain chain = {
+        2, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_ADD }, { 3, pThread->clientIndex + 1 }
+    };
+    for (uint32_t j = 0; j < COMPUTE_DAEMON_TEST_JOB_COUNT; j++)
+    {
+        const int kernel = (int)((j + pThread->clientIndex) % COMPUTE_DAEMON_KERNEL_COUNT);
+        const uint32_t elemCount = COMPUTE_DAEMON_TEST_BASE_ELEM_COUNT << (j % 4);
+        uint32_t* data = GetComputeDaemonClientData(pClient, elemCount);
+        if (data == NULL)
+        {
+            pThread->verified = false;
+            break;
+        }
+        const uint32_t seed = pThread->clientIndex * 1000U + j;
+        for (uint32_t i = 0; i < elemCount; i++) {
+            data[i] = seed + i;
+        }
+
+        struct ComputeDaemonJobTimes times;
+        const VkResult result = RunComputeDaemonJob(pClient, s_kernelNames[kernel], &chain, elemCount, &times);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Client %u: the job failed: %d\n", pThread->clientIndex, result);
+            pThread->verified = false;
+            break;
+        }
+        pThread->roundTripTimes[pThread->completedJobCount] = times.roundTripTime;
+        pThread->daemonTimes[pThread->completedJobCount] = times.totalTime;
+        pThread->completedJobCount++;
+        if (!VerifyComputeDaemonJob(kernel, &chain, data, elemCount, seed)) {
+            pThread->verified = false;
+        }
+    }
+
+    DisconnectComputeDaemon(pClient);
+    return NULL;
+}
+
+// Waits until the daemon accepts connections, by connecting and disconnecting
+static bool WaitComputeDaemonReady(const char* socketPath)
+{
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    while (HostGetTimeNanoseconds() - beginTime < (uint64_t)COMPUTE_DAEMON_CONNECT_TIMEOUT_MILLISECONDS * 1000000U)
+    {
+        struct ComputeDaemonClient* pClient = NULL;
+        if (ConnectComputeDaemon(socketPath, &pClient))
+        {
+            DisconnectComputeDaemon(pClient);
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+// Runs the client threads against the daemon of `socketPath` and prints their latencies
+static bool RunComputeDaemonClientThreads(const char* socketPath)
+{
+    struct ComputeDaemonClientThread threads[COMPUTE_DAEMON_TEST_CLIENT_COUNT];
+    const uint32_t totalJobCount = COMPUTE_DAEMON_TEST_CLIENT_COUNT * COMPUTE_DAEMON_TEST_JOB_COUNT;
+    uint64_t* roundTripTimes = calloc(totalJobCount, sizeof(uint64_t));
+    uint64_t* daemonTimes = calloc(totalJobCount, sizeof(uint64_t));
+    if (roundTripTimes == NULL || daemonTimes == NULL)
+    {
+        free(roundTripTimes);
+        free(daemonTimes);
+        return false;
+    }
+
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    uint32_t startedCount = 0;
+    for (uint32_t i = 0; i < COMPUTE_DAEMON_TEST_CLIENT_COUNT; i++)
+    {
+        threads[i] = (struct ComputeDaemonClientThread) {
+            .socketPath = socketPath,
+            .clientIndex = i,
+            .roundTripTimes = roundTripTimes + (size_t)i * COMPUTE_DAEMON_TEST_JOB_COUNT,
+            .daemonTimes = daemonTimes + (size_t)i * COMPUTE_DAEMON_TEST_JOB_COUNT
+        };
+        if (pthread_create(&threads[i].thread, NULL, ComputeDaemonClientThreadProc, &threads[i]) != 0)
+        {
+            fprintf(stderr, "Failed to create client thread %u!\n", i);
+            break;
+        }
+        startedCount++;
+    }
+
+    bool verified = startedCount == COMPUTE_DAEMON_TEST_CLIENT_COUNT;
+    uint32_t completedCount = 0;
+    for (uint32_t i = 0; i < startedCount; i++)
+    {
+        pthread_join(threads[i].thread, NULL);
+        verified = verified && threads[i].verified && threads[i].completedJobCount == COMPUTE_DAEMON_TEST_JOB_COUNT;
+        // Packs the latencies of the completed jobs
+        memmove(roundTripTimes + completedCount, threads[i].roundTripTimes, threads[i].completedJobCount * sizeof(uint64_t));
+        memmove(daemonTimes + completedCount, threads[i].daemonTimes, threads[i].completedJobCount * sizeof(uint64_t));
+        completedCount += threads[i].completedJobCount;
+    }
+    const double milliseconds = (double)(HostGetTimeNanoseconds() - beginTime) / 1000000.0;
+
+    printf("%u clients, %u jobs of %u ~ %u elements in %.3f ms, %.0f jobs/s (%s)\n", startedCount, completedCount,
+        COMPUTE_DAEMON_TEST_BASE_ELEM_COUNT, COMPUTE_DAEMON_TEST_BASE_ELEM_COUNT << 3, milliseconds, (double)completedCount * 1000.0 / milliseconds,
+        verified ? "verify OK" : "verify FAILED");
+    PrintLatencyPercentiles("Client round trip", roundTripTimes, completedCount);
+    PrintLatencyPercentiles("In the daemon", daemonTimes, completedCount);
+
+    free(roundTripTimes);
+    free(daemonTimes);
+    return verified;
+}
+
+int RunComputeDaemonClient(const char* socketPath, bool shutdown)
+{
+    puts("\n================ Begin compute daemon client ================\n");
+
+    bool succeeded = false;
+    do
+    {
+        struct ComputeDaemonClient* pClient = NULL;
+        if (!ConnectComputeDaemon(socketPath, &pClient))
+        {
+            fprintf(stderr, "No compute daemon listens on %s!\n", socketPath);
+            break;
+        }
+        DisconnectComputeDaemon(pClient);
+
+        succeeded = RunComputeDaemonClientThreads(socketPath);
+
+        if (shutdown && ConnectComputeDaemon(socketPath, &pClient))
+        {
+            RequestComputeDaemonShutdown(pClient);
+            DisconnectComputeDaemon(pClient);
+        }
+    } while (false);
+
+    puts("\n================ Complete compute daemon client ================\n");
+    return succeeded ? 0 : 1;
+}
+
+struct ComputeDaemonTestThread
+{
+    VkDevice device;
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties;
+    uint32_t queueFamilyIndex;
+    const VkPhysicalDeviceLimits* pLimits;
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties;
+    const char* socketPath;
+    int exitCode;
+};
+
+static void* ComputeDaemonTestThreadProc(void* param)
+{
+    struct ComputeDaemonTestThread* const pThread = param;
+    pThread->exitCode = RunComputeDaemon(pThread->device, pThread->pMemoryProperties, pThread->queueFamilyIndex, pThread->pLimits,
+        pThread->pSubgroupProperties, pThread->socketPath, 0);
+    return NULL;
+}
+
+void ComputeDaemonComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    puts("\n================ Begin compute daemon test ================\n");
+
+    char socketPath[64];
+    snprintf(socketPath, sizeof(socketPath), "/tmp/vulkancl-daemon-test-%d.sock", (int)getpid());
+
+    struct ComputeDaemonTestThread daemonThread = {
+        .device = specDevice,
+        .pMemoryProperties = pMemoryProperties,
+        .queueFamilyIndex = specQueueFamilyIndex,
+        .pLimits = pLimits,
+        .pSubgroupProperties = pSubgroupProperties,
+        .socketPath = socketPath,
+        .exitCode = 1
+    };
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, ComputeDaemonTestThreadProc, &daemonThread) == 0)
+    {
+        // The daemon thread uses the queue of the device alone until it is joined
+        if (WaitComputeDaemonReady(socketPath)) {
+            RunComputeDaemonClientThreads(socketPath);
+        }
+        else {
+            fprintf(stderr, "The compute daemon did not start!\n");
+        }
+
+        struct ComputeDaemonClient* pClient = NULL;
+        if (ConnectComputeDaemon(socketPath, &pClient))
+        {
+            RequestComputeDaemonShutdown(pClient);
+            DisconnectComputeDaemon(pClient);
+        }
+        pthread_join(thread, NULL);
+        printf("The compute daemon exited with %d.\n", daemonThread.exitCode);
+    }
+    else {
+        fprintf(stderr, "Failed to create the daemon thread!\n");
+    }
+
+    puts("\n================ Complete compute daemon test ================\n");
+}
+
+#else
+
+int RunComputeDaemon(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, const char* socketPath,
+    uint32_t maxJobCount)
+{
+    fprintf(stderr, "--daemon is POSIX only!\n");
+    return 1;
+}
+
+int RunComputeDaemonClient(const char* socketPath, bool shutdown)
+{
+    fprintf(stderr, "--daemon-client is POSIX only!\n");
+    return 1;
+}
+
+void ComputeDaemonComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    puts("\n================ Begin compute daemon test ================\n");
+    puts("The Unix domain sockets and the shared memory segments of the compute daemon are POSIX only. The test will be skipped.");
+    puts("\n================ Complete compute daemon test ================\n");
+}
+
+#endif // !_WIN32
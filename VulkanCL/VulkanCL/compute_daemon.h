@@ -0,0 +1,86 @@
+#ifndef COMPUTE_DAEMON_H
+#define COMPUTE_DAEMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct ElementwiseChain;
+
+// A long-running compute server on a Unix domain socket, which pays the layer and extension enumeration, the instance and device creation
+// and the pipeline compilation once instead of on every run.
+// It keeps the pipelines of the kernels, their plans, the device and staging buffers, a command buffer and a fence warm, and serves the jobs
+// of any number of local clients. A job names a kernel and passes its data in a shared memory segment of the client, whose fd goes over
+// the socket as SCM_RIGHTS. The daemon reads the source elements from the segment and writes the results back in place.
+//
+// Every connection has a thread of its own that receives the requests and pushes them into a lock-free MPSC queue (job_queue.h),
+// from which the single device thread takes them in order, runs them and replies with the latency of the job.
+// The device thread prints the latency percentiles of the jobs periodically and when it exits.
+//
+// The kernels are:
+//   "elementwise_chain"   dst[i] = chain(src[i]) with the chain of the request (elementwise_fusion.h)
+//   "inclusive_scan"      the inclusive prefix sum (scan.h)
+//   "exclusive_scan"      the exclusive prefix sum
+//
+// The sockets and the segments are POSIX only.
+
+#define COMPUTE_DAEMON_DEFAULT_SOCKET_PATH  "/tmp/vulkancl-daemon.sock"
+
+enum
+{
+    COMPUTE_DAEMON_MAX_KERNEL_NAME_LENGTH = 32
+};
+
+// The times of a job as the daemon measures them, from the receipt of the request
+struct ComputeDaemonJobTimes
+{
+    // Waiting in the queue
+    uint64_t queueTime;
+    // Copying in and out of the segment, and running on the device
+    uint64_t executeTime;
+    // Until the reply is sent
+    uint64_t totalTime;
+    // The round trip as the client measures it, including the socket
+    uint64_t roundTripTime;
+};
+
+// Initializes the warm state and serves the jobs until a client requests the shutdown, or `maxJobCount` jobs have been served
+// if it is not 0. Returns the exit code of the process.
+extern int RunComputeDaemon(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, const char* socketPath,
+    uint32_t maxJobCount);
+
+#ifndef _WIN32
+
+struct ComputeDaemonClient;
+
+extern bool ConnectComputeDaemon(const char* socketPath, struct ComputeDaemonClient** ppClient);
+extern void DisconnectComputeDaemon(struct ComputeDaemonClient* pClient);
+
+// The shared memory segment of the client, which holds at least `elemCount` elements. It is grown when needed, which moves it.
+// Returns NULL if it cannot be grown.
+extern uint32_t* GetComputeDaemonClientData(struct ComputeDaemonClient* pClient, uint32_t elemCount);
+
+// Runs `kernelName` on the first `elemCount` elements of the segment in place and waits for the reply.
+// @param pChain: the chain of "elementwise_chain". It may be NULL for the other kernels.
+// @param pTimes: receives the times of the job. It may be NULL.
+extern VkResult RunComputeDaemonJob(struct ComputeDaemonClient* pClient, const char* kernelName, const struct ElementwiseChain* pChain,
+    uint32_t elemCount, struct ComputeDaemonJobTimes* pTimes);
+
+// Asks the daemon to exit after the jobs it has received
+extern VkResult RequestComputeDaemonShutdown(struct ComputeDaemonClient* pClient);
+
+#endif // !_WIN32
+
+// The client mode of the program, started with --daemon-client[=<socket path>]. Measures the per-job latency of a running daemon
+// from several client threads, and returns the exit code of the process.
+// @param shutdown: whether the daemon is asked to exit afterwards
+extern int RunComputeDaemonClient(const char* socketPath, bool shutdown);
+
+// Starts the daemon on a thread of this process, and measures its per-job latency against its warm-up time
+extern void ComputeDaemonComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties);
+
+#endif // !COMPUTE_DAEMON_H
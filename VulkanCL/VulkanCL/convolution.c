@@ -0,0 +1,737 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+
+#define _USE_MATH_DEFINES
+
+#endif // _WIN32
+
+#include <math.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "clspv_reflection.h"
+
+enum
+{
+    CONVOLUTION_WORKGROUP_SIZE = 16,
+    CONVOLUTION_RADIUS = 4,
+    CONVOLUTION_TAP_COUNT = CONVOLUTION_RADIUS * 2 + 1,
+    CONVOLUTION_BENCHMARK_LOOP_COUNT = 5,
+
+    // src, dst and weights of the buffer kernels
+    CONVOLUTION_BUFFER_BINDING_COUNT = 3,
+    // Each of the rows pass and the columns pass has one descriptor set per path
+    CONVOLUTION_PASS_COUNT = 2
+};
+
+// The value of the pixels outside the image. The image path gets it from the custom border color of the sampler.
+// Without VK_EXT_custom_border_color, the sampler falls back to VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK, i.e. 0.
+static const float s_customBorderValue = 0.25f;
+
+// layout(push_constant, std430) uniform of all the convolution kernels. The image kernels do not use `borderValue`.
+struct ConvolutionPushConstants
+{
+    int32_t width;
+    int32_t height;
+    int32_t radius;
+    float borderValue;
+};
+
+struct ConvolutionPipelines
+{
+    VkShaderModule shaderModule;
+    VkSampler sampler;
+    float borderValue;
+    // VK_NULL_HANDLE if the device does not support the image path
+    VkDescriptorSetLayout imageDescLayout;
+    VkPipelineLayout imagePipelineLayout;
+    VkPipeline imagePipelines[CONVOLUTION_PASS_COUNT];
+    VkDescriptorSetLayout bufferDescLayout;
+    VkPipelineLayout bufferPipelineLayout;
+    VkPipeline bufferPipelines[CONVOLUTION_PASS_COUNT];
+};
+
+struct CpuConvolutionContext
+{
+    const float* src;
+    float* dst;
+    const float* weights;
+    int width;
+    int height;
+    // 1 for the rows pass, `width` for the columns pass
+    int stride;
+    float borderValue;
+};
+
+// Convolves the rows [begin, end) along the direction given by `stride`, in the same order as the kernels.
+static void CpuConvolutionTask(void* context, size_t begin, size_t end)
+{
+    const struct CpuConvolutionContext* ctx = context;
+    const bool alongRows = ctx->stride == 1;
+
+    for (int y = (int)begin; y < (int)end; y++)
+    {
+        for (int x = 0; x < ctx->width; x++)
+        {
+            float sum = 0.0f;
+            for (int i = -CONVOLUTION_RADIUS; i <= CONVOLUTION_RADIUS; i++)
+            {
+                const int sx = alongRows ? x + i : x;
+                const int sy = alongRows ? y : y + i;
+                const float pixel = sx >= 0 && sx < ctx->width && sy >= 0 && sy < ctx->height ? ctx->src[sy * ctx->width + sx] : ctx->borderValue;
+                sum += ctx->weights[i + CONVOLUTION_RADIUS] * pixel;
+            }
+            ctx->dst[y * ctx->width + x] = sum;
+        }
+    }
+}
+
+static float ComputeMaxError(const float* result, const float* reference, size_t count)
+{
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float error = fabsf(result[i] - reference[i]);
+        // `!(error <= maxError)` also catches NaN, which is reported as an infinite error
+        if (!(error <= maxError)) {
+            maxError = isnan(error) ? INFINITY : error;
+        }
+    }
+    return maxError;
+}
+
+// Binding order of the arguments src, sampler, dst and weights of the image kernels
+static const VkDescriptorSetLayoutBinding s_imageBindings[] = {
+    { 0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL },
+    { 1, VK_DESCRIPTOR_TYPE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL },
+    { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL }
+};
+
+// Binding order of the arguments src, dst and weights of the buffer kernels, as CreateStorageBufferDescriptorSetLayout creates them
+static const VkDescriptorSetLayoutBinding s_bufferBindings[CONVOLUTION_BUFFER_BINDING_COUNT] = {
+    { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL },
+    { 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL },
+    { 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL }
+};
+
+// Offsets of the POD arguments width, height, radius and borderValue. The image kernels take the first three.
+static const uint32_t s_podOffsets[] = {
+    (uint32_t)offsetof(struct ConvolutionPushConstants, width),
+    (uint32_t)offsetof(struct ConvolutionPushConstants, height),
+    (uint32_t)offsetof(struct ConvolutionPushConstants, radius),
+    (uint32_t)offsetof(struct ConvolutionPushConstants, borderValue)
+};
+
+// Compares the bindings and the push constant layout above with the reflection clspv has put in `fileName` for `kernelName`,
+// so that a module built with other POD or binding options fails here instead of reading garbage.
+static VkResult CheckConvolutionKernelLayout(const char* fileName, const char* kernelName, const VkDescriptorSetLayoutBinding bindings[],
+    uint32_t bindingCount, uint32_t podCount)
+{
+    struct ClspvKernelReflection reflection;
+    if (!LoadClspvKernelReflection(fileName, kernelName, &reflection))
+    {
+        fprintf(stderr, "LoadClspvKernelReflection failed for %s!\n", kernelName);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    return CheckClspvKernelLayout(kernelName, &reflection, bindings, bindingCount, s_podOffsets, podCount,
+        (uint32_t)sizeof(struct ConvolutionPushConstants));
+}
+
+static VkResult CreateImageDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout* pDescLayout)
+{
+    const VkDescriptorSetLayoutCreateInfo descLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = (uint32_t)(sizeof(s_imageBindings) / sizeof(s_imageBindings[0])),
+        .pBindings = s_imageBindings
+    };
+
+    VkResult res = vkCreateDescriptorSetLayout(device, &descLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
+    }
+    return res;
+}
+
+static VkResult AllocateImageDescriptorSet(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSetLayout descLayout,
+    VkImageView srcView, VkSampler sampler, VkImageView dstView, VkBuffer weightsBuffer, VkDescriptorSet* pDescSet)
+{
+    const VkDescriptorSetAllocateInfo descAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &descLayout
+    };
+    VkResult res = vkAllocateDescriptorSets(device, &descAllocInfo, pDescSet);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateDescriptorSets failed: %d\n", res);
+        return res;
+    }
+
+    // src is read through the sampler in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, while dst is written in VK_IMAGE_LAYOUT_GENERAL.
+    const VkDescriptorImageInfo srcImageInfo = { .sampler = VK_NULL_HANDLE, .imageView = srcView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    const VkDescriptorImageInfo samplerInfo = { .sampler = sampler, .imageView = VK_NULL_HANDLE, .imageLayout = VK_IMAGE_LAYOUT_UNDEFINED };
+    const VkDescriptorImageInfo dstImageInfo = { .sampler = VK_NULL_HANDLE, .imageView = dstView, .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+    const VkDescriptorBufferInfo weightsInfo = { .buffer = weightsBuffer, .offset = 0, .range = VK_WHOLE_SIZE };
+
+    const VkWriteDescriptorSet writeDescSets[] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = *pDescSet,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo = &srcImageInfo,
+            .pBufferInfo = NULL,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = *pDescSet,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .pImageInfo = &samplerInfo,
+            .pBufferInfo = NULL,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = *pDescSet,
+            .dstBinding = 2,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = &dstImageInfo,
+            .pBufferInfo = NULL,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = *pDescSet,
+            .dstBinding = 3,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &weightsInfo,
+            .pTexelBufferView = NULL
+        }
+    };
+    vkUpdateDescriptorSets(device, (uint32_t)(sizeof(writeDescSets) / sizeof(writeDescSets[0])), writeDescSets, 0, NULL);
+
+    return res;
+}
+
+static VkResult CreateBorderSampler(VkDevice device, bool supportCustomBorderColor, VkSampler* pSampler, float* pBorderValue)
+{
+    const VkSamplerCustomBorderColorCreateInfoEXT customBorderColorInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT,
+        .pNext = NULL,
+        .customBorderColor = {.float32 = { s_customBorderValue, s_customBorderValue, s_customBorderValue, s_customBorderValue } },
+        .format = VK_FORMAT_R32_SFLOAT
+    };
+
+    // Unnormalized coordinates require the nearest filter, no mipmapping, and clamping address modes
+    const VkSamplerCreateInfo samplerCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext = supportCustomBorderColor ? &customBorderColorInfo : NULL,
+        .flags = 0,
+        .magFilter = VK_FILTER_NEAREST,
+        .minFilter = VK_FILTER_NEAREST,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+        .mipLodBias = 0.0f,
+        .anisotropyEnable = VK_FALSE,
+        .maxAnisotropy = 1.0f,
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_NEVER,
+        .minLod = 0.0f,
+        .maxLod = 0.0f,
+        .borderColor = supportCustomBorderColor ? VK_BORDER_COLOR_FLOAT_CUSTOM_EXT : VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+        .unnormalizedCoordinates = VK_TRUE
+    };
+
+    VkResult res = vkCreateSampler(device, &samplerCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SAMPLER), pSampler);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateSampler failed: %d\n", res);
+    }
+    *pBorderValue = supportCustomBorderColor ? s_customBorderValue : 0.0f;
+    return res;
+}
+
+static void RecordConvolutionDispatch(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet,
+    const struct ConvolutionPushConstants* pArgs)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*pArgs), pArgs);
+    vkCmdDispatch(commandBuffer, ((uint32_t)pArgs->width + CONVOLUTION_WORKGROUP_SIZE - 1) / CONVOLUTION_WORKGROUP_SIZE,
+        ((uint32_t)pArgs->height + CONVOLUTION_WORKGROUP_SIZE - 1) / CONVOLUTION_WORKGROUP_SIZE, 1);
+}
+
+// srcImage must be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. dstImage is left in VK_IMAGE_LAYOUT_GENERAL.
+static void RecordImageConvolution(VkCommandBuffer commandBuffer, const struct ConvolutionPipelines* pPipelines, const VkDescriptorSet descSets[CONVOLUTION_PASS_COUNT],
+    const struct ConvolutionPushConstants* pArgs, VkImage tmpImage, VkImage dstImage)
+{
+    // The previous contents of tmpImage and dstImage are discarded, so only the write-after-read hazards need to be resolved.
+    RecordImageLayoutTransition(commandBuffer, tmpImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+    RecordConvolutionDispatch(commandBuffer, pPipelines->imagePipelines[0], pPipelines->imagePipelineLayout, descSets[0], pArgs);
+
+    RecordImageLayoutTransition(commandBuffer, tmpImage, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    RecordImageLayoutTransition(commandBuffer, dstImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+    RecordConvolutionDispatch(commandBuffer, pPipelines->imagePipelines[1], pPipelines->imagePipelineLayout, descSets[1], pArgs);
+}
+
+static void RecordBufferConvolution(VkCommandBuffer commandBuffer, const struct ConvolutionPipelines* pPipelines, const VkDescriptorSet descSets[CONVOLUTION_PASS_COUNT],
+    const struct ConvolutionPushConstants* pArgs)
+{
+    RecordConvolutionDispatch(commandBuffer, pPipelines->bufferPipelines[0], pPipelines->bufferPipelineLayout, descSets[0], pArgs);
+    RecordComputeToComputeBarrier(commandBuffer);
+    RecordConvolutionDispatch(commandBuffer, pPipelines->bufferPipelines[1], pPipelines->bufferPipelineLayout, descSets[1], pArgs);
+}
+
+static void PrintConvolutionResult(const char* name, uint32_t width, uint32_t height, double milliseconds, float maxError)
+{
+    // Each pass reads and writes every pixel once at least
+    const double pixelCount = (double)width * height;
+    const double bytes = pixelCount * sizeof(float) * 2.0 * CONVOLUTION_PASS_COUNT;
+    printf("%-12s %10.3f ms  %9.2f Mpixel/s  %8.2f GB/s  max error: %g%s\n", name, milliseconds, pixelCount / (milliseconds * 1000.0),
+        bytes / (milliseconds * 1000000.0), maxError, maxError <= 1e-4f ? "" : " (FAILED)");
+}
+
+static VkResult RunConvolutionWithImageSize(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, const struct ConvolutionPipelines* pPipelines, uint32_t width, uint32_t height)
+{
+    const size_t pixelCount = (size_t)width * height;
+    const VkDeviceSize imageSize = (VkDeviceSize)pixelCount * sizeof(float);
+    const bool useImagePath = pPipelines->imagePipelineLayout != VK_NULL_HANDLE;
+
+    printf("---- %u x %u ----\n", width, height);
+
+    // srcImage is only sampled, tmpImage is written by the first pass and sampled by the second one, dstImage is only written
+    VkImage images[3] = { VK_NULL_HANDLE };
+    VkDeviceMemory imageMemories[3] = { VK_NULL_HANDLE };
+    VkImageView imageViews[3] = { VK_NULL_HANDLE };
+    const VkImageUsageFlags imageUsages[3] = {
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+    };
+    // src, tmp and dst of the buffer path
+    VkBuffer buffers[3] = { VK_NULL_HANDLE };
+    VkDeviceMemory bufferMemories[3] = { VK_NULL_HANDLE };
+    VkBuffer weightsBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory weightsMemory = VK_NULL_HANDLE;
+    // The input pixels followed by the output pixels
+    VkBuffer hostBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory hostMemory = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    float* refPixels = malloc((size_t)imageSize * 2U);
+    VkResult result = refPixels != NULL ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    do
+    {
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to allocate the reference image!\n");
+            break;
+        }
+
+        for (int i = 0; i < 3 && useImagePath && result == VK_SUCCESS; i++)
+        {
+            result = CreateImage2DWithMemory(device, pMemoryProperties, width, height, VK_FORMAT_R32_SFLOAT, imageUsages[i], queueFamilyIndex,
+                &images[i], &imageMemories[i], &imageViews[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateImage2DWithMemory failed!\n");
+            break;
+        }
+
+        for (int i = 0; i < 3 && result == VK_SUCCESS; i++)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, imageSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &buffers[i], &bufferMemories[i]);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, CONVOLUTION_TAP_COUNT * sizeof(float), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &weightsBuffer, &weightsMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, imageSize * 2U, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &hostBuffer, &hostMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        // Normalized Gaussian weights with sigma = radius / 2
+        void* weightsPtr = NULL;
+        result = vkMapMemory(device, weightsMemory, 0, VK_WHOLE_SIZE, 0, &weightsPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        float weights[CONVOLUTION_TAP_COUNT];
+        float weightSum = 0.0f;
+        for (int i = 0; i < CONVOLUTION_TAP_COUNT; i++)
+        {
+            const float distance = (float)(i - CONVOLUTION_RADIUS) / (CONVOLUTION_RADIUS * 0.5f);
+            weights[i] = expf(-0.5f * distance * distance);
+            weightSum += weights[i];
+        }
+        for (int i = 0; i < CONVOLUTION_TAP_COUNT; i++) {
+            weights[i] /= weightSum;
+        }
+        memcpy(weightsPtr, weights, sizeof(weights));
+        vkUnmapMemory(device, weightsMemory);
+
+        void* hostPtr = NULL;
+        result = vkMapMemory(device, hostMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        float* srcPixels = hostPtr;
+        const float* dstPixels = srcPixels + pixelCount;
+
+        uint32_t state = width ^ height;
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            state = state * 1664525U + 1013904223U;
+            // [0.0, 1.0)
+            srcPixels[i] = (float)(state >> 8) / (float)(1U << 24);
+        }
+
+        struct CpuConvolutionContext cpuContext = { srcPixels, refPixels + pixelCount, weights, (int)width, (int)height, 1, pPipelines->borderValue };
+        HostParallelFor(height, 16, CpuConvolutionTask, &cpuContext);
+        cpuContext.src = refPixels + pixelCount;
+        cpuContext.dst = refPixels;
+        cpuContext.stride = (int)width;
+        HostParallelFor(height, 16, CpuConvolutionTask, &cpuContext);
+
+        const VkDescriptorPoolCreateInfo descriptorPoolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .maxSets = CONVOLUTION_PASS_COUNT * 2,
+            .poolSizeCount = 4,
+            .pPoolSizes = (VkDescriptorPoolSize[]) {
+                {.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = CONVOLUTION_PASS_COUNT },
+                {.type = VK_DESCRIPTOR_TYPE_SAMPLER, .descriptorCount = CONVOLUTION_PASS_COUNT },
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = CONVOLUTION_PASS_COUNT },
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = CONVOLUTION_PASS_COUNT * (1 + CONVOLUTION_BUFFER_BINDING_COUNT) }
+            }
+        };
+        result = vkCreateDescriptorPool(device, &descriptorPoolInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &descriptorPool);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreateDescriptorPool failed: %d\n", result);
+            break;
+        }
+
+        VkDescriptorSet imageDescSets[CONVOLUTION_PASS_COUNT] = { VK_NULL_HANDLE };
+        VkDescriptorSet bufferDescSets[CONVOLUTION_PASS_COUNT] = { VK_NULL_HANDLE };
+        for (int pass = 0; pass < CONVOLUTION_PASS_COUNT && result == VK_SUCCESS; pass++)
+        {
+            const VkBuffer passBuffers[CONVOLUTION_BUFFER_BINDING_COUNT] = { buffers[pass], buffers[pass + 1], weightsBuffer };
+            result = AllocateStorageBufferDescriptorSet(device, descriptorPool, pPipelines->bufferDescLayout, passBuffers, CONVOLUTION_BUFFER_BINDING_COUNT,
+                &bufferDescSets[pass]);
+            if (result == VK_SUCCESS && useImagePath)
+            {
+                result = AllocateImageDescriptorSet(device, descriptorPool, pPipelines->imageDescLayout, imageViews[pass], pPipelines->sampler,
+                    imageViews[pass + 1], weightsBuffer, &imageDescSets[pass]);
+            }
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to allocate the descriptor sets!\n");
+            break;
+        }
+
+        // Upload the input to both the source buffer and the source image
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const VkBufferCopy bufferRegion = { .srcOffset = 0, .dstOffset = 0, .size = imageSize };
+        vkCmdCopyBuffer(commandBuffer, hostBuffer, buffers[0], 1, &bufferRegion);
+        const VkBufferImageCopy imageRegion = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { width, height, 1 }
+        };
+        if (useImagePath)
+        {
+            RecordImageLayoutTransition(commandBuffer, images[0], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+            vkCmdCopyBufferToImage(commandBuffer, hostBuffer, images[0], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageRegion);
+            RecordImageLayoutTransition(commandBuffer, images[0], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+        RecordTransferToComputeBarrier(commandBuffer);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const struct ConvolutionPushConstants args = { (int32_t)width, (int32_t)height, CONVOLUTION_RADIUS, pPipelines->borderValue };
+        const VkBufferCopy readbackRegion = { .srcOffset = 0, .dstOffset = imageSize, .size = imageSize };
+        const VkBufferImageCopy readbackImageRegion = {
+            .bufferOffset = imageSize,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+            .imageOffset = { 0, 0, 0 },
+            .imageExtent = { width, height, 1 }
+        };
+
+        // ---- Buffer path ----
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordBufferConvolution(commandBuffer, pPipelines, bufferDescSets, &args);
+        RecordComputeToTransferBarrier(commandBuffer);
+        vkCmdCopyBuffer(commandBuffer, buffers[2], hostBuffer, 1, &readbackRegion);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        const float bufferMaxError = ComputeMaxError(dstPixels, refPixels, pixelCount);
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        for (int loop = 0; loop < CONVOLUTION_BENCHMARK_LOOP_COUNT; loop++)
+        {
+            if (loop > 0) {
+                RecordComputeToComputeBarrier(commandBuffer);
+            }
+            RecordBufferConvolution(commandBuffer, pPipelines, bufferDescSets, &args);
+        }
+        uint64_t beginTime = HostGetTimeNanoseconds();
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        const double bufferMilliseconds = (double)(HostGetTimeNanoseconds() - beginTime) / 1000000.0 / CONVOLUTION_BENCHMARK_LOOP_COUNT;
+        if (result != VK_SUCCESS) break;
+        PrintConvolutionResult("buffer path", width, height, bufferMilliseconds, bufferMaxError);
+
+        if (!useImagePath) break;
+
+        // ---- Image path ----
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordImageConvolution(commandBuffer, pPipelines, imageDescSets, &args, images[1], images[2]);
+        RecordImageLayoutTransition(commandBuffer, images[2], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        vkCmdCopyImageToBuffer(commandBuffer, images[2], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, hostBuffer, 1, &readbackImageRegion);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        const float imageMaxError = ComputeMaxError(dstPixels, refPixels, pixelCount);
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        for (int loop = 0; loop < CONVOLUTION_BENCHMARK_LOOP_COUNT; loop++) {
+            RecordImageConvolution(commandBuffer, pPipelines, imageDescSets, &args, images[1], images[2]);
+        }
+        beginTime = HostGetTimeNanoseconds();
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        const double imageMilliseconds = (double)(HostGetTimeNanoseconds() - beginTime) / 1000000.0 / CONVOLUTION_BENCHMARK_LOOP_COUNT;
+        if (result != VK_SUCCESS) break;
+        PrintConvolutionResult("image path", width, height, imageMilliseconds, imageMaxError);
+        printf("Image path is x%.2f as fast as buffer path\n", bufferMilliseconds / imageMilliseconds);
+    } while (false);
+
+    if (hostMemory != VK_NULL_HANDLE && result == VK_SUCCESS) {
+        vkUnmapMemory(device, hostMemory);
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    DestroyBufferWithMemory(device, hostBuffer, hostMemory);
+    DestroyBufferWithMemory(device, weightsBuffer, weightsMemory);
+    for (int i = 0; i < 3; i++)
+    {
+        DestroyBufferWithMemory(device, buffers[i], bufferMemories[i]);
+        DestroyImage2DWithMemory(device, images[i], imageMemories[i], imageViews[i]);
+    }
+    free(refPixels);
+
+    return result;
+}
+
+// `baseWidth` x `baseHeight` is the smallest image size to test. The test doubles both dimensions up to twice.
+void ConvolutionComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceFeatures* pFeatures, bool supportCustomBorderColor,
+    uint32_t baseWidth, uint32_t baseHeight)
+{
+    puts("\n================ Begin image convolution test ================\n");
+
+    struct ConvolutionPipelines pipelines = { VK_NULL_HANDLE };
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/convolution/convolution.spv"))
+        {
+            puts("shaders/convolution/convolution.spv has not been built by shaders/convolution/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        VkResult result = CreateShaderModule(specDevice, "shaders/convolution/convolution.spv", &pipelines.shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        const uint32_t specConstants[] = { CONVOLUTION_WORKGROUP_SIZE, CONVOLUTION_WORKGROUP_SIZE, 1U };
+        const uint32_t specConstantCount = (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0]));
+        const char* const bufferKernelNames[CONVOLUTION_PASS_COUNT] = { "ConvolveRowsBufferKernel", "ConvolveColumnsBufferKernel" };
+        const char* const imageKernelNames[CONVOLUTION_PASS_COUNT] = { "ConvolveRowsImageKernel", "ConvolveColumnsImageKernel" };
+
+        for (int pass = 0; pass < CONVOLUTION_PASS_COUNT && result == VK_SUCCESS; pass++)
+        {
+            result = CheckConvolutionKernelLayout("shaders/convolution/convolution.spv", bufferKernelNames[pass], s_bufferBindings,
+                CONVOLUTION_BUFFER_BINDING_COUNT, 4);
+            if (result != VK_SUCCESS) break;
+            result = CheckConvolutionKernelLayout("shaders/convolution/convolution.spv", imageKernelNames[pass], s_imageBindings,
+                (uint32_t)(sizeof(s_imageBindings) / sizeof(s_imageBindings[0])), 3);
+        }
+        if (result != VK_SUCCESS) break;
+
+        result = CreateStorageBufferDescriptorSetLayout(specDevice, CONVOLUTION_BUFFER_BINDING_COUNT, &pipelines.bufferDescLayout);
+        if (result != VK_SUCCESS) break;
+        result = CreateComputePipelineLayout(specDevice, pipelines.bufferDescLayout, sizeof(struct ConvolutionPushConstants), &pipelines.bufferPipelineLayout);
+        if (result != VK_SUCCESS) break;
+        for (int pass = 0; pass < CONVOLUTION_PASS_COUNT && result == VK_SUCCESS; pass++)
+        {
+            result = CreateComputePipelineWithSpecConstants(specDevice, pipelines.shaderModule, bufferKernelNames[pass], pipelines.bufferPipelineLayout,
+                specConstants, specConstantCount, &pipelines.bufferPipelines[pass]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create the buffer path pipelines!\n");
+            break;
+        }
+
+        result = CreateBorderSampler(specDevice, supportCustomBorderColor, &pipelines.sampler, &pipelines.borderValue);
+        if (result != VK_SUCCESS) break;
+        printf("Border value: %g (%s)\n", pipelines.borderValue, supportCustomBorderColor ? "custom border color" : "transparent black");
+
+        // clspv declares the storage images of write_only image2d_t arguments with an unknown format
+        if (pFeatures->shaderStorageImageWriteWithoutFormat != VK_FALSE)
+        {
+            result = CreateImageDescriptorSetLayout(specDevice, &pipelines.imageDescLayout);
+            if (result != VK_SUCCESS) break;
+            result = CreateComputePipelineLayout(specDevice, pipelines.imageDescLayout, sizeof(struct ConvolutionPushConstants), &pipelines.imagePipelineLayout);
+            if (result != VK_SUCCESS) break;
+            for (int pass = 0; pass < CONVOLUTION_PASS_COUNT && result == VK_SUCCESS; pass++)
+            {
+                result = CreateComputePipelineWithSpecConstants(specDevice, pipelines.shaderModule, imageKernelNames[pass], pipelines.imagePipelineLayout,
+                    specConstants, specConstantCount, &pipelines.imagePipelines[pass]);
+            }
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "Failed to create the image path pipelines!\n");
+                break;
+            }
+        }
+        else {
+            puts("The current device does not support `shaderStorageImageWriteWithoutFormat` feature. The image path will be skipped.");
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        for (uint32_t scale = 1; scale <= 4; scale *= 2)
+        {
+            const uint32_t width = baseWidth * scale;
+            const uint32_t height = baseHeight * scale;
+            if (width > pLimits->maxImageDimension2D || height > pLimits->maxImageDimension2D)
+            {
+                printf("%u x %u exceeds the max image dimension and will be skipped.\n", width, height);
+                continue;
+            }
+
+            result = RunConvolutionWithImageSize(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffers[0],
+                &pipelines, width, height);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "RunConvolutionWithImageSize failed!\n");
+                break;
+            }
+        }
+    } while (false);
+
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    for (int pass = 0; pass < CONVOLUTION_PASS_COUNT; pass++)
+    {
+        if (pipelines.imagePipelines[pass] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(specDevice, pipelines.imagePipelines[pass], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+        if (pipelines.bufferPipelines[pass] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(specDevice, pipelines.bufferPipelines[pass], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+    }
+    if (pipelines.imagePipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(specDevice, pipelines.imagePipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pipelines.bufferPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(specDevice, pipelines.bufferPipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pipelines.imageDescLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(specDevice, pipelines.imageDescLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (pipelines.bufferDescLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(specDevice, pipelines.bufferDescLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (pipelines.sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(specDevice, pipelines.sampler, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SAMPLER));
+    }
+    if (pipelines.shaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(specDevice, pipelines.shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+
+    puts("\n================ Complete image convolution test ================\n");
+}
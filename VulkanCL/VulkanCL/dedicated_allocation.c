@@ -0,0 +1,388 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "elementwise_fusion.h"
+#include "dedicated_allocation.h"
+
+enum
+{
+    DEDICATED_ALLOCATION_MAX_BUFFER_COUNT = 16,
+
+    DEDICATED_ALLOCATION_BENCHMARK_ROUND_COUNT = 8
+};
+
+static enum DedicatedAllocationPolicy s_policy = DEDICATED_ALLOCATION_POLICY_PREFERRED_OR_LARGE;
+static VkDeviceSize s_threshold = DEDICATED_ALLOCATION_DEFAULT_THRESHOLD;
+
+// The two 40 MB buffers of the simple test lie between the first two sizes
+static const VkDeviceSize s_benchmarkBufferSizes[] = { 4 * 1024 * 1024, 64 * 1024 * 1024, 256 * 1024 * 1024 };
+
+void SetDedicatedAllocationPolicy(enum DedicatedAllocationPolicy policy, VkDeviceSize threshold)
+{
+    s_policy = policy;
+    s_threshold = threshold;
+}
+
+enum DedicatedAllocationPolicy GetDedicatedAllocationPolicy(VkDeviceSize* pThreshold)
+{
+    if (pThreshold != NULL) {
+        *pThreshold = s_threshold;
+    }
+    return s_policy;
+}
+
+static bool QueryBufferMemoryRequirements(VkDevice device, VkBuffer buffer, enum DedicatedAllocationPolicy policy, VkDeviceSize threshold,
+    VkMemoryRequirements* pRequirements)
+{
+    VkMemoryDedicatedRequirements dedicatedRequirements = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+        .pNext = NULL
+    };
+    VkMemoryRequirements2 requirements2 = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+        .pNext = &dedicatedRequirements
+    };
+    const VkBufferMemoryRequirementsInfo2 requirementsInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+        .pNext = NULL,
+        .buffer = buffer
+    };
+    vkGetBufferMemoryRequirements2(device, &requirementsInfo, &requirements2);
+    *pRequirements = requirements2.memoryRequirements;
+
+    if (dedicatedRequirements.requiresDedicatedAllocation) return true;
+    if (policy == DEDICATED_ALLOCATION_POLICY_REQUIRED_ONLY) return false;
+    return dedicatedRequirements.prefersDedicatedAllocation || pRequirements->size >= threshold;
+}
+
+bool GetBufferMemoryRequirementsForPolicy(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pRequirements)
+{
+    return QueryBufferMemoryRequirements(device, buffer, s_policy, s_threshold, pRequirements);
+}
+
+static VkResult AllocateAndBindBufferMemoryWithPolicy(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    const VkBuffer buffers[], uint32_t bufferCount, VkMemoryPropertyFlags requiredFlags, const void* pNext, VkDeviceMemory memories[],
+    uint32_t* pDedicatedCount, enum DedicatedAllocationPolicy policy, VkDeviceSize threshold)
+{
+    if (pDedicatedCount != NULL) {
+        *pDedicatedCount = 0;
+    }
+    if (bufferCount == 0 || bufferCount > DEDICATED_ALLOCATION_MAX_BUFFER_COUNT) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        memories[i] = VK_NULL_HANDLE;
+    }
+
+    VkMemoryRequirements requirements[DEDICATED_ALLOCATION_MAX_BUFFER_COUNT];
+    bool dedicated[DEDICATED_ALLOCATION_MAX_BUFFER_COUNT];
+    VkDeviceSize offsets[DEDICATED_ALLOCATION_MAX_BUFFER_COUNT];
+
+    // The shared buffers are laid out one after another, each at the alignment it requires
+    VkMemoryRequirements sharedRequirements = { .size = 0, .alignment = 1, .memoryTypeBits = UINT32_MAX };
+    uint32_t firstShared = UINT32_MAX;
+    for (uint32_t i = 0; i < bufferCount; i++)
+    {
+        dedicated[i] = QueryBufferMemoryRequirements(device, buffers[i], policy, threshold, &requirements[i]);
+        if (dedicated[i]) continue;
+
+        if (firstShared == UINT32_MAX) {
+            firstShared = i;
+        }
+        const VkDeviceSize alignment = requirements[i].alignment > 0 ? requirements[i].alignment : 1;
+        offsets[i] = (sharedRequirements.size + alignment - 1) / alignment * alignment;
+        sharedRequirements.size = offsets[i] + requirements[i].size;
+        if (alignment > sharedRequirements.alignment) {
+            sharedRequirements.alignment = alignment;
+        }
+        sharedRequirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+    }
+
+    VkResult res = VK_SUCCESS;
+    for (uint32_t i = 0; i < bufferCount && res == VK_SUCCESS; i++)
+    {
+        if (!dedicated[i]) continue;
+
+        const VkMemoryDedicatedAllocateInfo dedicatedInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+            .pNext = pNext,
+            .image = VK_NULL_HANDLE,
+            .buffer = buffers[i]
+        };
+        res = AllocateMemoryWithinBudget(device, pMemoryProperties, &requirements[i], requiredFlags, &dedicatedInfo, &memories[i], NULL);
+        if (res != VK_SUCCESS) break;
+
+        res = vkBindBufferMemory(device, buffers[i], memories[i], 0);
+        if (res != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
+            break;
+        }
+        if (pDedicatedCount != NULL) {
+            (*pDedicatedCount)++;
+        }
+    }
+    if (res != VK_SUCCESS || firstShared == UINT32_MAX) {
+        return res;
+    }
+
+    if (sharedRequirements.memoryTypeBits == 0)
+    {
+        fprintf(stderr, "The buffers share no memory type!\n");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+    res = AllocateMemoryWithinBudget(device, pMemoryProperties, &sharedRequirements, requiredFlags, pNext, &memories[firstShared], NULL);
+    if (res != VK_SUCCESS) {
+        return res;
+    }
+    for (uint32_t i = firstShared; i < bufferCount; i++)
+    {
+        if (dedicated[i]) continue;
+
+        res = vkBindBufferMemory(device, buffers[i], memories[firstShared], offsets[i]);
+        if (res != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
+            break;
+        }
+    }
+    return res;
+}
+
+VkResult AllocateAndBindBufferMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, const VkBuffer buffers[],
+    uint32_t bufferCount, VkMemoryPropertyFlags requiredFlags, const void* pNext, VkDeviceMemory memories[], uint32_t* pDedicatedCount)
+{
+    return AllocateAndBindBufferMemoryWithPolicy(device, pMemoryProperties, buffers, bufferCount, requiredFlags, pNext, memories, pDedicatedCount,
+        s_policy, s_threshold);
+}
+
+// MARK: Benchmark
+
+struct DedicatedAllocationBenchmarkResult
+{
+    uint32_t dedicatedCount;
+    uint64_t allocationTime;
+    uint64_t chainTime;
+    bool verified;
+};
+
+// Allocates the pair of buffers with `policy`, and runs the chain between them for the rounds of the benchmark.
+static VkResult RunDedicatedAllocationBenchmark(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    VkBuffer stagingBuffer, uint32_t* stagingPtr, uint32_t elemCount, enum DedicatedAllocationPolicy policy, VkDeviceSize threshold,
+    struct DedicatedAllocationBenchmarkResult* pResult)
+{
+    const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+    VkBuffer buffers[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    VkDeviceMemory memories[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    struct ElementwiseChainPlan* pPlan = NULL;
+    VkResult result = VK_SUCCESS;
+
+    memset(pResult, 0, sizeof(*pResult));
+
+    do
+    {
+        const VkBufferCreateInfo bufferCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .size = bufferSize,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
+        };
+        for (uint32_t i = 0; i < 2 && result == VK_SUCCESS; i++)
+        {
+            result = vkCreateBuffer(device, &bufferCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &buffers[i]);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "vkCreateBuffer failed: %d\n", result);
+            }
+        }
+        if (result != VK_SUCCESS) break;
+
+        uint64_t beginTime = HostGetTimeNanoseconds();
+        result = AllocateAndBindBufferMemoryWithPolicy(device, pMemoryProperties, buffers, 2, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, NULL, memories,
+            &pResult->dedicatedCount, policy, threshold);
+        pResult->allocationTime = HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AllocateAndBindBufferMemory failed: %d\n", result);
+            break;
+        }
+
+        result = CreateElementwiseChainPlan(pContext, pChain, ELEMENTWISE_FUSION_AUTO, buffers[0], buffers[1], &pPlan);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+            break;
+        }
+
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = bufferSize };
+        HostParallelFillSequence((int*)stagingPtr, elemCount, 0);
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, buffers[0], 1, &copyRegion);
+        RecordTransferToComputeBarrier(commandBuffer);
+        // A first run to warm the pipelines and the memory up
+        RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        // Every round reads buffers[0] and writes buffers[1], so the result is the one of a single round
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        for (int round = 0; round < DEDICATED_ALLOCATION_BENCHMARK_ROUND_COUNT; round++)
+        {
+            if (round > 0) {
+                RecordComputeToComputeBarrier(commandBuffer);
+            }
+            RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+        }
+        beginTime = HostGetTimeNanoseconds();
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        pResult->chainTime = HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS) break;
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordComputeToTransferBarrier(commandBuffer);
+        vkCmdCopyBuffer(commandBuffer, buffers[1], stagingBuffer, 1, &copyRegion);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        pResult->verified = true;
+        for (uint32_t i = 0; i < elemCount && pResult->verified; i++) {
+            pResult->verified = stagingPtr[i] == ApplyElementwiseChainOnHost(pChain, i);
+        }
+    } while (false);
+
+    DestroyElementwiseChainPlan(pPlan);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (buffers[i] != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, buffers[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
+        }
+        FreeDeviceMemory(device, memories[i]);
+    }
+    return result;
+}
+
+void DedicatedAllocationBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin dedicated allocation benchmark ================\n");
+
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    struct ElementwiseContext* pContext = NULL;
+
+    const struct ElementwiseChain chain = {
+        3, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_XOR }, { 5, 17, 0xa5a5U }
+    };
+    static const struct
+    {
+        enum DedicatedAllocationPolicy policy;
+        VkDeviceSize threshold;
+        const char* name;
+    } policies[] = {
+        { DEDICATED_ALLOCATION_POLICY_REQUIRED_ONLY, 0, "shared" },
+        // Every buffer from the threshold of 0 on
+        { DEDICATED_ALLOCATION_POLICY_PREFERRED_OR_LARGE, 0, "dedicated" }
+    };
+
+    do
+    {
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+        VkResult result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, &commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        result = CreateElementwiseContext(specDevice, pLimits, &pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+
+        VkDeviceSize threshold = 0;
+        const enum DedicatedAllocationPolicy currentPolicy = GetDedicatedAllocationPolicy(&threshold);
+        printf("Current policy: %s, threshold %.1f MiB\n", currentPolicy == DEDICATED_ALLOCATION_POLICY_REQUIRED_ONLY ? "required only" :
+            "preferred or large", (double)threshold / (1024.0 * 1024.0));
+        puts("  buffer size     policy     dedicated   allocation      chain x8   bandwidth");
+
+        for (size_t s = 0; s < sizeof(s_benchmarkBufferSizes) / sizeof(s_benchmarkBufferSizes[0]) && result == VK_SUCCESS; s++)
+        {
+            const VkDeviceSize bufferSize = s_benchmarkBufferSizes[s];
+            const uint32_t elemCount = (uint32_t)(bufferSize / sizeof(uint32_t));
+            if (bufferSize > pLimits->maxStorageBufferRange ||
+                bufferSize * 2U > GetAvailableMemoryBudget(specDevice, pMemoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            {
+                printf("%8.1f MiB exceeds the storage buffer range or the device local budget and will be skipped.\n",
+                    (double)bufferSize / (1024.0 * 1024.0));
+                continue;
+            }
+
+            VkBuffer stagingBuffer = VK_NULL_HANDLE;
+            VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+            void* hostPtr = NULL;
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &stagingBuffer, &stagingMemory);
+            if (result == VK_SUCCESS)
+            {
+                result = vkMapMemory(specDevice, stagingMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+                if (result != VK_SUCCESS) {
+                    fprintf(stderr, "vkMapMemory failed: %d\n", result);
+                }
+            }
+            else {
+                fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            }
+
+            for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]) && result == VK_SUCCESS; p++)
+            {
+                struct DedicatedAllocationBenchmarkResult benchmarkResult;
+                result = RunDedicatedAllocationBenchmark(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffer,
+                    pContext, &chain, stagingBuffer, hostPtr, elemCount, policies[p].policy, policies[p].threshold, &benchmarkResult);
+                if (result != VK_SUCCESS) break;
+
+                const double chainMilliseconds = (double)benchmarkResult.chainTime / 1000000.0;
+                // Every round reads one buffer and writes the other
+                const double bandwidth = (double)bufferSize * 2.0 * DEDICATED_ALLOCATION_BENCHMARK_ROUND_COUNT / (chainMilliseconds * 1000000.0);
+                printf("%8.1f MiB  %-10s  %9u  %8.3f ms  %9.3f ms  %6.2f GB/s  (%s)\n", (double)bufferSize / (1024.0 * 1024.0), policies[p].name,
+                    benchmarkResult.dedicatedCount, (double)benchmarkResult.allocationTime / 1000000.0, chainMilliseconds, bandwidth,
+                    benchmarkResult.verified ? "verify OK" : "verify FAILED");
+            }
+
+            if (hostPtr != NULL) {
+                vkUnmapMemory(specDevice, stagingMemory);
+            }
+            DestroyBufferWithMemory(specDevice, stagingBuffer, stagingMemory);
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "RunDedicatedAllocationBenchmark failed: %d\n", result);
+        }
+    } while (false);
+
+    DestroyElementwiseContext(pContext);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, 1, &commandBuffer);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+
+    puts("\n================ Complete dedicated allocation benchmark ================\n");
+}
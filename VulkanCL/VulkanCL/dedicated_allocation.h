@@ -0,0 +1,50 @@
+#ifndef DEDICATED_ALLOCATION_H
+#define DEDICATED_ALLOCATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Routing of the buffer memory between dedicated allocations (VK_KHR_dedicated_allocation, core in Vulkan 1.1) and shared ones.
+// The requirements come from vkGetBufferMemoryRequirements2 with VkMemoryDedicatedRequirements. A buffer the policy routes to a dedicated
+// allocation gets a VkDeviceMemory of its own with VkMemoryDedicatedAllocateInfo, which some implementations place and compress better.
+// The other buffers of a call are sub-allocated from one shared allocation at consecutive aligned offsets.
+// All the allocations go through AllocateMemoryWithinBudget of memory_budget.h.
+
+enum DedicatedAllocationPolicy
+{
+    // Only the buffers the implementation requires to be dedicated
+    DEDICATED_ALLOCATION_POLICY_REQUIRED_ONLY,
+    // Also the buffers the implementation prefers dedicated, and the ones of the threshold size or larger
+    DEDICATED_ALLOCATION_POLICY_PREFERRED_OR_LARGE
+};
+
+enum
+{
+    DEDICATED_ALLOCATION_DEFAULT_THRESHOLD = 32 * 1024 * 1024
+};
+
+// The process-wide policy of AllocateAndBindBufferMemory, DEDICATED_ALLOCATION_POLICY_PREFERRED_OR_LARGE with the default threshold
+// until it is set. It is set while no buffer memory is being allocated.
+extern void SetDedicatedAllocationPolicy(enum DedicatedAllocationPolicy policy, VkDeviceSize threshold);
+extern enum DedicatedAllocationPolicy GetDedicatedAllocationPolicy(VkDeviceSize* pThreshold);
+
+// vkGetBufferMemoryRequirements2. Returns whether the current policy routes the buffer to a dedicated allocation.
+extern bool GetBufferMemoryRequirementsForPolicy(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pRequirements);
+
+// Allocates and binds the memory of `bufferCount` buffers with `requiredFlags`.
+// The buffers the policy routes to dedicated allocations get memories[i] of their own. The others share the allocation stored
+// in the memories[i] of the first of them, and the rest of their memories[i] are VK_NULL_HANDLE.
+// @param pNext: the pNext chain of every VkMemoryAllocateInfo, e.g. VkMemoryAllocateFlagsInfo
+// @param pDedicatedCount: receives the number of dedicated allocations. It may be NULL.
+extern VkResult AllocateAndBindBufferMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, const VkBuffer buffers[],
+    uint32_t bufferCount, VkMemoryPropertyFlags requiredFlags, const void* pNext, VkDeviceMemory memories[], uint32_t* pDedicatedCount);
+
+// Compares the shared and the dedicated allocations of a pair of large storage buffers, by the allocation time and by an elementwise chain
+// running between them.
+extern void DedicatedAllocationBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !DEDICATED_ALLOCATION_H
@@ -0,0 +1,821 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "indirect_dispatch.h"
+#include "elementwise_fusion.h"
+
+enum
+{
+    ELEMENTWISE_MAX_WORKGROUP_SIZE = 256,
+    // The kernels use grid-stride loops, so a few waves of workgroups are enough to saturate the device
+    ELEMENTWISE_MAX_GROUP_COUNT = 4096,
+    ELEMENTWISE_BINDING_COUNT = 2,
+    // dst, src and the indirect args
+    ELEMENTWISE_INDIRECT_BINDING_COUNT = 3,
+
+    ELEMENTWISE_BENCHMARK_LOOP_COUNT = 10
+};
+
+static const char* const s_stepKernelNames[ELEMENTWISE_OP_COUNT] = {
+    "ElementwiseAddKernel",
+    "ElementwiseMulKernel",
+    "ElementwiseXorKernel",
+    "ElementwiseMinKernel",
+    "ElementwiseMaxKernel"
+};
+
+// The generated fused entry points in elementwise_fusion.cl
+static const struct
+{
+    uint32_t opCount;
+    enum ElementwiseOp ops[2];
+    const char* entryName;
+} s_fusedKernels[] = {
+    { 2, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL }, "FusedAddMulKernel" },
+    { 2, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_ADD }, "FusedMulAddKernel" }
+};
+
+enum
+{
+    ELEMENTWISE_FUSED_KERNEL_COUNT = sizeof(s_fusedKernels) / sizeof(s_fusedKernels[0])
+};
+
+static const char s_chainKernelName[] = "ElementwiseChainKernel";
+static const char s_chainIndirectKernelName[] = "ElementwiseChainIndirectKernel";
+
+// layout(push_constant, std430) uniform of ElementwiseChainKernel and ElementwiseChainIndirectKernel. The uint4 operand vectors are 16-byte aligned.
+// The step kernels and the fused kernels take `elemCount` followed by their operands.
+struct ElementwiseChainPushConstants
+{
+    uint32_t elemCount;
+    uint32_t opCount;
+    uint32_t packedOpCodes;
+    // Only ElementwiseChainIndirectKernel reads it, and it is padding for ElementwiseChainKernel
+    uint32_t argsSlot;
+    uint32_t operands[ELEMENTWISE_MAX_CHAIN_LENGTH];
+};
+
+struct ElementwiseContext
+{
+    VkDevice device;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descLayout;
+    // All the kernels share the layout, whose push constant range is large enough for the chain interpreter kernel
+    VkPipelineLayout pipelineLayout;
+    VkPipeline stepPipelines[ELEMENTWISE_OP_COUNT];
+    VkPipeline chainPipeline;
+    VkPipeline fusedPipelines[ELEMENTWISE_FUSED_KERNEL_COUNT];
+    // The chain interpreter over a device side element count, with the indirect args as the third binding
+    VkDescriptorSetLayout indirectDescLayout;
+    VkPipelineLayout indirectPipelineLayout;
+    VkPipeline chainIndirectPipeline;
+    uint32_t workgroupSize;
+    uint32_t maxGroupCount;
+};
+
+struct ElementwiseChainPlan
+{
+    const struct ElementwiseContext* pContext;
+    struct ElementwiseChain chain;
+    // VK_NULL_HANDLE for the unfused plan
+    VkPipeline fusedPipeline;
+    const char* entryName;
+    VkDescriptorPool descriptorPool;
+    // { dst, src } for the first or the only pass
+    VkDescriptorSet srcSet;
+    // { dst, dst } for the in-place passes of the unfused plan
+    VkDescriptorSet inPlaceSet;
+    // VK_NULL_HANDLE except for the indirect plan, whose `srcSet` is { dst, src, args }
+    VkBuffer argsBuffer;
+    uint32_t argsSlot;
+};
+
+static uint32_t DivideRoundUp(uint32_t value, uint32_t divisor)
+{
+    return (uint32_t)(((uint64_t)value + divisor - 1U) / divisor);
+}
+
+static bool IsValidElementwiseChain(const struct ElementwiseChain* pChain)
+{
+    if (pChain->opCount == 0 || pChain->opCount > ELEMENTWISE_MAX_CHAIN_LENGTH)
+    {
+        fprintf(stderr, "An elementwise chain must have 1 ~ %d operations!\n", ELEMENTWISE_MAX_CHAIN_LENGTH);
+        return false;
+    }
+    for (uint32_t i = 0; i < pChain->opCount; i++)
+    {
+        if ((unsigned)pChain->ops[i] >= ELEMENTWISE_OP_COUNT)
+        {
+            fprintf(stderr, "Invalid elementwise operation %d!\n", (int)pChain->ops[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void PackElementwiseChainPushConstants(const struct ElementwiseChain* pChain, uint32_t elemCount, uint32_t argsSlot,
+    struct ElementwiseChainPushConstants* pPushConstants)
+{
+    *pPushConstants = (struct ElementwiseChainPushConstants){ elemCount, pChain->opCount, 0, argsSlot, { 0 } };
+    for (uint32_t i = 0; i < pChain->opCount; i++)
+    {
+        pPushConstants->packedOpCodes |= (uint32_t)pChain->ops[i] << (i * 4U);
+        pPushConstants->operands[i] = pChain->operands[i];
+    }
+}
+
+// Returns the index of the generated fused kernel of `pChain` in `s_fusedKernels`, or -1 if there's none.
+static int FindFusedKernel(const struct ElementwiseChain* pChain)
+{
+    for (int i = 0; i < ELEMENTWISE_FUSED_KERNEL_COUNT; i++)
+    {
+        if (s_fusedKernels[i].opCount == pChain->opCount &&
+            memcmp(s_fusedKernels[i].ops, pChain->ops, pChain->opCount * sizeof(pChain->ops[0])) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+VkResult CreateElementwiseContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits, struct ElementwiseContext** ppContext)
+{
+    struct ElementwiseContext* pContext = calloc(1, sizeof(*pContext));
+    if (pContext == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pContext->device = device;
+
+    uint32_t workgroupSize = ELEMENTWISE_MAX_WORKGROUP_SIZE;
+    if (workgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+        workgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    }
+    if (workgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        workgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    pContext->workgroupSize = workgroupSize;
+    pContext->maxGroupCount = pLimits->maxComputeWorkGroupCount[0] < ELEMENTWISE_MAX_GROUP_COUNT ?
+        pLimits->maxComputeWorkGroupCount[0] : ELEMENTWISE_MAX_GROUP_COUNT;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/elementwise_fusion/elementwise_fusion.spv"))
+        {
+            fprintf(stderr, "shaders/elementwise_fusion/elementwise_fusion.spv has not been built by shaders/elementwise_fusion/build-spv!\n");
+            result = VK_ERROR_INITIALIZATION_FAILED;
+            break;
+        }
+
+        result = CreateShaderModule(device, "shaders/elementwise_fusion/elementwise_fusion.spv", &pContext->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(device, ELEMENTWISE_BINDING_COUNT, &pContext->descLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(device, ELEMENTWISE_INDIRECT_BINDING_COUNT, &pContext->indirectDescLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        result = CreateComputePipelineLayout(device, pContext->descLayout, sizeof(struct ElementwiseChainPushConstants), &pContext->pipelineLayout);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateComputePipelineLayout(device, pContext->indirectDescLayout, sizeof(struct ElementwiseChainPushConstants),
+                &pContext->indirectPipelineLayout);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        const uint32_t specConstants[] = { workgroupSize, 1U, 1U };
+        const uint32_t specConstantCount = (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0]));
+        for (int i = 0; i < ELEMENTWISE_OP_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = CreateComputePipelineWithSpecConstants(device, pContext->shaderModule, s_stepKernelNames[i], pContext->pipelineLayout,
+                specConstants, specConstantCount, &pContext->stepPipelines[i]);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "CreateComputePipelineWithSpecConstants failed for %s!\n", s_stepKernelNames[i]);
+            }
+        }
+        if (result != VK_SUCCESS) break;
+
+        result = CreateComputePipelineWithSpecConstants(device, pContext->shaderModule, s_chainKernelName, pContext->pipelineLayout,
+            specConstants, specConstantCount, &pContext->chainPipeline);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineWithSpecConstants failed for %s!\n", s_chainKernelName);
+            break;
+        }
+
+        result = CreateComputePipelineWithSpecConstants(device, pContext->shaderModule, s_chainIndirectKernelName, pContext->indirectPipelineLayout,
+            specConstants, specConstantCount, &pContext->chainIndirectPipeline);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineWithSpecConstants failed for %s!\n", s_chainIndirectKernelName);
+            break;
+        }
+
+        for (int i = 0; i < ELEMENTWISE_FUSED_KERNEL_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = CreateComputePipelineWithSpecConstants(device, pContext->shaderModule, s_fusedKernels[i].entryName, pContext->pipelineLayout,
+                specConstants, specConstantCount, &pContext->fusedPipelines[i]);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "CreateComputePipelineWithSpecConstants failed for %s!\n", s_fusedKernels[i].entryName);
+            }
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyElementwiseContext(pContext);
+        return result;
+    }
+
+    *ppContext = pContext;
+    return VK_SUCCESS;
+}
+
+void DestroyElementwiseContext(struct ElementwiseContext* pContext)
+{
+    if (pContext == NULL) return;
+
+    const VkDevice device = pContext->device;
+    for (int i = 0; i < ELEMENTWISE_OP_COUNT; i++)
+    {
+        if (pContext->stepPipelines[i] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, pContext->stepPipelines[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+    }
+    for (int i = 0; i < ELEMENTWISE_FUSED_KERNEL_COUNT; i++)
+    {
+        if (pContext->fusedPipelines[i] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, pContext->fusedPipelines[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+    }
+    if (pContext->chainPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pContext->chainPipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    }
+    if (pContext->chainIndirectPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pContext->chainIndirectPipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    }
+    if (pContext->pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pContext->pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pContext->indirectPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pContext->indirectPipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pContext->descLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pContext->descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (pContext->indirectDescLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pContext->indirectDescLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (pContext->shaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, pContext->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+
+    free(pContext);
+}
+
+uint32_t GetElementwiseWorkgroupSize(const struct ElementwiseContext* pContext)
+{
+    return pContext->workgroupSize;
+}
+
+uint32_t GetElementwiseMaxGroupCount(const struct ElementwiseContext* pContext)
+{
+    return pContext->maxGroupCount;
+}
+
+VkResult CreateElementwiseChainPlan(struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    enum ElementwiseFusionMode mode, VkBuffer srcBuffer, VkBuffer dstBuffer, struct ElementwiseChainPlan** ppPlan)
+{
+    if (!IsValidElementwiseChain(pChain)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const VkDevice device = pContext->device;
+    struct ElementwiseChainPlan* pPlan = calloc(1, sizeof(*pPlan));
+    if (pPlan == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pPlan->pContext = pContext;
+    pPlan->chain = *pChain;
+
+    if (mode != ELEMENTWISE_FUSION_NONE)
+    {
+        const int fusedIndex = mode == ELEMENTWISE_FUSION_AUTO ? FindFusedKernel(pChain) : -1;
+        pPlan->fusedPipeline = fusedIndex >= 0 ? pContext->fusedPipelines[fusedIndex] : pContext->chainPipeline;
+        pPlan->entryName = fusedIndex >= 0 ? s_fusedKernels[fusedIndex].entryName : s_chainKernelName;
+    }
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        const VkDescriptorPoolCreateInfo descriptorPoolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .maxSets = 2,
+            .poolSizeCount = 1,
+            .pPoolSizes = (VkDescriptorPoolSize[]) {
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 2 * ELEMENTWISE_BINDING_COUNT }
+            }
+        };
+        result = vkCreateDescriptorPool(device, &descriptorPoolInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pPlan->descriptorPool);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreateDescriptorPool failed: %d\n", result);
+            break;
+        }
+
+        const VkBuffer srcBuffers[ELEMENTWISE_BINDING_COUNT] = { dstBuffer, srcBuffer };
+        result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayout, srcBuffers, ELEMENTWISE_BINDING_COUNT,
+            &pPlan->srcSet);
+        if (result == VK_SUCCESS && pPlan->fusedPipeline == VK_NULL_HANDLE)
+        {
+            const VkBuffer inPlaceBuffers[ELEMENTWISE_BINDING_COUNT] = { dstBuffer, dstBuffer };
+            result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayout, inPlaceBuffers, ELEMENTWISE_BINDING_COUNT,
+                &pPlan->inPlaceSet);
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "AllocateStorageBufferDescriptorSet failed!\n");
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyElementwiseChainPlan(pPlan);
+        return result;
+    }
+
+    *ppPlan = pPlan;
+    return VK_SUCCESS;
+}
+
+VkResult CreateElementwiseIndirectChainPlan(struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer argsBuffer, uint32_t argsSlot, struct ElementwiseChainPlan** ppPlan)
+{
+    if (!IsValidElementwiseChain(pChain)) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct ElementwiseChainPlan* pPlan = calloc(1, sizeof(*pPlan));
+    if (pPlan == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pPlan->pContext = pContext;
+    pPlan->chain = *pChain;
+    pPlan->fusedPipeline = pContext->chainIndirectPipeline;
+    pPlan->entryName = s_chainIndirectKernelName;
+    pPlan->argsBuffer = argsBuffer;
+    pPlan->argsSlot = argsSlot;
+
+    const VkBuffer buffers[ELEMENTWISE_INDIRECT_BINDING_COUNT] = { dstBuffer, srcBuffer, argsBuffer };
+    const VkResult result = CreateStorageBufferDescriptorSet(pContext->device, pContext->indirectDescLayout, buffers, ELEMENTWISE_INDIRECT_BINDING_COUNT,
+        &pPlan->descriptorPool, &pPlan->srcSet);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+        DestroyElementwiseChainPlan(pPlan);
+        return result;
+    }
+
+    *ppPlan = pPlan;
+    return VK_SUCCESS;
+}
+
+void DestroyElementwiseChainPlan(struct ElementwiseChainPlan* pPlan)
+{
+    if (pPlan == NULL) return;
+
+    // The descriptor sets are freed together with the pool
+    if (pPlan->descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(pPlan->pContext->device, pPlan->descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+
+    free(pPlan);
+}
+
+const char* GetElementwiseChainPlanEntryName(const struct ElementwiseChainPlan* pPlan)
+{
+    return pPlan->entryName;
+}
+
+uint32_t GetElementwiseChainPlanPassCount(const struct ElementwiseChainPlan* pPlan)
+{
+    return pPlan->fusedPipeline != VK_NULL_HANDLE ? 1U : pPlan->chain.opCount;
+}
+
+static void RecordElementwiseKernel(VkCommandBuffer commandBuffer, const struct ElementwiseContext* pContext, VkPipeline pipeline,
+    VkDescriptorSet descriptorSet, const void* pPushConstants, uint32_t pushConstantSize, uint32_t elemCount)
+{
+    uint32_t groupCount = DivideRoundUp(elemCount, pContext->workgroupSize);
+    if (groupCount > pContext->maxGroupCount) {
+        groupCount = pContext->maxGroupCount;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pContext->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize, pPushConstants);
+    vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+}
+
+void RecordElementwiseChainIndirect(VkCommandBuffer commandBuffer, const struct ElementwiseChainPlan* pPlan, uint32_t maxElemCount)
+{
+    const struct ElementwiseContext* pContext = pPlan->pContext;
+
+    struct ElementwiseChainPushConstants pushConstants;
+    PackElementwiseChainPushConstants(&pPlan->chain, maxElemCount, pPlan->argsSlot, &pushConstants);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pPlan->fusedPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->indirectPipelineLayout, 0, 1, &pPlan->srcSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pContext->indirectPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatchIndirect(commandBuffer, pPlan->argsBuffer, GetIndirectArgsOffset(pPlan->argsSlot));
+}
+
+void RecordElementwiseChain(VkCommandBuffer commandBuffer, const struct ElementwiseChainPlan* pPlan, uint32_t elemCount)
+{
+    if (elemCount == 0) return;
+
+    const struct ElementwiseContext* pContext = pPlan->pContext;
+    const struct ElementwiseChain* pChain = &pPlan->chain;
+
+    if (pPlan->argsBuffer != VK_NULL_HANDLE)
+    {
+        RecordElementwiseChainIndirect(commandBuffer, pPlan, elemCount);
+        return;
+    }
+
+    if (pPlan->fusedPipeline == pContext->chainPipeline)
+    {
+        struct ElementwiseChainPushConstants pushConstants;
+        PackElementwiseChainPushConstants(pChain, elemCount, 0, &pushConstants);
+        RecordElementwiseKernel(commandBuffer, pContext, pPlan->fusedPipeline, pPlan->srcSet, &pushConstants, sizeof(pushConstants), elemCount);
+        return;
+    }
+
+    if (pPlan->fusedPipeline != VK_NULL_HANDLE)
+    {
+        // elemCount, operand0, operand1, ...
+        uint32_t pushConstants[1 + ELEMENTWISE_MAX_CHAIN_LENGTH] = { elemCount };
+        memcpy(&pushConstants[1], pChain->operands, pChain->opCount * sizeof(pChain->operands[0]));
+        RecordElementwiseKernel(commandBuffer, pContext, pPlan->fusedPipeline, pPlan->srcSet, pushConstants,
+            (1U + pChain->opCount) * (uint32_t)sizeof(uint32_t), elemCount);
+        return;
+    }
+
+    // Unfused: the first operation reads `srcBuffer`, the rest of them update `dstBuffer` in place
+    for (uint32_t i = 0; i < pChain->opCount; i++)
+    {
+        if (i > 0) {
+            RecordComputeToComputeBarrier(commandBuffer);
+        }
+        const uint32_t pushConstants[] = { elemCount, pChain->operands[i] };
+        RecordElementwiseKernel(commandBuffer, pContext, pContext->stepPipelines[pChain->ops[i]], i == 0 ? pPlan->srcSet : pPlan->inPlaceSet,
+            pushConstants, sizeof(pushConstants), elemCount);
+    }
+}
+
+uint32_t ApplyElementwiseChainOnHost(const struct ElementwiseChain* pChain, uint32_t x)
+{
+    for (uint32_t i = 0; i < pChain->opCount; i++)
+    {
+        const uint32_t operand = pChain->operands[i];
+        switch (pChain->ops[i])
+        {
+        case ELEMENTWISE_OP_ADD:
+            x += operand;
+            break;
+
+        case ELEMENTWISE_OP_MUL:
+            x *= operand;
+            break;
+
+        case ELEMENTWISE_OP_XOR:
+            x ^= operand;
+            break;
+
+        case ELEMENTWISE_OP_MIN:
+            x = x < operand ? x : operand;
+            break;
+
+        case ELEMENTWISE_OP_MAX:
+        default:
+            x = x > operand ? x : operand;
+            break;
+        }
+    }
+    return x;
+}
+
+// ---- Test and benchmark ----
+
+enum
+{
+    ELEMENTWISE_VERIFY_CHUNK_SIZE = 64 * 1024,
+    // Enough for the largest element count in `s_testElemCounts`
+    ELEMENTWISE_MAX_VERIFY_CHUNK_COUNT = (1 << 24) / ELEMENTWISE_VERIFY_CHUNK_SIZE
+};
+
+struct ElementwiseVerifyContext
+{
+    const struct ElementwiseChain* pChain;
+    const uint32_t* result;
+    uint32_t elemCount;
+    // The first wrong index of each chunk, or SIZE_MAX. Each chunk is verified by exactly one task, so no synchronization is needed.
+    size_t errorIndices[ELEMENTWISE_MAX_VERIFY_CHUNK_COUNT];
+};
+
+// Verifies the chunks [begin, end)
+static void ElementwiseVerifyTask(void* context, size_t begin, size_t end)
+{
+    struct ElementwiseVerifyContext* ctx = context;
+    for (size_t chunk = begin; chunk < end; chunk++)
+    {
+        ctx->errorIndices[chunk] = SIZE_MAX;
+        const size_t chunkEnd = (chunk + 1) * ELEMENTWISE_VERIFY_CHUNK_SIZE < ctx->elemCount ? (chunk + 1) * ELEMENTWISE_VERIFY_CHUNK_SIZE : ctx->elemCount;
+        for (size_t i = chunk * ELEMENTWISE_VERIFY_CHUNK_SIZE; i < chunkEnd; i++)
+        {
+            // The source elements are filled with their indices
+            if (ctx->result[i] != ApplyElementwiseChainOnHost(ctx->pChain, (uint32_t)i))
+            {
+                ctx->errorIndices[chunk] = i;
+                break;
+            }
+        }
+    }
+}
+
+// Returns the index of the first wrong element of `result`, or SIZE_MAX if all the elements are correct.
+static size_t VerifyElementwiseChainResult(const struct ElementwiseChain* pChain, const uint32_t* result, uint32_t elemCount)
+{
+    struct ElementwiseVerifyContext verifyContext = { pChain, result, elemCount, { 0 } };
+
+    const size_t chunkCount = (elemCount + (size_t)ELEMENTWISE_VERIFY_CHUNK_SIZE - 1) / ELEMENTWISE_VERIFY_CHUNK_SIZE;
+    HostParallelFor(chunkCount, 1, ElementwiseVerifyTask, &verifyContext);
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        if (verifyContext.errorIndices[chunk] != SIZE_MAX) {
+            return verifyContext.errorIndices[chunk];
+        }
+    }
+    return SIZE_MAX;
+}
+
+static const struct
+{
+    const char* name;
+    struct ElementwiseChain chain;
+} s_testChains[] = {
+    // The same computation as IncKernel followed by DoubleKernel in the OpenCL with SPIR-V specific test
+    { "Inc -> Double", { 2, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL }, { 256, 2 } } },
+    { "6-op chain", { 6, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_XOR, ELEMENTWISE_OP_MIN, ELEMENTWISE_OP_MAX, ELEMENTWISE_OP_MUL },
+        { 7, 3, 0x5a5aU, 1U << 30, 12345, 5 } } }
+};
+
+static const char* const s_fusionModeNames[] = { "unfused", "interpreted", "auto" };
+
+static const uint32_t s_testElemCounts[] = { 1U << 20, 1U << 24 };
+
+// Returns the index of the first element where `result` differs from `expected`, or SIZE_MAX if they are identical.
+static size_t FindFirstMismatch(const uint32_t* result, const uint32_t* expected, uint32_t elemCount)
+{
+    if (memcmp(result, expected, (size_t)elemCount * sizeof(uint32_t)) == 0) {
+        return SIZE_MAX;
+    }
+    size_t index = 0;
+    while (result[index] == expected[index]) index++;
+    return index;
+}
+
+// @param unfusedResult: receives the result of ELEMENTWISE_FUSION_NONE, which the fused modes of the same chain must reproduce bit for bit.
+// The unfused mode has to run first.
+static VkResult RunElementwiseChainTest(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer,
+    struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain, enum ElementwiseFusionMode mode,
+    VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer hostBuffer, const uint32_t* hostResult, uint32_t* unfusedResult, uint32_t elemCount)
+{
+    const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+    struct ElementwiseChainPlan* pPlan = NULL;
+
+    VkResult result = CreateElementwiseChainPlan(pContext, pChain, mode, srcBuffer, dstBuffer, &pPlan);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+        return result;
+    }
+
+    do
+    {
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+        RecordComputeToTransferBarrier(commandBuffer);
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = bufferSize };
+        vkCmdCopyBuffer(commandBuffer, dstBuffer, hostBuffer, 1, &copyRegion);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const size_t errorIndex = VerifyElementwiseChainResult(pChain, hostResult, elemCount);
+        if (errorIndex != SIZE_MAX)
+        {
+            fprintf(stderr, "%s: wrong result at [%zu]: %u, expected %u!\n", s_fusionModeNames[mode], errorIndex,
+                hostResult[errorIndex], ApplyElementwiseChainOnHost(pChain, (uint32_t)errorIndex));
+        }
+
+        size_t mismatchIndex = SIZE_MAX;
+        if (mode == ELEMENTWISE_FUSION_NONE) {
+            memcpy(unfusedResult, hostResult, (size_t)elemCount * sizeof(uint32_t));
+        }
+        else
+        {
+            mismatchIndex = FindFirstMismatch(hostResult, unfusedResult, elemCount);
+            if (mismatchIndex != SIZE_MAX)
+            {
+                fprintf(stderr, "%s: differs from unfused at [%zu]: %u, unfused %u!\n", s_fusionModeNames[mode], mismatchIndex,
+                    hostResult[mismatchIndex], unfusedResult[mismatchIndex]);
+            }
+        }
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        for (int loop = 0; loop < ELEMENTWISE_BENCHMARK_LOOP_COUNT; loop++)
+        {
+            if (loop > 0) {
+                RecordComputeToComputeBarrier(commandBuffer);
+            }
+            RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+        }
+
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS) break;
+
+        // Every pass reads and writes each element once
+        const uint32_t passCount = GetElementwiseChainPlanPassCount(pPlan);
+        const double bytesMoved = (double)bufferSize * 2.0 * passCount;
+        const double milliseconds = (double)elapsedTime / 1000000.0 / ELEMENTWISE_BENCHMARK_LOOP_COUNT;
+        const char* entryName = GetElementwiseChainPlanEntryName(pPlan);
+        printf("%-12s %-24s %u pass(es)  %9.2f MB moved  %9.3f ms  %8.2f GB/s  (%s, %s)\n", s_fusionModeNames[mode],
+            entryName != NULL ? entryName : "-", passCount, bytesMoved / (1024.0 * 1024.0), milliseconds,
+            bytesMoved / (milliseconds * 1000000.0), errorIndex == SIZE_MAX ? "verify OK" : "verify FAILED",
+            mode == ELEMENTWISE_FUSION_NONE ? "reference" : mismatchIndex == SIZE_MAX ? "same as unfused" : "differs from unfused");
+    } while (false);
+
+    DestroyElementwiseChainPlan(pPlan);
+
+    return result;
+}
+
+void ElementwiseFusionComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin elementwise kernel fusion test ================\n");
+
+    struct ElementwiseContext* pContext = NULL;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+    VkBuffer srcBuffer = VK_NULL_HANDLE, dstBuffer = VK_NULL_HANDLE, hostBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory srcMemory = VK_NULL_HANDLE, dstMemory = VK_NULL_HANDLE, hostMemory = VK_NULL_HANDLE;
+    void* hostPtr = NULL;
+    uint32_t* unfusedResult = NULL;
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/elementwise_fusion/elementwise_fusion.spv"))
+        {
+            puts("shaders/elementwise_fusion/elementwise_fusion.spv has not been built by shaders/elementwise_fusion/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        VkResult result = CreateElementwiseContext(specDevice, pLimits, &pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        // The buffers are sized for the largest element count and shared by all the runs
+        uint32_t maxElemCount = 0;
+        for (size_t i = 0; i < sizeof(s_testElemCounts) / sizeof(s_testElemCounts[0]); i++)
+        {
+            if (s_testElemCounts[i] > maxElemCount && (uint64_t)s_testElemCounts[i] * sizeof(uint32_t) <= pLimits->maxStorageBufferRange) {
+                maxElemCount = s_testElemCounts[i];
+            }
+        }
+        const VkDeviceSize bufferSize = (VkDeviceSize)maxElemCount * sizeof(uint32_t);
+
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &srcBuffer, &srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &dstBuffer, &dstMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &hostBuffer, &hostMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = vkMapMemory(specDevice, hostMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            hostPtr = NULL;
+            break;
+        }
+
+        unfusedResult = malloc((size_t)bufferSize);
+        if (unfusedResult == NULL)
+        {
+            fprintf(stderr, "Failed to allocate the unfused result!\n");
+            break;
+        }
+
+        // src[i] = i
+        HostParallelFillSequence(hostPtr, maxElemCount, 0);
+        result = BeginOneTimeCommandBuffer(specDevice, commandPool, commandBuffers[0]);
+        if (result != VK_SUCCESS) break;
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = bufferSize };
+        vkCmdCopyBuffer(commandBuffers[0], hostBuffer, srcBuffer, 1, &copyRegion);
+        result = EndAndSubmitCommandBuffer(specDevice, queue, commandBuffers[0]);
+        if (result != VK_SUCCESS) break;
+
+        for (size_t i = 0; i < sizeof(s_testElemCounts) / sizeof(s_testElemCounts[0]) && result == VK_SUCCESS; i++)
+        {
+            const uint32_t elemCount = s_testElemCounts[i];
+            if (elemCount > maxElemCount)
+            {
+                printf("%u elements exceed the storage buffer range and will be skipped.\n", elemCount);
+                continue;
+            }
+
+            for (size_t chainIndex = 0; chainIndex < sizeof(s_testChains) / sizeof(s_testChains[0]) && result == VK_SUCCESS; chainIndex++)
+            {
+                printf("---- %s, %u elements ----\n", s_testChains[chainIndex].name, elemCount);
+                for (int mode = ELEMENTWISE_FUSION_NONE; mode <= ELEMENTWISE_FUSION_AUTO && result == VK_SUCCESS; mode++)
+                {
+                    result = RunElementwiseChainTest(specDevice, queue, commandPool, commandBuffers[0], pContext, &s_testChains[chainIndex].chain,
+                        (enum ElementwiseFusionMode)mode, srcBuffer, dstBuffer, hostBuffer, hostPtr, unfusedResult, elemCount);
+                }
+            }
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "RunElementwiseChainTest failed!\n");
+        }
+    } while (false);
+
+    if (hostPtr != NULL) {
+        vkUnmapMemory(specDevice, hostMemory);
+    }
+    DestroyBufferWithMemory(specDevice, hostBuffer, hostMemory);
+    DestroyBufferWithMemory(specDevice, dstBuffer, dstMemory);
+    DestroyBufferWithMemory(specDevice, srcBuffer, srcMemory);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    DestroyElementwiseContext(pContext);
+    free(unfusedResult);
+
+    puts("\n================ Complete elementwise kernel fusion test ================\n");
+}
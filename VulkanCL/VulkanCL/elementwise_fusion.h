@@ -0,0 +1,89 @@
+#ifndef ELEMENTWISE_FUSION_H
+#define ELEMENTWISE_FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Fusion of chained elementwise uint kernels (shaders/elementwise_fusion/elementwise_fusion.cl).
+// A chain is a sequence of operations, each of which takes the current value and one operand.
+// Unfused, every operation is a separate dispatch that reads and writes the whole buffer.
+// Fused, the chain runs in one dispatch that keeps the intermediate values in registers, either through a generated entry point
+// dedicated to the chain, or through the chain interpreter kernel that handles any chain of up to ELEMENTWISE_MAX_CHAIN_LENGTH operations.
+
+// The op codes must be identical to the ones of ELEMENTWISE_OPS in elementwise_fusion.cl
+enum ElementwiseOp
+{
+    ELEMENTWISE_OP_ADD,
+    ELEMENTWISE_OP_MUL,
+    ELEMENTWISE_OP_XOR,
+    ELEMENTWISE_OP_MIN,
+    ELEMENTWISE_OP_MAX,
+    ELEMENTWISE_OP_COUNT
+};
+
+enum
+{
+    ELEMENTWISE_MAX_CHAIN_LENGTH = 8
+};
+
+struct ElementwiseChain
+{
+    uint32_t opCount;
+    enum ElementwiseOp ops[ELEMENTWISE_MAX_CHAIN_LENGTH];
+    uint32_t operands[ELEMENTWISE_MAX_CHAIN_LENGTH];
+};
+
+enum ElementwiseFusionMode
+{
+    // One dispatch per operation
+    ELEMENTWISE_FUSION_NONE,
+    // The chain interpreter kernel
+    ELEMENTWISE_FUSION_INTERPRETED,
+    // The generated entry point of the chain if the shader module has one, otherwise the chain interpreter kernel
+    ELEMENTWISE_FUSION_AUTO
+};
+
+struct ElementwiseContext;
+struct ElementwiseChainPlan;
+
+extern VkResult CreateElementwiseContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits, struct ElementwiseContext** ppContext);
+extern void DestroyElementwiseContext(struct ElementwiseContext* pContext);
+
+// The workgroup size of the kernels, and the group count beyond which their grid-stride loops take over
+extern uint32_t GetElementwiseWorkgroupSize(const struct ElementwiseContext* pContext);
+extern uint32_t GetElementwiseMaxGroupCount(const struct ElementwiseContext* pContext);
+
+// Applies `pChain` to `srcBuffer` and stores the result in `dstBuffer`. The two buffers must not be the same.
+extern VkResult CreateElementwiseChainPlan(struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    enum ElementwiseFusionMode mode, VkBuffer srcBuffer, VkBuffer dstBuffer, struct ElementwiseChainPlan** ppPlan);
+// Applies `pChain` through the chain interpreter kernel to as many elements as slot `argsSlot` of `argsBuffer` holds,
+// with the group count of the slot, as RecordIndirectGroupCount of indirect_dispatch.h writes them for
+// GetElementwiseWorkgroupSize and GetElementwiseMaxGroupCount. `argsBuffer` is the buffer of struct IndirectArgsBuffer.
+extern VkResult CreateElementwiseIndirectChainPlan(struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer argsBuffer, uint32_t argsSlot, struct ElementwiseChainPlan** ppPlan);
+extern void DestroyElementwiseChainPlan(struct ElementwiseChainPlan* pPlan);
+
+// The entry point name of the fused kernel, or NULL for the unfused plan
+extern const char* GetElementwiseChainPlanEntryName(const struct ElementwiseChainPlan* pPlan);
+// The number of dispatches, each of which reads and writes every element once
+extern uint32_t GetElementwiseChainPlanPassCount(const struct ElementwiseChainPlan* pPlan);
+
+// The commands read `srcBuffer` and write `dstBuffer` in the compute shader stage.
+// The caller is responsible for the barriers before and after them.
+// For the indirect plan, `elemCount` bounds the element count of the args slot, as RecordElementwiseChainIndirect does.
+extern void RecordElementwiseChain(VkCommandBuffer commandBuffer, const struct ElementwiseChainPlan* pPlan, uint32_t elemCount);
+// Records vkCmdDispatchIndirect of the indirect plan, processing no more than `maxElemCount` elements whatever the args slot holds.
+// The slot must be visible to the indirect command read and to the compute shader reads.
+extern void RecordElementwiseChainIndirect(VkCommandBuffer commandBuffer, const struct ElementwiseChainPlan* pPlan, uint32_t maxElemCount);
+
+// The reference of the chain on the host
+extern uint32_t ApplyElementwiseChainOnHost(const struct ElementwiseChain* pChain, uint32_t x);
+
+extern void ElementwiseFusionComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !ELEMENTWISE_FUSION_H
+
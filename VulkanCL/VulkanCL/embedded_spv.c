@@ -0,0 +1,359 @@
+// Generated by tools/embed_spv.py. Do not edit.
+
+#include "embedded_spv.h"
+
+#ifdef _MSC_VER
+#define EMBEDDED_SPIRV_ALIGN   __declspec(align(16))
+#else
+#define EMBEDDED_SPIRV_ALIGN   __attribute__((aligned(16)))
+#endif // _MSC_VER
+
+// shaders/advance/advance.spv: 618 words
+EMBEDDED_SPIRV_ALIGN static const uint32_t s_advance_advance_code[618] = {
+    0x07230203U, 0x00010300U, 0x00150000U, 0x0000006bU, 0x00000000U, 0x00020011U, 0x00000001U, 0x00020011U,
+    0x0000000bU, 0x00020011U, 0x0000003eU, 0x0008000aU, 0x5f565053U, 0x5f52484bU, 0x5f6e6f6eU, 0x616d6573U,
+    0x6369746eU, 0x666e695fU, 0x0000006fU, 0x000a000bU, 0x00000056U, 0x536e6f4eU, 0x6e616d65U, 0x2e636974U,
+    0x70736c43U, 0x66655276U, 0x7463656cU, 0x2e6e6f69U, 0x00000035U, 0x0003000eU, 0x00000000U, 0x00000001U,
+    0x0009000fU, 0x00000005U, 0x0000001bU, 0x61766441U, 0x4b65636eU, 0x656e7265U, 0x0000006cU, 0x00000004U,
+    0x00000005U, 0x00030003U, 0x00000003U, 0x00000078U, 0x00060007U, 0x00000057U, 0x61766441U, 0x4b65636eU,
+    0x656e7265U, 0x0000006cU, 0x00040007U, 0x0000005aU, 0x74734470U, 0x00000000U, 0x00040007U, 0x0000005dU,
+    0x63725370U, 0x00000000U, 0x00060007U, 0x00000060U, 0x72616873U, 0x75426465U, 0x72656666U, 0x00000000U,
+    0x00080007U, 0x00000064U, 0x72616873U, 0x75426465U, 0x72656666U, 0x6d656c45U, 0x6e756f43U, 0x00000074U,
+    0x00050007U, 0x00000067U, 0x6d656c65U, 0x6e756f43U, 0x00000074U, 0x00040047U, 0x00000004U, 0x0000000bU,
+    0x0000001cU, 0x00040047U, 0x00000005U, 0x0000000bU, 0x0000001bU, 0x00040047U, 0x00000009U, 0x0000000bU,
+    0x00000019U, 0x00040047U, 0x0000000cU, 0x00000006U, 0x00000004U, 0x00050048U, 0x0000000dU, 0x00000000U,
+    0x00000023U, 0x00000000U, 0x00030047U, 0x0000000dU, 0x00000002U, 0x00050048U, 0x00000011U, 0x00000000U,
+    0x00000023U, 0x00000000U, 0x00050048U, 0x00000011U, 0x00000001U, 0x00000023U, 0x00000004U, 0x00050048U,
+    0x00000012U, 0x00000000U, 0x00000023U, 0x00000000U, 0x00030047U, 0x00000012U, 0x00000002U, 0x00040047U,
+    0x0000000fU, 0x00000022U, 0x00000000U, 0x00040047U, 0x0000000fU, 0x00000021U, 0x00000000U, 0x00040047U,
+    0x00000010U, 0x00000022U, 0x00000000U, 0x00040047U, 0x00000010U, 0x00000021U, 0x00000001U, 0x00040047U,
+    0x00000015U, 0x00000001U, 0x00000003U, 0x00040047U, 0x00000006U, 0x00000001U, 0x00000000U, 0x00040047U,
+    0x00000007U, 0x00000001U, 0x00000001U, 0x00040047U, 0x00000008U, 0x00000001U, 0x00000002U, 0x00040015U,
+    0x00000001U, 0x00000020U, 0x00000000U, 0x00040017U, 0x00000002U, 0x00000001U, 0x00000003U, 0x00040020U,
+    0x00000003U, 0x00000001U, 0x00000002U, 0x00040032U, 0x00000001U, 0x00000006U, 0x00000001U, 0x00040032U,
+    0x00000001U, 0x00000007U, 0x00000001U, 0x00040032U, 0x00000001U, 0x00000008U, 0x00000001U, 0x00060033U,
+    0x00000002U, 0x00000009U, 0x00000006U, 0x00000007U, 0x00000008U, 0x00040020U, 0x0000000aU, 0x00000006U,
+    0x00000002U, 0x0003001dU, 0x0000000cU, 0x00000001U, 0x0003001eU, 0x0000000dU, 0x0000000cU, 0x00040020U,
+    0x0000000eU, 0x0000000cU, 0x0000000dU, 0x0004001eU, 0x00000011U, 0x00000001U, 0x00000001U, 0x0003001eU,
+    0x00000012U, 0x00000011U, 0x00040020U, 0x00000013U, 0x00000009U, 0x00000012U, 0x00040032U, 0x00000001U,
+    0x00000015U, 0x00000001U, 0x0004001cU, 0x00000016U, 0x00000001U, 0x00000015U, 0x00040020U, 0x00000017U,
+    0x00000004U, 0x00000016U, 0x00020013U, 0x00000019U, 0x00030021U, 0x0000001aU, 0x00000019U, 0x00040020U,
+    0x0000001dU, 0x00000009U, 0x00000011U, 0x0004002bU, 0x00000001U, 0x0000001eU, 0x00000000U, 0x00040020U,
+    0x00000023U, 0x00000001U, 0x00000001U, 0x00020014U, 0x00000029U, 0x00040015U, 0x0000002eU, 0x00000040U,
+    0x00000000U, 0x00040020U, 0x00000030U, 0x00000004U, 0x00000001U, 0x0004002bU, 0x00000001U, 0x00000034U,
+    0x00000002U, 0x0004002bU, 0x00000001U, 0x00000035U, 0x00000108U, 0x0004002bU, 0x00000001U, 0x00000040U,
+    0x00000001U, 0x0004002bU, 0x00000001U, 0x0000004aU, 0x00000003U, 0x00040020U, 0x0000004fU, 0x0000000cU,
+    0x00000001U, 0x0004002bU, 0x00000001U, 0x00000054U, 0x00000050U, 0x0004002bU, 0x00000001U, 0x00000058U,
+    0x00000005U, 0x0004002bU, 0x00000001U, 0x00000062U, 0x00000004U, 0x0004003bU, 0x00000003U, 0x00000004U,
+    0x00000001U, 0x0004003bU, 0x00000003U, 0x00000005U, 0x00000001U, 0x0005003bU, 0x0000000aU, 0x0000000bU,
+    0x00000006U, 0x00000009U, 0x0004003bU, 0x0000000eU, 0x0000000fU, 0x0000000cU, 0x0004003bU, 0x0000000eU,
+    0x00000010U, 0x0000000cU, 0x0004003bU, 0x00000013U, 0x00000014U, 0x00000009U, 0x0004003bU, 0x00000017U,
+    0x00000018U, 0x00000004U, 0x00050036U, 0x00000019U, 0x0000001bU, 0x00000000U, 0x0000001aU, 0x000200f8U,
+    0x0000001cU, 0x00050041U, 0x0000001dU, 0x0000001fU, 0x00000014U, 0x0000001eU, 0x0004003dU, 0x00000011U,
+    0x00000020U, 0x0000001fU, 0x00050051U, 0x00000001U, 0x00000021U, 0x00000020U, 0x00000000U, 0x00050051U,
+    0x00000001U, 0x00000022U, 0x00000020U, 0x00000001U, 0x00050041U, 0x00000023U, 0x00000024U, 0x00000004U,
+    0x0000001eU, 0x0004003dU, 0x00000001U, 0x00000025U, 0x00000024U, 0x00050089U, 0x00000001U, 0x00000026U,
+    0x00000025U, 0x00000022U, 0x00050041U, 0x00000023U, 0x00000027U, 0x00000005U, 0x0000001eU, 0x0004003dU,
+    0x00000001U, 0x00000028U, 0x00000027U, 0x000500b0U, 0x00000029U, 0x0000002aU, 0x00000028U, 0x00000021U,
+    0x000300f7U, 0x00000033U, 0x00000000U, 0x000400faU, 0x0000002aU, 0x0000002dU, 0x00000033U, 0x000200f8U,
+    0x0000002dU, 0x00040071U, 0x0000002eU, 0x0000002fU, 0x00000028U, 0x00050041U, 0x00000030U, 0x00000031U,
+    0x00000018U, 0x0000002fU, 0x0003003eU, 0x00000031U, 0x00000026U, 0x000200f9U, 0x00000033U, 0x000200f8U,
+    0x00000033U, 0x000400e0U, 0x00000034U, 0x00000034U, 0x00000035U, 0x000500abU, 0x00000029U, 0x00000036U,
+    0x00000021U, 0x0000001eU, 0x000300f7U, 0x00000047U, 0x00000000U, 0x000400faU, 0x00000036U, 0x00000039U,
+    0x00000047U, 0x000200f8U, 0x00000039U, 0x000700f5U, 0x00000001U, 0x0000003aU, 0x0000003fU, 0x00000039U,
+    0x0000001eU, 0x00000033U, 0x000700f5U, 0x00000001U, 0x0000003bU, 0x00000041U, 0x00000039U, 0x0000001eU,
+    0x00000033U, 0x00040071U, 0x0000002eU, 0x0000003cU, 0x0000003bU, 0x00050041U, 0x00000030U, 0x0000003dU,
+    0x00000018U, 0x0000003cU, 0x0004003dU, 0x00000001U, 0x0000003eU, 0x0000003dU, 0x00050080U, 0x00000001U,
+    0x0000003fU, 0x0000003eU, 0x0000003aU, 0x00050080U, 0x00000001U, 0x00000041U, 0x0000003bU, 0x00000040U,
+    0x000500aeU, 0x00000029U, 0x00000042U, 0x00000041U, 0x00000021U, 0x000400f6U, 0x00000045U, 0x00000039U,
+    0x00000000U, 0x000400faU, 0x00000042U, 0x00000045U, 0x00000039U, 0x000200f8U, 0x00000045U, 0x000200f9U,
+    0x00000047U, 0x000200f8U, 0x00000047U, 0x000700f5U, 0x00000001U, 0x00000048U, 0x0000001eU, 0x00000033U,
+    0x0000003fU, 0x00000045U, 0x000600a9U, 0x00000001U, 0x00000049U, 0x0000002aU, 0x00000040U, 0x0000001eU,
+    0x0005014eU, 0x00000001U, 0x0000004bU, 0x0000004aU, 0x00000049U, 0x000500aaU, 0x00000029U, 0x0000004cU,
+    0x0000004bU, 0x0000001eU, 0x000600a9U, 0x00000001U, 0x0000004dU, 0x0000004cU, 0x0000001eU, 0x00000048U,
+    0x00040071U, 0x0000002eU, 0x0000004eU, 0x00000026U, 0x00060041U, 0x0000004fU, 0x00000050U, 0x0000000fU,
+    0x0000001eU, 0x0000004eU, 0x00060041U, 0x0000004fU, 0x00000051U, 0x00000010U, 0x0000001eU, 0x0000004eU,
+    0x0004003dU, 0x00000001U, 0x00000052U, 0x00000051U, 0x00050080U, 0x00000001U, 0x00000053U, 0x0000004dU,
+    0x00000052U, 0x000700eaU, 0x00000001U, 0x00000055U, 0x00000050U, 0x00000040U, 0x00000054U, 0x00000053U,
+    0x000100fdU, 0x00010038U, 0x0008000cU, 0x00000019U, 0x00000059U, 0x00000056U, 0x00000001U, 0x0000001bU,
+    0x00000057U, 0x00000058U, 0x0006000cU, 0x00000019U, 0x0000005bU, 0x00000056U, 0x00000002U, 0x0000005aU,
+    0x000a000cU, 0x00000019U, 0x0000005cU, 0x00000056U, 0x00000003U, 0x00000059U, 0x0000001eU, 0x0000001eU,
+    0x0000001eU, 0x0000005bU, 0x0006000cU, 0x00000019U, 0x0000005eU, 0x00000056U, 0x00000002U, 0x0000005dU,
+    0x000a000cU, 0x00000019U, 0x0000005fU, 0x00000056U, 0x00000003U, 0x00000059U, 0x00000040U, 0x0000001eU,
+    0x00000040U, 0x0000005eU, 0x0006000cU, 0x00000019U, 0x00000061U, 0x00000056U, 0x00000002U, 0x00000060U,
+    0x000a000cU, 0x00000019U, 0x00000063U, 0x00000056U, 0x0000000bU, 0x00000059U, 0x00000034U, 0x0000004aU,
+    0x00000062U, 0x00000061U, 0x0006000cU, 0x00000019U, 0x00000065U, 0x00000056U, 0x00000002U, 0x00000064U,
+    0x000a000cU, 0x00000019U, 0x00000066U, 0x00000056U, 0x00000007U, 0x00000059U, 0x0000004aU, 0x0000001eU,
+    0x00000062U, 0x00000065U, 0x0006000cU, 0x00000019U, 0x00000068U, 0x00000056U, 0x00000002U, 0x00000067U,
+    0x000a000cU, 0x00000019U, 0x00000069U, 0x00000056U, 0x00000007U, 0x00000059U, 0x00000062U, 0x00000062U,
+    0x00000062U, 0x00000068U, 0x0008000cU, 0x00000019U, 0x0000006aU, 0x00000056U, 0x0000000cU, 0x0000001eU,
+    0x00000040U, 0x00000034U,
+};
+
+static const struct EmbeddedSpirvEntryPoint s_advance_advance_entryPoints[1] = {
+    { "AdvanceKernel", { 0U, 0U, 0U } },
+};
+
+// shaders/clspv_spec/clspv_spec.spv: 798 words
+EMBEDDED_SPIRV_ALIGN static const uint32_t s_clspv_spec_clspv_spec_code[798] = {
+    0x07230203U, 0x00010300U, 0x00150000U, 0x00000093U, 0x00000000U, 0x00020011U, 0x00000001U, 0x00020011U,
+    0x0000000bU, 0x00020011U, 0x0000115aU, 0x0008000aU, 0x5f565053U, 0x5f52484bU, 0x5f6e6f6eU, 0x616d6573U,
+    0x6369746eU, 0x666e695fU, 0x0000006fU, 0x000a000bU, 0x00000079U, 0x536e6f4eU, 0x6e616d65U, 0x2e636974U,
+    0x70736c43U, 0x66655276U, 0x7463656cU, 0x2e6e6f69U, 0x00000035U, 0x0003000eU, 0x00000000U, 0x00000001U,
+    0x0008000fU, 0x00000005U, 0x0000001fU, 0x4b636e49U, 0x656e7265U, 0x0000006cU, 0x0000000cU, 0x00000013U,
+    0x0009000fU, 0x00000005U, 0x0000005cU, 0x62756f44U, 0x654b656cU, 0x6c656e72U, 0x00000000U, 0x0000000cU,
+    0x00000013U, 0x00030003U, 0x00000003U, 0x00000078U, 0x00050007U, 0x0000007aU, 0x4b636e49U, 0x656e7265U,
+    0x0000006cU, 0x00040007U, 0x0000007dU, 0x74734470U, 0x00000000U, 0x00040007U, 0x00000080U, 0x63725370U,
+    0x00000000U, 0x00050007U, 0x00000083U, 0x6d656c65U, 0x6e756f43U, 0x00000074U, 0x00060007U, 0x00000087U,
+    0x62756f44U, 0x654b656cU, 0x6c656e72U, 0x00000000U, 0x00040007U, 0x00000089U, 0x74734470U, 0x00000000U,
+    0x00040007U, 0x0000008cU, 0x63725370U, 0x00000000U, 0x00050007U, 0x0000008fU, 0x6d656c65U, 0x6e756f43U,
+    0x00000074U, 0x00040047U, 0x0000000cU, 0x0000000bU, 0x0000001cU, 0x00040047U, 0x00000010U, 0x0000000bU,
+    0x00000019U, 0x00040047U, 0x00000013U, 0x0000000bU, 0x0000001bU, 0x00040047U, 0x00000014U, 0x00000006U,
+    0x00000004U, 0x00050048U, 0x00000015U, 0x00000000U, 0x00000023U, 0x00000000U, 0x00030047U, 0x00000015U,
+    0x00000002U, 0x00050048U, 0x00000019U, 0x00000000U, 0x00000023U, 0x00000000U, 0x00050048U, 0x0000001aU,
+    0x00000000U, 0x00000023U, 0x00000000U, 0x00030047U, 0x0000001aU, 0x00000002U, 0x00040047U, 0x00000017U,
+    0x00000022U, 0x00000000U, 0x00040047U, 0x00000017U, 0x00000021U, 0x00000000U, 0x00040047U, 0x00000018U,
+    0x00000022U, 0x00000000U, 0x00040047U, 0x00000018U, 0x00000021U, 0x00000001U, 0x00040047U, 0x00000003U,
+    0x00000006U, 0x00000004U, 0x00040047U, 0x00000007U, 0x00000006U, 0x00000004U, 0x00040047U, 0x0000000dU,
+    0x00000001U, 0x00000000U, 0x00040047U, 0x0000000eU, 0x00000001U, 0x00000001U, 0x00040047U, 0x0000000fU,
+    0x00000001U, 0x00000002U, 0x00040015U, 0x00000001U, 0x00000020U, 0x00000000U, 0x0004002bU, 0x00000001U,
+    0x00000002U, 0x00000400U, 0x0004001cU, 0x00000003U, 0x00000001U, 0x00000002U, 0x00040020U, 0x00000004U,
+    0x00000004U, 0x00000003U, 0x00030016U, 0x00000006U, 0x00000020U, 0x0004001cU, 0x00000007U, 0x00000006U,
+    0x00000002U, 0x00040020U, 0x00000008U, 0x00000004U, 0x00000007U, 0x00040017U, 0x0000000aU, 0x00000001U,
+    0x00000003U, 0x00040020U, 0x0000000bU, 0x00000001U, 0x0000000aU, 0x00040032U, 0x00000001U, 0x0000000dU,
+    0x00000001U, 0x00040032U, 0x00000001U, 0x0000000eU, 0x00000001U, 0x00040032U, 0x00000001U, 0x0000000fU,
+    0x00000001U, 0x00060033U, 0x0000000aU, 0x00000010U, 0x0000000dU, 0x0000000eU, 0x0000000fU, 0x00040020U,
+    0x00000011U, 0x00000006U, 0x0000000aU, 0x0003001dU, 0x00000014U, 0x00000001U, 0x0003001eU, 0x00000015U,
+    0x00000014U, 0x00040020U, 0x00000016U, 0x0000000cU, 0x00000015U, 0x0003001eU, 0x00000019U, 0x00000001U,
+    0x0003001eU, 0x0000001aU, 0x00000019U, 0x00040020U, 0x0000001bU, 0x00000009U, 0x0000001aU, 0x00020013U,
+    0x0000001dU, 0x00030021U, 0x0000001eU, 0x0000001dU, 0x00040020U, 0x00000021U, 0x00000009U, 0x00000019U,
+    0x0004002bU, 0x00000001U, 0x00000022U, 0x00000000U, 0x00040020U, 0x00000026U, 0x00000001U, 0x00000001U,
+    0x00020014U, 0x00000029U, 0x00040015U, 0x00000032U, 0x00000040U, 0x00000000U, 0x00040020U, 0x00000034U,
+    0x00000004U, 0x00000001U, 0x0004002bU, 0x00000001U, 0x00000036U, 0x00000001U, 0x00040020U, 0x00000037U,
+    0x00000004U, 0x00000006U, 0x0004002bU, 0x00000006U, 0x00000039U, 0x3f800000U, 0x0004002bU, 0x00000001U,
+    0x0000003aU, 0x00000002U, 0x0004002bU, 0x00000001U, 0x0000003bU, 0x00000108U, 0x00040020U, 0x00000051U,
+    0x0000000cU, 0x00000001U, 0x0003002aU, 0x00000029U, 0x00000065U, 0x0004002bU, 0x00000001U, 0x0000007bU,
+    0x00000003U, 0x0004002bU, 0x00000001U, 0x00000085U, 0x00000004U, 0x0004003bU, 0x00000004U, 0x00000005U,
+    0x00000004U, 0x0004003bU, 0x00000008U, 0x00000009U, 0x00000004U, 0x0004003bU, 0x0000000bU, 0x0000000cU,
+    0x00000001U, 0x0005003bU, 0x00000011U, 0x00000012U, 0x00000006U, 0x00000010U, 0x0004003bU, 0x0000000bU,
+    0x00000013U, 0x00000001U, 0x0004003bU, 0x00000016U, 0x00000017U, 0x0000000cU, 0x0004003bU, 0x00000016U,
+    0x00000018U, 0x0000000cU, 0x0004003bU, 0x0000001bU, 0x0000001cU, 0x00000009U, 0x00050036U, 0x0000001dU,
+    0x0000001fU, 0x00000000U, 0x0000001eU, 0x000200f8U, 0x00000020U, 0x00050041U, 0x00000021U, 0x00000023U,
+    0x0000001cU, 0x00000022U, 0x0004003dU, 0x00000019U, 0x00000024U, 0x00000023U, 0x00050051U, 0x00000001U,
+    0x00000025U, 0x00000024U, 0x00000000U, 0x00050041U, 0x00000026U, 0x00000027U, 0x0000000cU, 0x00000022U,
+    0x0004003dU, 0x00000001U, 0x00000028U, 0x00000027U, 0x000500b0U, 0x00000029U, 0x0000002aU, 0x00000028U,
+    0x00000025U, 0x000300f7U, 0x00000059U, 0x00000000U, 0x000400faU, 0x0000002aU, 0x0000002dU, 0x00000059U,
+    0x000200f8U, 0x0000002dU, 0x00050041U, 0x00000026U, 0x0000002eU, 0x00000013U, 0x00000022U, 0x0004003dU,
+    0x00000001U, 0x0000002fU, 0x0000002eU, 0x000500c7U, 0x0000000aU, 0x00000030U, 0x00000010U, 0x00000010U,
+    0x00050051U, 0x00000001U, 0x00000031U, 0x00000030U, 0x00000000U, 0x00040071U, 0x00000032U, 0x00000033U,
+    0x0000002fU, 0x00050041U, 0x00000034U, 0x00000035U, 0x00000005U, 0x00000033U, 0x0003003eU, 0x00000035U,
+    0x00000036U, 0x00050041U, 0x00000037U, 0x00000038U, 0x00000009U, 0x00000033U, 0x0003003eU, 0x00000038U,
+    0x00000039U, 0x000400e0U, 0x0000003aU, 0x0000003aU, 0x0000003bU, 0x000500b0U, 0x00000029U, 0x0000003cU,
+    0x00000028U, 0x00000031U, 0x000600a9U, 0x00000034U, 0x0000003dU, 0x0000003cU, 0x00000005U, 0x00000009U,
+    0x000500abU, 0x00000029U, 0x0000003eU, 0x00000031U, 0x00000022U, 0x000300f7U, 0x0000004eU, 0x00000000U,
+    0x000400faU, 0x0000003eU, 0x00000041U, 0x0000004eU, 0x000200f8U, 0x00000041U, 0x000700f5U, 0x00000001U,
+    0x00000042U, 0x00000048U, 0x00000041U, 0x00000022U, 0x0000002dU, 0x000700f5U, 0x00000001U, 0x00000043U,
+    0x00000047U, 0x00000041U, 0x00000022U, 0x0000002dU, 0x00040071U, 0x00000032U, 0x00000044U, 0x00000042U,
+    0x00050043U, 0x00000034U, 0x00000045U, 0x0000003dU, 0x00000044U, 0x0004003dU, 0x00000001U, 0x00000046U,
+    0x00000045U, 0x00050080U, 0x00000001U, 0x00000047U, 0x00000046U, 0x00000043U, 0x00050080U, 0x00000001U,
+    0x00000048U, 0x00000042U, 0x00000036U, 0x000500aeU, 0x00000029U, 0x00000049U, 0x00000048U, 0x00000031U,
+    0x000400f6U, 0x0000004cU, 0x00000041U, 0x00000000U, 0x000400faU, 0x00000049U, 0x0000004cU, 0x00000041U,
+    0x000200f8U, 0x0000004cU, 0x000200f9U, 0x0000004eU, 0x000200f8U, 0x0000004eU, 0x000700f5U, 0x00000001U,
+    0x0000004fU, 0x00000022U, 0x0000002dU, 0x00000047U, 0x0000004cU, 0x00040071U, 0x00000032U, 0x00000050U,
+    0x00000028U, 0x00060041U, 0x00000051U, 0x00000052U, 0x00000018U, 0x00000022U, 0x00000050U, 0x0004003dU,
+    0x00000001U, 0x00000053U, 0x00000052U, 0x00050080U, 0x00000001U, 0x00000054U, 0x00000053U, 0x0000004fU,
+    0x00060041U, 0x00000051U, 0x00000055U, 0x00000017U, 0x00000022U, 0x00000050U, 0x000500aaU, 0x00000029U,
+    0x00000056U, 0x00000028U, 0x00000022U, 0x000600a9U, 0x00000001U, 0x00000057U, 0x00000056U, 0x00000031U,
+    0x00000054U, 0x0003003eU, 0x00000055U, 0x00000057U, 0x000200f9U, 0x00000059U, 0x000200f8U, 0x00000059U,
+    0x000200f9U, 0x0000005bU, 0x000200f8U, 0x0000005bU, 0x000100fdU, 0x00010038U, 0x00050036U, 0x0000001dU,
+    0x0000005cU, 0x00000000U, 0x0000001eU, 0x000200f8U, 0x0000005dU, 0x00050041U, 0x00000021U, 0x0000005eU,
+    0x0000001cU, 0x00000022U, 0x0004003dU, 0x00000019U, 0x0000005fU, 0x0000005eU, 0x00050041U, 0x00000026U,
+    0x00000060U, 0x0000000cU, 0x00000022U, 0x0004003dU, 0x00000001U, 0x00000061U, 0x00000060U, 0x000500abU,
+    0x00000029U, 0x00000062U, 0x00000061U, 0x00000022U, 0x00050051U, 0x00000001U, 0x00000063U, 0x0000005fU,
+    0x00000000U, 0x000500b0U, 0x00000029U, 0x00000064U, 0x00000061U, 0x00000063U, 0x000600a9U, 0x00000029U,
+    0x00000066U, 0x00000062U, 0x00000064U, 0x00000065U, 0x000300f7U, 0x00000078U, 0x00000000U, 0x000400faU,
+    0x00000066U, 0x00000069U, 0x00000078U, 0x000200f8U, 0x00000069U, 0x00040071U, 0x00000032U, 0x0000006aU,
+    0x00000061U, 0x00060041U, 0x00000051U, 0x0000006bU, 0x00000018U, 0x00000022U, 0x0000006aU, 0x0004003dU,
+    0x00000001U, 0x0000006cU, 0x0000006bU, 0x000500c4U, 0x00000001U, 0x0000006dU, 0x0000006cU, 0x00000036U,
+    0x00060041U, 0x00000051U, 0x0000006eU, 0x00000017U, 0x00000022U, 0x0000006aU, 0x0003003eU, 0x0000006eU,
+    0x0000006dU, 0x000500aaU, 0x00000029U, 0x0000006fU, 0x00000061U, 0x00000036U, 0x000300f7U, 0x00000076U,
+    0x00000000U, 0x000400faU, 0x0000006fU, 0x00000072U, 0x00000076U, 0x000200f8U, 0x00000072U, 0x000500c7U,
+    0x0000000aU, 0x00000073U, 0x00000010U, 0x00000010U, 0x00050051U, 0x00000001U, 0x00000074U, 0x00000073U,
+    0x00000000U, 0x0003003eU, 0x0000006eU, 0x00000074U, 0x000200f9U, 0x00000076U, 0x000200f8U, 0x00000076U,
+    0x000200f9U, 0x00000078U, 0x000200f8U, 0x00000078U, 0x000100fdU, 0x00010038U, 0x0008000cU, 0x0000001dU,
+    0x0000007cU, 0x00000079U, 0x00000001U, 0x0000001fU, 0x0000007aU, 0x0000007bU, 0x0006000cU, 0x0000001dU,
+    0x0000007eU, 0x00000079U, 0x00000002U, 0x0000007dU, 0x000a000cU, 0x0000001dU, 0x0000007fU, 0x00000079U,
+    0x00000003U, 0x0000007cU, 0x00000022U, 0x00000022U, 0x00000022U, 0x0000007eU, 0x0006000cU, 0x0000001dU,
+    0x00000081U, 0x00000079U, 0x00000002U, 0x00000080U, 0x000a000cU, 0x0000001dU, 0x00000082U, 0x00000079U,
+    0x00000003U, 0x0000007cU, 0x00000036U, 0x00000022U, 0x00000036U, 0x00000081U, 0x0006000cU, 0x0000001dU,
+    0x00000084U, 0x00000079U, 0x00000002U, 0x00000083U, 0x000a000cU, 0x0000001dU, 0x00000086U, 0x00000079U,
+    0x00000007U, 0x0000007cU, 0x0000003aU, 0x00000022U, 0x00000085U, 0x00000084U, 0x0008000cU, 0x0000001dU,
+    0x00000088U, 0x00000079U, 0x00000001U, 0x0000005cU, 0x00000087U, 0x0000007bU, 0x0006000cU, 0x0000001dU,
+    0x0000008aU, 0x00000079U, 0x00000002U, 0x00000089U, 0x000a000cU, 0x0000001dU, 0x0000008bU, 0x00000079U,
+    0x00000003U, 0x00000088U, 0x00000022U, 0x00000022U, 0x00000022U, 0x0000008aU, 0x0006000cU, 0x0000001dU,
+    0x0000008dU, 0x00000079U, 0x00000002U, 0x0000008cU, 0x000a000cU, 0x0000001dU, 0x0000008eU, 0x00000079U,
+    0x00000003U, 0x00000088U, 0x00000036U, 0x00000022U, 0x00000036U, 0x0000008dU, 0x0006000cU, 0x0000001dU,
+    0x00000090U, 0x00000079U, 0x00000002U, 0x0000008fU, 0x000a000cU, 0x0000001dU, 0x00000091U, 0x00000079U,
+    0x00000007U, 0x00000088U, 0x0000003aU, 0x00000022U, 0x00000085U, 0x00000090U, 0x0008000cU, 0x0000001dU,
+    0x00000092U, 0x00000079U, 0x0000000cU, 0x00000022U, 0x00000036U, 0x0000003aU,
+};
+
+static const struct EmbeddedSpirvEntryPoint s_clspv_spec_clspv_spec_entryPoints[2] = {
+    { "IncKernel", { 0U, 0U, 0U } },
+    { "DoubleKernel", { 0U, 0U, 0U } },
+};
+
+// shaders/phys_buf_storage/buff_addr.spv: 465 words
+EMBEDDED_SPIRV_ALIGN static const uint32_t s_phys_buf_storage_buff_addr_code[465] = {
+    0x07230203U, 0x00010300U, 0x00150000U, 0x00000054U, 0x00000000U, 0x00020011U, 0x00000001U, 0x00020011U,
+    0x0000000bU, 0x00020011U, 0x0000115aU, 0x00020011U, 0x000014e3U, 0x0009000aU, 0x5f565053U, 0x5f52484bU,
+    0x73796870U, 0x6c616369U, 0x6f74735fU, 0x65676172U, 0x6675625fU, 0x00726566U, 0x0008000aU, 0x5f565053U,
+    0x5f52484bU, 0x5f6e6f6eU, 0x616d6573U, 0x6369746eU, 0x666e695fU, 0x0000006fU, 0x000a000bU, 0x00000047U,
+    0x536e6f4eU, 0x6e616d65U, 0x2e636974U, 0x70736c43U, 0x66655276U, 0x7463656cU, 0x2e6e6f69U, 0x00000035U,
+    0x0003000eU, 0x000014e4U, 0x00000001U, 0x0009000fU, 0x00000005U, 0x00000012U, 0x66667542U, 0x64417265U,
+    0x73657264U, 0x72654b73U, 0x006c656eU, 0x00000004U, 0x00030003U, 0x00000003U, 0x00000078U, 0x00070007U,
+    0x00000048U, 0x66667542U, 0x64417265U, 0x73657264U, 0x72654b73U, 0x006c656eU, 0x00030007U, 0x0000004bU,
+    0x00000000U, 0x00030007U, 0x0000004fU, 0x00000000U, 0x00040047U, 0x00000004U, 0x0000000bU, 0x0000001cU,
+    0x00040047U, 0x00000008U, 0x0000000bU, 0x00000019U, 0x00050048U, 0x0000000cU, 0x00000000U, 0x00000023U,
+    0x00000000U, 0x00050048U, 0x0000000cU, 0x00000001U, 0x00000023U, 0x00000008U, 0x00050048U, 0x0000000dU,
+    0x00000000U, 0x00000023U, 0x00000000U, 0x00030047U, 0x0000000dU, 0x00000002U, 0x00040047U, 0x0000001aU,
+    0x00000006U, 0x00000008U, 0x00040047U, 0x00000025U, 0x00000006U, 0x00000004U, 0x00040047U, 0x00000005U,
+    0x00000001U, 0x00000000U, 0x00040047U, 0x00000006U, 0x00000001U, 0x00000001U, 0x00040047U, 0x00000007U,
+    0x00000001U, 0x00000002U, 0x00040015U, 0x00000001U, 0x00000020U, 0x00000000U, 0x00040017U, 0x00000002U,
+    0x00000001U, 0x00000003U, 0x00040020U, 0x00000003U, 0x00000001U, 0x00000002U, 0x00040032U, 0x00000001U,
+    0x00000005U, 0x00000001U, 0x00040032U, 0x00000001U, 0x00000006U, 0x00000001U, 0x00040032U, 0x00000001U,
+    0x00000007U, 0x00000001U, 0x00060033U, 0x00000002U, 0x00000008U, 0x00000005U, 0x00000006U, 0x00000007U,
+    0x00040020U, 0x00000009U, 0x00000006U, 0x00000002U, 0x00040015U, 0x0000000bU, 0x00000040U, 0x00000000U,
+    0x0004001eU, 0x0000000cU, 0x0000000bU, 0x00000001U, 0x0003001eU, 0x0000000dU, 0x0000000cU, 0x00040020U,
+    0x0000000eU, 0x00000009U, 0x0000000dU, 0x00020013U, 0x00000010U, 0x00030021U, 0x00000011U, 0x00000010U,
+    0x00040020U, 0x00000014U, 0x00000009U, 0x0000000cU, 0x0004002bU, 0x00000001U, 0x00000015U, 0x00000000U,
+    0x00040020U, 0x0000001aU, 0x000014e5U, 0x0000000bU, 0x00040020U, 0x0000001cU, 0x00000001U, 0x00000001U,
+    0x00020014U, 0x0000001fU, 0x00040020U, 0x00000025U, 0x000014e5U, 0x00000001U, 0x0005002bU, 0x0000000bU,
+    0x00000027U, 0x00000001U, 0x00000000U, 0x0005002bU, 0x0000000bU, 0x0000002bU, 0x00000000U, 0x00000000U,
+    0x00030029U, 0x0000001fU, 0x0000002eU, 0x0005002bU, 0x0000000bU, 0x00000034U, 0x00000002U, 0x00000000U,
+    0x0004002bU, 0x00000001U, 0x0000003eU, 0x00000001U, 0x0004002bU, 0x00000001U, 0x00000049U, 0x00000002U,
+    0x0004002bU, 0x00000001U, 0x0000004dU, 0x00000008U, 0x0004002bU, 0x00000001U, 0x00000051U, 0x00000004U,
+    0x0004003bU, 0x00000003U, 0x00000004U, 0x00000001U, 0x0005003bU, 0x00000009U, 0x0000000aU, 0x00000006U,
+    0x00000008U, 0x0004003bU, 0x0000000eU, 0x0000000fU, 0x00000009U, 0x00050036U, 0x00000010U, 0x00000012U,
+    0x00000000U, 0x00000011U, 0x000200f8U, 0x00000013U, 0x00050041U, 0x00000014U, 0x00000016U, 0x0000000fU,
+    0x00000015U, 0x0006003dU, 0x0000000cU, 0x00000017U, 0x00000016U, 0x00000002U, 0x00000008U, 0x00050051U,
+    0x0000000bU, 0x00000018U, 0x00000017U, 0x00000000U, 0x00050051U, 0x00000001U, 0x00000019U, 0x00000017U,
+    0x00000001U, 0x00040078U, 0x0000001aU, 0x0000001bU, 0x00000018U, 0x00050041U, 0x0000001cU, 0x0000001dU,
+    0x00000004U, 0x00000015U, 0x0006003dU, 0x00000001U, 0x0000001eU, 0x0000001dU, 0x00000002U, 0x00000010U,
+    0x000500b0U, 0x0000001fU, 0x00000020U, 0x0000001eU, 0x00000019U, 0x000300f7U, 0x00000046U, 0x00000000U,
+    0x000400faU, 0x00000020U, 0x00000023U, 0x00000046U, 0x000200f8U, 0x00000023U, 0x0006003dU, 0x0000000bU,
+    0x00000024U, 0x0000001bU, 0x00000002U, 0x00000008U, 0x00040078U, 0x00000025U, 0x00000026U, 0x00000024U,
+    0x00050043U, 0x0000001aU, 0x00000028U, 0x0000001bU, 0x00000027U, 0x0006003dU, 0x0000000bU, 0x00000029U,
+    0x00000028U, 0x00000002U, 0x00000008U, 0x00040078U, 0x00000025U, 0x0000002aU, 0x00000029U, 0x000500aaU,
+    0x0000001fU, 0x0000002cU, 0x00000024U, 0x0000002bU, 0x000500aaU, 0x0000001fU, 0x0000002dU, 0x00000029U,
+    0x0000002bU, 0x000600a9U, 0x0000001fU, 0x0000002fU, 0x0000002cU, 0x0000002eU, 0x0000002dU, 0x000400a8U,
+    0x0000001fU, 0x00000030U, 0x0000002fU, 0x000300f7U, 0x00000044U, 0x00000000U, 0x000400faU, 0x00000030U,
+    0x00000033U, 0x00000044U, 0x000200f8U, 0x00000033U, 0x00050043U, 0x0000001aU, 0x00000035U, 0x0000001bU,
+    0x00000034U, 0x0006003dU, 0x0000000bU, 0x00000036U, 0x00000035U, 0x00000002U, 0x00000008U, 0x000500aaU,
+    0x0000001fU, 0x00000037U, 0x00000036U, 0x0000002bU, 0x000300f7U, 0x00000042U, 0x00000000U, 0x000400faU,
+    0x00000037U, 0x0000003aU, 0x00000042U, 0x000200f8U, 0x0000003aU, 0x00040071U, 0x0000000bU, 0x0000003bU,
+    0x0000001eU, 0x00050043U, 0x00000025U, 0x0000003cU, 0x0000002aU, 0x0000003bU, 0x0006003dU, 0x00000001U,
+    0x0000003dU, 0x0000003cU, 0x00000002U, 0x00000004U, 0x000500c4U, 0x00000001U, 0x0000003fU, 0x0000003dU,
+    0x0000003eU, 0x00050043U, 0x00000025U, 0x00000040U, 0x00000026U, 0x0000003bU, 0x0005003eU, 0x00000040U,
+    0x0000003fU, 0x00000002U, 0x00000004U, 0x000200f9U, 0x00000042U, 0x000200f8U, 0x00000042U, 0x000200f9U,
+    0x00000044U, 0x000200f8U, 0x00000044U, 0x000200f9U, 0x00000046U, 0x000200f8U, 0x00000046U, 0x000100fdU,
+    0x00010038U, 0x0008000cU, 0x00000010U, 0x0000004aU, 0x00000047U, 0x00000001U, 0x00000012U, 0x00000048U,
+    0x00000049U, 0x0006000cU, 0x00000010U, 0x0000004cU, 0x00000047U, 0x00000002U, 0x0000004bU, 0x000a000cU,
+    0x00000010U, 0x0000004eU, 0x00000047U, 0x0000001aU, 0x0000004aU, 0x00000015U, 0x00000015U, 0x0000004dU,
+    0x0000004cU, 0x0006000cU, 0x00000010U, 0x00000050U, 0x00000047U, 0x00000002U, 0x0000004fU, 0x000a000cU,
+    0x00000010U, 0x00000052U, 0x00000047U, 0x00000007U, 0x0000004aU, 0x0000003eU, 0x0000004dU, 0x00000051U,
+    0x00000050U, 0x0008000cU, 0x00000010U, 0x00000053U, 0x00000047U, 0x0000000cU, 0x00000015U, 0x0000003eU,
+    0x00000049U,
+};
+
+static const struct EmbeddedSpirvEntryPoint s_phys_buf_storage_buff_addr_entryPoints[1] = {
+    { "BufferAddressKernel", { 0U, 0U, 0U } },
+};
+
+// shaders/simple/simple.spv: 569 words
+EMBEDDED_SPIRV_ALIGN static const uint32_t s_simple_simple_code[569] = {
+    0x07230203U, 0x00010300U, 0x00150000U, 0x00000069U, 0x00000000U, 0x00020011U, 0x00000001U, 0x00020011U,
+    0x0000000bU, 0x0008000aU, 0x5f565053U, 0x5f52484bU, 0x5f6e6f6eU, 0x616d6573U, 0x6369746eU, 0x666e695fU,
+    0x0000006fU, 0x000a000bU, 0x0000005cU, 0x536e6f4eU, 0x6e616d65U, 0x2e636974U, 0x70736c43U, 0x66655276U,
+    0x7463656cU, 0x2e6e6f69U, 0x00000035U, 0x0003000eU, 0x00000000U, 0x00000001U, 0x0009000fU, 0x00000005U,
+    0x0000001bU, 0x706d6953U, 0x654b656cU, 0x6c656e72U, 0x00000000U, 0x00000008U, 0x00000009U, 0x00030003U,
+    0x00000003U, 0x00000078U, 0x00060007U, 0x0000005dU, 0x706d6953U, 0x654b656cU, 0x6c656e72U, 0x00000000U,
+    0x00040007U, 0x0000005fU, 0x74734470U, 0x00000000U, 0x00040007U, 0x00000062U, 0x63725370U, 0x00000000U,
+    0x00050007U, 0x00000065U, 0x6d656c65U, 0x6e756f43U, 0x00000074U, 0x00040047U, 0x00000008U, 0x0000000bU,
+    0x0000001cU, 0x00040047U, 0x00000009U, 0x0000000bU, 0x0000001bU, 0x00040047U, 0x0000000dU, 0x0000000bU,
+    0x00000019U, 0x00040047U, 0x00000010U, 0x00000006U, 0x00000004U, 0x00050048U, 0x00000011U, 0x00000000U,
+    0x00000023U, 0x00000000U, 0x00030047U, 0x00000011U, 0x00000002U, 0x00050048U, 0x00000015U, 0x00000000U,
+    0x00000023U, 0x00000000U, 0x00050048U, 0x00000016U, 0x00000000U, 0x00000023U, 0x00000000U, 0x00030047U,
+    0x00000016U, 0x00000002U, 0x00040047U, 0x00000013U, 0x00000022U, 0x00000000U, 0x00040047U, 0x00000013U,
+    0x00000021U, 0x00000000U, 0x00040047U, 0x00000014U, 0x00000022U, 0x00000000U, 0x00040047U, 0x00000014U,
+    0x00000021U, 0x00000001U, 0x00040047U, 0x00000003U, 0x00000006U, 0x00000004U, 0x00040047U, 0x0000000aU,
+    0x00000001U, 0x00000000U, 0x00040047U, 0x0000000bU, 0x00000001U, 0x00000001U, 0x00040047U, 0x0000000cU,
+    0x00000001U, 0x00000002U, 0x00040015U, 0x00000001U, 0x00000020U, 0x00000000U, 0x0004002bU, 0x00000001U,
+    0x00000002U, 0x00000020U, 0x0004001cU, 0x00000003U, 0x00000001U, 0x00000002U, 0x00040020U, 0x00000004U,
+    0x00000004U, 0x00000003U, 0x00040017U, 0x00000006U, 0x00000001U, 0x00000003U, 0x00040020U, 0x00000007U,
+    0x00000001U, 0x00000006U, 0x00040032U, 0x00000001U, 0x0000000aU, 0x00000001U, 0x00040032U, 0x00000001U,
+    0x0000000bU, 0x00000001U, 0x00040032U, 0x00000001U, 0x0000000cU, 0x00000001U, 0x00060033U, 0x00000006U,
+    0x0000000dU, 0x0000000aU, 0x0000000bU, 0x0000000cU, 0x00040020U, 0x0000000eU, 0x00000006U, 0x00000006U,
+    0x0003001dU, 0x00000010U, 0x00000001U, 0x0003001eU, 0x00000011U, 0x00000010U, 0x00040020U, 0x00000012U,
+    0x0000000cU, 0x00000011U, 0x0003001eU, 0x00000015U, 0x00000001U, 0x0003001eU, 0x00000016U, 0x00000015U,
+    0x00040020U, 0x00000017U, 0x00000009U, 0x00000016U, 0x00020013U, 0x00000019U, 0x00030021U, 0x0000001aU,
+    0x00000019U, 0x00040020U, 0x0000001dU, 0x00000009U, 0x00000015U, 0x0004002bU, 0x00000001U, 0x0000001eU,
+    0x00000000U, 0x00040020U, 0x00000022U, 0x00000001U, 0x00000001U, 0x00020014U, 0x00000027U, 0x0004002bU,
+    0x00000001U, 0x00000030U, 0x00000001U, 0x00040015U, 0x00000033U, 0x00000040U, 0x00000000U, 0x00040020U,
+    0x00000035U, 0x00000004U, 0x00000001U, 0x0004002bU, 0x00000001U, 0x00000039U, 0x00000002U, 0x0004002bU,
+    0x00000001U, 0x0000003aU, 0x00000108U, 0x0004002bU, 0x00000001U, 0x0000003cU, 0x00000003U, 0x0004002bU,
+    0x00000001U, 0x0000003eU, 0x00000004U, 0x0004002bU, 0x00000001U, 0x00000049U, 0x0000001fU, 0x0004002bU,
+    0x00000001U, 0x0000004eU, 0x0000003cU, 0x00040020U, 0x00000051U, 0x0000000cU, 0x00000001U, 0x0004003bU,
+    0x00000004U, 0x00000005U, 0x00000004U, 0x0004003bU, 0x00000007U, 0x00000008U, 0x00000001U, 0x0004003bU,
+    0x00000007U, 0x00000009U, 0x00000001U, 0x0005003bU, 0x0000000eU, 0x0000000fU, 0x00000006U, 0x0000000dU,
+    0x0004003bU, 0x00000012U, 0x00000013U, 0x0000000cU, 0x0004003bU, 0x00000012U, 0x00000014U, 0x0000000cU,
+    0x0004003bU, 0x00000017U, 0x00000018U, 0x00000009U, 0x00050036U, 0x00000019U, 0x0000001bU, 0x00000000U,
+    0x0000001aU, 0x000200f8U, 0x0000001cU, 0x00050041U, 0x0000001dU, 0x0000001fU, 0x00000018U, 0x0000001eU,
+    0x0004003dU, 0x00000015U, 0x00000020U, 0x0000001fU, 0x00050051U, 0x00000001U, 0x00000021U, 0x00000020U,
+    0x00000000U, 0x00050041U, 0x00000022U, 0x00000023U, 0x00000008U, 0x0000001eU, 0x0004003dU, 0x00000001U,
+    0x00000024U, 0x00000023U, 0x00050041U, 0x00000022U, 0x00000025U, 0x00000009U, 0x0000001eU, 0x0004003dU,
+    0x00000001U, 0x00000026U, 0x00000025U, 0x000500b0U, 0x00000027U, 0x00000028U, 0x00000024U, 0x00000021U,
+    0x000300f7U, 0x00000059U, 0x00000000U, 0x000400faU, 0x00000028U, 0x0000002bU, 0x00000059U, 0x000200f8U,
+    0x0000002bU, 0x000500b0U, 0x00000027U, 0x0000002cU, 0x00000026U, 0x00000002U, 0x000300f7U, 0x00000038U,
+    0x00000000U, 0x000400faU, 0x0000002cU, 0x0000002fU, 0x00000038U, 0x000200f8U, 0x0000002fU, 0x000500acU,
+    0x00000027U, 0x00000031U, 0x00000026U, 0x00000030U, 0x000600a9U, 0x00000001U, 0x00000032U, 0x00000031U,
+    0x00000030U, 0x0000001eU, 0x00040071U, 0x00000033U, 0x00000034U, 0x00000026U, 0x00050041U, 0x00000035U,
+    0x00000036U, 0x00000005U, 0x00000034U, 0x0003003eU, 0x00000036U, 0x00000032U, 0x000200f9U, 0x00000038U,
+    0x000200f8U, 0x00000038U, 0x000400e0U, 0x00000039U, 0x00000039U, 0x0000003aU, 0x00050080U, 0x00000001U,
+    0x0000003bU, 0x00000039U, 0x00000030U, 0x00050080U, 0x00000001U, 0x0000003dU, 0x0000003cU, 0x0000003bU,
+    0x00050080U, 0x00000001U, 0x0000003fU, 0x0000003eU, 0x0000003dU, 0x000200f9U, 0x00000041U, 0x000200f8U,
+    0x00000041U, 0x000700f5U, 0x00000001U, 0x00000042U, 0x00000047U, 0x00000041U, 0x0000003fU, 0x00000038U,
+    0x000700f5U, 0x00000001U, 0x00000043U, 0x00000048U, 0x00000041U, 0x0000001eU, 0x00000038U, 0x00040071U,
+    0x00000033U, 0x00000044U, 0x00000043U, 0x00050041U, 0x00000035U, 0x00000045U, 0x00000005U, 0x00000044U,
+    0x0004003dU, 0x00000001U, 0x00000046U, 0x00000045U, 0x00050080U, 0x00000001U, 0x00000047U, 0x00000046U,
+    0x00000042U, 0x00050080U, 0x00000001U, 0x00000048U, 0x00000043U, 0x00000030U, 0x000500aeU, 0x00000027U,
+    0x0000004aU, 0x00000043U, 0x00000049U, 0x000400f6U, 0x0000004dU, 0x00000041U, 0x00000000U, 0x000400faU,
+    0x0000004aU, 0x0000004dU, 0x00000041U, 0x000200f8U, 0x0000004dU, 0x00050080U, 0x00000001U, 0x0000004fU,
+    0x00000047U, 0x0000004eU, 0x00040071U, 0x00000033U, 0x00000050U, 0x00000024U, 0x00060041U, 0x00000051U,
+    0x00000052U, 0x00000014U, 0x0000001eU, 0x00000050U, 0x0004003dU, 0x00000001U, 0x00000053U, 0x00000052U,
+    0x00050080U, 0x00000001U, 0x00000054U, 0x0000004fU, 0x00000053U, 0x00060041U, 0x00000051U, 0x00000055U,
+    0x00000013U, 0x0000001eU, 0x00000050U, 0x0004003dU, 0x00000001U, 0x00000056U, 0x00000055U, 0x00050080U,
+    0x00000001U, 0x00000057U, 0x00000054U, 0x00000056U, 0x0003003eU, 0x00000055U, 0x00000057U, 0x000200f9U,
+    0x00000059U, 0x000200f8U, 0x00000059U, 0x000200f9U, 0x0000005bU, 0x000200f8U, 0x0000005bU, 0x000100fdU,
+    0x00010038U, 0x0008000cU, 0x00000019U, 0x0000005eU, 0x0000005cU, 0x00000001U, 0x0000001bU, 0x0000005dU,
+    0x0000003cU, 0x0006000cU, 0x00000019U, 0x00000060U, 0x0000005cU, 0x00000002U, 0x0000005fU, 0x000a000cU,
+    0x00000019U, 0x00000061U, 0x0000005cU, 0x00000003U, 0x0000005eU, 0x0000001eU, 0x0000001eU, 0x0000001eU,
+    0x00000060U, 0x0006000cU, 0x00000019U, 0x00000063U, 0x0000005cU, 0x00000002U, 0x00000062U, 0x000a000cU,
+    0x00000019U, 0x00000064U, 0x0000005cU, 0x00000003U, 0x0000005eU, 0x00000030U, 0x0000001eU, 0x00000030U,
+    0x00000063U, 0x0006000cU, 0x00000019U, 0x00000066U, 0x0000005cU, 0x00000002U, 0x00000065U, 0x000a000cU,
+    0x00000019U, 0x00000067U, 0x0000005cU, 0x00000007U, 0x0000005eU, 0x00000039U, 0x0000001eU, 0x0000003eU,
+    0x00000066U, 0x0008000cU, 0x00000019U, 0x00000068U, 0x0000005cU, 0x0000000cU, 0x0000001eU, 0x00000030U,
+    0x00000039U,
+};
+
+static const struct EmbeddedSpirvEntryPoint s_simple_simple_entryPoints[1] = {
+    { "SimpleKernel", { 0U, 0U, 0U } },
+};
+
+const struct EmbeddedSpirvModule g_embeddedSpirvModules[EMBEDDED_SPIRV_MODULE_COUNT > 0 ? EMBEDDED_SPIRV_MODULE_COUNT : 1] = {
+    { "shaders/advance/advance.spv", s_advance_advance_code, sizeof(s_advance_advance_code), s_advance_advance_entryPoints, 1U },
+    { "shaders/clspv_spec/clspv_spec.spv", s_clspv_spec_clspv_spec_code, sizeof(s_clspv_spec_clspv_spec_code), s_clspv_spec_clspv_spec_entryPoints, 2U },
+    { "shaders/phys_buf_storage/buff_addr.spv", s_phys_buf_storage_buff_addr_code, sizeof(s_phys_buf_storage_buff_addr_code), s_phys_buf_storage_buff_addr_entryPoints, 1U },
+    { "shaders/simple/simple.spv", s_simple_simple_code, sizeof(s_simple_simple_code), s_simple_simple_entryPoints, 1U },
+};
+
@@ -0,0 +1,70 @@
+// Generated by tools/embed_spv.py. Do not edit.
+
+// Not embedded since they had not been generated, and loaded from the file system at runtime:
+//   shaders/convolution/convolution.spv
+//   shaders/elementwise_fusion/elementwise_fusion.spv
+//   shaders/indirect_dispatch/indirect_dispatch.spv
+//   shaders/iterative/iterative.spv
+//   shaders/persistent_queue/persistent_queue.spv
+//   shaders/radix_sort/radix_sort_u32_r4.spv
+//   shaders/radix_sort/radix_sort_u32_r8.spv
+//   shaders/radix_sort/radix_sort_u64_r4.spv
+//   shaders/radix_sort/radix_sort_u64_r8.spv
+//   shaders/scan/scan.spv
+//   shaders/scan/scan_subgroup.spv
+//   shaders/sgemm/sgemm.spv
+
+#ifndef EMBEDDED_SPV_H
+#define EMBEDDED_SPV_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct EmbeddedSpirvEntryPoint
+{
+    const char* name;
+    // The LocalSize execution mode, or all 0s if the workgroup size is only given by the specialization constants
+    uint32_t localSize[3];
+};
+
+struct EmbeddedSpirvModule
+{
+    // The path relative to the project directory, as passed to CreateShaderModule
+    const char* fileName;
+    const uint32_t* code;
+    size_t codeSize;
+    const struct EmbeddedSpirvEntryPoint* entryPoints;
+    uint32_t entryPointCount;
+};
+
+enum EmbeddedSpirvModuleIndex
+{
+    EMBEDDED_SPIRV_ADVANCE_ADVANCE,
+    EMBEDDED_SPIRV_CLSPV_SPEC_CLSPV_SPEC,
+    EMBEDDED_SPIRV_PHYS_BUF_STORAGE_BUFF_ADDR,
+    EMBEDDED_SPIRV_SIMPLE_SIMPLE,
+    EMBEDDED_SPIRV_MODULE_COUNT
+};
+
+// shaders/advance/advance.spv
+#define EMBEDDED_SPIRV_ADVANCE_ADVANCE_ENTRY_POINT_COUNT    1
+#define EMBEDDED_SPIRV_ADVANCE_ADVANCE_HAS_ADVANCEKERNEL    1
+
+// shaders/clspv_spec/clspv_spec.spv
+#define EMBEDDED_SPIRV_CLSPV_SPEC_CLSPV_SPEC_ENTRY_POINT_COUNT    2
+#define EMBEDDED_SPIRV_CLSPV_SPEC_CLSPV_SPEC_HAS_INCKERNEL    1
+#define EMBEDDED_SPIRV_CLSPV_SPEC_CLSPV_SPEC_HAS_DOUBLEKERNEL    1
+
+// shaders/phys_buf_storage/buff_addr.spv
+#define EMBEDDED_SPIRV_PHYS_BUF_STORAGE_BUFF_ADDR_ENTRY_POINT_COUNT    1
+#define EMBEDDED_SPIRV_PHYS_BUF_STORAGE_BUFF_ADDR_HAS_BUFFERADDRESSKERNEL    1
+
+// shaders/simple/simple.spv
+#define EMBEDDED_SPIRV_SIMPLE_SIMPLE_ENTRY_POINT_COUNT    1
+#define EMBEDDED_SPIRV_SIMPLE_SIMPLE_HAS_SIMPLEKERNEL    1
+
+// Indexed by `enum EmbeddedSpirvModuleIndex`. The code of every module is 16-byte aligned.
+extern const struct EmbeddedSpirvModule g_embeddedSpirvModules[EMBEDDED_SPIRV_MODULE_COUNT > 0 ? EMBEDDED_SPIRV_MODULE_COUNT : 1];
+
+#endif // !EMBEDDED_SPV_H
+
@@ -0,0 +1,1120 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif // !_WIN32
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "dedicated_allocation.h"
+#include "elementwise_fusion.h"
+#include "external_memory.h"
+
+#ifndef _WIN32
+
+enum
+{
+    EXTERNAL_MEMORY_MESSAGE_MAGIC = 0x564b4d46U,    // 'VKMF'
+    EXTERNAL_MEMORY_MAX_GPU_COUNT = 8,
+    EXTERNAL_MEMORY_MAX_QUEUE_FAMILY_COUNT = 8,
+
+    EXTERNAL_MEMORY_TEST_ELEM_COUNT = 4 * 1024 * 1024
+};
+
+static const VkBufferUsageFlags s_externalBufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+    VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+// What the exporter sends with the fds of the buffer memory and of the semaphore
+struct ExternalMemoryMessage
+{
+    uint32_t magic;
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    uint8_t driverUUID[VK_UUID_SIZE];
+    uint64_t bufferSize;
+    uint64_t allocationSize;
+    uint32_t memoryTypeIndex;
+    uint32_t dedicated;
+    uint32_t elemCount;
+    // The chain the exporter ran, with which the importer verifies the contents of the buffer
+    struct ElementwiseChain chain;
+};
+
+// What the importer replies
+struct ExternalMemoryReply
+{
+    uint32_t magic;
+    int32_t result;
+    uint32_t verified;
+    uint64_t setupTime;
+    uint64_t importTime;
+    uint64_t readTime;
+};
+
+bool QueryExternalMemoryFdSupport(VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, bool* pDedicatedOnly)
+{
+    const VkPhysicalDeviceExternalBufferInfo bufferInfo = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_BUFFER_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .usage = usage,
+        .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    VkExternalBufferProperties bufferProperties = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_BUFFER_PROPERTIES,
+        .pNext = NULL
+    };
+    vkGetPhysicalDeviceExternalBufferProperties(physicalDevice, &bufferInfo, &bufferProperties);
+
+    const VkPhysicalDeviceExternalSemaphoreInfo semaphoreInfo = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO,
+        .pNext = NULL,
+        .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    VkExternalSemaphoreProperties semaphoreProperties = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES,
+        .pNext = NULL
+    };
+    vkGetPhysicalDeviceExternalSemaphoreProperties(physicalDevice, &semaphoreInfo, &semaphoreProperties);
+
+    const VkExternalMemoryFeatureFlags memoryFeatures = bufferProperties.externalMemoryProperties.externalMemoryFeatures;
+    if (pDedicatedOnly != NULL) {
+        *pDedicatedOnly = (memoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_DEDICATED_ONLY_BIT) != 0;
+    }
+    const VkExternalMemoryFeatureFlags requiredMemoryFeatures = VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT | VK_EXTERNAL_MEMORY_FEATURE_IMPORTABLE_BIT;
+    const VkExternalSemaphoreFeatureFlags requiredSemaphoreFeatures = VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT |
+        VK_EXTERNAL_SEMAPHORE_FEATURE_IMPORTABLE_BIT;
+    return (memoryFeatures & requiredMemoryFeatures) == requiredMemoryFeatures &&
+        (semaphoreProperties.externalSemaphoreFeatures & requiredSemaphoreFeatures) == requiredSemaphoreFeatures;
+}
+
+static VkResult CreateExternalBufferObject(VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage, uint32_t queueFamilyIndex, VkBuffer* pBuffer)
+{
+    const VkExternalMemoryBufferCreateInfo externalInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = &externalInfo,
+        .flags = 0,
+        .size = size,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
+    };
+    const VkResult result = vkCreateBuffer(device, &bufferCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), pBuffer);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateBuffer failed: %d\n", result);
+    }
+    return result;
+}
+
+VkResult CreateExportableBuffer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags requiredFlags, bool dedicatedOnly, uint32_t queueFamilyIndex, struct ExternalBuffer* pBuffer)
+{
+    memset(pBuffer, 0, sizeof(*pBuffer));
+    pBuffer->size = size;
+
+    VkResult result = CreateExternalBufferObject(device, size, usage, queueFamilyIndex, &pBuffer->buffer);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    VkMemoryRequirements requirements;
+    pBuffer->dedicated = GetBufferMemoryRequirementsForPolicy(device, pBuffer->buffer, &requirements) || dedicatedOnly;
+
+    const VkMemoryDedicatedAllocateInfo dedicatedInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .pNext = NULL,
+        .image = VK_NULL_HANDLE,
+        .buffer = pBuffer->buffer
+    };
+    const VkExportMemoryAllocateInfo exportInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+        .pNext = pBuffer->dedicated ? &dedicatedInfo : NULL,
+        .handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    result = AllocateMemoryWithinBudget(device, pMemoryProperties, &requirements, requiredFlags, &exportInfo, &pBuffer->memory,
+        &pBuffer->memoryTypeIndex);
+    if (result != VK_SUCCESS)
+    {
+        DestroyExternalBuffer(device, pBuffer);
+        return result;
+    }
+    pBuffer->allocationSize = requirements.size;
+
+    result = vkBindBufferMemory(device, pBuffer->buffer, pBuffer->memory, 0);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBindBufferMemory failed: %d\n", result);
+        DestroyExternalBuffer(device, pBuffer);
+    }
+    return result;
+}
+
+VkResult ImportExternalBuffer(VkDevice device, VkBufferUsageFlags usage, uint32_t queueFamilyIndex, int fd, struct ExternalBuffer* pBuffer)
+{
+    pBuffer->buffer = VK_NULL_HANDLE;
+    pBuffer->memory = VK_NULL_HANDLE;
+
+    VkResult result = CreateExternalBufferObject(device, pBuffer->size, usage, queueFamilyIndex, &pBuffer->buffer);
+    do
+    {
+        if (result != VK_SUCCESS) break;
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(device, pBuffer->buffer, &requirements);
+        if (pBuffer->memoryTypeIndex >= VK_MAX_MEMORY_TYPES || (requirements.memoryTypeBits & (1U << pBuffer->memoryTypeIndex)) == 0 ||
+             requirements.size > pBuffer->allocationSize)
+        {
+            fprintf(stderr, "The imported memory of type %u and %llu bytes cannot back the buffer!\n", pBuffer->memoryTypeIndex,
+                (unsigned long long)pBuffer->allocationSize);
+            result = VK_ERROR_INVALID_EXTERNAL_HANDLE;
+            break;
+        }
+
+        const VkMemoryDedicatedAllocateInfo dedicatedInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+            .pNext = NULL,
+            .image = VK_NULL_HANDLE,
+            .buffer = pBuffer->buffer
+        };
+        const VkImportMemoryFdInfoKHR importInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+            .pNext = pBuffer->dedicated ? &dedicatedInfo : NULL,
+            .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT,
+            .fd = fd
+        };
+        const VkMemoryAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = &importInfo,
+            .allocationSize = pBuffer->allocationSize,
+            .memoryTypeIndex = pBuffer->memoryTypeIndex
+        };
+        result = AllocateDeviceMemory(device, &allocateInfo, &pBuffer->memory);
+        if (result != VK_SUCCESS) break;
+        // The implementation owns the fd from now on
+        fd = -1;
+
+        result = vkBindBufferMemory(device, pBuffer->buffer, pBuffer->memory, 0);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "vkBindBufferMemory failed: %d\n", result);
+        }
+    } while (false);
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (result != VK_SUCCESS) {
+        DestroyExternalBuffer(device, pBuffer);
+    }
+    return result;
+}
+
+void DestroyExternalBuffer(VkDevice device, struct ExternalBuffer* pBuffer)
+{
+    if (pBuffer->buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, pBuffer->buffer, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
+    }
+    FreeDeviceMemory(device, pBuffer->memory);
+    pBuffer->buffer = VK_NULL_HANDLE;
+    pBuffer->memory = VK_NULL_HANDLE;
+}
+
+VkResult ExportExternalBufferFd(VkDevice device, const struct ExternalBuffer* pBuffer, int* pFd)
+{
+    *pFd = -1;
+    // The loader does not export the entry points of the device extensions
+    const PFN_vkGetMemoryFdKHR getMemoryFd = (PFN_vkGetMemoryFdKHR)vkGetDeviceProcAddr(device, "vkGetMemoryFdKHR");
+    if (getMemoryFd == NULL)
+    {
+        fprintf(stderr, "vkGetMemoryFdKHR is not available!\n");
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+
+    const VkMemoryGetFdInfoKHR getFdInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+        .pNext = NULL,
+        .memory = pBuffer->memory,
+        .handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    const VkResult result = getMemoryFd(device, &getFdInfo, pFd);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkGetMemoryFdKHR failed: %d\n", result);
+    }
+    return result;
+}
+
+static VkResult CreateSemaphoreWithNext(VkDevice device, const void* pNext, VkSemaphore* pSemaphore)
+{
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = pNext,
+        .flags = 0
+    };
+    const VkResult result = vkCreateSemaphore(device, &semaphoreCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE), pSemaphore);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateSemaphore failed: %d\n", result);
+    }
+    return result;
+}
+
+VkResult CreateExportableSemaphore(VkDevice device, VkSemaphore* pSemaphore)
+{
+    const VkExportSemaphoreCreateInfo exportInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .handleTypes = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    return CreateSemaphoreWithNext(device, &exportInfo, pSemaphore);
+}
+
+VkResult ExportSemaphoreFd(VkDevice device, VkSemaphore semaphore, int* pFd)
+{
+    *pFd = -1;
+    const PFN_vkGetSemaphoreFdKHR getSemaphoreFd = (PFN_vkGetSemaphoreFdKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreFdKHR");
+    if (getSemaphoreFd == NULL)
+    {
+        fprintf(stderr, "vkGetSemaphoreFdKHR is not available!\n");
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+
+    const VkSemaphoreGetFdInfoKHR getFdInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+        .pNext = NULL,
+        .semaphore = semaphore,
+        .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    const VkResult result = getSemaphoreFd(device, &getFdInfo, pFd);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkGetSemaphoreFdKHR failed: %d\n", result);
+    }
+    return result;
+}
+
+VkResult ImportSemaphoreFd(VkDevice device, int fd, VkSemaphore* pSemaphore)
+{
+    *pSemaphore = VK_NULL_HANDLE;
+    VkResult result = VK_ERROR_EXTENSION_NOT_PRESENT;
+    do
+    {
+        const PFN_vkImportSemaphoreFdKHR importSemaphoreFd = (PFN_vkImportSemaphoreFdKHR)vkGetDeviceProcAddr(device, "vkImportSemaphoreFdKHR");
+        if (importSemaphoreFd == NULL)
+        {
+            fprintf(stderr, "vkImportSemaphoreFdKHR is not available!\n");
+            break;
+        }
+
+        result = CreateSemaphoreWithNext(device, NULL, pSemaphore);
+        if (result != VK_SUCCESS) break;
+
+        // A permanent import, so that the semaphore keeps the shared payload for every wait
+        const VkImportSemaphoreFdInfoKHR importInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+            .pNext = NULL,
+            .semaphore = *pSemaphore,
+            .flags = 0,
+            .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT,
+            .fd = fd
+        };
+        result = importSemaphoreFd(device, &importInfo);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkImportSemaphoreFdKHR failed: %d\n", result);
+            break;
+        }
+        fd = -1;
+    } while (false);
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (result != VK_SUCCESS && *pSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(device, *pSemaphore, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE));
+        *pSemaphore = VK_NULL_HANDLE;
+    }
+    return result;
+}
+
+// MARK: Unix domain socket
+
+static bool SendAll(int socket, const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0)
+        {
+            fprintf(stderr, "send failed: %d\n", errno);
+            return false;
+        }
+        data += sent;
+        size -= (size_t)sent;
+    }
+    return true;
+}
+
+static bool ReceiveAll(int socket, uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t received = recv(socket, data, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0)
+        {
+            fprintf(stderr, "recv failed: %d\n", received == 0 ? 0 : errno);
+            return false;
+        }
+        data += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+bool SendExternalMemoryMessage(int socket, const void* data, size_t size, const int fds[], uint32_t fdCount)
+{
+    if (size == 0 || fdCount > EXTERNAL_MEMORY_MAX_FD_COUNT) {
+        return false;
+    }
+
+    union
+    {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * EXTERNAL_MEMORY_MAX_FD_COUNT)];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    // The fds go with the first byte, and the rest of the message follows on the stream
+    struct iovec iov = { .iov_base = (void*)data, .iov_len = size };
+    struct msghdr message = {
+        .msg_name = NULL,
+        .msg_namelen = 0,
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = fdCount > 0 ? control.buffer : NULL,
+        .msg_controllen = fdCount > 0 ? CMSG_SPACE(sizeof(int) * fdCount) : 0,
+        .msg_flags = 0
+    };
+    if (fdCount > 0)
+    {
+        struct cmsghdr* pHeader = CMSG_FIRSTHDR(&message);
+        pHeader->cmsg_level = SOL_SOCKET;
+        pHeader->cmsg_type = SCM_RIGHTS;
+        pHeader->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        memcpy(CMSG_DATA(pHeader), fds, sizeof(int) * fdCount);
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent <= 0)
+    {
+        fprintf(stderr, "sendmsg failed: %d\n", errno);
+        return false;
+    }
+    return SendAll(socket, (const uint8_t*)data + sent, size - (size_t)sent);
+}
+
+bool ReceiveExternalMemoryMessage(int socket, void* data, size_t size, int fds[], uint32_t maxFdCount, uint32_t* pFdCount)
+{
+    *pFdCount = 0;
+    if (size == 0 || maxFdCount > EXTERNAL_MEMORY_MAX_FD_COUNT) {
+        return false;
+    }
+
+    union
+    {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * EXTERNAL_MEMORY_MAX_FD_COUNT)];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct iovec iov = { .iov_base = data, .iov_len = size };
+    struct msghdr message = {
+        .msg_name = NULL,
+        .msg_namelen = 0,
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = sizeof(control.buffer),
+        .msg_flags = 0
+    };
+
+    int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+    // The fds must not leak into the processes this one may start
+    flags |= MSG_CMSG_CLOEXEC;
+#endif // MSG_CMSG_CLOEXEC
+    ssize_t received;
+    do {
+        received = recvmsg(socket, &message, flags);
+    } while (received < 0 && errno == EINTR);
+    // The orderly shutdown of the peer is not an error of its own
+    if (received <= 0)
+    {
+        if (received < 0) {
+            fprintf(stderr, "recvmsg failed: %d\n", errno);
+        }
+        return false;
+    }
+
+    for (struct cmsghdr* pHeader = CMSG_FIRSTHDR(&message); pHeader != NULL; pHeader = CMSG_NXTHDR(&message, pHeader))
+    {
+        if (pHeader->cmsg_level != SOL_SOCKET || pHeader->cmsg_type != SCM_RIGHTS) continue;
+
+        const uint32_t count = (uint32_t)((pHeader->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int receivedFds[EXTERNAL_MEMORY_MAX_FD_COUNT];
+        memcpy(receivedFds, CMSG_DATA(pHeader), sizeof(int) * (count < EXTERNAL_MEMORY_MAX_FD_COUNT ? count : EXTERNAL_MEMORY_MAX_FD_COUNT));
+        for (uint32_t i = 0; i < count && i < EXTERNAL_MEMORY_MAX_FD_COUNT; i++)
+        {
+            // The fds beyond what the caller takes are not leaked
+            if (*pFdCount < maxFdCount) {
+                fds[(*pFdCount)++] = receivedFds[i];
+            }
+            else {
+                close(receivedFds[i]);
+            }
+        }
+    }
+    if ((message.msg_flags & MSG_CTRUNC) != 0) {
+        fprintf(stderr, "recvmsg truncated the fds!\n");
+    }
+
+    return ReceiveAll(socket, (uint8_t*)data + received, size - (size_t)received);
+}
+
+// MARK: Test
+
+// Releases the whole buffer from the queue family of this device to the ones of other devices and processes, after the writes of the kernels
+static void RecordReleaseToExternalBarrier(VkCommandBuffer commandBuffer, VkBuffer buffer, uint32_t queueFamilyIndex)
+{
+    const VkBufferMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = queueFamilyIndex,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL,
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+}
+
+// The matching acquire, before the buffer is read by transfers. Its source stage is the one of the semaphore wait, which it follows.
+static void RecordAcquireFromExternalBarrier(VkCommandBuffer commandBuffer, VkBuffer buffer, uint32_t queueFamilyIndex)
+{
+    const VkBufferMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL,
+        .dstQueueFamilyIndex = queueFamilyIndex,
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+}
+
+// Submits `commandBuffer` with the semaphores, and signals the fence that is returned in *pFence
+static VkResult SubmitWithSemaphore(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer, VkSemaphore waitSemaphore,
+    VkPipelineStageFlags waitStageMask, VkSemaphore signalSemaphore, VkFence* pFence)
+{
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    VkResult result = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), pFence);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateFence failed: %d\n", result);
+        *pFence = VK_NULL_HANDLE;
+        return result;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1U : 0U,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitStageMask,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1U : 0U,
+        .pSignalSemaphores = &signalSemaphore
+    };
+    result = vkQueueSubmit(queue, 1, &submitInfo, *pFence);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+    }
+    return result;
+}
+
+static void GetDeviceUUIDs(VkPhysicalDevice physicalDevice, uint8_t deviceUUID[VK_UUID_SIZE], uint8_t driverUUID[VK_UUID_SIZE])
+{
+    VkPhysicalDeviceIDProperties idProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &idProperties
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    memcpy(deviceUUID, idProperties.deviceUUID, VK_UUID_SIZE);
+    memcpy(driverUUID, idProperties.driverUUID, VK_UUID_SIZE);
+}
+
+// Starts this program again as the importer on `socket`. Only the exec runs in the child, as the driver threads are not forked.
+static pid_t SpawnExternalMemoryConsumer(const char* programPath, int socket)
+{
+    char argument[64];
+    snprintf(argument, sizeof(argument), "--external-memory-consumer=%d", socket);
+
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        char* const args[] = { (char*)programPath, argument, NULL };
+        execv("/proc/self/exe", args);
+        execvp(programPath, args);
+        _exit(127);
+    }
+    if (pid < 0) {
+        fprintf(stderr, "fork failed: %d\n", errno);
+    }
+    return pid;
+}
+
+void ExternalMemoryComputeTest(VkPhysicalDevice specPhysicalDevice, VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t specQueueFamilyIndex, const VkPhysicalDeviceLimits* pLimits, bool supportExternalFd, const char* programPath)
+{
+    puts("\n================ Begin external memory test ================\n");
+
+    int sockets[2] = { -1, -1 };
+    pid_t consumerPid = -1;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkBuffer srcBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory srcMemory = VK_NULL_HANDLE;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    struct ExternalBuffer exportedBuffer = { .buffer = VK_NULL_HANDLE, .memory = VK_NULL_HANDLE };
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    struct ElementwiseContext* pContext = NULL;
+    struct ElementwiseChainPlan* pPlan = NULL;
+    int fds[2] = { -1, -1 };
+
+    const struct ElementwiseChain chain = {
+        3, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_XOR, ELEMENTWISE_OP_ADD }, { 7, 0x5a5aU, 3 }
+    };
+    const uint32_t elemCount = EXTERNAL_MEMORY_TEST_ELEM_COUNT;
+    const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+
+    do
+    {
+        if (!supportExternalFd)
+        {
+            puts("The current device does not support `VK_KHR_external_memory_fd` and `VK_KHR_external_semaphore_fd`. The test will be skipped.");
+            break;
+        }
+        bool dedicatedOnly = false;
+        if (!QueryExternalMemoryFdSupport(specPhysicalDevice, s_externalBufferUsage, &dedicatedOnly))
+        {
+            puts("The storage buffers and the semaphores of the current device cannot be shared as opaque fds. The test will be skipped.");
+            break;
+        }
+        if (bufferSize > pLimits->maxStorageBufferRange) {
+            break;
+        }
+
+        // Before any fd is exported, so that the importer inherits none but its end of the socket
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        {
+            fprintf(stderr, "socketpair failed: %d\n", errno);
+            break;
+        }
+        consumerPid = SpawnExternalMemoryConsumer(programPath, sockets[1]);
+        close(sockets[1]);
+        sockets[1] = -1;
+        if (consumerPid < 0) break;
+
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+        VkResult result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, &commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &srcBuffer, &srcMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &stagingBuffer, &stagingMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+        void* hostPtr = NULL;
+        result = vkMapMemory(specDevice, stagingMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        HostParallelFillSequence(hostPtr, elemCount, 0);
+        vkUnmapMemory(specDevice, stagingMemory);
+
+        result = CreateExportableBuffer(specDevice, pMemoryProperties, bufferSize, s_externalBufferUsage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            dedicatedOnly, specQueueFamilyIndex, &exportedBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateExportableBuffer failed!\n");
+            break;
+        }
+        result = CreateExportableSemaphore(specDevice, &semaphore);
+        if (result != VK_SUCCESS) break;
+
+        result = CreateElementwiseContext(specDevice, pLimits, &pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+        result = CreateElementwiseChainPlan(pContext, &chain, ELEMENTWISE_FUSION_AUTO, srcBuffer, exportedBuffer.buffer, &pPlan);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+            break;
+        }
+
+        // The chain writes the exported buffer, which is then handed over with the semaphore its submission signals
+        result = BeginOneTimeCommandBuffer(specDevice, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = bufferSize };
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, srcBuffer, 1, &copyRegion);
+        RecordTransferToComputeBarrier(commandBuffer);
+        RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+        RecordReleaseToExternalBarrier(commandBuffer, exportedBuffer.buffer, specQueueFamilyIndex);
+        result = vkEndCommandBuffer(commandBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+            break;
+        }
+        result = SubmitWithSemaphore(specDevice, queue, commandBuffer, VK_NULL_HANDLE, 0, semaphore, &fence);
+        if (result != VK_SUCCESS) break;
+
+        result = ExportExternalBufferFd(specDevice, &exportedBuffer, &fds[0]);
+        if (result != VK_SUCCESS) break;
+        result = ExportSemaphoreFd(specDevice, semaphore, &fds[1]);
+        if (result != VK_SUCCESS) break;
+
+        struct ExternalMemoryMessage message = {
+            .magic = EXTERNAL_MEMORY_MESSAGE_MAGIC,
+            .bufferSize = exportedBuffer.size,
+            .allocationSize = exportedBuffer.allocationSize,
+            .memoryTypeIndex = exportedBuffer.memoryTypeIndex,
+            .dedicated = exportedBuffer.dedicated ? 1U : 0U,
+            .elemCount = elemCount,
+            .chain = chain
+        };
+        GetDeviceUUIDs(specPhysicalDevice, message.deviceUUID, message.driverUUID);
+
+        // The handoff runs while the chain may still be executing: the importer waits on the semaphore on the device
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        const bool sent = SendExternalMemoryMessage(sockets[0], &message, sizeof(message), fds, 2);
+        // The importer has its own references now
+        for (int i = 0; i < 2; i++)
+        {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+        if (!sent) break;
+
+        struct ExternalMemoryReply reply;
+        uint32_t fdCount = 0;
+        if (!ReceiveExternalMemoryMessage(sockets[0], &reply, sizeof(reply), NULL, 0, &fdCount) || reply.magic != EXTERNAL_MEMORY_MESSAGE_MAGIC)
+        {
+            fprintf(stderr, "The importer gave no reply!\n");
+            break;
+        }
+        const uint64_t roundTripTime = HostGetTimeNanoseconds() - beginTime;
+        if (reply.result != VK_SUCCESS)
+        {
+            fprintf(stderr, "The importer failed: %d\n", reply.result);
+            break;
+        }
+
+        printf("Shared %.1f MiB of device memory (memory type %u, %s allocation) and a semaphore with the importer process %d.\n",
+            (double)exportedBuffer.allocationSize / (1024.0 * 1024.0), exportedBuffer.memoryTypeIndex,
+            exportedBuffer.dedicated ? "dedicated" : "shared", (int)consumerPid);
+        printf("%zu bytes went through the socket, and no byte of the buffer was copied through the host.\n",
+            sizeof(message) + sizeof(reply));
+        printf("Importer: device setup %.3f ms, import %.3f ms, semaphore wait and read back %.3f ms. Handoff round trip: %.3f ms\n",
+            (double)reply.setupTime / 1000000.0, (double)reply.importTime / 1000000.0, (double)reply.readTime / 1000000.0, (double)roundTripTime / 1000000.0);
+        printf("The importer verified the buffer: %s\n", reply.verified != 0 ? "OK" : "FAILED");
+    } while (false);
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+    if (sockets[0] >= 0) {
+        close(sockets[0]);
+    }
+    if (consumerPid > 0)
+    {
+        int status = 0;
+        while (waitpid(consumerPid, &status, 0) < 0 && errno == EINTR);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "The importer process exited abnormally: %d\n", status);
+        }
+    }
+
+    if (fence != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(specDevice, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(specDevice, fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    DestroyElementwiseChainPlan(pPlan);
+    DestroyElementwiseContext(pContext);
+    if (semaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(specDevice, semaphore, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE));
+    }
+    DestroyExternalBuffer(specDevice, &exportedBuffer);
+    DestroyBufferWithMemory(specDevice, stagingBuffer, stagingMemory);
+    DestroyBufferWithMemory(specDevice, srcBuffer, srcMemory);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, 1, &commandBuffer);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+
+    puts("\n================ Complete external memory test ================\n");
+}
+
+// MARK: Importer
+
+// An instance and a device of their own, on the physical device of the exporter
+struct ExternalMemoryConsumer
+{
+    VkInstance instance;
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    VkQueue queue;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+};
+
+static VkResult CreateExternalMemoryConsumerDevice(const struct ExternalMemoryMessage* pMessage, struct ExternalMemoryConsumer* pConsumer)
+{
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    vkEnumerateInstanceVersion(&apiVersion);
+    if (apiVersion < VK_API_VERSION_1_1)
+    {
+        fprintf(stderr, "The importer needs Vulkan 1.1!\n");
+        return VK_ERROR_INCOMPATIBLE_DRIVER;
+    }
+
+    const VkApplicationInfo appInfo = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pNext = NULL,
+        .pApplicationName = "Vulkan Test Importer",
+        .applicationVersion = 1,
+        .pEngineName = "My Engine",
+        .engineVersion = 1,
+        .apiVersion = apiVersion
+    };
+    const VkInstanceCreateInfo instanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .pApplicationInfo = &appInfo,
+        .enabledExtensionCount = 0,
+        .ppEnabledExtensionNames = NULL,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL
+    };
+    VkResult result = vkCreateInstance(&instanceInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_INSTANCE), &pConsumer->instance);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateInstance failed: %d\n", result);
+        pConsumer->instance = VK_NULL_HANDLE;
+        return result;
+    }
+
+    VkPhysicalDevice physicalDevices[EXTERNAL_MEMORY_MAX_GPU_COUNT];
+    uint32_t physicalDeviceCount = EXTERNAL_MEMORY_MAX_GPU_COUNT;
+    result = vkEnumeratePhysicalDevices(pConsumer->instance, &physicalDeviceCount, physicalDevices);
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+    {
+        fprintf(stderr, "vkEnumeratePhysicalDevices failed: %d\n", result);
+        return result;
+    }
+
+    // The opaque fds are only meaningful to the same device with the same driver
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    for (uint32_t i = 0; i < physicalDeviceCount && physicalDevice == VK_NULL_HANDLE; i++)
+    {
+        uint8_t deviceUUID[VK_UUID_SIZE];
+        uint8_t driverUUID[VK_UUID_SIZE];
+        GetDeviceUUIDs(physicalDevices[i], deviceUUID, driverUUID);
+        if (memcmp(deviceUUID, pMessage->deviceUUID, VK_UUID_SIZE) == 0 && memcmp(driverUUID, pMessage->driverUUID, VK_UUID_SIZE) == 0) {
+            physicalDevice = physicalDevices[i];
+        }
+    }
+    if (physicalDevice == VK_NULL_HANDLE)
+    {
+        fprintf(stderr, "The importer found no device with the UUIDs of the exporter!\n");
+        return VK_ERROR_INCOMPATIBLE_DRIVER;
+    }
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &pConsumer->memoryProperties);
+
+    uint32_t queueFamilyPropertyCount = 0;
+    VkQueueFamilyProperties queueFamilyProperties[EXTERNAL_MEMORY_MAX_QUEUE_FAMILY_COUNT];
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, NULL);
+    if (queueFamilyPropertyCount > EXTERNAL_MEMORY_MAX_QUEUE_FAMILY_COUNT) {
+        queueFamilyPropertyCount = EXTERNAL_MEMORY_MAX_QUEUE_FAMILY_COUNT;
+    }
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, queueFamilyProperties);
+    pConsumer->queueFamilyIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < queueFamilyPropertyCount && pConsumer->queueFamilyIndex == UINT32_MAX; i++)
+    {
+        if ((queueFamilyProperties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0) {
+            pConsumer->queueFamilyIndex = i;
+        }
+    }
+    if (pConsumer->queueFamilyIndex == UINT32_MAX)
+    {
+        fprintf(stderr, "The importer found no compute queue!\n");
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    const char* const extensionNames[] = { VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
+    const float queuePriorities[1] = { 0.0f };
+    const VkDeviceQueueCreateInfo queueInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = pConsumer->queueFamilyIndex,
+        .queueCount = 1,
+        .pQueuePriorities = queuePriorities
+    };
+    const VkDeviceCreateInfo deviceInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queueInfo,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL,
+        .enabledExtensionCount = (uint32_t)(sizeof(extensionNames) / sizeof(extensionNames[0])),
+        .ppEnabledExtensionNames = extensionNames,
+        .pEnabledFeatures = NULL
+    };
+    result = vkCreateDevice(physicalDevice, &deviceInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE), &pConsumer->device);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateDevice failed: %d\n", result);
+        pConsumer->device = VK_NULL_HANDLE;
+        return result;
+    }
+    vkGetDeviceQueue(pConsumer->device, pConsumer->queueFamilyIndex, 0, &pConsumer->queue);
+    return VK_SUCCESS;
+}
+
+// Imports the buffer and the semaphore of the message, and reads the buffer back once the semaphore has been signaled
+static VkResult ConsumeExternalBuffer(const struct ExternalMemoryConsumer* pConsumer, const struct ExternalMemoryMessage* pMessage,
+    int memoryFd, int semaphoreFd, struct ExternalMemoryReply* pReply)
+{
+    const VkDevice device = pConsumer->device;
+    struct ExternalBuffer importedBuffer = {
+        .buffer = VK_NULL_HANDLE,
+        .memory = VK_NULL_HANDLE,
+        .size = pMessage->bufferSize,
+        .allocationSize = pMessage->allocationSize,
+        .memoryTypeIndex = pMessage->memoryTypeIndex,
+        .dedicated = pMessage->dedicated != 0
+    };
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkResult result;
+
+    do
+    {
+        uint64_t beginTime = HostGetTimeNanoseconds();
+        result = ImportExternalBuffer(device, s_externalBufferUsage, pConsumer->queueFamilyIndex, memoryFd, &importedBuffer);
+        memoryFd = -1;
+        if (result != VK_SUCCESS) break;
+        result = ImportSemaphoreFd(device, semaphoreFd, &semaphore);
+        semaphoreFd = -1;
+        if (result != VK_SUCCESS) break;
+        pReply->importTime = HostGetTimeNanoseconds() - beginTime;
+
+        result = CreateBufferWithMemory(device, &pConsumer->memoryProperties, pMessage->bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pConsumer->queueFamilyIndex, &stagingBuffer, &stagingMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+        result = InitializeCommandBuffer(pConsumer->queueFamilyIndex, device, &commandPool, &commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        beginTime = HostGetTimeNanoseconds();
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordAcquireFromExternalBarrier(commandBuffer, importedBuffer.buffer, pConsumer->queueFamilyIndex);
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = pMessage->bufferSize };
+        vkCmdCopyBuffer(commandBuffer, importedBuffer.buffer, stagingBuffer, 1, &copyRegion);
+        result = vkEndCommandBuffer(commandBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+            break;
+        }
+        result = SubmitWithSemaphore(device, pConsumer->queue, commandBuffer, semaphore, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_NULL_HANDLE, &fence);
+        if (result != VK_SUCCESS) break;
+        result = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            break;
+        }
+        pReply->readTime = HostGetTimeNanoseconds() - beginTime;
+
+        uint32_t* hostPtr = NULL;
+        result = vkMapMemory(device, stagingMemory, 0, VK_WHOLE_SIZE, 0, (void**)&hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        bool verified = true;
+        for (uint32_t i = 0; i < pMessage->elemCount && verified; i++) {
+            verified = hostPtr[i] == ApplyElementwiseChainOnHost(&pMessage->chain, i);
+        }
+        vkUnmapMemory(device, stagingMemory);
+        pReply->verified = verified ? 1U : 0U;
+    } while (false);
+
+    if (memoryFd >= 0) {
+        close(memoryFd);
+    }
+    if (semaphoreFd >= 0) {
+        close(semaphoreFd);
+    }
+    if (fence != VK_NULL_HANDLE) {
+        vkDestroyFence(device, fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+        vkDestroyCommandPool(device, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    DestroyBufferWithMemory(device, stagingBuffer, stagingMemory);
+    if (semaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, semaphore, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE));
+    }
+    DestroyExternalBuffer(device, &importedBuffer);
+    return result;
+}
+
+int RunExternalMemoryConsumer(int socket)
+{
+    struct ExternalMemoryConsumer consumer = { .instance = VK_NULL_HANDLE, .device = VK_NULL_HANDLE };
+    struct ExternalMemoryMessage message;
+    struct ExternalMemoryReply reply = { .magic = EXTERNAL_MEMORY_MESSAGE_MAGIC, .result = VK_ERROR_INITIALIZATION_FAILED };
+    int fds[2] = { -1, -1 };
+    uint32_t fdCount = 0;
+
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    if (ReceiveExternalMemoryMessage(socket, &message, sizeof(message), fds, 2, &fdCount) && fdCount == 2 &&
+        message.magic == EXTERNAL_MEMORY_MESSAGE_MAGIC && message.elemCount <= message.bufferSize / sizeof(uint32_t))
+    {
+        reply.result = CreateExternalMemoryConsumerDevice(&message, &consumer);
+        reply.setupTime = HostGetTimeNanoseconds() - beginTime;
+        if (reply.result == VK_SUCCESS)
+        {
+            reply.result = ConsumeExternalBuffer(&consumer, &message, fds[0], fds[1], &reply);
+            fds[0] = -1;
+            fds[1] = -1;
+        }
+    }
+    else {
+        fprintf(stderr, "The importer received no valid message!\n");
+    }
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+    if (consumer.device != VK_NULL_HANDLE) {
+        vkDestroyDevice(consumer.device, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE));
+    }
+    if (consumer.instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(consumer.instance, GetHostAllocationCallbacks(VK_OBJECT_TYPE_INSTANCE));
+    }
+
+    const bool sent = SendExternalMemoryMessage(socket, &reply, sizeof(reply), NULL, 0);
+    close(socket);
+    return sent && reply.result == VK_SUCCESS && reply.verified != 0 ? 0 : 1;
+}
+
+#else
+
+void ExternalMemoryComputeTest(VkPhysicalDevice specPhysicalDevice, VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t specQueueFamilyIndex, const VkPhysicalDeviceLimits* pLimits, bool supportExternalFd, const char* programPath)
+{
+    puts("\n================ Begin external memory test ================\n");
+    puts("The opaque fds of `VK_KHR_external_memory_fd` and `VK_KHR_external_semaphore_fd` are POSIX only. The test will be skipped.");
+    puts("\n================ Complete external memory test ================\n");
+}
+
+int RunExternalMemoryConsumer(int socket)
+{
+    fprintf(stderr, "--external-memory-consumer is POSIX only!\n");
+    return 1;
+}
+
+#endif // !_WIN32
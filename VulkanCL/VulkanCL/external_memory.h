@@ -0,0 +1,77 @@
+#ifndef EXTERNAL_MEMORY_H
+#define EXTERNAL_MEMORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Zero-copy sharing of device buffers and semaphores between processes on the same device.
+// The memory of a buffer is exported as an opaque POSIX file descriptor (VK_KHR_external_memory_fd), and so is the semaphore that signals
+// its completion (VK_KHR_external_semaphore_fd). The descriptors are passed over a Unix domain socket as SCM_RIGHTS ancillary data,
+// so the other process imports the same physical pages and waits on the same semaphore payload: only a small message goes through the socket.
+// The buffer is released to VK_QUEUE_FAMILY_EXTERNAL by the exporter and acquired from it by the importer.
+// The opaque descriptors are only valid on a device with the same device and driver UUIDs, which the message carries.
+//
+// The descriptors are POSIX only. The Windows counterparts are the opaque Win32 handles of VK_KHR_external_memory_win32 and
+// VK_KHR_external_semaphore_win32, which are not implemented here.
+
+enum
+{
+    EXTERNAL_MEMORY_MAX_FD_COUNT = 4
+};
+
+#ifndef _WIN32
+
+// A buffer with the memory it is bound to at offset 0, which is exported or imported as a whole
+struct ExternalBuffer
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    // The size and the memory type of the allocation, which the importer must allocate the same
+    VkDeviceSize allocationSize;
+    uint32_t memoryTypeIndex;
+    // Whether the memory is a dedicated allocation of the buffer, which the importer must also make
+    bool dedicated;
+};
+
+// Whether buffers of `usage` can be exported and imported as opaque fds, and semaphores too.
+// @param pDedicatedOnly: receives whether the exported memory must be a dedicated allocation. It may be NULL.
+extern bool QueryExternalMemoryFdSupport(VkPhysicalDevice physicalDevice, VkBufferUsageFlags usage, bool* pDedicatedOnly);
+
+// Creates a buffer whose memory can be exported, from a memory type with `requiredFlags` within the budget.
+extern VkResult CreateExportableBuffer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags requiredFlags, bool dedicatedOnly, uint32_t queueFamilyIndex, struct ExternalBuffer* pBuffer);
+// Imports the memory of an exported buffer into a new buffer. The fd is owned by the implementation on success, and is closed on failure.
+// `pBuffer->size`, `allocationSize`, `memoryTypeIndex` and `dedicated` are the ones of the exporter.
+extern VkResult ImportExternalBuffer(VkDevice device, VkBufferUsageFlags usage, uint32_t queueFamilyIndex, int fd, struct ExternalBuffer* pBuffer);
+extern void DestroyExternalBuffer(VkDevice device, struct ExternalBuffer* pBuffer);
+// Returns a new fd referring to the memory of `pBuffer`, which the caller closes once it has been passed on.
+extern VkResult ExportExternalBufferFd(VkDevice device, const struct ExternalBuffer* pBuffer, int* pFd);
+
+// A binary semaphore whose payload can be exported
+extern VkResult CreateExportableSemaphore(VkDevice device, VkSemaphore* pSemaphore);
+extern VkResult ExportSemaphoreFd(VkDevice device, VkSemaphore semaphore, int* pFd);
+// Creates a binary semaphore and imports the payload of `fd` permanently. The fd is owned by the implementation on success, and is closed on failure.
+extern VkResult ImportSemaphoreFd(VkDevice device, int fd, VkSemaphore* pSemaphore);
+
+// Sends `size` bytes with up to EXTERNAL_MEMORY_MAX_FD_COUNT fds as SCM_RIGHTS. The fds stay open in the sender.
+extern bool SendExternalMemoryMessage(int socket, const void* data, size_t size, const int fds[], uint32_t fdCount);
+// Receives `size` bytes and the fds sent with them, which the caller closes or passes on. *pFdCount may be less than `maxFdCount`.
+// Returns false also when the peer has closed the socket.
+extern bool ReceiveExternalMemoryMessage(int socket, void* data, size_t size, int fds[], uint32_t maxFdCount, uint32_t* pFdCount);
+
+#endif // !_WIN32
+
+// The exporter side of the test. It starts a second process of this program as the importer, runs an elementwise chain into
+// an exported buffer, and hands the buffer and the semaphore of its completion over to the importer, which verifies the result.
+// @param programPath: argv[0] of this program, used when /proc/self/exe is not available
+extern void ExternalMemoryComputeTest(VkPhysicalDevice specPhysicalDevice, VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t specQueueFamilyIndex, const VkPhysicalDeviceLimits* pLimits, bool supportExternalFd, const char* programPath);
+
+// The importer side, run by the process started with --external-memory-consumer=<socket fd>. Returns the exit code of the process.
+extern int RunExternalMemoryConsumer(int socket);
+
+#endif // !EXTERNAL_MEMORY_H
@@ -0,0 +1,560 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "elementwise_fusion.h"
+#include "iterative.h"
+#include "cl_host.h"
+#include "host_kernels.h"
+#include "heterogeneous.h"
+
+enum
+{
+    HETEROGENEOUS_TIMESTAMP_QUERY_COUNT = 2,
+
+    HETEROGENEOUS_TEST_ELEM_COUNT = 1 << 22,
+    HETEROGENEOUS_TEST_ROUND_COUNT = 6,
+    HETEROGENEOUS_NEWTON_ELEM_COUNT = 100003,
+    HETEROGENEOUS_NEWTON_WORKGROUP_SIZE = 64,
+    HETEROGENEOUS_NEWTON_ITERATION_COUNT = 24
+};
+
+// The weight of the latest measurement when it is blended into the throughput of a side, as for the multi-device executor
+#define HETEROGENEOUS_THROUGHPUT_BLEND  0.5
+
+struct HeterogeneousExecutor
+{
+    VkDevice device;
+    VkQueue queue;
+    uint32_t maxElemCount;
+    uint32_t workgroupSize;
+
+    struct ElementwiseContext* pContext;
+    // The plan of `planChain`, created again when the chain of a job differs
+    struct ElementwiseChainPlan* pPlan;
+    struct ElementwiseChain planChain;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    // Signaled by the device part of a job, which the host part does not wait for
+    VkFence fence;
+    // VK_NULL_HANDLE if the queue does not support timestamps
+    VkQueryPool queryPool;
+    // Nanoseconds per timestamp tick
+    double timestampPeriod;
+    VkBuffer srcBuffer, dstBuffer, stagingBuffer;
+    VkDeviceMemory srcMemory, dstMemory, stagingMemory;
+    // Both the upload and the readback go through the staging buffer
+    uint32_t* stagingPtr;
+
+    struct HeterogeneousStats stats;
+};
+
+VkResult CreateHeterogeneousExecutor(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, uint32_t maxElemCount, struct HeterogeneousExecutor** ppExecutor)
+{
+    const VkDeviceSize bufferSize = (VkDeviceSize)maxElemCount * sizeof(uint32_t);
+    if (maxElemCount == 0 || bufferSize > pLimits->maxStorageBufferRange) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct HeterogeneousExecutor* pExecutor = calloc(1, sizeof(*pExecutor));
+    if (pExecutor == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pExecutor->device = device;
+    pExecutor->maxElemCount = maxElemCount;
+    pExecutor->stats.deviceShare = 0.5;
+    vkGetDeviceQueue(device, queueFamilyIndex, 0, &pExecutor->queue);
+
+    VkResult result;
+    do
+    {
+        result = CreateElementwiseContext(device, pLimits, &pExecutor->pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+        pExecutor->workgroupSize = GetElementwiseWorkgroupSize(pExecutor->pContext);
+
+        result = InitializeCommandBuffer(queueFamilyIndex, device, &pExecutor->commandPool, &pExecutor->commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        const VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0
+        };
+        result = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), &pExecutor->fence);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+            break;
+        }
+
+        if (pLimits->timestampComputeAndGraphics && pLimits->timestampPeriod > 0.0f)
+        {
+            const VkQueryPoolCreateInfo queryPoolCreateInfo = {
+                .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+                .pNext = NULL,
+                .flags = 0,
+                .queryType = VK_QUERY_TYPE_TIMESTAMP,
+                .queryCount = HETEROGENEOUS_TIMESTAMP_QUERY_COUNT,
+                .pipelineStatistics = 0
+            };
+            // Without the timestamps, the device part is timed on the host, which the host part may delay
+            if (vkCreateQueryPool(device, &queryPoolCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_QUERY_POOL), &pExecutor->queryPool) != VK_SUCCESS) {
+                pExecutor->queryPool = VK_NULL_HANDLE;
+            }
+            pExecutor->timestampPeriod = pLimits->timestampPeriod;
+        }
+
+        result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pExecutor->srcBuffer, &pExecutor->srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pExecutor->dstBuffer, &pExecutor->dstMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex,
+                &pExecutor->stagingBuffer, &pExecutor->stagingMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        void* hostPtr = NULL;
+        result = vkMapMemory(device, pExecutor->stagingMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        pExecutor->stagingPtr = hostPtr;
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyHeterogeneousExecutor(pExecutor);
+        return result;
+    }
+
+    *ppExecutor = pExecutor;
+    return VK_SUCCESS;
+}
+
+void DestroyHeterogeneousExecutor(struct HeterogeneousExecutor* pExecutor)
+{
+    if (pExecutor == NULL) return;
+
+    const VkDevice device = pExecutor->device;
+    DestroyElementwiseChainPlan(pExecutor->pPlan);
+    DestroyElementwiseContext(pExecutor->pContext);
+    if (pExecutor->stagingPtr != NULL) {
+        vkUnmapMemory(device, pExecutor->stagingMemory);
+    }
+    DestroyBufferWithMemory(device, pExecutor->stagingBuffer, pExecutor->stagingMemory);
+    DestroyBufferWithMemory(device, pExecutor->dstBuffer, pExecutor->dstMemory);
+    DestroyBufferWithMemory(device, pExecutor->srcBuffer, pExecutor->srcMemory);
+    if (pExecutor->queryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, pExecutor->queryPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_QUERY_POOL));
+    }
+    if (pExecutor->fence != VK_NULL_HANDLE) {
+        vkDestroyFence(device, pExecutor->fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    if (pExecutor->commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, pExecutor->commandPool, 1, &pExecutor->commandBuffer);
+        vkDestroyCommandPool(device, pExecutor->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    free(pExecutor);
+}
+
+void GetHeterogeneousStats(const struct HeterogeneousExecutor* pExecutor, struct HeterogeneousStats* pStats)
+{
+    *pStats = pExecutor->stats;
+}
+
+// Uploads the first `elemCount` elements, and submits the chain and the readback without waiting for them
+static VkResult SubmitHeterogeneousDevicePart(struct HeterogeneousExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t elemCount)
+{
+    if (pExecutor->pPlan == NULL || memcmp(&pExecutor->planChain, pChain, sizeof(*pChain)) != 0)
+    {
+        DestroyElementwiseChainPlan(pExecutor->pPlan);
+        pExecutor->pPlan = NULL;
+        VkResult result = CreateElementwiseChainPlan(pExecutor->pContext, pChain, ELEMENTWISE_FUSION_AUTO, pExecutor->srcBuffer, pExecutor->dstBuffer,
+            &pExecutor->pPlan);
+        if (result != VK_SUCCESS) return result;
+        pExecutor->planChain = *pChain;
+    }
+
+    const size_t size = (size_t)elemCount * sizeof(uint32_t);
+    memcpy(pExecutor->stagingPtr, src, size);
+
+    const VkCommandBuffer commandBuffer = pExecutor->commandBuffer;
+    VkResult result = BeginOneTimeCommandBuffer(pExecutor->device, pExecutor->commandPool, commandBuffer);
+    if (result != VK_SUCCESS) return result;
+
+    if (pExecutor->queryPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, pExecutor->queryPool, 0, HETEROGENEOUS_TIMESTAMP_QUERY_COUNT);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pExecutor->queryPool, 0);
+    }
+    const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = size };
+    vkCmdCopyBuffer(commandBuffer, pExecutor->stagingBuffer, pExecutor->srcBuffer, 1, &copyRegion);
+    RecordTransferToComputeBarrier(commandBuffer);
+    RecordElementwiseChain(commandBuffer, pExecutor->pPlan, elemCount);
+    RecordComputeToTransferBarrier(commandBuffer);
+    vkCmdCopyBuffer(commandBuffer, pExecutor->dstBuffer, pExecutor->stagingBuffer, 1, &copyRegion);
+    if (pExecutor->queryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pExecutor->queryPool, 1);
+    }
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+        return result;
+    }
+
+    result = vkResetFences(pExecutor->device, 1, &pExecutor->fence);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkResetFences failed: %d\n", result);
+        return result;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    result = vkQueueSubmit(pExecutor->queue, 1, &submitInfo, pExecutor->fence);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+    }
+    return result;
+}
+
+// Returns the time between the two timestamps of the device part in nanoseconds, or 0 if it is not available
+static uint64_t GetHeterogeneousDeviceTime(const struct HeterogeneousExecutor* pExecutor)
+{
+    if (pExecutor->queryPool == VK_NULL_HANDLE) return 0;
+
+    uint64_t timestamps[HETEROGENEOUS_TIMESTAMP_QUERY_COUNT] = { 0 };
+    const VkResult result = vkGetQueryPoolResults(pExecutor->device, pExecutor->queryPool, 0, HETEROGENEOUS_TIMESTAMP_QUERY_COUNT,
+        sizeof(timestamps), timestamps, sizeof(timestamps[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    if (result != VK_SUCCESS || timestamps[1] < timestamps[0]) return 0;
+
+    return (uint64_t)((double)(timestamps[1] - timestamps[0]) * pExecutor->timestampPeriod);
+}
+
+static double BlendHeterogeneousThroughput(double current, uint32_t elemCount, uint64_t elapsedTime)
+{
+    const double throughput = (double)elemCount / ((double)(elapsedTime > 0 ? elapsedTime : 1) / 1000000000.0);
+    // The first measurement of a side replaces the initial 0
+    return current > 0.0 ? (1.0 - HETEROGENEOUS_THROUGHPUT_BLEND) * current + HETEROGENEOUS_THROUGHPUT_BLEND * throughput : throughput;
+}
+
+VkResult RunHeterogeneousElementwiseChain(struct HeterogeneousExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t* dst, uint32_t elemCount, enum HeterogeneousMode mode)
+{
+    if (elemCount > pExecutor->maxElemCount)
+    {
+        fprintf(stderr, "%u elements exceed the heterogeneous executor capacity of %u!\n", elemCount, pExecutor->maxElemCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct HeterogeneousStats* pStats = &pExecutor->stats;
+    const uint32_t workgroupSize = pExecutor->workgroupSize;
+    const uint32_t groupCount = (uint32_t)(((uint64_t)elemCount + workgroupSize - 1) / workgroupSize);
+
+    // The device takes the first workgroups and the host the rest of them, so each side works on a contiguous slice
+    uint32_t deviceGroupCount = 0;
+    switch (mode)
+    {
+    case HETEROGENEOUS_MODE_DEVICE_ONLY:
+        deviceGroupCount = groupCount;
+        break;
+    case HETEROGENEOUS_MODE_HOST_ONLY:
+        deviceGroupCount = 0;
+        break;
+    case HETEROGENEOUS_MODE_SPLIT:
+    default:
+        deviceGroupCount = (uint32_t)((double)groupCount * pStats->deviceShare + 0.5);
+        if (deviceGroupCount > groupCount) {
+            deviceGroupCount = groupCount;
+        }
+        break;
+    }
+    const uint64_t deviceElemEnd = (uint64_t)deviceGroupCount * workgroupSize;
+    const uint32_t deviceElemCount = deviceElemEnd < elemCount ? (uint32_t)deviceElemEnd : elemCount;
+
+    pStats->deviceGroupCount = deviceGroupCount;
+    pStats->hostGroupCount = groupCount - deviceGroupCount;
+    pStats->deviceElemCount = deviceElemCount;
+    pStats->hostElemCount = elemCount - deviceElemCount;
+    pStats->deviceElapsedTime = 0;
+    pStats->hostElapsedTime = 0;
+
+    const uint64_t deviceBeginTime = HostGetTimeNanoseconds();
+    uint64_t uploadTime = 0;
+    if (deviceElemCount > 0)
+    {
+        const VkResult result = SubmitHeterogeneousDevicePart(pExecutor, pChain, src, deviceElemCount);
+        if (result != VK_SUCCESS) return result;
+        uploadTime = HostGetTimeNanoseconds() - deviceBeginTime;
+    }
+
+    // The host part runs while the device is busy. Its work-items see the whole NDRange, so they index `src` and `dst` as the device would.
+    bool hostSucceeded = true;
+    if (pStats->hostGroupCount > 0)
+    {
+        const struct ClHostNDRange range = {
+            .workDim = 1,
+            .globalSize = { (size_t)groupCount * workgroupSize, 1, 1 },
+            .localSize = { workgroupSize, 1, 1 }
+        };
+        const uint64_t hostBeginTime = HostGetTimeNanoseconds();
+        hostSucceeded = RunElementwiseChainKernelOnHost(&range, deviceGroupCount, pStats->hostGroupCount, dst, src, elemCount, pChain);
+        pStats->hostElapsedTime = HostGetTimeNanoseconds() - hostBeginTime;
+    }
+
+    VkResult result = VK_SUCCESS;
+    if (deviceElemCount > 0)
+    {
+        result = vkWaitForFences(pExecutor->device, 1, &pExecutor->fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            return result;
+        }
+        const uint64_t readbackBeginTime = HostGetTimeNanoseconds();
+        memcpy(dst, pExecutor->stagingPtr, (size_t)deviceElemCount * sizeof(uint32_t));
+        const uint64_t readbackEndTime = HostGetTimeNanoseconds();
+
+        // Without the timestamps, the device part is timed up to the end of the host part at least,
+        // which underestimates its throughput while the host part is the longer one, and hands the host less work in the next job.
+        const uint64_t deviceTime = GetHeterogeneousDeviceTime(pExecutor);
+        pStats->deviceElapsedTime = deviceTime > 0 ? uploadTime + deviceTime + (readbackEndTime - readbackBeginTime) :
+            readbackEndTime - deviceBeginTime;
+        pStats->deviceThroughput = BlendHeterogeneousThroughput(pStats->deviceThroughput, deviceElemCount, pStats->deviceElapsedTime);
+    }
+    if (!hostSucceeded)
+    {
+        fprintf(stderr, "RunElementwiseChainKernelOnHost failed!\n");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    if (pStats->hostElemCount > 0) {
+        pStats->hostThroughput = BlendHeterogeneousThroughput(pStats->hostThroughput, pStats->hostElemCount, pStats->hostElapsedTime);
+    }
+
+    // Both sides finish together when each one takes the share of its throughput
+    if (pStats->deviceThroughput > 0.0 && pStats->hostThroughput > 0.0) {
+        pStats->deviceShare = pStats->deviceThroughput / (pStats->deviceThroughput + pStats->hostThroughput);
+    }
+    return result;
+}
+
+// MARK: Test
+
+// Runs the Newton iterations of iterative.cl on the host, and checks the solution and the control words the atomic functions update
+static void HeterogeneousNewtonHostTest(void)
+{
+    const uint32_t elemCount = HETEROGENEOUS_NEWTON_ELEM_COUNT;
+    const uint32_t workgroupSize = HETEROGENEOUS_NEWTON_WORKGROUP_SIZE;
+    const uint32_t groupCount = (elemCount + workgroupSize - 1) / workgroupSize;
+
+    float* coefficients = malloc(elemCount * sizeof(float));
+    float* buffers[2] = { malloc(elemCount * sizeof(float)), malloc(elemCount * sizeof(float)) };
+    do
+    {
+        if (coefficients == NULL || buffers[0] == NULL || buffers[1] == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+        for (uint32_t i = 0; i < elemCount; i++)
+        {
+            coefficients[i] = 1.0f + (float)i;
+            buffers[0][i] = coefficients[i];
+        }
+
+        const struct ClHostNDRange range = {
+            .workDim = 1,
+            .globalSize = { (size_t)groupCount * workgroupSize, 1, 1 },
+            .localSize = { workgroupSize, 1, 1 }
+        };
+        uint32_t control[ITERATIVE_CONTROL_WORD_COUNT] = { 0 };
+        float lastResidual = 0.0f;
+        bool succeeded = true;
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        for (uint32_t iteration = 0; iteration < HETEROGENEOUS_NEWTON_ITERATION_COUNT && succeeded; iteration++)
+        {
+            control[ITERATIVE_CONTROL_RESIDUAL] = 0;
+            succeeded = RunNewtonSqrtKernelOnHost(&range, 0, groupCount, coefficients, buffers[iteration & 1], buffers[(iteration + 1) & 1],
+                control, elemCount);
+            memcpy(&lastResidual, &control[ITERATIVE_CONTROL_RESIDUAL], sizeof(lastResidual));
+        }
+        const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+        if (!succeeded)
+        {
+            fprintf(stderr, "RunNewtonSqrtKernelOnHost failed!\n");
+            break;
+        }
+
+        const float* solution = buffers[HETEROGENEOUS_NEWTON_ITERATION_COUNT & 1];
+        uint32_t errorCount = 0;
+        for (uint32_t i = 0; i < elemCount; i++)
+        {
+            const float expected = sqrtf(coefficients[i]);
+            if (fabsf(solution[i] - expected) > expected * 1e-5f) {
+                errorCount++;
+            }
+        }
+        printf("Host Newton iterations: %u workgroups of %u work-items, %u iterations counted, final residual %g, %.3f ms  (%s)\n",
+            groupCount, workgroupSize, control[ITERATIVE_CONTROL_ITERATIONS], lastResidual, (double)elapsedTime / 1000000.0,
+            errorCount == 0 && control[ITERATIVE_CONTROL_ITERATIONS] == HETEROGENEOUS_NEWTON_ITERATION_COUNT ? "verify OK" : "verify FAILED");
+    } while (false);
+
+    free(buffers[1]);
+    free(buffers[0]);
+    free(coefficients);
+}
+
+// Returns the index of the first wrong element, or SIZE_MAX if all the elements are correct.
+static size_t VerifyHeterogeneousResult(const struct ElementwiseChain* pChain, const uint32_t* result, uint32_t elemCount)
+{
+    // The source elements are filled with their indices
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        if (result[i] != ApplyElementwiseChainOnHost(pChain, i)) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+static void PrintHeterogeneousRun(const struct HeterogeneousExecutor* pExecutor, const char* title, uint64_t elapsedTime, uint32_t elemCount,
+    size_t errorIndex)
+{
+    struct HeterogeneousStats stats;
+    GetHeterogeneousStats(pExecutor, &stats);
+
+    const double milliseconds = (double)elapsedTime / 1000000.0;
+    printf("%-16s %9.3f ms  %8.2f M elements/s  (%s)\n", title, milliseconds, (double)elemCount / (milliseconds * 1000.0),
+        errorIndex == SIZE_MAX ? "verify OK" : "verify FAILED");
+    printf("    device: %7u groups, %8u elements, %9.3f ms  |  host: %7u groups, %8u elements, %9.3f ms  |  next device share %.3f\n",
+        stats.deviceGroupCount, stats.deviceElemCount, (double)stats.deviceElapsedTime / 1000000.0,
+        stats.hostGroupCount, stats.hostElemCount, (double)stats.hostElapsedTime / 1000000.0, stats.deviceShare);
+}
+
+void HeterogeneousComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin heterogeneous test ================\n");
+
+    HeterogeneousNewtonHostTest();
+
+    struct HeterogeneousExecutor* pExecutor = NULL;
+    uint32_t* src = NULL;
+    uint32_t* dst = NULL;
+
+    // The 6-op chain of the elementwise kernel fusion test
+    const struct ElementwiseChain chain = {
+        6, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_XOR, ELEMENTWISE_OP_MIN, ELEMENTWISE_OP_MAX, ELEMENTWISE_OP_MUL },
+        { 7, 3, 0x5a5aU, 1U << 30, 12345, 5 }
+    };
+
+    do
+    {
+        const uint32_t elemCount = HETEROGENEOUS_TEST_ELEM_COUNT;
+        VkResult result = CreateHeterogeneousExecutor(specDevice, pMemoryProperties, specQueueFamilyIndex, pLimits, elemCount, &pExecutor);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateHeterogeneousExecutor failed: %d\n", result);
+            break;
+        }
+
+        src = malloc((size_t)elemCount * sizeof(uint32_t));
+        dst = malloc((size_t)elemCount * sizeof(uint32_t));
+        if (src == NULL || dst == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+        HostParallelFillSequence((int*)src, elemCount, 0);
+
+        printf("%u elements per job, %u host thread(s), device timed by %s\n", elemCount, HostParallelGetThreadCount(),
+            pExecutor->queryPool != VK_NULL_HANDLE ? "timestamps" : "the host");
+
+        // The first job of each side creates the plan and warms it up, and measures its first throughput
+        const struct
+        {
+            enum HeterogeneousMode mode;
+            const char* title;
+        } singleRuns[] = {
+            { HETEROGENEOUS_MODE_DEVICE_ONLY, "device alone" },
+            { HETEROGENEOUS_MODE_DEVICE_ONLY, "device alone" },
+            { HETEROGENEOUS_MODE_HOST_ONLY, "host alone" },
+            { HETEROGENEOUS_MODE_HOST_ONLY, "host alone" }
+        };
+        for (size_t i = 0; i < sizeof(singleRuns) / sizeof(singleRuns[0]) && result == VK_SUCCESS; i++)
+        {
+            memset(dst, 0, (size_t)elemCount * sizeof(uint32_t));
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunHeterogeneousElementwiseChain(pExecutor, &chain, src, dst, elemCount, singleRuns[i].mode);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            PrintHeterogeneousRun(pExecutor, singleRuns[i].title, elapsedTime, elemCount, VerifyHeterogeneousResult(&chain, dst, elemCount));
+        }
+
+        // The share settles as the rounds blend in the throughputs measured while both sides are busy
+        char title[64];
+        for (int round = 0; round < HETEROGENEOUS_TEST_ROUND_COUNT && result == VK_SUCCESS; round++)
+        {
+            memset(dst, 0, (size_t)elemCount * sizeof(uint32_t));
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunHeterogeneousElementwiseChain(pExecutor, &chain, src, dst, elemCount, HETEROGENEOUS_MODE_SPLIT);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            snprintf(title, sizeof(title), "split, round %d", round);
+            PrintHeterogeneousRun(pExecutor, title, elapsedTime, elemCount, VerifyHeterogeneousResult(&chain, dst, elemCount));
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "RunHeterogeneousElementwiseChain failed: %d\n", result);
+        }
+    } while (false);
+
+    free(dst);
+    free(src);
+    DestroyHeterogeneousExecutor(pExecutor);
+
+    puts("\n================ Complete heterogeneous test ================\n");
+}
@@ -0,0 +1,62 @@
+#ifndef HETEROGENEOUS_H
+#define HETEROGENEOUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct ElementwiseChain;
+
+// Heterogeneous execution of an elementwise chain on the selected device and on the host at the same time.
+// The workgroups of the 1D NDRange of a job are split in two contiguous ranges: the device runs the first one through the elementwise
+// context of elementwise_fusion.h, and the host runs the rest of them through the same OpenCL C kernel compiled as C (host_kernels.h),
+// on the host threads, while the device is busy.
+// The split follows the throughputs of the two sides measured on the previous jobs, so that both of them finish at about the same time.
+// The device side is timed by timestamp queries when the queue supports them, plus the copies between the host arrays and the staging buffer.
+
+enum HeterogeneousMode
+{
+    HETEROGENEOUS_MODE_DEVICE_ONLY,
+    HETEROGENEOUS_MODE_HOST_ONLY,
+    // The workgroups are split by the measured throughputs
+    HETEROGENEOUS_MODE_SPLIT
+};
+
+struct HeterogeneousStats
+{
+    // The workgroups and the elements of each side in the last job
+    uint32_t deviceGroupCount;
+    uint32_t hostGroupCount;
+    uint32_t deviceElemCount;
+    uint32_t hostElemCount;
+    uint64_t deviceElapsedTime;
+    uint64_t hostElapsedTime;
+    // Elements per second, blended over the jobs. 0 until the side has run.
+    double deviceThroughput;
+    double hostThroughput;
+    // The fraction of the workgroups the device takes in the next split job
+    double deviceShare;
+};
+
+struct HeterogeneousExecutor;
+
+// @param maxElemCount: the largest job, which the device buffers and the staging buffer hold
+extern VkResult CreateHeterogeneousExecutor(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, uint32_t maxElemCount, struct HeterogeneousExecutor** ppExecutor);
+extern void DestroyHeterogeneousExecutor(struct HeterogeneousExecutor* pExecutor);
+
+// dst[i] = pChain(src[i]) for `elemCount` elements, on the device, on the host or on both of them.
+// The elapsed time of each side that takes part is blended into its throughput.
+extern VkResult RunHeterogeneousElementwiseChain(struct HeterogeneousExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t* dst, uint32_t elemCount, enum HeterogeneousMode mode);
+
+extern void GetHeterogeneousStats(const struct HeterogeneousExecutor* pExecutor, struct HeterogeneousStats* pStats);
+
+// Checks the barriers, the `local` memory and the atomic functions of the host backend with the Newton iteration of iterative.cl,
+// and then compares the device alone and the host alone against the split jobs.
+extern void HeterogeneousComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !HETEROGENEOUS_H
@@ -0,0 +1,591 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "host_allocator.h"
+
+#ifdef _WIN32
+#define HOST_ALLOCATOR_THREAD_LOCAL __declspec(thread)
+#else
+#define HOST_ALLOCATOR_THREAD_LOCAL __thread
+#endif // _WIN32
+
+enum
+{
+    HOST_ALLOCATOR_SCOPE_COUNT = 5,
+
+    // The size classes are the powers of two from 64 bytes to 64 KiB, including the header and the alignment padding
+    HOST_ALLOCATOR_MIN_CLASS_SHIFT = 6,
+    HOST_ALLOCATOR_CLASS_COUNT = 11,
+    HOST_ALLOCATOR_LARGE_CLASS = HOST_ALLOCATOR_CLASS_COUNT,
+    HOST_ALLOCATOR_MIN_ALIGNMENT = 16,
+
+    HOST_ALLOCATOR_CHUNK_SIZE = 1024 * 1024,
+    // The blocks a thread takes from the arena at a time, and the blocks of a class a thread keeps at most
+    HOST_ALLOCATOR_BATCH_SIZE = 16,
+    HOST_ALLOCATOR_CACHE_LIMIT = 64
+};
+
+// The object types with statistics of their own. The first entry takes all the others.
+static const struct
+{
+    VkObjectType type;
+    const char* name;
+} s_objectTypes[] = {
+    { VK_OBJECT_TYPE_UNKNOWN, "other" },
+    { VK_OBJECT_TYPE_INSTANCE, "instance" },
+    { VK_OBJECT_TYPE_DEVICE, "device" },
+    { VK_OBJECT_TYPE_DEVICE_MEMORY, "device memory" },
+    { VK_OBJECT_TYPE_BUFFER, "buffer" },
+    { VK_OBJECT_TYPE_IMAGE, "image" },
+    { VK_OBJECT_TYPE_IMAGE_VIEW, "image view" },
+    { VK_OBJECT_TYPE_SAMPLER, "sampler" },
+    { VK_OBJECT_TYPE_SHADER_MODULE, "shader module" },
+    { VK_OBJECT_TYPE_PIPELINE_CACHE, "pipeline cache" },
+    { VK_OBJECT_TYPE_PIPELINE_LAYOUT, "pipeline layout" },
+    { VK_OBJECT_TYPE_PIPELINE, "pipeline" },
+    { VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, "descriptor set layout" },
+    { VK_OBJECT_TYPE_DESCRIPTOR_POOL, "descriptor pool" },
+    { VK_OBJECT_TYPE_COMMAND_POOL, "command pool" },
+    { VK_OBJECT_TYPE_FENCE, "fence" },
+    { VK_OBJECT_TYPE_SEMAPHORE, "semaphore" },
+    { VK_OBJECT_TYPE_EVENT, "event" },
+    { VK_OBJECT_TYPE_QUERY_POOL, "query pool" }
+};
+
+#define HOST_ALLOCATOR_OBJECT_TYPE_COUNT    (sizeof(s_objectTypes) / sizeof(s_objectTypes[0]))
+
+static const char* const s_scopeNames[HOST_ALLOCATOR_SCOPE_COUNT] = { "command", "object", "cache", "device", "instance" };
+
+// Precedes every block returned to the implementation
+struct HostAllocatorHeader
+{
+    size_t size;
+    // From the start of the block of the size class, or of the malloc block
+    uint32_t offset;
+    uint8_t sizeClass;
+    uint8_t typeIndex;
+    uint8_t scopeIndex;
+    uint8_t reserved;
+};
+
+struct HostAllocatorCounters
+{
+    volatile uint64_t allocationCount;
+    volatile uint64_t reallocationCount;
+    volatile uint64_t freeCount;
+    volatile uint64_t allocatedBytes;
+    volatile uint64_t liveBytes;
+    volatile uint64_t peakBytes;
+};
+
+struct HostAllocatorFreeBlock
+{
+    struct HostAllocatorFreeBlock* next;
+};
+
+struct HostAllocatorChunk
+{
+    struct HostAllocatorChunk* next;
+};
+
+struct HostAllocatorThreadCache
+{
+    // The cache of an earlier arena is dropped
+    uint32_t generation;
+    uint32_t counts[HOST_ALLOCATOR_CLASS_COUNT];
+    struct HostAllocatorFreeBlock* lists[HOST_ALLOCATOR_CLASS_COUNT];
+};
+
+static bool s_enabled = false;
+static uint32_t s_generation = 0;
+static VkAllocationCallbacks s_callbacks[HOST_ALLOCATOR_OBJECT_TYPE_COUNT];
+static struct HostAllocatorCounters s_counters[HOST_ALLOCATOR_OBJECT_TYPE_COUNT][HOST_ALLOCATOR_SCOPE_COUNT];
+// The allocations the implementation makes itself and reports through pfnInternalAllocation
+static struct HostAllocatorCounters s_internalCounters[HOST_ALLOCATOR_SCOPE_COUNT];
+
+static HOST_ALLOCATOR_THREAD_LOCAL struct HostAllocatorThreadCache s_threadCache;
+
+// The arena, guarded by `s_pArenaLock`
+static struct HostLock* s_pArenaLock = NULL;
+static struct HostAllocatorFreeBlock* s_arenaLists[HOST_ALLOCATOR_CLASS_COUNT];
+static struct HostAllocatorChunk* s_chunks = NULL;
+static uint8_t* s_chunkCursor = NULL;
+static uint8_t* s_chunkEnd = NULL;
+static uint64_t s_chunkCount = 0;
+static uint64_t s_chunkBytes = 0;
+static uint64_t s_refillCount = 0;
+static uint64_t s_flushCount = 0;
+// The blocks of the size classes and the malloc blocks handed out
+static volatile uint64_t s_smallBlockCount = 0;
+static volatile uint64_t s_largeBlockCount = 0;
+
+static uint32_t GetHostAllocatorScopeIndex(VkSystemAllocationScope scope)
+{
+    switch (scope)
+    {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+        return 0;
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+        return 1;
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+        return 2;
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+        return 3;
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+    default:
+        return 4;
+    }
+}
+
+static uint32_t GetHostAllocatorTypeIndex(VkObjectType objectType)
+{
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_OBJECT_TYPE_COUNT; i++)
+    {
+        if (s_objectTypes[i].type == objectType) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// MARK: Arena
+
+static inline size_t GetHostAllocatorClassSize(uint32_t sizeClass)
+{
+    return (size_t)1 << (HOST_ALLOCATOR_MIN_CLASS_SHIFT + sizeClass);
+}
+
+static uint32_t GetHostAllocatorSizeClass(size_t blockSize)
+{
+    for (uint32_t sizeClass = 0; sizeClass < HOST_ALLOCATOR_CLASS_COUNT; sizeClass++)
+    {
+        if (blockSize <= GetHostAllocatorClassSize(sizeClass)) {
+            return sizeClass;
+        }
+    }
+    return HOST_ALLOCATOR_LARGE_CLASS;
+}
+
+static struct HostAllocatorThreadCache* GetHostAllocatorThreadCache(void)
+{
+    struct HostAllocatorThreadCache* pCache = &s_threadCache;
+    if (pCache->generation != s_generation)
+    {
+        memset(pCache, 0, sizeof(*pCache));
+        pCache->generation = s_generation;
+    }
+    return pCache;
+}
+
+// Moves a batch of blocks of `sizeClass` from the arena into the thread cache. Returns false if it is out of memory.
+static bool RefillHostAllocatorThreadCache(struct HostAllocatorThreadCache* pCache, uint32_t sizeClass)
+{
+    const size_t classSize = GetHostAllocatorClassSize(sizeClass);
+    bool succeeded = true;
+
+    HostLockAcquire(s_pArenaLock);
+    s_refillCount++;
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_BATCH_SIZE; i++)
+    {
+        struct HostAllocatorFreeBlock* pBlock = s_arenaLists[sizeClass];
+        if (pBlock != NULL) {
+            s_arenaLists[sizeClass] = pBlock->next;
+        }
+        else
+        {
+            // The rest of the current chunk is dropped when a block does not fit in it
+            if (s_chunkCursor == NULL || (size_t)(s_chunkEnd - s_chunkCursor) < classSize)
+            {
+                const size_t chunkSize = HOST_ALLOCATOR_CHUNK_SIZE;
+                struct HostAllocatorChunk* pChunk = malloc(chunkSize);
+                if (pChunk == NULL)
+                {
+                    succeeded = i > 0;
+                    break;
+                }
+                pChunk->next = s_chunks;
+                s_chunks = pChunk;
+                s_chunkCursor = (uint8_t*)pChunk + HOST_ALLOCATOR_MIN_ALIGNMENT;
+                s_chunkEnd = (uint8_t*)pChunk + chunkSize;
+                s_chunkCount++;
+                s_chunkBytes += chunkSize;
+            }
+            pBlock = (struct HostAllocatorFreeBlock*)s_chunkCursor;
+            s_chunkCursor += classSize;
+        }
+        pBlock->next = pCache->lists[sizeClass];
+        pCache->lists[sizeClass] = pBlock;
+        pCache->counts[sizeClass]++;
+    }
+    HostLockRelease(s_pArenaLock);
+
+    return succeeded;
+}
+
+// Returns half of the blocks of `sizeClass` in the thread cache to the arena
+static void FlushHostAllocatorThreadCache(struct HostAllocatorThreadCache* pCache, uint32_t sizeClass)
+{
+    HostLockAcquire(s_pArenaLock);
+    s_flushCount++;
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_CACHE_LIMIT / 2; i++)
+    {
+        struct HostAllocatorFreeBlock* pBlock = pCache->lists[sizeClass];
+        pCache->lists[sizeClass] = pBlock->next;
+        pCache->counts[sizeClass]--;
+        pBlock->next = s_arenaLists[sizeClass];
+        s_arenaLists[sizeClass] = pBlock;
+    }
+    HostLockRelease(s_pArenaLock);
+}
+
+static void* AcquireHostAllocatorBlock(uint32_t sizeClass, size_t blockSize)
+{
+    if (sizeClass == HOST_ALLOCATOR_LARGE_CLASS)
+    {
+        HostAtomicFetchAddUInt64(&s_largeBlockCount, 1);
+        return malloc(blockSize);
+    }
+
+    struct HostAllocatorThreadCache* pCache = GetHostAllocatorThreadCache();
+    if (pCache->lists[sizeClass] == NULL && !RefillHostAllocatorThreadCache(pCache, sizeClass)) {
+        return NULL;
+    }
+    struct HostAllocatorFreeBlock* pBlock = pCache->lists[sizeClass];
+    pCache->lists[sizeClass] = pBlock->next;
+    pCache->counts[sizeClass]--;
+    HostAtomicFetchAddUInt64(&s_smallBlockCount, 1);
+    return pBlock;
+}
+
+static void ReleaseHostAllocatorBlock(uint32_t sizeClass, void* block)
+{
+    if (sizeClass == HOST_ALLOCATOR_LARGE_CLASS)
+    {
+        free(block);
+        return;
+    }
+
+    // A block freed by another thread than the one that allocated it joins the cache of the freeing thread
+    struct HostAllocatorThreadCache* pCache = GetHostAllocatorThreadCache();
+    struct HostAllocatorFreeBlock* pBlock = block;
+    pBlock->next = pCache->lists[sizeClass];
+    pCache->lists[sizeClass] = pBlock;
+    if (++pCache->counts[sizeClass] > HOST_ALLOCATOR_CACHE_LIMIT) {
+        FlushHostAllocatorThreadCache(pCache, sizeClass);
+    }
+}
+
+static inline struct HostAllocatorHeader* GetHostAllocatorHeader(void* pMemory)
+{
+    return (struct HostAllocatorHeader*)pMemory - 1;
+}
+
+// Returns a block of `size` bytes aligned to `alignment` with its header filled in, or NULL. It updates no statistics.
+static void* AcquireHostAllocatorMemory(size_t size, size_t alignment, uint32_t typeIndex, uint32_t scopeIndex)
+{
+    if (size == 0 || size > SIZE_MAX / 2 || alignment > UINT32_MAX / 2 || (alignment & (alignment - 1)) != 0) return NULL;
+
+    if (alignment < HOST_ALLOCATOR_MIN_ALIGNMENT) {
+        alignment = HOST_ALLOCATOR_MIN_ALIGNMENT;
+    }
+    const size_t blockSize = sizeof(struct HostAllocatorHeader) + size + alignment - 1;
+    const uint32_t sizeClass = GetHostAllocatorSizeClass(blockSize);
+    uint8_t* block = AcquireHostAllocatorBlock(sizeClass, blockSize);
+    if (block == NULL) return NULL;
+
+    const uintptr_t address = ((uintptr_t)block + sizeof(struct HostAllocatorHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    void* pMemory = (void*)address;
+    struct HostAllocatorHeader* pHeader = GetHostAllocatorHeader(pMemory);
+    pHeader->size = size;
+    pHeader->offset = (uint32_t)(address - (uintptr_t)block);
+    pHeader->sizeClass = (uint8_t)sizeClass;
+    pHeader->typeIndex = (uint8_t)typeIndex;
+    pHeader->scopeIndex = (uint8_t)scopeIndex;
+    pHeader->reserved = 0;
+    return pMemory;
+}
+
+static void ReleaseHostAllocatorMemory(void* pMemory)
+{
+    const struct HostAllocatorHeader* pHeader = GetHostAllocatorHeader(pMemory);
+    ReleaseHostAllocatorBlock(pHeader->sizeClass, (uint8_t*)pMemory - pHeader->offset);
+}
+
+// MARK: Statistics
+
+static void AddHostAllocatorLiveBytes(struct HostAllocatorCounters* pCounters, uint64_t size)
+{
+    const uint64_t liveBytes = HostAtomicFetchAddUInt64(&pCounters->liveBytes, size) + size;
+    uint64_t peakBytes = pCounters->peakBytes;
+    while (liveBytes > peakBytes)
+    {
+        const uint64_t current = HostAtomicCompareExchangeUInt64(&pCounters->peakBytes, peakBytes, liveBytes);
+        if (current == peakBytes) break;
+        peakBytes = current;
+    }
+}
+
+static inline void SubtractHostAllocatorLiveBytes(struct HostAllocatorCounters* pCounters, uint64_t size)
+{
+    HostAtomicFetchAddUInt64(&pCounters->liveBytes, 0 - size);
+}
+
+// MARK: Callbacks
+
+static void* VKAPI_PTR HostAllocatorAllocation(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope)
+{
+    const uint32_t typeIndex = (uint32_t)(uintptr_t)pUserData;
+    const uint32_t scopeIndex = GetHostAllocatorScopeIndex(allocationScope);
+    void* pMemory = AcquireHostAllocatorMemory(size, alignment, typeIndex, scopeIndex);
+    if (pMemory == NULL) return NULL;
+
+    struct HostAllocatorCounters* pCounters = &s_counters[typeIndex][scopeIndex];
+    HostAtomicFetchAddUInt64(&pCounters->allocationCount, 1);
+    HostAtomicFetchAddUInt64(&pCounters->allocatedBytes, size);
+    AddHostAllocatorLiveBytes(pCounters, size);
+    return pMemory;
+}
+
+static void VKAPI_PTR HostAllocatorFree(void* pUserData, void* pMemory)
+{
+    (void)pUserData;
+    if (pMemory == NULL) return;
+
+    // The statistics of the object type and the scope the block was allocated with, whichever set of callbacks frees it
+    const struct HostAllocatorHeader* pHeader = GetHostAllocatorHeader(pMemory);
+    struct HostAllocatorCounters* pCounters = &s_counters[pHeader->typeIndex][pHeader->scopeIndex];
+    HostAtomicFetchAddUInt64(&pCounters->freeCount, 1);
+    SubtractHostAllocatorLiveBytes(pCounters, pHeader->size);
+    ReleaseHostAllocatorMemory(pMemory);
+}
+
+static void* VKAPI_PTR HostAllocatorReallocation(void* pUserData, void* pOriginal, size_t size, size_t alignment,
+    VkSystemAllocationScope allocationScope)
+{
+    if (pOriginal == NULL) {
+        return HostAllocatorAllocation(pUserData, size, alignment, allocationScope);
+    }
+    if (size == 0)
+    {
+        HostAllocatorFree(pUserData, pOriginal);
+        return NULL;
+    }
+
+    const uint32_t typeIndex = (uint32_t)(uintptr_t)pUserData;
+    const uint32_t scopeIndex = GetHostAllocatorScopeIndex(allocationScope);
+    struct HostAllocatorHeader* pHeader = GetHostAllocatorHeader(pOriginal);
+    const size_t originalSize = pHeader->size;
+    struct HostAllocatorCounters* pOriginalCounters = &s_counters[pHeader->typeIndex][pHeader->scopeIndex];
+
+    void* pMemory = pOriginal;
+    // In place if the block of the size class has room for it and the alignment holds
+    const bool inPlace = pHeader->sizeClass != HOST_ALLOCATOR_LARGE_CLASS && ((uintptr_t)pOriginal & (alignment - 1)) == 0 &&
+        pHeader->offset + size <= GetHostAllocatorClassSize(pHeader->sizeClass);
+    if (inPlace)
+    {
+        pHeader->size = size;
+        pHeader->typeIndex = (uint8_t)typeIndex;
+        pHeader->scopeIndex = (uint8_t)scopeIndex;
+    }
+    else
+    {
+        pMemory = AcquireHostAllocatorMemory(size, alignment, typeIndex, scopeIndex);
+        // The original block stays valid on failure
+        if (pMemory == NULL) return NULL;
+
+        memcpy(pMemory, pOriginal, originalSize < size ? originalSize : size);
+        ReleaseHostAllocatorMemory(pOriginal);
+    }
+
+    struct HostAllocatorCounters* pCounters = &s_counters[typeIndex][scopeIndex];
+    HostAtomicFetchAddUInt64(&pCounters->reallocationCount, 1);
+    if (size > originalSize) {
+        HostAtomicFetchAddUInt64(&pCounters->allocatedBytes, size - originalSize);
+    }
+    SubtractHostAllocatorLiveBytes(pOriginalCounters, originalSize);
+    AddHostAllocatorLiveBytes(pCounters, size);
+    return pMemory;
+}
+
+static void VKAPI_PTR HostAllocatorInternalAllocation(void* pUserData, size_t size, VkInternalAllocationType allocationType,
+    VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+    (void)allocationType;
+    struct HostAllocatorCounters* pCounters = &s_internalCounters[GetHostAllocatorScopeIndex(allocationScope)];
+    HostAtomicFetchAddUInt64(&pCounters->allocationCount, 1);
+    HostAtomicFetchAddUInt64(&pCounters->allocatedBytes, size);
+    AddHostAllocatorLiveBytes(pCounters, size);
+}
+
+static void VKAPI_PTR HostAllocatorInternalFree(void* pUserData, size_t size, VkInternalAllocationType allocationType,
+    VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+    (void)allocationType;
+    struct HostAllocatorCounters* pCounters = &s_internalCounters[GetHostAllocatorScopeIndex(allocationScope)];
+    HostAtomicFetchAddUInt64(&pCounters->freeCount, 1);
+    SubtractHostAllocatorLiveBytes(pCounters, size);
+}
+
+// MARK: Interface
+
+bool HostAllocatorInitialize(bool enableCallbacks)
+{
+    memset(s_counters, 0, sizeof(s_counters));
+    memset(s_internalCounters, 0, sizeof(s_internalCounters));
+    s_smallBlockCount = 0;
+    s_largeBlockCount = 0;
+    s_enabled = false;
+    if (!enableCallbacks) return true;
+
+    s_pArenaLock = HostLockCreate();
+    if (s_pArenaLock == NULL)
+    {
+        fprintf(stderr, "Failed to create the lock of the host allocator!\n");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_OBJECT_TYPE_COUNT; i++)
+    {
+        s_callbacks[i] = (VkAllocationCallbacks){
+            .pUserData = (void*)(uintptr_t)i,
+            .pfnAllocation = HostAllocatorAllocation,
+            .pfnReallocation = HostAllocatorReallocation,
+            .pfnFree = HostAllocatorFree,
+            .pfnInternalAllocation = HostAllocatorInternalAllocation,
+            .pfnInternalFree = HostAllocatorInternalFree
+        };
+    }
+    s_generation++;
+    s_enabled = true;
+    return true;
+}
+
+void HostAllocatorFinalize(void)
+{
+    if (!s_enabled) return;
+
+    PrintHostAllocatorSummary();
+
+    uint64_t liveBytes = 0;
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_OBJECT_TYPE_COUNT; i++)
+    {
+        for (uint32_t scope = 0; scope < HOST_ALLOCATOR_SCOPE_COUNT; scope++) {
+            liveBytes += s_counters[i][scope].liveBytes;
+        }
+    }
+    if (liveBytes > 0) {
+        fprintf(stderr, "%llu bytes allocated through the host allocation callbacks have not been freed!\n", (unsigned long long)liveBytes);
+    }
+
+    // The thread caches of the other threads hold blocks of the chunks, and are dropped as they see the next generation
+    struct HostAllocatorChunk* pChunk = s_chunks;
+    while (pChunk != NULL)
+    {
+        struct HostAllocatorChunk* pNext = pChunk->next;
+        free(pChunk);
+        pChunk = pNext;
+    }
+    s_chunks = NULL;
+    s_chunkCursor = NULL;
+    s_chunkEnd = NULL;
+    s_chunkCount = 0;
+    s_chunkBytes = 0;
+    s_refillCount = 0;
+    s_flushCount = 0;
+    memset(s_arenaLists, 0, sizeof(s_arenaLists));
+    s_generation++;
+
+    HostLockDestroy(s_pArenaLock);
+    s_pArenaLock = NULL;
+    s_enabled = false;
+}
+
+bool HostAllocatorIsEnabled(void)
+{
+    return s_enabled;
+}
+
+const VkAllocationCallbacks* GetHostAllocationCallbacks(VkObjectType objectType)
+{
+    return s_enabled ? &s_callbacks[GetHostAllocatorTypeIndex(objectType)] : NULL;
+}
+
+static void ReadHostAllocatorCounters(const struct HostAllocatorCounters* pCounters, struct HostAllocatorStats* pStats)
+{
+    pStats->allocationCount = pCounters->allocationCount;
+    pStats->reallocationCount = pCounters->reallocationCount;
+    pStats->freeCount = pCounters->freeCount;
+    pStats->allocatedBytes = pCounters->allocatedBytes;
+    pStats->liveBytes = pCounters->liveBytes;
+    pStats->peakBytes = pCounters->peakBytes;
+}
+
+void GetHostAllocatorStats(VkObjectType objectType, VkSystemAllocationScope scope, struct HostAllocatorStats* pStats)
+{
+    ReadHostAllocatorCounters(&s_counters[GetHostAllocatorTypeIndex(objectType)][GetHostAllocatorScopeIndex(scope)], pStats);
+}
+
+static void PrintHostAllocatorRow(const char* typeName, const char* scopeName, const struct HostAllocatorStats* pStats)
+{
+    printf("%-22s %-9s %10llu %9llu %10llu %13llu %11llu %11llu\n", typeName, scopeName,
+        (unsigned long long)pStats->allocationCount, (unsigned long long)pStats->reallocationCount, (unsigned long long)pStats->freeCount,
+        (unsigned long long)pStats->allocatedBytes, (unsigned long long)pStats->peakBytes, (unsigned long long)pStats->liveBytes);
+}
+
+void PrintHostAllocatorSummary(void)
+{
+    if (!s_enabled) return;
+
+    puts("\n================ Host allocation callbacks summary ================\n");
+    printf("%-22s %-9s %10s %9s %10s %13s %11s %11s\n", "object type", "scope", "allocs", "reallocs", "frees", "bytes", "peak", "live");
+
+    struct HostAllocatorStats stats;
+    struct HostAllocatorStats total = { 0 };
+    for (uint32_t i = 0; i < HOST_ALLOCATOR_OBJECT_TYPE_COUNT; i++)
+    {
+        for (uint32_t scope = 0; scope < HOST_ALLOCATOR_SCOPE_COUNT; scope++)
+        {
+            ReadHostAllocatorCounters(&s_counters[i][scope], &stats);
+            if (stats.allocationCount == 0 && stats.reallocationCount == 0) continue;
+
+            PrintHostAllocatorRow(s_objectTypes[i].name, s_scopeNames[scope], &stats);
+            total.allocationCount += stats.allocationCount;
+            total.reallocationCount += stats.reallocationCount;
+            total.freeCount += stats.freeCount;
+            total.allocatedBytes += stats.allocatedBytes;
+            total.peakBytes += stats.peakBytes;
+            total.liveBytes += stats.liveBytes;
+        }
+    }
+    // The sum of the peaks of the rows, which bounds the peak of the whole
+    PrintHostAllocatorRow("total", "", &total);
+
+    for (uint32_t scope = 0; scope < HOST_ALLOCATOR_SCOPE_COUNT; scope++)
+    {
+        ReadHostAllocatorCounters(&s_internalCounters[scope], &stats);
+        if (stats.allocationCount == 0) continue;
+        PrintHostAllocatorRow("internal (notified)", s_scopeNames[scope], &stats);
+    }
+
+    HostLockAcquire(s_pArenaLock);
+    const uint64_t chunkCount = s_chunkCount;
+    const uint64_t chunkBytes = s_chunkBytes;
+    const uint64_t refillCount = s_refillCount;
+    const uint64_t flushCount = s_flushCount;
+    HostLockRelease(s_pArenaLock);
+
+    const uint64_t smallBlockCount = s_smallBlockCount;
+    printf("\nArena: %llu chunk(s) of %.2f MiB in all, %llu small and %llu large block(s) handed out\n", (unsigned long long)chunkCount,
+        (double)chunkBytes / (1024.0 * 1024.0), (unsigned long long)smallBlockCount, (unsigned long long)s_largeBlockCount);
+    printf("Thread caches: %llu refill(s) and %llu flush(es) under the arena lock, %.2f%% of the small blocks without the lock\n",
+        (unsigned long long)refillCount, (unsigned long long)flushCount,
+        smallBlockCount > 0 ? 100.0 * (double)(smallBlockCount - (refillCount < smallBlockCount ? refillCount : smallBlockCount)) / (double)smallBlockCount : 0.0);
+}
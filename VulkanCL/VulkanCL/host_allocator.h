@@ -0,0 +1,48 @@
+#ifndef HOST_ALLOCATOR_H
+#define HOST_ALLOCATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// VkAllocationCallbacks backed by a host arena, for measuring and pooling the host memory the Vulkan implementation allocates.
+// Small blocks come from power-of-two size classes carved out of large chunks. Every thread caches the freed blocks of each class,
+// and exchanges them in batches with the lists of the arena, so the allocations on the job path seldom take a lock.
+// Larger blocks go straight to malloc.
+//
+// There is one set of callbacks per object type, so the statistics are split by object type and by VkSystemAllocationScope.
+// All the sets are compatible with each other, as the specification requires of the callbacks of the creation and the destruction of an object,
+// but an object created with the callbacks must be destroyed with them, and one created without them must be destroyed without them.
+
+struct HostAllocatorStats
+{
+    // pfnAllocation, and pfnReallocation without an original block
+    uint64_t allocationCount;
+    uint64_t reallocationCount;
+    uint64_t freeCount;
+    // The sum of the sizes of the allocations and of the grown reallocations
+    uint64_t allocatedBytes;
+    uint64_t liveBytes;
+    uint64_t peakBytes;
+};
+
+// @param enableCallbacks: false makes GetHostAllocationCallbacks return NULL, so the implementation uses its own allocator
+extern bool HostAllocatorInitialize(bool enableCallbacks);
+// Prints the summary and releases the arena. All the objects created with the callbacks must have been destroyed.
+extern void HostAllocatorFinalize(void);
+
+extern bool HostAllocatorIsEnabled(void);
+
+// The `pAllocator` of the vkCreate* and vkDestroy* functions of `objectType`, and of vkAllocateMemory and vkFreeMemory for VK_OBJECT_TYPE_DEVICE_MEMORY.
+// Returns NULL if the callbacks are disabled. Object types without statistics of their own share the ones of VK_OBJECT_TYPE_UNKNOWN.
+extern const VkAllocationCallbacks* GetHostAllocationCallbacks(VkObjectType objectType);
+
+extern void GetHostAllocatorStats(VkObjectType objectType, VkSystemAllocationScope scope, struct HostAllocatorStats* pStats);
+
+// Prints the statistics of every object type and scope that has allocated, the internal allocations the implementation reported,
+// and the thread cache hits of the arena.
+extern void PrintHostAllocatorSummary(void);
+
+#endif // !HOST_ALLOCATOR_H
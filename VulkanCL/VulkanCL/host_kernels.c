@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "host_kernels.h"
+#include "elementwise_fusion.h"
+
+// The OpenCL C keywords and built-in functions of cl_host.h apply to the rest of this file, so the headers of the other modules go above.
+#define CL_HOST_KERNEL_SOURCE
+#include "cl_host.h"
+
+#include "shaders/elementwise_fusion/elementwise_fusion.cl"
+#include "shaders/iterative/iterative.cl"
+
+// MARK: Elementwise chain
+
+struct ElementwiseChainKernelArgs
+{
+    uint* dst;
+    const uint* src;
+    uint elemCount;
+    uint opCount;
+    uint packedOpCodes;
+    uint4 operandsLo;
+    uint4 operandsHi;
+};
+
+static void ElementwiseChainKernelEntry(void* args)
+{
+    const struct ElementwiseChainKernelArgs* pArgs = args;
+    ElementwiseChainKernel(pArgs->dst, pArgs->src, pArgs->elemCount, pArgs->opCount, pArgs->packedOpCodes, pArgs->operandsLo, pArgs->operandsHi);
+}
+
+bool RunElementwiseChainKernelOnHost(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount,
+    uint32_t* dst, const uint32_t* src, uint32_t elemCount, const struct ElementwiseChain* pChain)
+{
+    if (pChain->opCount > ELEMENTWISE_MAX_CHAIN_LENGTH) return false;
+
+    // The push constants of the chain interpreter kernel, as elementwise_fusion.c packs them
+    uint operands[ELEMENTWISE_MAX_CHAIN_LENGTH] = { 0 };
+    struct ElementwiseChainKernelArgs args = {
+        .dst = dst,
+        .src = src,
+        .elemCount = elemCount,
+        .opCount = pChain->opCount,
+        .packedOpCodes = 0
+    };
+    for (uint32_t i = 0; i < pChain->opCount; i++)
+    {
+        args.packedOpCodes |= ((uint)pChain->ops[i] & 15U) << (i * 4U);
+        operands[i] = pChain->operands[i];
+    }
+    args.operandsLo = (uint4){ operands[0], operands[1], operands[2], operands[3] };
+    args.operandsHi = (uint4){ operands[4], operands[5], operands[6], operands[7] };
+
+    return ClHostEnqueueNDRange(pRange, firstGroup, groupCount, ElementwiseChainKernelEntry, &args, 0);
+}
+
+// MARK: Newton iteration
+
+struct NewtonSqrtKernelArgs
+{
+    const float* coefficients;
+    const float* src;
+    float* dst;
+    uint* control;
+    uint elemCount;
+};
+
+static void NewtonSqrtKernelEntry(void* args)
+{
+    const struct NewtonSqrtKernelArgs* pArgs = args;
+    NewtonSqrtKernel(pArgs->coefficients, pArgs->src, pArgs->dst, pArgs->control, pArgs->elemCount);
+}
+
+bool RunNewtonSqrtKernelOnHost(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount,
+    const float* coefficients, const float* src, float* dst, uint32_t* control, uint32_t elemCount)
+{
+    struct NewtonSqrtKernelArgs args = {
+        .coefficients = coefficients,
+        .src = src,
+        .dst = dst,
+        .control = control,
+        .elemCount = elemCount
+    };
+    return ClHostEnqueueNDRange(pRange, firstGroup, groupCount, NewtonSqrtKernelEntry, &args, CL_HOST_KERNEL_USES_BARRIERS);
+}
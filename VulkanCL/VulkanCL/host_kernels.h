@@ -0,0 +1,23 @@
+#ifndef HOST_KERNELS_H
+#define HOST_KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+struct ClHostNDRange;
+struct ElementwiseChain;
+
+// The OpenCL C kernels of shaders/*/*.cl compiled as C for the host backend of cl_host.h, with the same arguments as their dispatches.
+// Each function runs the workgroups [firstGroup, firstGroup + groupCount) of `pRange` on the host threads, and returns false if the range is invalid.
+
+// ElementwiseChainKernel of elementwise_fusion.cl. dst[i] = pChain(src[i]) for the global IDs i below `elemCount`.
+extern bool RunElementwiseChainKernelOnHost(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount,
+    uint32_t* dst, const uint32_t* src, uint32_t elemCount, const struct ElementwiseChain* pChain);
+
+// NewtonSqrtKernel of iterative.cl, an iteration of the square roots. `control` holds the words of `enum IterativeControl` in iterative.h.
+// It synchronizes the work-items of a workgroup with barriers around a `local` residual.
+extern bool RunNewtonSqrtKernelOnHost(const struct ClHostNDRange* pRange, size_t firstGroup, size_t groupCount,
+    const float* coefficients, const float* src, float* dst, uint32_t* control, uint32_t elemCount);
+
+#endif // !HOST_KERNELS_H
@@ -0,0 +1,1118 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "host_parallel.h"
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // !WIN32_LEAN_AND_MEAN
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // !NOMINMAX
+
+#include <Windows.h>
+#include <intrin.h>
+
+typedef HANDLE HostThreadHandle;
+typedef CRITICAL_SECTION HostMutex;
+typedef CONDITION_VARIABLE HostCondition;
+
+#define HOST_THREAD_LOCAL   __declspec(thread)
+
+static inline void HostMutexInit(HostMutex* pMutex) { InitializeCriticalSection(pMutex); }
+static inline void HostMutexDestroy(HostMutex* pMutex) { DeleteCriticalSection(pMutex); }
+static inline void HostMutexLock(HostMutex* pMutex) { EnterCriticalSection(pMutex); }
+static inline void HostMutexUnlock(HostMutex* pMutex) { LeaveCriticalSection(pMutex); }
+static inline void HostConditionInit(HostCondition* pCond) { InitializeConditionVariable(pCond); }
+static inline void HostConditionDestroy(HostCondition* pCond) { (void)pCond; }
+static inline void HostConditionWait(HostCondition* pCond, HostMutex* pMutex) { SleepConditionVariableCS(pCond, pMutex, INFINITE); }
+static inline void HostConditionBroadcast(HostCondition* pCond) { WakeAllConditionVariable(pCond); }
+static inline void HostConditionSignal(HostCondition* pCond) { WakeConditionVariable(pCond); }
+
+static inline void HostConditionWaitTimeout(HostCondition* pCond, HostMutex* pMutex, uint64_t timeoutNanoseconds)
+{
+    const uint64_t milliseconds = timeoutNanoseconds / 1000000U;
+    SleepConditionVariableCS(pCond, pMutex, milliseconds >= INFINITE ? INFINITE : (DWORD)milliseconds);
+}
+
+static inline size_t HostAtomicFetchAdd(volatile size_t* pValue, size_t addend)
+{
+#ifdef _WIN64
+    return (size_t)_InterlockedExchangeAdd64((volatile LONG64*)pValue, (LONG64)addend);
+#else
+    return (size_t)_InterlockedExchangeAdd((volatile LONG*)pValue, (LONG)addend);
+#endif // _WIN64
+}
+
+static inline size_t HostAtomicCompareExchange(volatile size_t* pValue, size_t expected, size_t desired)
+{
+#ifdef _WIN64
+    return (size_t)_InterlockedCompareExchange64((volatile LONG64*)pValue, (LONG64)desired, (LONG64)expected);
+#else
+    return (size_t)_InterlockedCompareExchange((volatile LONG*)pValue, (LONG)desired, (LONG)expected);
+#endif // _WIN64
+}
+
+static inline size_t HostAtomicLoad(volatile size_t* pValue)
+{
+    return HostAtomicFetchAdd(pValue, 0);
+}
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+
+typedef pthread_t HostThreadHandle;
+typedef pthread_mutex_t HostMutex;
+typedef pthread_cond_t HostCondition;
+
+#define HOST_THREAD_LOCAL   __thread
+
+static inline void HostMutexInit(HostMutex* pMutex) { pthread_mutex_init(pMutex, NULL); }
+static inline void HostMutexDestroy(HostMutex* pMutex) { pthread_mutex_destroy(pMutex); }
+static inline void HostMutexLock(HostMutex* pMutex) { pthread_mutex_lock(pMutex); }
+static inline void HostMutexUnlock(HostMutex* pMutex) { pthread_mutex_unlock(pMutex); }
+static inline void HostConditionDestroy(HostCondition* pCond) { pthread_cond_destroy(pCond); }
+static inline void HostConditionWait(HostCondition* pCond, HostMutex* pMutex) { pthread_cond_wait(pCond, pMutex); }
+static inline void HostConditionBroadcast(HostCondition* pCond) { pthread_cond_broadcast(pCond); }
+static inline void HostConditionSignal(HostCondition* pCond) { pthread_cond_signal(pCond); }
+
+// The timeouts are measured on the monotonic clock, so that they are immune to the changes of the wall clock
+static inline void HostConditionInit(HostCondition* pCond)
+{
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(pCond, &attributes);
+    pthread_condattr_destroy(&attributes);
+}
+
+static inline void HostConditionWaitTimeout(HostCondition* pCond, HostMutex* pMutex, uint64_t timeoutNanoseconds)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    const uint64_t nanoseconds = (uint64_t)deadline.tv_nsec + timeoutNanoseconds % 1000000000U;
+    deadline.tv_sec += (time_t)(timeoutNanoseconds / 1000000000U + nanoseconds / 1000000000U);
+    deadline.tv_nsec = (long)(nanoseconds % 1000000000U);
+    pthread_cond_timedwait(pCond, pMutex, &deadline);
+}
+
+static inline size_t HostAtomicFetchAdd(volatile size_t* pValue, size_t addend)
+{
+    return __atomic_fetch_add(pValue, addend, __ATOMIC_ACQ_REL);
+}
+
+static inline size_t HostAtomicCompareExchange(volatile size_t* pValue, size_t expected, size_t desired)
+{
+    __atomic_compare_exchange_n(pValue, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return expected;
+}
+
+static inline size_t HostAtomicLoad(volatile size_t* pValue)
+{
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+}
+
+#endif // _WIN32
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HOST_ARCH_X86   1
+#include <immintrin.h>
+#if !defined(_MSC_VER)
+#include <cpuid.h>
+#endif // !_MSC_VER
+#elif defined(_M_ARM64) || defined(__aarch64__) || defined(__ARM_NEON)
+#define HOST_ARCH_ARM_NEON  1
+#include <arm_neon.h>
+#endif
+
+// MSVC accepts AVX2 intrinsics in any function while GCC and Clang require the target attribute.
+#if defined(HOST_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HOST_TARGET_AVX2    __attribute__((target("avx2")))
+#else
+#define HOST_TARGET_AVX2
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX    ((size_t)-1)
+#endif // !SIZE_MAX
+
+enum
+{
+    // Each batch of the fill and verification kernels should be large enough to amortize the scheduling cost
+    HOST_PARALLEL_MIN_ELEMENTWISE_BATCH = 64 * 1024,
+
+    HOST_PARALLEL_BENCHMARK_ELEM_COUNT = 10 * 1024 * 1024,
+    HOST_PARALLEL_BENCHMARK_LOOP_COUNT = 8
+};
+
+// MARK: SIMD kernels
+
+typedef void (*FillSequenceFunc)(int* dst, size_t count, uint32_t startValue);
+typedef size_t (*FindMismatchFunc)(const int* src, size_t count, uint32_t firstExpected, uint32_t step);
+
+static void FillSequenceScalar(int* dst, size_t count, uint32_t startValue)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int)(startValue + (uint32_t)i);
+    }
+}
+
+// Expected value of element i is `firstExpected + i * step` in wrap-around 32-bit arithmetic.
+static size_t FindMismatchScalar(const int* src, size_t count, uint32_t firstExpected, uint32_t step)
+{
+    uint32_t expected = firstExpected;
+    for (size_t i = 0; i < count; i++, expected += step)
+    {
+        if ((uint32_t)src[i] != expected) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+#ifdef HOST_ARCH_X86
+
+static void FillSequenceSSE2(int* dst, size_t count, uint32_t startValue)
+{
+    // The lanes wrap around in 32-bit unsigned arithmetic, as in the scalar path
+    const uint32_t initValues[4] = { startValue, startValue + 1U, startValue + 2U, startValue + 3U };
+    __m128i values = _mm_loadu_si128((const __m128i*)initValues);
+    const __m128i increment = _mm_set1_epi32(4);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_si128((__m128i*)&dst[i], values);
+        values = _mm_add_epi32(values, increment);
+    }
+    FillSequenceScalar(dst + i, count - i, startValue + (uint32_t)i);
+}
+
+static size_t FindMismatchSSE2(const int* src, size_t count, uint32_t firstExpected, uint32_t step)
+{
+    const uint32_t initValues[4] = { firstExpected, firstExpected + step, firstExpected + 2U * step, firstExpected + 3U * step };
+    __m128i expected = _mm_loadu_si128((const __m128i*)initValues);
+    const __m128i increment = _mm_set1_epi32((int)(4U * step));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i values = _mm_loadu_si128((const __m128i*)&src[i]);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(values, expected)) != 0xffff) {
+            break;
+        }
+        expected = _mm_add_epi32(expected, increment);
+    }
+    const size_t index = FindMismatchScalar(src + i, count - i, firstExpected + (uint32_t)i * step, step);
+    return index == SIZE_MAX ? SIZE_MAX : index + i;
+}
+
+static HOST_TARGET_AVX2 void FillSequenceAVX2(int* dst, size_t count, uint32_t startValue)
+{
+    const uint32_t initValues[8] = {
+        startValue, startValue + 1U, startValue + 2U, startValue + 3U, startValue + 4U, startValue + 5U, startValue + 6U, startValue + 7U
+    };
+    __m256i values = _mm256_loadu_si256((const __m256i*)initValues);
+    const __m256i increment = _mm256_set1_epi32(8);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_si256((__m256i*)&dst[i], values);
+        values = _mm256_add_epi32(values, increment);
+    }
+    FillSequenceScalar(dst + i, count - i, startValue + (uint32_t)i);
+}
+
+static HOST_TARGET_AVX2 size_t FindMismatchAVX2(const int* src, size_t count, uint32_t firstExpected, uint32_t step)
+{
+    uint32_t initValues[8];
+    for (uint32_t lane = 0; lane < 8; lane++) {
+        initValues[lane] = firstExpected + lane * step;
+    }
+    __m256i expected = _mm256_loadu_si256((const __m256i*)initValues);
+    const __m256i increment = _mm256_set1_epi32((int)(8U * step));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i values = _mm256_loadu_si256((const __m256i*)&src[i]);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(values, expected)) != -1) {
+            break;
+        }
+        expected = _mm256_add_epi32(expected, increment);
+    }
+    const size_t index = FindMismatchScalar(src + i, count - i, firstExpected + (uint32_t)i * step, step);
+    return index == SIZE_MAX ? SIZE_MAX : index + i;
+}
+
+#endif // HOST_ARCH_X86
+
+#ifdef HOST_ARCH_ARM_NEON
+
+static void FillSequenceNEON(int* dst, size_t count, uint32_t startValue)
+{
+    const uint32_t initValues[4] = { startValue, startValue + 1U, startValue + 2U, startValue + 3U };
+    uint32x4_t values = vld1q_u32(initValues);
+    const uint32x4_t increment = vdupq_n_u32(4U);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_s32(&dst[i], vreinterpretq_s32_u32(values));
+        values = vaddq_u32(values, increment);
+    }
+    FillSequenceScalar(dst + i, count - i, startValue + (uint32_t)i);
+}
+
+static size_t FindMismatchNEON(const int* src, size_t count, uint32_t firstExpected, uint32_t step)
+{
+    const uint32_t initValues[4] = { firstExpected, firstExpected + step, firstExpected + 2U * step, firstExpected + 3U * step };
+    uint32x4_t expected = vld1q_u32(initValues);
+    const uint32x4_t increment = vdupq_n_u32(4U * step);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t values = vreinterpretq_u32_s32(vld1q_s32(&src[i]));
+        const uint32x4_t equals = vceqq_u32(values, expected);
+        const uint32x2_t narrowed = vand_u32(vget_low_u32(equals), vget_high_u32(equals));
+        if ((vget_lane_u32(narrowed, 0) & vget_lane_u32(narrowed, 1)) != 0xffffffffU) {
+            break;
+        }
+        expected = vaddq_u32(expected, increment);
+    }
+    const size_t index = FindMismatchScalar(src + i, count - i, firstExpected + (uint32_t)i * step, step);
+    return index == SIZE_MAX ? SIZE_MAX : index + i;
+}
+
+#endif // HOST_ARCH_ARM_NEON
+
+// MARK: CPU feature detection
+
+static enum HostSimdLevel DetectSimdLevel(void)
+{
+#if defined(HOST_ARCH_X86)
+    unsigned regs[4] = { 0 };
+#ifdef _MSC_VER
+    __cpuid((int*)regs, 0);
+    const unsigned maxLeaf = regs[0];
+    __cpuid((int*)regs, 1);
+#else
+    const unsigned maxLeaf = __get_cpuid_max(0, NULL);
+    __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif // _MSC_VER
+    const bool hasSSE2 = (regs[3] & (1U << 26)) != 0;
+    const bool hasOSXSAVE = (regs[2] & (1U << 27)) != 0;
+    const bool hasAVX = (regs[2] & (1U << 28)) != 0;
+
+    bool hasAVX2 = false;
+    if (maxLeaf >= 7 && hasOSXSAVE && hasAVX)
+    {
+        // The OS must also preserve the YMM registers on context switches (XCR0 bits 1 and 2)
+#ifdef _MSC_VER
+        const unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex((int*)regs, 7, 0);
+#else
+        unsigned xcr0Low = 0, xcr0High = 0;
+        __asm__ volatile ("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        const unsigned long long xcr0 = ((unsigned long long)xcr0High << 32) | xcr0Low;
+        __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif // _MSC_VER
+        hasAVX2 = (xcr0 & 0x6) == 0x6 && (regs[1] & (1U << 5)) != 0;
+    }
+
+    if (hasAVX2) {
+        return HOST_SIMD_LEVEL_AVX2;
+    }
+    if (hasSSE2) {
+        return HOST_SIMD_LEVEL_SSE2;
+    }
+    return HOST_SIMD_LEVEL_SCALAR;
+#elif defined(HOST_ARCH_ARM_NEON)
+    return HOST_SIMD_LEVEL_NEON;
+#else
+    return HOST_SIMD_LEVEL_SCALAR;
+#endif
+}
+
+// MARK: Thread pool
+
+struct HostThreadPool
+{
+    HostThreadHandle threads[HOST_PARALLEL_MAX_THREAD_COUNT];
+    uint32_t workerCount;
+
+    HostMutex lock;
+    HostCondition wakeCondition;
+    HostCondition doneCondition;
+    // Serializes concurrent HostParallelFor callers
+    HostMutex submitLock;
+
+    // The current job
+    HostParallelTask task;
+    void* context;
+    size_t count;
+    size_t batchSize;
+    volatile size_t nextIndex;
+    // The threads beyond `participantLimit` skip the current job
+    size_t participantLimit;
+    volatile size_t nextParticipant;
+    uint32_t busyWorkerCount;
+    uint64_t generation;
+    bool quit;
+};
+
+static struct HostThreadPool s_threadPool;
+static bool s_threadPoolInitialized = false;
+static uint32_t s_threadCount = 1;
+
+static enum HostSimdLevel s_simdLevel = HOST_SIMD_LEVEL_SCALAR;
+static FillSequenceFunc s_fillSequence = FillSequenceScalar;
+static FindMismatchFunc s_findMismatch = FindMismatchScalar;
+
+// Marks the threads that are currently executing a batch so that nested jobs run inline instead of deadlocking.
+static HOST_THREAD_LOCAL bool s_isInsideParallelTask = false;
+
+static void RunJobBatches(struct HostThreadPool* pool)
+{
+    if (HostAtomicFetchAdd(&pool->nextParticipant, 1) >= pool->participantLimit) {
+        return;
+    }
+
+    s_isInsideParallelTask = true;
+    while (true)
+    {
+        const size_t begin = HostAtomicFetchAdd(&pool->nextIndex, pool->batchSize);
+        if (begin >= pool->count) {
+            break;
+        }
+        const size_t end = pool->count - begin > pool->batchSize ? begin + pool->batchSize : pool->count;
+        pool->task(pool->context, begin, end);
+    }
+    s_isInsideParallelTask = false;
+}
+
+static void WorkerLoop(struct HostThreadPool* pool)
+{
+    uint64_t seenGeneration = 0;
+    while (true)
+    {
+        HostMutexLock(&pool->lock);
+        while (!pool->quit && pool->generation == seenGeneration) {
+            HostConditionWait(&pool->wakeCondition, &pool->lock);
+        }
+        if (pool->quit)
+        {
+            HostMutexUnlock(&pool->lock);
+            break;
+        }
+        seenGeneration = pool->generation;
+        HostMutexUnlock(&pool->lock);
+
+        RunJobBatches(pool);
+
+        HostMutexLock(&pool->lock);
+        if (--pool->busyWorkerCount == 0) {
+            HostConditionBroadcast(&pool->doneCondition);
+        }
+        HostMutexUnlock(&pool->lock);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerThreadProc(LPVOID param)
+{
+    WorkerLoop(param);
+    return 0;
+}
+#else
+static void* WorkerThreadProc(void* param)
+{
+    WorkerLoop(param);
+    return NULL;
+}
+#endif // _WIN32
+
+static uint32_t GetLogicalProcessorCount(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    const long count = (long)systemInfo.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif // _WIN32
+    return count > 0 ? (uint32_t)count : 1U;
+}
+
+bool HostParallelInitialize(uint32_t threadCount)
+{
+    if (s_threadPoolInitialized) {
+        return true;
+    }
+
+    s_simdLevel = DetectSimdLevel();
+    switch (s_simdLevel)
+    {
+#ifdef HOST_ARCH_X86
+    case HOST_SIMD_LEVEL_AVX2:
+        s_fillSequence = FillSequenceAVX2;
+        s_findMismatch = FindMismatchAVX2;
+        break;
+    case HOST_SIMD_LEVEL_SSE2:
+        s_fillSequence = FillSequenceSSE2;
+        s_findMismatch = FindMismatchSSE2;
+        break;
+#endif // HOST_ARCH_X86
+#ifdef HOST_ARCH_ARM_NEON
+    case HOST_SIMD_LEVEL_NEON:
+        s_fillSequence = FillSequenceNEON;
+        s_findMismatch = FindMismatchNEON;
+        break;
+#endif // HOST_ARCH_ARM_NEON
+    default:
+        s_fillSequence = FillSequenceScalar;
+        s_findMismatch = FindMismatchScalar;
+        break;
+    }
+
+    if (threadCount == 0) {
+        threadCount = GetLogicalProcessorCount();
+    }
+    if (threadCount > HOST_PARALLEL_MAX_THREAD_COUNT) {
+        threadCount = HOST_PARALLEL_MAX_THREAD_COUNT;
+    }
+
+    struct HostThreadPool* pool = &s_threadPool;
+    memset(pool, 0, sizeof(*pool));
+    HostMutexInit(&pool->lock);
+    HostMutexInit(&pool->submitLock);
+    HostConditionInit(&pool->wakeCondition);
+    HostConditionInit(&pool->doneCondition);
+
+    // The calling thread always takes part in a job, so only (threadCount - 1) workers are needed.
+    for (uint32_t i = 0; i + 1 < threadCount; i++)
+    {
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, WorkerThreadProc, pool, 0, NULL);
+        const bool created = pool->threads[i] != NULL;
+#else
+        const bool created = pthread_create(&pool->threads[i], NULL, WorkerThreadProc, pool) == 0;
+#endif // _WIN32
+        if (!created)
+        {
+            fprintf(stderr, "Failed to create host worker thread %u!\n", i);
+            break;
+        }
+        pool->workerCount++;
+    }
+
+    s_threadCount = pool->workerCount + 1;
+    s_threadPoolInitialized = true;
+
+    printf("Host parallel kernels: %u thread(s), %s code path\n", s_threadCount, HostParallelGetSimdLevelName(s_simdLevel));
+
+    return true;
+}
+
+void HostParallelFinalize(void)
+{
+    if (!s_threadPoolInitialized) {
+        return;
+    }
+
+    struct HostThreadPool* pool = &s_threadPool;
+    HostMutexLock(&pool->lock);
+    pool->quit = true;
+    HostConditionBroadcast(&pool->wakeCondition);
+    HostMutexUnlock(&pool->lock);
+
+    for (uint32_t i = 0; i < pool->workerCount; i++)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif // _WIN32
+    }
+
+    HostConditionDestroy(&pool->doneCondition);
+    HostConditionDestroy(&pool->wakeCondition);
+    HostMutexDestroy(&pool->submitLock);
+    HostMutexDestroy(&pool->lock);
+
+    s_threadPoolInitialized = false;
+    s_threadCount = 1;
+}
+
+uint32_t HostParallelGetThreadCount(void)
+{
+    return s_threadCount;
+}
+
+enum HostSimdLevel HostParallelGetSimdLevel(void)
+{
+    return s_simdLevel;
+}
+
+const char* HostParallelGetSimdLevelName(enum HostSimdLevel level)
+{
+    switch (level)
+    {
+    case HOST_SIMD_LEVEL_SSE2:
+        return "SSE2";
+    case HOST_SIMD_LEVEL_AVX2:
+        return "AVX2";
+    case HOST_SIMD_LEVEL_NEON:
+        return "NEON";
+    default:
+        return "scalar";
+    }
+}
+
+// Runs the job on at most `participantLimit` threads, including the calling thread.
+// The threads take their participant slots in the order they arrive, so the calling thread may only wait for the workers.
+static void RunParallelJob(size_t count, size_t batchSize, size_t participantLimit, HostParallelTask task, void* context)
+{
+    struct HostThreadPool* pool = &s_threadPool;
+    HostMutexLock(&pool->submitLock);
+
+    HostMutexLock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    pool->batchSize = batchSize;
+    pool->nextIndex = 0;
+    pool->participantLimit = participantLimit;
+    pool->nextParticipant = 0;
+    pool->busyWorkerCount = pool->workerCount;
+    pool->generation++;
+    HostConditionBroadcast(&pool->wakeCondition);
+    HostMutexUnlock(&pool->lock);
+
+    RunJobBatches(pool);
+
+    HostMutexLock(&pool->lock);
+    while (pool->busyWorkerCount > 0) {
+        HostConditionWait(&pool->doneCondition, &pool->lock);
+    }
+    HostMutexUnlock(&pool->lock);
+
+    HostMutexUnlock(&pool->submitLock);
+}
+
+void HostParallelFor(size_t count, size_t minBatchSize, HostParallelTask task, void* context)
+{
+    if (count == 0) {
+        return;
+    }
+    if (minBatchSize == 0) {
+        minBatchSize = 1;
+    }
+
+    if (!s_threadPoolInitialized || s_threadPool.workerCount == 0 || s_isInsideParallelTask || count <= minBatchSize)
+    {
+        task(context, 0, count);
+        return;
+    }
+
+    // Several batches per thread keep the threads balanced when some of them get descheduled.
+    size_t batchSize = count / ((size_t)s_threadCount * 4);
+    if (batchSize < minBatchSize) {
+        batchSize = minBatchSize;
+    }
+
+    RunParallelJob(count, batchSize, s_threadCount, task, context);
+}
+
+void HostParallelForEach(size_t count, uint32_t maxThreadCount, HostParallelTask task, void* context)
+{
+    if (count == 0) {
+        return;
+    }
+    if (maxThreadCount == 0 || maxThreadCount > s_threadCount) {
+        maxThreadCount = s_threadCount;
+    }
+
+    if (!s_threadPoolInitialized || s_threadPool.workerCount == 0 || s_isInsideParallelTask || maxThreadCount == 1 || count == 1)
+    {
+        for (size_t i = 0; i < count; i++) {
+            task(context, i, i + 1);
+        }
+        return;
+    }
+
+    RunParallelJob(count, 1, maxThreadCount, task, context);
+}
+
+// MARK: Lock
+
+struct HostLock
+{
+    HostMutex mutex;
+    HostCondition condition;
+};
+
+struct HostLock* HostLockCreate(void)
+{
+    struct HostLock* pLock = malloc(sizeof(*pLock));
+    if (pLock != NULL)
+    {
+        HostMutexInit(&pLock->mutex);
+        HostConditionInit(&pLock->condition);
+    }
+    return pLock;
+}
+
+void HostLockDestroy(struct HostLock* pLock)
+{
+    if (pLock == NULL) return;
+
+    HostConditionDestroy(&pLock->condition);
+    HostMutexDestroy(&pLock->mutex);
+    free(pLock);
+}
+
+void HostLockAcquire(struct HostLock* pLock)
+{
+    HostMutexLock(&pLock->mutex);
+}
+
+void HostLockRelease(struct HostLock* pLock)
+{
+    HostMutexUnlock(&pLock->mutex);
+}
+
+void HostLockWait(struct HostLock* pLock, uint64_t timeoutNanoseconds)
+{
+    if (timeoutNanoseconds == UINT64_MAX) {
+        HostConditionWait(&pLock->condition, &pLock->mutex);
+    }
+    else {
+        HostConditionWaitTimeout(&pLock->condition, &pLock->mutex, timeoutNanoseconds);
+    }
+}
+
+void HostLockWakeOne(struct HostLock* pLock)
+{
+    HostConditionSignal(&pLock->condition);
+}
+
+void HostLockWakeAll(struct HostLock* pLock)
+{
+    HostConditionBroadcast(&pLock->condition);
+}
+
+void HostYield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif // _WIN32
+}
+
+// MARK: Thread
+
+struct HostThread
+{
+    HostThreadHandle handle;
+    HostThreadMain threadMain;
+    void* context;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI HostThreadProc(LPVOID param)
+{
+    struct HostThread* pThread = param;
+    pThread->threadMain(pThread->context);
+    return 0;
+}
+#else
+static void* HostThreadProc(void* param)
+{
+    struct HostThread* pThread = param;
+    pThread->threadMain(pThread->context);
+    return NULL;
+}
+#endif // _WIN32
+
+struct HostThread* HostThreadCreate(HostThreadMain threadMain, void* context)
+{
+    struct HostThread* pThread = malloc(sizeof(*pThread));
+    if (pThread == NULL) return NULL;
+
+    pThread->threadMain = threadMain;
+    pThread->context = context;
+#ifdef _WIN32
+    pThread->handle = CreateThread(NULL, 0, HostThreadProc, pThread, 0, NULL);
+    const bool created = pThread->handle != NULL;
+#else
+    const bool created = pthread_create(&pThread->handle, NULL, HostThreadProc, pThread) == 0;
+#endif // _WIN32
+    if (!created)
+    {
+        free(pThread);
+        return NULL;
+    }
+    return pThread;
+}
+
+void HostThreadJoin(struct HostThread* pThread)
+{
+    if (pThread == NULL) return;
+
+#ifdef _WIN32
+    WaitForSingleObject(pThread->handle, INFINITE);
+    CloseHandle(pThread->handle);
+#else
+    pthread_join(pThread->handle, NULL);
+#endif // _WIN32
+    free(pThread);
+}
+
+// MARK: Shared words
+
+uint32_t HostAtomicLoadUInt32(volatile uint32_t* pValue)
+{
+#ifdef _WIN32
+    return (uint32_t)_InterlockedOr((volatile LONG*)pValue, 0);
+#else
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+#endif // _WIN32
+}
+
+void HostAtomicStoreUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+#ifdef _WIN32
+    _InterlockedExchange((volatile LONG*)pValue, (LONG)value);
+#else
+    __atomic_store_n(pValue, value, __ATOMIC_RELEASE);
+#endif // _WIN32
+}
+
+#ifdef _WIN32
+
+uint32_t HostAtomicFetchAddUInt32(volatile uint32_t* pValue, uint32_t addend)
+{
+    return (uint32_t)_InterlockedExchangeAdd((volatile LONG*)pValue, (LONG)addend);
+}
+
+uint32_t HostAtomicExchangeUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return (uint32_t)_InterlockedExchange((volatile LONG*)pValue, (LONG)value);
+}
+
+uint32_t HostAtomicCompareExchangeUInt32(volatile uint32_t* pValue, uint32_t expected, uint32_t desired)
+{
+    return (uint32_t)_InterlockedCompareExchange((volatile LONG*)pValue, (LONG)desired, (LONG)expected);
+}
+
+uint32_t HostAtomicFetchAndUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return (uint32_t)_InterlockedAnd((volatile LONG*)pValue, (LONG)value);
+}
+
+uint32_t HostAtomicFetchOrUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return (uint32_t)_InterlockedOr((volatile LONG*)pValue, (LONG)value);
+}
+
+uint32_t HostAtomicFetchXorUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return (uint32_t)_InterlockedXor((volatile LONG*)pValue, (LONG)value);
+}
+
+uint64_t HostAtomicFetchAddUInt64(volatile uint64_t* pValue, uint64_t addend)
+{
+    return (uint64_t)_InterlockedExchangeAdd64((volatile LONG64*)pValue, (LONG64)addend);
+}
+
+uint64_t HostAtomicCompareExchangeUInt64(volatile uint64_t* pValue, uint64_t expected, uint64_t desired)
+{
+    return (uint64_t)_InterlockedCompareExchange64((volatile LONG64*)pValue, (LONG64)desired, (LONG64)expected);
+}
+
+// The interlocked functions are full barriers on every architecture, unlike the plain volatile accesses on ARM64
+void* HostAtomicLoadPointer(void* volatile* pValue)
+{
+    return _InterlockedCompareExchangePointer(pValue, NULL, NULL);
+}
+
+void HostAtomicStorePointer(void* volatile* pValue, void* value)
+{
+    _InterlockedExchangePointer(pValue, value);
+}
+
+void* HostAtomicExchangePointer(void* volatile* pValue, void* value)
+{
+    return _InterlockedExchangePointer(pValue, value);
+}
+
+void HostAtomicThreadFence(void)
+{
+    MemoryBarrier();
+}
+
+#else
+
+uint32_t HostAtomicFetchAddUInt32(volatile uint32_t* pValue, uint32_t addend)
+{
+    return __atomic_fetch_add(pValue, addend, __ATOMIC_SEQ_CST);
+}
+
+uint32_t HostAtomicExchangeUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return __atomic_exchange_n(pValue, value, __ATOMIC_SEQ_CST);
+}
+
+uint32_t HostAtomicCompareExchangeUInt32(volatile uint32_t* pValue, uint32_t expected, uint32_t desired)
+{
+    __atomic_compare_exchange_n(pValue, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+
+uint32_t HostAtomicFetchAndUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return __atomic_fetch_and(pValue, value, __ATOMIC_SEQ_CST);
+}
+
+uint32_t HostAtomicFetchOrUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return __atomic_fetch_or(pValue, value, __ATOMIC_SEQ_CST);
+}
+
+uint32_t HostAtomicFetchXorUInt32(volatile uint32_t* pValue, uint32_t value)
+{
+    return __atomic_fetch_xor(pValue, value, __ATOMIC_SEQ_CST);
+}
+
+uint64_t HostAtomicFetchAddUInt64(volatile uint64_t* pValue, uint64_t addend)
+{
+    return __atomic_fetch_add(pValue, addend, __ATOMIC_SEQ_CST);
+}
+
+uint64_t HostAtomicCompareExchangeUInt64(volatile uint64_t* pValue, uint64_t expected, uint64_t desired)
+{
+    __atomic_compare_exchange_n(pValue, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return expected;
+}
+
+void* HostAtomicLoadPointer(void* volatile* pValue)
+{
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+}
+
+void HostAtomicStorePointer(void* volatile* pValue, void* value)
+{
+    __atomic_store_n(pValue, value, __ATOMIC_RELEASE);
+}
+
+void* HostAtomicExchangePointer(void* volatile* pValue, void* value)
+{
+    return __atomic_exchange_n(pValue, value, __ATOMIC_SEQ_CST);
+}
+
+void HostAtomicThreadFence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+#endif // _WIN32
+
+// MARK: Parallel fill and verification
+
+struct FillSequenceContext
+{
+    int* dst;
+    uint32_t startValue;
+};
+
+static void FillSequenceTask(void* context, size_t begin, size_t end)
+{
+    const struct FillSequenceContext* ctx = context;
+    s_fillSequence(ctx->dst + begin, end - begin, ctx->startValue + (uint32_t)begin);
+}
+
+void HostParallelFillSequence(int* dst, size_t count, int startValue)
+{
+    struct FillSequenceContext context = { dst, (uint32_t)startValue };
+    HostParallelFor(count, HOST_PARALLEL_MIN_ELEMENTWISE_BATCH, FillSequenceTask, &context);
+}
+
+struct FindMismatchContext
+{
+    const int* src;
+    uint32_t firstExpected;
+    uint32_t step;
+    // The smallest mismatch index found by any batch
+    volatile size_t firstMismatch;
+};
+
+static void FindMismatchTask(void* context, size_t begin, size_t end)
+{
+    struct FindMismatchContext* ctx = context;
+
+    // A preceding batch has already found a mismatch, so this one cannot provide the first.
+    if (HostAtomicLoad(&ctx->firstMismatch) < begin) {
+        return;
+    }
+
+    const size_t index = s_findMismatch(ctx->src + begin, end - begin, ctx->firstExpected + (uint32_t)begin * ctx->step, ctx->step);
+    if (index == SIZE_MAX) {
+        return;
+    }
+
+    size_t current = HostAtomicLoad(&ctx->firstMismatch);
+    while (begin + index < current)
+    {
+        const size_t previous = HostAtomicCompareExchange(&ctx->firstMismatch, current, begin + index);
+        if (previous == current) {
+            break;
+        }
+        current = previous;
+    }
+}
+
+size_t HostParallelFindMismatch(const int* src, size_t count, int addend, int multiplier)
+{
+    struct FindMismatchContext context = {
+        .src = src,
+        .firstExpected = (uint32_t)addend * (uint32_t)multiplier,
+        .step = (uint32_t)multiplier,
+        .firstMismatch = SIZE_MAX
+    };
+    HostParallelFor(count, HOST_PARALLEL_MIN_ELEMENTWISE_BATCH, FindMismatchTask, &context);
+    return context.firstMismatch;
+}
+
+uint64_t HostGetTimeNanoseconds(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    const uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    const uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000ULL + remainder * 1000000000ULL / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif // _WIN32
+}
+
+// MARK: Benchmark
+
+static void PrintBenchmarkLine(const char* name, uint64_t elapsedNs, size_t bytes, uint64_t baselineNs)
+{
+    const double milliseconds = (double)elapsedNs / 1000000.0;
+    const double gigabytesPerSecond = (double)bytes / ((double)elapsedNs + 1.0);
+    printf("%-36s %9.3f ms  %7.2f GB/s  x%.2f\n", name, milliseconds, gigabytesPerSecond,
+        (double)baselineNs / ((double)elapsedNs + 1.0));
+}
+
+void HostParallelBenchmark(void)
+{
+    puts("\n================ Begin host parallel kernel benchmark ================\n");
+
+    const size_t elemCount = HOST_PARALLEL_BENCHMARK_ELEM_COUNT;
+    const size_t bytes = elemCount * sizeof(int) * HOST_PARALLEL_BENCHMARK_LOOP_COUNT;
+    int* buffer = malloc(elemCount * sizeof(int));
+    if (buffer == NULL)
+    {
+        fprintf(stderr, "Failed to allocate the benchmark buffer!\n");
+        return;
+    }
+
+    printf("Elements: %zu, loops: %d, threads: %u, SIMD: %s\n\n", elemCount, HOST_PARALLEL_BENCHMARK_LOOP_COUNT,
+        s_threadCount, HostParallelGetSimdLevelName(s_simdLevel));
+
+    // Scalar fill, as the original staging buffer initialization
+    uint64_t begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++)
+    {
+        volatile int* dstMem = buffer;
+        for (int i = 0; i < (int)elemCount; i++) {
+            dstMem[i] = i;
+        }
+    }
+    const uint64_t scalarFillNs = HostGetTimeNanoseconds() - begin;
+    PrintBenchmarkLine("Fill: scalar loop", scalarFillNs, bytes, scalarFillNs);
+
+    begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++) {
+        s_fillSequence(buffer, elemCount, 0U);
+    }
+    PrintBenchmarkLine("Fill: SIMD single thread", HostGetTimeNanoseconds() - begin, bytes, scalarFillNs);
+
+    begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++) {
+        HostParallelFillSequence(buffer, elemCount, 0);
+    }
+    PrintBenchmarkLine("Fill: SIMD multithreaded", HostGetTimeNanoseconds() - begin, bytes, scalarFillNs);
+
+    // Scalar verification, as the original result checking loops
+    size_t mismatchCount = 0;
+    begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++)
+    {
+        const volatile int* srcMem = buffer;
+        for (int i = 0; i < (int)elemCount; i++)
+        {
+            if (srcMem[i] != i)
+            {
+                mismatchCount++;
+                break;
+            }
+        }
+    }
+    const uint64_t scalarVerifyNs = HostGetTimeNanoseconds() - begin;
+    PrintBenchmarkLine("Verify: scalar loop", scalarVerifyNs, bytes, scalarVerifyNs);
+
+    begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++)
+    {
+        if (s_findMismatch(buffer, elemCount, 0U, 1U) != SIZE_MAX) {
+            mismatchCount++;
+        }
+    }
+    PrintBenchmarkLine("Verify: SIMD single thread", HostGetTimeNanoseconds() - begin, bytes, scalarVerifyNs);
+
+    begin = HostGetTimeNanoseconds();
+    for (int loop = 0; loop < HOST_PARALLEL_BENCHMARK_LOOP_COUNT; loop++)
+    {
+        if (HostParallelFindMismatch(buffer, elemCount, 0, 1) != SIZE_MAX) {
+            mismatchCount++;
+        }
+    }
+    PrintBenchmarkLine("Verify: SIMD multithreaded", HostGetTimeNanoseconds() - begin, bytes, scalarVerifyNs);
+
+    // Make sure that a mismatch in the middle of the last batch is still reported at the exact index
+    const size_t probeIndex = elemCount - 3;
+    buffer[probeIndex] = -1;
+    const size_t foundIndex = HostParallelFindMismatch(buffer, elemCount, 0, 1);
+    if (mismatchCount != 0 || foundIndex != probeIndex) {
+        fprintf(stderr, "Host parallel verification error! mismatches: %zu, probe found @ %zu\n", mismatchCount, foundIndex);
+    }
+
+    free(buffer);
+
+    puts("\n================ Complete host parallel kernel benchmark ================\n");
+}
+
@@ -0,0 +1,108 @@
+#ifndef HOST_PARALLEL_H
+#define HOST_PARALLEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Host side parallel kernels used for staging buffer initialization, result verification and CPU reference computation.
+// A single process-wide worker thread pool is created by `HostParallelInitialize` and the SIMD code path
+// (scalar, SSE2, AVX2 or NEON) is chosen once at runtime according to the features the current CPU reports.
+
+enum HostSimdLevel
+{
+    HOST_SIMD_LEVEL_SCALAR,
+    HOST_SIMD_LEVEL_SSE2,
+    HOST_SIMD_LEVEL_AVX2,
+    HOST_SIMD_LEVEL_NEON
+};
+
+enum
+{
+    HOST_PARALLEL_MAX_THREAD_COUNT = 64
+};
+
+// Processes the element range [begin, end).
+typedef void (*HostParallelTask)(void* context, size_t begin, size_t end);
+
+// @param threadCount: the total number of threads (including the calling thread) that take part in a parallel job.
+// 0 means the number of logical processors of the current system.
+extern bool HostParallelInitialize(uint32_t threadCount);
+extern void HostParallelFinalize(void);
+
+extern uint32_t HostParallelGetThreadCount(void);
+extern enum HostSimdLevel HostParallelGetSimdLevel(void);
+extern const char* HostParallelGetSimdLevelName(enum HostSimdLevel level);
+
+// Splits [0, count) into batches of at least `minBatchSize` elements and runs `task` on them concurrently.
+// It returns after all the batches have been completed. Calling it from inside a task runs the nested job serially.
+extern void HostParallelFor(size_t count, size_t minBatchSize, HostParallelTask task, void* context);
+
+// Runs `task` on every single element [i, i + 1) of [0, count) using at most `maxThreadCount` threads, including the calling thread.
+// 0 means all the threads of the pool. It suits a small number of long and independent tasks, such as pipeline compilation.
+extern void HostParallelForEach(size_t count, uint32_t maxThreadCount, HostParallelTask task, void* context);
+
+// A mutex for the modules that share their state between the threads, such as a task of HostParallelForEach.
+struct HostLock;
+
+// Returns NULL if it is out of memory.
+extern struct HostLock* HostLockCreate(void);
+extern void HostLockDestroy(struct HostLock* pLock);
+extern void HostLockAcquire(struct HostLock* pLock);
+extern void HostLockRelease(struct HostLock* pLock);
+// Each lock comes with a condition variable. The caller holds the lock, which is released while it sleeps until a wake-up or the timeout.
+// The sleep may also end spuriously, so the caller checks its condition again. UINT64_MAX waits without a timeout.
+extern void HostLockWait(struct HostLock* pLock, uint64_t timeoutNanoseconds);
+extern void HostLockWakeOne(struct HostLock* pLock);
+extern void HostLockWakeAll(struct HostLock* pLock);
+
+// Gives the rest of the time slice to the other threads
+extern void HostYield(void);
+
+// A thread of its own, apart from the pool, for the modules that run a long loop beside the callers, such as a submitter.
+typedef void (*HostThreadMain)(void* context);
+struct HostThread;
+
+// Returns NULL if the thread cannot be created.
+extern struct HostThread* HostThreadCreate(HostThreadMain threadMain, void* context);
+// Waits for `threadMain` to return, and frees the thread.
+extern void HostThreadJoin(struct HostThread* pThread);
+
+// An acquire load and a release store of a 32-bit word that other threads or the device access concurrently,
+// such as a word of mapped host visible device memory.
+extern uint32_t HostAtomicLoadUInt32(volatile uint32_t* pValue);
+extern void HostAtomicStoreUInt32(volatile uint32_t* pValue, uint32_t value);
+
+// The read-modify-write operations are sequentially consistent, and return the value before the operation.
+// The compare-exchange stores `desired` only if the value was `expected`.
+extern uint32_t HostAtomicFetchAddUInt32(volatile uint32_t* pValue, uint32_t addend);
+extern uint32_t HostAtomicExchangeUInt32(volatile uint32_t* pValue, uint32_t value);
+extern uint32_t HostAtomicCompareExchangeUInt32(volatile uint32_t* pValue, uint32_t expected, uint32_t desired);
+extern uint32_t HostAtomicFetchAndUInt32(volatile uint32_t* pValue, uint32_t value);
+extern uint32_t HostAtomicFetchOrUInt32(volatile uint32_t* pValue, uint32_t value);
+extern uint32_t HostAtomicFetchXorUInt32(volatile uint32_t* pValue, uint32_t value);
+extern uint64_t HostAtomicFetchAddUInt64(volatile uint64_t* pValue, uint64_t addend);
+extern uint64_t HostAtomicCompareExchangeUInt64(volatile uint64_t* pValue, uint64_t expected, uint64_t desired);
+
+// The same operations on a pointer, for the linked structures shared between the threads
+extern void* HostAtomicLoadPointer(void* volatile* pValue);
+extern void HostAtomicStorePointer(void* volatile* pValue, void* value);
+extern void* HostAtomicExchangePointer(void* volatile* pValue, void* value);
+
+// A sequentially consistent fence, which orders a store before a later load of another word
+extern void HostAtomicThreadFence(void);
+
+// dst[i] = startValue + i
+extern void HostParallelFillSequence(int* dst, size_t count, int startValue);
+
+// Returns the index of the first element that is not equal to (i + addend) * multiplier, or SIZE_MAX if all elements match.
+extern size_t HostParallelFindMismatch(const int* src, size_t count, int addend, int multiplier);
+
+// Monotonic timestamp in nanoseconds
+extern uint64_t HostGetTimeNanoseconds(void);
+
+// Compares the scalar fill and verification loops against the vectorized and multithreaded implementations.
+extern void HostParallelBenchmark(void);
+
+#endif // !HOST_PARALLEL_H
+
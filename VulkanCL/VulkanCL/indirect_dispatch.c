@@ -0,0 +1,550 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "pipeline_variants.h"
+#include "scan.h"
+#include "elementwise_fusion.h"
+#include "indirect_dispatch.h"
+
+enum
+{
+    // counts, dispatchArgs
+    INDIRECT_GROUP_COUNT_BINDING_COUNT = 2,
+
+    INDIRECT_TEST_ELEM_COUNT = 1 << 20,
+    INDIRECT_TEST_LOOP_COUNT = 10
+};
+
+static const char s_groupCountKernelName[] = "GroupCountKernel";
+
+// layout(push_constant, std430) uniform of GroupCountKernel
+struct GroupCountPushConstants
+{
+    uint32_t countIndex;
+    uint32_t argsSlot;
+    uint32_t elemsPerGroup;
+    uint32_t maxGroupCount;
+};
+
+struct IndirectDispatchContext
+{
+    VkDevice device;
+    struct PipelineVariantCache* pCache;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline groupCountPipeline;
+};
+
+struct IndirectGroupCountPlan
+{
+    const struct IndirectDispatchContext* pContext;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+};
+
+VkResult CreateIndirectArgsBuffer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    uint32_t slotCount, struct IndirectArgsBuffer* pArgsBuffer)
+{
+    *pArgsBuffer = (struct IndirectArgsBuffer){ VK_NULL_HANDLE, VK_NULL_HANDLE, 0 };
+    if (slotCount == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    const VkResult result = CreateBufferWithMemory(device, pMemoryProperties, GetIndirectArgsOffset(slotCount), usage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pArgsBuffer->buffer, &pArgsBuffer->memory);
+    if (result == VK_SUCCESS) {
+        pArgsBuffer->slotCount = slotCount;
+    }
+    return result;
+}
+
+void DestroyIndirectArgsBuffer(VkDevice device, struct IndirectArgsBuffer* pArgsBuffer)
+{
+    DestroyBufferWithMemory(device, pArgsBuffer->buffer, pArgsBuffer->memory);
+    *pArgsBuffer = (struct IndirectArgsBuffer){ VK_NULL_HANDLE, VK_NULL_HANDLE, 0 };
+}
+
+VkResult CreateIndirectDispatchContext(VkDevice device, struct PipelineVariantCache* pCache, struct IndirectDispatchContext** ppContext)
+{
+    struct IndirectDispatchContext* pContext = calloc(1, sizeof(*pContext));
+    if (pContext == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pContext->device = device;
+    pContext->pCache = pCache;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/indirect_dispatch/indirect_dispatch.spv"))
+        {
+            fprintf(stderr, "shaders/indirect_dispatch/indirect_dispatch.spv has not been built by shaders/indirect_dispatch/build-spv!\n");
+            result = VK_ERROR_INITIALIZATION_FAILED;
+            break;
+        }
+
+        result = CreateShaderModule(device, "shaders/indirect_dispatch/indirect_dispatch.spv", &pContext->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(device, INDIRECT_GROUP_COUNT_BINDING_COUNT, &pContext->descLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        result = CreateComputePipelineLayout(device, pContext->descLayout, sizeof(struct GroupCountPushConstants), &pContext->pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        // A single invocation
+        const uint32_t specConstants[] = { 1U, 1U, 1U };
+        result = GetPipelineVariant(pCache, pContext->shaderModule, s_groupCountKernelName, pContext->pipelineLayout, specConstants,
+            (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0])), &pContext->groupCountPipeline);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "GetPipelineVariant failed: %d\n", result);
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyIndirectDispatchContext(pContext);
+        return result;
+    }
+
+    *ppContext = pContext;
+    return VK_SUCCESS;
+}
+
+void DestroyIndirectDispatchContext(struct IndirectDispatchContext* pContext)
+{
+    if (pContext == NULL) return;
+
+    const VkDevice device = pContext->device;
+    // The pipeline belongs to the pipeline variant cache
+    if (pContext->shaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(pContext->pCache, pContext->shaderModule);
+        vkDestroyShaderModule(device, pContext->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+    if (pContext->pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pContext->pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pContext->descLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pContext->descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+
+    free(pContext);
+}
+
+VkResult CreateIndirectGroupCountPlan(struct IndirectDispatchContext* pContext, VkBuffer countBuffer,
+    const struct IndirectArgsBuffer* pArgsBuffer, struct IndirectGroupCountPlan** ppPlan)
+{
+    struct IndirectGroupCountPlan* pPlan = calloc(1, sizeof(*pPlan));
+    if (pPlan == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pPlan->pContext = pContext;
+
+    const VkBuffer buffers[INDIRECT_GROUP_COUNT_BINDING_COUNT] = { countBuffer, pArgsBuffer->buffer };
+    const VkResult result = CreateStorageBufferDescriptorSet(pContext->device, pContext->descLayout, buffers, INDIRECT_GROUP_COUNT_BINDING_COUNT,
+        &pPlan->descriptorPool, &pPlan->descriptorSet);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+        DestroyIndirectGroupCountPlan(pPlan);
+        return result;
+    }
+
+    *ppPlan = pPlan;
+    return VK_SUCCESS;
+}
+
+void DestroyIndirectGroupCountPlan(struct IndirectGroupCountPlan* pPlan)
+{
+    if (pPlan == NULL) return;
+
+    // The descriptor set is freed together with the pool
+    if (pPlan->descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(pPlan->pContext->device, pPlan->descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+
+    free(pPlan);
+}
+
+void RecordIndirectGroupCount(VkCommandBuffer commandBuffer, const struct IndirectGroupCountPlan* pPlan, uint32_t countIndex,
+    uint32_t argsSlot, uint32_t elemsPerGroup, uint32_t maxGroupCount)
+{
+    const struct IndirectDispatchContext* pContext = pPlan->pContext;
+    const struct GroupCountPushConstants pushConstants = { countIndex, argsSlot, elemsPerGroup, maxGroupCount };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->groupCountPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->pipelineLayout, 0, 1, &pPlan->descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pContext->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+    // vkCmdDispatchIndirect reads the slot in the draw indirect stage, and the consuming kernel may read the element count as well
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+// MARK: Test
+
+enum IndirectTestBuffer
+{
+    // The scan test pattern
+    INDIRECT_TEST_BUFFER_SOURCE,
+    // The kept elements of compaction
+    INDIRECT_TEST_BUFFER_COMPACTED,
+    // The chain applied to the kept elements
+    INDIRECT_TEST_BUFFER_RESULT,
+    // Host visible, the readback of the result
+    INDIRECT_TEST_BUFFER_HOST,
+    // Host visible, the kept count of compaction
+    INDIRECT_TEST_BUFFER_COUNT,
+    INDIRECT_TEST_BUFFER_TOTAL
+};
+
+struct IndirectTestContext
+{
+    VkDevice device;
+    VkQueue queue;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    VkBuffer buffers[INDIRECT_TEST_BUFFER_TOTAL];
+    VkDeviceMemory memories[INDIRECT_TEST_BUFFER_TOTAL];
+    const uint32_t* hostResult;
+    const volatile uint32_t* hostCount;
+    struct IndirectArgsBuffer argsBuffer;
+
+    struct ScanContext* pScanContext;
+    struct ScanPlan* pScanPlan;
+    struct ElementwiseContext* pElementwiseContext;
+    struct ElementwiseChainPlan* pDirectPlan;
+    struct ElementwiseChainPlan* pIndirectPlan;
+    struct IndirectDispatchContext* pIndirectContext;
+    struct IndirectGroupCountPlan* pGroupCountPlan;
+    uint32_t elemCount;
+};
+
+// x * 3 + 1 of every kept element
+static const struct ElementwiseChain s_testChain = { 2, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_ADD }, { 3, 1 } };
+
+// The same as RecordScanTestPattern
+static uint32_t GetIndirectTestPatternValue(uint32_t index)
+{
+    return (uint32_t)(((uint64_t)index * 2654435761U) & 0xffffffffU) >> 24;
+}
+
+static bool VerifyIndirectTestResult(const struct IndirectTestContext* pContext, uint32_t threshold, uint32_t count)
+{
+    uint32_t keptCount = 0;
+    for (uint32_t i = 0; i < pContext->elemCount; i++)
+    {
+        const uint32_t value = GetIndirectTestPatternValue(i);
+        if (value < threshold) continue;
+
+        if (keptCount < count && pContext->hostResult[keptCount] != value * 3U + 1U)
+        {
+            fprintf(stderr, "Wrong result at [%u]: %u, expected %u!\n", keptCount, pContext->hostResult[keptCount], value * 3U + 1U);
+            return false;
+        }
+        keptCount++;
+    }
+    if (keptCount != count)
+    {
+        fprintf(stderr, "Wrong kept count %u, expected %u!\n", count, keptCount);
+        return false;
+    }
+
+    // The result buffer is filled with UINT32_MAX before every run, so a chain that runs past the kept count shows up here
+    for (uint32_t i = count; i < pContext->elemCount; i++)
+    {
+        if (pContext->hostResult[i] != UINT32_MAX)
+        {
+            fprintf(stderr, "[%u] beyond the kept count %u has been written: %u!\n", i, count, pContext->hostResult[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void RecordIndirectTestReadback(const struct IndirectTestContext* pContext)
+{
+    RecordComputeToTransferBarrier(pContext->commandBuffer);
+    const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = (VkDeviceSize)pContext->elemCount * sizeof(uint32_t) };
+    vkCmdCopyBuffer(pContext->commandBuffer, pContext->buffers[INDIRECT_TEST_BUFFER_RESULT], pContext->buffers[INDIRECT_TEST_BUFFER_HOST],
+        1, &copyRegion);
+}
+
+// Compaction and the chain, either in two submissions with the host reading the kept count in between,
+// or in one submission with the group count kernel and the indirect chain in between.
+// Both of them read the whole result buffer back, so that the times only differ in the synchronization.
+static VkResult RunIndirectTestPipeline(struct IndirectTestContext* pContext, bool isIndirect, uint32_t threshold, uint64_t* pElapsedTime)
+{
+    const VkCommandBuffer commandBuffer = pContext->commandBuffer;
+
+    // Clears the result of the previous run
+    VkResult result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, commandBuffer);
+    if (result != VK_SUCCESS) return result;
+    vkCmdFillBuffer(commandBuffer, pContext->buffers[INDIRECT_TEST_BUFFER_RESULT], 0, VK_WHOLE_SIZE, UINT32_MAX);
+    vkCmdFillBuffer(commandBuffer, pContext->buffers[INDIRECT_TEST_BUFFER_HOST], 0, VK_WHOLE_SIZE, UINT32_MAX);
+    RecordTransferToComputeBarrier(commandBuffer);
+    RecordScanTestPattern(commandBuffer, pContext->pScanPlan, pContext->elemCount);
+    result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, commandBuffer);
+    if (result != VK_SUCCESS) return result;
+
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+
+    result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, commandBuffer);
+    if (result != VK_SUCCESS) return result;
+    RecordCompaction(commandBuffer, pContext->pScanPlan, pContext->elemCount, threshold);
+    if (isIndirect)
+    {
+        RecordComputeToComputeBarrier(commandBuffer);
+        RecordIndirectGroupCount(commandBuffer, pContext->pGroupCountPlan, 0, 0, GetElementwiseWorkgroupSize(pContext->pElementwiseContext),
+            GetElementwiseMaxGroupCount(pContext->pElementwiseContext));
+        RecordElementwiseChainIndirect(commandBuffer, pContext->pIndirectPlan, pContext->elemCount);
+        RecordIndirectTestReadback(pContext);
+        RecordComputeToHostBarrier(commandBuffer);
+    }
+    else
+    {
+        RecordComputeToHostBarrier(commandBuffer);
+        result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, commandBuffer);
+        if (result != VK_SUCCESS) return result;
+
+        result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, commandBuffer);
+        if (result != VK_SUCCESS) return result;
+        RecordElementwiseChain(commandBuffer, pContext->pDirectPlan, *pContext->hostCount);
+        RecordIndirectTestReadback(pContext);
+    }
+    result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, commandBuffer);
+
+    *pElapsedTime = HostGetTimeNanoseconds() - beginTime;
+    return result;
+}
+
+static VkResult CreateIndirectTestResources(struct IndirectTestContext* pContext, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t queueFamilyIndex, const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties,
+    struct PipelineVariantCache* pCache)
+{
+    const VkDevice device = pContext->device;
+    const VkDeviceSize bufferSize = (VkDeviceSize)pContext->elemCount * sizeof(uint32_t);
+    const VkMemoryPropertyFlags hostFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const struct
+    {
+        VkDeviceSize size;
+        VkBufferUsageFlags usage;
+        VkMemoryPropertyFlags memoryFlags;
+    } bufferInfos[INDIRECT_TEST_BUFFER_TOTAL] = {
+        [INDIRECT_TEST_BUFFER_SOURCE] = { bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+        [INDIRECT_TEST_BUFFER_COMPACTED] = { bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+        [INDIRECT_TEST_BUFFER_RESULT] = { bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+        [INDIRECT_TEST_BUFFER_HOST] = { bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostFlags },
+        [INDIRECT_TEST_BUFFER_COUNT] = { sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostFlags }
+    };
+
+    VkResult result = VK_SUCCESS;
+    for (int i = 0; i < INDIRECT_TEST_BUFFER_TOTAL && result == VK_SUCCESS; i++)
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, bufferInfos[i].size, bufferInfos[i].usage, bufferInfos[i].memoryFlags,
+            queueFamilyIndex, &pContext->buffers[i], &pContext->memories[i]);
+    }
+    if (result == VK_SUCCESS) {
+        result = CreateIndirectArgsBuffer(device, pMemoryProperties, queueFamilyIndex, 1, &pContext->argsBuffer);
+    }
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateBufferWithMemory failed!\n");
+        return result;
+    }
+
+    void* hostPtr = NULL;
+    result = vkMapMemory(device, pContext->memories[INDIRECT_TEST_BUFFER_HOST], 0, VK_WHOLE_SIZE, 0, &hostPtr);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkMapMemory failed: %d\n", result);
+        return result;
+    }
+    pContext->hostResult = hostPtr;
+    result = vkMapMemory(device, pContext->memories[INDIRECT_TEST_BUFFER_COUNT], 0, VK_WHOLE_SIZE, 0, &hostPtr);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkMapMemory failed: %d\n", result);
+        return result;
+    }
+    pContext->hostCount = hostPtr;
+
+    result = CreateScanContext(device, pLimits, pSubgroupProperties, &pContext->pScanContext);
+    if (result == VK_SUCCESS)
+    {
+        result = CreateScanPlan(pContext->pScanContext, pMemoryProperties, queueFamilyIndex, pContext->elemCount,
+            pContext->buffers[INDIRECT_TEST_BUFFER_SOURCE], pContext->buffers[INDIRECT_TEST_BUFFER_COMPACTED],
+            pContext->buffers[INDIRECT_TEST_BUFFER_COUNT], &pContext->pScanPlan);
+    }
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "Creating the scan plan failed: %d\n", result);
+        return result;
+    }
+
+    result = CreateElementwiseContext(device, pLimits, &pContext->pElementwiseContext);
+    if (result == VK_SUCCESS)
+    {
+        result = CreateElementwiseChainPlan(pContext->pElementwiseContext, &s_testChain, ELEMENTWISE_FUSION_INTERPRETED,
+            pContext->buffers[INDIRECT_TEST_BUFFER_COMPACTED], pContext->buffers[INDIRECT_TEST_BUFFER_RESULT], &pContext->pDirectPlan);
+    }
+    if (result == VK_SUCCESS)
+    {
+        result = CreateElementwiseIndirectChainPlan(pContext->pElementwiseContext, &s_testChain, pContext->buffers[INDIRECT_TEST_BUFFER_COMPACTED],
+            pContext->buffers[INDIRECT_TEST_BUFFER_RESULT], pContext->argsBuffer.buffer, 0, &pContext->pIndirectPlan);
+    }
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "Creating the elementwise chain plans failed: %d\n", result);
+        return result;
+    }
+
+    result = CreateIndirectDispatchContext(device, pCache, &pContext->pIndirectContext);
+    if (result == VK_SUCCESS)
+    {
+        result = CreateIndirectGroupCountPlan(pContext->pIndirectContext, pContext->buffers[INDIRECT_TEST_BUFFER_COUNT], &pContext->argsBuffer,
+            &pContext->pGroupCountPlan);
+    }
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "Creating the group count plan failed: %d\n", result);
+    }
+    return result;
+}
+
+static void DestroyIndirectTestResources(struct IndirectTestContext* pContext)
+{
+    DestroyIndirectGroupCountPlan(pContext->pGroupCountPlan);
+    DestroyIndirectDispatchContext(pContext->pIndirectContext);
+    DestroyElementwiseChainPlan(pContext->pIndirectPlan);
+    DestroyElementwiseChainPlan(pContext->pDirectPlan);
+    DestroyElementwiseContext(pContext->pElementwiseContext);
+    DestroyScanPlan(pContext->pScanPlan);
+    DestroyScanContext(pContext->pScanContext);
+
+    DestroyIndirectArgsBuffer(pContext->device, &pContext->argsBuffer);
+    if (pContext->hostResult != NULL) {
+        vkUnmapMemory(pContext->device, pContext->memories[INDIRECT_TEST_BUFFER_HOST]);
+    }
+    if (pContext->hostCount != NULL) {
+        vkUnmapMemory(pContext->device, pContext->memories[INDIRECT_TEST_BUFFER_COUNT]);
+    }
+    for (int i = 0; i < INDIRECT_TEST_BUFFER_TOTAL; i++) {
+        DestroyBufferWithMemory(pContext->device, pContext->buffers[i], pContext->memories[i]);
+    }
+}
+
+void IndirectDispatchComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, struct PipelineVariantCache* pCache)
+{
+    puts("\n================ Begin indirect dispatch test ================\n");
+
+    struct IndirectTestContext context = { .device = specDevice };
+
+    do
+    {
+        // The compaction comes from the scan module and the chain from the elementwise fusion module
+        static const char* const moduleFileNames[] = {
+            "shaders/indirect_dispatch/indirect_dispatch.spv", "shaders/scan/scan.spv", "shaders/elementwise_fusion/elementwise_fusion.spv"
+        };
+        const char* missingFileName = NULL;
+        for (size_t i = 0; i < sizeof(moduleFileNames) / sizeof(moduleFileNames[0]) && missingFileName == NULL; i++)
+        {
+            if (!IsShaderModuleAvailable(moduleFileNames[i])) {
+                missingFileName = moduleFileNames[i];
+            }
+        }
+        if (missingFileName != NULL)
+        {
+            printf("%s has not been built, so the test will be skipped.\n", missingFileName);
+            break;
+        }
+
+        context.elemCount = INDIRECT_TEST_ELEM_COUNT;
+        if ((uint64_t)context.elemCount * sizeof(uint32_t) > pLimits->maxStorageBufferRange) {
+            context.elemCount = pLimits->maxStorageBufferRange / sizeof(uint32_t);
+        }
+
+        VkResult result = CreateIndirectTestResources(&context, pMemoryProperties, specQueueFamilyIndex, pLimits, pSubgroupProperties, pCache);
+        if (result != VK_SUCCESS) break;
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &context.commandPool, &context.commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &context.queue);
+
+        printf("Elements: %u, compaction keeps the pattern values not less than the threshold, then the chain computes x * 3 + 1\n",
+            context.elemCount);
+
+        // The pattern values are 0 ~ 255
+        static const uint32_t thresholds[] = { 0, 64, 192, 250, 256 };
+        for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]) && result == VK_SUCCESS; t++)
+        {
+            for (int mode = 0; mode < 2 && result == VK_SUCCESS; mode++)
+            {
+                const bool isIndirect = mode != 0;
+                uint64_t totalTime = 0;
+                for (int loop = 0; loop < INDIRECT_TEST_LOOP_COUNT && result == VK_SUCCESS; loop++)
+                {
+                    uint64_t elapsedTime = 0;
+                    result = RunIndirectTestPipeline(&context, isIndirect, thresholds[t], &elapsedTime);
+                    totalTime += elapsedTime;
+                }
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "RunIndirectTestPipeline failed: %d\n", result);
+                    break;
+                }
+
+                const uint32_t count = *context.hostCount;
+                const bool isCorrect = VerifyIndirectTestResult(&context, thresholds[t], count);
+                printf("threshold %3u  %-28s kept: %8u  submissions: %u  %9.2f us  (%s)\n", thresholds[t],
+                    isIndirect ? "indirect, one submission" : "host reads the count", count, isIndirect ? 1U : 2U,
+                    (double)totalTime / 1000.0 / INDIRECT_TEST_LOOP_COUNT, isCorrect ? "verify OK" : "verify FAILED");
+            }
+        }
+    } while (false);
+
+    if (context.commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, context.commandPool, 1, &context.commandBuffer);
+        vkDestroyCommandPool(specDevice, context.commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    DestroyIndirectTestResources(&context);
+
+    puts("\n================ Complete indirect dispatch test ================\n");
+}
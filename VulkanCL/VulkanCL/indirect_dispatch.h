@@ -0,0 +1,65 @@
+#ifndef INDIRECT_DISPATCH_H
+#define INDIRECT_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct PipelineVariantCache;
+
+// Indirect dispatch with workgroup counts computed on the device (shaders/indirect_dispatch/indirect_dispatch.cl).
+// A kernel whose output size depends on the data, such as stream compaction, leaves an element count in a buffer.
+// The group count kernel turns it into the VkDispatchIndirectCommand of the next kernel, which vkCmdDispatchIndirect reads,
+// so a chain of data dependent kernels runs in one submission without the host reading the count in between.
+
+enum
+{
+    // VkDispatchIndirectCommand followed by the element count
+    INDIRECT_ARGS_SLOT_SIZE = 16
+};
+
+// A device local buffer of `slotCount` slots, created with VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT and VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+// as well as the transfer usages, so that a kernel writes the slots and vkCmdDispatchIndirect reads them.
+struct IndirectArgsBuffer
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    uint32_t slotCount;
+};
+
+// The `offset` of vkCmdDispatchIndirect for the slot
+static inline VkDeviceSize GetIndirectArgsOffset(uint32_t slot)
+{
+    return (VkDeviceSize)slot * INDIRECT_ARGS_SLOT_SIZE;
+}
+
+extern VkResult CreateIndirectArgsBuffer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    uint32_t slotCount, struct IndirectArgsBuffer* pArgsBuffer);
+extern void DestroyIndirectArgsBuffer(VkDevice device, struct IndirectArgsBuffer* pArgsBuffer);
+
+struct IndirectDispatchContext;
+struct IndirectGroupCountPlan;
+
+extern VkResult CreateIndirectDispatchContext(VkDevice device, struct PipelineVariantCache* pCache, struct IndirectDispatchContext** ppContext);
+extern void DestroyIndirectDispatchContext(struct IndirectDispatchContext* pContext);
+
+// Reads the element counts from `countBuffer`, a storage buffer of uint32 words, and writes the slots of `pArgsBuffer`.
+extern VkResult CreateIndirectGroupCountPlan(struct IndirectDispatchContext* pContext, VkBuffer countBuffer,
+    const struct IndirectArgsBuffer* pArgsBuffer, struct IndirectGroupCountPlan** ppPlan);
+extern void DestroyIndirectGroupCountPlan(struct IndirectGroupCountPlan* pPlan);
+
+// Writes slot `argsSlot` from word `countIndex` of the count buffer, with `elemsPerGroup` elements per workgroup and at most
+// `maxGroupCount` workgroups. A zero count gives a dispatch of no workgroups.
+// The caller orders the write of the count before it. The recorded barrier makes the slot visible to the indirect command read
+// and to the compute shader reads of the following commands.
+extern void RecordIndirectGroupCount(VkCommandBuffer commandBuffer, const struct IndirectGroupCountPlan* pPlan, uint32_t countIndex,
+    uint32_t argsSlot, uint32_t elemsPerGroup, uint32_t maxGroupCount);
+
+// Compares compaction followed by an elementwise chain, with the host reading the kept count in between,
+// against the same pipeline in one submission with the chain as an indirect dispatch.
+extern void IndirectDispatchComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, struct PipelineVariantCache* pCache);
+
+#endif // !INDIRECT_DISPATCH_H
@@ -0,0 +1,590 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "pipeline_variants.h"
+#include "launch_advisor.h"
+#include "small_transfer.h"
+#include "iterative.h"
+
+enum IterativeBuffer
+{
+    ITERATIVE_BUFFER_COEFFICIENTS,
+    ITERATIVE_BUFFER_SOLUTION_0,
+    ITERATIVE_BUFFER_SOLUTION_1,
+    ITERATIVE_BUFFER_CONTROL,
+    ITERATIVE_BUFFER_COUNT
+};
+
+enum
+{
+    // coefficients, src, dst, control
+    ITERATIVE_ITERATION_BINDING_COUNT = 4,
+    // control
+    ITERATIVE_CHECK_BINDING_COUNT = 1,
+
+    // 64 KB, so that the readbacks take the small transfer path
+    ITERATIVE_TEST_ELEM_COUNT = 16 * 1024,
+    ITERATIVE_TEST_MAX_ITERATION_COUNT = 64
+};
+
+#define ITERATIVE_TEST_TOLERANCE    1e-6f
+#define ITERATIVE_TEST_MAX_ERROR    1e-5f
+
+static const char s_iterationKernelName[] = "NewtonSqrtKernel";
+static const char s_checkKernelName[] = "ConvergenceKernel";
+
+struct IterativeSolver
+{
+    VkDevice device;
+    struct PipelineVariantCache* pCache;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout iterationDescLayout;
+    VkDescriptorSetLayout checkDescLayout;
+    VkPipelineLayout iterationPipelineLayout;
+    VkPipelineLayout checkPipelineLayout;
+    VkPipeline iterationPipeline;
+    VkPipeline checkPipeline;
+    // iterationDescriptorSets[i] reads ITERATIVE_BUFFER_SOLUTION_0 + i and writes the other solution buffer
+    VkDescriptorPool iterationDescriptorPools[2];
+    VkDescriptorSet iterationDescriptorSets[2];
+    VkDescriptorPool checkDescriptorPool;
+    VkDescriptorSet checkDescriptorSet;
+
+    VkBuffer buffers[ITERATIVE_BUFFER_COUNT];
+    VkDeviceMemory memories[ITERATIVE_BUFFER_COUNT];
+
+    uint32_t elemCount;
+    uint32_t workgroupSize;
+    uint32_t groupCount;
+};
+
+// Orders an iteration after the preceding iteration, convergence check or reset, including the read of the indirect group count.
+static void RecordIterationBarrier(VkCommandBuffer commandBuffer)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+VkResult CreateIterativeSolver(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, uint32_t elemCount, struct IterativeSolver** ppSolver)
+{
+    // A workgroup reduces its residual in one local word
+    const struct LaunchKernelResources resources = {
+        .localMemorySize = sizeof(uint32_t),
+        .localMemorySizePerInvocation = 0,
+        .maxWorkgroupSize = 0
+    };
+    struct LaunchConfig launchConfig;
+    if (elemCount == 0 || !AdviseLaunchConfig(pModel, &resources, elemCount, &launchConfig))
+    {
+        fprintf(stderr, "No launch configuration for %s!\n", s_iterationKernelName);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct IterativeSolver* pSolver = calloc(1, sizeof(*pSolver));
+    if (pSolver == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pSolver->device = device;
+    pSolver->pCache = pCache;
+    pSolver->elemCount = elemCount;
+    pSolver->workgroupSize = launchConfig.workgroupSize;
+    pSolver->groupCount = launchConfig.groupCount;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        for (int i = 0; i < ITERATIVE_BUFFER_COUNT && result == VK_SUCCESS; i++)
+        {
+            const bool isControl = i == ITERATIVE_BUFFER_CONTROL;
+            const VkDeviceSize size = isControl ? ITERATIVE_CONTROL_WORD_COUNT * sizeof(uint32_t) : (VkDeviceSize)elemCount * sizeof(float);
+            const VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                (isControl ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0);
+            result = CreateBufferWithMemory(device, pMemoryProperties, size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex,
+                &pSolver->buffers[i], &pSolver->memories[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = CreateShaderModule(device, "shaders/iterative/iterative.spv", &pSolver->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(device, ITERATIVE_ITERATION_BINDING_COUNT, &pSolver->iterationDescLayout);
+        if (result == VK_SUCCESS) {
+            result = CreateStorageBufferDescriptorSetLayout(device, ITERATIVE_CHECK_BINDING_COUNT, &pSolver->checkDescLayout);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        // uint elemCount and float tolerance
+        result = CreateComputePipelineLayout(device, pSolver->iterationDescLayout, sizeof(uint32_t), &pSolver->iterationPipelineLayout);
+        if (result == VK_SUCCESS) {
+            result = CreateComputePipelineLayout(device, pSolver->checkDescLayout, sizeof(float), &pSolver->checkPipelineLayout);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        for (int i = 0; i < 2 && result == VK_SUCCESS; i++)
+        {
+            const VkBuffer buffers[ITERATIVE_ITERATION_BINDING_COUNT] = {
+                pSolver->buffers[ITERATIVE_BUFFER_COEFFICIENTS],
+                pSolver->buffers[ITERATIVE_BUFFER_SOLUTION_0 + i],
+                pSolver->buffers[ITERATIVE_BUFFER_SOLUTION_0 + 1 - i],
+                pSolver->buffers[ITERATIVE_BUFFER_CONTROL]
+            };
+            result = CreateStorageBufferDescriptorSet(device, pSolver->iterationDescLayout, buffers, ITERATIVE_ITERATION_BINDING_COUNT,
+                &pSolver->iterationDescriptorPools[i], &pSolver->iterationDescriptorSets[i]);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateStorageBufferDescriptorSet(device, pSolver->checkDescLayout, &pSolver->buffers[ITERATIVE_BUFFER_CONTROL],
+                ITERATIVE_CHECK_BINDING_COUNT, &pSolver->checkDescriptorPool, &pSolver->checkDescriptorSet);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        const uint32_t iterationSpecConstants[] = { pSolver->workgroupSize, 1U, 1U };
+        const uint32_t checkSpecConstants[] = { 1U, 1U, 1U };
+        result = GetPipelineVariant(pCache, pSolver->shaderModule, s_iterationKernelName, pSolver->iterationPipelineLayout, iterationSpecConstants,
+            (uint32_t)(sizeof(iterationSpecConstants) / sizeof(iterationSpecConstants[0])), &pSolver->iterationPipeline);
+        if (result == VK_SUCCESS)
+        {
+            result = GetPipelineVariant(pCache, pSolver->shaderModule, s_checkKernelName, pSolver->checkPipelineLayout, checkSpecConstants,
+                (uint32_t)(sizeof(checkSpecConstants) / sizeof(checkSpecConstants[0])), &pSolver->checkPipeline);
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "GetPipelineVariant failed: %d\n", result);
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyIterativeSolver(pSolver);
+        pSolver = NULL;
+    }
+    *ppSolver = pSolver;
+    return result;
+}
+
+void DestroyIterativeSolver(struct IterativeSolver* pSolver)
+{
+    if (pSolver == NULL) return;
+
+    VkDevice device = pSolver->device;
+    for (int i = 0; i < 2; i++)
+    {
+        if (pSolver->iterationDescriptorPools[i] != VK_NULL_HANDLE) {
+            vkDestroyDescriptorPool(device, pSolver->iterationDescriptorPools[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+        }
+    }
+    if (pSolver->checkDescriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, pSolver->checkDescriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    // The pipelines belong to the pipeline variant cache
+    if (pSolver->shaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(pSolver->pCache, pSolver->shaderModule);
+        vkDestroyShaderModule(device, pSolver->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+    if (pSolver->iterationPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pSolver->iterationPipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pSolver->checkPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pSolver->checkPipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pSolver->iterationDescLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pSolver->iterationDescLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (pSolver->checkDescLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pSolver->checkDescLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    for (int i = 0; i < ITERATIVE_BUFFER_COUNT; i++) {
+        DestroyBufferWithMemory(device, pSolver->buffers[i], pSolver->memories[i]);
+    }
+
+    free(pSolver);
+}
+
+VkBuffer GetIterativeCoefficientBuffer(const struct IterativeSolver* pSolver)
+{
+    return pSolver->buffers[ITERATIVE_BUFFER_COEFFICIENTS];
+}
+
+VkBuffer GetIterativeControlBuffer(const struct IterativeSolver* pSolver)
+{
+    return pSolver->buffers[ITERATIVE_BUFFER_CONTROL];
+}
+
+VkBuffer GetIterativeSolutionBuffer(const struct IterativeSolver* pSolver, uint32_t iterationCount)
+{
+    return pSolver->buffers[ITERATIVE_BUFFER_SOLUTION_0 + (iterationCount & 1U)];
+}
+
+void RecordIterativeReset(struct IterativeSolver* pSolver, VkCommandBuffer commandBuffer)
+{
+    // The transfers overwrite what the previous solve and the writes of the coefficients may still access
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+
+    const uint32_t controlWords[ITERATIVE_CONTROL_WORD_COUNT] = {
+        [ITERATIVE_CONTROL_DISPATCH_X] = pSolver->groupCount,
+        [ITERATIVE_CONTROL_DISPATCH_Y] = 1U,
+        [ITERATIVE_CONTROL_DISPATCH_Z] = 1U
+    };
+    RecordSmallBufferUpload(commandBuffer, pSolver->buffers[ITERATIVE_BUFFER_CONTROL], 0, controlWords, sizeof(controlWords));
+
+    const VkBufferCopy copyRegion = {
+        .srcOffset = 0,
+        .dstOffset = 0,
+        .size = (VkDeviceSize)pSolver->elemCount * sizeof(float)
+    };
+    vkCmdCopyBuffer(commandBuffer, pSolver->buffers[ITERATIVE_BUFFER_COEFFICIENTS], pSolver->buffers[ITERATIVE_BUFFER_SOLUTION_0], 1, &copyRegion);
+}
+
+void RecordIterations(struct IterativeSolver* pSolver, VkCommandBuffer commandBuffer, uint32_t firstIteration, uint32_t iterationCount,
+    uint32_t checkInterval, float tolerance)
+{
+    const bool isIndirect = checkInterval > 0;
+    // vkCmdBindPipeline of the convergence check disturbs the push constants of the iterations, whose pipeline layout is different
+    bool isIterationPipelineBound = false;
+
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        const uint32_t iteration = firstIteration + i;
+
+        RecordIterationBarrier(commandBuffer);
+
+        if (!isIterationPipelineBound)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pSolver->iterationPipeline);
+            vkCmdPushConstants(commandBuffer, pSolver->iterationPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pSolver->elemCount),
+                &pSolver->elemCount);
+            isIterationPipelineBound = true;
+        }
+        // Ping-pong
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pSolver->iterationPipelineLayout, 0, 1,
+            &pSolver->iterationDescriptorSets[iteration & 1U], 0, NULL);
+
+        if (isIndirect) {
+            vkCmdDispatchIndirect(commandBuffer, pSolver->buffers[ITERATIVE_BUFFER_CONTROL], ITERATIVE_CONTROL_DISPATCH_X * sizeof(uint32_t));
+        }
+        else {
+            vkCmdDispatch(commandBuffer, pSolver->groupCount, 1, 1);
+        }
+
+        if (isIndirect && (i + 1) % checkInterval == 0)
+        {
+            RecordComputeToComputeBarrier(commandBuffer);
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pSolver->checkPipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pSolver->checkPipelineLayout, 0, 1,
+                &pSolver->checkDescriptorSet, 0, NULL);
+            vkCmdPushConstants(commandBuffer, pSolver->checkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(tolerance), &tolerance);
+            vkCmdDispatch(commandBuffer, 1, 1, 1);
+            isIterationPipelineBound = false;
+        }
+    }
+}
+
+// MARK: Test
+
+struct IterativeTestContext
+{
+    VkDevice device;
+    VkQueue queue;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    struct IterativeSolver* pSolver;
+    struct ResultSlab* pSlab;
+    // The control words and the two solution buffers
+    struct ResultSlabRange ranges[3];
+};
+
+static float FindMaxRelativeError(const float* solution, const float* coefficients, uint32_t elemCount)
+{
+    float maxError = 0.0f;
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        const float root = sqrtf(coefficients[i]);
+        const float error = fabsf(solution[i] - root) / root;
+        // NaN counts as the largest error
+        if (!(error <= maxError)) {
+            maxError = error;
+        }
+    }
+    return maxError;
+}
+
+// Runs the iterations of NewtonSqrtKernel and the convergence checks of RecordIterations on the host, with the same float expressions.
+// Returns the number of iterations the device is expected to run, and `solution` receives the result of them.
+static uint32_t RunIterativeReference(const float* coefficients, float* solution, float* scratch, uint32_t elemCount, uint32_t checkInterval)
+{
+    memcpy(solution, coefficients, elemCount * sizeof(float));
+
+    float residual = 0.0f;
+    uint32_t iteration = 0;
+    while (iteration < ITERATIVE_TEST_MAX_ITERATION_COUNT)
+    {
+        for (uint32_t i = 0; i < elemCount; i++)
+        {
+            const float x = solution[i];
+            const float y = 0.5f * (x + coefficients[i] / x);
+            scratch[i] = y;
+            const float change = fabsf(y - x) / y;
+            if (change > residual) {
+                residual = change;
+            }
+        }
+        memcpy(solution, scratch, elemCount * sizeof(float));
+        iteration++;
+
+        if (checkInterval > 0 && iteration % checkInterval == 0)
+        {
+            if (residual <= ITERATIVE_TEST_TOLERANCE) break;
+            residual = 0.0f;
+        }
+    }
+    return iteration;
+}
+
+static float FindMaxReferenceDifference(const float* solution, const float* reference, uint32_t elemCount)
+{
+    float maxDifference = 0.0f;
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        const float difference = fabsf(solution[i] - reference[i]) / reference[i];
+        // NaN counts as the largest difference
+        if (!(difference <= maxDifference)) {
+            maxDifference = difference;
+        }
+    }
+    return maxDifference;
+}
+
+// @param checkInterval: 0 for no convergence check
+// @param hostChecks: submits every iteration on its own, and reads the control words back to stop once it has converged
+static VkResult RunIterativeSolve(struct IterativeTestContext* pContext, bool hostChecks, uint32_t checkInterval,
+    uint64_t* pElapsedTime, uint32_t* pSubmissionCount)
+{
+    const volatile uint32_t* controlWords = pContext->ranges[0].pHostData;
+
+    VkResult result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, pContext->commandBuffer);
+    if (result != VK_SUCCESS) return result;
+    RecordIterativeReset(pContext->pSolver, pContext->commandBuffer);
+    result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, pContext->commandBuffer);
+    if (result != VK_SUCCESS) return result;
+
+    *pSubmissionCount = 0;
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    if (hostChecks)
+    {
+        for (uint32_t iteration = 0; iteration < ITERATIVE_TEST_MAX_ITERATION_COUNT; iteration++)
+        {
+            result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, pContext->commandBuffer);
+            if (result != VK_SUCCESS) break;
+            RecordIterations(pContext->pSolver, pContext->commandBuffer, iteration, 1, 1, ITERATIVE_TEST_TOLERANCE);
+            RecordResultSlabReadback(pContext->commandBuffer, pContext->pSlab, &pContext->ranges[0],
+                GetIterativeControlBuffer(pContext->pSolver), 0);
+            result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, pContext->commandBuffer);
+            if (result != VK_SUCCESS) break;
+
+            ++*pSubmissionCount;
+            if (controlWords[ITERATIVE_CONTROL_DISPATCH_X] == 0) break;
+        }
+    }
+    else
+    {
+        result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, pContext->commandBuffer);
+        if (result == VK_SUCCESS)
+        {
+            RecordIterations(pContext->pSolver, pContext->commandBuffer, 0, ITERATIVE_TEST_MAX_ITERATION_COUNT, checkInterval, ITERATIVE_TEST_TOLERANCE);
+            result = EndAndSubmitCommandBuffer(pContext->device, pContext->queue, pContext->commandBuffer);
+            *pSubmissionCount = 1;
+        }
+    }
+    *pElapsedTime = HostGetTimeNanoseconds() - beginTime;
+    if (result != VK_SUCCESS) return result;
+
+    // Both solution buffers are read back, since which one holds the solution depends on the iterations that have run
+    result = BeginOneTimeCommandBuffer(pContext->device, pContext->commandPool, pContext->commandBuffer);
+    if (result != VK_SUCCESS) return result;
+    RecordResultSlabReadback(pContext->commandBuffer, pContext->pSlab, &pContext->ranges[0], GetIterativeControlBuffer(pContext->pSolver), 0);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        RecordResultSlabReadback(pContext->commandBuffer, pContext->pSlab, &pContext->ranges[1 + i],
+            GetIterativeSolutionBuffer(pContext->pSolver, i), 0);
+    }
+    return EndAndSubmitCommandBuffer(pContext->device, pContext->queue, pContext->commandBuffer);
+}
+
+void IterativeComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, struct ResultSlab* pSlab)
+{
+    puts("\n================ Begin iterative execution test ================\n");
+
+    struct IterativeTestContext context = { .device = specDevice, .pSlab = pSlab };
+    float* coefficients = NULL;
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/iterative/iterative.spv"))
+        {
+            puts("shaders/iterative/iterative.spv has not been built by shaders/iterative/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        if (pSlab == NULL)
+        {
+            fprintf(stderr, "No result slab!\n");
+            break;
+        }
+
+        const uint32_t elemCount = ITERATIVE_TEST_ELEM_COUNT;
+        const VkDeviceSize bufferSize = elemCount * sizeof(float);
+
+        VkResult result = CreateIterativeSolver(specDevice, pMemoryProperties, specQueueFamilyIndex, pModel, pCache, elemCount, &context.pSolver);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateIterativeSolver failed: %d\n", result);
+            break;
+        }
+
+        result = AcquireResultSlabRange(pSlab, ITERATIVE_CONTROL_WORD_COUNT * sizeof(uint32_t), &context.ranges[0]);
+        for (int i = 1; i < 3 && result == VK_SUCCESS; i++) {
+            result = AcquireResultSlabRange(pSlab, bufferSize, &context.ranges[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AcquireResultSlabRange failed: %d\n", result);
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &context.commandPool, &context.commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &context.queue);
+
+        // The coefficients, followed by the host reference solution and its scratch buffer
+        coefficients = malloc(bufferSize * 3);
+        if (coefficients == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+        float* const reference = coefficients + elemCount;
+        // From 1 up to about 10^6, about 15 Newton steps from the coefficients themselves
+        for (uint32_t i = 0; i < elemCount; i++) {
+            coefficients[i] = 1.0f + 61.0f * (float)i;
+        }
+
+        result = BeginOneTimeCommandBuffer(specDevice, context.commandPool, context.commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordSmallBufferUpload(context.commandBuffer, GetIterativeCoefficientBuffer(context.pSolver), 0, coefficients, bufferSize);
+        result = EndAndSubmitCommandBuffer(specDevice, context.queue, context.commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        printf("Elements: %u, workgroup size: %u, at most %d iterations, tolerance: %g\n", elemCount, context.pSolver->workgroupSize,
+            ITERATIVE_TEST_MAX_ITERATION_COUNT, ITERATIVE_TEST_TOLERANCE);
+
+        static const struct
+        {
+            const char* title;
+            bool hostChecks;
+            uint32_t checkInterval;
+        } modes[] = {
+            { "Host check, per iteration", true, 1 },
+            { "No convergence check", false, 0 },
+            { "Device check every 1", false, 1 },
+            { "Device check every 4", false, 4 },
+            { "Device check every 16", false, 16 }
+        };
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+        {
+            uint64_t elapsedTime = 0;
+            uint32_t submissionCount = 0;
+            result = RunIterativeSolve(&context, modes[m].hostChecks, modes[m].checkInterval, &elapsedTime, &submissionCount);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "%s failed: %d\n", modes[m].title, result);
+                break;
+            }
+
+            const uint32_t iterationCount = ((const uint32_t*)context.ranges[0].pHostData)[ITERATIVE_CONTROL_ITERATIONS];
+            const float maxError = FindMaxRelativeError(context.ranges[1 + (iterationCount & 1U)].pHostData, coefficients, elemCount);
+            printf("%-26s iterations: %2u, submissions: %2u, time: %9.2f us, max relative error: %g\n", modes[m].title, iterationCount,
+                submissionCount, (double)elapsedTime / 1000.0, maxError);
+            if (!(maxError <= ITERATIVE_TEST_MAX_ERROR)) {
+                fprintf(stderr, "%s has not converged!\n", modes[m].title);
+            }
+
+            // The device may round the division differently, which can move the residual of the last check across the tolerance,
+            // so the iteration count may differ from the reference by one check interval
+            const uint32_t expectedCount = RunIterativeReference(coefficients, reference, reference + elemCount, elemCount, modes[m].checkInterval);
+            const uint32_t allowedDifference = modes[m].checkInterval;
+            const float referenceDifference = FindMaxReferenceDifference(context.ranges[1 + (iterationCount & 1U)].pHostData, reference, elemCount);
+            if (iterationCount + allowedDifference < expectedCount || iterationCount > expectedCount + allowedDifference)
+            {
+                fprintf(stderr, "%s ran %u iterations, but the host reference converges after %u!\n", modes[m].title, iterationCount,
+                    expectedCount);
+            }
+            if (!(referenceDifference <= ITERATIVE_TEST_MAX_ERROR)) {
+                fprintf(stderr, "%s differs from the host reference by %g!\n", modes[m].title, referenceDifference);
+            }
+        }
+    } while (false);
+
+    free(coefficients);
+    if (context.commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, context.commandPool, 1, &context.commandBuffer);
+        vkDestroyCommandPool(specDevice, context.commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    if (pSlab != NULL)
+    {
+        for (int i = 0; i < 3; i++) {
+            ReleaseResultSlabRange(pSlab, &context.ranges[i]);
+        }
+    }
+    DestroyIterativeSolver(context.pSolver);
+
+    puts("\n================ Complete iterative execution test ================\n");
+}
@@ -0,0 +1,62 @@
+#ifndef ITERATIVE_H
+#define ITERATIVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct LaunchDeviceModel;
+struct PipelineVariantCache;
+struct ResultSlab;
+
+// Iterative kernel execution (shaders/iterative/iterative.cl), with the Newton iteration of square roots as the kernel.
+// The iterations of a solve are recorded into one command buffer, alternating two descriptor sets that swap the source and the destination
+// buffers, with a single barrier between two iterations and no readback in between.
+// With convergence checks, the iterations are indirect dispatches, and a check that finds the residual below the tolerance
+// zeroes their group count on the device, so the remaining iterations of the submission end early without a round trip to the host.
+
+// The 32-bit words of the control buffer, identical to ITERATIVE_CONTROL_* in iterative.cl
+enum IterativeControl
+{
+    ITERATIVE_CONTROL_RESIDUAL,
+    ITERATIVE_CONTROL_ITERATIONS,
+    // VkDispatchIndirectCommand of the iterations
+    ITERATIVE_CONTROL_DISPATCH_X = 4,
+    ITERATIVE_CONTROL_DISPATCH_Y,
+    ITERATIVE_CONTROL_DISPATCH_Z,
+    ITERATIVE_CONTROL_WORD_COUNT = 8
+};
+
+struct IterativeSolver;
+
+extern VkResult CreateIterativeSolver(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, uint32_t elemCount, struct IterativeSolver** ppSolver);
+extern void DestroyIterativeSolver(struct IterativeSolver* pSolver);
+
+// The device local buffers, all of them created with VK_BUFFER_USAGE_TRANSFER_SRC_BIT and VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+// The coefficients are `elemCount` positive floats, written by the caller.
+extern VkBuffer GetIterativeCoefficientBuffer(const struct IterativeSolver* pSolver);
+extern VkBuffer GetIterativeControlBuffer(const struct IterativeSolver* pSolver);
+// The buffer that holds the solution after `iterationCount` iterations from RecordIterativeReset
+extern VkBuffer GetIterativeSolutionBuffer(const struct IterativeSolver* pSolver, uint32_t iterationCount);
+
+// Starts a solve with the coefficients as the initial guess, and clears the control words.
+// The writes of the coefficients must be available to the transfer stage.
+extern void RecordIterativeReset(struct IterativeSolver* pSolver, VkCommandBuffer commandBuffer);
+
+// Records iterations [firstIteration, firstIteration + iterationCount) of the solve.
+// With `checkInterval` 0, they are plain dispatches that always run. Otherwise they are indirect dispatches, and the convergence check runs
+// after every `checkInterval` iterations, stopping the remaining iterations, of this call and of the later ones, once the largest relative change
+// since the previous check is not greater than `tolerance`.
+// The control word ITERATIVE_CONTROL_ITERATIONS counts the iterations that have actually run.
+extern void RecordIterations(struct IterativeSolver* pSolver, VkCommandBuffer commandBuffer, uint32_t firstIteration, uint32_t iterationCount,
+    uint32_t checkInterval, float tolerance);
+
+// Compares a submission and a host side convergence check per iteration against the iterations of one submission,
+// without convergence checks and with them at several intervals.
+extern void IterativeComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, struct ResultSlab* pSlab);
+
+#endif // !ITERATIVE_H
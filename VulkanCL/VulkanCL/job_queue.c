@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "host_parallel.h"
+#include "job_queue.h"
+
+enum
+{
+    // The pops the consumer retries before it parks, which cover a push caught between its two steps
+    JOB_QUEUE_SPIN_COUNT = 64
+};
+
+struct JobQueue
+{
+    // The last pushed node. The producers contend on it alone.
+    struct JobQueueNode* volatile pHead;
+    // Apart from the producers, on its own cache line
+    uint8_t padding[64 - sizeof(struct JobQueueNode*)];
+    // The next node to pop, only accessed by the consumer
+    struct JobQueueNode* pTail;
+    struct JobQueueNode stub;
+
+    // Whether the consumer is parked or about to park
+    volatile uint32_t sleeping;
+    // With the condition variable the consumer parks on
+    struct HostLock* pLock;
+    // Protected by `pLock`
+    bool signaled;
+    uint64_t parkCount;
+    uint64_t wakeCount;
+};
+
+struct JobQueue* CreateJobQueue(void)
+{
+    struct JobQueue* pQueue = calloc(1, sizeof(*pQueue));
+    if (pQueue == NULL) {
+        return NULL;
+    }
+
+    pQueue->pLock = HostLockCreate();
+    if (pQueue->pLock == NULL)
+    {
+        free(pQueue);
+        return NULL;
+    }
+    pQueue->stub.pNext = NULL;
+    pQueue->pHead = &pQueue->stub;
+    pQueue->pTail = &pQueue->stub;
+    return pQueue;
+}
+
+void DestroyJobQueue(struct JobQueue* pQueue)
+{
+    if (pQueue == NULL) {
+        return;
+    }
+
+    HostLockDestroy(pQueue->pLock);
+    free(pQueue);
+}
+
+static void LinkJobQueueNode(struct JobQueue* pQueue, struct JobQueueNode* pNode)
+{
+    pNode->pNext = NULL;
+    struct JobQueueNode* const pPrev = HostAtomicExchangePointer((void* volatile*)&pQueue->pHead, pNode);
+    // Between the exchange and this store, the consumer cannot see `pNode` nor any node pushed after it
+    HostAtomicStorePointer((void* volatile*)&pPrev->pNext, pNode);
+}
+
+void PushJobQueueNode(struct JobQueue* pQueue, struct JobQueueNode* pNode)
+{
+    LinkJobQueueNode(pQueue, pNode);
+
+    // Pairs with the fence of the consumer between announcing its sleep and checking the queue the last time:
+    // either the consumer sees the node, or this push sees it sleeping
+    HostAtomicThreadFence();
+    if (HostAtomicLoadUInt32(&pQueue->sleeping) != 0)
+    {
+        HostLockAcquire(pQueue->pLock);
+        pQueue->signaled = true;
+        pQueue->wakeCount++;
+        HostLockWakeOne(pQueue->pLock);
+        HostLockRelease(pQueue->pLock);
+    }
+}
+
+struct JobQueueNode* PopJobQueueNode(struct JobQueue* pQueue)
+{
+    struct JobQueueNode* pTail = pQueue->pTail;
+    struct JobQueueNode* pNext = HostAtomicLoadPointer((void* volatile*)&pTail->pNext);
+    if (pTail == &pQueue->stub)
+    {
+        if (pNext == NULL) {
+            return NULL;
+        }
+        pQueue->pTail = pNext;
+        pTail = pNext;
+        pNext = HostAtomicLoadPointer((void* volatile*)&pNext->pNext);
+    }
+    if (pNext != NULL)
+    {
+        pQueue->pTail = pNext;
+        return pTail;
+    }
+
+    // `pTail` is the last node, unless a push is in progress
+    if (pTail != HostAtomicLoadPointer((void* volatile*)&pQueue->pHead)) {
+        return NULL;
+    }
+    // The stub goes behind the last node, so that it can be popped without leaving the queue without a node
+    LinkJobQueueNode(pQueue, &pQueue->stub);
+    pNext = HostAtomicLoadPointer((void* volatile*)&pTail->pNext);
+    if (pNext != NULL)
+    {
+        pQueue->pTail = pNext;
+        return pTail;
+    }
+    return NULL;
+}
+
+struct JobQueueNode* WaitJobQueueNode(struct JobQueue* pQueue, uint64_t timeoutNanoseconds)
+{
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    while (true)
+    {
+        for (uint32_t i = 0; i < JOB_QUEUE_SPIN_COUNT; i++)
+        {
+            struct JobQueueNode* const pNode = PopJobQueueNode(pQueue);
+            if (pNode != NULL) {
+                return pNode;
+            }
+            HostYield();
+        }
+
+        // A push that has seen the consumer announcing its sleep signals even if the consumer then pops its node without parking.
+        // Such a stale signal would end the next park at once, so it is dropped before announcing the sleep again.
+        HostLockAcquire(pQueue->pLock);
+        pQueue->signaled = false;
+        HostLockRelease(pQueue->pLock);
+
+        HostAtomicExchangeUInt32(&pQueue->sleeping, 1);
+        HostAtomicThreadFence();
+        struct JobQueueNode* pNode = PopJobQueueNode(pQueue);
+        if (pNode == NULL)
+        {
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            HostLockAcquire(pQueue->pLock);
+            if (!pQueue->signaled && elapsedTime < timeoutNanoseconds)
+            {
+                pQueue->parkCount++;
+                HostLockWait(pQueue->pLock, timeoutNanoseconds == UINT64_MAX ? UINT64_MAX : timeoutNanoseconds - elapsedTime);
+            }
+            pQueue->signaled = false;
+            HostLockRelease(pQueue->pLock);
+        }
+        HostAtomicExchangeUInt32(&pQueue->sleeping, 0);
+
+        // A push signals after linking its node, so the node is visible once the wake-up has been consumed,
+        // unless an earlier push is still between its two steps. Then, as after a spurious wake-up, the consumer waits again.
+        if (pNode == NULL) {
+            pNode = PopJobQueueNode(pQueue);
+        }
+        if (pNode != NULL || HostGetTimeNanoseconds() - beginTime >= timeoutNanoseconds) {
+            return pNode;
+        }
+    }
+}
+
+uint64_t GetJobQueueParkCount(const struct JobQueue* pQueue)
+{
+    return pQueue->parkCount;
+}
+
+uint64_t GetJobQueueWakeCount(const struct JobQueue* pQueue)
+{
+    return pQueue->wakeCount;
+}
@@ -0,0 +1,42 @@
+#ifndef JOB_QUEUE_H
+#define JOB_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// A multiple-producer single-consumer queue of intrusive nodes (Dmitry Vyukov's intrusive MPSC queue, with a stub node of its own
+// that is pushed again whenever the consumer would otherwise pop the last node).
+// A push is one atomic exchange and one release store, so the producers never wait for one another nor for the consumer.
+// A pop is free of atomic read-modify-writes. While a push is between its two steps, the nodes behind it are not visible yet,
+// and PopJobQueueNode returns NULL even though the queue is not empty.
+//
+// The consumer may block in WaitJobQueueNode when the queue is empty. It parks on a condition variable only after announcing it,
+// so a push takes the lock only when the consumer is actually asleep.
+
+struct JobQueueNode
+{
+    struct JobQueueNode* volatile pNext;
+};
+
+struct JobQueue;
+
+// Returns NULL if it is out of memory.
+extern struct JobQueue* CreateJobQueue(void);
+// The queue must be empty, or its nodes be freed by the caller.
+extern void DestroyJobQueue(struct JobQueue* pQueue);
+
+// Any thread
+extern void PushJobQueueNode(struct JobQueue* pQueue, struct JobQueueNode* pNode);
+
+// The consumer thread only. Returns NULL if no node is visible.
+extern struct JobQueueNode* PopJobQueueNode(struct JobQueue* pQueue);
+// The consumer thread only. Returns NULL only once `timeoutNanoseconds` has passed without a node becoming visible,
+// UINT64_MAX waiting forever.
+extern struct JobQueueNode* WaitJobQueueNode(struct JobQueue* pQueue, uint64_t timeoutNanoseconds);
+
+// The number of times the consumer has parked, and the number of pushes that woke it up
+extern uint64_t GetJobQueueParkCount(const struct JobQueue* pQueue);
+extern uint64_t GetJobQueueWakeCount(const struct JobQueue* pQueue);
+
+#endif // !JOB_QUEUE_H
@@ -0,0 +1,377 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "pipeline_variants.h"
+#include "clspv_reflection.h"
+#include "launch_advisor.h"
+
+enum
+{
+    // The assumptions for the devices that report nothing about their compute units:
+    // a compute unit holds twice the invocations of the largest workgroup, up to 16 workgroups,
+    // and as much local memory as a single workgroup may use.
+    LAUNCH_ADVISOR_ASSUMED_INVOCATION_FACTOR = 2,
+    LAUNCH_ADVISOR_ASSUMED_MAX_WORKGROUPS = 16,
+
+    LAUNCH_ADVISOR_TEST_ELEM_COUNT = 1024 * 1024,
+    LAUNCH_ADVISOR_TEST_LOOP_COUNT = 16
+};
+
+void InitializeLaunchDeviceModel(const VkPhysicalDeviceLimits* pLimits, uint32_t subgroupSize, uint32_t maxComputeWorkgroupSubgroups,
+    struct LaunchDeviceModel* pModel)
+{
+    uint32_t maxWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    // maxComputeWorkgroupSubgroups is 0 without VK_EXT_subgroup_size_control
+    if (maxComputeWorkgroupSubgroups > 0 && subgroupSize > 0 && maxWorkgroupSize / subgroupSize > maxComputeWorkgroupSubgroups) {
+        maxWorkgroupSize = maxComputeWorkgroupSubgroups * subgroupSize;
+    }
+
+    *pModel = (struct LaunchDeviceModel){
+        .subgroupSize = subgroupSize > 0 ? subgroupSize : 1U,
+        .maxWorkgroupSize = maxWorkgroupSize,
+        .maxWorkgroupLocalMemorySize = pLimits->maxComputeSharedMemorySize,
+        .maxWorkgroupCount = pLimits->maxComputeWorkGroupCount[0],
+        .computeUnitCount = 0,
+        .computeUnitMaxInvocations = pLimits->maxComputeWorkGroupInvocations * LAUNCH_ADVISOR_ASSUMED_INVOCATION_FACTOR,
+        .computeUnitLocalMemorySize = pLimits->maxComputeSharedMemorySize,
+        .computeUnitMaxWorkgroups = LAUNCH_ADVISOR_ASSUMED_MAX_WORKGROUPS
+    };
+}
+
+bool EvaluateLaunchConfig(const struct LaunchDeviceModel* pModel, const struct LaunchKernelResources* pResources, uint32_t workgroupSize,
+    uint32_t elemCount, struct LaunchConfig* pConfig)
+{
+    if (workgroupSize == 0 || workgroupSize > pModel->maxWorkgroupSize ||
+        (pResources->maxWorkgroupSize != 0 && workgroupSize > pResources->maxWorkgroupSize)) {
+        return false;
+    }
+
+    const uint64_t localMemorySize = pResources->localMemorySize + (uint64_t)pResources->localMemorySizePerInvocation * workgroupSize;
+    if (localMemorySize > pModel->maxWorkgroupLocalMemorySize) {
+        return false;
+    }
+
+    const uint64_t groupCount = ((uint64_t)elemCount + workgroupSize - 1) / workgroupSize;
+    if (groupCount > pModel->maxWorkgroupCount) {
+        return false;
+    }
+
+    uint32_t residentWorkgroups = pModel->computeUnitMaxInvocations / workgroupSize;
+    enum LaunchLimiter limiter = LAUNCH_LIMITER_INVOCATIONS;
+    if (pModel->computeUnitMaxWorkgroups < residentWorkgroups)
+    {
+        residentWorkgroups = pModel->computeUnitMaxWorkgroups;
+        limiter = LAUNCH_LIMITER_WORKGROUP_SLOTS;
+    }
+    if (localMemorySize > 0 && pModel->computeUnitLocalMemorySize / localMemorySize < residentWorkgroups)
+    {
+        residentWorkgroups = (uint32_t)(pModel->computeUnitLocalMemorySize / localMemorySize);
+        limiter = LAUNCH_LIMITER_LOCAL_MEMORY;
+    }
+    if (residentWorkgroups == 0) {
+        return false;
+    }
+
+    const uint32_t residentGroupCount = residentWorkgroups * pModel->computeUnitCount;
+    *pConfig = (struct LaunchConfig){
+        .workgroupSize = workgroupSize,
+        .groupCount = (uint32_t)groupCount,
+        .localMemorySize = (uint32_t)localMemorySize,
+        .residentWorkgroupsPerComputeUnit = residentWorkgroups,
+        .limiter = limiter,
+        .occupancy = (float)(residentWorkgroups * workgroupSize) / (float)pModel->computeUnitMaxInvocations,
+        .residentGroupCount = residentGroupCount,
+        .waveCount = residentGroupCount > 0 ? (uint32_t)((groupCount + residentGroupCount - 1) / residentGroupCount) : 0
+    };
+    return true;
+}
+
+static bool IsBetterLaunchConfig(const struct LaunchConfig* pConfig, const struct LaunchConfig* pBest)
+{
+    // Compare the resident invocations instead of the float occupancy
+    const uint32_t residentInvocations = pConfig->residentWorkgroupsPerComputeUnit * pConfig->workgroupSize;
+    const uint32_t bestResidentInvocations = pBest->residentWorkgroupsPerComputeUnit * pBest->workgroupSize;
+    if (residentInvocations != bestResidentInvocations) {
+        return residentInvocations > bestResidentInvocations;
+    }
+
+    // groupCount / (waveCount * residentGroupCount) is how full the waves are on average
+    if (pConfig->waveCount > 0 && pBest->waveCount > 0)
+    {
+        const uint64_t fill = (uint64_t)pConfig->groupCount * pBest->waveCount * pBest->residentGroupCount;
+        const uint64_t bestFill = (uint64_t)pBest->groupCount * pConfig->waveCount * pConfig->residentGroupCount;
+        if (fill != bestFill) {
+            return fill > bestFill;
+        }
+    }
+
+    return pConfig->workgroupSize > pBest->workgroupSize;
+}
+
+bool AdviseLaunchConfig(const struct LaunchDeviceModel* pModel, const struct LaunchKernelResources* pResources, uint32_t elemCount,
+    struct LaunchConfig* pConfig)
+{
+    bool found = false;
+    for (uint32_t workgroupSize = pModel->subgroupSize; workgroupSize <= pModel->maxWorkgroupSize; workgroupSize *= 2U)
+    {
+        struct LaunchConfig config;
+        if (!EvaluateLaunchConfig(pModel, pResources, workgroupSize, elemCount, &config)) continue;
+
+        if (!found || IsBetterLaunchConfig(&config, pConfig))
+        {
+            *pConfig = config;
+            found = true;
+        }
+    }
+    return found;
+}
+
+const char* GetLaunchLimiterName(enum LaunchLimiter limiter)
+{
+    switch (limiter)
+    {
+    case LAUNCH_LIMITER_INVOCATIONS:
+        return "invocations";
+    case LAUNCH_LIMITER_WORKGROUP_SLOTS:
+        return "workgroup slots";
+    case LAUNCH_LIMITER_LOCAL_MEMORY:
+        return "local memory";
+    default:
+        return "unknown";
+    }
+}
+
+static const struct AdvisedKernel
+{
+    const char* fileName;
+    const char* kernelName;
+    uint32_t localMemorySizePerInvocation;
+    uint32_t maxWorkgroupSize;
+    // Whether the test times the kernel. Both of clspv_spec take (global pDst, global pSrc, uint elemCount).
+    bool timed;
+} s_advisedKernels[] = {
+    // intBuffer[get_local_id(0)] of 1024 elements
+    { "shaders/clspv_spec/clspv_spec.spv", "IncKernel", 0, 1024, true },
+    { "shaders/clspv_spec/clspv_spec.spv", "DoubleKernel", 0, 0, true },
+    // One `sharedBuffer` element per invocation
+    { "shaders/advance/advance.spv", "AdvanceKernel", sizeof(int), 0, false }
+};
+
+static void PrintLaunchConfig(const struct LaunchConfig* pConfig, bool advised, double milliseconds)
+{
+    printf("%c %4u  %7u  %6u B  %3u  %-15s  %5.1f%%", advised ? '*' : ' ', pConfig->workgroupSize, pConfig->groupCount, pConfig->localMemorySize,
+        pConfig->residentWorkgroupsPerComputeUnit, GetLaunchLimiterName(pConfig->limiter), (double)pConfig->occupancy * 100.0);
+    if (pConfig->waveCount > 0) {
+        printf("  %5u", pConfig->waveCount);
+    }
+    else {
+        printf("      -");
+    }
+    if (milliseconds >= 0.0) {
+        printf("  %9.3f ms", milliseconds);
+    }
+    puts("");
+}
+
+// Dispatches the kernel LAUNCH_ADVISOR_TEST_LOOP_COUNT times in one command buffer, and returns the average time in milliseconds, or -1.0.
+static double TimeDispatches(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkPipeline pipeline,
+    VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, uint32_t elemCount, uint32_t groupCount)
+{
+    double milliseconds = -1.0;
+    // The first round warms up
+    for (int round = 0; round < 2; round++)
+    {
+        VkResult result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+        vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(elemCount), &elemCount);
+        for (int i = 0; i < LAUNCH_ADVISOR_TEST_LOOP_COUNT; i++)
+        {
+            vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+            RecordComputeToComputeBarrier(commandBuffer);
+        }
+
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS) break;
+
+        milliseconds = (double)elapsedTime / 1000000.0 / LAUNCH_ADVISOR_TEST_LOOP_COUNT;
+    }
+    return milliseconds;
+}
+
+void LaunchAdvisorTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache)
+{
+    puts("\n================ Begin launch advisor test ================\n");
+
+    printf("Subgroup size: %u, max workgroup size: %u, max local memory per workgroup: %u bytes\n", pModel->subgroupSize,
+        pModel->maxWorkgroupSize, pModel->maxWorkgroupLocalMemorySize);
+    if (pModel->computeUnitCount > 0) {
+        printf("Compute units: %u, ", pModel->computeUnitCount);
+    }
+    else {
+        printf("Compute units: unknown, ");
+    }
+    printf("per compute unit: %u invocations, %u workgroups, %u bytes of local memory\n", pModel->computeUnitMaxInvocations,
+        pModel->computeUnitMaxWorkgroups, pModel->computeUnitLocalMemorySize);
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+    VkBuffer srcBuffer = VK_NULL_HANDLE, dstBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory srcMemory = VK_NULL_HANDLE, dstMemory = VK_NULL_HANDLE;
+
+    do
+    {
+        const uint32_t elemCount = LAUNCH_ADVISOR_TEST_ELEM_COUNT;
+        const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+
+        VkResult result = CreateShaderModule(specDevice, "shaders/clspv_spec/clspv_spec.spv", &shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+        result = CreateStorageBufferDescriptorSetLayout(specDevice, 2, &descLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+        result = CreateComputePipelineLayout(specDevice, descLayout, sizeof(uint32_t), &pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        // The results are not read back. CLSPVSpecComputeTest and PipelineVariantCacheTest verify these kernels.
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &srcBuffer, &srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &dstBuffer, &dstMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        const VkBuffer buffers[] = { dstBuffer, srcBuffer };
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        result = CreateStorageBufferDescriptorSet(specDevice, descLayout, buffers, 2, &descriptorPool, &descriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        for (size_t i = 0; i < sizeof(s_advisedKernels) / sizeof(s_advisedKernels[0]) && result == VK_SUCCESS; i++)
+        {
+            const struct AdvisedKernel* pKernel = &s_advisedKernels[i];
+            struct ClspvKernelReflection reflection;
+            if (!LoadClspvKernelReflection(pKernel->fileName, pKernel->kernelName, &reflection))
+            {
+                printf("\n%s: no reflection information, skipped\n", pKernel->kernelName);
+                continue;
+            }
+
+            const struct LaunchKernelResources resources = {
+                .localMemorySize = reflection.staticLocalMemorySize,
+                .localMemorySizePerInvocation = pKernel->localMemorySizePerInvocation,
+                .maxWorkgroupSize = pKernel->maxWorkgroupSize
+            };
+            struct LaunchConfig advisedConfig;
+            if (!AdviseLaunchConfig(pModel, &resources, elemCount, &advisedConfig))
+            {
+                printf("\n%s: no valid launch configuration\n", pKernel->kernelName);
+                continue;
+            }
+
+            printf("\n%s: %u bytes of local arrays, %u bytes of local arguments per invocation, %u elements\n", pKernel->kernelName,
+                reflection.staticLocalMemorySize, pKernel->localMemorySizePerInvocation, elemCount);
+            printf("  size   groups     local  res  limited by       occupancy  waves%s\n", pKernel->timed ? "       time" : "");
+
+            for (uint32_t workgroupSize = pModel->subgroupSize; workgroupSize <= pModel->maxWorkgroupSize; workgroupSize *= 2U)
+            {
+                struct LaunchConfig config;
+                if (!EvaluateLaunchConfig(pModel, &resources, workgroupSize, elemCount, &config)) continue;
+
+                double milliseconds = -1.0;
+                if (pKernel->timed)
+                {
+                    // The timed kernels have no local pointer arguments
+                    const uint32_t specConstants[] = { workgroupSize, 1U, 1U };
+                    VkPipeline pipeline = VK_NULL_HANDLE;
+                    result = GetPipelineVariant(pCache, shaderModule, pKernel->kernelName, pipelineLayout, specConstants,
+                        (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0])), &pipeline);
+                    if (result != VK_SUCCESS)
+                    {
+                        fprintf(stderr, "GetPipelineVariant failed: %d\n", result);
+                        break;
+                    }
+                    milliseconds = TimeDispatches(specDevice, queue, commandPool, commandBuffers[0], pipeline, pipelineLayout, descriptorSet,
+                        elemCount, config.groupCount);
+                }
+                PrintLaunchConfig(&config, workgroupSize == advisedConfig.workgroupSize, milliseconds);
+            }
+        }
+        puts("\n(* marks the advised workgroup size)");
+    } while (false);
+
+    DestroyBufferWithMemory(specDevice, dstBuffer, dstMemory);
+    DestroyBufferWithMemory(specDevice, srcBuffer, srcMemory);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(specDevice, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    if (shaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(pCache, shaderModule);
+        vkDestroyShaderModule(specDevice, shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (descLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(specDevice, descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+
+    puts("\n================ Complete launch advisor test ================\n");
+}
+
@@ -0,0 +1,89 @@
+#ifndef LAUNCH_ADVISOR_H
+#define LAUNCH_ADVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct PipelineVariantCache;
+
+// Occupancy-aware launch configuration.
+// Vulkan reports the limits of a single workgroup only, so the capacity of a compute unit (an SM of NVIDIA or a CU of AMD)
+// comes from VK_NV_shader_sm_builtins or VK_AMD_shader_core_properties if the device supports one of them, and is assumed otherwise.
+// The predicted occupancy is the ratio of the invocations resident on a compute unit to the ones it can hold.
+
+struct LaunchDeviceModel
+{
+    uint32_t subgroupSize;
+    // The largest 1D workgroup, limited by maxComputeWorkGroupInvocations, maxComputeWorkGroupSize[0] and maxComputeWorkgroupSubgroups
+    uint32_t maxWorkgroupSize;
+    // maxComputeSharedMemorySize
+    uint32_t maxWorkgroupLocalMemorySize;
+    // maxComputeWorkGroupCount[0]
+    uint32_t maxWorkgroupCount;
+
+    // 0 if the device does not report it
+    uint32_t computeUnitCount;
+    uint32_t computeUnitMaxInvocations;
+    uint32_t computeUnitLocalMemorySize;
+    uint32_t computeUnitMaxWorkgroups;
+};
+
+struct LaunchKernelResources
+{
+    // The local memory a workgroup occupies regardless of its size, e.g. ClspvKernelReflection::staticLocalMemorySize
+    // plus the fixed size local pointer arguments
+    uint32_t localMemorySize;
+    // The local memory each invocation adds, for the local pointer arguments sized by the workgroup size
+    uint32_t localMemorySizePerInvocation;
+    // The largest workgroup size the kernel allows, or 0 for the device limit
+    uint32_t maxWorkgroupSize;
+};
+
+// What keeps more workgroups from being resident on a compute unit
+enum LaunchLimiter
+{
+    LAUNCH_LIMITER_INVOCATIONS,
+    LAUNCH_LIMITER_WORKGROUP_SLOTS,
+    LAUNCH_LIMITER_LOCAL_MEMORY
+};
+
+struct LaunchConfig
+{
+    uint32_t workgroupSize;
+    // The number of workgroups that cover `elemCount` elements, one element per invocation
+    uint32_t groupCount;
+    uint32_t localMemorySize;
+    uint32_t residentWorkgroupsPerComputeUnit;
+    enum LaunchLimiter limiter;
+    float occupancy;
+    // The workgroups resident on the whole device at a time, i.e. the group count of a persistent kernel,
+    // and the number of such waves `groupCount` takes. Both are 0 if the compute unit count is unknown.
+    uint32_t residentGroupCount;
+    uint32_t waveCount;
+};
+
+extern void InitializeLaunchDeviceModel(const VkPhysicalDeviceLimits* pLimits, uint32_t subgroupSize, uint32_t maxComputeWorkgroupSubgroups,
+    struct LaunchDeviceModel* pModel);
+
+// Returns false if `workgroupSize` exceeds a limit of the device or the kernel, or the local memory does not fit in a workgroup.
+extern bool EvaluateLaunchConfig(const struct LaunchDeviceModel* pModel, const struct LaunchKernelResources* pResources, uint32_t workgroupSize,
+    uint32_t elemCount, struct LaunchConfig* pConfig);
+
+// Tries the power of 2 workgroup sizes from the subgroup size on, and picks the one of the highest predicted occupancy.
+// Among them, the one whose last wave is the fullest wins, and then the larger workgroup.
+// Returns false if no workgroup size is valid.
+extern bool AdviseLaunchConfig(const struct LaunchDeviceModel* pModel, const struct LaunchKernelResources* pResources, uint32_t elemCount,
+    struct LaunchConfig* pConfig);
+
+extern const char* GetLaunchLimiterName(enum LaunchLimiter limiter);
+
+// Prints the candidate launch configurations of the kernels of clspv_spec and advance, and times IncKernel and DoubleKernel
+// with each of them next to the predicted occupancy.
+extern void LaunchAdvisorTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache);
+
+#endif // !LAUNCH_ADVISOR_H
+
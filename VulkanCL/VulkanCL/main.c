@@ -40,6 +40,31 @@ static inline FILE* OpenFileWithRead(const char* filePath)
 
 #include <vulkan/vulkan.h>
 
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "dedicated_allocation.h"
+#include "scan.h"
+#include "radix_sort.h"
+#include "elementwise_fusion.h"
+#include "pipeline_warmup.h"
+#include "pipeline_variants.h"
+#include "clspv_reflection.h"
+#include "launch_advisor.h"
+#include "persistent_queue.h"
+#include "small_transfer.h"
+#include "iterative.h"
+#include "indirect_dispatch.h"
+#include "multi_device.h"
+#include "heterogeneous.h"
+#include "external_memory.h"
+#include "compute_daemon.h"
+#include "submission_queue.h"
+#include "command_recorder.h"
+#include "object_pool.h"
+#include "embedded_spv.h"
+
 #ifndef max
 #define max(a,b) (((a) > (b)) ? (a) : (b))
 #endif // !max
@@ -51,6 +76,8 @@ enum MY_CONSTANTS
     MAX_VULKAN_GLOBAL_EXT_PROPS = 256,
     MAX_GPU_COUNT = 8,
     MAX_QUEUE_FAMILY_PROPERTY_COUNT = 8,
+    // The most fences of the shared fence pool out at the same time, one per thread waiting for a submission
+    SHARED_FENCE_POOL_MAX_COUNT = 64,
 
     TEST_IMAGE_WIDTH = 1024,
     TEST_IMAGE_HEIGHT = 1024
@@ -63,7 +90,16 @@ static uint32_t s_layerCount;
 static uint32_t s_instanceExtensionCounts[MAX_VULKAN_LAYER_COUNT];
 
 static VkInstance s_instance = VK_NULL_HANDLE;
+static VkPhysicalDevice s_specPhysicalDevice = VK_NULL_HANDLE;
 static VkDevice s_specDevice = VK_NULL_HANDLE;
+// All the compute pipelines are created through this cache, which the pipeline warmup stage fills at startup
+static VkPipelineCache s_pipelineCache = VK_NULL_HANDLE;
+// The specialization variants of the pipelines that the tests create on demand
+static struct PipelineVariantCache* s_pipelineVariantCache = NULL;
+// Persistently mapped, for the readbacks of the small transfer path
+static struct ResultSlab* s_resultSlab = NULL;
+// The fences of SubmitCommandBufferAndWait and of the tests, recycled instead of created per submission
+static struct FencePool* s_fencePool = NULL;
 static uint32_t s_specQueueFamilyIndex = 0;
 static VkPhysicalDeviceMemoryProperties s_memoryProperties = { 0 };
 
@@ -71,6 +107,15 @@ static bool s_supportShaderNonSemanticInfo = false;
 static bool s_supportBufferDeviceAddress = false;
 
 static uint32_t s_maxWorkGroupSize = 0;
+static VkPhysicalDeviceLimits s_deviceLimits = { 0 };
+static VkPhysicalDeviceSubgroupProperties s_subgroupProperties = { 0 };
+// Chained to s_subgroupProperties if compute pipelines may require a subgroup size or full subgroups
+static VkPhysicalDeviceSubgroupSizeControlPropertiesEXT s_subgroupSizeControlProperties = { 0 };
+static struct LaunchDeviceModel s_launchDeviceModel = { 0 };
+static VkPhysicalDeviceFeatures s_deviceFeatures = { 0 };
+static bool s_supportCustomBorderColor = false;
+static bool s_supportExternalFd = false;
+static bool s_supportTimelineSemaphore = false;
 
 static const char* const s_deviceTypes[] = {
     "Other",
@@ -208,7 +253,7 @@ static VkResult InitializeInstance(void)
         .ppEnabledLayerNames = s_layerNames
     };
 
-    result = vkCreateInstance(&inst_info, NULL, &s_instance);
+    result = vkCreateInstance(&inst_info, GetHostAllocationCallbacks(VK_OBJECT_TYPE_INSTANCE), &s_instance);
     if (result == VK_ERROR_INCOMPATIBLE_DRIVER) {
         puts("cannot find a compatible Vulkan ICD");
     }
@@ -398,6 +443,12 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
     bool supportCustomBorderColor = false;
     bool supportVariablePointers = false;
     bool supportBufferDeviceAddressEXT = false;
+    bool supportShaderSMBuiltins = false;
+    bool supportShaderCoreProperties = false;
+    bool supportMemoryBudget = false;
+    bool supportExternalMemoryFd = false;
+    bool supportExternalSemaphoreFd = false;
+    bool supportTimelineSemaphore = false;
     for (uint32_t i = 0; i < extPropCount; ++i)
     {
         if (strcmp(extProps[i].extensionName, VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME) == 0)
@@ -425,6 +476,36 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
             supportBufferDeviceAddressEXT = true;
             puts("The current device fully supports `VK_KHR_buffer_device_address` extension!");
         }
+        if (strcmp(extProps[i].extensionName, VK_NV_SHADER_SM_BUILTINS_EXTENSION_NAME) == 0)
+        {
+            supportShaderSMBuiltins = true;
+            puts("Current device supports `VK_NV_shader_sm_builtins` extension!");
+        }
+        if (strcmp(extProps[i].extensionName, VK_AMD_SHADER_CORE_PROPERTIES_EXTENSION_NAME) == 0)
+        {
+            supportShaderCoreProperties = true;
+            puts("Current device supports `VK_AMD_shader_core_properties` extension!");
+        }
+        if (strcmp(extProps[i].extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+        {
+            supportMemoryBudget = true;
+            puts("Current device supports `VK_EXT_memory_budget` extension!");
+        }
+        if (strcmp(extProps[i].extensionName, VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME) == 0)
+        {
+            supportExternalMemoryFd = true;
+            puts("Current device supports `VK_KHR_external_memory_fd` extension!");
+        }
+        if (strcmp(extProps[i].extensionName, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME) == 0)
+        {
+            supportExternalSemaphoreFd = true;
+            puts("Current device supports `VK_KHR_external_semaphore_fd` extension!");
+        }
+        if (strcmp(extProps[i].extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0)
+        {
+            supportTimelineSemaphore = true;
+            puts("Current device supports `VK_KHR_timeline_semaphore` extension!");
+        }
     }
 
     if (!supportBufferDeviceAddressEXT) {
@@ -433,11 +514,18 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
 
     // ==== The following is query the specific extension features in the feature chaining form ====
 
+    // VK_KHR_timeline_semaphore feature, which is core since Vulkan 1.2
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES,
+        // This is the last node
+        .pNext = NULL
+    };
+
     // VK_EXT_custom_border_color feature
     VkPhysicalDeviceCustomBorderColorFeaturesEXT customBorderColorFeature = {
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CUSTOM_BORDER_COLOR_FEATURES_EXT,
-        // This is the last node
-        .pNext = NULL
+        // link to timelineSemaphoreFeature node
+        .pNext = &timelineSemaphoreFeature
     };
 
     // VK_EXT_subgroup_size_control feature
@@ -487,6 +575,8 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
         deviceBufferAddresFeatures.bufferDeviceAddressCaptureReplay != VK_FALSE ? "supports" : "does not support");
     printf("Current device %s bufferDeviceAddressMultiDevice\n",
         deviceBufferAddresFeatures.bufferDeviceAddressMultiDevice != VK_FALSE ? "supports" : "does not support");
+    printf("Current device %s timelineSemaphore\n",
+        timelineSemaphoreFeature.timelineSemaphore != VK_FALSE ? "supports" : "does not support");
 
     if (deviceBufferAddresFeatures.bufferDeviceAddress != VK_FALSE) {
         s_supportBufferDeviceAddress = true;
@@ -497,6 +587,10 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
         puts("WARNING: shaderInt64 feature is not enabled by default. This feature will be enabled automatically...");
     }
     features2.features.shaderInt64 = VK_TRUE;
+    s_deviceFeatures = features2.features;
+
+    s_supportCustomBorderColor = supportCustomBorderColor && customBorderColorFeature.customBorderColors != VK_FALSE;
+    s_supportTimelineSemaphore = timelineSemaphoreFeature.timelineSemaphore != VK_FALSE;
 
     // ==== Query the current selected device properties corresponding the above features ====
     // VK_EXT_custom_border_color properties
@@ -532,6 +626,22 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
         .pNext = &driverProps
     };
 
+    // The compute unit properties for the launch advisor, which may be chained only if the device supports the extension
+    VkPhysicalDeviceShaderSMBuiltinsPropertiesNV smBuiltinsProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SM_BUILTINS_PROPERTIES_NV,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceShaderCorePropertiesAMD shaderCoreProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_CORE_PROPERTIES_AMD,
+        .pNext = NULL
+    };
+    if (supportShaderSMBuiltins) {
+        customBorderProps.pNext = &smBuiltinsProps;
+    }
+    else if (supportShaderCoreProperties) {
+        customBorderProps.pNext = &shaderCoreProps;
+    }
+
     // Query all above properties
     vkGetPhysicalDeviceProperties2(physicalDevices[deviceIndex], &properties2);
 
@@ -555,9 +665,38 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
     FetchSupportedShaderStages(subgroupSizeProps.supportedStages, strBuffer);
     printf("Current device supported subgroup stages: %s\n", strBuffer);
 
+    s_deviceLimits = properties2.properties.limits;
+    s_subgroupProperties = subgroupSizeProps;
+    s_subgroupProperties.pNext = NULL;
+    // The subgroupSizeControl and computeFullSubgroups features are enabled together with the rest of features2 by vkCreateDevice
+    if (supportSubgroupSizeControl && subgroupSizeControlFeature.subgroupSizeControl != VK_FALSE &&
+        subgroupSizeControlFeature.computeFullSubgroups != VK_FALSE)
+    {
+        s_subgroupSizeControlProperties = subgroupSizeControlProps;
+        s_subgroupSizeControlProperties.pNext = NULL;
+        s_subgroupProperties.pNext = &s_subgroupSizeControlProperties;
+    }
     s_maxWorkGroupSize = properties2.properties.limits.maxComputeWorkGroupInvocations;
     printf("Current device max work group size: %u\n", s_maxWorkGroupSize);
 
+    InitializeLaunchDeviceModel(&s_deviceLimits, subgroupSizeProps.subgroupSize,
+        supportSubgroupSizeControl ? subgroupSizeControlProps.maxComputeWorkgroupSubgroups : 0, &s_launchDeviceModel);
+    if (supportShaderSMBuiltins)
+    {
+        s_launchDeviceModel.computeUnitCount = smBuiltinsProps.shaderSMCount;
+        s_launchDeviceModel.computeUnitMaxInvocations = smBuiltinsProps.shaderWarpsPerSM * subgroupSizeProps.subgroupSize;
+        printf("Current device SM count: %u, warps per SM: %u\n", smBuiltinsProps.shaderSMCount, smBuiltinsProps.shaderWarpsPerSM);
+    }
+    else if (supportShaderCoreProperties)
+    {
+        s_launchDeviceModel.computeUnitCount = shaderCoreProps.shaderEngineCount * shaderCoreProps.shaderArraysPerEngineCount *
+            shaderCoreProps.computeUnitsPerShaderArray;
+        s_launchDeviceModel.computeUnitMaxInvocations = shaderCoreProps.simdPerComputeUnit * shaderCoreProps.wavefrontsPerSimd *
+            shaderCoreProps.wavefrontSize;
+        printf("Current device compute unit count: %u, wavefronts per compute unit: %u\n", s_launchDeviceModel.computeUnitCount,
+            shaderCoreProps.simdPerComputeUnit * shaderCoreProps.wavefrontsPerSimd);
+    }
+
     // Get device memory properties
     vkGetPhysicalDeviceMemoryProperties(physicalDevices[deviceIndex], pMemoryProperties);
 
@@ -593,7 +732,7 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
     s_specQueueFamilyIndex = queue_info.queueFamilyIndex;
 
     uint32_t extCount = 0;
-    const char* extensionNames[5] = { NULL };
+    const char* extensionNames[10] = { NULL };
     if (supportSubgroupSizeControl) {
         extensionNames[extCount++] = VK_EXT_SUBGROUP_SIZE_CONTROL_EXTENSION_NAME;
     }
@@ -609,6 +748,20 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
     if (supportBufferDeviceAddressEXT) {
         extensionNames[extCount++] = VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME;
     }
+    if (supportMemoryBudget) {
+        extensionNames[extCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
+    // Buffers and semaphores are shared with other processes only as a pair
+    s_supportExternalFd = supportExternalMemoryFd && supportExternalSemaphoreFd;
+    if (s_supportExternalFd)
+    {
+        extensionNames[extCount++] = VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME;
+        extensionNames[extCount++] = VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME;
+    }
+    // Not needed on a Vulkan 1.2 device, whose timelineSemaphore feature is enabled through features2 alone
+    if (supportTimelineSemaphore) {
+        extensionNames[extCount++] = VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME;
+    }
 
     // There are two ways to enable features:
     // (1) Set pNext to a VkPhysicalDeviceFeatures2 structure and set pEnabledFeatures to NULL;
@@ -626,25 +779,81 @@ static VkResult InitializeDevice(VkQueueFlagBits queueFlag, VkPhysicalDeviceMemo
         .pEnabledFeatures = NULL
     };
 
-    res = vkCreateDevice(physicalDevices[deviceIndex], &device_info, NULL, &s_specDevice);
-    if (res != VK_SUCCESS) {
+    res = vkCreateDevice(physicalDevices[deviceIndex], &device_info, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE), &s_specDevice);
+    if (res != VK_SUCCESS)
+    {
         fprintf(stderr, "vkCreateDevice failed: %d\n", res);
+        return res;
+    }
+    s_specPhysicalDevice = physicalDevices[deviceIndex];
+
+    // All the device memory of the selected device is allocated within the budget of its heaps
+    if (!RegisterMemoryBudgetDevice(physicalDevices[deviceIndex], s_specDevice, supportMemoryBudget)) {
+        fprintf(stderr, "RegisterMemoryBudgetDevice failed!\n");
+    }
+
+    const VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .initialDataSize = 0,
+        .pInitialData = NULL
+    };
+    res = vkCreatePipelineCache(s_specDevice, &pipelineCacheCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_CACHE), &s_pipelineCache);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreatePipelineCache failed: %d\n", res);
+        return res;
+    }
+
+    res = CreatePipelineVariantCache(s_specDevice, &s_pipelineVariantCache);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreatePipelineVariantCache failed: %d\n", res);
+        return res;
+    }
+
+    res = CreateFencePool(s_specDevice, SHARED_FENCE_POOL_MAX_COUNT, &s_fencePool);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "CreateFencePool failed: %d\n", res);
     }
 
     return res;
 }
 
+VkPipelineCache GetSharedPipelineCache(void)
+{
+    return s_pipelineCache;
+}
+
+struct PipelineVariantCache* GetSharedPipelineVariantCache(void)
+{
+    return s_pipelineVariantCache;
+}
+
+struct FencePool* GetSharedFencePool(void)
+{
+    return s_fencePool;
+}
+
 VkResult InitializeCommandBuffer(uint32_t queueFamilyIndex, VkDevice device, VkCommandPool* pCommandPool,
     VkCommandBuffer commandBuffers[], uint32_t commandBufferCount)
+{
+    return InitializeCommandBufferWithFlags(queueFamilyIndex, device, 0, VK_COMMAND_BUFFER_LEVEL_PRIMARY, pCommandPool,
+        commandBuffers, commandBufferCount);
+}
+
+VkResult InitializeCommandBufferWithFlags(uint32_t queueFamilyIndex, VkDevice device, VkCommandPoolCreateFlags poolFlags,
+    VkCommandBufferLevel level, VkCommandPool* pCommandPool, VkCommandBuffer commandBuffers[], uint32_t commandBufferCount)
 {
     const VkCommandPoolCreateInfo cmd_pool_info = {
         .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
         .pNext = NULL,
-        .flags = 0,
+        .flags = poolFlags,
         .queueFamilyIndex = queueFamilyIndex
     };
 
-    VkResult res = vkCreateCommandPool(device, &cmd_pool_info, NULL, pCommandPool);
+    VkResult res = vkCreateCommandPool(device, &cmd_pool_info, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL), pCommandPool);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateCommandPool failed: %d\n", res);
@@ -656,7 +865,7 @@ VkResult InitializeCommandBuffer(uint32_t queueFamilyIndex, VkDevice device, VkC
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
         .pNext = NULL,
         .commandPool = *pCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .level = level,
         .commandBufferCount = commandBufferCount
     };
 
@@ -664,142 +873,94 @@ VkResult InitializeCommandBuffer(uint32_t queueFamilyIndex, VkDevice device, VkC
     return res;
 }
 
-// deviceMemories[0] as host visible memory, deviceMemories[1] as device local memory
-// deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer
-static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[2],
-    VkBuffer deviceBuffers[3], VkDeviceSize bufferSize, uint32_t queueFamilyIndex)
+// deviceBuffers[0] as device dst buffer, deviceBuffers[1] as device src buffer, both bound to the device local deviceMemories[0],
+// or to deviceMemories[0] and deviceMemories[1] if the dedicated allocation policy routes them to allocations of their own
+static VkResult AllocateDeviceBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[2],
+    VkBuffer deviceBuffers[2], VkDeviceSize bufferSize, uint32_t queueFamilyIndex)
 {
-    const VkBufferCreateInfo hostBufCreateInfo = {
+    const VkBufferCreateInfo deviceBufCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .pNext = NULL,
         .flags = 0,
         .size = bufferSize,
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .queueFamilyIndexCount = 1,
         .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
     };
 
-    VkResult res = vkCreateBuffer(device, &hostBufCreateInfo, NULL, &deviceBuffers[0]);
+    VkResult res = vkCreateBuffer(device, &deviceBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[0]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    VkMemoryRequirements hostMemBufRequirements = { 0 };
-    vkGetBufferMemoryRequirements(device, deviceBuffers[0], &hostMemBufRequirements);
-
-    uint32_t memoryTypeIndex;
-    // Find host visible property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
-    {
-        if ((hostMemBufRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 &&
-            (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0 &&
-            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size >= hostMemBufRequirements.size)
-        {
-            // found our memory type!
-            printf("Host visible memory size: %zuMB\n", pMemoryProperties->memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
-    const VkMemoryAllocateInfo hostMemAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = hostMemBufRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex
-    };
-
-    res = vkAllocateMemory(device, &hostMemAllocInfo, NULL, &deviceMemories[0]);
+    res = vkCreateBuffer(device, &deviceBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[1]);
     if (res != VK_SUCCESS)
     {
-        fprintf(stderr, "vkAllocateMemory failed: %d\n", res);
+        fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    res = vkBindBufferMemory(device, deviceBuffers[0], deviceMemories[0], 0);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
+    // two memory buffers share one device local memory, unless they are large enough for dedicated allocations.
+    uint32_t dedicatedCount = 0;
+    res = AllocateAndBindBufferMemory(device, pMemoryProperties, deviceBuffers, 2, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, NULL, deviceMemories,
+        &dedicatedCount);
+    if (res != VK_SUCCESS) {
         return res;
     }
+    printf("Device local VRAM budget left: %zuMB, %u dedicated allocation(s)\n",
+        (size_t)(GetAvailableMemoryBudget(device, pMemoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) / (1024 * 1024)), dedicatedCount);
 
-    const VkBufferCreateInfo deviceBufCreateInfo = {
+    return res;
+}
+
+// deviceMemories[0] as host visible memory, deviceMemories[1] and deviceMemories[2] as device local memory (see AllocateDeviceBuffers)
+// deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer
+static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[3],
+    VkBuffer deviceBuffers[3], VkDeviceSize bufferSize, uint32_t queueFamilyIndex)
+{
+    const VkBufferCreateInfo hostBufCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
         .pNext = NULL,
         .flags = 0,
         .size = bufferSize,
-        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
         .queueFamilyIndexCount = 1,
         .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
     };
 
-    res = vkCreateBuffer(device, &deviceBufCreateInfo, NULL, &deviceBuffers[1]);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
-        return res;
-    }
-
-    res = vkCreateBuffer(device, &deviceBufCreateInfo, NULL, &deviceBuffers[2]);
+    VkResult res = vkCreateBuffer(device, &hostBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[0]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    VkMemoryRequirements deviceMemBufRequirements = { 0 };
-    vkGetBufferMemoryRequirements(device, deviceBuffers[1], &deviceMemBufRequirements);
-
-    // two memory buffers share one device local memory.
-    const VkDeviceSize deviceMemTotalSize = max(bufferSize * 2, deviceMemBufRequirements.size);
-    // Find device local property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
-    {
-        if ((deviceMemBufRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size >= deviceMemTotalSize)
-        {
-            // found our memory type!
-            printf("Device local VRAM size: %zuMB\n", pMemoryProperties->memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
-    const VkMemoryAllocateInfo deviceMemAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = deviceMemTotalSize,
-        .memoryTypeIndex = memoryTypeIndex
-    };
+    VkMemoryRequirements hostMemBufRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, deviceBuffers[0], &hostMemBufRequirements);
 
-    res = vkAllocateMemory(device, &deviceMemAllocInfo, NULL, &deviceMemories[1]);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkAllocateMemory failed: %d\n", res);
+    // Find host visible property memory type index whose heap has the budget for the buffer
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    res = AllocateMemoryWithinBudget(device, pMemoryProperties, &hostMemBufRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, NULL, &deviceMemories[0], &memoryTypeIndex);
+    if (res != VK_SUCCESS) {
         return res;
     }
+    printf("Host visible memory size: %zuMB\n",
+        (size_t)(pMemoryProperties->memoryHeaps[pMemoryProperties->memoryTypes[memoryTypeIndex].heapIndex].size / (1024 * 1024)));
 
-    res = vkBindBufferMemory(device, deviceBuffers[1], deviceMemories[1], 0);
+    res = vkBindBufferMemory(device, deviceBuffers[0], deviceMemories[0], 0);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
         return res;
     }
 
-    res = vkBindBufferMemory(device, deviceBuffers[2], deviceMemories[1], bufferSize);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
+    res = AllocateDeviceBuffers(device, pMemoryProperties, &deviceMemories[1], &deviceBuffers[1], bufferSize, queueFamilyIndex);
+    if (res != VK_SUCCESS) {
         return res;
     }
 
@@ -812,16 +973,41 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         fprintf(stderr, "vkMapMemory failed: %d\n", res);
         return res;
     }
-    int* srcMem = hostBuffer;
-    for (int i = 0; i < elemCount; i++) {
-        srcMem[i] = i;
-    }
+    HostParallelFillSequence(hostBuffer, (size_t)elemCount, 0);
 
     vkUnmapMemory(device, deviceMemories[0]);
 
     return res;
 }
 
+// The buffers of AllocateMemoryAndBuffers, except that a payload small enough for vkCmdUpdateBuffer skips the staging buffer.
+// In that case, deviceBuffers[0] and deviceMemories[0] stay VK_NULL_HANDLE, `*ppSrcData` holds the initialized source data to be uploaded
+// by WriteSourceAndSync, and `*pResultRange` is a range of the result slab for SyncAndReadDestination. Otherwise `*ppSrcData` is NULL.
+static VkResult AllocateTransferBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[3],
+    VkBuffer deviceBuffers[3], VkDeviceSize bufferSize, uint32_t queueFamilyIndex, int** ppSrcData, struct ResultSlabRange* pResultRange)
+{
+    *ppSrcData = NULL;
+    memset(pResultRange, 0, sizeof(*pResultRange));
+
+    if (s_resultSlab == NULL || !IsSmallTransferSize(bufferSize) || AcquireResultSlabRange(s_resultSlab, bufferSize, pResultRange) != VK_SUCCESS)
+    {
+        puts("Transfer path: staging buffer");
+        return AllocateMemoryAndBuffers(device, pMemoryProperties, deviceMemories, deviceBuffers, bufferSize, queueFamilyIndex);
+    }
+    puts("Transfer path: vkCmdUpdateBuffer and the result slab");
+
+    int* srcData = malloc(bufferSize);
+    if (srcData == NULL)
+    {
+        ReleaseResultSlabRange(s_resultSlab, pResultRange);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    HostParallelFillSequence(srcData, (size_t)(bufferSize / sizeof(int)), 0);
+    *ppSrcData = srcData;
+
+    return AllocateDeviceBuffers(device, pMemoryProperties, &deviceMemories[1], &deviceBuffers[1], bufferSize, queueFamilyIndex);
+}
+
 static void ClearDeviceBuffer(VkCommandBuffer commandBuffer, VkBuffer dstDeviceBuffer, size_t size)
 {
     vkCmdFillBuffer(commandBuffer, dstDeviceBuffer, 0U, size, 0U);
@@ -876,46 +1062,659 @@ void SyncAndReadBuffer(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex,
     vkCmdCopyBuffer(commandBuffer, srcDeviceBuffer, dstHostBuffer, 1, &copyRegion);
 }
 
-static void SynchronizeExecution(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex)
-{
-    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
-        0, NULL, 0, NULL, 0, NULL);
+// Uploads the source buffer deviceBuffers[2] from `srcData` of AllocateTransferBuffers, or from the staging buffer if `srcData` is NULL
+static void WriteSourceAndSync(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex, const VkBuffer deviceBuffers[3], const int* srcData, size_t size)
+{
+    if (srcData != NULL)
+    {
+        RecordSmallBufferUpload(commandBuffer, deviceBuffers[2], 0, srcData, size);
+        RecordTransferToComputeBarrier(commandBuffer);
+    }
+    else {
+        WriteBufferAndSync(commandBuffer, queueFamilyIndex, deviceBuffers[2], deviceBuffers[0], size);
+    }
+}
+
+// Reads the destination buffer deviceBuffers[1] back into the result slab range of AllocateTransferBuffers, or into the staging buffer
+static void SyncAndReadDestination(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex, const VkBuffer deviceBuffers[3],
+    const struct ResultSlabRange* pResultRange, size_t size)
+{
+    if (pResultRange->pHostData != NULL) {
+        RecordResultSlabReadback(commandBuffer, s_resultSlab, pResultRange, deviceBuffers[1], 0);
+    }
+    else {
+        SyncAndReadBuffer(commandBuffer, queueFamilyIndex, deviceBuffers[0], deviceBuffers[1], size);
+    }
+}
+
+static void SynchronizeExecution(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex)
+{
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        0, NULL, 0, NULL, 0, NULL);
+}
+
+// Returns the module of tools/embed_spv.py embedded for `fileName`, or NULL if it has not been embedded.
+static const struct EmbeddedSpirvModule* FindEmbeddedSpirvModule(const char* fileName)
+{
+    for (int i = 0; i < EMBEDDED_SPIRV_MODULE_COUNT; i++)
+    {
+        if (strcmp(g_embeddedSpirvModules[i].fileName, fileName) == 0) {
+            return &g_embeddedSpirvModules[i];
+        }
+    }
+    return NULL;
+}
+
+bool IsShaderModuleAvailable(const char* fileName)
+{
+    if (FindEmbeddedSpirvModule(fileName) != NULL) return true;
+
+    FILE* fp = OpenFileWithRead(fileName);
+    if (fp == NULL) return false;
+    fclose(fp);
+    return true;
+}
+
+uint32_t* LoadSpirvCode(const char* fileName, size_t* pCodeSize)
+{
+    const struct EmbeddedSpirvModule* pEmbeddedModule = FindEmbeddedSpirvModule(fileName);
+    if (pEmbeddedModule != NULL)
+    {
+        uint32_t* code = malloc(pEmbeddedModule->codeSize);
+        if (code != NULL)
+        {
+            memcpy(code, pEmbeddedModule->code, pEmbeddedModule->codeSize);
+            *pCodeSize = pEmbeddedModule->codeSize;
+        }
+        return code;
+    }
+
+    FILE* fp = OpenFileWithRead(fileName);
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Shader file %s not found!\n", fileName);
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t fileLen = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint32_t* codeBuffer = malloc(fileLen);
+    if (codeBuffer != NULL)
+    {
+        if (fread(codeBuffer, 1, fileLen, fp) == fileLen) {
+            *pCodeSize = fileLen;
+        }
+        else
+        {
+            fprintf(stderr, "Failed to read shader file %s!\n", fileName);
+            free(codeBuffer);
+            codeBuffer = NULL;
+        }
+    }
+    fclose(fp);
+
+    return codeBuffer;
+}
+
+VkResult CreateShaderModule(VkDevice device, const char* fileName, VkShaderModule* pShaderModule)
+{
+    // The embedded modules need neither file I/O nor a copy
+    const struct EmbeddedSpirvModule* pEmbeddedModule = FindEmbeddedSpirvModule(fileName);
+    if (pEmbeddedModule != NULL)
+    {
+        const VkShaderModuleCreateInfo embeddedModuleCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .codeSize = pEmbeddedModule->codeSize,
+            .pCode = pEmbeddedModule->code
+        };
+
+        VkResult res = vkCreateShaderModule(device, &embeddedModuleCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE), pShaderModule);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateShaderModule failed: %d\n", res);
+        }
+        return res;
+    }
+
+    size_t codeSize = 0;
+    uint32_t* codeBuffer = LoadSpirvCode(fileName, &codeSize);
+    if (codeBuffer == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const VkShaderModuleCreateInfo moduleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .codeSize = codeSize,
+        .pCode = codeBuffer
+    };
+
+    VkResult res = vkCreateShaderModule(device, &moduleCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE), pShaderModule);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateShaderModule failed: %d\n", res);
+    }
+
+    free(codeBuffer);
+
+    return res;
+}
+
+uint32_t FindMemoryTypeIndex(const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t memoryTypeBits,
+    VkMemoryPropertyFlags requiredFlags)
+{
+    for (uint32_t memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
+    {
+        if ((memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
+            continue;
+        }
+        if ((pMemoryProperties->memoryTypes[memoryTypeIndex].propertyFlags & requiredFlags) == requiredFlags) {
+            return memoryTypeIndex;
+        }
+    }
+    return UINT32_MAX;
+}
+
+VkResult CreateBufferWithMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags, uint32_t queueFamilyIndex, VkBuffer* pBuffer, VkDeviceMemory* pMemory)
+{
+    *pBuffer = VK_NULL_HANDLE;
+    *pMemory = VK_NULL_HANDLE;
+
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = size,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
+    };
+
+    VkResult res = vkCreateBuffer(device, &bufferCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), pBuffer);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
+        return res;
+    }
+
+    // If buffer was created with the VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT bit set,
+    // memory must have been allocated with the VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT bit set.
+    const VkMemoryAllocateFlagsInfo memAllocFlagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .pNext = NULL,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
+    };
+
+    // A dedicated allocation if the policy routes the buffer to one.
+    // Device local memory falls back to host visible memory when the budget of the device cannot hold it.
+    return AllocateAndBindBufferMemory(device, pMemoryProperties, pBuffer, 1, memoryFlags,
+        (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0 ? &memAllocFlagsInfo : NULL, pMemory, NULL);
+}
+
+void DestroyBufferWithMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory)
+{
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
+    }
+    FreeDeviceMemory(device, memory);
+}
+
+VkDeviceAddress GetBufferDeviceAddress(VkDevice device, VkBuffer buffer)
+{
+    const VkBufferDeviceAddressInfo addressInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .pNext = NULL,
+        .buffer = buffer
+    };
+    return vkGetBufferDeviceAddress(device, &addressInfo);
+}
+
+VkResult CreateImage2DWithMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t width, uint32_t height,
+    VkFormat format, VkImageUsageFlags usage, uint32_t queueFamilyIndex, VkImage* pImage, VkDeviceMemory* pMemory, VkImageView* pImageView)
+{
+    *pImage = VK_NULL_HANDLE;
+    *pMemory = VK_NULL_HANDLE;
+    *pImageView = VK_NULL_HANDLE;
+
+    const VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = format,
+        .extent = { width, height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex },
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+
+    VkResult res = vkCreateImage(device, &imageCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_IMAGE), pImage);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateImage failed: %d\n", res);
+        return res;
+    }
+
+    VkMemoryRequirements memRequirements = { 0 };
+    vkGetImageMemoryRequirements(device, *pImage, &memRequirements);
+
+    res = AllocateMemoryWithinBudget(device, pMemoryProperties, &memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, NULL, pMemory, NULL);
+    if (res != VK_SUCCESS) {
+        return res;
+    }
+
+    res = vkBindImageMemory(device, *pImage, *pMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBindImageMemory failed: %d\n", res);
+        return res;
+    }
+
+    const VkImageViewCreateInfo imageViewCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .image = *pImage,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = format,
+        .components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+    };
+
+    res = vkCreateImageView(device, &imageViewCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_IMAGE_VIEW), pImageView);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateImageView failed: %d\n", res);
+    }
+
+    return res;
+}
+
+void DestroyImage2DWithMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkImageView imageView)
+{
+    if (imageView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, imageView, GetHostAllocationCallbacks(VK_OBJECT_TYPE_IMAGE_VIEW));
+    }
+    if (image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, image, GetHostAllocationCallbacks(VK_OBJECT_TYPE_IMAGE));
+    }
+    FreeDeviceMemory(device, memory);
+}
+
+void RecordImageLayoutTransition(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const VkImageMemoryBarrier imageBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask,
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+    };
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+}
+
+VkResult CreateStorageBufferDescriptorSetLayout(VkDevice device, uint32_t bindingCount, VkDescriptorSetLayout* pDescLayout)
+{
+    VkDescriptorSetLayoutBinding* bindings = calloc(bindingCount > 0 ? bindingCount : 1, sizeof(*bindings));
+    if (bindings == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < bindingCount; i++) {
+        bindings[i] = (VkDescriptorSetLayoutBinding){ i, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, NULL };
+    }
+
+    const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = bindingCount,
+        .pBindings = bindings
+    };
+
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
+    }
+
+    free(bindings);
+
+    return res;
+}
+
+VkResult AllocateStorageBufferDescriptorSet(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSetLayout descLayout,
+    const VkBuffer buffers[], uint32_t bufferCount, VkDescriptorSet* pDescSet)
+{
+    const VkDescriptorSetAllocateInfo descAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &descLayout
+    };
+    VkResult res = vkAllocateDescriptorSets(device, &descAllocInfo, pDescSet);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateDescriptorSets failed: %d\n", res);
+        return res;
+    }
+
+    VkDescriptorBufferInfo* bufferInfos = calloc(bufferCount > 0 ? bufferCount : 1, sizeof(*bufferInfos));
+    VkWriteDescriptorSet* writeDescSets = calloc(bufferCount > 0 ? bufferCount : 1, sizeof(*writeDescSets));
+    if (bufferInfos == NULL || writeDescSets == NULL)
+    {
+        free(bufferInfos);
+        free(writeDescSets);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < bufferCount; i++)
+    {
+        bufferInfos[i] = (VkDescriptorBufferInfo){
+            .buffer = buffers[i],
+            .offset = 0,
+            .range = VK_WHOLE_SIZE
+        };
+        writeDescSets[i] = (VkWriteDescriptorSet){
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = *pDescSet,
+            .dstBinding = i,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &bufferInfos[i],
+            .pTexelBufferView = NULL
+        };
+    }
+
+    vkUpdateDescriptorSets(device, bufferCount, writeDescSets, 0, NULL);
+
+    free(bufferInfos);
+    free(writeDescSets);
+
+    return res;
+}
+
+VkResult CreateStorageBufferDescriptorSet(VkDevice device, VkDescriptorSetLayout descLayout, const VkBuffer buffers[], uint32_t bufferCount,
+    VkDescriptorPool* pDescriptorPool, VkDescriptorSet* pDescSet)
+{
+    const VkDescriptorPoolCreateInfo descriptorPoolInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .maxSets = 1,
+        .poolSizeCount = 1,
+        .pPoolSizes = (VkDescriptorPoolSize[]) {
+            {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = bufferCount > 0 ? bufferCount : 1 }
+        }
+    };
+    VkResult res = vkCreateDescriptorPool(device, &descriptorPoolInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), pDescriptorPool);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateDescriptorPool failed: %d\n", res);
+        return res;
+    }
+
+    return AllocateStorageBufferDescriptorSet(device, *pDescriptorPool, descLayout, buffers, bufferCount, pDescSet);
+}
+
+VkResult CreateComputePipelineLayout(VkDevice device, VkDescriptorSetLayout descLayout, uint32_t pushConstantSize, VkPipelineLayout* pPipelineLayout)
+{
+    const VkPushConstantRange pushConstRange = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = pushConstantSize
+    };
+
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .setLayoutCount = descLayout != VK_NULL_HANDLE ? 1U : 0U,
+        .pSetLayouts = descLayout != VK_NULL_HANDLE ? &descLayout : NULL,
+        .pushConstantRangeCount = pushConstantSize > 0 ? 1U : 0U,
+        .pPushConstantRanges = pushConstantSize > 0 ? &pushConstRange : NULL
+    };
+
+    VkResult res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreatePipelineLayout failed: %d\n", res);
+    }
+
+    return res;
+}
+
+VkResult CreateComputePipelineWithSpecConstants(VkDevice device, VkShaderModule computeShaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipeline* pComputePipeline)
+{
+    return CreateComputePipelineWithStageFlags(device, computeShaderModule, entryName, pipelineLayout, specConstants, specConstantCount,
+        0, 0, pComputePipeline);
+}
+
+VkResult CreateComputePipelineWithStageFlags(VkDevice device, VkShaderModule computeShaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipelineShaderStageCreateFlags stageFlags,
+    uint32_t requiredSubgroupSize, VkPipeline* pComputePipeline)
+{
+    VkSpecializationMapEntry* mapEntries = calloc(specConstantCount > 0 ? specConstantCount : 1, sizeof(*mapEntries));
+    if (mapEntries == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < specConstantCount; i++)
+    {
+        mapEntries[i] = (VkSpecializationMapEntry){
+            .constantID = i,
+            .offset = i * (uint32_t)sizeof(uint32_t),
+            .size = sizeof(uint32_t)
+        };
+    }
+
+    const VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = specConstantCount,
+        .pMapEntries = mapEntries,
+        .dataSize = specConstantCount * sizeof(uint32_t),
+        .pData = specConstants
+    };
+
+    // VK_EXT_subgroup_size_control
+    VkPipelineShaderStageRequiredSubgroupSizeCreateInfoEXT requiredSubgroupSizeCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_REQUIRED_SUBGROUP_SIZE_CREATE_INFO_EXT,
+        .pNext = NULL,
+        .requiredSubgroupSize = requiredSubgroupSize
+    };
+
+    const VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+        .pNext = requiredSubgroupSize > 0 ? &requiredSubgroupSizeCreateInfo : NULL,
+        .flags = stageFlags,
+        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+        .module = computeShaderModule,
+        .pName = entryName,
+        .pSpecializationInfo = specConstantCount > 0 ? &specializationInfo : NULL
+    };
+
+    const VkComputePipelineCreateInfo computePipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .stage = shaderStageCreateInfo,
+        .layout = pipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0
+    };
+
+    // The shared pipeline cache belongs to the selected device, and the other devices of the multi-device executor compile without a cache
+    const VkPipelineCache pipelineCache = device == s_specDevice ? s_pipelineCache : VK_NULL_HANDLE;
+    VkResult res = vkCreateComputePipelines(device, pipelineCache, 1, &computePipelineCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE), pComputePipeline);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateComputePipelines for %s failed: %d\n", entryName, res);
+    }
+
+    free(mapEntries);
+
+    return res;
+}
+
+void RecordComputeToComputeBarrier(VkCommandBuffer commandBuffer)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+void RecordTransferToComputeBarrier(VkCommandBuffer commandBuffer)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+void RecordComputeToTransferBarrier(VkCommandBuffer commandBuffer)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+        1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+void RecordComputeToHostBarrier(VkCommandBuffer commandBuffer)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+    };
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+        1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+VkResult SubmitCommandBufferAndWait(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer)
+{
+    // The fence is recycled through the shared pool of the selected device.
+    // The other devices, and the submissions beyond the bound of the pool, create a fence of their own.
+    struct FencePool* pFencePool = device == s_specDevice ? s_fencePool : NULL;
+    VkFence fence = VK_NULL_HANDLE;
+    bool fenceWaitFailed = false;
+    VkResult res = pFencePool != NULL ? AcquirePooledFence(pFencePool, &fence) : VK_ERROR_TOO_MANY_OBJECTS;
+    if (res != VK_SUCCESS)
+    {
+        pFencePool = NULL;
+        const VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0
+        };
+        res = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), &fence);
+        if (res != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreateFence failed: %d\n", res);
+            return res;
+        }
+    }
+
+    const VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    res = vkQueueSubmit(queue, 1, &submit_info, fence);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", res);
+    }
+    else
+    {
+        res = vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkWaitForFences failed: %d\n", res);
+        }
+        fenceWaitFailed = res != VK_SUCCESS;
+    }
+
+    // After a failed wait, the fence may still be pending, so it is not handed out again
+    if (pFencePool != NULL && fenceWaitFailed) {
+        DiscardPooledFence(pFencePool, fence);
+    }
+    else if (pFencePool != NULL) {
+        ReleasePooledFence(pFencePool, fence);
+    }
+    else {
+        vkDestroyFence(device, fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+
+    return res;
 }
 
-VkResult CreateShaderModule(VkDevice device, const char* fileName, VkShaderModule* pShaderModule)
+VkResult BeginOneTimeCommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBuffer commandBuffer)
 {
-    FILE* fp = OpenFileWithRead(fileName);
-    if (fp == NULL)
+    VkResult result = vkResetCommandPool(device, commandPool, 0);
+    if (result != VK_SUCCESS)
     {
-        fprintf(stderr, "Shader file %s not found!\n", fileName);
-        return VK_ERROR_INITIALIZATION_FAILED;
-    }
-    fseek(fp, 0, SEEK_END);
-    size_t fileLen = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    uint32_t* codeBuffer = malloc(fileLen);
-    if (codeBuffer != NULL) {
-        fread(codeBuffer, 1, fileLen, fp);
+        fprintf(stderr, "vkResetCommandPool failed: %d\n", result);
+        return result;
     }
-    fclose(fp);
 
-    const VkShaderModuleCreateInfo moduleCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+    const VkCommandBufferBeginInfo cmdBufBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .pNext = NULL,
-        .flags = 0,
-        .codeSize = fileLen,
-        .pCode = codeBuffer
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
     };
-
-    VkResult res = vkCreateShaderModule(device, &moduleCreateInfo, NULL, pShaderModule);
-    if (res != VK_SUCCESS) {
-        fprintf(stderr, "vkCreateShaderModule failed: %d\n", res);
+    result = vkBeginCommandBuffer(commandBuffer, &cmdBufBeginInfo);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", result);
     }
+    return result;
+}
 
-    free(codeBuffer);
-
-    return res;
+VkResult EndAndSubmitCommandBuffer(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer)
+{
+    VkResult result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+        return result;
+    }
+    return SubmitCommandBufferAndWait(device, queue, commandBuffer);
 }
 
 static VkResult CreateComputePipelineSimple(VkDevice device, VkShaderModule computeShaderModule, VkPipeline* pComputePipeline,
@@ -931,7 +1730,8 @@ static VkResult CreateComputePipelineSimple(VkDevice device, VkShaderModule comp
         NULL, 0, bindingCount, descriptorSetLayoutBindings
     };
 
-    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, NULL, pDescLayout);
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
@@ -957,66 +1757,18 @@ static VkResult CreateComputePipelineSimple(VkDevice device, VkShaderModule comp
         .pPushConstantRanges = pushConstRanges
     };
 
-    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, NULL, pPipelineLayout);
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreatePipelineLayout failed: %d\n", res);
         return res;
     }
 
-    const struct WorkGroupSizeType {
-        unsigned local_size_x_id;
-        unsigned local_size_y_id;
-        unsigned local_size_z_id;
-    } workGroupSize = { s_maxWorkGroupSize, 1U, 1U };
-
-    const VkSpecializationMapEntry mapEntries[3] = {
-        {
-            .constantID = 0,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_x_id),
-            .size = sizeof(workGroupSize.local_size_x_id)
-        },
-        {
-            .constantID = 1,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_y_id),
-            .size = sizeof(workGroupSize.local_size_y_id)
-        },
-        {
-            .constantID = 2,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_z_id),
-            .size = sizeof(workGroupSize.local_size_z_id)
-        }
-    };
-
-    const VkSpecializationInfo specializationInfo = {
-        .mapEntryCount = 3,
-        .pMapEntries = mapEntries,
-        .dataSize = sizeof(workGroupSize),
-        .pData = &workGroupSize
-    };
-
-    const VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-        .module = computeShaderModule,
-        .pName = "SimpleKernel",
-        .pSpecializationInfo = &specializationInfo
-    };
-
-    const VkComputePipelineCreateInfo computePipelineCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = shaderStageCreateInfo,
-        .layout = *pPipelineLayout,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = 0
-    };
-    res = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, pComputePipeline);
+    const uint32_t workGroupSize[] = { s_maxWorkGroupSize, 1U, 1U };
+    res = GetPipelineVariant(s_pipelineVariantCache, computeShaderModule, "SimpleKernel", *pPipelineLayout,
+        workGroupSize, (uint32_t)(sizeof(workGroupSize) / sizeof(workGroupSize[0])), pComputePipeline);
     if (res != VK_SUCCESS) {
-        fprintf(stderr, "vkCreateComputePipelines failed: %d\n", res);
+        fprintf(stderr, "GetPipelineVariant failed: %d\n", res);
     }
 
     return res;
@@ -1028,8 +1780,10 @@ struct Paramter4and5
     uint32_t elemCount;
 };
 
-static VkResult CreateComputePipelineAdvanced(VkDevice device, VkShaderModule computeShaderModule, int sharedMemorySize, VkPipeline* pComputePipeline,
-    VkPipelineLayout* pPipelineLayout, VkDescriptorSetLayout* pDescLayout)
+// @param sharedBufferSize: the size in bytes of the local pointer argument `sharedBuffer`
+// @param pSharedBufferElemCount: receives the element count of `sharedBuffer`, which is also passed as the kernel argument `sharedBufferElemCount`
+static VkResult CreateComputePipelineAdvanced(VkDevice device, VkShaderModule computeShaderModule, uint32_t sharedBufferSize, uint32_t* pSharedBufferElemCount,
+    VkPipeline* pComputePipeline, VkPipelineLayout* pPipelineLayout, VkDescriptorSetLayout* pDescLayout)
 {
     const VkDescriptorSetLayoutBinding descriptorSetLayoutBindings[2] = {
         {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, 0},
@@ -1041,7 +1795,8 @@ static VkResult CreateComputePipelineAdvanced(VkDevice device, VkShaderModule co
         NULL, 0, bindingCount, descriptorSetLayoutBindings
     };
 
-    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, NULL, pDescLayout);
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
@@ -1067,72 +1822,26 @@ static VkResult CreateComputePipelineAdvanced(VkDevice device, VkShaderModule co
         .pPushConstantRanges = pushConstRanges
     };
 
-    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, NULL, pPipelineLayout);
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreatePipelineLayout failed: %d\n", res);
         return res;
     }
 
-    const struct WorkGroupSizeTypeWithSharedCount {
-        unsigned local_size_x_id;
-        unsigned local_size_y_id;
-        unsigned local_size_z_id;
-        unsigned sharedCount;
-    } workGroupSizeWithSharedCount = { 256U, 1U, 1U, 128U };
-
-    const VkSpecializationMapEntry mapEntries[4] = {
-        {
-            .constantID = 0,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeTypeWithSharedCount, local_size_x_id),
-            .size = sizeof(workGroupSizeWithSharedCount.local_size_x_id)
-        },
-        {
-            .constantID = 1,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeTypeWithSharedCount, local_size_y_id),
-            .size = sizeof(workGroupSizeWithSharedCount.local_size_y_id)
-        },
-        {
-            .constantID = 2,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeTypeWithSharedCount, local_size_z_id),
-            .size = sizeof(workGroupSizeWithSharedCount.local_size_z_id)
-        },
-        {
-            .constantID = 3,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeTypeWithSharedCount, sharedCount),
-            .size = sizeof(workGroupSizeWithSharedCount.sharedCount)
-        }
-    };
-
-    const VkSpecializationInfo specializationInfo = {
-        .mapEntryCount = 4,
-        .pMapEntries = mapEntries,
-        .dataSize = sizeof(workGroupSizeWithSharedCount),
-        .pData = &workGroupSizeWithSharedCount
-    };
-
-    const VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-        .module = computeShaderModule,
-        .pName = "AdvanceKernel",
-        .pSpecializationInfo = &specializationInfo
-    };
+    // The specialization constant ID and the element size of `sharedBuffer` come from the reflection information of the module
+    struct ClspvKernelReflection reflection;
+    if (!LoadClspvKernelReflection("shaders/advance/advance.spv", "AdvanceKernel", &reflection))
+    {
+        fprintf(stderr, "LoadClspvKernelReflection failed!\n");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
 
-    const VkComputePipelineCreateInfo computePipelineCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = shaderStageCreateInfo,
-        .layout = *pPipelineLayout,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = 0
-    };
-    res = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, pComputePipeline);
+    const uint32_t workGroupSize[] = { 256U, 1U, 1U };
+    res = GetClspvKernelPipeline(s_pipelineVariantCache, computeShaderModule, "AdvanceKernel", *pPipelineLayout, &reflection, workGroupSize,
+        &sharedBufferSize, 1, &s_deviceLimits, pComputePipeline, pSharedBufferElemCount);
     if (res != VK_SUCCESS) {
-        fprintf(stderr, "vkCreateComputePipelines failed: %d\n", res);
+        fprintf(stderr, "GetClspvKernelPipeline failed: %d\n", res);
     }
 
     return res;
@@ -1151,7 +1860,8 @@ static VkResult CreateComputePipelineCLSPVSpec(VkDevice device, VkShaderModule c
         NULL, 0, bindingCount, descriptorSetLayoutBindings
     };
 
-    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, NULL, pDescLayout);
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
@@ -1177,117 +1887,24 @@ static VkResult CreateComputePipelineCLSPVSpec(VkDevice device, VkShaderModule c
         .pPushConstantRanges = pushConstRanges
     };
 
-    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, NULL, pPipelineLayout);
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreatePipelineLayout failed: %d\n", res);
         return res;
     }
 
-    // Create VkComputePipelineCreateInfo for IncKernel
-    const struct WorkGroupSizeType {
-        unsigned local_size_x_id;
-        unsigned local_size_y_id;
-        unsigned local_size_z_id;
-    } workGroupSizeForInc = { maxWorkGroupSizeForInc, 1U, 1U };
-
-    const VkSpecializationMapEntry mapEntriesForInc[3] = {
-        {
-            .constantID = 0,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_x_id),
-            .size = sizeof(workGroupSizeForInc.local_size_x_id)
-        },
-        {
-            .constantID = 1,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_y_id),
-            .size = sizeof(workGroupSizeForInc.local_size_y_id)
-        },
-        {
-            .constantID = 2,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_z_id),
-            .size = sizeof(workGroupSizeForInc.local_size_z_id)
-        }
-    };
-
-    const VkSpecializationInfo specializationInfoForInc = {
-        .mapEntryCount = 3,
-        .pMapEntries = mapEntriesForInc,
-        .dataSize = sizeof(workGroupSizeForInc),
-        .pData = &workGroupSizeForInc
-    };
-
-    const VkPipelineShaderStageCreateInfo shaderStageCreateInfoForInc = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-        .module = computeShaderModule,
-        .pName = "IncKernel",
-        .pSpecializationInfo = &specializationInfoForInc
-    };
-
-    const VkComputePipelineCreateInfo computePipelineCreateInfoForInc = {
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = shaderStageCreateInfoForInc,
-        .layout = *pPipelineLayout,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = 0
-    };
-
-    // Create VkComputePipelineCreateInfo for DoubleKernel
-    const struct WorkGroupSizeType workGroupSizeForDouble = { maxWorkGroupSizeForDouble, 1U, 1U };
-
-    const VkSpecializationMapEntry mapEntriesForDouble[3] = {
-        {
-            .constantID = 0,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_x_id),
-            .size = sizeof(workGroupSizeForDouble.local_size_x_id)
-        },
-        {
-            .constantID = 1,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_y_id),
-            .size = sizeof(workGroupSizeForDouble.local_size_y_id)
-        },
-        {
-            .constantID = 2,
-            .offset = (uint32_t)offsetof(struct WorkGroupSizeType, local_size_z_id),
-            .size = sizeof(workGroupSizeForDouble.local_size_z_id)
-        }
-    };
-
-    const VkSpecializationInfo specializationInfoForDouble = {
-        .mapEntryCount = 3,
-        .pMapEntries = mapEntriesForDouble,
-        .dataSize = sizeof(workGroupSizeForDouble),
-        .pData = &workGroupSizeForDouble
-    };
-
-    const VkPipelineShaderStageCreateInfo shaderStageCreateInfoForDouble = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = VK_SHADER_STAGE_COMPUTE_BIT,
-        .module = computeShaderModule,
-        .pName = "DoubleKernel",
-        .pSpecializationInfo = &specializationInfoForDouble
-    };
-
-    const VkComputePipelineCreateInfo computePipelineCreateInfoForDouble = {
-        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .stage = shaderStageCreateInfoForDouble,
-        .layout = *pPipelineLayout,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = 0
-    };
-
-    res = vkCreateComputePipelines(device, VK_NULL_HANDLE, 2,
-        (const VkComputePipelineCreateInfo[]) { computePipelineCreateInfoForInc, computePipelineCreateInfoForDouble }, NULL, computePipelines);
+    const uint32_t workGroupSizeForInc[] = { maxWorkGroupSizeForInc, 1U, 1U };
+    res = GetPipelineVariant(s_pipelineVariantCache, computeShaderModule, "IncKernel", *pPipelineLayout,
+        workGroupSizeForInc, (uint32_t)(sizeof(workGroupSizeForInc) / sizeof(workGroupSizeForInc[0])), &computePipelines[0]);
+    if (res == VK_SUCCESS)
+    {
+        const uint32_t workGroupSizeForDouble[] = { maxWorkGroupSizeForDouble, 1U, 1U };
+        res = GetPipelineVariant(s_pipelineVariantCache, computeShaderModule, "DoubleKernel", *pPipelineLayout,
+            workGroupSizeForDouble, (uint32_t)(sizeof(workGroupSizeForDouble) / sizeof(workGroupSizeForDouble[0])), &computePipelines[1]);
+    }
     if (res != VK_SUCCESS) {
-        fprintf(stderr, "vkCreateComputePipelines failed: %d\n", res);
+        fprintf(stderr, "GetPipelineVariant failed: %d\n", res);
     }
 
     return res;
@@ -1306,7 +1923,7 @@ static VkResult CreateDescriptorSets(VkDevice device, const VkBuffer deviceBuffe
             {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 2}
         }
     };
-    VkResult res = vkCreateDescriptorPool(device, &descriptorPoolInfo, NULL, pDescriptorPool);
+    VkResult res = vkCreateDescriptorPool(device, &descriptorPoolInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), pDescriptorPool);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateDescriptorPool failed: %d\n", res);
@@ -1383,8 +2000,16 @@ static VkResult InitializeInstanceAndeDevice(void)
     }
 
     result = InitializeDevice(VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, &s_memoryProperties);
-    if (result != VK_SUCCESS) {
+    if (result != VK_SUCCESS)
+    {
         fprintf(stderr, "InitializeDevice failed!\n");
+        return result;
+    }
+
+    // Without the result slab, all the transfers take the staging path.
+    if (CreateResultSlab(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, RESULT_SLAB_BLOCK_SIZE * RESULT_SLAB_MAX_BLOCK_COUNT,
+        &s_resultSlab) != VK_SUCCESS) {
+        fprintf(stderr, "CreateResultSlab failed!\n");
     }
 
     return result;
@@ -1392,11 +2017,26 @@ static VkResult InitializeInstanceAndeDevice(void)
 
 static void DestroyInstanceAndDevice(void)
 {
-    if (s_specDevice != VK_NULL_HANDLE) {
-        vkDestroyDevice(s_specDevice, NULL);
+    if (s_fencePool != NULL)
+    {
+        struct ObjectPoolStats fenceStats;
+        GetFencePoolStats(s_fencePool, &fenceStats);
+        printf("Shared fence pool: %llu fences created for %llu acquisitions, %u at most in use\n", (unsigned long long)fenceStats.createdCount,
+            (unsigned long long)(fenceStats.createdCount + fenceStats.reusedCount), fenceStats.peakLiveCount);
+        DestroyFencePool(s_fencePool);
+    }
+    DestroyResultSlab(s_resultSlab);
+    DestroyPipelineVariantCache(s_pipelineVariantCache);
+    if (s_pipelineCache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(s_specDevice, s_pipelineCache, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_CACHE));
+    }
+    if (s_specDevice != VK_NULL_HANDLE)
+    {
+        UnregisterMemoryBudgetDevice(s_specDevice);
+        vkDestroyDevice(s_specDevice, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE));
     }
     if (s_instance != VK_NULL_HANDLE) {
-        vkDestroyInstance(s_instance, NULL);
+        vkDestroyInstance(s_instance, GetHostAllocationCallbacks(VK_OBJECT_TYPE_INSTANCE));
     }
 }
 
@@ -1404,7 +2044,7 @@ static void SimpleComputeTest(void)
 {
     puts("\n================ Begin simple OpenCL with SPIR-V test ================\n");
 
-    VkDeviceMemory deviceMemories[2] = { VK_NULL_HANDLE };
+    VkDeviceMemory deviceMemories[3] = { VK_NULL_HANDLE };
     // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer
     VkBuffer deviceBuffers[3] = { VK_NULL_HANDLE };
     VkShaderModule computeShaderModule = VK_NULL_HANDLE;
@@ -1415,6 +2055,7 @@ static void SimpleComputeTest(void)
     VkCommandPool commandPool = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
     VkFence fence = VK_NULL_HANDLE;
+    bool fenceWaitFailed = false;
     uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
 
     do
@@ -1496,15 +2137,10 @@ static void SimpleComputeTest(void)
             break;
         }
 
-        const VkFenceCreateInfo fenceCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0
-        };
-        result = vkCreateFence(s_specDevice, &fenceCreateInfo, NULL, &fence);
+        result = AcquirePooledFence(s_fencePool, &fence);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
             break;
         }
 
@@ -1530,6 +2166,7 @@ static void SimpleComputeTest(void)
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            fenceWaitFailed = true;
             break;
         }
 
@@ -1542,13 +2179,9 @@ static void SimpleComputeTest(void)
             break;
         }
         int* dstMem = hostBuffer;
-        for (int i = 0; i < (int)elemCount; i++)
-        {
-            if (dstMem[i] != i + 100)
-            {
-                fprintf(stderr, "Result error @ %d, result is: %d\n", i, dstMem[i]);
-                break;
-            }
+        const size_t errIndex = HostParallelFindMismatch(dstMem, elemCount, 100, 1);
+        if (errIndex != SIZE_MAX) {
+            fprintf(stderr, "Result error @ %d, result is: %d\n", (int)errIndex, dstMem[errIndex]);
         }
         printf("The first 5 elements sum = %d\n", dstMem[0] + dstMem[1] + dstMem[2] + dstMem[3] + dstMem[4]);
 
@@ -1556,40 +2189,43 @@ static void SimpleComputeTest(void)
 
     } while (false);
 
-    if (fence != VK_NULL_HANDLE) {
-        vkDestroyFence(s_specDevice, fence, NULL);
+    if (fenceWaitFailed) {
+        DiscardPooledFence(s_fencePool, fence);
+    }
+    else {
+        ReleasePooledFence(s_fencePool, fence);
     }
     if (commandPool != VK_NULL_HANDLE)
     {
         vkFreeCommandBuffers(s_specDevice, commandPool, commandBufferCount, commandBuffers);
-        vkDestroyCommandPool(s_specDevice, commandPool, NULL);
+        vkDestroyCommandPool(s_specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
     }
     if (descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(s_specDevice, descriptorPool, NULL);
+        vkDestroyDescriptorPool(s_specDevice, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
     }
     if (descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, NULL);
+        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
     }
     if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, NULL);
-    }
-    if (computePipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(s_specDevice, computePipeline, NULL);
+        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
     }
-    if (computeShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(s_specDevice, computeShaderModule, NULL);
+    // `computePipeline` belongs to the pipeline variant cache
+    if (computeShaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(s_pipelineVariantCache, computeShaderModule);
+        vkDestroyShaderModule(s_specDevice, computeShaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
     }
 
     for (size_t i = 0; i < sizeof(deviceBuffers) / sizeof(deviceBuffers[0]); i++)
     {
         if (deviceBuffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, deviceBuffers[i], NULL);
+            vkDestroyBuffer(s_specDevice, deviceBuffers[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
         }
     }
     for (size_t i = 0; i < sizeof(deviceMemories) / sizeof(deviceMemories[0]); i++)
     {
         if (deviceMemories[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(s_specDevice, deviceMemories[i], NULL);
+            FreeDeviceMemory(s_specDevice, deviceMemories[i]);
         }
     }
 
@@ -1600,9 +2236,13 @@ static void AdvancedComputeTest(void)
 {
     puts("================ Begin advanced OpenCL with SPIR-V test ================\n");
 
-    VkDeviceMemory deviceMemories[2] = { VK_NULL_HANDLE };
-    // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer
+    VkDeviceMemory deviceMemories[3] = { VK_NULL_HANDLE };
+    // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer.
+    // There's no host temporal buffer on the small transfer path.
     VkBuffer deviceBuffers[3] = { VK_NULL_HANDLE };
+    // The source data and the readback range of the small transfer path
+    int* srcData = NULL;
+    struct ResultSlabRange resultRange = { 0 };
     VkShaderModule computeShaderModule = VK_NULL_HANDLE;
     VkPipeline computePipeline = VK_NULL_HANDLE;
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
@@ -1612,6 +2252,7 @@ static void AdvancedComputeTest(void)
     VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
     uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
     VkFence fence = VK_NULL_HANDLE;
+    bool fenceWaitFailed = false;
 
     if (s_instance == VK_NULL_HANDLE || s_specDevice == VK_NULL_HANDLE) {
         return;
@@ -1628,10 +2269,11 @@ static void AdvancedComputeTest(void)
             .flags = 0
         };
 
-        VkResult result = AllocateMemoryAndBuffers(s_specDevice, &s_memoryProperties, deviceMemories, deviceBuffers, bufferSize, s_specQueueFamilyIndex);
+        VkResult result = AllocateTransferBuffers(s_specDevice, &s_memoryProperties, deviceMemories, deviceBuffers, bufferSize, s_specQueueFamilyIndex,
+            &srcData, &resultRange);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "AllocateMemoryAndBuffers failed!\n");
+            fprintf(stderr, "AllocateTransferBuffers failed!\n");
             break;
         }
 
@@ -1642,7 +2284,11 @@ static void AdvancedComputeTest(void)
             break;
         }
 
-        result = CreateComputePipelineAdvanced(s_specDevice, computeShaderModule, elemCount, &computePipeline, &pipelineLayout, &descriptorSetLayout);
+        // Half of the workgroup fills `sharedBuffer`. Its element count specializes the pipeline and is passed as `sharedBufferElemCount` as well.
+        const uint32_t sharedBufferSize = 128 * sizeof(int);
+        uint32_t sharedBufferElemCount = 0;
+        result = CreateComputePipelineAdvanced(s_specDevice, computeShaderModule, sharedBufferSize, &sharedBufferElemCount,
+            &computePipeline, &pipelineLayout, &descriptorSetLayout);
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "CreateComputePipeline failed!\n");
@@ -1688,18 +2334,18 @@ static void AdvancedComputeTest(void)
 
         // PushConstant for the kernel 4th and 5th parameters -- uint sharedBufferElemCount, uint elemCount
         const struct Paramter4and5 pushConstants = {
-            .sharedBufferElemCount = 128,
+            .sharedBufferElemCount = sharedBufferElemCount,
             .elemCount = 1024
         };
         vkCmdPushConstants(commandBuffers[0], pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
             0, sizeof(pushConstants), &pushConstants);
 
         ClearDeviceBuffer(commandBuffers[0], deviceBuffers[1], bufferSize);
-        WriteBufferAndSync(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers[2], deviceBuffers[0], bufferSize);
+        WriteSourceAndSync(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers, srcData, bufferSize);
 
         vkCmdDispatch(commandBuffers[0], elemCount / 256, 1, 1);
 
-        SyncAndReadBuffer(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers[0], deviceBuffers[1], bufferSize);
+        SyncAndReadDestination(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers, &resultRange, bufferSize);
 
         result = vkEndCommandBuffer(commandBuffers[0]);
         if (result != VK_SUCCESS)
@@ -1708,15 +2354,10 @@ static void AdvancedComputeTest(void)
             break;
         }
 
-        const VkFenceCreateInfo fenceCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0
-        };
-        result = vkCreateFence(s_specDevice, &fenceCreateInfo, NULL, &fence);
+        result = AcquirePooledFence(s_fencePool, &fence);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
             break;
         }
 
@@ -1742,30 +2383,34 @@ static void AdvancedComputeTest(void)
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            fenceWaitFailed = true;
             break;
         }
 
         // Verify the result
-        void* hostBuffer = NULL;
-        result = vkMapMemory(s_specDevice, deviceMemories[0], 0, bufferSize, 0, &hostBuffer);
-        if (result != VK_SUCCESS)
+        void* hostBuffer = resultRange.pHostData;
+        if (hostBuffer == NULL)
         {
-            fprintf(stderr, "vkMapMemory failed: %d\n", result);
-            break;
+            result = vkMapMemory(s_specDevice, deviceMemories[0], 0, bufferSize, 0, &hostBuffer);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "vkMapMemory failed: %d\n", result);
+                break;
+            }
         }
         int* dstMem = hostBuffer;
         bool successful = true;
         for (int group = 0, startIndex = 0; group < 4; ++group, startIndex += 256)
         {
             int sum = 0;
-            for (int i = 0; i < 128; i++) {
+            for (int i = 0; i < (int)sharedBufferElemCount; i++) {
                 sum += startIndex + i;
             }
 
             for (int i = 0; i < 256; i++)
             {
                 const int index = i + startIndex;
-                const int value = (index % 256) < 128 ? sum : 0;
+                const int value = (index % 256) < (int)sharedBufferElemCount ? sum : 0;
                 if (dstMem[index] != (index + value) * 8)
                 {
                     fprintf(stderr, "Result error @ %d, result is: %d, correct is: %d\n", index, dstMem[index], (index + value) * 8);
@@ -1778,52 +2423,60 @@ static void AdvancedComputeTest(void)
 
         printf("The first 5 elements sum = %d\n", dstMem[0] + dstMem[1] + dstMem[2] + dstMem[3] + dstMem[4]);
 
-        vkUnmapMemory(s_specDevice, deviceMemories[0]);
+        if (resultRange.pHostData == NULL) {
+            vkUnmapMemory(s_specDevice, deviceMemories[0]);
+        }
 
         // Here, we use a fence to ensure the queue has been completed before destroying the Vulkan resources.
         result = vkWaitForFences(s_specDevice, 1, &fence, VK_TRUE, UINT64_MAX);
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            fenceWaitFailed = true;
             break;
         }
 
     } while (false);
 
-    if (fence != VK_NULL_HANDLE) {
-        vkDestroyFence(s_specDevice, fence, NULL);
+    free(srcData);
+    ReleaseResultSlabRange(s_resultSlab, &resultRange);
+    if (fenceWaitFailed) {
+        DiscardPooledFence(s_fencePool, fence);
+    }
+    else {
+        ReleasePooledFence(s_fencePool, fence);
     }
     if (commandPool != VK_NULL_HANDLE)
     {
         vkFreeCommandBuffers(s_specDevice, commandPool, commandBufferCount, commandBuffers);
-        vkDestroyCommandPool(s_specDevice, commandPool, NULL);
+        vkDestroyCommandPool(s_specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
     }
     if (descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(s_specDevice, descriptorPool, NULL);
+        vkDestroyDescriptorPool(s_specDevice, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
     }
     if (descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, NULL);
+        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
     }
     if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, NULL);
+        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
     }
-    if (computePipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(s_specDevice, computePipeline, NULL);
-    }
-    if (computeShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(s_specDevice, computeShaderModule, NULL);
+    // `computePipeline` belongs to the pipeline variant cache
+    if (computeShaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(s_pipelineVariantCache, computeShaderModule);
+        vkDestroyShaderModule(s_specDevice, computeShaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
     }
 
     for (size_t i = 0; i < sizeof(deviceBuffers) / sizeof(deviceBuffers[0]); i++)
     {
         if (deviceBuffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, deviceBuffers[i], NULL);
+            vkDestroyBuffer(s_specDevice, deviceBuffers[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
         }
     }
     for (size_t i = 0; i < sizeof(deviceMemories) / sizeof(deviceMemories[0]); i++)
     {
         if (deviceMemories[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(s_specDevice, deviceMemories[i], NULL);
+            FreeDeviceMemory(s_specDevice, deviceMemories[i]);
         }
     }
 
@@ -1834,9 +2487,13 @@ static void CLSPVSpecComputeTest(void)
 {
     puts("\n================ Begin OpenCL with SPIR-V specific test ================\n");
 
-    VkDeviceMemory deviceMemories[2] = { VK_NULL_HANDLE };
-    // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer
+    VkDeviceMemory deviceMemories[3] = { VK_NULL_HANDLE };
+    // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer.
+    // There's no host temporal buffer on the small transfer path.
     VkBuffer deviceBuffers[3] = { VK_NULL_HANDLE };
+    // The source data and the readback range of the small transfer path
+    int* srcData = NULL;
+    struct ResultSlabRange resultRange = { 0 };
     VkShaderModule computeShaderModule = VK_NULL_HANDLE;
     VkPipeline computePipelines[2] = { VK_NULL_HANDLE };
     VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
@@ -1846,6 +2503,7 @@ static void CLSPVSpecComputeTest(void)
     VkCommandPool commandPool = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
     VkFence fence = VK_NULL_HANDLE;
+    bool fenceWaitFailed = false;
     uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
 
     do
@@ -1853,10 +2511,11 @@ static void CLSPVSpecComputeTest(void)
         const uint32_t elemCount = 256;
         const VkDeviceSize bufferSize = elemCount * sizeof(int);
 
-        VkResult result = AllocateMemoryAndBuffers(s_specDevice, &s_memoryProperties, deviceMemories, deviceBuffers, bufferSize, s_specQueueFamilyIndex);
+        VkResult result = AllocateTransferBuffers(s_specDevice, &s_memoryProperties, deviceMemories, deviceBuffers, bufferSize, s_specQueueFamilyIndex,
+            &srcData, &resultRange);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "AllocateMemoryAndBuffers failed!\n");
+            fprintf(stderr, "AllocateTransferBuffers failed!\n");
             break;
         }
 
@@ -1935,7 +2594,7 @@ static void CLSPVSpecComputeTest(void)
         vkCmdPushConstants(commandBuffers[0], pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(elemCount), &elemCount);
 
         ClearDeviceBuffer(commandBuffers[0], deviceBuffers[1], bufferSize);
-        WriteBufferAndSync(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers[2], deviceBuffers[0], bufferSize);
+        WriteSourceAndSync(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers, srcData, bufferSize);
 
         vkCmdDispatch(commandBuffers[0], elemCount / maxWorkGroupSizeForInc, 1, 1);
 
@@ -1946,7 +2605,7 @@ static void CLSPVSpecComputeTest(void)
         vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSetForDouble, 0, NULL);
         vkCmdDispatch(commandBuffers[0], elemCount / maxWorkGroupSizeForDouble, 1, 1);
 
-        SyncAndReadBuffer(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers[0], deviceBuffers[1], bufferSize);
+        SyncAndReadDestination(commandBuffers[0], s_specQueueFamilyIndex, deviceBuffers, &resultRange, bufferSize);
 
         result = vkEndCommandBuffer(commandBuffers[0]);
         if (result != VK_SUCCESS)
@@ -1955,15 +2614,10 @@ static void CLSPVSpecComputeTest(void)
             break;
         }
 
-        const VkFenceCreateInfo fenceCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0
-        };
-        result = vkCreateFence(s_specDevice, &fenceCreateInfo, NULL, &fence);
+        result = AcquirePooledFence(s_fencePool, &fence);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
             break;
         }
 
@@ -1989,72 +2643,77 @@ static void CLSPVSpecComputeTest(void)
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            fenceWaitFailed = true;
             break;
         }
 
         // Verify the result
-        void* hostBuffer = NULL;
-        result = vkMapMemory(s_specDevice, deviceMemories[0], 0, bufferSize, 0, &hostBuffer);
-        if (result != VK_SUCCESS)
-        {
-            fprintf(stderr, "vkMapMemory failed: %d\n", result);
-            break;
-        }
-        int* dstMem = hostBuffer;
-        for (int i = 2; i < (int)elemCount; i++)
+        void* hostBuffer = resultRange.pHostData;
+        if (hostBuffer == NULL)
         {
-            if (dstMem[i] != (i + 256) * 2)
+            result = vkMapMemory(s_specDevice, deviceMemories[0], 0, bufferSize, 0, &hostBuffer);
+            if (result != VK_SUCCESS)
             {
-                fprintf(stderr, "Result error @ %d, result is: %d\n", i, dstMem[i]);
+                fprintf(stderr, "vkMapMemory failed: %d\n", result);
                 break;
             }
         }
+        int* dstMem = hostBuffer;
+        // The first two elements hold the workgroup sizes, and dstMem[i] == (i + 256) * 2 for the rest.
+        const size_t errIndex = HostParallelFindMismatch(dstMem + 2, elemCount - 2, 2 + 256, 2);
+        if (errIndex != SIZE_MAX) {
+            fprintf(stderr, "Result error @ %d, result is: %d\n", (int)errIndex + 2, dstMem[errIndex + 2]);
+        }
         printf("IncKernel workgroup size = %d; DoubleKernel workgroup size: %d\n", dstMem[0], dstMem[1]);
 
-        vkUnmapMemory(s_specDevice, deviceMemories[0]);
+        if (resultRange.pHostData == NULL) {
+            vkUnmapMemory(s_specDevice, deviceMemories[0]);
+        }
 
     } while (false);
 
-    if (fence != VK_NULL_HANDLE) {
-        vkDestroyFence(s_specDevice, fence, NULL);
+    free(srcData);
+    ReleaseResultSlabRange(s_resultSlab, &resultRange);
+    if (fenceWaitFailed) {
+        DiscardPooledFence(s_fencePool, fence);
+    }
+    else {
+        ReleasePooledFence(s_fencePool, fence);
     }
     if (commandPool != VK_NULL_HANDLE)
     {
         vkFreeCommandBuffers(s_specDevice, commandPool, commandBufferCount, commandBuffers);
-        vkDestroyCommandPool(s_specDevice, commandPool, NULL);
+        vkDestroyCommandPool(s_specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
     }
     if (descriptorPoolForInc != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(s_specDevice, descriptorPoolForInc, NULL);
+        vkDestroyDescriptorPool(s_specDevice, descriptorPoolForInc, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
     }
     if (descriptorPoolForDouble != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(s_specDevice, descriptorPoolForDouble, NULL);
+        vkDestroyDescriptorPool(s_specDevice, descriptorPoolForDouble, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
     }
     if (descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, NULL);
+        vkDestroyDescriptorSetLayout(s_specDevice, descriptorSetLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
     }
     if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, NULL);
+        vkDestroyPipelineLayout(s_specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
     }
-    for (size_t i = 0; i < sizeof(computePipelines) / sizeof(computePipelines[0]); ++i)
+    // `computePipelines` belong to the pipeline variant cache
+    if (computeShaderModule != VK_NULL_HANDLE)
     {
-        if (computePipelines[i] != VK_NULL_HANDLE) {
-            vkDestroyPipeline(s_specDevice, computePipelines[i], NULL);
-        }
-    }
-    if (computeShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(s_specDevice, computeShaderModule, NULL);
+        RemovePipelineVariantsOfModule(s_pipelineVariantCache, computeShaderModule);
+        vkDestroyShaderModule(s_specDevice, computeShaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
     }
 
     for (size_t i = 0; i < sizeof(deviceBuffers) / sizeof(deviceBuffers[0]); i++)
     {
         if (deviceBuffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, deviceBuffers[i], NULL);
+            vkDestroyBuffer(s_specDevice, deviceBuffers[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
         }
     }
     for (size_t i = 0; i < sizeof(deviceMemories) / sizeof(deviceMemories[0]); i++)
     {
         if (deviceMemories[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(s_specDevice, deviceMemories[i], NULL);
+            FreeDeviceMemory(s_specDevice, deviceMemories[i]);
         }
     }
 
@@ -2064,16 +2723,121 @@ static void CLSPVSpecComputeTest(void)
 extern void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
     uint32_t specQueueFamilyIndex, uint32_t maxWorkGroupSize);
 
+extern void SgemmComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+extern void ConvolutionComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceFeatures* pFeatures, bool supportCustomBorderColor,
+    uint32_t baseWidth, uint32_t baseHeight);
+
 int main(int argc, const char* argv[])
 {
+    // --allocation-callbacks passes the VkAllocationCallbacks of host_allocator.h to the Vulkan objects, and prints their statistics at exit.
+    bool useAllocationCallbacks = false;
+    // --no-dedicated-allocation sub-allocates every buffer that the implementation does not require to be dedicated.
+    // --external-memory-consumer=<socket fd> runs only the importer of the external memory test, which starts this program with it.
+    int externalMemoryConsumerSocket = -1;
+    // --daemon[=<socket path>] serves compute jobs on the socket instead of running the tests, until a client asks it to exit.
+    // --daemon-client[=<socket path>] measures the per-job latency of a running daemon without creating a Vulkan instance.
+    const char* daemonSocketPath = NULL;
+    const char* daemonClientSocketPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--allocation-callbacks") == 0) {
+            useAllocationCallbacks = true;
+        }
+        if (strcmp(argv[i], "--no-dedicated-allocation") == 0) {
+            SetDedicatedAllocationPolicy(DEDICATED_ALLOCATION_POLICY_REQUIRED_ONLY, 0);
+        }
+        if (strncmp(argv[i], "--external-memory-consumer=", strlen("--external-memory-consumer=")) == 0) {
+            externalMemoryConsumerSocket = atoi(argv[i] + strlen("--external-memory-consumer="));
+        }
+        if (strcmp(argv[i], "--daemon") == 0) {
+            daemonSocketPath = COMPUTE_DAEMON_DEFAULT_SOCKET_PATH;
+        }
+        if (strncmp(argv[i], "--daemon=", strlen("--daemon=")) == 0) {
+            daemonSocketPath = argv[i] + strlen("--daemon=");
+        }
+        if (strcmp(argv[i], "--daemon-client") == 0) {
+            daemonClientSocketPath = COMPUTE_DAEMON_DEFAULT_SOCKET_PATH;
+        }
+        if (strncmp(argv[i], "--daemon-client=", strlen("--daemon-client=")) == 0) {
+            daemonClientSocketPath = argv[i] + strlen("--daemon-client=");
+        }
+    }
+
+    HostParallelInitialize(0);
+    if (!HostAllocatorInitialize(useAllocationCallbacks)) {
+        return 1;
+    }
+
+    if (externalMemoryConsumerSocket >= 0)
+    {
+        const int exitCode = RunExternalMemoryConsumer(externalMemoryConsumerSocket);
+        HostAllocatorFinalize();
+        HostParallelFinalize();
+        return exitCode;
+    }
+    if (daemonClientSocketPath != NULL)
+    {
+        const int exitCode = RunComputeDaemonClient(daemonClientSocketPath, false);
+        HostAllocatorFinalize();
+        HostParallelFinalize();
+        return exitCode;
+    }
+
+    if (daemonSocketPath != NULL)
+    {
+        int exitCode = 1;
+        if (InitializeInstanceAndeDevice() == VK_SUCCESS)
+        {
+            exitCode = RunComputeDaemon(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_subgroupProperties,
+                daemonSocketPath, 0);
+        }
+        DestroyInstanceAndDevice();
+        HostAllocatorFinalize();
+        HostParallelFinalize();
+        return exitCode;
+    }
+
     if (InitializeInstanceAndeDevice() == VK_SUCCESS)
     {
         if (s_supportShaderNonSemanticInfo)
         {
+            PipelineWarmupTest(s_specDevice, s_pipelineCache, &s_deviceLimits, &s_subgroupProperties, s_supportBufferDeviceAddress);
+            PipelineVariantCacheTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, s_pipelineVariantCache);
+            LaunchAdvisorTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_launchDeviceModel, s_pipelineVariantCache);
             SimpleComputeTest();
             AdvancedComputeTest();
             CLSPVSpecComputeTest();
             BufferAddressComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, s_maxWorkGroupSize);
+            SgemmComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            ScanComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_subgroupProperties);
+            if (s_supportBufferDeviceAddress) {
+                RadixSortComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_subgroupProperties);
+            }
+            else {
+                puts("The current device does not support `bufferDeviceAddress` feature that is required by the radix sort test.");
+            }
+            ConvolutionComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_deviceFeatures,
+                s_supportCustomBorderColor, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+            ElementwiseFusionComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            PersistentQueueComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_launchDeviceModel, s_pipelineVariantCache);
+            SmallTransferTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, s_resultSlab);
+            IterativeComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_launchDeviceModel, s_pipelineVariantCache,
+                s_resultSlab);
+            IndirectDispatchComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_subgroupProperties,
+                s_pipelineVariantCache);
+            MultiDeviceComputeTest(s_instance);
+            HeterogeneousComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            MemoryBudgetComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            DedicatedAllocationBenchmark(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            ExternalMemoryComputeTest(s_specPhysicalDevice, s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits,
+                s_supportExternalFd, argv[0]);
+            SubmissionQueueComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            ParallelRecordingBenchmark(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits);
+            ObjectPoolBenchmark(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, s_supportTimelineSemaphore);
+            ComputeDaemonComputeTest(s_specDevice, &s_memoryProperties, s_specQueueFamilyIndex, &s_deviceLimits, &s_subgroupProperties);
         }
         else {
             fprintf(stderr, "The current device does not support `VK_KHR_shader_non_semantic_info` feature that is required by all the tests!\n");
@@ -2081,6 +2845,10 @@ int main(int argc, const char* argv[])
     }
 
     DestroyInstanceAndDevice();
+    HostAllocatorFinalize();
+
+    HostParallelBenchmark();
+    HostParallelFinalize();
 }
 
 // 运行程序: Ctrl + F5 或调试 >“开始执行(不调试)”菜单
@@ -0,0 +1,775 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "elementwise_fusion.h"
+#include "memory_budget.h"
+
+enum
+{
+    MEMORY_BUDGET_MAX_DEVICE_COUNT = 8,
+
+    // Without `VK_EXT_memory_budget`, the budget of a heap is this part of its size, in percent
+    MEMORY_BUDGET_HEAP_SIZE_PERCENT = 80,
+    // The implementation is queried again once our own usage of a heap has moved by this part of its budget since the last query,
+    // or when the last query is older than the interval, so that the pressure of the other processes is seen as well
+    MEMORY_BUDGET_REQUERY_DIVISOR = 16,
+    MEMORY_BUDGET_REQUERY_INTERVAL = 100 * 1000 * 1000,
+
+    MEMORY_BUDGET_INITIAL_ALLOCATION_CAPACITY = 64,
+
+    MEMORY_BUDGET_TEST_ELEM_COUNT = 1 << 22,
+    MEMORY_BUDGET_TEST_BUFFER_COUNT = 4,
+    // The chunks of the chained run are a multiple of this, and leave it to the alignment of their allocations
+    MEMORY_BUDGET_TEST_CHUNK_GRANULARITY = 1 << 16
+};
+
+struct MemoryBudgetAllocation
+{
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    uint32_t heapIndex;
+};
+
+struct MemoryBudgetDevice
+{
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    bool supportMemoryBudget;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    // Guards all the members below
+    struct HostLock* pLock;
+
+    // At the last query
+    VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize ownUsagesAtQuery[VK_MAX_MEMORY_HEAPS];
+    // The bytes allocated and freed since the last query
+    VkDeviceSize heapChanges[VK_MAX_MEMORY_HEAPS];
+    uint64_t lastQueryTime;
+    // 0 for no limit
+    VkDeviceSize heapLimits[VK_MAX_MEMORY_HEAPS];
+
+    VkDeviceSize ownUsages[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize ownPeakUsages[VK_MAX_MEMORY_HEAPS];
+    uint32_t ownAllocationCounts[VK_MAX_MEMORY_HEAPS];
+    // The live allocations, to account vkFreeMemory to their heaps
+    struct MemoryBudgetAllocation* allocations;
+    uint32_t allocationCount;
+    uint32_t allocationCapacity;
+
+    uint64_t queryCount;
+    uint64_t fallbackCount;
+    uint64_t overBudgetCount;
+    uint64_t failureCount;
+};
+
+static struct MemoryBudgetDevice s_devices[MEMORY_BUDGET_MAX_DEVICE_COUNT];
+
+static struct MemoryBudgetDevice* FindMemoryBudgetDevice(VkDevice device)
+{
+    if (device == VK_NULL_HANDLE) return NULL;
+
+    for (uint32_t i = 0; i < MEMORY_BUDGET_MAX_DEVICE_COUNT; i++)
+    {
+        if (s_devices[i].device == device) {
+            return &s_devices[i];
+        }
+    }
+    return NULL;
+}
+
+// The lock of the device must be held.
+static void QueryMemoryBudget(struct MemoryBudgetDevice* pDevice)
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+        .pNext = &budgetProperties
+    };
+    if (pDevice->supportMemoryBudget) {
+        vkGetPhysicalDeviceMemoryProperties2(pDevice->physicalDevice, &memoryProperties2);
+    }
+
+    for (uint32_t i = 0; i < pDevice->memoryProperties.memoryHeapCount; i++)
+    {
+        VkDeviceSize budget, usage;
+        if (pDevice->supportMemoryBudget && budgetProperties.heapBudget[i] > 0)
+        {
+            budget = budgetProperties.heapBudget[i];
+            usage = budgetProperties.heapUsage[i];
+        }
+        else
+        {
+            budget = pDevice->memoryProperties.memoryHeaps[i].size / 100 * MEMORY_BUDGET_HEAP_SIZE_PERCENT;
+            usage = pDevice->ownUsages[i];
+        }
+        if (pDevice->heapLimits[i] != 0 && pDevice->heapLimits[i] < budget) {
+            budget = pDevice->heapLimits[i];
+        }
+
+        pDevice->heapBudgets[i] = budget;
+        pDevice->heapUsages[i] = usage;
+        pDevice->ownUsagesAtQuery[i] = pDevice->ownUsages[i];
+        pDevice->heapChanges[i] = 0;
+    }
+    pDevice->lastQueryTime = HostGetTimeNanoseconds();
+    pDevice->queryCount++;
+}
+
+// Queries the implementation again if our own usage has moved or the last query is old. The lock of the device must be held.
+static void RefreshMemoryBudget(struct MemoryBudgetDevice* pDevice)
+{
+    bool stale = HostGetTimeNanoseconds() - pDevice->lastQueryTime >= MEMORY_BUDGET_REQUERY_INTERVAL;
+    for (uint32_t i = 0; i < pDevice->memoryProperties.memoryHeapCount && !stale; i++) {
+        stale = pDevice->heapChanges[i] > pDevice->heapBudgets[i] / MEMORY_BUDGET_REQUERY_DIVISOR;
+    }
+    if (stale) {
+        QueryMemoryBudget(pDevice);
+    }
+}
+
+// The usage at the last query, moved by our own allocations since then. The lock of the device must be held.
+static VkDeviceSize GetHeapAvailableBudget(const struct MemoryBudgetDevice* pDevice, uint32_t heapIndex)
+{
+    VkDeviceSize usage = pDevice->heapUsages[heapIndex] + pDevice->ownUsages[heapIndex];
+    usage = usage > pDevice->ownUsagesAtQuery[heapIndex] ? usage - pDevice->ownUsagesAtQuery[heapIndex] : 0;
+    return pDevice->heapBudgets[heapIndex] > usage ? pDevice->heapBudgets[heapIndex] - usage : 0;
+}
+
+bool RegisterMemoryBudgetDevice(VkPhysicalDevice physicalDevice, VkDevice device, bool supportMemoryBudget)
+{
+    struct MemoryBudgetDevice* pDevice = NULL;
+    for (uint32_t i = 0; i < MEMORY_BUDGET_MAX_DEVICE_COUNT && pDevice == NULL; i++)
+    {
+        if (s_devices[i].device == VK_NULL_HANDLE) {
+            pDevice = &s_devices[i];
+        }
+    }
+    if (pDevice == NULL)
+    {
+        fprintf(stderr, "More than %d devices track their memory budget!\n", MEMORY_BUDGET_MAX_DEVICE_COUNT);
+        return false;
+    }
+
+    memset(pDevice, 0, sizeof(*pDevice));
+    pDevice->pLock = HostLockCreate();
+    pDevice->allocations = malloc(MEMORY_BUDGET_INITIAL_ALLOCATION_CAPACITY * sizeof(*pDevice->allocations));
+    if (pDevice->pLock == NULL || pDevice->allocations == NULL)
+    {
+        fprintf(stderr, "Lack of system memory!\n");
+        HostLockDestroy(pDevice->pLock);
+        free(pDevice->allocations);
+        memset(pDevice, 0, sizeof(*pDevice));
+        return false;
+    }
+    pDevice->allocationCapacity = MEMORY_BUDGET_INITIAL_ALLOCATION_CAPACITY;
+    pDevice->physicalDevice = physicalDevice;
+    pDevice->supportMemoryBudget = supportMemoryBudget;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &pDevice->memoryProperties);
+    QueryMemoryBudget(pDevice);
+    pDevice->device = device;
+    return true;
+}
+
+void UnregisterMemoryBudgetDevice(VkDevice device)
+{
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL) return;
+
+    if (pDevice->allocationCount > 0) {
+        fprintf(stderr, "%u device memory allocation(s) have not been freed!\n", pDevice->allocationCount);
+    }
+    HostLockDestroy(pDevice->pLock);
+    free(pDevice->allocations);
+    memset(pDevice, 0, sizeof(*pDevice));
+}
+
+void UpdateMemoryBudget(VkDevice device)
+{
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL) return;
+
+    HostLockAcquire(pDevice->pLock);
+    QueryMemoryBudget(pDevice);
+    HostLockRelease(pDevice->pLock);
+}
+
+void SetMemoryBudgetLimit(VkDevice device, uint32_t heapIndex, VkDeviceSize limit)
+{
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL || heapIndex >= pDevice->memoryProperties.memoryHeapCount) return;
+
+    HostLockAcquire(pDevice->pLock);
+    pDevice->heapLimits[heapIndex] = limit;
+    QueryMemoryBudget(pDevice);
+    HostLockRelease(pDevice->pLock);
+}
+
+VkDeviceSize GetAvailableMemoryBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    VkMemoryPropertyFlags requiredFlags)
+{
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice != NULL)
+    {
+        HostLockAcquire(pDevice->pLock);
+        RefreshMemoryBudget(pDevice);
+    }
+
+    VkDeviceSize available = 0;
+    for (uint32_t i = 0; i < pMemoryProperties->memoryTypeCount; i++)
+    {
+        if ((pMemoryProperties->memoryTypes[i].propertyFlags & requiredFlags) != requiredFlags) continue;
+
+        const uint32_t heapIndex = pMemoryProperties->memoryTypes[i].heapIndex;
+        const VkDeviceSize heapAvailable = pDevice != NULL ? GetHeapAvailableBudget(pDevice, heapIndex) :
+            pMemoryProperties->memoryHeaps[heapIndex].size;
+        if (heapAvailable > available) {
+            available = heapAvailable;
+        }
+    }
+
+    if (pDevice != NULL) {
+        HostLockRelease(pDevice->pLock);
+    }
+    return available;
+}
+
+uint32_t FindMemoryTypeIndexWithinBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t memoryTypeBits,
+    VkMemoryPropertyFlags requiredFlags, VkDeviceSize size)
+{
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice != NULL)
+    {
+        HostLockAcquire(pDevice->pLock);
+        RefreshMemoryBudget(pDevice);
+    }
+
+    // The memory types come in the order of preference, so the first one with the budget is taken,
+    // unless a later type with the same property flags has more budget left on its heap.
+    uint32_t bestTypeIndex = UINT32_MAX;
+    VkDeviceSize bestAvailable = 0;
+    for (uint32_t i = 0; i < pMemoryProperties->memoryTypeCount; i++)
+    {
+        if ((memoryTypeBits & (1U << i)) == 0U) continue;
+        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[i];
+        if ((memoryType.propertyFlags & requiredFlags) != requiredFlags) continue;
+
+        const VkDeviceSize available = pDevice != NULL ? GetHeapAvailableBudget(pDevice, memoryType.heapIndex) :
+            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size;
+        if (available < size) continue;
+
+        if (bestTypeIndex == UINT32_MAX ||
+            (memoryType.propertyFlags == pMemoryProperties->memoryTypes[bestTypeIndex].propertyFlags && available > bestAvailable))
+        {
+            bestTypeIndex = i;
+            bestAvailable = available;
+        }
+    }
+
+    if (pDevice != NULL) {
+        HostLockRelease(pDevice->pLock);
+    }
+    return bestTypeIndex;
+}
+
+VkResult AllocateMemoryWithinBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    const VkMemoryRequirements* pRequirements, VkMemoryPropertyFlags requiredFlags, const void* pNext, VkDeviceMemory* pMemory,
+    uint32_t* pMemoryTypeIndex)
+{
+    *pMemory = VK_NULL_HANDLE;
+
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    const bool canFallBack = (requiredFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+    const VkMemoryPropertyFlags fallbackFlags = (requiredFlags & ~(VkMemoryPropertyFlags)VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) |
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+    bool fellBack = false;
+    uint32_t memoryTypeIndex = FindMemoryTypeIndexWithinBudget(device, pMemoryProperties, pRequirements->memoryTypeBits, requiredFlags,
+        pRequirements->size);
+    if (memoryTypeIndex == UINT32_MAX && canFallBack)
+    {
+        memoryTypeIndex = FindMemoryTypeIndexWithinBudget(device, pMemoryProperties, pRequirements->memoryTypeBits, fallbackFlags,
+            pRequirements->size);
+        fellBack = memoryTypeIndex != UINT32_MAX;
+    }
+    if (memoryTypeIndex == UINT32_MAX)
+    {
+        // Over the budget rather than failing. The implementation may still page the memory in and out.
+        memoryTypeIndex = FindMemoryTypeIndex(pMemoryProperties, pRequirements->memoryTypeBits, requiredFlags);
+        if (memoryTypeIndex == UINT32_MAX)
+        {
+            fprintf(stderr, "No memory type supports the memory property flags 0x%08X!\n", requiredFlags);
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+        }
+        if (pDevice != NULL)
+        {
+            HostLockAcquire(pDevice->pLock);
+            pDevice->overBudgetCount++;
+            HostLockRelease(pDevice->pLock);
+        }
+    }
+
+    VkMemoryAllocateInfo allocInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = pNext,
+        .allocationSize = pRequirements->size,
+        .memoryTypeIndex = memoryTypeIndex
+    };
+    VkResult res = AllocateDeviceMemory(device, &allocInfo, pMemory);
+
+    // The implementation refuses device local memory beyond what it can hold, so host visible memory is the last resort.
+    if (res == VK_ERROR_OUT_OF_DEVICE_MEMORY && canFallBack && !fellBack)
+    {
+        memoryTypeIndex = FindMemoryTypeIndex(pMemoryProperties, pRequirements->memoryTypeBits, fallbackFlags);
+        if (memoryTypeIndex != UINT32_MAX)
+        {
+            allocInfo.memoryTypeIndex = memoryTypeIndex;
+            res = AllocateDeviceMemory(device, &allocInfo, pMemory);
+            fellBack = true;
+        }
+    }
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateMemory failed: %d\n", res);
+        return res;
+    }
+
+    if (fellBack)
+    {
+        printf("Device local memory is out of budget, so %llu bytes have been allocated from memory type %u instead.\n",
+            (unsigned long long)pRequirements->size, memoryTypeIndex);
+        if (pDevice != NULL)
+        {
+            HostLockAcquire(pDevice->pLock);
+            pDevice->fallbackCount++;
+            HostLockRelease(pDevice->pLock);
+        }
+    }
+    if (pMemoryTypeIndex != NULL) {
+        *pMemoryTypeIndex = memoryTypeIndex;
+    }
+    return VK_SUCCESS;
+}
+
+VkResult AllocateDeviceMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, VkDeviceMemory* pMemory)
+{
+    const VkResult res = vkAllocateMemory(device, pAllocateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE_MEMORY), pMemory);
+
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL) return res;
+
+    HostLockAcquire(pDevice->pLock);
+    do
+    {
+        if (res != VK_SUCCESS)
+        {
+            // Other processes have taken the memory, so the budget is out of date.
+            pDevice->failureCount++;
+            QueryMemoryBudget(pDevice);
+            break;
+        }
+
+        if (pDevice->allocationCount == pDevice->allocationCapacity)
+        {
+            struct MemoryBudgetAllocation* allocations = realloc(pDevice->allocations, (size_t)pDevice->allocationCapacity * 2 * sizeof(*allocations));
+            // The memory stays valid. It is only left out of the usage.
+            if (allocations == NULL) break;
+            pDevice->allocations = allocations;
+            pDevice->allocationCapacity *= 2;
+        }
+
+        const uint32_t heapIndex = pDevice->memoryProperties.memoryTypes[pAllocateInfo->memoryTypeIndex].heapIndex;
+        pDevice->allocations[pDevice->allocationCount++] = (struct MemoryBudgetAllocation){
+            .memory = *pMemory,
+            .size = pAllocateInfo->allocationSize,
+            .heapIndex = heapIndex
+        };
+        pDevice->ownUsages[heapIndex] += pAllocateInfo->allocationSize;
+        pDevice->ownAllocationCounts[heapIndex]++;
+        pDevice->heapChanges[heapIndex] += pAllocateInfo->allocationSize;
+        if (pDevice->ownUsages[heapIndex] > pDevice->ownPeakUsages[heapIndex]) {
+            pDevice->ownPeakUsages[heapIndex] = pDevice->ownUsages[heapIndex];
+        }
+    } while (false);
+    HostLockRelease(pDevice->pLock);
+
+    return res;
+}
+
+void FreeDeviceMemory(VkDevice device, VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE) return;
+
+    vkFreeMemory(device, memory, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE_MEMORY));
+
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL) return;
+
+    HostLockAcquire(pDevice->pLock);
+    for (uint32_t i = 0; i < pDevice->allocationCount; i++)
+    {
+        if (pDevice->allocations[i].memory != memory) continue;
+
+        const struct MemoryBudgetAllocation allocation = pDevice->allocations[i];
+        pDevice->allocations[i] = pDevice->allocations[--pDevice->allocationCount];
+        pDevice->ownUsages[allocation.heapIndex] -= allocation.size;
+        pDevice->ownAllocationCounts[allocation.heapIndex]--;
+        pDevice->heapChanges[allocation.heapIndex] += allocation.size;
+        break;
+    }
+    HostLockRelease(pDevice->pLock);
+}
+
+void GetMemoryBudgetStats(VkDevice device, struct MemoryBudgetStats* pStats)
+{
+    memset(pStats, 0, sizeof(*pStats));
+
+    struct MemoryBudgetDevice* pDevice = FindMemoryBudgetDevice(device);
+    if (pDevice == NULL) return;
+
+    HostLockAcquire(pDevice->pLock);
+    RefreshMemoryBudget(pDevice);
+
+    pStats->supportMemoryBudget = pDevice->supportMemoryBudget;
+    pStats->heapCount = pDevice->memoryProperties.memoryHeapCount;
+    for (uint32_t i = 0; i < pStats->heapCount; i++)
+    {
+        pStats->heaps[i] = (struct MemoryHeapBudget){
+            .size = pDevice->memoryProperties.memoryHeaps[i].size,
+            .flags = pDevice->memoryProperties.memoryHeaps[i].flags,
+            .budget = pDevice->heapBudgets[i],
+            .usage = pDevice->heapUsages[i],
+            .available = GetHeapAvailableBudget(pDevice, i),
+            .ownUsage = pDevice->ownUsages[i],
+            .ownPeakUsage = pDevice->ownPeakUsages[i],
+            .allocationCount = pDevice->ownAllocationCounts[i]
+        };
+    }
+    pStats->queryCount = pDevice->queryCount;
+    pStats->fallbackCount = pDevice->fallbackCount;
+    pStats->overBudgetCount = pDevice->overBudgetCount;
+    pStats->failureCount = pDevice->failureCount;
+
+    HostLockRelease(pDevice->pLock);
+}
+
+void PrintMemoryBudgetStats(VkDevice device)
+{
+    struct MemoryBudgetStats stats;
+    GetMemoryBudgetStats(device, &stats);
+    if (stats.heapCount == 0)
+    {
+        puts("The device does not track its memory budget.");
+        return;
+    }
+
+    const double mebibyte = 1024.0 * 1024.0;
+    printf("Memory budget (%s):\n", stats.supportMemoryBudget ? "VK_EXT_memory_budget" : "estimated from the heap sizes");
+    for (uint32_t i = 0; i < stats.heapCount; i++)
+    {
+        const struct MemoryHeapBudget* pHeap = &stats.heaps[i];
+        printf("    heap %u%s: size %.1f MiB, budget %.1f MiB, usage %.1f MiB, available %.1f MiB, ours %.1f MiB (peak %.1f MiB) in %u allocation(s)\n",
+            i, (pHeap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 ? " (device local)" : "", (double)pHeap->size / mebibyte,
+            (double)pHeap->budget / mebibyte, (double)pHeap->usage / mebibyte, (double)pHeap->available / mebibyte,
+            (double)pHeap->ownUsage / mebibyte, (double)pHeap->ownPeakUsage / mebibyte, pHeap->allocationCount);
+    }
+    printf("    %llu quer%s, %llu host visible fallback(s), %llu allocation(s) over the budget, %llu failed allocation(s)\n",
+        (unsigned long long)stats.queryCount, stats.queryCount == 1 ? "y" : "ies", (unsigned long long)stats.fallbackCount,
+        (unsigned long long)stats.overBudgetCount, (unsigned long long)stats.failureCount);
+}
+
+// MARK: Test
+
+// Uploads [firstElem, firstElem + elemCount) of the staging buffer, runs the chain of `pPlan` and reads the result back into the same range.
+static VkResult RunMemoryBudgetChain(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer,
+    const struct ElementwiseChainPlan* pPlan, VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer stagingBuffer, uint32_t firstElem, uint32_t elemCount)
+{
+    VkResult result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+    if (result != VK_SUCCESS) return result;
+
+    const VkBufferCopy uploadRegion = {
+        .srcOffset = (VkDeviceSize)firstElem * sizeof(uint32_t),
+        .dstOffset = 0,
+        .size = (VkDeviceSize)elemCount * sizeof(uint32_t)
+    };
+    const VkBufferCopy readbackRegion = { .srcOffset = 0, .dstOffset = uploadRegion.srcOffset, .size = uploadRegion.size };
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, srcBuffer, 1, &uploadRegion);
+    RecordTransferToComputeBarrier(commandBuffer);
+    RecordElementwiseChain(commandBuffer, pPlan, elemCount);
+    RecordComputeToTransferBarrier(commandBuffer);
+    vkCmdCopyBuffer(commandBuffer, dstBuffer, stagingBuffer, 1, &readbackRegion);
+
+    return EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+}
+
+static VkResult RunMemoryBudgetChainOnBuffers(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer,
+    struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain, VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer stagingBuffer,
+    uint32_t elemCount)
+{
+    struct ElementwiseChainPlan* pPlan = NULL;
+    VkResult result = CreateElementwiseChainPlan(pContext, pChain, ELEMENTWISE_FUSION_AUTO, srcBuffer, dstBuffer, &pPlan);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+        return result;
+    }
+
+    result = RunMemoryBudgetChain(device, queue, commandPool, commandBuffer, pPlan, srcBuffer, dstBuffer, stagingBuffer, 0, elemCount);
+    DestroyElementwiseChainPlan(pPlan);
+    return result;
+}
+
+static bool VerifyMemoryBudgetChain(const struct ElementwiseChain* pChain, const uint32_t* stagingPtr, uint32_t elemCount)
+{
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        if (stagingPtr[i] != ApplyElementwiseChainOnHost(pChain, i)) return false;
+    }
+    return true;
+}
+
+// Runs the chain over the whole staging buffer with a source and a destination buffer sized by the device local budget that is left,
+// one chunk at a time, as the callers that size their working set by the budget do when it does not fit.
+static VkResult RunMemoryBudgetChainInChunks(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, struct ElementwiseContext* pContext, const struct ElementwiseChain* pChain,
+    VkBuffer stagingBuffer, uint32_t elemCount, uint32_t* pChunkCount)
+{
+    *pChunkCount = 0;
+
+    // Both buffers of a chunk have to fit, with the room for the alignment of each allocation
+    const VkDeviceSize available = GetAvailableMemoryBudget(device, pMemoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    const VkDeviceSize granularity = (VkDeviceSize)MEMORY_BUDGET_TEST_CHUNK_GRANULARITY * sizeof(uint32_t);
+    const VkDeviceSize chunkSize = available / 2 > granularity ? (available / 2 - granularity) / granularity * granularity : 0;
+    if (chunkSize == 0)
+    {
+        puts("The device local budget left cannot hold a chunk, so the chunked run will be skipped.");
+        return VK_SUCCESS;
+    }
+    const uint32_t chunkElemCount = chunkSize / sizeof(uint32_t) < elemCount ? (uint32_t)(chunkSize / sizeof(uint32_t)) : elemCount;
+    printf("%.1f MiB of the device local budget left, so the chain runs in chunks of %u elements\n", (double)available / (1024.0 * 1024.0),
+        chunkElemCount);
+
+    VkBuffer buffers[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    VkDeviceMemory memories[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    struct ElementwiseChainPlan* pPlan = NULL;
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        for (uint32_t i = 0; i < 2 && result == VK_SUCCESS; i++)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, (VkDeviceSize)chunkElemCount * sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &buffers[i], &memories[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = CreateElementwiseChainPlan(pContext, pChain, ELEMENTWISE_FUSION_AUTO, buffers[0], buffers[1], &pPlan);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+            break;
+        }
+
+        for (uint32_t firstElem = 0; firstElem < elemCount && result == VK_SUCCESS; firstElem += chunkElemCount)
+        {
+            const uint32_t count = elemCount - firstElem < chunkElemCount ? elemCount - firstElem : chunkElemCount;
+            result = RunMemoryBudgetChain(device, queue, commandPool, commandBuffer, pPlan, buffers[0], buffers[1], stagingBuffer, firstElem, count);
+            (*pChunkCount)++;
+        }
+    } while (false);
+
+    DestroyElementwiseChainPlan(pPlan);
+    for (uint32_t i = 0; i < 2; i++) {
+        DestroyBufferWithMemory(device, buffers[i], memories[i]);
+    }
+    return result;
+}
+
+void MemoryBudgetComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin memory budget test ================\n");
+
+    PrintMemoryBudgetStats(specDevice);
+
+    const uint32_t elemCount = MEMORY_BUDGET_TEST_ELEM_COUNT;
+    const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+
+    VkQueue queue = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    struct ElementwiseContext* pContext = NULL;
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    VkBuffer buffers[MEMORY_BUDGET_TEST_BUFFER_COUNT] = { VK_NULL_HANDLE };
+    VkDeviceMemory memories[MEMORY_BUDGET_TEST_BUFFER_COUNT] = { VK_NULL_HANDLE };
+    uint32_t* stagingPtr = NULL;
+    uint32_t heapIndex = UINT32_MAX;
+
+    const struct ElementwiseChain chain = {
+        4, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_XOR, ELEMENTWISE_OP_ADD }, { 11, 3, 0x3c3cU, 5 }
+    };
+
+    do
+    {
+        struct MemoryBudgetStats stats;
+        GetMemoryBudgetStats(specDevice, &stats);
+        const uint32_t deviceLocalTypeIndex = FindMemoryTypeIndex(pMemoryProperties, UINT32_MAX, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (stats.heapCount == 0 || deviceLocalTypeIndex == UINT32_MAX)
+        {
+            puts("The device tracks no device local budget, so the test will be skipped.");
+            break;
+        }
+        if (bufferSize > pLimits->maxStorageBufferRange)
+        {
+            printf("%u elements exceed the storage buffer range, so the test will be skipped.\n", elemCount);
+            break;
+        }
+
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+        VkResult result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, &commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        result = CreateElementwiseContext(specDevice, pLimits, &pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+
+        // Before the cap, so that it does not take the budget of a unified memory heap
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &stagingBuffer, &stagingMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+        void* hostPtr = NULL;
+        result = vkMapMemory(specDevice, stagingMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        stagingPtr = hostPtr;
+
+        // Leave room for two and a half of the buffers on the heap, as if the other processes had taken the rest of it
+        GetMemoryBudgetStats(specDevice, &stats);
+        heapIndex = pMemoryProperties->memoryTypes[deviceLocalTypeIndex].heapIndex;
+        const struct MemoryHeapBudget* pHeap = &stats.heaps[heapIndex];
+        SetMemoryBudgetLimit(specDevice, heapIndex, pHeap->budget - pHeap->available + bufferSize * 2 + bufferSize / 2);
+        printf("The budget of heap %u is capped at %.1f MiB to hold 2 of %d buffers of %.1f MiB\n", heapIndex,
+            (double)(pHeap->budget - pHeap->available + bufferSize * 2 + bufferSize / 2) / (1024.0 * 1024.0), MEMORY_BUDGET_TEST_BUFFER_COUNT,
+            (double)bufferSize / (1024.0 * 1024.0));
+
+        for (uint32_t i = 0; i < MEMORY_BUDGET_TEST_BUFFER_COUNT && result == VK_SUCCESS; i++)
+        {
+            const uint64_t fallbackCount = stats.fallbackCount;
+            const uint64_t overBudgetCount = stats.overBudgetCount;
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &buffers[i], &memories[i]);
+            GetMemoryBudgetStats(specDevice, &stats);
+            printf("buffer %u: %s, %.1f MiB of the device local budget left\n", i, stats.fallbackCount > fallbackCount ? "host visible fallback" :
+                (stats.overBudgetCount > overBudgetCount ? "over the budget" : "device local"),
+                (double)stats.heaps[heapIndex].available / (1024.0 * 1024.0));
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        // The first pair is within the budget and the second one is what did not fit
+        for (uint32_t pair = 0; pair < MEMORY_BUDGET_TEST_BUFFER_COUNT / 2 && result == VK_SUCCESS; pair++)
+        {
+            HostParallelFillSequence((int*)stagingPtr, elemCount, 0);
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunMemoryBudgetChainOnBuffers(specDevice, queue, commandPool, commandBuffer, pContext, &chain, buffers[pair * 2],
+                buffers[pair * 2 + 1], stagingBuffer, elemCount);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            printf("buffers %u and %u: %.3f ms (%s)\n", pair * 2, pair * 2 + 1, (double)elapsedTime / 1000000.0,
+                VerifyMemoryBudgetChain(&chain, stagingPtr, elemCount) ? "verify OK" : "verify FAILED");
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "RunMemoryBudgetChain failed: %d\n", result);
+            break;
+        }
+
+        // Then the whole chain is sized by the budget instead: with room for half a buffer, it runs in chunks without any fallback
+        for (uint32_t i = 0; i < MEMORY_BUDGET_TEST_BUFFER_COUNT; i++)
+        {
+            DestroyBufferWithMemory(specDevice, buffers[i], memories[i]);
+            buffers[i] = VK_NULL_HANDLE;
+            memories[i] = VK_NULL_HANDLE;
+        }
+        SetMemoryBudgetLimit(specDevice, heapIndex, 0);
+        GetMemoryBudgetStats(specDevice, &stats);
+        SetMemoryBudgetLimit(specDevice, heapIndex, pHeap->budget - pHeap->available + bufferSize / 2);
+
+        const uint64_t fallbackCount = stats.fallbackCount;
+        const uint64_t overBudgetCount = stats.overBudgetCount;
+        uint32_t chunkCount = 0;
+        HostParallelFillSequence((int*)stagingPtr, elemCount, 0);
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        result = RunMemoryBudgetChainInChunks(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffer, pContext, &chain,
+            stagingBuffer, elemCount, &chunkCount);
+        const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "RunMemoryBudgetChainInChunks failed: %d\n", result);
+            break;
+        }
+        if (chunkCount > 0)
+        {
+            GetMemoryBudgetStats(specDevice, &stats);
+            printf("%u chunk(s): %.3f ms, %llu fallback(s), %llu allocation(s) over the budget (%s)\n", chunkCount, (double)elapsedTime / 1000000.0,
+                (unsigned long long)(stats.fallbackCount - fallbackCount), (unsigned long long)(stats.overBudgetCount - overBudgetCount),
+                VerifyMemoryBudgetChain(&chain, stagingPtr, elemCount) ? "verify OK" : "verify FAILED");
+        }
+    } while (false);
+
+    if (heapIndex != UINT32_MAX) {
+        SetMemoryBudgetLimit(specDevice, heapIndex, 0);
+    }
+    for (uint32_t i = 0; i < MEMORY_BUDGET_TEST_BUFFER_COUNT; i++) {
+        DestroyBufferWithMemory(specDevice, buffers[i], memories[i]);
+    }
+    if (stagingPtr != NULL) {
+        vkUnmapMemory(specDevice, stagingMemory);
+    }
+    DestroyBufferWithMemory(specDevice, stagingBuffer, stagingMemory);
+    DestroyElementwiseContext(pContext);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, 1, &commandBuffer);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+
+    PrintMemoryBudgetStats(specDevice);
+
+    puts("\n================ Complete memory budget test ================\n");
+}
@@ -0,0 +1,91 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Device memory allocation that follows the budget of every memory heap rather than its size.
+// With `VK_EXT_memory_budget`, the budget and the usage of the heaps, including the other processes, come from the implementation.
+// Without it, the budget of a heap is a fixed fraction of its size and the usage is our own one.
+// Our own allocations are tracked per heap, so that the budget needs no query after every allocation: the implementation is queried again
+// once our usage has moved by a part of the budget since the last query, and whenever an allocation fails.
+//
+// A memory type is chosen among the ones with the required property flags by the budget left on its heap.
+// When none of them has enough budget for a device local allocation, it falls back to a host visible memory type,
+// and the callers that size their working set by the budget, such as the multi-device executor, run it in chunks instead.
+// The devices that are not registered keep the previous behavior: the first memory type with the flags, whose heap is large enough.
+
+struct MemoryHeapBudget
+{
+    VkDeviceSize size;
+    VkMemoryHeapFlags flags;
+    // At the last query, after the limit of SetMemoryBudgetLimit
+    VkDeviceSize budget;
+    // The usage of all the processes at the last query
+    VkDeviceSize usage;
+    // The budget that is left now, with our own allocations since the last query
+    VkDeviceSize available;
+    // Our own allocations
+    VkDeviceSize ownUsage;
+    VkDeviceSize ownPeakUsage;
+    uint32_t allocationCount;
+};
+
+struct MemoryBudgetStats
+{
+    bool supportMemoryBudget;
+    uint32_t heapCount;
+    struct MemoryHeapBudget heaps[VK_MAX_MEMORY_HEAPS];
+    uint64_t queryCount;
+    // The allocations that went to a host visible memory type because no device local heap had the budget for them
+    uint64_t fallbackCount;
+    // The allocations that exceeded the budget of every heap and were attempted anyway
+    uint64_t overBudgetCount;
+    // The allocations the implementation refused
+    uint64_t failureCount;
+};
+
+// Tracks the allocations of `device` from now on. The devices are registered and unregistered while no allocation is in flight on any of them.
+// @param supportMemoryBudget: whether `VK_EXT_memory_budget` is enabled on `device`
+extern bool RegisterMemoryBudgetDevice(VkPhysicalDevice physicalDevice, VkDevice device, bool supportMemoryBudget);
+// All the memory of `device` must have been freed.
+extern void UnregisterMemoryBudgetDevice(VkDevice device);
+
+// Queries the budget of the heaps again
+extern void UpdateMemoryBudget(VkDevice device);
+
+// Caps the budget of a heap below the one of the implementation, e.g. to leave room for other work on the device. 0 removes the cap.
+extern void SetMemoryBudgetLimit(VkDevice device, uint32_t heapIndex, VkDeviceSize limit);
+
+// The largest budget left on a heap of the memory types with `requiredFlags`
+extern VkDeviceSize GetAvailableMemoryBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    VkMemoryPropertyFlags requiredFlags);
+
+// Returns the first memory type of `memoryTypeBits` with `requiredFlags` whose heap has the budget for `size` bytes, or UINT32_MAX.
+extern uint32_t FindMemoryTypeIndexWithinBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t memoryTypeBits,
+    VkMemoryPropertyFlags requiredFlags, VkDeviceSize size);
+
+// Allocates the memory of `pRequirements` from a memory type with `requiredFlags` within the budget.
+// Failing that, device local memory falls back to host visible memory, and then the allocation is attempted over the budget.
+// @param pNext: the pNext chain of VkMemoryAllocateInfo
+// @param pMemoryTypeIndex: receives the memory type of the allocation. It may be NULL.
+extern VkResult AllocateMemoryWithinBudget(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    const VkMemoryRequirements* pRequirements, VkMemoryPropertyFlags requiredFlags, const void* pNext, VkDeviceMemory* pMemory,
+    uint32_t* pMemoryTypeIndex);
+
+// vkAllocateMemory and vkFreeMemory with the host allocation callbacks, which account the memory to its heap
+extern VkResult AllocateDeviceMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, VkDeviceMemory* pMemory);
+extern void FreeDeviceMemory(VkDevice device, VkDeviceMemory memory);
+
+extern void GetMemoryBudgetStats(VkDevice device, struct MemoryBudgetStats* pStats);
+extern void PrintMemoryBudgetStats(VkDevice device);
+
+// Caps the device local budget, and checks that the allocations beyond it fall back to host visible memory and still run the kernels.
+// Then it sizes the buffers of the chain by GetAvailableMemoryBudget under a tighter cap, and runs the chain in chunks that stay within the budget.
+extern void MemoryBudgetComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !MEMORY_BUDGET_H
@@ -0,0 +1,656 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "elementwise_fusion.h"
+#include "multi_device.h"
+
+enum
+{
+    MULTI_DEVICE_MAX_EXTENSION_COUNT = 256,
+    MULTI_DEVICE_MAX_QUEUE_FAMILY_COUNT = 16,
+
+    MULTI_DEVICE_TEST_ELEM_COUNT = 1 << 22,
+    MULTI_DEVICE_CALIBRATION_ELEM_COUNT = 1 << 20,
+    MULTI_DEVICE_TEST_ROUND_COUNT = 4,
+
+    // The chunks of a partition are multiples of it
+    MULTI_DEVICE_CHUNK_GRANULARITY = 1 << 16
+};
+
+// The weight of the latest measurement when it is blended into the throughput of a device
+#define MULTI_DEVICE_THROUGHPUT_BLEND   0.5
+
+struct MultiDeviceMember
+{
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    VkQueue queue;
+    uint32_t queueFamilyIndex;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    struct MultiDeviceInfo info;
+
+    struct ElementwiseContext* pContext;
+    // The plan of `planChain`, created again when the chain of a job differs
+    struct ElementwiseChainPlan* pPlan;
+    struct ElementwiseChain planChain;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    VkBuffer srcBuffer, dstBuffer, stagingBuffer;
+    VkDeviceMemory srcMemory, dstMemory, stagingMemory;
+    // Both the upload and the readback go through the staging buffer
+    uint32_t* stagingPtr;
+    VkResult lastResult;
+};
+
+struct MultiDeviceExecutor
+{
+    uint32_t memberCount;
+    uint32_t maxElemCount;
+    struct MultiDeviceMember members[MULTI_DEVICE_MAX_COUNT];
+
+    // The job of RunMultiDevicePartitions, shared by its tasks
+    const struct ElementwiseChain* pJobChain;
+    const uint32_t* jobSrc;
+    uint32_t* jobDst;
+    // The member index of every task
+    uint32_t taskMembers[MULTI_DEVICE_MAX_COUNT];
+};
+
+static bool HasDeviceExtension(const VkExtensionProperties* extProps, uint32_t extPropCount, const char* extensionName)
+{
+    for (uint32_t i = 0; i < extPropCount; i++)
+    {
+        if (strcmp(extProps[i].extensionName, extensionName) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void DestroyMultiDeviceMember(struct MultiDeviceMember* pMember)
+{
+    const VkDevice device = pMember->device;
+    if (device == VK_NULL_HANDLE) return;
+
+    DestroyElementwiseChainPlan(pMember->pPlan);
+    DestroyElementwiseContext(pMember->pContext);
+    if (pMember->stagingPtr != NULL) {
+        vkUnmapMemory(device, pMember->stagingMemory);
+    }
+    DestroyBufferWithMemory(device, pMember->stagingBuffer, pMember->stagingMemory);
+    DestroyBufferWithMemory(device, pMember->dstBuffer, pMember->dstMemory);
+    DestroyBufferWithMemory(device, pMember->srcBuffer, pMember->srcMemory);
+    UnregisterMemoryBudgetDevice(device);
+    if (pMember->commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, pMember->commandPool, 1, &pMember->commandBuffer);
+        vkDestroyCommandPool(device, pMember->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    vkDestroyDevice(device, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE));
+
+    memset(pMember, 0, sizeof(*pMember));
+}
+
+// Creates the logical device and the resources of a member. Returns VK_ERROR_FEATURE_NOT_PRESENT for a device that cannot run the kernels.
+static VkResult CreateMultiDeviceMember(VkPhysicalDevice physicalDevice, uint32_t maxElemCount, struct MultiDeviceMember* pMember)
+{
+    memset(pMember, 0, sizeof(*pMember));
+    pMember->physicalDevice = physicalDevice;
+
+    VkPhysicalDeviceProperties props = { 0 };
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+    memcpy(pMember->info.deviceName, props.deviceName, sizeof(pMember->info.deviceName));
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &pMember->memoryProperties);
+
+    if ((VkDeviceSize)maxElemCount * sizeof(uint32_t) > props.limits.maxStorageBufferRange)
+    {
+        printf("%s: %u elements exceed the storage buffer range!\n", props.deviceName, maxElemCount);
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    uint32_t extPropCount = MULTI_DEVICE_MAX_EXTENSION_COUNT;
+    VkExtensionProperties* extProps = calloc(extPropCount, sizeof(*extProps));
+    if (extProps == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    VkResult result = vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &extPropCount, extProps);
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+    {
+        fprintf(stderr, "vkEnumerateDeviceExtensionProperties failed: %d\n", result);
+        free(extProps);
+        return result;
+    }
+    const bool supportShaderNonSemanticInfo = HasDeviceExtension(extProps, extPropCount, VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME);
+    const bool supportVariablePointers = HasDeviceExtension(extProps, extPropCount, VK_KHR_VARIABLE_POINTERS_EXTENSION_NAME);
+    const bool supportMemoryBudget = HasDeviceExtension(extProps, extPropCount, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    free(extProps);
+
+    // The reflection of clspv needs it, as for the selected device
+    if (!supportShaderNonSemanticInfo)
+    {
+        printf("%s does not support `VK_KHR_shader_non_semantic_info` and will be skipped.\n", props.deviceName);
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    uint32_t queueFamilyPropertyCount = 0;
+    VkQueueFamilyProperties queueFamilyProperties[MULTI_DEVICE_MAX_QUEUE_FAMILY_COUNT];
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, NULL);
+    if (queueFamilyPropertyCount > MULTI_DEVICE_MAX_QUEUE_FAMILY_COUNT) {
+        queueFamilyPropertyCount = MULTI_DEVICE_MAX_QUEUE_FAMILY_COUNT;
+    }
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, queueFamilyProperties);
+
+    bool found = false;
+    for (uint32_t i = 0; i < queueFamilyPropertyCount && !found; i++)
+    {
+        if ((queueFamilyProperties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0)
+        {
+            pMember->queueFamilyIndex = i;
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        printf("%s has no compute queue and will be skipped.\n", props.deviceName);
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    // The same features as the selected device, as far as the kernels need them
+    VkPhysicalDeviceVariablePointersFeatures variablePointersFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VARIABLE_POINTERS_FEATURES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceFeatures2 features2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &variablePointersFeature
+    };
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    features2.features.shaderInt64 = VK_TRUE;
+
+    uint32_t extCount = 0;
+    const char* extensionNames[3] = { NULL };
+    extensionNames[extCount++] = VK_KHR_SHADER_NON_SEMANTIC_INFO_EXTENSION_NAME;
+    if (supportVariablePointers) {
+        extensionNames[extCount++] = VK_KHR_VARIABLE_POINTERS_EXTENSION_NAME;
+    }
+    if (supportMemoryBudget) {
+        extensionNames[extCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
+
+    const float queuePriorities[1] = { 0.0f };
+    const VkDeviceQueueCreateInfo queueInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = pMember->queueFamilyIndex,
+        .queueCount = 1,
+        .pQueuePriorities = queuePriorities
+    };
+    const VkDeviceCreateInfo deviceInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &features2,
+        .flags = 0,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queueInfo,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL,
+        .enabledExtensionCount = extCount,
+        .ppEnabledExtensionNames = extensionNames,
+        .pEnabledFeatures = NULL
+    };
+    result = vkCreateDevice(physicalDevice, &deviceInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DEVICE), &pMember->device);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateDevice failed for %s: %d\n", props.deviceName, result);
+        pMember->device = VK_NULL_HANDLE;
+        return result;
+    }
+    const VkDevice device = pMember->device;
+    vkGetDeviceQueue(device, pMember->queueFamilyIndex, 0, &pMember->queue);
+    RegisterMemoryBudgetDevice(physicalDevice, device, supportMemoryBudget);
+
+    // src and dst take the device local budget. When it cannot hold the whole job, the partitions run in chunks of what it holds.
+    const VkDeviceSize availableBudget = GetAvailableMemoryBudget(device, &pMember->memoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    pMember->info.chunkElemCount = maxElemCount;
+    if (availableBudget / (2 * sizeof(uint32_t)) < maxElemCount)
+    {
+        const uint32_t chunkElemCount = (uint32_t)(availableBudget / (2 * sizeof(uint32_t))) / MULTI_DEVICE_CHUNK_GRANULARITY *
+            MULTI_DEVICE_CHUNK_GRANULARITY;
+        pMember->info.chunkElemCount = chunkElemCount > 0 ? chunkElemCount : MULTI_DEVICE_CHUNK_GRANULARITY;
+        printf("%s: the device local budget of %llu bytes runs the partitions in chunks of %u elements.\n", props.deviceName,
+            (unsigned long long)availableBudget, pMember->info.chunkElemCount);
+    }
+    const VkDeviceSize bufferSize = (VkDeviceSize)pMember->info.chunkElemCount * sizeof(uint32_t);
+
+    do
+    {
+        result = CreateElementwiseContext(device, &props.limits, &pMember->pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(pMember->queueFamilyIndex, device, &pMember->commandPool, &pMember->commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        result = CreateBufferWithMemory(device, &pMember->memoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pMember->queueFamilyIndex, &pMember->srcBuffer, &pMember->srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, &pMember->memoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pMember->queueFamilyIndex, &pMember->dstBuffer, &pMember->dstMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, &pMember->memoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, pMember->queueFamilyIndex,
+                &pMember->stagingBuffer, &pMember->stagingMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        void* hostPtr = NULL;
+        result = vkMapMemory(device, pMember->stagingMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        pMember->stagingPtr = hostPtr;
+    } while (false);
+
+    if (result != VK_SUCCESS) {
+        DestroyMultiDeviceMember(pMember);
+    }
+    return result;
+}
+
+VkResult CreateMultiDeviceExecutor(VkInstance instance, uint32_t maxElemCount, struct MultiDeviceExecutor** ppExecutor)
+{
+    if (maxElemCount == 0) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    VkPhysicalDevice physicalDevices[MULTI_DEVICE_MAX_COUNT] = { VK_NULL_HANDLE };
+    uint32_t physicalDeviceCount = MULTI_DEVICE_MAX_COUNT;
+    VkResult result = vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices);
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+    {
+        fprintf(stderr, "vkEnumeratePhysicalDevices failed: %d\n", result);
+        return result;
+    }
+
+    // The device groups only label the members. Each physical device of a group gets a logical device of its own.
+    VkPhysicalDeviceGroupProperties groupProperties[MULTI_DEVICE_MAX_COUNT];
+    uint32_t groupCount = MULTI_DEVICE_MAX_COUNT;
+    for (uint32_t i = 0; i < groupCount; i++)
+    {
+        groupProperties[i] = (VkPhysicalDeviceGroupProperties){
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GROUP_PROPERTIES,
+            .pNext = NULL
+        };
+    }
+    result = vkEnumeratePhysicalDeviceGroups(instance, &groupCount, groupProperties);
+    if (result != VK_SUCCESS && result != VK_INCOMPLETE)
+    {
+        fprintf(stderr, "vkEnumeratePhysicalDeviceGroups failed: %d\n", result);
+        groupCount = 0;
+    }
+
+    struct MultiDeviceExecutor* pExecutor = calloc(1, sizeof(*pExecutor));
+    if (pExecutor == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pExecutor->maxElemCount = maxElemCount;
+
+    for (uint32_t i = 0; i < physicalDeviceCount; i++)
+    {
+        struct MultiDeviceMember* pMember = &pExecutor->members[pExecutor->memberCount];
+        if (CreateMultiDeviceMember(physicalDevices[i], maxElemCount, pMember) != VK_SUCCESS) continue;
+
+        pMember->info.groupIndex = UINT32_MAX;
+        pMember->info.groupSize = 1;
+        for (uint32_t g = 0; g < groupCount; g++)
+        {
+            for (uint32_t d = 0; d < groupProperties[g].physicalDeviceCount; d++)
+            {
+                if (groupProperties[g].physicalDevices[d] == physicalDevices[i])
+                {
+                    pMember->info.groupIndex = g;
+                    pMember->info.groupSize = groupProperties[g].physicalDeviceCount;
+                }
+            }
+        }
+        pMember->info.throughput = 1.0;
+        pExecutor->memberCount++;
+    }
+
+    if (pExecutor->memberCount == 0)
+    {
+        fprintf(stderr, "No physical device can run the multi-device executor!\n");
+        free(pExecutor);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    *ppExecutor = pExecutor;
+    return VK_SUCCESS;
+}
+
+void DestroyMultiDeviceExecutor(struct MultiDeviceExecutor* pExecutor)
+{
+    if (pExecutor == NULL) return;
+
+    for (uint32_t i = 0; i < pExecutor->memberCount; i++) {
+        DestroyMultiDeviceMember(&pExecutor->members[i]);
+    }
+    free(pExecutor);
+}
+
+uint32_t GetMultiDeviceCount(const struct MultiDeviceExecutor* pExecutor)
+{
+    return pExecutor->memberCount;
+}
+
+void GetMultiDeviceInfo(const struct MultiDeviceExecutor* pExecutor, uint32_t deviceIndex, struct MultiDeviceInfo* pInfo)
+{
+    *pInfo = pExecutor->members[deviceIndex].info;
+}
+
+// Uploads the partition of a member, runs the chain and reads the result back, a chunk at a time
+static VkResult RunMultiDevicePartition(struct MultiDeviceExecutor* pExecutor, struct MultiDeviceMember* pMember)
+{
+    const struct ElementwiseChain* pChain = pExecutor->pJobChain;
+
+    if (pMember->pPlan == NULL || memcmp(&pMember->planChain, pChain, sizeof(*pChain)) != 0)
+    {
+        DestroyElementwiseChainPlan(pMember->pPlan);
+        pMember->pPlan = NULL;
+        VkResult result = CreateElementwiseChainPlan(pMember->pContext, pChain, ELEMENTWISE_FUSION_AUTO, pMember->srcBuffer, pMember->dstBuffer,
+            &pMember->pPlan);
+        if (result != VK_SUCCESS) return result;
+        pMember->planChain = *pChain;
+    }
+
+    const uint32_t partitionEnd = pMember->info.lastElemOffset + pMember->info.lastElemCount;
+    for (uint32_t elemOffset = pMember->info.lastElemOffset; elemOffset < partitionEnd; elemOffset += pMember->info.chunkElemCount)
+    {
+        const uint32_t elemCount = partitionEnd - elemOffset < pMember->info.chunkElemCount ? partitionEnd - elemOffset : pMember->info.chunkElemCount;
+        const size_t size = (size_t)elemCount * sizeof(uint32_t);
+
+        memcpy(pMember->stagingPtr, pExecutor->jobSrc + elemOffset, size);
+
+        VkResult result = BeginOneTimeCommandBuffer(pMember->device, pMember->commandPool, pMember->commandBuffer);
+        if (result != VK_SUCCESS) return result;
+
+        const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = size };
+        vkCmdCopyBuffer(pMember->commandBuffer, pMember->stagingBuffer, pMember->srcBuffer, 1, &copyRegion);
+        RecordTransferToComputeBarrier(pMember->commandBuffer);
+        RecordElementwiseChain(pMember->commandBuffer, pMember->pPlan, elemCount);
+        RecordComputeToTransferBarrier(pMember->commandBuffer);
+        vkCmdCopyBuffer(pMember->commandBuffer, pMember->dstBuffer, pMember->stagingBuffer, 1, &copyRegion);
+
+        result = EndAndSubmitCommandBuffer(pMember->device, pMember->queue, pMember->commandBuffer);
+        if (result != VK_SUCCESS) return result;
+
+        memcpy(pExecutor->jobDst + elemOffset, pMember->stagingPtr, size);
+    }
+    return VK_SUCCESS;
+}
+
+static void MultiDevicePartitionTask(void* context, size_t begin, size_t end)
+{
+    struct MultiDeviceExecutor* pExecutor = context;
+    for (size_t task = begin; task < end; task++)
+    {
+        struct MultiDeviceMember* pMember = &pExecutor->members[pExecutor->taskMembers[task]];
+
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        pMember->lastResult = RunMultiDevicePartition(pExecutor, pMember);
+        pMember->info.lastElapsedTime = HostGetTimeNanoseconds() - beginTime;
+    }
+}
+
+// Splits the job among the members of `deviceMask` in proportion to their throughput, and runs the partitions concurrently.
+// @param blend: blends the measured throughputs into the current ones rather than replacing them
+static VkResult RunMultiDevicePartitions(struct MultiDeviceExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t* dst, uint32_t elemCount, uint32_t deviceMask, bool blend)
+{
+    if (elemCount > pExecutor->maxElemCount)
+    {
+        fprintf(stderr, "%u elements exceed the multi-device executor capacity of %u!\n", elemCount, pExecutor->maxElemCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    double totalThroughput = 0.0;
+    uint32_t lastMember = UINT32_MAX;
+    for (uint32_t i = 0; i < pExecutor->memberCount; i++)
+    {
+        pExecutor->members[i].info.lastElemOffset = 0;
+        pExecutor->members[i].info.lastElemCount = 0;
+        if ((deviceMask & (1U << i)) != 0)
+        {
+            totalThroughput += pExecutor->members[i].info.throughput;
+            lastMember = i;
+        }
+    }
+    if (lastMember == UINT32_MAX)
+    {
+        fprintf(stderr, "The device mask 0x%x selects no device!\n", deviceMask);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Contiguous partitions in the member order, the last one taking the remainder of the rounding
+    uint32_t taskCount = 0;
+    uint32_t elemOffset = 0;
+    for (uint32_t i = 0; i <= lastMember; i++)
+    {
+        if ((deviceMask & (1U << i)) == 0) continue;
+
+        struct MultiDeviceInfo* pInfo = &pExecutor->members[i].info;
+        const uint32_t partitionCount = i == lastMember ? elemCount - elemOffset :
+            (uint32_t)((double)elemCount * pInfo->throughput / totalThroughput);
+        pInfo->lastElemOffset = elemOffset;
+        pInfo->lastElemCount = partitionCount;
+        elemOffset += partitionCount;
+        if (partitionCount > 0) {
+            pExecutor->taskMembers[taskCount++] = i;
+        }
+    }
+
+    pExecutor->pJobChain = pChain;
+    pExecutor->jobSrc = src;
+    pExecutor->jobDst = dst;
+    HostParallelForEach(taskCount, 0, MultiDevicePartitionTask, pExecutor);
+
+    VkResult result = VK_SUCCESS;
+    for (uint32_t task = 0; task < taskCount; task++)
+    {
+        struct MultiDeviceMember* pMember = &pExecutor->members[pExecutor->taskMembers[task]];
+        if (pMember->lastResult != VK_SUCCESS)
+        {
+            fprintf(stderr, "The partition of %s failed: %d\n", pMember->info.deviceName, pMember->lastResult);
+            result = pMember->lastResult;
+            continue;
+        }
+
+        const double elapsedSeconds = (double)(pMember->info.lastElapsedTime > 0 ? pMember->info.lastElapsedTime : 1) / 1000000000.0;
+        const double throughput = (double)pMember->info.lastElemCount / elapsedSeconds;
+        pMember->info.throughput = blend ?
+            (1.0 - MULTI_DEVICE_THROUGHPUT_BLEND) * pMember->info.throughput + MULTI_DEVICE_THROUGHPUT_BLEND * throughput : throughput;
+    }
+    return result;
+}
+
+VkResult CalibrateMultiDeviceExecutor(struct MultiDeviceExecutor* pExecutor, const struct ElementwiseChain* pChain, uint32_t elemCount)
+{
+    if (elemCount > pExecutor->maxElemCount) {
+        elemCount = pExecutor->maxElemCount;
+    }
+
+    uint32_t* src = malloc((size_t)elemCount * sizeof(uint32_t));
+    uint32_t* dst = malloc((size_t)elemCount * sizeof(uint32_t));
+    VkResult result = VK_SUCCESS;
+    if (src == NULL || dst == NULL)
+    {
+        fprintf(stderr, "Lack of system memory!\n");
+        result = VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    else
+    {
+        HostParallelFillSequence((int*)src, elemCount, 0);
+        // Every device alone, so that none of them slows the others down. The first pass creates the plans and warms the devices up.
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (uint32_t i = 0; i < pExecutor->memberCount && result == VK_SUCCESS; i++) {
+                result = RunMultiDevicePartitions(pExecutor, pChain, src, dst, elemCount, 1U << i, false);
+            }
+        }
+    }
+
+    free(dst);
+    free(src);
+    return result;
+}
+
+VkResult RunMultiDeviceElementwiseChain(struct MultiDeviceExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t* dst, uint32_t elemCount, uint32_t deviceMask)
+{
+    return RunMultiDevicePartitions(pExecutor, pChain, src, dst, elemCount, deviceMask, true);
+}
+
+// MARK: Test
+
+// Returns the index of the first wrong element, or SIZE_MAX if all the elements are correct.
+static size_t VerifyMultiDeviceResult(const struct ElementwiseChain* pChain, const uint32_t* result, uint32_t elemCount)
+{
+    // The source elements are filled with their indices
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        if (result[i] != ApplyElementwiseChainOnHost(pChain, i)) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+static void PrintMultiDeviceRun(const struct MultiDeviceExecutor* pExecutor, const char* title, uint32_t deviceMask, uint64_t elapsedTime,
+    uint32_t elemCount, size_t errorIndex)
+{
+    const double milliseconds = (double)elapsedTime / 1000000.0;
+    printf("%-24s %9.3f ms  %8.2f M elements/s  (%s)\n", title, milliseconds, (double)elemCount / (milliseconds * 1000.0),
+        errorIndex == SIZE_MAX ? "verify OK" : "verify FAILED");
+    for (uint32_t i = 0; i < pExecutor->memberCount; i++)
+    {
+        const struct MultiDeviceInfo* pInfo = &pExecutor->members[i].info;
+        if ((deviceMask & (1U << i)) == 0 || pInfo->lastElemCount == 0) continue;
+        printf("    device %u: [%8u, +%8u)  %9.3f ms\n", i, pInfo->lastElemOffset, pInfo->lastElemCount, (double)pInfo->lastElapsedTime / 1000000.0);
+    }
+}
+
+void MultiDeviceComputeTest(VkInstance instance)
+{
+    puts("\n================ Begin multi-device test ================\n");
+
+    struct MultiDeviceExecutor* pExecutor = NULL;
+    uint32_t* src = NULL;
+    uint32_t* dst = NULL;
+
+    // The 6-op chain of the elementwise kernel fusion test
+    const struct ElementwiseChain chain = {
+        6, { ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_XOR, ELEMENTWISE_OP_MIN, ELEMENTWISE_OP_MAX, ELEMENTWISE_OP_MUL },
+        { 7, 3, 0x5a5aU, 1U << 30, 12345, 5 }
+    };
+
+    do
+    {
+        const uint32_t elemCount = MULTI_DEVICE_TEST_ELEM_COUNT;
+        VkResult result = CreateMultiDeviceExecutor(instance, elemCount, &pExecutor);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateMultiDeviceExecutor failed: %d\n", result);
+            break;
+        }
+
+        src = malloc((size_t)elemCount * sizeof(uint32_t));
+        dst = malloc((size_t)elemCount * sizeof(uint32_t));
+        if (src == NULL || dst == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+        HostParallelFillSequence((int*)src, elemCount, 0);
+
+        result = CalibrateMultiDeviceExecutor(pExecutor, &chain, MULTI_DEVICE_CALIBRATION_ELEM_COUNT);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CalibrateMultiDeviceExecutor failed: %d\n", result);
+            break;
+        }
+
+        const uint32_t deviceCount = GetMultiDeviceCount(pExecutor);
+        printf("%u device(s), %u elements per job\n", deviceCount, elemCount);
+        for (uint32_t i = 0; i < deviceCount; i++)
+        {
+            struct MultiDeviceInfo info;
+            GetMultiDeviceInfo(pExecutor, i, &info);
+            printf("device %u: %s, device group %d of %u device(s), chunks of %u elements, calibrated at %.2f M elements/s\n", i, info.deviceName,
+                info.groupIndex == UINT32_MAX ? -1 : (int)info.groupIndex, info.groupSize, info.chunkElemCount, info.throughput / 1000000.0);
+        }
+        if (deviceCount == 1) {
+            puts("Only one device is usable, so the partitioned job runs on it alone.");
+        }
+
+        char title[64];
+        for (uint32_t i = 0; i < deviceCount && result == VK_SUCCESS; i++)
+        {
+            memset(dst, 0, (size_t)elemCount * sizeof(uint32_t));
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunMultiDeviceElementwiseChain(pExecutor, &chain, src, dst, elemCount, 1U << i);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            snprintf(title, sizeof(title), "device %u alone", i);
+            PrintMultiDeviceRun(pExecutor, title, 1U << i, elapsedTime, elemCount, VerifyMultiDeviceResult(&chain, dst, elemCount));
+        }
+
+        // The weights settle as the rounds blend in the throughputs measured under the concurrent load
+        const uint32_t allDevices = deviceCount < 32 ? (1U << deviceCount) - 1U : UINT32_MAX;
+        for (int round = 0; round < MULTI_DEVICE_TEST_ROUND_COUNT && result == VK_SUCCESS; round++)
+        {
+            memset(dst, 0, (size_t)elemCount * sizeof(uint32_t));
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunMultiDeviceElementwiseChain(pExecutor, &chain, src, dst, elemCount, allDevices);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            snprintf(title, sizeof(title), "all devices, round %d", round);
+            PrintMultiDeviceRun(pExecutor, title, allDevices, elapsedTime, elemCount, VerifyMultiDeviceResult(&chain, dst, elemCount));
+        }
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "RunMultiDeviceElementwiseChain failed: %d\n", result);
+        }
+    } while (false);
+
+    free(dst);
+    free(src);
+    DestroyMultiDeviceExecutor(pExecutor);
+
+    puts("\n================ Complete multi-device test ================\n");
+}
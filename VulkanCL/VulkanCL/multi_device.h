@@ -0,0 +1,67 @@
+#ifndef MULTI_DEVICE_H
+#define MULTI_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct ElementwiseChain;
+
+// Elementwise jobs partitioned across all the physical devices of the instance.
+// Every physical device that supports `VK_KHR_shader_non_semantic_info` gets a logical device of its own, with its own queue,
+// elementwise context, staging buffer and device buffers, so the members of a device group are driven the same way as separate GPUs.
+// A job is split into contiguous partitions proportional to the throughput measured for each device, and every partition runs
+// on a host thread of its own, from the upload of its slice to the readback, concurrently with the others.
+// A device whose memory budget cannot hold the whole job gets smaller buffers, and runs its partition through them in chunks.
+//
+// Several software ICDs make it testable on a machine with a single GPU or none,
+// e.g. by listing copies of the lavapipe ICD manifest in VK_DRIVER_FILES (VK_ICD_FILENAMES for older loaders).
+
+enum
+{
+    MULTI_DEVICE_MAX_COUNT = 8
+};
+
+struct MultiDeviceInfo
+{
+    char deviceName[VK_MAX_PHYSICAL_DEVICE_NAME_SIZE];
+    // The index of the device group in vkEnumeratePhysicalDeviceGroups, and the number of physical devices in it
+    uint32_t groupIndex;
+    uint32_t groupSize;
+    // Elements per second, including the transfers between the host and the device
+    double throughput;
+    // The elements the buffers of the device hold, which a partition is run in chunks of
+    uint32_t chunkElemCount;
+    // The partition of the last job
+    uint32_t lastElemOffset;
+    uint32_t lastElemCount;
+    uint64_t lastElapsedTime;
+};
+
+struct MultiDeviceExecutor;
+
+// @param maxElemCount: the largest job. Every device allocates its buffers for the whole job, so that any partition fits in a single chunk,
+// as far as the device local budget of the device allows.
+// Returns VK_ERROR_INITIALIZATION_FAILED if no physical device is usable.
+extern VkResult CreateMultiDeviceExecutor(VkInstance instance, uint32_t maxElemCount, struct MultiDeviceExecutor** ppExecutor);
+extern void DestroyMultiDeviceExecutor(struct MultiDeviceExecutor* pExecutor);
+
+extern uint32_t GetMultiDeviceCount(const struct MultiDeviceExecutor* pExecutor);
+extern void GetMultiDeviceInfo(const struct MultiDeviceExecutor* pExecutor, uint32_t deviceIndex, struct MultiDeviceInfo* pInfo);
+
+// Runs `pChain` over `elemCount` elements on every device alone, and takes the throughputs as the weights of the partitions.
+// Until it is called, all the devices weigh the same.
+extern VkResult CalibrateMultiDeviceExecutor(struct MultiDeviceExecutor* pExecutor, const struct ElementwiseChain* pChain, uint32_t elemCount);
+
+// dst[i] = pChain(src[i]) for `elemCount` elements, partitioned across the devices of `deviceMask`, bit i for device i.
+// The measured throughput of every device that takes part is blended into its weight, so the partitions follow the devices
+// as their load changes.
+extern VkResult RunMultiDeviceElementwiseChain(struct MultiDeviceExecutor* pExecutor, const struct ElementwiseChain* pChain,
+    const uint32_t* src, uint32_t* dst, uint32_t elemCount, uint32_t deviceMask);
+
+// Compares every device alone against the job partitioned across all of them.
+extern void MultiDeviceComputeTest(VkInstance instance);
+
+#endif // !MULTI_DEVICE_H
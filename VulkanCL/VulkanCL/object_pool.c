@@ -0,0 +1,938 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "object_pool.h"
+
+enum
+{
+    // The jobs each benchmark mode keeps in flight, each in a region of the buffers of its own
+    OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT = 4,
+    OBJECT_POOL_BENCHMARK_JOB_COUNT = 4096,
+    OBJECT_POOL_BENCHMARK_ELEM_COUNT = 1024
+};
+
+// Every mode of the benchmark runs the same jobs: a fill of the region of the job in the device buffer, and, in a second submission
+// that waits for the first one through a binary semaphore, a copy of the region to the host buffer.
+enum ObjectPoolBenchmarkMode
+{
+    // A command pool, two command buffers, a semaphore and a fence created and destroyed per job, as the tests do
+    OBJECT_POOL_MODE_CREATE_PER_JOB,
+    // The objects acquired from the pools, and the completion waited for with a pooled fence
+    OBJECT_POOL_MODE_POOLED_FENCE,
+    // The completion signaled on a pooled timeline semaphore instead of a fence
+    OBJECT_POOL_MODE_POOLED_TIMELINE,
+    OBJECT_POOL_MODE_COUNT
+};
+
+// Bookkeeping of an acquisition, called with the lock of a thread-safe pool held.
+// `*pFromFreeList` tells if the object comes from the free list, or is to be created by the caller. Fails if `maxCount` objects are out.
+static VkResult TakeObjectPoolSlot(struct ObjectPoolStats* pStats, bool* pFromFreeList)
+{
+    if (pStats->freeCount > 0)
+    {
+        pStats->freeCount--;
+        pStats->reusedCount++;
+        *pFromFreeList = true;
+    }
+    else if (pStats->liveCount >= pStats->maxCount)
+    {
+        pStats->exhaustedCount++;
+        return VK_ERROR_TOO_MANY_OBJECTS;
+    }
+    else {
+        *pFromFreeList = false;
+    }
+
+    // A slot for an object to be created is reserved here, and given back by CancelObjectPoolSlot if the creation fails
+    pStats->liveCount++;
+    if (pStats->liveCount > pStats->peakLiveCount) {
+        pStats->peakLiveCount = pStats->liveCount;
+    }
+    return VK_SUCCESS;
+}
+
+static void CancelObjectPoolSlot(struct ObjectPoolStats* pStats)
+{
+    pStats->liveCount--;
+}
+
+static void PrintObjectPoolStats(const char* title, const struct ObjectPoolStats* pStats)
+{
+    printf("%-22s %6llu created, %6llu reused, %6llu released, %u live, %u peak live of %u, %u free, %llu exhausted\n", title,
+        (unsigned long long)pStats->createdCount, (unsigned long long)pStats->reusedCount, (unsigned long long)pStats->releasedCount,
+        pStats->liveCount, pStats->peakLiveCount, pStats->maxCount, pStats->freeCount, (unsigned long long)pStats->exhaustedCount);
+    if (pStats->discardedCount > 0 || pStats->leakedCount > 0)
+    {
+        printf("%-22s %6llu discarded after failed waits, %llu of them leaked since they might still be pending\n", "",
+            (unsigned long long)(pStats->discardedCount + pStats->leakedCount), (unsigned long long)pStats->leakedCount);
+    }
+}
+
+// MARK: Fence pool
+
+struct FencePool
+{
+    VkDevice device;
+    struct HostLock* pLock;
+    // maxCount entries, of which the first stats.freeCount are the fences ready to be acquired
+    VkFence* freeFences;
+    struct ObjectPoolStats stats;
+};
+
+VkResult CreateFencePool(VkDevice device, uint32_t maxCount, struct FencePool** ppPool)
+{
+    if (device == VK_NULL_HANDLE || maxCount == 0 || ppPool == NULL) return VK_ERROR_INITIALIZATION_FAILED;
+
+    struct FencePool* pPool = calloc(1, sizeof(*pPool));
+    if (pPool == NULL) return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    pPool->device = device;
+    pPool->pLock = HostLockCreate();
+    pPool->freeFences = calloc(maxCount, sizeof(*pPool->freeFences));
+    pPool->stats.maxCount = maxCount;
+    if (pPool->pLock == NULL || pPool->freeFences == NULL)
+    {
+        DestroyFencePool(pPool);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    *ppPool = pPool;
+    return VK_SUCCESS;
+}
+
+void DestroyFencePool(struct FencePool* pPool)
+{
+    if (pPool == NULL) return;
+
+    if (pPool->stats.liveCount > 0) {
+        fprintf(stderr, "DestroyFencePool: %u fence(s) not released!\n", pPool->stats.liveCount);
+    }
+    if (pPool->stats.leakedCount > 0) {
+        fprintf(stderr, "DestroyFencePool: %llu fence(s) leaked after failed waits!\n", (unsigned long long)pPool->stats.leakedCount);
+    }
+    for (uint32_t i = 0; i < pPool->stats.freeCount; i++) {
+        vkDestroyFence(pPool->device, pPool->freeFences[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    if (pPool->pLock != NULL) {
+        HostLockDestroy(pPool->pLock);
+    }
+    free(pPool->freeFences);
+    free(pPool);
+}
+
+VkDevice GetFencePoolDevice(const struct FencePool* pPool)
+{
+    return pPool->device;
+}
+
+VkResult AcquirePooledFence(struct FencePool* pPool, VkFence* pFence)
+{
+    bool fromFreeList = false;
+    HostLockAcquire(pPool->pLock);
+    VkResult res = TakeObjectPoolSlot(&pPool->stats, &fromFreeList);
+    if (res == VK_SUCCESS && fromFreeList) {
+        *pFence = pPool->freeFences[pPool->stats.freeCount];
+    }
+    HostLockRelease(pPool->pLock);
+    if (res != VK_SUCCESS || fromFreeList) return res;
+
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    res = vkCreateFence(pPool->device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), pFence);
+
+    HostLockAcquire(pPool->pLock);
+    if (res == VK_SUCCESS) {
+        pPool->stats.createdCount++;
+    }
+    else {
+        CancelObjectPoolSlot(&pPool->stats);
+    }
+    HostLockRelease(pPool->pLock);
+
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateFence failed: %d\n", res);
+    }
+    return res;
+}
+
+void ReleasePooledFence(struct FencePool* pPool, VkFence fence)
+{
+    if (fence == VK_NULL_HANDLE) return;
+
+    // The fence is still owned by the caller here, so it's reset outside the lock
+    const VkResult res = vkResetFences(pPool->device, 1, &fence);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkResetFences failed: %d\n", res);
+        vkDestroyFence(pPool->device, fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+
+    HostLockAcquire(pPool->pLock);
+    pPool->stats.liveCount--;
+    if (res == VK_SUCCESS)
+    {
+        pPool->freeFences[pPool->stats.freeCount++] = fence;
+        pPool->stats.releasedCount++;
+    }
+    HostLockRelease(pPool->pLock);
+}
+
+void DiscardPooledFence(struct FencePool* pPool, VkFence fence)
+{
+    if (fence == VK_NULL_HANDLE) return;
+
+    // A signaled fence has no submission pending, and on a lost device all the submissions count as complete
+    const VkResult status = vkGetFenceStatus(pPool->device, fence);
+    const bool canDestroy = status == VK_SUCCESS || status == VK_ERROR_DEVICE_LOST;
+    if (canDestroy) {
+        vkDestroyFence(pPool->device, fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    else {
+        fprintf(stderr, "DiscardPooledFence: the fence might still be pending (%d), so it is leaked!\n", status);
+    }
+
+    HostLockAcquire(pPool->pLock);
+    pPool->stats.liveCount--;
+    if (canDestroy) {
+        pPool->stats.discardedCount++;
+    }
+    else {
+        pPool->stats.leakedCount++;
+    }
+    HostLockRelease(pPool->pLock);
+}
+
+VkResult ReplacePooledFence(struct FencePool* pPool, VkFence* pFence)
+{
+    DiscardPooledFence(pPool, *pFence);
+    *pFence = VK_NULL_HANDLE;
+    return AcquirePooledFence(pPool, pFence);
+}
+
+void GetFencePoolStats(const struct FencePool* pPool, struct ObjectPoolStats* pStats)
+{
+    HostLockAcquire(pPool->pLock);
+    *pStats = pPool->stats;
+    HostLockRelease(pPool->pLock);
+}
+
+// MARK: Semaphore pool
+
+struct SemaphorePool
+{
+    VkDevice device;
+    VkSemaphoreType semaphoreType;
+    struct HostLock* pLock;
+    // maxCount entries each, of which the first stats.freeCount are the semaphores ready to be acquired and, for timeline ones, their values
+    VkSemaphore* freeSemaphores;
+    uint64_t* freeValues;
+    struct ObjectPoolStats stats;
+};
+
+VkResult CreateSemaphorePool(VkDevice device, VkSemaphoreType semaphoreType, uint32_t maxCount, struct SemaphorePool** ppPool)
+{
+    if (device == VK_NULL_HANDLE || maxCount == 0 || ppPool == NULL) return VK_ERROR_INITIALIZATION_FAILED;
+    if (semaphoreType != VK_SEMAPHORE_TYPE_BINARY && semaphoreType != VK_SEMAPHORE_TYPE_TIMELINE) return VK_ERROR_INITIALIZATION_FAILED;
+
+    struct SemaphorePool* pPool = calloc(1, sizeof(*pPool));
+    if (pPool == NULL) return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    pPool->device = device;
+    pPool->semaphoreType = semaphoreType;
+    pPool->pLock = HostLockCreate();
+    pPool->freeSemaphores = calloc(maxCount, sizeof(*pPool->freeSemaphores));
+    pPool->freeValues = calloc(maxCount, sizeof(*pPool->freeValues));
+    pPool->stats.maxCount = maxCount;
+    if (pPool->pLock == NULL || pPool->freeSemaphores == NULL || pPool->freeValues == NULL)
+    {
+        DestroySemaphorePool(pPool);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    *ppPool = pPool;
+    return VK_SUCCESS;
+}
+
+void DestroySemaphorePool(struct SemaphorePool* pPool)
+{
+    if (pPool == NULL) return;
+
+    if (pPool->stats.liveCount > 0) {
+        fprintf(stderr, "DestroySemaphorePool: %u semaphore(s) not released!\n", pPool->stats.liveCount);
+    }
+    for (uint32_t i = 0; i < pPool->stats.freeCount; i++) {
+        vkDestroySemaphore(pPool->device, pPool->freeSemaphores[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE));
+    }
+    if (pPool->pLock != NULL) {
+        HostLockDestroy(pPool->pLock);
+    }
+    free(pPool->freeSemaphores);
+    free(pPool->freeValues);
+    free(pPool);
+}
+
+VkResult AcquirePooledSemaphore(struct SemaphorePool* pPool, VkSemaphore* pSemaphore, uint64_t* pValue)
+{
+    bool fromFreeList = false;
+    uint64_t value = 0;
+    HostLockAcquire(pPool->pLock);
+    VkResult res = TakeObjectPoolSlot(&pPool->stats, &fromFreeList);
+    if (res == VK_SUCCESS && fromFreeList)
+    {
+        *pSemaphore = pPool->freeSemaphores[pPool->stats.freeCount];
+        value = pPool->freeValues[pPool->stats.freeCount];
+    }
+    HostLockRelease(pPool->pLock);
+
+    if (res == VK_SUCCESS && !fromFreeList)
+    {
+        // A timeline semaphore starts at 0, and only ever increases afterwards, so a recycled one carries its value over to the next owner
+        const VkSemaphoreTypeCreateInfo typeCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+            .pNext = NULL,
+            .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+            .initialValue = 0
+        };
+        const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = pPool->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE ? &typeCreateInfo : NULL,
+            .flags = 0
+        };
+        res = vkCreateSemaphore(pPool->device, &semaphoreCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE), pSemaphore);
+
+        HostLockAcquire(pPool->pLock);
+        if (res == VK_SUCCESS) {
+            pPool->stats.createdCount++;
+        }
+        else {
+            CancelObjectPoolSlot(&pPool->stats);
+        }
+        HostLockRelease(pPool->pLock);
+
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateSemaphore failed: %d\n", res);
+        }
+    }
+
+    if (res == VK_SUCCESS && pValue != NULL) {
+        *pValue = value;
+    }
+    return res;
+}
+
+void ReleasePooledSemaphore(struct SemaphorePool* pPool, VkSemaphore semaphore, uint64_t value)
+{
+    if (semaphore == VK_NULL_HANDLE) return;
+
+    HostLockAcquire(pPool->pLock);
+    pPool->stats.liveCount--;
+    pPool->freeSemaphores[pPool->stats.freeCount] = semaphore;
+    pPool->freeValues[pPool->stats.freeCount] = pPool->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE ? value : 0;
+    pPool->stats.freeCount++;
+    pPool->stats.releasedCount++;
+    HostLockRelease(pPool->pLock);
+}
+
+void GetSemaphorePoolStats(const struct SemaphorePool* pPool, struct ObjectPoolStats* pStats)
+{
+    HostLockAcquire(pPool->pLock);
+    *pStats = pPool->stats;
+    HostLockRelease(pPool->pLock);
+}
+
+// MARK: Command buffer pool
+
+struct CommandBufferPool
+{
+    VkDevice device;
+    VkCommandPool commandPool;
+    // maxCount entries, of which the first stats.freeCount are the command buffers ready to be acquired
+    VkCommandBuffer* freeCommandBuffers;
+    struct ObjectPoolStats stats;
+};
+
+VkResult CreateCommandBufferPool(VkDevice device, uint32_t queueFamilyIndex, uint32_t maxCount, struct CommandBufferPool** ppPool)
+{
+    if (device == VK_NULL_HANDLE || maxCount == 0 || ppPool == NULL) return VK_ERROR_INITIALIZATION_FAILED;
+
+    struct CommandBufferPool* pPool = calloc(1, sizeof(*pPool));
+    if (pPool == NULL) return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    pPool->device = device;
+    pPool->freeCommandBuffers = calloc(maxCount, sizeof(*pPool->freeCommandBuffers));
+    pPool->stats.maxCount = maxCount;
+    if (pPool->freeCommandBuffers == NULL)
+    {
+        DestroyCommandBufferPool(pPool);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queueFamilyIndex
+    };
+    const VkResult res = vkCreateCommandPool(device, &commandPoolCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL),
+        &pPool->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateCommandPool failed: %d\n", res);
+        DestroyCommandBufferPool(pPool);
+        return res;
+    }
+
+    *ppPool = pPool;
+    return VK_SUCCESS;
+}
+
+void DestroyCommandBufferPool(struct CommandBufferPool* pPool)
+{
+    if (pPool == NULL) return;
+
+    if (pPool->stats.liveCount > 0) {
+        fprintf(stderr, "DestroyCommandBufferPool: %u command buffer(s) not released!\n", pPool->stats.liveCount);
+    }
+    // Destroying the command pool frees all of its command buffers
+    if (pPool->commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(pPool->device, pPool->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    free(pPool->freeCommandBuffers);
+    free(pPool);
+}
+
+VkResult AcquirePooledCommandBuffer(struct CommandBufferPool* pPool, VkCommandBuffer* pCommandBuffer)
+{
+    bool fromFreeList = false;
+    VkResult res = TakeObjectPoolSlot(&pPool->stats, &fromFreeList);
+    if (res != VK_SUCCESS) return res;
+
+    if (fromFreeList)
+    {
+        // Left as it was executed; the next vkBeginCommandBuffer resets it
+        *pCommandBuffer = pPool->freeCommandBuffers[pPool->stats.freeCount];
+        return VK_SUCCESS;
+    }
+
+    const VkCommandBufferAllocateInfo allocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pPool->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+    res = vkAllocateCommandBuffers(pPool->device, &allocateInfo, pCommandBuffer);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateCommandBuffers failed: %d\n", res);
+        CancelObjectPoolSlot(&pPool->stats);
+        return res;
+    }
+    pPool->stats.createdCount++;
+    return VK_SUCCESS;
+}
+
+void ReleasePooledCommandBuffer(struct CommandBufferPool* pPool, VkCommandBuffer commandBuffer)
+{
+    if (commandBuffer == VK_NULL_HANDLE) return;
+
+    pPool->stats.liveCount--;
+    pPool->freeCommandBuffers[pPool->stats.freeCount++] = commandBuffer;
+    pPool->stats.releasedCount++;
+}
+
+void GetCommandBufferPoolStats(const struct CommandBufferPool* pPool, struct ObjectPoolStats* pStats)
+{
+    *pStats = pPool->stats;
+}
+
+// MARK: Benchmark
+
+// The objects of a job in flight
+struct ObjectPoolJob
+{
+    // Only created by OBJECT_POOL_MODE_CREATE_PER_JOB
+    VkCommandPool commandPool;
+    // The fill, and the copy that waits for it
+    VkCommandBuffer commandBuffers[2];
+    VkSemaphore semaphore;
+    VkFence fence;
+    VkSemaphore timelineSemaphore;
+    // The value the job signals on timelineSemaphore
+    uint64_t timelineValue;
+    bool inFlight;
+    // The fence of a failed wait is discarded rather than released to its pool
+    bool waitFailed;
+};
+
+struct ObjectPoolBenchmarkContext
+{
+    VkDevice device;
+    VkQueue queue;
+    uint32_t queueFamilyIndex;
+    enum ObjectPoolBenchmarkMode mode;
+
+    VkBuffer deviceBuffer;
+    VkBuffer hostBuffer;
+
+    struct FencePool* pFencePool;
+    struct SemaphorePool* pSemaphorePool;
+    struct SemaphorePool* pTimelineSemaphorePool;
+    struct CommandBufferPool* pCommandBufferPool;
+    PFN_vkWaitSemaphores waitSemaphores;
+
+    struct ObjectPoolJob jobs[OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT];
+};
+
+static VkResult CreateObjectPoolJobObjects(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob)
+{
+    const VkDevice device = pBenchmark->device;
+    VkResult res = InitializeCommandBuffer(pBenchmark->queueFamilyIndex, device, &pJob->commandPool, pJob->commandBuffers, 2);
+    if (res != VK_SUCCESS) return res;
+
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    res = vkCreateSemaphore(device, &semaphoreCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE), &pJob->semaphore);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateSemaphore failed: %d\n", res);
+        return res;
+    }
+
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    res = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), &pJob->fence);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkCreateFence failed: %d\n", res);
+    }
+    return res;
+}
+
+static VkResult AcquireObjectPoolJobObjects(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob)
+{
+    if (pBenchmark->mode == OBJECT_POOL_MODE_CREATE_PER_JOB) {
+        return CreateObjectPoolJobObjects(pBenchmark, pJob);
+    }
+
+    VkResult res = AcquirePooledCommandBuffer(pBenchmark->pCommandBufferPool, &pJob->commandBuffers[0]);
+    if (res == VK_SUCCESS) {
+        res = AcquirePooledCommandBuffer(pBenchmark->pCommandBufferPool, &pJob->commandBuffers[1]);
+    }
+    if (res == VK_SUCCESS) {
+        res = AcquirePooledSemaphore(pBenchmark->pSemaphorePool, &pJob->semaphore, NULL);
+    }
+    if (res == VK_SUCCESS)
+    {
+        if (pBenchmark->mode == OBJECT_POOL_MODE_POOLED_TIMELINE)
+        {
+            uint64_t value = 0;
+            res = AcquirePooledSemaphore(pBenchmark->pTimelineSemaphorePool, &pJob->timelineSemaphore, &value);
+            pJob->timelineValue = value + 1;
+        }
+        else {
+            res = AcquirePooledFence(pBenchmark->pFencePool, &pJob->fence);
+        }
+    }
+    return res;
+}
+
+// The job must have completed, or never been submitted.
+static void ReleaseObjectPoolJobObjects(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob)
+{
+    const VkDevice device = pBenchmark->device;
+    if (pBenchmark->mode == OBJECT_POOL_MODE_CREATE_PER_JOB)
+    {
+        if (pJob->fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, pJob->fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+        }
+        if (pJob->semaphore != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, pJob->semaphore, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SEMAPHORE));
+        }
+        if (pJob->commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, pJob->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+        }
+    }
+    else
+    {
+        ReleasePooledCommandBuffer(pBenchmark->pCommandBufferPool, pJob->commandBuffers[0]);
+        ReleasePooledCommandBuffer(pBenchmark->pCommandBufferPool, pJob->commandBuffers[1]);
+        ReleasePooledSemaphore(pBenchmark->pSemaphorePool, pJob->semaphore, 0);
+        if (pBenchmark->pFencePool != NULL && pJob->waitFailed) {
+            DiscardPooledFence(pBenchmark->pFencePool, pJob->fence);
+        }
+        else if (pBenchmark->pFencePool != NULL) {
+            ReleasePooledFence(pBenchmark->pFencePool, pJob->fence);
+        }
+        // Had the job not completed, its value would not have been reached, but the pool only hands out values above the one given back
+        if (pBenchmark->pTimelineSemaphorePool != NULL) {
+            ReleasePooledSemaphore(pBenchmark->pTimelineSemaphorePool, pJob->timelineSemaphore, pJob->timelineValue);
+        }
+    }
+    memset(pJob, 0, sizeof(*pJob));
+}
+
+static VkResult RecordObjectPoolJob(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob, uint32_t slot, uint32_t value)
+{
+    const VkDeviceSize regionSize = OBJECT_POOL_BENCHMARK_ELEM_COUNT * sizeof(uint32_t);
+    const VkDeviceSize offset = slot * regionSize;
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+
+    VkResult res = vkBeginCommandBuffer(pJob->commandBuffers[0], &beginInfo);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", res);
+        return res;
+    }
+    vkCmdFillBuffer(pJob->commandBuffers[0], pBenchmark->deviceBuffer, offset, regionSize, value);
+    res = vkEndCommandBuffer(pJob->commandBuffers[0]);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", res);
+        return res;
+    }
+
+    res = vkBeginCommandBuffer(pJob->commandBuffers[1], &beginInfo);
+    if (res != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", res);
+        return res;
+    }
+    const VkBufferCopy copyRegion = { .srcOffset = offset, .dstOffset = offset, .size = regionSize };
+    vkCmdCopyBuffer(pJob->commandBuffers[1], pBenchmark->deviceBuffer, pBenchmark->hostBuffer, 1, &copyRegion);
+
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT
+    };
+    vkCmdPipelineBarrier(pJob->commandBuffers[1], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+    res = vkEndCommandBuffer(pJob->commandBuffers[1]);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", res);
+    }
+    return res;
+}
+
+static VkResult SubmitObjectPoolJob(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob)
+{
+    // The signal of the semaphore makes the fill available, and its wait makes it visible to the copy
+    const VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    const bool signalTimeline = pBenchmark->mode == OBJECT_POOL_MODE_POOLED_TIMELINE;
+
+    // The value of the binary semaphore waited for is ignored
+    const uint64_t waitValue = 0;
+    const VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {
+        .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreValueCount = 1,
+        .pWaitSemaphoreValues = &waitValue,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &pJob->timelineValue
+    };
+    const VkSubmitInfo submitInfos[2] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = NULL,
+            .waitSemaphoreCount = 0,
+            .pWaitSemaphores = NULL,
+            .pWaitDstStageMask = NULL,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &pJob->commandBuffers[0],
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &pJob->semaphore
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = signalTimeline ? &timelineSubmitInfo : NULL,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &pJob->semaphore,
+            .pWaitDstStageMask = &waitStageMask,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &pJob->commandBuffers[1],
+            .signalSemaphoreCount = signalTimeline ? 1U : 0U,
+            .pSignalSemaphores = signalTimeline ? &pJob->timelineSemaphore : NULL
+        }
+    };
+
+    const VkResult res = vkQueueSubmit(pBenchmark->queue, 2, submitInfos, signalTimeline ? VK_NULL_HANDLE : pJob->fence);
+    if (res != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", res);
+    }
+    return res;
+}
+
+static VkResult WaitObjectPoolJob(struct ObjectPoolBenchmarkContext* pBenchmark, struct ObjectPoolJob* pJob)
+{
+    VkResult res;
+    if (pBenchmark->mode == OBJECT_POOL_MODE_POOLED_TIMELINE)
+    {
+        const VkSemaphoreWaitInfo waitInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .semaphoreCount = 1,
+            .pSemaphores = &pJob->timelineSemaphore,
+            .pValues = &pJob->timelineValue
+        };
+        res = pBenchmark->waitSemaphores(pBenchmark->device, &waitInfo, UINT64_MAX);
+        if (res != VK_SUCCESS) {
+            fprintf(stderr, "vkWaitSemaphores failed: %d\n", res);
+        }
+    }
+    else
+    {
+        res = vkWaitForFences(pBenchmark->device, 1, &pJob->fence, VK_TRUE, UINT64_MAX);
+        if (res != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkWaitForFences failed: %d\n", res);
+            pJob->waitFailed = true;
+        }
+    }
+    pJob->inFlight = false;
+    return res;
+}
+
+// Runs `jobCount` jobs from the job `firstJobIndex`, whose fill value is its index, and waits for all of them.
+static VkResult RunObjectPoolJobs(struct ObjectPoolBenchmarkContext* pBenchmark, uint32_t firstJobIndex, uint32_t jobCount)
+{
+    VkResult res = VK_SUCCESS;
+    for (uint32_t i = 0; i < jobCount && res == VK_SUCCESS; i++)
+    {
+        const uint32_t slot = i % OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT;
+        struct ObjectPoolJob* pJob = &pBenchmark->jobs[slot];
+
+        // The job that used this region before is the oldest one in flight
+        if (pJob->inFlight) {
+            res = WaitObjectPoolJob(pBenchmark, pJob);
+        }
+        ReleaseObjectPoolJobObjects(pBenchmark, pJob);
+        if (res != VK_SUCCESS) break;
+
+        res = AcquireObjectPoolJobObjects(pBenchmark, pJob);
+        if (res == VK_SUCCESS) {
+            res = RecordObjectPoolJob(pBenchmark, pJob, slot, firstJobIndex + i);
+        }
+        if (res == VK_SUCCESS) {
+            res = SubmitObjectPoolJob(pBenchmark, pJob);
+        }
+        pJob->inFlight = res == VK_SUCCESS;
+    }
+
+    for (uint32_t slot = 0; slot < OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT; slot++)
+    {
+        struct ObjectPoolJob* pJob = &pBenchmark->jobs[slot];
+        if (pJob->inFlight)
+        {
+            const VkResult waitResult = WaitObjectPoolJob(pBenchmark, pJob);
+            if (res == VK_SUCCESS) {
+                res = waitResult;
+            }
+        }
+        ReleaseObjectPoolJobObjects(pBenchmark, pJob);
+    }
+    return res;
+}
+
+// The objects created by the pools of the benchmark so far
+static uint64_t GetObjectPoolBenchmarkCreatedCount(const struct ObjectPoolBenchmarkContext* pBenchmark)
+{
+    struct ObjectPoolStats stats;
+    uint64_t createdCount = 0;
+    GetFencePoolStats(pBenchmark->pFencePool, &stats);
+    createdCount += stats.createdCount;
+    GetSemaphorePoolStats(pBenchmark->pSemaphorePool, &stats);
+    createdCount += stats.createdCount;
+    if (pBenchmark->pTimelineSemaphorePool != NULL)
+    {
+        GetSemaphorePoolStats(pBenchmark->pTimelineSemaphorePool, &stats);
+        createdCount += stats.createdCount;
+    }
+    GetCommandBufferPoolStats(pBenchmark->pCommandBufferPool, &stats);
+    return createdCount + stats.createdCount;
+}
+
+void ObjectPoolBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    bool supportTimelineSemaphore)
+{
+    puts("\n================ Begin Vulkan object pool benchmark ================\n");
+
+    struct ObjectPoolBenchmarkContext benchmark = { 0 };
+    benchmark.device = specDevice;
+    benchmark.queueFamilyIndex = specQueueFamilyIndex;
+    VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
+    VkDeviceMemory hostMemory = VK_NULL_HANDLE;
+
+    do
+    {
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &benchmark.queue);
+
+        const VkDeviceSize bufferSize = OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT * OBJECT_POOL_BENCHMARK_ELEM_COUNT * sizeof(uint32_t);
+        VkResult result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &benchmark.deviceBuffer, &deviceMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, specQueueFamilyIndex, &benchmark.hostBuffer, &hostMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        // Every job in flight holds two command buffers, a binary semaphore, and a fence or a timeline semaphore, none of which the pools exceed
+        result = CreateFencePool(specDevice, OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT, &benchmark.pFencePool);
+        if (result == VK_SUCCESS) {
+            result = CreateSemaphorePool(specDevice, VK_SEMAPHORE_TYPE_BINARY, OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT, &benchmark.pSemaphorePool);
+        }
+        if (result == VK_SUCCESS) {
+            result = CreateCommandBufferPool(specDevice, specQueueFamilyIndex, 2 * OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT, &benchmark.pCommandBufferPool);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create the object pools: %d\n", result);
+            break;
+        }
+
+        if (supportTimelineSemaphore)
+        {
+            // Core in Vulkan 1.2, and vkWaitSemaphoresKHR of VK_KHR_timeline_semaphore before it
+            benchmark.waitSemaphores = (PFN_vkWaitSemaphores)vkGetDeviceProcAddr(specDevice, "vkWaitSemaphores");
+            if (benchmark.waitSemaphores == NULL) {
+                benchmark.waitSemaphores = (PFN_vkWaitSemaphores)vkGetDeviceProcAddr(specDevice, "vkWaitSemaphoresKHR");
+            }
+            if (benchmark.waitSemaphores != NULL)
+            {
+                result = CreateSemaphorePool(specDevice, VK_SEMAPHORE_TYPE_TIMELINE, OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT,
+                    &benchmark.pTimelineSemaphorePool);
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "Failed to create the timeline semaphore pool: %d\n", result);
+                    break;
+                }
+            }
+        }
+
+        uint32_t* hostPtr = NULL;
+        result = vkMapMemory(specDevice, hostMemory, 0, VK_WHOLE_SIZE, 0, (void**)&hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+
+        printf("%d jobs of two submissions linked by a semaphore, %d jobs in flight\n", OBJECT_POOL_BENCHMARK_JOB_COUNT,
+            OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT);
+
+        static const char* const modeTitles[OBJECT_POOL_MODE_COUNT] = { "Created per job", "Pooled with fences", "Pooled with timelines" };
+        uint32_t nextJobIndex = 0;
+        double createTime = 0.0;
+        bool verified = true;
+        for (uint32_t mode = 0; mode < OBJECT_POOL_MODE_COUNT && result == VK_SUCCESS; mode++)
+        {
+            if (mode == OBJECT_POOL_MODE_POOLED_TIMELINE && benchmark.pTimelineSemaphorePool == NULL)
+            {
+                printf("%-22s: timeline semaphores are not supported\n", modeTitles[mode]);
+                continue;
+            }
+            benchmark.mode = (enum ObjectPoolBenchmarkMode)mode;
+
+            // The warm-up jobs grow the pools to the jobs in flight, after which the measured jobs create no object
+            result = RunObjectPoolJobs(&benchmark, nextJobIndex, OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT);
+            nextJobIndex += OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT;
+            if (result != VK_SUCCESS) break;
+
+            const uint64_t createdCount = GetObjectPoolBenchmarkCreatedCount(&benchmark);
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunObjectPoolJobs(&benchmark, nextJobIndex, OBJECT_POOL_BENCHMARK_JOB_COUNT);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            // The last job of every region wrote its index to it
+            for (uint32_t slot = 0; slot < OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT && verified; slot++)
+            {
+                const uint32_t expected = nextJobIndex + OBJECT_POOL_BENCHMARK_JOB_COUNT - OBJECT_POOL_BENCHMARK_IN_FLIGHT_JOB_COUNT + slot;
+                const uint32_t* region = hostPtr + slot * OBJECT_POOL_BENCHMARK_ELEM_COUNT;
+                for (uint32_t i = 0; i < OBJECT_POOL_BENCHMARK_ELEM_COUNT; i++)
+                {
+                    if (region[i] != expected)
+                    {
+                        fprintf(stderr, "Result mismatch of %s @%u: %u, expected %u\n", modeTitles[mode], slot * OBJECT_POOL_BENCHMARK_ELEM_COUNT + i,
+                            region[i], expected);
+                        verified = false;
+                        break;
+                    }
+                }
+            }
+            nextJobIndex += OBJECT_POOL_BENCHMARK_JOB_COUNT;
+
+            const double jobTime = (double)elapsedTime / OBJECT_POOL_BENCHMARK_JOB_COUNT;
+            if (mode == OBJECT_POOL_MODE_CREATE_PER_JOB)
+            {
+                createTime = jobTime;
+                printf("%-22s: %8.2f us per job, %9.0f jobs/s, 5 objects created and destroyed per job\n", modeTitles[mode], jobTime / 1000.0,
+                    jobTime > 0.0 ? 1e9 / jobTime : 0.0);
+            }
+            else
+            {
+                printf("%-22s: %8.2f us per job, %9.0f jobs/s, %5.2fx the created objects, %llu objects created by the measured jobs\n", modeTitles[mode],
+                    jobTime / 1000.0, jobTime > 0.0 ? 1e9 / jobTime : 0.0, jobTime > 0.0 ? createTime / jobTime : 0.0,
+                    (unsigned long long)(GetObjectPoolBenchmarkCreatedCount(&benchmark) - createdCount));
+            }
+        }
+        vkUnmapMemory(specDevice, hostMemory);
+
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "The object pool benchmark failed: %d\n", result);
+            break;
+        }
+
+        struct ObjectPoolStats stats;
+        GetFencePoolStats(benchmark.pFencePool, &stats);
+        PrintObjectPoolStats("Fence pool:", &stats);
+        GetSemaphorePoolStats(benchmark.pSemaphorePool, &stats);
+        PrintObjectPoolStats("Semaphore pool:", &stats);
+        if (benchmark.pTimelineSemaphorePool != NULL)
+        {
+            GetSemaphorePoolStats(benchmark.pTimelineSemaphorePool, &stats);
+            PrintObjectPoolStats("Timeline pool:", &stats);
+        }
+        GetCommandBufferPoolStats(benchmark.pCommandBufferPool, &stats);
+        PrintObjectPoolStats("Command buffer pool:", &stats);
+        printf("Object pool results: %s\n", verified ? "verify OK" : "verify FAILED");
+    } while (false);
+
+    // The jobs still hold nothing here: RunObjectPoolJobs releases them all even when it fails
+    DestroyCommandBufferPool(benchmark.pCommandBufferPool);
+    DestroySemaphorePool(benchmark.pTimelineSemaphorePool);
+    DestroySemaphorePool(benchmark.pSemaphorePool);
+    DestroyFencePool(benchmark.pFencePool);
+    DestroyBufferWithMemory(specDevice, benchmark.deviceBuffer, deviceMemory);
+    DestroyBufferWithMemory(specDevice, benchmark.hostBuffer, hostMemory);
+
+    puts("\n================ Complete Vulkan object pool benchmark ================\n");
+}
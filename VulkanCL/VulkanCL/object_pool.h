@@ -0,0 +1,96 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Recycling pools of the per-job Vulkan objects: fences, binary and timeline semaphores, and primary command buffers.
+// An object released to its pool is kept in the free list of the pool, and handed out again by the next acquisition, so once the pools have
+// grown to the number of jobs in flight, a job creates and destroys no Vulkan object at all.
+// Every pool is bounded by the `maxCount` it is created with: the objects acquired and the ones in the free list never exceed it,
+// and an acquisition beyond it fails with VK_ERROR_TOO_MANY_OBJECTS instead of growing the pool.
+//
+// The fence and semaphore pools are thread-safe. A command buffer pool wraps one VkCommandPool, which must be externally synchronized
+// while its command buffers are allocated, reset or recorded, so it is used by one thread at a time, such as one pool per thread.
+
+struct ObjectPoolStats
+{
+    // The objects created by the pool, and the acquisitions served from the free list instead
+    uint64_t createdCount;
+    uint64_t reusedCount;
+    uint64_t releasedCount;
+    // The acquisitions refused because `maxCount` objects were out already
+    uint64_t exhaustedCount;
+    // The fences given to DiscardPooledFence that were destroyed, and the ones left alive because they might still be pending.
+    // A pool with leaked fences is poisoned: it keeps working, but the device has objects the application can no longer destroy.
+    uint64_t discardedCount;
+    uint64_t leakedCount;
+    // The objects acquired and not released yet, and the most of them at any time
+    uint32_t liveCount;
+    uint32_t peakLiveCount;
+    uint32_t freeCount;
+    uint32_t maxCount;
+};
+
+// MARK: Fence pool
+
+struct FencePool;
+
+extern VkResult CreateFencePool(VkDevice device, uint32_t maxCount, struct FencePool** ppPool);
+// All the fences must have been released.
+extern void DestroyFencePool(struct FencePool* pPool);
+extern VkDevice GetFencePoolDevice(const struct FencePool* pPool);
+
+// Receives an unsignaled fence.
+extern VkResult AcquirePooledFence(struct FencePool* pPool, VkFence* pFence);
+// The fence must not be pending: either it has been waited for, or it has never been submitted. It is reset here.
+extern void ReleasePooledFence(struct FencePool* pPool, VkFence fence);
+// For a fence whose wait has failed, so that its state is unknown: it is never handed out again.
+// It is destroyed only if it is signaled or the device is lost, since a pending fence must not be destroyed.
+// Otherwise it is leaked and counted in `leakedCount`. vkDeviceWaitIdle is not an option, as the other users of the device may be submitting meanwhile.
+extern void DiscardPooledFence(struct FencePool* pPool, VkFence fence);
+// For an owner that keeps its fence across submissions: discards *pFence after a failed wait and acquires another one in its place,
+// so that a fence that might still be pending is neither reset nor submitted again. *pFence is VK_NULL_HANDLE if the acquisition fails.
+extern VkResult ReplacePooledFence(struct FencePool* pPool, VkFence* pFence);
+extern void GetFencePoolStats(const struct FencePool* pPool, struct ObjectPoolStats* pStats);
+
+// MARK: Semaphore pool
+
+struct SemaphorePool;
+
+// @param semaphoreType: VK_SEMAPHORE_TYPE_BINARY, or VK_SEMAPHORE_TYPE_TIMELINE, which requires the `timelineSemaphore` feature
+extern VkResult CreateSemaphorePool(VkDevice device, VkSemaphoreType semaphoreType, uint32_t maxCount, struct SemaphorePool** ppPool);
+// All the semaphores must have been released.
+extern void DestroySemaphorePool(struct SemaphorePool* pPool);
+
+// @param pValue: receives the current value of a timeline semaphore, above which the new owner signals. It may be NULL for a binary one.
+extern VkResult AcquirePooledSemaphore(struct SemaphorePool* pPool, VkSemaphore* pSemaphore, uint64_t* pValue);
+// A binary semaphore must have no signal nor wait pending, which holds once the fence of the submission that waited for it is signaled.
+// @param value: the last value a timeline semaphore has reached. It is ignored for a binary one.
+extern void ReleasePooledSemaphore(struct SemaphorePool* pPool, VkSemaphore semaphore, uint64_t value);
+extern void GetSemaphorePoolStats(const struct SemaphorePool* pPool, struct ObjectPoolStats* pStats);
+
+// MARK: Command buffer pool
+
+struct CommandBufferPool;
+
+// The command buffers are primary, from a VkCommandPool with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+// so a recycled command buffer is reset implicitly by vkBeginCommandBuffer.
+extern VkResult CreateCommandBufferPool(VkDevice device, uint32_t queueFamilyIndex, uint32_t maxCount, struct CommandBufferPool** ppPool);
+// Frees all the command buffers of the pool, which must not be pending.
+extern void DestroyCommandBufferPool(struct CommandBufferPool* pPool);
+
+extern VkResult AcquirePooledCommandBuffer(struct CommandBufferPool* pPool, VkCommandBuffer* pCommandBuffer);
+// The command buffer must not be pending.
+extern void ReleasePooledCommandBuffer(struct CommandBufferPool* pPool, VkCommandBuffer commandBuffer);
+extern void GetCommandBufferPoolStats(const struct CommandBufferPool* pPool, struct ObjectPoolStats* pStats);
+
+// Runs jobs of two submissions linked by a binary semaphore, creating and destroying their objects every job,
+// and then with the pools, with a fence or a timeline semaphore for the completion. Reports the jobs per second and the pool statistics.
+extern void ObjectPoolBenchmark(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    bool supportTimelineSemaphore);
+
+#endif // !OBJECT_POOL_H
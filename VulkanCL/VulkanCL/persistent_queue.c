@@ -0,0 +1,672 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "pipeline_variants.h"
+#include "launch_advisor.h"
+#include "persistent_queue.h"
+
+// The words of the control block, identical to QUEUE_CONTROL_* in persistent_queue.cl
+enum PersistentQueueControl
+{
+    PERSISTENT_QUEUE_CONTROL_HEAD,
+    PERSISTENT_QUEUE_CONTROL_TAIL,
+    PERSISTENT_QUEUE_CONTROL_STOP,
+    PERSISTENT_QUEUE_CONTROL_ACTIVE,
+    PERSISTENT_QUEUE_CONTROL_WORD_COUNT
+};
+
+// The storage buffer bindings in the order of the kernel arguments
+enum PersistentQueueBinding
+{
+    PERSISTENT_QUEUE_BINDING_CONTROL,
+    PERSISTENT_QUEUE_BINDING_JOBS,
+    PERSISTENT_QUEUE_BINDING_COMPLETIONS,
+    PERSISTENT_QUEUE_BINDING_SRC,
+    PERSISTENT_QUEUE_BINDING_DST,
+    PERSISTENT_QUEUE_BINDING_COUNT
+};
+
+enum
+{
+    // The workgroups of the persistent dispatch retire after this many empty polls in a row, or this many polls in total
+    PERSISTENT_QUEUE_MAX_IDLE_POLLS = 1 << 18,
+    PERSISTENT_QUEUE_POLL_BUDGET = 1 << 22,
+    // The job size the workgroup size is advised for
+    PERSISTENT_QUEUE_ADVISED_JOB_ELEM_COUNT = 1024,
+
+    PERSISTENT_QUEUE_TEST_CAPACITY = 64,
+    PERSISTENT_QUEUE_TEST_JOB_COUNT = 1000,
+    // 4 KB per job
+    PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT = 1024
+};
+
+// The bound of a single job in the test, beyond which the job is regarded as lost
+#define PERSISTENT_QUEUE_TEST_TIMEOUT_NS    1000000000ULL
+
+static const char s_persistentQueueKernelName[] = "PersistentQueueKernel";
+
+struct PersistentQueuePushConstants
+{
+    uint32_t capacity;
+    uint32_t maxIdlePolls;
+    uint32_t pollBudget;
+};
+
+struct PersistentQueue
+{
+    VkDevice device;
+    VkQueue queue;
+    struct PipelineVariantCache* pCache;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descLayout;
+    VkPipelineLayout pipelineLayout;
+    VkDescriptorPool descriptorPool;
+    VkDescriptorSet descriptorSet;
+    VkCommandPool commandPool;
+    // [0] runs the persistent dispatch, [1] drains the ring with a single workgroup
+    VkCommandBuffer commandBuffers[2];
+    VkFence fence;
+    // Whether a submission of the persistent dispatch has not been waited for
+    bool isRunning;
+
+    VkBuffer buffers[PERSISTENT_QUEUE_BINDING_COUNT];
+    VkDeviceMemory memories[PERSISTENT_QUEUE_BINDING_COUNT];
+    void* mappedPointers[PERSISTENT_QUEUE_BINDING_COUNT];
+
+    uint32_t capacity;
+    uint32_t dataElemCount;
+    uint32_t workgroupSize;
+    uint32_t groupCount;
+    // The number of jobs published so far, i.e. the ticket of the next job
+    uint32_t tail;
+    uint32_t relaunchCount;
+};
+
+static volatile uint32_t* GetControlWords(struct PersistentQueue* pQueue)
+{
+    return pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_CONTROL];
+}
+
+static volatile uint32_t* GetCompletionWords(struct PersistentQueue* pQueue)
+{
+    return pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_COMPLETIONS];
+}
+
+// Host visible memory that is device local as well is preferred, so that the polls of the device do not cross the bus.
+static VkResult CreateMappedBuffer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceSize size,
+    uint32_t queueFamilyIndex, VkBuffer* pBuffer, VkDeviceMemory* pMemory, void** ppMapped)
+{
+    const VkMemoryPropertyFlags hostMemoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    VkResult result = VK_ERROR_FEATURE_NOT_PRESENT;
+    if (FindMemoryTypeIndex(pMemoryProperties, UINT32_MAX, hostMemoryFlags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != UINT32_MAX)
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            hostMemoryFlags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, pBuffer, pMemory);
+    }
+    if (result != VK_SUCCESS)
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemoryFlags,
+            queueFamilyIndex, pBuffer, pMemory);
+    }
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    result = vkMapMemory(device, *pMemory, 0, VK_WHOLE_SIZE, 0, ppMapped);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkMapMemory failed: %d\n", result);
+        *ppMapped = NULL;
+    }
+    return result;
+}
+
+static VkResult RecordPersistentQueueCommands(struct PersistentQueue* pQueue, VkCommandBuffer commandBuffer, VkPipeline pipeline,
+    const struct PersistentQueuePushConstants* pPushConstants, uint32_t groupCount)
+{
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        // Submitted many times
+        .flags = 0,
+        .pInheritanceInfo = NULL
+    };
+    VkResult result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", result);
+        return result;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pQueue->pipelineLayout, 0, 1, &pQueue->descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pQueue->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*pPushConstants), pPushConstants);
+    vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+    RecordComputeToHostBarrier(commandBuffer);
+
+    result = vkEndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+    }
+    return result;
+}
+
+VkResult CreatePersistentQueue(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, uint32_t capacity, uint32_t dataElemCount,
+    struct PersistentQueue** ppQueue)
+{
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 || dataElemCount == 0)
+    {
+        fprintf(stderr, "The capacity of a persistent queue must be a power of 2!\n");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // The first invocation of a workgroup keeps the claimed job in one local word
+    const struct LaunchKernelResources resources = {
+        .localMemorySize = sizeof(uint32_t),
+        .localMemorySizePerInvocation = 0,
+        .maxWorkgroupSize = 0
+    };
+    struct LaunchConfig launchConfig;
+    if (!AdviseLaunchConfig(pModel, &resources, PERSISTENT_QUEUE_ADVISED_JOB_ELEM_COUNT, &launchConfig))
+    {
+        fprintf(stderr, "No launch configuration for %s!\n", s_persistentQueueKernelName);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct PersistentQueue* pQueue = calloc(1, sizeof(*pQueue));
+    if (pQueue == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pQueue->device = device;
+    pQueue->pCache = pCache;
+    pQueue->capacity = capacity;
+    pQueue->dataElemCount = dataElemCount;
+    pQueue->workgroupSize = launchConfig.workgroupSize;
+    // All the workgroups should be resident at a time. Without the compute unit count, fill one compute unit.
+    pQueue->groupCount = launchConfig.residentGroupCount > 0 ? launchConfig.residentGroupCount : launchConfig.residentWorkgroupsPerComputeUnit;
+    vkGetDeviceQueue(device, queueFamilyIndex, 0, &pQueue->queue);
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        const VkDeviceSize bufferSizes[PERSISTENT_QUEUE_BINDING_COUNT] = {
+            [PERSISTENT_QUEUE_BINDING_CONTROL] = PERSISTENT_QUEUE_CONTROL_WORD_COUNT * sizeof(uint32_t),
+            [PERSISTENT_QUEUE_BINDING_JOBS] = (VkDeviceSize)capacity * 4 * sizeof(uint32_t),
+            [PERSISTENT_QUEUE_BINDING_COMPLETIONS] = (VkDeviceSize)capacity * sizeof(uint32_t),
+            [PERSISTENT_QUEUE_BINDING_SRC] = (VkDeviceSize)dataElemCount * sizeof(uint32_t),
+            [PERSISTENT_QUEUE_BINDING_DST] = (VkDeviceSize)dataElemCount * sizeof(uint32_t)
+        };
+        for (int i = 0; i < PERSISTENT_QUEUE_BINDING_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = CreateMappedBuffer(device, pMemoryProperties, bufferSizes[i], queueFamilyIndex, &pQueue->buffers[i], &pQueue->memories[i],
+                &pQueue->mappedPointers[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateMappedBuffer failed!\n");
+            break;
+        }
+
+        memset(pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_CONTROL], 0, (size_t)bufferSizes[PERSISTENT_QUEUE_BINDING_CONTROL]);
+        // The slot of ticket t is free when it holds the sequence of ticket (t - capacity), i.e. t - capacity + 1
+        for (uint32_t slot = 0; slot < capacity; slot++) {
+            GetCompletionWords(pQueue)[slot] = slot - capacity + 1U;
+        }
+
+        result = CreateShaderModule(device, "shaders/persistent_queue/persistent_queue.spv", &pQueue->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(device, PERSISTENT_QUEUE_BINDING_COUNT, &pQueue->descLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        result = CreateComputePipelineLayout(device, pQueue->descLayout, sizeof(struct PersistentQueuePushConstants), &pQueue->pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSet(device, pQueue->descLayout, pQueue->buffers, PERSISTENT_QUEUE_BINDING_COUNT,
+            &pQueue->descriptorPool, &pQueue->descriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        const uint32_t specConstants[] = { pQueue->workgroupSize, 1U, 1U };
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        result = GetPipelineVariant(pCache, pQueue->shaderModule, s_persistentQueueKernelName, pQueue->pipelineLayout, specConstants,
+            (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0])), &pipeline);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "GetPipelineVariant failed: %d\n", result);
+            break;
+        }
+
+        result = InitializeCommandBuffer(queueFamilyIndex, device, &pQueue->commandPool, pQueue->commandBuffers, 2);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        const struct PersistentQueuePushConstants persistentPushConstants = { capacity, PERSISTENT_QUEUE_MAX_IDLE_POLLS, PERSISTENT_QUEUE_POLL_BUDGET };
+        result = RecordPersistentQueueCommands(pQueue, pQueue->commandBuffers[0], pipeline, &persistentPushConstants, pQueue->groupCount);
+        if (result != VK_SUCCESS) break;
+
+        // The draining workgroup exits at the first empty poll
+        const struct PersistentQueuePushConstants drainPushConstants = { capacity, 1U, UINT32_MAX };
+        result = RecordPersistentQueueCommands(pQueue, pQueue->commandBuffers[1], pipeline, &drainPushConstants, 1);
+        if (result != VK_SUCCESS) break;
+
+        const VkFenceCreateInfo fenceCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0
+        };
+        result = vkCreateFence(device, &fenceCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE), &pQueue->fence);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyPersistentQueue(pQueue);
+        pQueue = NULL;
+    }
+    *ppQueue = pQueue;
+    return result;
+}
+
+void DestroyPersistentQueue(struct PersistentQueue* pQueue)
+{
+    if (pQueue == NULL) return;
+
+    VkDevice device = pQueue->device;
+    if (pQueue->isRunning) {
+        StopPersistentQueue(pQueue);
+    }
+
+    if (pQueue->fence != VK_NULL_HANDLE) {
+        vkDestroyFence(device, pQueue->fence, GetHostAllocationCallbacks(VK_OBJECT_TYPE_FENCE));
+    }
+    if (pQueue->commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, pQueue->commandPool, 2, pQueue->commandBuffers);
+        vkDestroyCommandPool(device, pQueue->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    if (pQueue->descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, pQueue->descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    // The pipeline belongs to the pipeline variant cache
+    if (pQueue->shaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(pQueue->pCache, pQueue->shaderModule);
+        vkDestroyShaderModule(device, pQueue->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+    if (pQueue->pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pQueue->pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pQueue->descLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pQueue->descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    for (int i = 0; i < PERSISTENT_QUEUE_BINDING_COUNT; i++)
+    {
+        if (pQueue->mappedPointers[i] != NULL) {
+            vkUnmapMemory(device, pQueue->memories[i]);
+        }
+        DestroyBufferWithMemory(device, pQueue->buffers[i], pQueue->memories[i]);
+    }
+
+    free(pQueue);
+}
+
+uint32_t* GetPersistentQueueSource(struct PersistentQueue* pQueue)
+{
+    return pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_SRC];
+}
+
+uint32_t* GetPersistentQueueDestination(struct PersistentQueue* pQueue)
+{
+    return pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_DST];
+}
+
+static VkResult SubmitPersistentQueueCommands(struct PersistentQueue* pQueue, VkCommandBuffer commandBuffer)
+{
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    VkResult result = vkQueueSubmit(pQueue->queue, 1, &submitInfo, pQueue->fence);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+    }
+    return result;
+}
+
+// Waits for the fence of the last submission and resets it.
+static VkResult WaitAndResetFence(struct PersistentQueue* pQueue)
+{
+    VkResult result = vkWaitForFences(pQueue->device, 1, &pQueue->fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+        return result;
+    }
+    result = vkResetFences(pQueue->device, 1, &pQueue->fence);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkResetFences failed: %d\n", result);
+    }
+    return result;
+}
+
+VkResult StartPersistentQueue(struct PersistentQueue* pQueue)
+{
+    if (pQueue->isRunning) {
+        return VK_SUCCESS;
+    }
+
+    const VkResult result = SubmitPersistentQueueCommands(pQueue, pQueue->commandBuffers[0]);
+    pQueue->isRunning = result == VK_SUCCESS;
+    return result;
+}
+
+VkResult StopPersistentQueue(struct PersistentQueue* pQueue)
+{
+    if (!pQueue->isRunning) {
+        return VK_SUCCESS;
+    }
+
+    volatile uint32_t* pControl = GetControlWords(pQueue);
+    HostAtomicStoreUInt32(&pControl[PERSISTENT_QUEUE_CONTROL_STOP], 1U);
+    const VkResult result = WaitAndResetFence(pQueue);
+    pQueue->isRunning = false;
+    HostAtomicStoreUInt32(&pControl[PERSISTENT_QUEUE_CONTROL_STOP], 0);
+    return result;
+}
+
+VkResult EnqueuePersistentQueueJob(struct PersistentQueue* pQueue, uint32_t srcOffset, uint32_t dstOffset, uint32_t elemCount,
+    uint32_t* pTicket)
+{
+    if (elemCount > pQueue->dataElemCount || srcOffset > pQueue->dataElemCount - elemCount || dstOffset > pQueue->dataElemCount - elemCount) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const uint32_t ticket = pQueue->tail;
+    const uint32_t slot = ticket & (pQueue->capacity - 1U);
+    if (HostAtomicLoadUInt32(&GetCompletionWords(pQueue)[slot]) != ticket - pQueue->capacity + 1U) {
+        return VK_NOT_READY;
+    }
+
+    volatile uint32_t* pDescriptor = (volatile uint32_t*)pQueue->mappedPointers[PERSISTENT_QUEUE_BINDING_JOBS] + (size_t)slot * 4;
+    pDescriptor[0] = srcOffset;
+    pDescriptor[1] = dstOffset;
+    pDescriptor[2] = elemCount;
+    pDescriptor[3] = ticket + 1U;
+
+    // The release store publishes the descriptor together with the tail
+    pQueue->tail = ticket + 1U;
+    HostAtomicStoreUInt32(&GetControlWords(pQueue)[PERSISTENT_QUEUE_CONTROL_TAIL], pQueue->tail);
+
+    *pTicket = ticket;
+    return VK_SUCCESS;
+}
+
+VkResult WaitPersistentQueueJob(struct PersistentQueue* pQueue, uint32_t ticket, uint64_t timeoutNanoseconds)
+{
+    volatile uint32_t* pCompletion = &GetCompletionWords(pQueue)[ticket & (pQueue->capacity - 1U)];
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    while (HostAtomicLoadUInt32(pCompletion) != ticket + 1U)
+    {
+        // All the workgroups have retired before taking the job
+        if (pQueue->isRunning && vkGetFenceStatus(pQueue->device, pQueue->fence) == VK_SUCCESS)
+        {
+            VkResult result = vkResetFences(pQueue->device, 1, &pQueue->fence);
+            pQueue->isRunning = false;
+            if (result == VK_SUCCESS) {
+                result = StartPersistentQueue(pQueue);
+            }
+            if (result != VK_SUCCESS) {
+                return result;
+            }
+            pQueue->relaunchCount++;
+        }
+
+        if (HostGetTimeNanoseconds() - beginTime > timeoutNanoseconds) {
+            return VK_TIMEOUT;
+        }
+    }
+    return VK_SUCCESS;
+}
+
+VkResult DrainPersistentQueue(struct PersistentQueue* pQueue)
+{
+    if (pQueue->isRunning) {
+        return VK_NOT_READY;
+    }
+
+    const VkResult result = SubmitPersistentQueueCommands(pQueue, pQueue->commandBuffers[1]);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+    return WaitAndResetFence(pQueue);
+}
+
+uint32_t GetPersistentQueueRelaunchCount(const struct PersistentQueue* pQueue)
+{
+    return pQueue->relaunchCount;
+}
+
+// MARK: Test
+
+static int CompareLatency(const void* a, const void* b)
+{
+    const uint64_t lhs = *(const uint64_t*)a;
+    const uint64_t rhs = *(const uint64_t*)b;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+// Sorts `latencies` and prints the percentiles in microseconds.
+static void PrintLatencyPercentiles(const char* title, uint64_t latencies[], uint32_t count)
+{
+    qsort(latencies, count, sizeof(latencies[0]), CompareLatency);
+    const double p50 = (double)latencies[(count - 1) * 50 / 100] / 1000.0;
+    const double p90 = (double)latencies[(count - 1) * 90 / 100] / 1000.0;
+    const double p99 = (double)latencies[(count - 1) * 99 / 100] / 1000.0;
+    const double maximum = (double)latencies[count - 1] / 1000.0;
+    printf("%-24s p50: %9.2f us, p90: %9.2f us, p99: %9.2f us, max: %9.2f us\n", title, p50, p90, p99, maximum);
+}
+
+// Returns the index of the first element that is not src[i] * 2 + 1, or SIZE_MAX.
+static size_t FindPersistentQueueMismatch(const uint32_t* dst, const uint32_t* src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (dst[i] != src[i] * 2U + 1U) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Runs the jobs one at a time, measuring from the enqueue to the observed completion of each.
+static VkResult RunPersistentQueueJobs(struct PersistentQueue* pQueue, bool isPersistent, uint64_t latencies[])
+{
+    VkResult result = VK_SUCCESS;
+    for (uint32_t job = 0; job < PERSISTENT_QUEUE_TEST_JOB_COUNT && result == VK_SUCCESS; job++)
+    {
+        const uint32_t offset = job * PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT;
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+
+        uint32_t ticket = 0;
+        result = EnqueuePersistentQueueJob(pQueue, offset, offset, PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT, &ticket);
+        if (result == VK_SUCCESS && !isPersistent) {
+            result = DrainPersistentQueue(pQueue);
+        }
+        if (result == VK_SUCCESS) {
+            result = WaitPersistentQueueJob(pQueue, ticket, PERSISTENT_QUEUE_TEST_TIMEOUT_NS);
+        }
+
+        latencies[job] = HostGetTimeNanoseconds() - beginTime;
+    }
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "Running the %s jobs failed: %d\n", isPersistent ? "persistent" : "per-submission", result);
+    }
+    return result;
+}
+
+// Keeps up to `capacity` jobs in flight, waiting for the oldest one only when the ring is full,
+// so that every slot is reused PERSISTENT_QUEUE_TEST_JOB_COUNT / capacity times while the kernel is still busy with the others.
+// The host never has more than `capacity` jobs in flight, otherwise the slot of a job it has not waited for yet could be taken over.
+static VkResult RunPersistentQueueBurst(struct PersistentQueue* pQueue, uint32_t* pRingFullCount)
+{
+    VkResult result = VK_SUCCESS;
+    uint32_t ringFullCount = 0;
+    uint32_t oldestTicket = pQueue->tail;
+    for (uint32_t job = 0; job < PERSISTENT_QUEUE_TEST_JOB_COUNT && result == VK_SUCCESS; )
+    {
+        uint32_t ticket = 0;
+        if (pQueue->tail - oldestTicket < pQueue->capacity) {
+            result = EnqueuePersistentQueueJob(pQueue, job * PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT, job * PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT,
+                PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT, &ticket);
+        }
+        else {
+            result = VK_NOT_READY;
+        }
+
+        if (result == VK_SUCCESS) {
+            job++;
+        }
+        else if (result == VK_NOT_READY)
+        {
+            ringFullCount++;
+            result = WaitPersistentQueueJob(pQueue, oldestTicket++, PERSISTENT_QUEUE_TEST_TIMEOUT_NS);
+        }
+    }
+    while (result == VK_SUCCESS && oldestTicket != pQueue->tail) {
+        result = WaitPersistentQueueJob(pQueue, oldestTicket++, PERSISTENT_QUEUE_TEST_TIMEOUT_NS);
+    }
+
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "Running the burst of jobs failed: %d\n", result);
+    }
+    *pRingFullCount = ringFullCount;
+    return result;
+}
+
+void PersistentQueueComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache)
+{
+    puts("\n================ Begin persistent queue test ================\n");
+
+    struct PersistentQueue* pQueue = NULL;
+    uint64_t* latencies = NULL;
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/persistent_queue/persistent_queue.spv"))
+        {
+            puts("shaders/persistent_queue/persistent_queue.spv has not been built by shaders/persistent_queue/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        const uint32_t dataElemCount = PERSISTENT_QUEUE_TEST_JOB_COUNT * PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT;
+        VkResult result = CreatePersistentQueue(specDevice, pMemoryProperties, specQueueFamilyIndex, pModel, pCache, PERSISTENT_QUEUE_TEST_CAPACITY,
+            dataElemCount, &pQueue);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreatePersistentQueue failed: %d\n", result);
+            break;
+        }
+
+        latencies = malloc(PERSISTENT_QUEUE_TEST_JOB_COUNT * sizeof(*latencies));
+        if (latencies == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+
+        uint32_t* src = GetPersistentQueueSource(pQueue);
+        uint32_t* dst = GetPersistentQueueDestination(pQueue);
+        HostParallelFillSequence((int*)src, dataElemCount, 0);
+
+        printf("Jobs: %d of %zu bytes, workgroup size: %u, persistent workgroups: %u\n", PERSISTENT_QUEUE_TEST_JOB_COUNT,
+            PERSISTENT_QUEUE_TEST_JOB_ELEM_COUNT * sizeof(uint32_t), pQueue->workgroupSize, pQueue->groupCount);
+
+        // A submission and a fence wait per job
+        memset(dst, 0, dataElemCount * sizeof(uint32_t));
+        result = RunPersistentQueueJobs(pQueue, false, latencies);
+        if (result != VK_SUCCESS) break;
+
+        size_t errIndex = FindPersistentQueueMismatch(dst, src, dataElemCount);
+        if (errIndex != SIZE_MAX) {
+            fprintf(stderr, "Per-submission result error @ %zu: %u\n", errIndex, dst[errIndex]);
+        }
+        PrintLatencyPercentiles("Submission per job", latencies, PERSISTENT_QUEUE_TEST_JOB_COUNT);
+
+        // The persistent dispatch, one job at a time and then a burst that wraps around the full ring
+        memset(dst, 0, dataElemCount * sizeof(uint32_t));
+        result = StartPersistentQueue(pQueue);
+        if (result == VK_SUCCESS) {
+            result = RunPersistentQueueJobs(pQueue, true, latencies);
+        }
+        uint32_t ringFullCount = 0;
+        uint64_t burstTime = 0;
+        if (result == VK_SUCCESS)
+        {
+            errIndex = FindPersistentQueueMismatch(dst, src, dataElemCount);
+            if (errIndex != SIZE_MAX) {
+                fprintf(stderr, "Persistent result error @ %zu: %u\n", errIndex, dst[errIndex]);
+            }
+            PrintLatencyPercentiles("Persistent dispatch", latencies, PERSISTENT_QUEUE_TEST_JOB_COUNT);
+
+            memset(dst, 0, dataElemCount * sizeof(uint32_t));
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = RunPersistentQueueBurst(pQueue, &ringFullCount);
+            burstTime = HostGetTimeNanoseconds() - beginTime;
+        }
+        const VkResult stopResult = StopPersistentQueue(pQueue);
+        if (result != VK_SUCCESS || stopResult != VK_SUCCESS) break;
+
+        errIndex = FindPersistentQueueMismatch(dst, src, dataElemCount);
+        if (errIndex != SIZE_MAX) {
+            fprintf(stderr, "Burst result error @ %zu: %u\n", errIndex, dst[errIndex]);
+        }
+        printf("Burst of %d jobs through %u slots: %.2f ms, the ring was full %u times (%s)\n", PERSISTENT_QUEUE_TEST_JOB_COUNT,
+            pQueue->capacity, (double)burstTime / 1000000.0, ringFullCount, errIndex == SIZE_MAX ? "verify OK" : "verify FAILED");
+        printf("The persistent dispatch was submitted again %u times. A job waits at most %.1f ms before it is regarded as lost.\n",
+            GetPersistentQueueRelaunchCount(pQueue), (double)PERSISTENT_QUEUE_TEST_TIMEOUT_NS / 1000000.0);
+    } while (false);
+
+    free(latencies);
+    DestroyPersistentQueue(pQueue);
+
+    puts("\n================ Complete persistent queue test ================\n");
+}
+
@@ -0,0 +1,62 @@
+#ifndef PERSISTENT_QUEUE_H
+#define PERSISTENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+struct LaunchDeviceModel;
+struct PipelineVariantCache;
+
+// Persistent-threads execution of tiny jobs (shaders/persistent_queue/persistent_queue.cl).
+// One long-running dispatch, as many workgroups as the launch advisor predicts to be resident, keeps pulling jobs
+// from a ring of job descriptors in host visible memory. The host enqueues a job by writing its descriptor and bumping the tail,
+// and polls the completion slot of the job, so no vkQueueSubmit or vkWaitForFences is on the path of a job.
+//
+// The workgroups retire after a bounded number of polls, so a dispatch never runs long enough for the driver watchdog,
+// and WaitPersistentQueueJob submits the dispatch again when it finds them all retired.
+// The host and the device exchange the words of the ring while the dispatch runs, which relies on HOST_COHERENT memory
+// being coherent in practice rather than on the availability and visibility operations of the Vulkan memory model.
+
+struct PersistentQueue;
+
+// @param capacity: the number of descriptors of the ring, a power of 2
+// @param dataElemCount: the element count of the source and destination buffers the jobs index into
+extern VkResult CreatePersistentQueue(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache, uint32_t capacity, uint32_t dataElemCount,
+    struct PersistentQueue** ppQueue);
+// Stops the dispatch if it is running.
+extern void DestroyPersistentQueue(struct PersistentQueue* pQueue);
+
+// The mapped source and destination buffers of `dataElemCount` elements
+extern uint32_t* GetPersistentQueueSource(struct PersistentQueue* pQueue);
+extern uint32_t* GetPersistentQueueDestination(struct PersistentQueue* pQueue);
+
+// Submits the persistent dispatch if it is not running.
+extern VkResult StartPersistentQueue(struct PersistentQueue* pQueue);
+// Asks the workgroups to exit and waits for the dispatch.
+extern VkResult StopPersistentQueue(struct PersistentQueue* pQueue);
+
+// Publishes a job computing dst[dstOffset + i] = src[srcOffset + i] * 2 + 1 for i in [0, elemCount).
+// Returns VK_NOT_READY if the ring is full, i.e. the job that used the same slot has not been completed yet.
+extern VkResult EnqueuePersistentQueueJob(struct PersistentQueue* pQueue, uint32_t srcOffset, uint32_t dstOffset, uint32_t elemCount,
+    uint32_t* pTicket);
+// Polls the completion of the job, submitting the dispatch again if all the workgroups have retired while it runs.
+// Returns VK_TIMEOUT if the job is not completed in `timeoutNanoseconds`.
+extern VkResult WaitPersistentQueueJob(struct PersistentQueue* pQueue, uint32_t ticket, uint64_t timeoutNanoseconds);
+
+// Processes the published jobs with a one-shot dispatch of a single workgroup and waits for it, just like a submission per job.
+// The persistent dispatch must not be running.
+extern VkResult DrainPersistentQueue(struct PersistentQueue* pQueue);
+
+// The number of times WaitPersistentQueueJob has submitted the dispatch again
+extern uint32_t GetPersistentQueueRelaunchCount(const struct PersistentQueue* pQueue);
+
+// Compares the per-job latency percentiles of a submission per job against the persistent dispatch.
+extern void PersistentQueueComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const struct LaunchDeviceModel* pModel, struct PipelineVariantCache* pCache);
+
+#endif // !PERSISTENT_QUEUE_H
+
@@ -15,6 +15,13 @@
 
 #include <vulkan/vulkan.h>
 
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "dedicated_allocation.h"
+#include "object_pool.h"
+
 #ifndef max
 #define max(a,b) (((a) > (b)) ? (a) : (b))
 #endif // !max
@@ -34,6 +41,7 @@ struct PushConstantArgs
 };
 
 extern VkResult CreateShaderModule(VkDevice device, const char* fileName, VkShaderModule* pShaderModule);
+extern VkPipelineCache GetSharedPipelineCache(void);
 extern VkResult InitializeCommandBuffer(uint32_t queueFamilyIndex, VkDevice device, VkCommandPool* pCommandPool,
     VkCommandBuffer commandBuffers[], uint32_t commandBufferCount);
 extern void SyncAndReadBuffer(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex, VkBuffer dstHostBuffer, VkBuffer srcDeviceBuffer, size_t size);
@@ -41,11 +49,12 @@ extern void SyncAndReadBuffer(VkCommandBuffer commandBuffer, uint32_t queueFamil
 // deviceMemories[0] as host visible memory;
 // deviceMemories[1] as device local memory for src and dst device buffers;
 // deviceMemories[2] as device local memory to store up to 8 device buffer addresses;
+// deviceMemories[3] as device local memory for the src device buffer if the dedicated allocation policy routes src and dst to allocations of their own;
 // deviceBuffers[0] as host temporal buffer;
 // deviceBuffers[1] as dst device buffer;
 // deviceBuffers[2] as src device buffer;
 // deviceBuffers[3] as address storage device buffer;
-static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[3],
+static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceMemory deviceMemories[4],
     VkBuffer deviceBuffers[4], VkDeviceSize bufferSize, uint32_t queueFamilyIndex)
 {
     const VkDeviceSize hostBufferSize = bufferSize + ADDITIONAL_ADDRESS_BUFFER_SIZE;
@@ -61,7 +70,7 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
     };
 
-    VkResult res = vkCreateBuffer(device, &hostBufCreateInfo, NULL, &deviceBuffers[0]);
+    VkResult res = vkCreateBuffer(device, &hostBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[0]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
@@ -71,37 +80,15 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
     VkMemoryRequirements hostMemBufRequirements = { 0 };
     vkGetBufferMemoryRequirements(device, deviceBuffers[0], &hostMemBufRequirements);
 
-    uint32_t memoryTypeIndex;
-    // Find host visible property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
-    {
-        if ((hostMemBufRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 &&
-            (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0 &&
-            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size >= hostMemBufRequirements.size)
-        {
-            // found our memory type!
-            printf("Host visible memory size: %zuMB\n", pMemoryProperties->memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
-    const VkMemoryAllocateInfo hostMemAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = hostMemBufRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex
-    };
-
-    res = vkAllocateMemory(device, &hostMemAllocInfo, NULL, &deviceMemories[0]);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkAllocateMemory failed: %d\n", res);
+    // Find host visible property memory type index whose heap has the budget for the buffer
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    res = AllocateMemoryWithinBudget(device, pMemoryProperties, &hostMemBufRequirements,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, NULL, &deviceMemories[0], &memoryTypeIndex);
+    if (res != VK_SUCCESS) {
         return res;
     }
+    printf("Host visible memory size: %zuMB\n",
+        (size_t)(pMemoryProperties->memoryHeaps[pMemoryProperties->memoryTypes[memoryTypeIndex].heapIndex].size / (1024 * 1024)));
 
     res = vkBindBufferMemory(device, deviceBuffers[0], deviceMemories[0], 0);
     if (res != VK_SUCCESS)
@@ -122,41 +109,20 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
     };
 
-    res = vkCreateBuffer(device, &deviceBufCreateInfo, NULL, &deviceBuffers[1]);
+    res = vkCreateBuffer(device, &deviceBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[1]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    res = vkCreateBuffer(device, &deviceBufCreateInfo, NULL, &deviceBuffers[2]);
+    res = vkCreateBuffer(device, &deviceBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[2]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    VkMemoryRequirements deviceMemBufRequirements = { 0 };
-    vkGetBufferMemoryRequirements(device, deviceBuffers[1], &deviceMemBufRequirements);
-
-    // two memory buffers share one device local memory.
-    const VkDeviceSize deviceMemTotalSize = max(bufferSize * 2, deviceMemBufRequirements.size);
-    // Find device local property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
-    {
-        if ((deviceMemBufRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size >= deviceMemTotalSize)
-        {
-            // found our memory type!
-            printf("Device local VRAM size: %zuMB\n", pMemoryProperties->memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
     // If buffer was created with the VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT bit set,
     // memory must have been allocated with the VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT bit set.
     const VkMemoryAllocateFlagsInfo memAllocFlagsInfo = {
@@ -165,33 +131,18 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
     };
 
-    VkMemoryAllocateInfo deviceMemAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = &memAllocFlagsInfo,
-        .allocationSize = deviceMemTotalSize,
-        .memoryTypeIndex = memoryTypeIndex
-    };
-
-    res = vkAllocateMemory(device, &deviceMemAllocInfo, NULL, &deviceMemories[1]);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkAllocateMemory failed: %d\n", res);
-        return res;
-    }
-
-    res = vkBindBufferMemory(device, deviceBuffers[1], deviceMemories[1], 0);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
-        return res;
-    }
-
-    res = vkBindBufferMemory(device, deviceBuffers[2], deviceMemories[1], bufferSize);
-    if (res != VK_SUCCESS)
-    {
-        fprintf(stderr, "vkBindBufferMemory failed: %d\n", res);
+    // two memory buffers share one device local memory, unless they are large enough for dedicated allocations.
+    VkDeviceMemory pairMemories[2] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+    uint32_t dedicatedCount = 0;
+    res = AllocateAndBindBufferMemory(device, pMemoryProperties, &deviceBuffers[1], 2, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memAllocFlagsInfo,
+        pairMemories, &dedicatedCount);
+    deviceMemories[1] = pairMemories[0];
+    deviceMemories[3] = pairMemories[1];
+    if (res != VK_SUCCESS) {
         return res;
     }
+    printf("Device local VRAM budget left: %zuMB, %u dedicated allocation(s)\n",
+        (size_t)(GetAvailableMemoryBudget(device, pMemoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) / (1024 * 1024)), dedicatedCount);
 
     const VkBufferCreateInfo addressWrapperDeviceBufCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -204,37 +155,21 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         .pQueueFamilyIndices = (uint32_t[]){ queueFamilyIndex }
     };
 
-    res = vkCreateBuffer(device, &deviceBufCreateInfo, NULL, &deviceBuffers[3]);
+    res = vkCreateBuffer(device, &deviceBufCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER), &deviceBuffers[3]);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateBuffer failed: %d\n", res);
         return res;
     }
 
-    memset(&deviceMemBufRequirements, 0, sizeof(deviceMemBufRequirements));
+    VkMemoryRequirements deviceMemBufRequirements = { 0 };
     vkGetBufferMemoryRequirements(device, deviceBuffers[3], &deviceMemBufRequirements);
 
-    // Find device local property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; memoryTypeIndex++)
-    {
-        if ((deviceMemBufRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = pMemoryProperties->memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-            pMemoryProperties->memoryHeaps[memoryType.heapIndex].size >= deviceMemBufRequirements.size) {
-            // found our memory type!
-            break;
-        }
-    }
-
-    deviceMemAllocInfo.allocationSize = deviceMemBufRequirements.size;
-    deviceMemAllocInfo.memoryTypeIndex = memoryTypeIndex;
-
-    res = vkAllocateMemory(device, &deviceMemAllocInfo, NULL, &deviceMemories[2]);
+    res = AllocateMemoryWithinBudget(device, pMemoryProperties, &deviceMemBufRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memAllocFlagsInfo,
+        &deviceMemories[2], NULL);
     if (res != VK_SUCCESS)
     {
-        fprintf(stderr, "vkAllocateMemory for deviceMemories[2] failed: %d\n", res);
+        fprintf(stderr, "AllocateMemoryWithinBudget for deviceMemories[2] failed: %d\n", res);
         return res;
     }
 
@@ -255,10 +190,7 @@ static VkResult AllocateMemoryAndBuffers(VkDevice device, const VkPhysicalDevice
         return res;
     }
 
-    int* srcMem = hostBuffer;
-    for (int i = 0; i < elemCount; i++) {
-        srcMem[i] = i;
-    }
+    HostParallelFillSequence(hostBuffer, (size_t)elemCount, 0);
 
     // Initialize the host buffer for addresses
     VkDeviceAddress* addrMem = (VkDeviceAddress*)((uint8_t*)hostBuffer + bufferSize);
@@ -336,7 +268,8 @@ static VkResult CreateComputePipeline(VkDevice device, VkShaderModule computeSha
         NULL, 0, 0, descriptorSetLayoutBindings
     };
 
-    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, NULL, pDescLayout);
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), pDescLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreateDescriptorSetLayout failed: %d\n", res);
@@ -361,7 +294,7 @@ static VkResult CreateComputePipeline(VkDevice device, VkShaderModule computeSha
         .pPushConstantRanges = pushConstRanges
     };
 
-    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, NULL, pPipelineLayout);
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), pPipelineLayout);
     if (res != VK_SUCCESS)
     {
         fprintf(stderr, "vkCreatePipelineLayout failed: %d\n", res);
@@ -418,7 +351,8 @@ static VkResult CreateComputePipeline(VkDevice device, VkShaderModule computeSha
         .basePipelineHandle = VK_NULL_HANDLE,
         .basePipelineIndex = 0
     };
-    res = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, NULL, pComputePipeline);
+    res = vkCreateComputePipelines(device, GetSharedPipelineCache(), 1, &computePipelineCreateInfo,
+        GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE), pComputePipeline);
     if (res != VK_SUCCESS) {
         fprintf(stderr, "vkCreateComputePipelines failed: %d\n", res);
     }
@@ -431,7 +365,7 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
 {
     puts("\n================ Begin Buffer Address OpenCL with SPIR-V test ================\n");
 
-    VkDeviceMemory deviceMemories[3] = { VK_NULL_HANDLE };
+    VkDeviceMemory deviceMemories[4] = { VK_NULL_HANDLE };
     // deviceBuffers[0] as host temporal buffer, deviceBuffers[1] as device dst buffer, deviceBuffers[2] as device src buffer,
     // deviceBuffer[3] as address buffer
     VkBuffer deviceBuffers[4] = { VK_NULL_HANDLE };
@@ -443,6 +377,7 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
     VkCommandPool commandPool = VK_NULL_HANDLE;
     VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
     VkFence fence = VK_NULL_HANDLE;
+    bool fenceWaitFailed = false;
     uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
 
     do
@@ -521,15 +456,10 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
             break;
         }
 
-        const VkFenceCreateInfo fenceCreateInfo = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0
-        };
-        result = vkCreateFence(specDevice, &fenceCreateInfo, NULL, &fence);
+        result = AcquirePooledFence(GetSharedFencePool(), &fence);
         if (result != VK_SUCCESS)
         {
-            fprintf(stderr, "vkCreateFence failed: %d\n", result);
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
             break;
         }
 
@@ -555,6 +485,7 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
         if (result != VK_SUCCESS)
         {
             fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+            fenceWaitFailed = true;
             break;
         }
 
@@ -567,13 +498,9 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
             break;
         }
         int* dstMem = hostBuffer;
-        for (int i = 0; i < (int)elemCount; i++)
-        {
-            if (dstMem[i] != i + i)
-            {
-                fprintf(stderr, "Result error @ %d, result is: %d\n", i, dstMem[i]);
-                break;
-            }
+        const size_t errIndex = HostParallelFindMismatch(dstMem, elemCount, 0, 2);
+        if (errIndex != SIZE_MAX) {
+            fprintf(stderr, "Result error @ %d, result is: %d\n", (int)errIndex, dstMem[errIndex]);
         }
         printf("The first 5 elements sum = %d\n", dstMem[0] + dstMem[1] + dstMem[2] + dstMem[3] + dstMem[4]);
 
@@ -581,40 +508,43 @@ void BufferAddressComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryP
 
     } while (false);
 
-    if (fence != VK_NULL_HANDLE) {
-        vkDestroyFence(specDevice, fence, NULL);
+    if (fenceWaitFailed) {
+        DiscardPooledFence(GetSharedFencePool(), fence);
+    }
+    else {
+        ReleasePooledFence(GetSharedFencePool(), fence);
     }
     if (commandPool != VK_NULL_HANDLE)
     {
         vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
-        vkDestroyCommandPool(specDevice, commandPool, NULL);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
     }
     if (descriptorPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(specDevice, descriptorPool, NULL);
+        vkDestroyDescriptorPool(specDevice, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
     }
     if (descriptorSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(specDevice, descriptorSetLayout, NULL);
+        vkDestroyDescriptorSetLayout(specDevice, descriptorSetLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
     }
     if (pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(specDevice, pipelineLayout, NULL);
+        vkDestroyPipelineLayout(specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
     }
     if (computePipeline != VK_NULL_HANDLE) {
-        vkDestroyPipeline(specDevice, computePipeline, NULL);
+        vkDestroyPipeline(specDevice, computePipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
     }
     if (computeShaderModule != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(specDevice, computeShaderModule, NULL);
+        vkDestroyShaderModule(specDevice, computeShaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
     }
 
     for (size_t i = 0; i < sizeof(deviceBuffers) / sizeof(deviceBuffers[0]); i++)
     {
         if (deviceBuffers[i] != VK_NULL_HANDLE) {
-            vkDestroyBuffer(specDevice, deviceBuffers[i], NULL);
+            vkDestroyBuffer(specDevice, deviceBuffers[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_BUFFER));
         }
     }
     for (size_t i = 0; i < sizeof(deviceMemories) / sizeof(deviceMemories[0]); i++)
     {
         if (deviceMemories[i] != VK_NULL_HANDLE) {
-            vkFreeMemory(specDevice, deviceMemories[i], NULL);
+            FreeDeviceMemory(specDevice, deviceMemories[i]);
         }
     }
 
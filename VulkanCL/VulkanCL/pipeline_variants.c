@@ -0,0 +1,490 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "pipeline_variants.h"
+
+enum
+{
+    // Power of 2, so that a hash is reduced to a slot index by masking
+    PIPELINE_VARIANT_INITIAL_CAPACITY = 64,
+
+    PIPELINE_VARIANT_TEST_ELEM_COUNT = 64 * 1024,
+    PIPELINE_VARIANT_TEST_MIN_WORKGROUP_SIZE = 32,
+    PIPELINE_VARIANT_TEST_MAX_WORKGROUP_SIZE = 1024,
+    PIPELINE_VARIANT_TEST_ROUND_COUNT = 2
+};
+
+struct PipelineVariant
+{
+    uint64_t hash;
+    VkShaderModule shaderModule;
+    VkPipelineLayout pipelineLayout;
+    // `specConstants` and the entry name share one allocation, which `specConstants` points to
+    uint32_t* specConstants;
+    const char* entryName;
+    uint32_t specConstantCount;
+    // VK_NULL_HANDLE for an empty slot
+    VkPipeline pipeline;
+};
+
+struct PipelineVariantCache
+{
+    VkDevice device;
+    struct HostLock* pLock;
+    // Open addressing with linear probing, no more than half full
+    struct PipelineVariant* slots;
+    uint32_t capacity;
+    uint32_t variantCount;
+    uint64_t hitCount;
+    uint64_t missCount;
+};
+
+// 64-bit FNV-1a
+static inline uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static uint64_t HashPipelineVariantKey(VkShaderModule shaderModule, const char* entryName, VkPipelineLayout pipelineLayout,
+    const uint32_t specConstants[], uint32_t specConstantCount)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = HashBytes(hash, &shaderModule, sizeof(shaderModule));
+    hash = HashBytes(hash, &pipelineLayout, sizeof(pipelineLayout));
+    hash = HashBytes(hash, entryName, strlen(entryName) + 1);
+    hash = HashBytes(hash, &specConstantCount, sizeof(specConstantCount));
+    return HashBytes(hash, specConstants, specConstantCount * sizeof(specConstants[0]));
+}
+
+static inline bool IsSamePipelineVariant(const struct PipelineVariant* pVariant, uint64_t hash, VkShaderModule shaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount)
+{
+    return pVariant->hash == hash && pVariant->shaderModule == shaderModule && pVariant->pipelineLayout == pipelineLayout &&
+        pVariant->specConstantCount == specConstantCount && strcmp(pVariant->entryName, entryName) == 0 &&
+        memcmp(pVariant->specConstants, specConstants, specConstantCount * sizeof(specConstants[0])) == 0;
+}
+
+// Returns the slot of the key if it exists, otherwise the empty slot where the key would be inserted.
+// The caller must hold the lock.
+static struct PipelineVariant* FindPipelineVariantSlot(struct PipelineVariantCache* pCache, uint64_t hash, VkShaderModule shaderModule,
+    const char* entryName, VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount)
+{
+    const uint32_t mask = pCache->capacity - 1;
+    for (uint32_t index = (uint32_t)hash & mask; ; index = (index + 1) & mask)
+    {
+        struct PipelineVariant* pSlot = &pCache->slots[index];
+        if (pSlot->pipeline == VK_NULL_HANDLE ||
+            IsSamePipelineVariant(pSlot, hash, shaderModule, entryName, pipelineLayout, specConstants, specConstantCount)) {
+            return pSlot;
+        }
+    }
+}
+
+// Places all the variants into a new table of `capacity` slots. The caller must hold the lock.
+static bool RehashPipelineVariants(struct PipelineVariantCache* pCache, uint32_t capacity)
+{
+    struct PipelineVariant* newSlots = calloc(capacity, sizeof(*newSlots));
+    if (newSlots == NULL) {
+        return false;
+    }
+
+    struct PipelineVariant* oldSlots = pCache->slots;
+    const uint32_t oldCapacity = pCache->capacity;
+    pCache->slots = newSlots;
+    pCache->capacity = capacity;
+
+    for (uint32_t i = 0; i < oldCapacity; i++)
+    {
+        const struct PipelineVariant* pVariant = &oldSlots[i];
+        if (pVariant->pipeline == VK_NULL_HANDLE) continue;
+
+        struct PipelineVariant* pSlot = FindPipelineVariantSlot(pCache, pVariant->hash, pVariant->shaderModule, pVariant->entryName,
+            pVariant->pipelineLayout, pVariant->specConstants, pVariant->specConstantCount);
+        *pSlot = *pVariant;
+    }
+    free(oldSlots);
+    return true;
+}
+
+static void FreePipelineVariant(VkDevice device, struct PipelineVariant* pVariant)
+{
+    vkDestroyPipeline(device, pVariant->pipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    free(pVariant->specConstants);
+    memset(pVariant, 0, sizeof(*pVariant));
+}
+
+VkResult CreatePipelineVariantCache(VkDevice device, struct PipelineVariantCache** ppCache)
+{
+    struct PipelineVariantCache* pCache = calloc(1, sizeof(*pCache));
+    if (pCache == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pCache->device = device;
+    pCache->pLock = HostLockCreate();
+    pCache->slots = calloc(PIPELINE_VARIANT_INITIAL_CAPACITY, sizeof(*pCache->slots));
+    pCache->capacity = PIPELINE_VARIANT_INITIAL_CAPACITY;
+    if (pCache->pLock == NULL || pCache->slots == NULL)
+    {
+        DestroyPipelineVariantCache(pCache);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    *ppCache = pCache;
+    return VK_SUCCESS;
+}
+
+void DestroyPipelineVariantCache(struct PipelineVariantCache* pCache)
+{
+    if (pCache == NULL) return;
+
+    if (pCache->slots != NULL)
+    {
+        for (uint32_t i = 0; i < pCache->capacity; i++)
+        {
+            if (pCache->slots[i].pipeline != VK_NULL_HANDLE) {
+                FreePipelineVariant(pCache->device, &pCache->slots[i]);
+            }
+        }
+        free(pCache->slots);
+    }
+    HostLockDestroy(pCache->pLock);
+    free(pCache);
+}
+
+VkResult GetPipelineVariant(struct PipelineVariantCache* pCache, VkShaderModule shaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipeline* pPipeline)
+{
+    const uint64_t hash = HashPipelineVariantKey(shaderModule, entryName, pipelineLayout, specConstants, specConstantCount);
+
+    HostLockAcquire(pCache->pLock);
+    const struct PipelineVariant* pSlot = FindPipelineVariantSlot(pCache, hash, shaderModule, entryName, pipelineLayout, specConstants, specConstantCount);
+    if (pSlot->pipeline != VK_NULL_HANDLE)
+    {
+        pCache->hitCount++;
+        *pPipeline = pSlot->pipeline;
+        HostLockRelease(pCache->pLock);
+        return VK_SUCCESS;
+    }
+    pCache->missCount++;
+    HostLockRelease(pCache->pLock);
+
+    // The pipeline is compiled without the lock so that the other threads keep hitting the cache meanwhile
+    const size_t specConstantsSize = specConstantCount * sizeof(specConstants[0]);
+    const size_t entryNameSize = strlen(entryName) + 1;
+    uint32_t* keyStorage = malloc(specConstantsSize + entryNameSize);
+    if (keyStorage == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memcpy(keyStorage, specConstants, specConstantsSize);
+    memcpy((char*)keyStorage + specConstantsSize, entryName, entryNameSize);
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkResult result = CreateComputePipelineWithSpecConstants(pCache->device, shaderModule, entryName, pipelineLayout,
+        specConstants, specConstantCount, &pipeline);
+    if (result != VK_SUCCESS)
+    {
+        free(keyStorage);
+        return result;
+    }
+
+    HostLockAcquire(pCache->pLock);
+    do
+    {
+        struct PipelineVariant* pNewSlot = FindPipelineVariantSlot(pCache, hash, shaderModule, entryName, pipelineLayout, specConstants, specConstantCount);
+        if (pNewSlot->pipeline != VK_NULL_HANDLE)
+        {
+            // Another thread has created the same variant in the meantime
+            vkDestroyPipeline(pCache->device, pipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+            free(keyStorage);
+            pipeline = pNewSlot->pipeline;
+            break;
+        }
+
+        // Keep at least one empty slot so that the probe sequences terminate, even if the table fails to grow
+        if ((pCache->variantCount + 1U) * 2U > pCache->capacity)
+        {
+            if (RehashPipelineVariants(pCache, pCache->capacity * 2U)) {
+                pNewSlot = FindPipelineVariantSlot(pCache, hash, shaderModule, entryName, pipelineLayout, specConstants, specConstantCount);
+            }
+            else if (pCache->variantCount + 1U >= pCache->capacity)
+            {
+                vkDestroyPipeline(pCache->device, pipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+                free(keyStorage);
+                pipeline = VK_NULL_HANDLE;
+                result = VK_ERROR_OUT_OF_HOST_MEMORY;
+                break;
+            }
+        }
+
+        *pNewSlot = (struct PipelineVariant){
+            .hash = hash,
+            .shaderModule = shaderModule,
+            .pipelineLayout = pipelineLayout,
+            .specConstants = keyStorage,
+            .entryName = (const char*)keyStorage + specConstantsSize,
+            .specConstantCount = specConstantCount,
+            .pipeline = pipeline
+        };
+        pCache->variantCount++;
+    } while (false);
+    HostLockRelease(pCache->pLock);
+
+    *pPipeline = pipeline;
+    return result;
+}
+
+void RemovePipelineVariantsOfModule(struct PipelineVariantCache* pCache, VkShaderModule shaderModule)
+{
+    HostLockAcquire(pCache->pLock);
+
+    uint32_t removedCount = 0;
+    for (uint32_t i = 0; i < pCache->capacity; i++)
+    {
+        struct PipelineVariant* pVariant = &pCache->slots[i];
+        if (pVariant->pipeline != VK_NULL_HANDLE && pVariant->shaderModule == shaderModule)
+        {
+            FreePipelineVariant(pCache->device, pVariant);
+            removedCount++;
+        }
+    }
+
+    // The probe sequences may run through the removed slots, so the remaining variants are placed again
+    if (removedCount > 0)
+    {
+        pCache->variantCount -= removedCount;
+        if (!RehashPipelineVariants(pCache, pCache->capacity)) {
+            fprintf(stderr, "RemovePipelineVariantsOfModule: out of memory!\n");
+        }
+    }
+
+    HostLockRelease(pCache->pLock);
+}
+
+void GetPipelineVariantCacheStatistics(struct PipelineVariantCache* pCache, struct PipelineVariantCacheStatistics* pStatistics)
+{
+    HostLockAcquire(pCache->pLock);
+    pStatistics->variantCount = pCache->variantCount;
+    pStatistics->hitCount = pCache->hitCount;
+    pStatistics->missCount = pCache->missCount;
+    HostLockRelease(pCache->pLock);
+}
+
+// dst[1] is the workgroup size, dst[i] = src[i] * 2 for the other elements from index 2, and dst[0] is not written.
+static bool VerifyDoubleKernelResult(const uint32_t* dst, const uint32_t* src, uint32_t elemCount, uint32_t workgroupSize)
+{
+    if (dst[0] != 0 || dst[1] != workgroupSize)
+    {
+        fprintf(stderr, "Wrong result: dst[0] = %u, dst[1] = %u, expected 0 and %u!\n", dst[0], dst[1], workgroupSize);
+        return false;
+    }
+    for (uint32_t i = 2; i < elemCount; i++)
+    {
+        if (dst[i] != src[i] * 2U)
+        {
+            fprintf(stderr, "Wrong result @ %u: %u, expected %u!\n", i, dst[i], src[i] * 2U);
+            return false;
+        }
+    }
+    return true;
+}
+
+void PipelineVariantCacheTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, struct PipelineVariantCache* pCache)
+{
+    puts("\n================ Begin pipeline variant cache test ================\n");
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descLayout = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+    VkBuffer srcBuffer = VK_NULL_HANDLE, dstBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory srcMemory = VK_NULL_HANDLE, dstMemory = VK_NULL_HANDLE;
+    void* srcPtr = NULL;
+    void* dstPtr = NULL;
+
+    do
+    {
+        const uint32_t elemCount = PIPELINE_VARIANT_TEST_ELEM_COUNT;
+        const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+
+        VkResult result = CreateShaderModule(specDevice, "shaders/clspv_spec/clspv_spec.spv", &shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        // DoubleKernel(global uint* pDst, global const uint* pSrc, uint elemCount)
+        result = CreateStorageBufferDescriptorSetLayout(specDevice, 2, &descLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+        result = CreateComputePipelineLayout(specDevice, descLayout, sizeof(uint32_t), &pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        // The buffers are small, so the kernel accesses the host visible memory directly
+        const VkMemoryPropertyFlags hostMemoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemoryFlags,
+            specQueueFamilyIndex, &srcBuffer, &srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(specDevice, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                hostMemoryFlags, specQueueFamilyIndex, &dstBuffer, &dstMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = vkMapMemory(specDevice, srcMemory, 0, VK_WHOLE_SIZE, 0, &srcPtr);
+        if (result == VK_SUCCESS)
+        {
+            result = vkMapMemory(specDevice, dstMemory, 0, VK_WHOLE_SIZE, 0, &dstPtr);
+            if (result != VK_SUCCESS) {
+                dstPtr = NULL;
+            }
+        }
+        else {
+            srcPtr = NULL;
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        HostParallelFillSequence(srcPtr, elemCount, 0);
+
+        const VkBuffer buffers[] = { dstBuffer, srcBuffer };
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        result = CreateStorageBufferDescriptorSet(specDevice, descLayout, buffers, 2, &descriptorPool, &descriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        uint32_t maxWorkgroupSize = PIPELINE_VARIANT_TEST_MAX_WORKGROUP_SIZE;
+        if (maxWorkgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+            maxWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+        }
+        if (maxWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+            maxWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+        }
+
+        struct PipelineVariantCacheStatistics statistics;
+        GetPipelineVariantCacheStatistics(pCache, &statistics);
+        const uint64_t initialMissCount = statistics.missCount;
+
+        for (int round = 0; round < PIPELINE_VARIANT_TEST_ROUND_COUNT && result == VK_SUCCESS; round++)
+        {
+            printf("---- Round %d ----\n", round + 1);
+            for (uint32_t workgroupSize = PIPELINE_VARIANT_TEST_MIN_WORKGROUP_SIZE; workgroupSize <= maxWorkgroupSize && result == VK_SUCCESS; workgroupSize *= 2U)
+            {
+                const uint32_t specConstants[] = { workgroupSize, 1U, 1U };
+                VkPipeline pipeline = VK_NULL_HANDLE;
+                const uint64_t beginTime = HostGetTimeNanoseconds();
+                result = GetPipelineVariant(pCache, shaderModule, "DoubleKernel", pipelineLayout, specConstants,
+                    (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0])), &pipeline);
+                const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "GetPipelineVariant failed: %d\n", result);
+                    break;
+                }
+
+                result = BeginOneTimeCommandBuffer(specDevice, commandPool, commandBuffers[0]);
+                if (result != VK_SUCCESS) break;
+                vkCmdFillBuffer(commandBuffers[0], dstBuffer, 0, bufferSize, 0);
+                RecordTransferToComputeBarrier(commandBuffers[0]);
+                vkCmdBindPipeline(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+                vkCmdBindDescriptorSets(commandBuffers[0], VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+                vkCmdPushConstants(commandBuffers[0], pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(elemCount), &elemCount);
+                vkCmdDispatch(commandBuffers[0], (elemCount + workgroupSize - 1) / workgroupSize, 1, 1);
+                result = EndAndSubmitCommandBuffer(specDevice, queue, commandBuffers[0]);
+                if (result != VK_SUCCESS) break;
+
+                const bool successful = VerifyDoubleKernelResult(dstPtr, srcPtr, elemCount, workgroupSize);
+                printf("Workgroup size %4u: pipeline got in %8.3f ms  (%s)\n", workgroupSize, (double)elapsedTime / 1000000.0,
+                    successful ? "verify OK" : "verify FAILED");
+            }
+        }
+
+        GetPipelineVariantCacheStatistics(pCache, &statistics);
+        printf("Variants: %u, hits: %llu, misses: %llu\n", statistics.variantCount, (unsigned long long)statistics.hitCount,
+            (unsigned long long)statistics.missCount);
+        if (result == VK_SUCCESS)
+        {
+            // Only the first round may create pipelines
+            uint32_t sizeCount = 0;
+            for (uint32_t workgroupSize = PIPELINE_VARIANT_TEST_MIN_WORKGROUP_SIZE; workgroupSize <= maxWorkgroupSize; workgroupSize *= 2U) {
+                sizeCount++;
+            }
+            printf("The later rounds %s the cache.\n", statistics.missCount - initialMissCount == sizeCount ? "all hit" : "did NOT all hit");
+        }
+    } while (false);
+
+    if (srcPtr != NULL) {
+        vkUnmapMemory(specDevice, srcMemory);
+    }
+    if (dstPtr != NULL) {
+        vkUnmapMemory(specDevice, dstMemory);
+    }
+    DestroyBufferWithMemory(specDevice, dstBuffer, dstMemory);
+    DestroyBufferWithMemory(specDevice, srcBuffer, srcMemory);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(specDevice, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    if (shaderModule != VK_NULL_HANDLE)
+    {
+        RemovePipelineVariantsOfModule(pCache, shaderModule);
+        vkDestroyShaderModule(specDevice, shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(specDevice, pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (descLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(specDevice, descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+
+    puts("\n================ Complete pipeline variant cache test ================\n");
+}
+
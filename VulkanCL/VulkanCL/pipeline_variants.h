@@ -0,0 +1,45 @@
+#ifndef PIPELINE_VARIANTS_H
+#define PIPELINE_VARIANTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Specialization variants of compute pipelines, keyed by (shader module, entry point, pipeline layout, specialization constants).
+// A variant is created through CreateComputePipelineWithSpecConstants the first time it is requested, and the later requests
+// of the same key return the same pipeline, so a caller may choose the workgroup size or the local memory size at dispatch time.
+// All the functions may be called from several threads concurrently.
+
+struct PipelineVariantCache;
+
+struct PipelineVariantCacheStatistics
+{
+    uint32_t variantCount;
+    uint64_t hitCount;
+    uint64_t missCount;
+};
+
+extern VkResult CreatePipelineVariantCache(VkDevice device, struct PipelineVariantCache** ppCache);
+// Destroys all the pipelines of the cache.
+extern void DestroyPipelineVariantCache(struct PipelineVariantCache* pCache);
+
+// specConstants[i] is assigned to the 32-bit specialization constant whose constantID is i, as CreateComputePipelineWithSpecConstants does.
+// The pipeline belongs to the cache and must not be destroyed by the caller.
+extern VkResult GetPipelineVariant(struct PipelineVariantCache* pCache, VkShaderModule shaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipeline* pPipeline);
+
+// Destroys the variants created from `shaderModule`. It must be called before the shader module is destroyed,
+// since a later module may get the same handle value. The pipelines must not be in use by the device.
+extern void RemovePipelineVariantsOfModule(struct PipelineVariantCache* pCache, VkShaderModule shaderModule);
+
+extern void GetPipelineVariantCacheStatistics(struct PipelineVariantCache* pCache, struct PipelineVariantCacheStatistics* pStatistics);
+
+// Dispatches DoubleKernel of shaders/clspv_spec/clspv_spec.spv with a range of workgroup sizes through `pCache`,
+// twice each, and verifies that the second round does not create any pipeline.
+extern void PipelineVariantCacheTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, struct PipelineVariantCache* pCache);
+
+#endif // !PIPELINE_VARIANTS_H
+
@@ -0,0 +1,474 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "clspv_reflection.h"
+#include "scan.h"
+#include "pipeline_warmup.h"
+
+enum
+{
+    // These must be identical to the constants of the same name in sgemm.c
+    SGEMM_TILE_K = 16,
+    SGEMM_WPT_M = 4,
+    SGEMM_WPT_N = 4,
+    SGEMM_NAIVE_WORKGROUP_SIZE = 16,
+    SGEMM_BUFFER_COUNT = 3,
+    SGEMM_PUSH_CONSTANT_SIZE = 5 * sizeof(uint32_t),
+
+    // The upper bound of the 1D workgroup size of the scan, radix sort and elementwise kernels
+    WARMUP_MAX_WORKGROUP_SIZE = 256,
+
+    SCAN_PUSH_CONSTANT_SIZE = 3 * sizeof(uint32_t),
+    // sizeof(struct RadixScatterPushConstants) of radix_sort.c: three uint32_t after the addresses, padded to the alignment of an address
+    RADIX_PUSH_CONSTANT_SIZE = 5 * sizeof(VkDeviceAddress) + 4 * sizeof(uint32_t),
+
+    CONVOLUTION_WORKGROUP_SIZE = 16,
+    CONVOLUTION_BUFFER_BINDING_COUNT = 3,
+    CONVOLUTION_PUSH_CONSTANT_SIZE = 4 * sizeof(uint32_t),
+
+    ELEMENTWISE_BINDING_COUNT = 2,
+    ELEMENTWISE_PUSH_CONSTANT_SIZE = 12 * sizeof(uint32_t),
+
+    PIPELINE_WARMUP_MAX_KERNEL_COUNT = 64
+};
+
+static const uint32_t s_sgemmTileSizes[][2] = { { 8, 8 }, { 16, 8 }, { 16, 16 }, { 32, 8 } };
+
+static const char* const s_scanKernelNames[] = { "ScanReduceKernel", "ScanDownsweepKernel", "CompactScatterKernel", "ScanFillPatternKernel" };
+static const uint32_t s_scanKernelBindingCounts[] = { 2, 3, 4, 1 };
+
+static const char* const s_elementwiseKernelNames[] = {
+    "ElementwiseAddKernel",
+    "ElementwiseMulKernel",
+    "ElementwiseXorKernel",
+    "ElementwiseMinKernel",
+    "ElementwiseMaxKernel",
+    "ElementwiseChainKernel",
+    "FusedAddMulKernel",
+    "FusedMulAddKernel"
+};
+
+// The radix sort configs of RadixSortComputeTest
+static const struct
+{
+    const char* fileName;
+    uint32_t radixBits;
+} s_radixSortModules[] = {
+    { "shaders/radix_sort/radix_sort_u32_r4.spv", 4 },
+    { "shaders/radix_sort/radix_sort_u32_r8.spv", 8 },
+    { "shaders/radix_sort/radix_sort_u64_r8.spv", 8 }
+};
+
+static uint32_t GetPow2WorkgroupSize(const VkPhysicalDeviceLimits* pLimits)
+{
+    uint32_t maxWorkgroupSize = WARMUP_MAX_WORKGROUP_SIZE;
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    }
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    uint32_t workgroupSize = 1;
+    while (workgroupSize * 2U <= maxWorkgroupSize) {
+        workgroupSize *= 2U;
+    }
+    return workgroupSize;
+}
+
+static void AppendKernel(struct PipelineWarmupKernel kernels[], uint32_t maxKernelCount, uint32_t* pKernelCount, const char* fileName,
+    const char* entryName, uint32_t bindingCount, uint32_t pushConstantSize, const uint32_t specConstants[], uint32_t specConstantCount)
+{
+    if (*pKernelCount >= maxKernelCount) return;
+
+    struct PipelineWarmupKernel* pKernel = &kernels[(*pKernelCount)++];
+    pKernel->fileName = fileName;
+    pKernel->entryName = entryName;
+    pKernel->bindingCount = bindingCount;
+    pKernel->pushConstantSize = pushConstantSize;
+    pKernel->specConstantCount = specConstantCount;
+    pKernel->stageFlags = 0;
+    pKernel->requiredSubgroupSize = 0;
+    memcpy(pKernel->specConstants, specConstants, specConstantCount * sizeof(specConstants[0]));
+}
+
+uint32_t GetPipelineWarmupKernels(const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties,
+    bool supportBufferDeviceAddress, struct PipelineWarmupKernel kernels[], uint32_t maxKernelCount)
+{
+    uint32_t kernelCount = 0;
+
+    // SGEMM, with the tile configs the device supports
+    const uint32_t naiveSpecConstants[] = { SGEMM_NAIVE_WORKGROUP_SIZE, SGEMM_NAIVE_WORKGROUP_SIZE, 1U };
+    AppendKernel(kernels, maxKernelCount, &kernelCount, "shaders/sgemm/sgemm.spv", "SgemmNaiveKernel", SGEMM_BUFFER_COUNT, SGEMM_PUSH_CONSTANT_SIZE,
+        naiveSpecConstants, 3);
+    // The specialization constants of `tileA` and `tileB` come from the reflection information as SgemmComputeTest does.
+    struct ClspvKernelReflection sgemmReflection;
+    const bool hasSgemmReflection = LoadClspvKernelReflection("shaders/sgemm/sgemm.spv", "SgemmTiledKernel", &sgemmReflection);
+    for (size_t i = 0; i < sizeof(s_sgemmTileSizes) / sizeof(s_sgemmTileSizes[0]) && hasSgemmReflection; i++)
+    {
+        const uint32_t localSizeX = s_sgemmTileSizes[i][0];
+        const uint32_t localSizeY = s_sgemmTileSizes[i][1];
+        const uint32_t localMemorySize = SGEMM_TILE_K * (localSizeY * SGEMM_WPT_M + localSizeX * SGEMM_WPT_N) * (uint32_t)sizeof(float);
+        if (localSizeX > pLimits->maxComputeWorkGroupSize[0] || localSizeY > pLimits->maxComputeWorkGroupSize[1] ||
+            localSizeX * localSizeY > pLimits->maxComputeWorkGroupInvocations || localMemorySize > pLimits->maxComputeSharedMemorySize) {
+            continue;
+        }
+
+        const uint32_t workgroupSizes[3] = { localSizeX, localSizeY, 1U };
+        const uint32_t localArgumentSizes[] = {
+            SGEMM_TILE_K * localSizeY * SGEMM_WPT_M * (uint32_t)sizeof(float),
+            SGEMM_TILE_K * localSizeX * SGEMM_WPT_N * (uint32_t)sizeof(float)
+        };
+        uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT];
+        uint32_t specConstantCount = 0;
+        if (GetClspvKernelSpecConstants("SgemmTiledKernel", &sgemmReflection, workgroupSizes, localArgumentSizes, 2, pLimits,
+                specConstants, &specConstantCount) != VK_SUCCESS ||
+            specConstantCount > PIPELINE_WARMUP_MAX_SPEC_CONSTANT_COUNT) {
+            continue;
+        }
+        AppendKernel(kernels, maxKernelCount, &kernelCount, "shaders/sgemm/sgemm.spv", "SgemmTiledKernel", SGEMM_BUFFER_COUNT, SGEMM_PUSH_CONSTANT_SIZE,
+            specConstants, specConstantCount);
+    }
+
+    const uint32_t workgroupSize = GetPow2WorkgroupSize(pLimits);
+
+    // Scan, with the workgroup size, module and shader stage of CreateScanContext
+    struct ScanPipelineConfig scanConfig;
+    GetScanPipelineConfig(pLimits, pSubgroupProperties, &scanConfig);
+    const uint32_t scanSpecConstants[] = { scanConfig.workgroupSize, 1U, 1U };
+    for (size_t i = 0; i < sizeof(s_scanKernelNames) / sizeof(s_scanKernelNames[0]); i++)
+    {
+        const uint32_t index = kernelCount;
+        AppendKernel(kernels, maxKernelCount, &kernelCount, scanConfig.shaderFileName, s_scanKernelNames[i], s_scanKernelBindingCounts[i],
+            SCAN_PUSH_CONSTANT_SIZE, scanSpecConstants, 3);
+        if (index < kernelCount)
+        {
+            kernels[index].stageFlags = scanConfig.stageFlags;
+            kernels[index].requiredSubgroupSize = scanConfig.requiredSubgroupSize;
+        }
+    }
+
+    // Radix sort, whose modules use physical storage buffer pointers.
+    // The specialization constant of `localHistogram` comes from the reflection information as CreateRadixSortContext does.
+    if (supportBufferDeviceAddress)
+    {
+        const char* const radixKernelNames[] = { "RadixHistogramKernel", "RadixScatterKernel" };
+        const uint32_t workgroupSizes[3] = { workgroupSize, 1U, 1U };
+        for (size_t i = 0; i < sizeof(s_radixSortModules) / sizeof(s_radixSortModules[0]); i++)
+        {
+            const uint32_t localHistogramSize = (1U << s_radixSortModules[i].radixBits) * (uint32_t)sizeof(uint32_t);
+            for (int kernel = 0; kernel < 2; kernel++)
+            {
+                struct ClspvKernelReflection reflection;
+                uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT];
+                uint32_t specConstantCount = 0;
+                if (!LoadClspvKernelReflection(s_radixSortModules[i].fileName, radixKernelNames[kernel], &reflection) ||
+                    GetClspvKernelSpecConstants(radixKernelNames[kernel], &reflection, workgroupSizes, &localHistogramSize, 1, pLimits,
+                        specConstants, &specConstantCount) != VK_SUCCESS ||
+                    specConstantCount > PIPELINE_WARMUP_MAX_SPEC_CONSTANT_COUNT) {
+                    continue;
+                }
+                AppendKernel(kernels, maxKernelCount, &kernelCount, s_radixSortModules[i].fileName, radixKernelNames[kernel], 0, RADIX_PUSH_CONSTANT_SIZE,
+                    specConstants, specConstantCount);
+            }
+        }
+    }
+
+    // The buffer path of the convolution. The image path needs a sampler in its descriptor set layout.
+    const uint32_t convolutionSpecConstants[] = { CONVOLUTION_WORKGROUP_SIZE, CONVOLUTION_WORKGROUP_SIZE, 1U };
+    AppendKernel(kernels, maxKernelCount, &kernelCount, "shaders/convolution/convolution.spv", "ConvolveRowsBufferKernel",
+        CONVOLUTION_BUFFER_BINDING_COUNT, CONVOLUTION_PUSH_CONSTANT_SIZE, convolutionSpecConstants, 3);
+    AppendKernel(kernels, maxKernelCount, &kernelCount, "shaders/convolution/convolution.spv", "ConvolveColumnsBufferKernel",
+        CONVOLUTION_BUFFER_BINDING_COUNT, CONVOLUTION_PUSH_CONSTANT_SIZE, convolutionSpecConstants, 3);
+
+    // Elementwise fusion, whose workgroup size is not rounded down to a power of 2
+    uint32_t elementwiseWorkgroupSize = WARMUP_MAX_WORKGROUP_SIZE;
+    if (elementwiseWorkgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+        elementwiseWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    }
+    if (elementwiseWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        elementwiseWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    const uint32_t elementwiseSpecConstants[] = { elementwiseWorkgroupSize, 1U, 1U };
+    for (size_t i = 0; i < sizeof(s_elementwiseKernelNames) / sizeof(s_elementwiseKernelNames[0]); i++)
+    {
+        AppendKernel(kernels, maxKernelCount, &kernelCount, "shaders/elementwise_fusion/elementwise_fusion.spv", s_elementwiseKernelNames[i],
+            ELEMENTWISE_BINDING_COUNT, ELEMENTWISE_PUSH_CONSTANT_SIZE, elementwiseSpecConstants, 3);
+    }
+
+    return kernelCount;
+}
+
+struct WarmupPipelineJob
+{
+    const struct PipelineWarmupKernel* pKernel;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipeline;
+    VkResult result;
+};
+
+struct WarmupPipelinesContext
+{
+    VkDevice device;
+    VkPipelineCache pipelineCache;
+    struct WarmupPipelineJob* jobs;
+};
+
+static void CreateWarmupPipelineTask(void* context, size_t begin, size_t end)
+{
+    const struct WarmupPipelinesContext* ctx = context;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        struct WarmupPipelineJob* pJob = &ctx->jobs[i];
+        const struct PipelineWarmupKernel* pKernel = pJob->pKernel;
+
+        VkSpecializationMapEntry mapEntries[PIPELINE_WARMUP_MAX_SPEC_CONSTANT_COUNT];
+        for (uint32_t id = 0; id < pKernel->specConstantCount; id++)
+        {
+            mapEntries[id] = (VkSpecializationMapEntry){
+                .constantID = id,
+                .offset = id * (uint32_t)sizeof(uint32_t),
+                .size = sizeof(uint32_t)
+            };
+        }
+
+        const VkSpecializationInfo specializationInfo = {
+            .mapEntryCount = pKernel->specConstantCount,
+            .pMapEntries = mapEntries,
+            .dataSize = pKernel->specConstantCount * sizeof(uint32_t),
+            .pData = pKernel->specConstants
+        };
+
+        VkPipelineShaderStageRequiredSubgroupSizeCreateInfoEXT requiredSubgroupSizeCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_REQUIRED_SUBGROUP_SIZE_CREATE_INFO_EXT,
+            .pNext = NULL,
+            .requiredSubgroupSize = pKernel->requiredSubgroupSize
+        };
+
+        const VkComputePipelineCreateInfo computePipelineCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = pKernel->requiredSubgroupSize > 0 ? &requiredSubgroupSizeCreateInfo : NULL,
+                .flags = pKernel->stageFlags,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = pJob->shaderModule,
+                .pName = pKernel->entryName,
+                .pSpecializationInfo = pKernel->specConstantCount > 0 ? &specializationInfo : NULL
+            },
+            .layout = pJob->pipelineLayout,
+            .basePipelineHandle = VK_NULL_HANDLE,
+            .basePipelineIndex = 0
+        };
+        // The pipeline cache is internally synchronized, so that all the threads compile into the same cache
+        pJob->result = vkCreateComputePipelines(ctx->device, ctx->pipelineCache, 1, &computePipelineCreateInfo,
+            GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE), &pJob->pipeline);
+    }
+}
+
+VkResult WarmupPipelines(VkDevice device, VkPipelineCache pipelineCache, const struct PipelineWarmupKernel kernels[], uint32_t kernelCount,
+    uint32_t threadCount, uint32_t* pCompiledCount, uint64_t* pElapsedNs)
+{
+    if (pCompiledCount != NULL) {
+        *pCompiledCount = 0;
+    }
+    if (pElapsedNs != NULL) {
+        *pElapsedNs = 0;
+    }
+    if (kernelCount == 0) {
+        return VK_SUCCESS;
+    }
+
+    struct WarmupPipelineJob* jobs = calloc(kernelCount, sizeof(*jobs));
+    // One shader module per distinct file name. A module that fails to load stays VK_NULL_HANDLE.
+    const char** moduleFileNames = calloc(kernelCount, sizeof(*moduleFileNames));
+    VkShaderModule* shaderModules = calloc(kernelCount, sizeof(*shaderModules));
+    if (jobs == NULL || moduleFileNames == NULL || shaderModules == NULL)
+    {
+        free(jobs);
+        free(moduleFileNames);
+        free(shaderModules);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+
+    VkResult result = VK_SUCCESS;
+    uint32_t moduleCount = 0;
+    uint32_t jobCount = 0;
+    do
+    {
+        // Shader modules and pipeline layouts are cheap, so they are created on the calling thread
+        for (uint32_t i = 0; i < kernelCount && result == VK_SUCCESS; i++)
+        {
+            const struct PipelineWarmupKernel* pKernel = &kernels[i];
+
+            uint32_t moduleIndex = 0;
+            while (moduleIndex < moduleCount && strcmp(moduleFileNames[moduleIndex], pKernel->fileName) != 0) {
+                moduleIndex++;
+            }
+            if (moduleIndex == moduleCount)
+            {
+                moduleFileNames[moduleCount++] = pKernel->fileName;
+                if (CreateShaderModule(device, pKernel->fileName, &shaderModules[moduleIndex]) != VK_SUCCESS)
+                {
+                    printf("Shader module %s is not available and its kernels will be skipped.\n", pKernel->fileName);
+                    shaderModules[moduleIndex] = VK_NULL_HANDLE;
+                }
+            }
+            if (shaderModules[moduleIndex] == VK_NULL_HANDLE) continue;
+
+            struct WarmupPipelineJob* pJob = &jobs[jobCount++];
+            pJob->pKernel = pKernel;
+            pJob->shaderModule = shaderModules[moduleIndex];
+            if (pKernel->bindingCount > 0)
+            {
+                result = CreateStorageBufferDescriptorSetLayout(device, pKernel->bindingCount, &pJob->descLayout);
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+                    break;
+                }
+            }
+            result = CreateComputePipelineLayout(device, pJob->descLayout, pKernel->pushConstantSize, &pJob->pipelineLayout);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            }
+        }
+        if (result != VK_SUCCESS) break;
+
+        struct WarmupPipelinesContext context = { device, pipelineCache, jobs };
+        const uint64_t beginTime = HostGetTimeNanoseconds();
+        HostParallelForEach(jobCount, threadCount, CreateWarmupPipelineTask, &context);
+        const uint64_t endTime = HostGetTimeNanoseconds();
+        if (pElapsedNs != NULL) {
+            *pElapsedNs = endTime - beginTime;
+        }
+
+        uint32_t compiledCount = 0;
+        for (uint32_t i = 0; i < jobCount; i++)
+        {
+            if (jobs[i].result == VK_SUCCESS) {
+                compiledCount++;
+            }
+            else
+            {
+                fprintf(stderr, "vkCreateComputePipelines failed for %s of %s: %d\n", jobs[i].pKernel->entryName, jobs[i].pKernel->fileName, jobs[i].result);
+                result = jobs[i].result;
+            }
+        }
+        if (pCompiledCount != NULL) {
+            *pCompiledCount = compiledCount;
+        }
+    } while (false);
+
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        if (jobs[i].pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, jobs[i].pipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+        if (jobs[i].pipelineLayout != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, jobs[i].pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+        }
+        if (jobs[i].descLayout != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(device, jobs[i].descLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+        }
+    }
+    for (uint32_t i = 0; i < moduleCount; i++)
+    {
+        if (shaderModules[i] != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(device, shaderModules[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+        }
+    }
+    free(jobs);
+    free(moduleFileNames);
+    free(shaderModules);
+
+    return result;
+}
+
+void PipelineWarmupTest(VkDevice specDevice, VkPipelineCache sharedPipelineCache, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, bool supportBufferDeviceAddress)
+{
+    puts("\n================ Begin pipeline warmup test ================\n");
+
+    struct PipelineWarmupKernel kernels[PIPELINE_WARMUP_MAX_KERNEL_COUNT];
+    const uint32_t kernelCount = GetPipelineWarmupKernels(pLimits, pSubgroupProperties, supportBufferDeviceAddress, kernels, PIPELINE_WARMUP_MAX_KERNEL_COUNT);
+    const uint32_t maxThreadCount = HostParallelGetThreadCount();
+    printf("%u kernels are registered, the host thread pool has %u threads.\n", kernelCount, maxThreadCount);
+    puts("The driver may keep its own on-disk cache as well, which makes the later rounds faster regardless of the thread count.");
+
+    const VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .initialDataSize = 0,
+        .pInitialData = NULL
+    };
+
+    uint64_t singleThreadNs = 0;
+    // 1, 2, 4, ... threads, and finally all the threads if the thread count is not a power of 2
+    uint32_t threadCount = 1;
+    while (true)
+    {
+        // Every round starts from an empty cache so that it really compiles all the pipelines
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+        VkResult result = vkCreatePipelineCache(specDevice, &pipelineCacheCreateInfo,
+            GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_CACHE), &pipelineCache);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreatePipelineCache failed: %d\n", result);
+            break;
+        }
+
+        uint32_t compiledCount = 0;
+        uint64_t elapsedNs = 0;
+        result = WarmupPipelines(specDevice, pipelineCache, kernels, kernelCount, threadCount, &compiledCount, &elapsedNs);
+
+        size_t cacheDataSize = 0;
+        if (result == VK_SUCCESS) {
+            result = vkGetPipelineCacheData(specDevice, pipelineCache, &cacheDataSize, NULL);
+        }
+        vkDestroyPipelineCache(specDevice, pipelineCache, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_CACHE));
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "WarmupPipelines failed: %d\n", result);
+            break;
+        }
+
+        if (threadCount == 1) {
+            singleThreadNs = elapsedNs;
+        }
+        printf("%2u thread(s): %u pipelines compiled in %.3f ms, speedup: %.2fx, cache data size: %zu bytes\n", threadCount, compiledCount,
+            (double)elapsedNs / 1000000.0, elapsedNs > 0 ? (double)singleThreadNs / (double)elapsedNs : 0.0, cacheDataSize);
+
+        if (threadCount >= maxThreadCount) break;
+        threadCount = threadCount * 2U < maxThreadCount ? threadCount * 2U : maxThreadCount;
+    }
+
+    if (sharedPipelineCache != VK_NULL_HANDLE)
+    {
+        uint32_t compiledCount = 0;
+        uint64_t elapsedNs = 0;
+        const VkResult result = WarmupPipelines(specDevice, sharedPipelineCache, kernels, kernelCount, 0, &compiledCount, &elapsedNs);
+        if (result == VK_SUCCESS) {
+            printf("The shared pipeline cache has been warmed with %u pipelines in %.3f ms.\n", compiledCount, (double)elapsedNs / 1000000.0);
+        }
+        else {
+            fprintf(stderr, "WarmupPipelines failed for the shared pipeline cache: %d\n", result);
+        }
+    }
+
+    puts("\n================ Complete pipeline warmup test ================\n");
+}
+
@@ -0,0 +1,52 @@
+#ifndef PIPELINE_WARMUP_H
+#define PIPELINE_WARMUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Startup compilation of the compute pipelines that the tests create later.
+// The pipelines are compiled concurrently on the host thread pool into a pipeline cache, so that the test modules,
+// which create their pipelines through the same cache (GetSharedPipelineCache), hit the cache instead of compiling again.
+
+enum
+{
+    PIPELINE_WARMUP_MAX_SPEC_CONSTANT_COUNT = 5
+};
+
+struct PipelineWarmupKernel
+{
+    // The path passed to CreateShaderModule, such as "shaders/scan/scan.spv"
+    const char* fileName;
+    const char* entryName;
+    // The number of storage buffer bindings. 0 means the pipeline layout has no descriptor set layout.
+    uint32_t bindingCount;
+    uint32_t pushConstantSize;
+    uint32_t specConstants[PIPELINE_WARMUP_MAX_SPEC_CONSTANT_COUNT];
+    uint32_t specConstantCount;
+    // The shader stage flags and the required subgroup size (0 for none) of CreateComputePipelineWithStageFlags
+    VkPipelineShaderStageCreateFlags stageFlags;
+    uint32_t requiredSubgroupSize;
+};
+
+// Fills `kernels` with the kernels of the tests, specialized in the same way as the tests specialize them for the current device.
+// Returns the number of kernels, which is no more than `maxKernelCount`.
+extern uint32_t GetPipelineWarmupKernels(const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties,
+    bool supportBufferDeviceAddress, struct PipelineWarmupKernel kernels[], uint32_t maxKernelCount);
+
+// Compiles the pipelines of `kernels` into `pipelineCache` on at most `threadCount` threads (0 means all the threads of the host thread pool)
+// and destroys them afterwards. The kernels whose shader module is not available are skipped.
+// @param pCompiledCount: optional, receives the number of the pipelines that have been compiled.
+// @param pElapsedNs: optional, receives the wall time of the pipeline compilation.
+extern VkResult WarmupPipelines(VkDevice device, VkPipelineCache pipelineCache, const struct PipelineWarmupKernel kernels[], uint32_t kernelCount,
+    uint32_t threadCount, uint32_t* pCompiledCount, uint64_t* pElapsedNs);
+
+// Measures the startup pipeline compilation time with 1, 2, 4, ... threads up to the size of the host thread pool,
+// each with an empty pipeline cache, then warms `sharedPipelineCache` with all the threads.
+extern void PipelineWarmupTest(VkDevice specDevice, VkPipelineCache sharedPipelineCache, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, bool supportBufferDeviceAddress);
+
+#endif // !PIPELINE_WARMUP_H
+
@@ -0,0 +1,687 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "clspv_reflection.h"
+#include "scan.h"
+#include "radix_sort.h"
+
+enum
+{
+    // These must be identical to the macros of the same name in shaders/radix_sort/radix_sort.cl
+    RADIX_ITEMS_PER_THREAD = 4,
+    RADIX_MAX_WORKGROUP_SIZE = 256,
+
+    RADIX_BENCHMARK_LOOP_COUNT = 5,
+    // The average number of the occurrences of each test key
+    RADIX_TEST_KEY_REPEAT_COUNT = 16
+};
+
+// The modules of shaders/radix_sort/build-spv.sh, one per key type and radix width (RADIX_BITS).
+// Every radix width divides the key width, so that all the passes are of the same width.
+static const struct
+{
+    enum RadixSortKeyType keyType;
+    uint32_t radixBits;
+    const char* fileName;
+} s_radixSortModules[] = {
+    { RADIX_SORT_KEY_UINT32, 4, "shaders/radix_sort/radix_sort_u32_r4.spv" },
+    { RADIX_SORT_KEY_UINT32, 8, "shaders/radix_sort/radix_sort_u32_r8.spv" },
+    { RADIX_SORT_KEY_UINT64, 4, "shaders/radix_sort/radix_sort_u64_r4.spv" },
+    { RADIX_SORT_KEY_UINT64, 8, "shaders/radix_sort/radix_sort_u64_r8.spv" }
+};
+
+// layout(push_constant, std430) uniform of RadixHistogramKernel
+struct RadixHistogramPushConstants
+{
+    VkDeviceAddress keysIn;
+    VkDeviceAddress histogram;
+    uint32_t elemCount;
+    uint32_t shift;
+};
+
+// layout(push_constant, std430) uniform of RadixScatterKernel
+struct RadixScatterPushConstants
+{
+    VkDeviceAddress keysIn;
+    VkDeviceAddress keysOut;
+    VkDeviceAddress valuesIn;
+    VkDeviceAddress valuesOut;
+    VkDeviceAddress histogramOffsets;
+    uint32_t elemCount;
+    uint32_t shift;
+    // Whether the values are sorted along with the keys
+    uint32_t hasValues;
+};
+
+struct RadixSortContext
+{
+    VkDevice device;
+    VkShaderModule shaderModule;
+    // Both kernels have no descriptor sets, so that they share one pipeline layout with the larger push constant range.
+    VkPipelineLayout pipelineLayout;
+    VkPipeline histogramPipeline;
+    VkPipeline scatterPipeline;
+    struct ScanContext* pScanContext;
+    enum RadixSortKeyType keyType;
+    uint32_t keySize;
+    uint32_t radixBits;
+    uint32_t workgroupSize;
+    uint32_t blockElemCount;
+    uint32_t maxGroupCountX;
+};
+
+struct RadixSortPlan
+{
+    const struct RadixSortContext* pContext;
+    uint32_t maxElemCount;
+    VkBuffer keysBuffer;
+    // VK_NULL_HANDLE for the key only sort
+    VkBuffer valuesBuffer;
+    VkBuffer tempKeysBuffer;
+    VkDeviceMemory tempKeysMemory;
+    VkBuffer tempValuesBuffer;
+    VkDeviceMemory tempValuesMemory;
+    VkBuffer histogramBuffer;
+    VkDeviceMemory histogramMemory;
+    // Scans `histogramBuffer` in place
+    struct ScanPlan* pHistogramScanPlan;
+    // The addresses are 0 for the absent value buffers, which RadixScatterKernel does not access since `hasValues` is 0
+    VkDeviceAddress keysAddress;
+    VkDeviceAddress valuesAddress;
+    VkDeviceAddress tempKeysAddress;
+    VkDeviceAddress tempValuesAddress;
+    VkDeviceAddress histogramAddress;
+};
+
+static uint32_t GetBlockCount(const struct RadixSortContext* pContext, uint32_t elemCount)
+{
+    return (uint32_t)(((uint64_t)elemCount + pContext->blockElemCount - 1U) / pContext->blockElemCount);
+}
+
+// Spreads the workgroups of the blocks over the X and Y dimensions. The kernels skip the surplus workgroups of the last row.
+static void GetDispatchSize(const struct RadixSortContext* pContext, uint32_t blockCount, uint32_t* pGroupCountX, uint32_t* pGroupCountY)
+{
+    const uint32_t groupCountX = blockCount < pContext->maxGroupCountX ? blockCount : pContext->maxGroupCountX;
+    *pGroupCountX = groupCountX > 0 ? groupCountX : 1U;
+    *pGroupCountY = (blockCount + *pGroupCountX - 1U) / *pGroupCountX;
+}
+
+VkResult CreateRadixSortContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, enum RadixSortKeyType keyType, uint32_t radixBits,
+    struct RadixSortContext** ppContext)
+{
+    const char* shaderFileName = NULL;
+    for (size_t i = 0; i < sizeof(s_radixSortModules) / sizeof(s_radixSortModules[0]); i++)
+    {
+        if (s_radixSortModules[i].keyType == keyType && s_radixSortModules[i].radixBits == radixBits) {
+            shaderFileName = s_radixSortModules[i].fileName;
+        }
+    }
+    if (shaderFileName == NULL)
+    {
+        fprintf(stderr, "Radix width %u has no radix sort module, which is built for 4 or 8 bits!\n", radixBits);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    const uint32_t keySize = keyType == RADIX_SORT_KEY_UINT64 ? (uint32_t)sizeof(uint64_t) : (uint32_t)sizeof(uint32_t);
+    const uint32_t digitCount = 1U << radixBits;
+    // localKeys, localValues and scratch of RadixScatterKernel are sized for the maximum workgroup size
+    const uint32_t localMemorySize = RADIX_MAX_WORKGROUP_SIZE * RADIX_ITEMS_PER_THREAD * (keySize + (uint32_t)sizeof(uint32_t)) +
+        RADIX_MAX_WORKGROUP_SIZE * (uint32_t)sizeof(uint32_t) + digitCount * (uint32_t)sizeof(uint32_t);
+    if (localMemorySize > pLimits->maxComputeSharedMemorySize)
+    {
+        fprintf(stderr, "Radix sort needs %u bytes of shared memory while the device only has %u bytes!\n",
+            localMemorySize, pLimits->maxComputeSharedMemorySize);
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    struct RadixSortContext* pContext = calloc(1, sizeof(*pContext));
+    if (pContext == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pContext->device = device;
+    pContext->keyType = keyType;
+    pContext->keySize = keySize;
+    pContext->radixBits = radixBits;
+
+    uint32_t maxWorkgroupSize = RADIX_MAX_WORKGROUP_SIZE;
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    }
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    uint32_t workgroupSize = 1;
+    while (workgroupSize * 2U <= maxWorkgroupSize) {
+        workgroupSize *= 2U;
+    }
+    pContext->workgroupSize = workgroupSize;
+    pContext->blockElemCount = workgroupSize * RADIX_ITEMS_PER_THREAD;
+    pContext->maxGroupCountX = pLimits->maxComputeWorkGroupCount[0];
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        result = CreateShaderModule(device, shaderFileName, &pContext->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateComputePipelineLayout(device, VK_NULL_HANDLE, sizeof(struct RadixScatterPushConstants), &pContext->pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        // `localHistogram` holds one uint per digit. The reflection information of the module tells its specialization constant ID
+        // for each kernel, since the compiler may or may not share it between the kernels.
+        const char* const kernelNames[] = { "RadixHistogramKernel", "RadixScatterKernel" };
+        VkPipeline* const pPipelines[] = { &pContext->histogramPipeline, &pContext->scatterPipeline };
+        const uint32_t workgroupSizes[3] = { workgroupSize, 1U, 1U };
+        const uint32_t localHistogramSize = digitCount * (uint32_t)sizeof(uint32_t);
+        for (int i = 0; i < 2 && result == VK_SUCCESS; i++)
+        {
+            struct ClspvKernelReflection reflection;
+            if (!LoadClspvKernelReflection(shaderFileName, kernelNames[i], &reflection))
+            {
+                fprintf(stderr, "LoadClspvKernelReflection failed for %s!\n", kernelNames[i]);
+                result = VK_ERROR_INITIALIZATION_FAILED;
+                break;
+            }
+
+            uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT];
+            uint32_t specConstantCount = 0;
+            result = GetClspvKernelSpecConstants(kernelNames[i], &reflection, workgroupSizes, &localHistogramSize, 1, pLimits,
+                specConstants, &specConstantCount);
+            if (result == VK_SUCCESS)
+            {
+                result = CreateComputePipelineWithSpecConstants(device, pContext->shaderModule, kernelNames[i], pContext->pipelineLayout,
+                    specConstants, specConstantCount, pPipelines[i]);
+            }
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineWithSpecConstants failed!\n");
+            break;
+        }
+
+        result = CreateScanContext(device, pLimits, pSubgroupProperties, &pContext->pScanContext);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "CreateScanContext failed!\n");
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyRadixSortContext(pContext);
+        return result;
+    }
+
+    *ppContext = pContext;
+    return VK_SUCCESS;
+}
+
+void DestroyRadixSortContext(struct RadixSortContext* pContext)
+{
+    if (pContext == NULL) return;
+
+    const VkDevice device = pContext->device;
+    DestroyScanContext(pContext->pScanContext);
+    if (pContext->scatterPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pContext->scatterPipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    }
+    if (pContext->histogramPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pContext->histogramPipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    }
+    if (pContext->pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pContext->pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pContext->shaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, pContext->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+
+    free(pContext);
+}
+
+VkResult CreateRadixSortPlan(struct RadixSortContext* pContext, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t queueFamilyIndex, uint32_t maxElemCount, VkBuffer keysBuffer, VkBuffer valuesBuffer, struct RadixSortPlan** ppPlan)
+{
+    const VkDevice device = pContext->device;
+    const VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    const uint64_t histogramElemCount = (uint64_t)GetBlockCount(pContext, maxElemCount) << pContext->radixBits;
+    if (maxElemCount == 0 || histogramElemCount > UINT32_MAX)
+    {
+        fprintf(stderr, "%u elements are out of the range of the radix sort!\n", maxElemCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct RadixSortPlan* pPlan = calloc(1, sizeof(*pPlan));
+    if (pPlan == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pPlan->pContext = pContext;
+    pPlan->maxElemCount = maxElemCount;
+    pPlan->keysBuffer = keysBuffer;
+    pPlan->valuesBuffer = valuesBuffer;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, (VkDeviceSize)maxElemCount * pContext->keySize, usage,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pPlan->tempKeysBuffer, &pPlan->tempKeysMemory);
+        if (result == VK_SUCCESS && valuesBuffer != VK_NULL_HANDLE)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, (VkDeviceSize)maxElemCount * sizeof(uint32_t), usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pPlan->tempValuesBuffer, &pPlan->tempValuesMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, (VkDeviceSize)histogramElemCount * sizeof(uint32_t), usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &pPlan->histogramBuffer, &pPlan->histogramMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = CreateScanPlan(pContext->pScanContext, pMemoryProperties, queueFamilyIndex, (uint32_t)histogramElemCount,
+            pPlan->histogramBuffer, pPlan->histogramBuffer, VK_NULL_HANDLE, &pPlan->pHistogramScanPlan);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateScanPlan failed!\n");
+            break;
+        }
+
+        pPlan->keysAddress = GetBufferDeviceAddress(device, keysBuffer);
+        pPlan->tempKeysAddress = GetBufferDeviceAddress(device, pPlan->tempKeysBuffer);
+        pPlan->histogramAddress = GetBufferDeviceAddress(device, pPlan->histogramBuffer);
+        if (valuesBuffer != VK_NULL_HANDLE)
+        {
+            pPlan->valuesAddress = GetBufferDeviceAddress(device, valuesBuffer);
+            pPlan->tempValuesAddress = GetBufferDeviceAddress(device, pPlan->tempValuesBuffer);
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyRadixSortPlan(pPlan);
+        return result;
+    }
+
+    *ppPlan = pPlan;
+    return VK_SUCCESS;
+}
+
+void DestroyRadixSortPlan(struct RadixSortPlan* pPlan)
+{
+    if (pPlan == NULL) return;
+
+    const VkDevice device = pPlan->pContext->device;
+    DestroyScanPlan(pPlan->pHistogramScanPlan);
+    DestroyBufferWithMemory(device, pPlan->histogramBuffer, pPlan->histogramMemory);
+    DestroyBufferWithMemory(device, pPlan->tempValuesBuffer, pPlan->tempValuesMemory);
+    DestroyBufferWithMemory(device, pPlan->tempKeysBuffer, pPlan->tempKeysMemory);
+
+    free(pPlan);
+}
+
+void RecordRadixSort(VkCommandBuffer commandBuffer, const struct RadixSortPlan* pPlan, uint32_t elemCount)
+{
+    if (elemCount == 0 || elemCount > pPlan->maxElemCount) return;
+
+    const struct RadixSortContext* pContext = pPlan->pContext;
+    const uint32_t keyBits = pContext->keySize * 8U;
+    const uint32_t blockCount = GetBlockCount(pContext, elemCount);
+    uint32_t groupCountX, groupCountY;
+    GetDispatchSize(pContext, blockCount, &groupCountX, &groupCountY);
+
+    // The source and the destination of each pass. Swapping them is all it takes to ping-pong.
+    VkDeviceAddress keysIn = pPlan->keysAddress;
+    VkDeviceAddress keysOut = pPlan->tempKeysAddress;
+    VkDeviceAddress valuesIn = pPlan->valuesAddress;
+    VkDeviceAddress valuesOut = pPlan->tempValuesAddress;
+    uint32_t passCount = 0;
+
+    const uint32_t radixBits = pContext->radixBits;
+    for (uint32_t shift = 0; shift < keyBits; shift += radixBits)
+    {
+        if (passCount > 0) {
+            RecordComputeToComputeBarrier(commandBuffer);
+        }
+
+        const struct RadixHistogramPushConstants histogramArgs = { keysIn, pPlan->histogramAddress, elemCount, shift };
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->histogramPipeline);
+        vkCmdPushConstants(commandBuffer, pContext->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(histogramArgs), &histogramArgs);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+        RecordComputeToComputeBarrier(commandBuffer);
+
+        RecordScan(commandBuffer, pPlan->pHistogramScanPlan, blockCount << radixBits, false);
+        RecordComputeToComputeBarrier(commandBuffer);
+
+        const struct RadixScatterPushConstants scatterArgs = {
+            keysIn, keysOut, valuesIn, valuesOut, pPlan->histogramAddress, elemCount, shift, pPlan->valuesBuffer != VK_NULL_HANDLE ? 1U : 0U
+        };
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->scatterPipeline);
+        vkCmdPushConstants(commandBuffer, pContext->pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(scatterArgs), &scatterArgs);
+        vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+
+        VkDeviceAddress temp = keysIn;
+        keysIn = keysOut;
+        keysOut = temp;
+        temp = valuesIn;
+        valuesIn = valuesOut;
+        valuesOut = temp;
+        passCount++;
+    }
+
+    if ((passCount & 1U) != 0)
+    {
+        // The sorted elements are in the temporary buffers
+        RecordComputeToTransferBarrier(commandBuffer);
+
+        const VkBufferCopy keysRegion = { .srcOffset = 0, .dstOffset = 0, .size = (VkDeviceSize)elemCount * pContext->keySize };
+        vkCmdCopyBuffer(commandBuffer, pPlan->tempKeysBuffer, pPlan->keysBuffer, 1, &keysRegion);
+        if (pPlan->valuesBuffer != VK_NULL_HANDLE)
+        {
+            const VkBufferCopy valuesRegion = { .srcOffset = 0, .dstOffset = 0, .size = (VkDeviceSize)elemCount * sizeof(uint32_t) };
+            vkCmdCopyBuffer(commandBuffer, pPlan->tempValuesBuffer, pPlan->valuesBuffer, 1, &valuesRegion);
+        }
+    }
+}
+
+// ---- Test and benchmark ----
+
+struct RadixSortTestConfig
+{
+    enum RadixSortKeyType keyType;
+    uint32_t radixBits;
+};
+
+static const struct RadixSortTestConfig s_radixSortTestConfigs[] = {
+    { RADIX_SORT_KEY_UINT32, 4 },
+    { RADIX_SORT_KEY_UINT32, 8 },
+    { RADIX_SORT_KEY_UINT64, 8 }
+};
+
+static const uint32_t s_radixSortTestElemCounts[] = { 1U << 20, 1U << 24 };
+
+static int CompareUInt32(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static int CompareUInt64(const void* a, const void* b)
+{
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static uint64_t GetKey(const void* keys, enum RadixSortKeyType keyType, size_t index)
+{
+    return keyType == RADIX_SORT_KEY_UINT64 ? ((const uint64_t*)keys)[index] : ((const uint32_t*)keys)[index];
+}
+
+// Returns the index of the first wrong element, or SIZE_MAX if the keys match `refKeys` and the values, if any, are the
+// original indices of the keys in stable order.
+static size_t VerifySortResult(enum RadixSortKeyType keyType, const void* srcKeys, const void* sortedKeys, const uint32_t* sortedValues,
+    const void* refKeys, uint32_t elemCount)
+{
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        const uint64_t key = GetKey(sortedKeys, keyType, i);
+        if (key != GetKey(refKeys, keyType, i)) return i;
+
+        if (sortedValues != NULL)
+        {
+            if (sortedValues[i] >= elemCount || GetKey(srcKeys, keyType, sortedValues[i]) != key) return i;
+            if (i > 0 && GetKey(sortedKeys, keyType, i - 1U) == key && sortedValues[i - 1U] >= sortedValues[i]) return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Records the upload of the unsorted keys and values from the first half of `hostBuffer`.
+static void RecordSortInputUpload(VkCommandBuffer commandBuffer, VkBuffer hostBuffer, VkBuffer keysBuffer, VkBuffer valuesBuffer,
+    VkDeviceSize keysSize, VkDeviceSize valuesSize)
+{
+    const VkBufferCopy keysRegion = { .srcOffset = 0, .dstOffset = 0, .size = keysSize };
+    vkCmdCopyBuffer(commandBuffer, hostBuffer, keysBuffer, 1, &keysRegion);
+    if (valuesBuffer != VK_NULL_HANDLE)
+    {
+        const VkBufferCopy valuesRegion = { .srcOffset = keysSize, .dstOffset = 0, .size = valuesSize };
+        vkCmdCopyBuffer(commandBuffer, hostBuffer, valuesBuffer, 1, &valuesRegion);
+    }
+    RecordTransferToComputeBarrier(commandBuffer);
+}
+
+static VkResult RunRadixSortWithElemCount(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, struct RadixSortContext* pContext, uint32_t elemCount)
+{
+    const enum RadixSortKeyType keyType = pContext->keyType;
+    const VkDeviceSize keysSize = (VkDeviceSize)elemCount * pContext->keySize;
+    const VkDeviceSize valuesSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+    const VkBufferUsageFlags deviceUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    VkBuffer keysBuffer = VK_NULL_HANDLE, valuesBuffer = VK_NULL_HANDLE, hostBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory keysMemory = VK_NULL_HANDLE, valuesMemory = VK_NULL_HANDLE, hostMemory = VK_NULL_HANDLE;
+    void* refKeys = malloc((size_t)keysSize);
+    VkResult result = refKeys != NULL ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    do
+    {
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to allocate the reference keys!\n");
+            break;
+        }
+
+        result = CreateBufferWithMemory(device, pMemoryProperties, keysSize, deviceUsage,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &keysBuffer, &keysMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, valuesSize, deviceUsage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &valuesBuffer, &valuesMemory);
+        }
+        // The unsorted keys and values, followed by the sorted ones
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, (keysSize + valuesSize) * 2U,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &hostBuffer, &hostMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        void* hostPtr = NULL;
+        result = vkMapMemory(device, hostMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        uint8_t* srcKeys = hostPtr;
+        uint32_t* srcValues = (uint32_t*)(srcKeys + keysSize);
+        const uint8_t* sortedKeys = (const uint8_t*)(srcValues + elemCount);
+        const uint32_t* sortedValues = (const uint32_t*)(sortedKeys + keysSize);
+
+        // Random keys out of (elemCount / RADIX_TEST_KEY_REPEAT_COUNT) distinct ones, so that every key occurs about RADIX_TEST_KEY_REPEAT_COUNT times
+        // and the stability is verified by the values. Multiplying by an odd constant keeps the keys distinct and spreads them over all the bits.
+        const uint32_t distinctKeyCount = elemCount / RADIX_TEST_KEY_REPEAT_COUNT > 0 ? elemCount / RADIX_TEST_KEY_REPEAT_COUNT : 1U;
+        uint64_t state = elemCount;
+        for (uint32_t i = 0; i < elemCount; i++)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint32_t keyIndex = (uint32_t)(state >> 32) % distinctKeyCount;
+            if (keyType == RADIX_SORT_KEY_UINT64) {
+                ((uint64_t*)srcKeys)[i] = (uint64_t)keyIndex * 0x9e3779b97f4a7c15ULL;
+            }
+            else {
+                ((uint32_t*)srcKeys)[i] = keyIndex * 2654435761U;
+            }
+            srcValues[i] = i;
+        }
+        memcpy(refKeys, srcKeys, (size_t)keysSize);
+
+        const uint64_t qsortBeginTime = HostGetTimeNanoseconds();
+        qsort(refKeys, elemCount, pContext->keySize, keyType == RADIX_SORT_KEY_UINT64 ? CompareUInt64 : CompareUInt32);
+        const double qsortMilliseconds = (double)(HostGetTimeNanoseconds() - qsortBeginTime) / 1000000.0;
+        printf("%-24s %10.3f ms  %9.2f Mkeys/s\n", "host qsort (keys only)", qsortMilliseconds, (double)elemCount / (qsortMilliseconds * 1000.0));
+
+        for (int withValues = 0; withValues < 2 && result == VK_SUCCESS; withValues++)
+        {
+            struct RadixSortPlan* pPlan = NULL;
+            result = CreateRadixSortPlan(pContext, pMemoryProperties, queueFamilyIndex, elemCount, keysBuffer,
+                withValues != 0 ? valuesBuffer : VK_NULL_HANDLE, &pPlan);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "CreateRadixSortPlan failed!\n");
+                break;
+            }
+
+            do
+            {
+                // Sort once and read back for the verification
+                result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+                if (result != VK_SUCCESS) break;
+                RecordSortInputUpload(commandBuffer, hostBuffer, keysBuffer, pPlan->valuesBuffer, keysSize, valuesSize);
+                RecordRadixSort(commandBuffer, pPlan, elemCount);
+
+                const VkMemoryBarrier readBarrier = {
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                    .pNext = NULL,
+                    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT
+                };
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                    1, &readBarrier, 0, NULL, 0, NULL);
+
+                const VkBufferCopy keysRegion = { .srcOffset = 0, .dstOffset = keysSize + valuesSize, .size = keysSize };
+                vkCmdCopyBuffer(commandBuffer, keysBuffer, hostBuffer, 1, &keysRegion);
+                if (withValues != 0)
+                {
+                    const VkBufferCopy valuesRegion = { .srcOffset = 0, .dstOffset = keysSize * 2U + valuesSize, .size = valuesSize };
+                    vkCmdCopyBuffer(commandBuffer, valuesBuffer, hostBuffer, 1, &valuesRegion);
+                }
+                result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+                if (result != VK_SUCCESS) break;
+
+                const size_t errorIndex = VerifySortResult(keyType, srcKeys, sortedKeys, withValues != 0 ? sortedValues : NULL, refKeys, elemCount);
+                if (errorIndex != SIZE_MAX) {
+                    fprintf(stderr, "Radix sort result error @ %zu!\n", errorIndex);
+                }
+
+                // Only the sort itself is timed. The input is restored by a separate submission before each run.
+                uint64_t elapsedTime = 0;
+                for (int loop = 0; loop < RADIX_BENCHMARK_LOOP_COUNT && result == VK_SUCCESS; loop++)
+                {
+                    result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+                    if (result != VK_SUCCESS) break;
+                    RecordSortInputUpload(commandBuffer, hostBuffer, keysBuffer, pPlan->valuesBuffer, keysSize, valuesSize);
+                    result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+                    if (result != VK_SUCCESS) break;
+
+                    result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+                    if (result != VK_SUCCESS) break;
+                    RecordRadixSort(commandBuffer, pPlan, elemCount);
+                    const uint64_t beginTime = HostGetTimeNanoseconds();
+                    result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+                    elapsedTime += HostGetTimeNanoseconds() - beginTime;
+                }
+                if (result != VK_SUCCESS) break;
+
+                const double milliseconds = (double)elapsedTime / 1000000.0 / RADIX_BENCHMARK_LOOP_COUNT;
+                printf("%-24s %10.3f ms  %9.2f Mkeys/s  x%.2f vs qsort  (verify %s)\n", withValues != 0 ? "GPU radix sort (pairs)" : "GPU radix sort (keys)",
+                    milliseconds, (double)elemCount / (milliseconds * 1000.0), qsortMilliseconds / milliseconds, errorIndex == SIZE_MAX ? "OK" : "FAILED");
+            } while (false);
+
+            DestroyRadixSortPlan(pPlan);
+        }
+
+        vkUnmapMemory(device, hostMemory);
+    } while (false);
+
+    DestroyBufferWithMemory(device, hostBuffer, hostMemory);
+    DestroyBufferWithMemory(device, valuesBuffer, valuesMemory);
+    DestroyBufferWithMemory(device, keysBuffer, keysMemory);
+    free(refKeys);
+
+    return result;
+}
+
+void RadixSortComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    puts("\n================ Begin radix sort test ================\n");
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+
+    do
+    {
+        VkResult result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        for (size_t i = 0; i < sizeof(s_radixSortTestConfigs) / sizeof(s_radixSortTestConfigs[0]) && result == VK_SUCCESS; i++)
+        {
+            const struct RadixSortTestConfig* pConfig = &s_radixSortTestConfigs[i];
+            struct RadixSortContext* pContext = NULL;
+            result = CreateRadixSortContext(specDevice, pLimits, pSubgroupProperties, pConfig->keyType, pConfig->radixBits, &pContext);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "CreateRadixSortContext failed!\n");
+                break;
+            }
+
+            for (size_t j = 0; j < sizeof(s_radixSortTestElemCounts) / sizeof(s_radixSortTestElemCounts[0]); j++)
+            {
+                printf("---- %u %s keys, %u-bit radix ----\n", s_radixSortTestElemCounts[j],
+                    pConfig->keyType == RADIX_SORT_KEY_UINT64 ? "64-bit" : "32-bit", pConfig->radixBits);
+
+                result = RunRadixSortWithElemCount(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffers[0],
+                    pContext, s_radixSortTestElemCounts[j]);
+                if (result != VK_SUCCESS)
+                {
+                    fprintf(stderr, "RunRadixSortWithElemCount failed!\n");
+                    break;
+                }
+            }
+
+            DestroyRadixSortContext(pContext);
+        }
+    } while (false);
+
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+
+    puts("\n================ Complete radix sort test ================\n");
+}
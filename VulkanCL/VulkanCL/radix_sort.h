@@ -0,0 +1,45 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// LSD radix sort of 32-bit or 64-bit unsigned keys, optionally carrying 32-bit values (shaders/radix_sort/radix_sort.cl).
+// Every pass runs a histogram kernel, an exclusive scan of the histogram (scan.h) and a stable scatter kernel.
+// The kernels access the keys and values through buffer device addresses, so the passes ping-pong between
+// the caller's buffers and the temporary buffers of the plan by swapping the push constant addresses.
+
+enum RadixSortKeyType
+{
+    RADIX_SORT_KEY_UINT32,
+    RADIX_SORT_KEY_UINT64
+};
+
+struct RadixSortContext;
+struct RadixSortPlan;
+
+// `radixBits` is the digit width of one pass, 4 or 8, which selects the module built with that RADIX_BITS (shaders/radix_sort/build-spv.sh).
+extern VkResult CreateRadixSortContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, enum RadixSortKeyType keyType, uint32_t radixBits,
+    struct RadixSortContext** ppContext);
+extern void DestroyRadixSortContext(struct RadixSortContext* pContext);
+
+// `keysBuffer` and `valuesBuffer` must be created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT (see CreateBufferWithMemory).
+// `valuesBuffer` is VK_NULL_HANDLE for the key only sort.
+extern VkResult CreateRadixSortPlan(struct RadixSortContext* pContext, const VkPhysicalDeviceMemoryProperties* pMemoryProperties,
+    uint32_t queueFamilyIndex, uint32_t maxElemCount, VkBuffer keysBuffer, VkBuffer valuesBuffer, struct RadixSortPlan** ppPlan);
+extern void DestroyRadixSortPlan(struct RadixSortPlan* pPlan);
+
+// Sorts the first `elemCount` keys (and values) in place. The commands read the buffers in the compute shader stage and
+// write them in the compute shader stage, or in the transfer stage when the pass count is odd.
+// The caller is responsible for the barriers before and after them.
+extern void RecordRadixSort(VkCommandBuffer commandBuffer, const struct RadixSortPlan* pPlan, uint32_t elemCount);
+
+extern void RadixSortComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties);
+
+#endif // !RADIX_SORT_H
+
@@ -0,0 +1,767 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "memory_budget.h"
+#include "scan.h"
+
+enum
+{
+    // These must be identical to the macros of the same name in shaders/scan/scan.cl
+    SCAN_ITEMS_PER_THREAD = 8,
+    SCAN_MAX_WORKGROUP_SIZE = 256,
+    SCAN_FLAG_INCLUSIVE = 1,
+    SCAN_FLAG_PREDICATE = 2,
+    SCAN_FLAG_NO_BLOCK_OFFSETS = 4,
+
+    // Each level divides the element count by the block element count, which is at least SCAN_ITEMS_PER_THREAD * 16 on any device,
+    // so that 4 levels of block sums are enough for 2^32 elements.
+    SCAN_MAX_LEVEL_COUNT = 4,
+
+    SCAN_BENCHMARK_LOOP_COUNT = 5,
+    // Inputs larger than this are only benchmarked, since the CPU verification would take longer than the GPU work itself
+    SCAN_MAX_VERIFY_ELEM_COUNT = 16 * 1024 * 1024,
+    SCAN_COMPACTION_THRESHOLD = 128
+};
+
+enum ScanKernel
+{
+    SCAN_KERNEL_REDUCE,
+    SCAN_KERNEL_DOWNSWEEP,
+    SCAN_KERNEL_COMPACT,
+    SCAN_KERNEL_FILL_PATTERN,
+    SCAN_KERNEL_COUNT
+};
+
+static const char* const s_scanKernelNames[SCAN_KERNEL_COUNT] = {
+    "ScanReduceKernel",
+    "ScanDownsweepKernel",
+    "CompactScatterKernel",
+    "ScanFillPatternKernel"
+};
+
+// The number of the global pointer arguments of each kernel
+static const uint32_t s_scanKernelBindingCounts[SCAN_KERNEL_COUNT] = { 2, 3, 4, 1 };
+
+// layout(push_constant, std430) uniform of all the scan kernels
+struct ScanPushConstants
+{
+    uint32_t elemCount;
+    uint32_t flags;
+    uint32_t threshold;
+};
+
+struct ScanContext
+{
+    VkDevice device;
+    VkShaderModule shaderModule;
+    VkDescriptorSetLayout descLayouts[SCAN_KERNEL_COUNT];
+    VkPipelineLayout pipelineLayouts[SCAN_KERNEL_COUNT];
+    VkPipeline pipelines[SCAN_KERNEL_COUNT];
+    uint32_t workgroupSize;
+    uint32_t blockElemCount;
+    uint32_t maxGroupCountX;
+    bool useSubgroups;
+};
+
+struct ScanPlan
+{
+    const struct ScanContext* pContext;
+    uint32_t maxElemCount;
+    // The number of the block sum levels needed by `maxElemCount` elements
+    uint32_t levelCount;
+    VkBuffer blockSumBuffers[SCAN_MAX_LEVEL_COUNT];
+    VkDeviceMemory blockSumMemories[SCAN_MAX_LEVEL_COUNT];
+    VkDescriptorPool descriptorPool;
+    // reduceSets[k] for k < levelCount, downsweepSets[k] for k <= levelCount
+    VkDescriptorSet reduceSets[SCAN_MAX_LEVEL_COUNT];
+    VkDescriptorSet downsweepSets[SCAN_MAX_LEVEL_COUNT + 1];
+    // VK_NULL_HANDLE if the plan has no count buffer
+    VkDescriptorSet compactSet;
+    VkDescriptorSet fillSet;
+};
+
+static uint32_t DivideRoundUp(uint32_t value, uint32_t divisor)
+{
+    return (uint32_t)(((uint64_t)value + divisor - 1U) / divisor);
+}
+
+// Spreads `groupCount` workgroups over the X and Y dimensions. The kernels skip the surplus workgroups of the last row.
+static void GetDispatchSize(const struct ScanContext* pContext, uint32_t groupCount, uint32_t* pGroupCountX, uint32_t* pGroupCountY)
+{
+    const uint32_t groupCountX = groupCount < pContext->maxGroupCountX ? groupCount : pContext->maxGroupCountX;
+    *pGroupCountX = groupCountX > 0 ? groupCountX : 1U;
+    *pGroupCountY = groupCount > 0 ? DivideRoundUp(groupCount, *pGroupCountX) : 1U;
+}
+
+static const VkPhysicalDeviceSubgroupSizeControlPropertiesEXT* FindSubgroupSizeControlProperties(
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    for (const VkBaseInStructure* pNode = pSubgroupProperties->pNext; pNode != NULL; pNode = pNode->pNext)
+    {
+        if (pNode->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES_EXT) {
+            return (const VkPhysicalDeviceSubgroupSizeControlPropertiesEXT*)pNode;
+        }
+    }
+    return NULL;
+}
+
+void GetScanPipelineConfig(const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties,
+    struct ScanPipelineConfig* pConfig)
+{
+    // The largest power of two the device allows, which keeps the Hillis-Steele scan simple
+    uint32_t maxWorkgroupSize = SCAN_MAX_WORKGROUP_SIZE;
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupInvocations) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupInvocations;
+    }
+    if (maxWorkgroupSize > pLimits->maxComputeWorkGroupSize[0]) {
+        maxWorkgroupSize = pLimits->maxComputeWorkGroupSize[0];
+    }
+    uint32_t workgroupSize = 1;
+    while (workgroupSize * 2U <= maxWorkgroupSize) {
+        workgroupSize *= 2U;
+    }
+
+    *pConfig = (struct ScanPipelineConfig){
+        .shaderFileName = "shaders/scan/scan.spv",
+        .workgroupSize = workgroupSize,
+        .useSubgroups = false,
+        .stageFlags = 0,
+        .requiredSubgroupSize = 0
+    };
+
+    // The first subgroup scans the totals of all the subgroups of the workgroup in WorkGroupExclusiveScan,
+    // so the workgroup must consist of full subgroups, no more of them than a subgroup has invocations.
+    // Only VK_EXT_subgroup_size_control guarantees that, by requiring full subgroups, and the subgroup size where the device allows it.
+    const VkPhysicalDeviceSubgroupSizeControlPropertiesEXT* pSizeControlProperties = FindSubgroupSizeControlProperties(pSubgroupProperties);
+    const VkSubgroupFeatureFlags requiredOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+    if (pSizeControlProperties == NULL || (pSubgroupProperties->supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) == 0 ||
+        (pSubgroupProperties->supportedOperations & requiredOperations) != requiredOperations) {
+        return;
+    }
+
+    // Without a required subgroup size, full subgroups are of the default size
+    uint32_t subgroupSize = pSubgroupProperties->subgroupSize;
+    uint32_t maxSubgroupCount = subgroupSize;
+    uint32_t requiredSubgroupSize = 0;
+    if ((pSizeControlProperties->requiredSubgroupSizeStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0)
+    {
+        // The largest subgroups scan the most subgroups
+        subgroupSize = pSizeControlProperties->maxSubgroupSize;
+        maxSubgroupCount = subgroupSize < pSizeControlProperties->maxComputeWorkgroupSubgroups ?
+            subgroupSize : pSizeControlProperties->maxComputeWorkgroupSubgroups;
+        requiredSubgroupSize = subgroupSize;
+    }
+    if (subgroupSize == 0) return;
+
+    // Shrink the workgroup if it has more subgroups than the first subgroup is able to scan,
+    // unless the subgroups are so small that the plain local memory scan with a larger workgroup is preferable.
+    const uint32_t maxSubgroupWorkgroupSize = subgroupSize * maxSubgroupCount;
+    if (workgroupSize > maxSubgroupWorkgroupSize && maxSubgroupWorkgroupSize >= 64U)
+    {
+        while (workgroupSize > maxSubgroupWorkgroupSize) {
+            workgroupSize /= 2U;
+        }
+    }
+    if (workgroupSize % subgroupSize != 0 || workgroupSize / subgroupSize > maxSubgroupCount) return;
+    // The subgroup variant is built apart from the local memory one, so it may be missing on its own
+    if (!IsShaderModuleAvailable("shaders/scan/scan_subgroup.spv")) return;
+
+    pConfig->shaderFileName = "shaders/scan/scan_subgroup.spv";
+    pConfig->workgroupSize = workgroupSize;
+    pConfig->useSubgroups = true;
+    pConfig->stageFlags = VK_PIPELINE_SHADER_STAGE_CREATE_REQUIRE_FULL_SUBGROUPS_BIT_EXT;
+    pConfig->requiredSubgroupSize = requiredSubgroupSize;
+}
+
+VkResult CreateScanContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, struct ScanContext** ppContext)
+{
+    struct ScanContext* pContext = calloc(1, sizeof(*pContext));
+    if (pContext == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pContext->device = device;
+
+    struct ScanPipelineConfig config;
+    GetScanPipelineConfig(pLimits, pSubgroupProperties, &config);
+    const uint32_t workgroupSize = config.workgroupSize;
+
+    pContext->useSubgroups = config.useSubgroups;
+    pContext->workgroupSize = workgroupSize;
+    pContext->blockElemCount = workgroupSize * SCAN_ITEMS_PER_THREAD;
+    pContext->maxGroupCountX = pLimits->maxComputeWorkGroupCount[0];
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        if (!IsShaderModuleAvailable(config.shaderFileName))
+        {
+            fprintf(stderr, "%s has not been built by shaders/scan/build-spv!\n", config.shaderFileName);
+            result = VK_ERROR_INITIALIZATION_FAILED;
+            break;
+        }
+
+        result = CreateShaderModule(device, config.shaderFileName, &pContext->shaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        const uint32_t specConstants[] = { workgroupSize, 1U, 1U };
+        for (int i = 0; i < SCAN_KERNEL_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = CreateStorageBufferDescriptorSetLayout(device, s_scanKernelBindingCounts[i], &pContext->descLayouts[i]);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+                break;
+            }
+
+            result = CreateComputePipelineLayout(device, pContext->descLayouts[i], sizeof(struct ScanPushConstants), &pContext->pipelineLayouts[i]);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+                break;
+            }
+
+            result = CreateComputePipelineWithStageFlags(device, pContext->shaderModule, s_scanKernelNames[i], pContext->pipelineLayouts[i],
+                specConstants, (uint32_t)(sizeof(specConstants) / sizeof(specConstants[0])), config.stageFlags, config.requiredSubgroupSize,
+                &pContext->pipelines[i]);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "CreateComputePipelineWithStageFlags failed for %s!\n", s_scanKernelNames[i]);
+            }
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyScanContext(pContext);
+        return result;
+    }
+
+    *ppContext = pContext;
+    return VK_SUCCESS;
+}
+
+void DestroyScanContext(struct ScanContext* pContext)
+{
+    if (pContext == NULL) return;
+
+    const VkDevice device = pContext->device;
+    for (int i = 0; i < SCAN_KERNEL_COUNT; i++)
+    {
+        if (pContext->pipelines[i] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, pContext->pipelines[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+        if (pContext->pipelineLayouts[i] != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, pContext->pipelineLayouts[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+        }
+        if (pContext->descLayouts[i] != VK_NULL_HANDLE) {
+            vkDestroyDescriptorSetLayout(device, pContext->descLayouts[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+        }
+    }
+    if (pContext->shaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(device, pContext->shaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+
+    free(pContext);
+}
+
+bool IsScanContextUsingSubgroups(const struct ScanContext* pContext)
+{
+    return pContext->useSubgroups;
+}
+
+uint32_t GetScanBlockElemCount(const struct ScanContext* pContext)
+{
+    return pContext->blockElemCount;
+}
+
+VkResult CreateScanPlan(struct ScanContext* pContext, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    uint32_t maxElemCount, VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer countBuffer, struct ScanPlan** ppPlan)
+{
+    const VkDevice device = pContext->device;
+    const uint32_t blockElemCount = pContext->blockElemCount;
+
+    // The kernels compute the element indices in 32 bits, including the ones of the surplus workgroups of the 2D dispatch
+    uint32_t groupCountX, groupCountY;
+    GetDispatchSize(pContext, DivideRoundUp(maxElemCount, blockElemCount), &groupCountX, &groupCountY);
+    if ((uint64_t)groupCountX * groupCountY * blockElemCount > (uint64_t)UINT32_MAX + 1U)
+    {
+        fprintf(stderr, "%u elements exceed the capacity of the scan kernels!\n", maxElemCount);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct ScanPlan* pPlan = calloc(1, sizeof(*pPlan));
+    if (pPlan == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pPlan->pContext = pContext;
+    pPlan->maxElemCount = maxElemCount;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        // Level k holds one sum per block of the level k input, and is the input of level k + 1
+        uint32_t levelElemCount = maxElemCount;
+        while (levelElemCount > blockElemCount && pPlan->levelCount < SCAN_MAX_LEVEL_COUNT)
+        {
+            levelElemCount = DivideRoundUp(levelElemCount, blockElemCount);
+            result = CreateBufferWithMemory(device, pMemoryProperties, (VkDeviceSize)levelElemCount * sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex,
+                &pPlan->blockSumBuffers[pPlan->levelCount], &pPlan->blockSumMemories[pPlan->levelCount]);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "CreateBufferWithMemory failed!\n");
+                break;
+            }
+            pPlan->levelCount++;
+        }
+        if (result != VK_SUCCESS) break;
+
+        if (levelElemCount > blockElemCount)
+        {
+            fprintf(stderr, "%u elements need more than %d levels of block sums!\n", maxElemCount, SCAN_MAX_LEVEL_COUNT);
+            result = VK_ERROR_INITIALIZATION_FAILED;
+            break;
+        }
+
+        const uint32_t levelCount = pPlan->levelCount;
+        const uint32_t setCount = levelCount + (levelCount + 1U) + 2U;
+        const uint32_t descriptorCount = levelCount * s_scanKernelBindingCounts[SCAN_KERNEL_REDUCE] +
+            (levelCount + 1U) * s_scanKernelBindingCounts[SCAN_KERNEL_DOWNSWEEP] +
+            s_scanKernelBindingCounts[SCAN_KERNEL_COMPACT] + s_scanKernelBindingCounts[SCAN_KERNEL_FILL_PATTERN];
+        const VkDescriptorPoolCreateInfo descriptorPoolInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .maxSets = setCount,
+            .poolSizeCount = 1,
+            .pPoolSizes = (VkDescriptorPoolSize[]) {
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = descriptorCount }
+            }
+        };
+        result = vkCreateDescriptorPool(device, &descriptorPoolInfo, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &pPlan->descriptorPool);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkCreateDescriptorPool failed: %d\n", result);
+            break;
+        }
+
+        for (uint32_t level = 0; level <= levelCount && result == VK_SUCCESS; level++)
+        {
+            // Level 0 scans `srcBuffer` into `dstBuffer`. The upper levels scan the block sums of the level below in place.
+            const VkBuffer inBuffer = level == 0 ? srcBuffer : pPlan->blockSumBuffers[level - 1];
+            const VkBuffer outBuffer = level == 0 ? dstBuffer : pPlan->blockSumBuffers[level - 1];
+            // The top level runs with SCAN_FLAG_NO_BLOCK_OFFSETS, so any valid buffer will do for its offsets binding.
+            const VkBuffer offsetBuffer = level < levelCount ? pPlan->blockSumBuffers[level] : inBuffer;
+
+            if (level < levelCount)
+            {
+                const VkBuffer reduceBuffers[] = { inBuffer, pPlan->blockSumBuffers[level] };
+                result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayouts[SCAN_KERNEL_REDUCE],
+                    reduceBuffers, s_scanKernelBindingCounts[SCAN_KERNEL_REDUCE], &pPlan->reduceSets[level]);
+                if (result != VK_SUCCESS) break;
+            }
+
+            const VkBuffer downsweepBuffers[] = { inBuffer, outBuffer, offsetBuffer };
+            result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayouts[SCAN_KERNEL_DOWNSWEEP],
+                downsweepBuffers, s_scanKernelBindingCounts[SCAN_KERNEL_DOWNSWEEP], &pPlan->downsweepSets[level]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AllocateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        if (countBuffer != VK_NULL_HANDLE)
+        {
+            const VkBuffer compactBuffers[] = { srcBuffer, dstBuffer, levelCount > 0 ? pPlan->blockSumBuffers[0] : srcBuffer, countBuffer };
+            result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayouts[SCAN_KERNEL_COMPACT],
+                compactBuffers, s_scanKernelBindingCounts[SCAN_KERNEL_COMPACT], &pPlan->compactSet);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "AllocateStorageBufferDescriptorSet failed!\n");
+                break;
+            }
+        }
+
+        result = AllocateStorageBufferDescriptorSet(device, pPlan->descriptorPool, pContext->descLayouts[SCAN_KERNEL_FILL_PATTERN],
+            &srcBuffer, s_scanKernelBindingCounts[SCAN_KERNEL_FILL_PATTERN], &pPlan->fillSet);
+        if (result != VK_SUCCESS) {
+            fprintf(stderr, "AllocateStorageBufferDescriptorSet failed!\n");
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyScanPlan(pPlan);
+        return result;
+    }
+
+    *ppPlan = pPlan;
+    return VK_SUCCESS;
+}
+
+void DestroyScanPlan(struct ScanPlan* pPlan)
+{
+    if (pPlan == NULL) return;
+
+    const VkDevice device = pPlan->pContext->device;
+    // The descriptor sets are freed together with the pool
+    if (pPlan->descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, pPlan->descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    for (int i = 0; i < SCAN_MAX_LEVEL_COUNT; i++) {
+        DestroyBufferWithMemory(device, pPlan->blockSumBuffers[i], pPlan->blockSumMemories[i]);
+    }
+
+    free(pPlan);
+}
+
+static void RecordScanKernel(VkCommandBuffer commandBuffer, const struct ScanContext* pContext, enum ScanKernel kernel,
+    VkDescriptorSet descriptorSet, uint32_t elemCount, uint32_t flags, uint32_t threshold)
+{
+    const struct ScanPushConstants pushConstants = { elemCount, flags, threshold };
+    uint32_t groupCountX, groupCountY;
+    GetDispatchSize(pContext, DivideRoundUp(elemCount, pContext->blockElemCount), &groupCountX, &groupCountY);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->pipelines[kernel]);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pContext->pipelineLayouts[kernel], 0, 1, &descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pContext->pipelineLayouts[kernel], VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+}
+
+// Records the scan of the level `level` input of `elemCount` elements. Level 0 runs `finalKernel` with `flags`;
+// the upper levels always scan their block sums exclusively.
+static void RecordScanLevel(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t level, uint32_t elemCount,
+    enum ScanKernel finalKernel, uint32_t flags, uint32_t threshold)
+{
+    const struct ScanContext* pContext = pPlan->pContext;
+    const VkDescriptorSet finalSet = finalKernel == SCAN_KERNEL_COMPACT ? pPlan->compactSet : pPlan->downsweepSets[level];
+
+    if (elemCount <= pContext->blockElemCount)
+    {
+        RecordScanKernel(commandBuffer, pContext, finalKernel, finalSet, elemCount, flags | SCAN_FLAG_NO_BLOCK_OFFSETS, threshold);
+        return;
+    }
+
+    // Only the predicate affects the block sums
+    RecordScanKernel(commandBuffer, pContext, SCAN_KERNEL_REDUCE, pPlan->reduceSets[level], elemCount, flags & SCAN_FLAG_PREDICATE, threshold);
+    RecordComputeToComputeBarrier(commandBuffer);
+
+    RecordScanLevel(commandBuffer, pPlan, level + 1U, DivideRoundUp(elemCount, pContext->blockElemCount), SCAN_KERNEL_DOWNSWEEP, 0, 0);
+    RecordComputeToComputeBarrier(commandBuffer);
+
+    RecordScanKernel(commandBuffer, pContext, finalKernel, finalSet, elemCount, flags, threshold);
+}
+
+void RecordScan(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount, bool inclusive)
+{
+    if (elemCount == 0 || elemCount > pPlan->maxElemCount) return;
+
+    RecordScanLevel(commandBuffer, pPlan, 0, elemCount, SCAN_KERNEL_DOWNSWEEP, inclusive ? SCAN_FLAG_INCLUSIVE : 0, 0);
+}
+
+void RecordCompaction(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount, uint32_t threshold)
+{
+    if (elemCount == 0 || elemCount > pPlan->maxElemCount || pPlan->compactSet == VK_NULL_HANDLE) return;
+
+    RecordScanLevel(commandBuffer, pPlan, 0, elemCount, SCAN_KERNEL_COMPACT, SCAN_FLAG_PREDICATE, threshold);
+}
+
+void RecordScanTestPattern(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount)
+{
+    if (elemCount == 0 || elemCount > pPlan->maxElemCount) return;
+
+    RecordScanKernel(commandBuffer, pPlan->pContext, SCAN_KERNEL_FILL_PATTERN, pPlan->fillSet, elemCount, 0, 0);
+}
+
+// ---- Test and benchmark ----
+
+static uint32_t GetTestPatternValue(uint32_t index)
+{
+    return (index * 2654435761U) >> 24;
+}
+
+enum ScanTestOperation
+{
+    SCAN_TEST_EXCLUSIVE,
+    SCAN_TEST_INCLUSIVE,
+    SCAN_TEST_COMPACTION,
+    SCAN_TEST_OPERATION_COUNT
+};
+
+static const char* const s_scanTestOperationNames[SCAN_TEST_OPERATION_COUNT] = {
+    "exclusive scan",
+    "inclusive scan",
+    "compaction"
+};
+
+static const uint32_t s_scanTestElemCounts[] = { 1000000U, 10000000U, 100000000U, 1000000000U };
+
+static void RecordScanTestOperation(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, enum ScanTestOperation operation, uint32_t elemCount)
+{
+    switch (operation)
+    {
+    case SCAN_TEST_EXCLUSIVE:
+        RecordScan(commandBuffer, pPlan, elemCount, false);
+        break;
+
+    case SCAN_TEST_INCLUSIVE:
+        RecordScan(commandBuffer, pPlan, elemCount, true);
+        break;
+
+    case SCAN_TEST_COMPACTION:
+    default:
+        RecordCompaction(commandBuffer, pPlan, elemCount, SCAN_COMPACTION_THRESHOLD);
+        break;
+    }
+}
+
+// Returns the index of the first wrong element of `result`, or SIZE_MAX if all the elements are correct.
+// For compaction, `count` is the element count reported by the GPU.
+static size_t VerifyScanResult(enum ScanTestOperation operation, const uint32_t* result, uint32_t elemCount, uint32_t count)
+{
+    uint32_t sum = 0;
+    uint32_t keptCount = 0;
+    for (uint32_t i = 0; i < elemCount; i++)
+    {
+        const uint32_t value = GetTestPatternValue(i);
+        switch (operation)
+        {
+        case SCAN_TEST_EXCLUSIVE:
+            if (result[i] != sum) return i;
+            sum += value;
+            break;
+
+        case SCAN_TEST_INCLUSIVE:
+            sum += value;
+            if (result[i] != sum) return i;
+            break;
+
+        case SCAN_TEST_COMPACTION:
+        default:
+            if (value >= SCAN_COMPACTION_THRESHOLD)
+            {
+                if (keptCount >= count || result[keptCount] != value) return keptCount;
+                keptCount++;
+            }
+            break;
+        }
+    }
+
+    if (operation == SCAN_TEST_COMPACTION && keptCount != count) return count;
+    return SIZE_MAX;
+}
+
+static VkResult RunScanWithElemCount(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, struct ScanContext* pContext, uint32_t elemCount)
+{
+    const VkDeviceSize bufferSize = (VkDeviceSize)elemCount * sizeof(uint32_t);
+    const bool verify = elemCount <= SCAN_MAX_VERIFY_ELEM_COUNT;
+
+    printf("---- %u elements ----\n", elemCount);
+
+    VkBuffer srcBuffer = VK_NULL_HANDLE, dstBuffer = VK_NULL_HANDLE, countBuffer = VK_NULL_HANDLE, hostBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory srcMemory = VK_NULL_HANDLE, dstMemory = VK_NULL_HANDLE, countMemory = VK_NULL_HANDLE, hostMemory = VK_NULL_HANDLE;
+    struct ScanPlan* pPlan = NULL;
+    VkResult result = VK_SUCCESS;
+
+    do
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &srcBuffer, &srcMemory);
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &dstBuffer, &dstMemory);
+        }
+        if (result == VK_SUCCESS)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &countBuffer, &countMemory);
+        }
+        if (result == VK_SUCCESS && verify)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &hostBuffer, &hostMemory);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = CreateScanPlan(pContext, pMemoryProperties, queueFamilyIndex, elemCount, srcBuffer, dstBuffer, countBuffer, &pPlan);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateScanPlan failed!\n");
+            break;
+        }
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+        RecordScanTestPattern(commandBuffer, pPlan, elemCount);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const uint32_t* hostResult = NULL;
+        if (verify)
+        {
+            void* hostPtr = NULL;
+            result = vkMapMemory(device, hostMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "vkMapMemory failed: %d\n", result);
+                break;
+            }
+            hostResult = hostPtr;
+        }
+        void* countPtr = NULL;
+        result = vkMapMemory(device, countMemory, 0, VK_WHOLE_SIZE, 0, &countPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        const volatile uint32_t* pCount = countPtr;
+
+        for (int operation = 0; operation < SCAN_TEST_OPERATION_COUNT && result == VK_SUCCESS; operation++)
+        {
+            const char* verifyResult = "not verified";
+            if (verify)
+            {
+                result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+                if (result != VK_SUCCESS) break;
+                RecordScanTestOperation(commandBuffer, pPlan, (enum ScanTestOperation)operation, elemCount);
+                RecordComputeToTransferBarrier(commandBuffer);
+                const VkBufferCopy copyRegion = { .srcOffset = 0, .dstOffset = 0, .size = bufferSize };
+                vkCmdCopyBuffer(commandBuffer, dstBuffer, hostBuffer, 1, &copyRegion);
+                result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+                if (result != VK_SUCCESS) break;
+
+                const size_t errorIndex = VerifyScanResult((enum ScanTestOperation)operation, hostResult, elemCount, *pCount);
+                if (errorIndex == SIZE_MAX) {
+                    verifyResult = "verify OK";
+                }
+                else
+                {
+                    fprintf(stderr, "%s: wrong result at [%zu]!\n", s_scanTestOperationNames[operation], errorIndex);
+                    verifyResult = "verify FAILED";
+                }
+            }
+
+            result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+            if (result != VK_SUCCESS) break;
+            for (int loop = 0; loop < SCAN_BENCHMARK_LOOP_COUNT; loop++)
+            {
+                if (loop > 0) {
+                    RecordComputeToComputeBarrier(commandBuffer);
+                }
+                RecordScanTestOperation(commandBuffer, pPlan, (enum ScanTestOperation)operation, elemCount);
+            }
+
+            const uint64_t beginTime = HostGetTimeNanoseconds();
+            result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+            const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+            if (result != VK_SUCCESS) break;
+
+            const double milliseconds = (double)elapsedTime / 1000000.0 / SCAN_BENCHMARK_LOOP_COUNT;
+            printf("%-16s %10.3f ms  %8.3f Gelem/s  (%s)\n", s_scanTestOperationNames[operation], milliseconds,
+                (double)elemCount / (milliseconds * 1000000.0), verifyResult);
+        }
+
+        vkUnmapMemory(device, countMemory);
+        if (verify) {
+            vkUnmapMemory(device, hostMemory);
+        }
+    } while (false);
+
+    DestroyScanPlan(pPlan);
+    DestroyBufferWithMemory(device, hostBuffer, hostMemory);
+    DestroyBufferWithMemory(device, countBuffer, countMemory);
+    DestroyBufferWithMemory(device, dstBuffer, dstMemory);
+    DestroyBufferWithMemory(device, srcBuffer, srcMemory);
+
+    return result;
+}
+
+void ScanComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties)
+{
+    puts("\n================ Begin scan and compaction test ================\n");
+
+    struct ScanContext* pContext = NULL;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/scan/scan.spv"))
+        {
+            puts("shaders/scan/scan.spv has not been built by shaders/scan/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        VkResult result = CreateScanContext(specDevice, pLimits, pSubgroupProperties, &pContext);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateScanContext failed!\n");
+            break;
+        }
+        printf("Workgroup size: %u, block size: %u elements, subgroup operations: %s\n", pContext->workgroupSize,
+            GetScanBlockElemCount(pContext), IsScanContextUsingSubgroups(pContext) ? "used" : "not used");
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        // src and dst must both fit in the budget of the device local heap
+        for (size_t i = 0; i < sizeof(s_scanTestElemCounts) / sizeof(s_scanTestElemCounts[0]); i++)
+        {
+            const uint32_t elemCount = s_scanTestElemCounts[i];
+            const uint64_t bufferSize = (uint64_t)elemCount * sizeof(uint32_t);
+            // The budget is taken again for every size, as the other processes and the previous runs move it
+            if (bufferSize > pLimits->maxStorageBufferRange ||
+                bufferSize * 2U > GetAvailableMemoryBudget(specDevice, pMemoryProperties, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+            {
+                printf("%u elements exceed the storage buffer range or the device local budget and will be skipped.\n", elemCount);
+                continue;
+            }
+
+            result = RunScanWithElemCount(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffers[0],
+                pContext, elemCount);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "RunScanWithElemCount failed!\n");
+                break;
+            }
+        }
+    } while (false);
+
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    DestroyScanContext(pContext);
+
+    puts("\n================ Complete scan and compaction test ================\n");
+}
@@ -0,0 +1,62 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Device-wide prefix scan and stream compaction over uint32 elements (shaders/scan/scan.cl).
+// A context owns the shader module and the pipelines. The subgroup variant of the kernels is chosen
+// when the device supports subgroup arithmetic operations in the compute stage, and the pipelines are able to require full subgroups:
+// `pSubgroupProperties` has to chain VkPhysicalDeviceSubgroupSizeControlPropertiesEXT, which the caller does only if
+// the subgroupSizeControl and computeFullSubgroups features are enabled, and scan_subgroup.spv has to have been built.
+// Otherwise the kernels scan in local memory. CreateScanContext fails if the chosen module has not been built.
+// A plan binds the source and destination buffers and owns the intermediate block sum buffers
+// sized for up to `maxElemCount` elements.
+
+struct ScanContext;
+struct ScanPlan;
+
+// The shader module and the shader stage of the scan pipelines, as CreateScanContext chooses them for the device
+struct ScanPipelineConfig
+{
+    const char* shaderFileName;
+    uint32_t workgroupSize;
+    bool useSubgroups;
+    VkPipelineShaderStageCreateFlags stageFlags;
+    // 0 if the subgroup size is left to the implementation
+    uint32_t requiredSubgroupSize;
+};
+
+extern void GetScanPipelineConfig(const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties,
+    struct ScanPipelineConfig* pConfig);
+
+extern VkResult CreateScanContext(VkDevice device, const VkPhysicalDeviceLimits* pLimits,
+    const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties, struct ScanContext** ppContext);
+extern void DestroyScanContext(struct ScanContext* pContext);
+
+extern bool IsScanContextUsingSubgroups(const struct ScanContext* pContext);
+// The number of elements one workgroup processes
+extern uint32_t GetScanBlockElemCount(const struct ScanContext* pContext);
+
+// `srcBuffer` and `dstBuffer` may be the same buffer for an in-place scan, but not for compaction.
+// `countBuffer` receives the number of the elements compaction keeps. It may be VK_NULL_HANDLE if compaction is not used.
+extern VkResult CreateScanPlan(struct ScanContext* pContext, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    uint32_t maxElemCount, VkBuffer srcBuffer, VkBuffer dstBuffer, VkBuffer countBuffer, struct ScanPlan** ppPlan);
+extern void DestroyScanPlan(struct ScanPlan* pPlan);
+
+// The recorded commands read `srcBuffer` and write `dstBuffer` in the compute shader stage.
+// The caller is responsible for the barriers before and after them.
+extern void RecordScan(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount, bool inclusive);
+// Keeps the elements that are not less than `threshold` in their original order.
+extern void RecordCompaction(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount, uint32_t threshold);
+// Fills `srcBuffer` with the benchmark pattern src[i] = (i * 2654435761) >> 24.
+extern void RecordScanTestPattern(VkCommandBuffer commandBuffer, const struct ScanPlan* pPlan, uint32_t elemCount);
+
+extern void ScanComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits, const VkPhysicalDeviceSubgroupProperties* pSubgroupProperties);
+
+#endif // !SCAN_H
+
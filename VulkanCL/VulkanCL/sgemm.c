@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#ifdef _WIN32
+
+#define _USE_MATH_DEFINES
+
+#endif // _WIN32
+
+#include <math.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "clspv_reflection.h"
+
+enum
+{
+    // These must be identical to the macros of the same name in shaders/sgemm/sgemm.cl
+    SGEMM_TILE_K = 16,
+    SGEMM_WPT_M = 4,
+    SGEMM_WPT_N = 4,
+
+    SGEMM_NAIVE_WORKGROUP_SIZE = 16,
+    SGEMM_BENCHMARK_LOOP_COUNT = 5,
+
+    // Binding order of the kernel arguments A, B and C
+    SGEMM_BUFFER_COUNT = 3
+};
+
+// layout(push_constant, std430) uniform of both SGEMM kernels
+struct SgemmPushConstants
+{
+    uint32_t M;
+    uint32_t N;
+    uint32_t K;
+    float alpha;
+    float beta;
+};
+
+// The tiled kernel workgroup shape. A workgroup computes a (localSizeY * SGEMM_WPT_M) x (localSizeX * SGEMM_WPT_N) tile of C.
+struct SgemmTileConfig
+{
+    uint32_t localSizeX;
+    uint32_t localSizeY;
+};
+
+static const struct SgemmTileConfig s_tileConfigs[] = {
+    { 8, 8 },
+    { 16, 8 },
+    { 16, 16 },
+    { 32, 8 }
+};
+
+// 1000 is not a multiple of any tile size so that the boundary handling is also verified
+static const uint32_t s_matrixSizes[] = { 1000, 1024, 2048 };
+
+enum
+{
+    SGEMM_TILE_CONFIG_COUNT = (int)(sizeof(s_tileConfigs) / sizeof(s_tileConfigs[0]))
+};
+
+struct CpuSgemmContext
+{
+    const float* A;
+    const float* B;
+    float* C;
+    uint32_t M;
+    uint32_t N;
+    uint32_t K;
+};
+
+// Computes the rows [begin, end) of C = A * B
+static void CpuSgemmTask(void* context, size_t begin, size_t end)
+{
+    const struct CpuSgemmContext* ctx = context;
+    const size_t N = ctx->N;
+    const size_t K = ctx->K;
+
+    for (size_t row = begin; row < end; row++)
+    {
+        float* dstRow = &ctx->C[row * N];
+        memset(dstRow, 0, N * sizeof(*dstRow));
+        for (size_t k = 0; k < K; k++)
+        {
+            const float a = ctx->A[row * K + k];
+            const float* srcRow = &ctx->B[k * N];
+            for (size_t col = 0; col < N; col++) {
+                dstRow[col] += a * srcRow[col];
+            }
+        }
+    }
+}
+
+static void FillRandomMatrix(float* dst, size_t count, uint32_t seed)
+{
+    uint32_t state = seed;
+    for (size_t i = 0; i < count; i++)
+    {
+        state = state * 1664525U + 1013904223U;
+        // [-1.0, 1.0)
+        dst[i] = (float)(state >> 8) / (float)(1U << 23) - 1.0f;
+    }
+}
+
+static double ComputeGflops(uint32_t M, uint32_t N, uint32_t K, double milliseconds)
+{
+    return 2.0 * (double)M * (double)N * (double)K / (milliseconds * 1000000.0);
+}
+
+static void RecordSgemmDispatch(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet,
+    const struct SgemmPushConstants* pArgs, uint32_t groupCountX, uint32_t groupCountY)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, NULL);
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(*pArgs), pArgs);
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, 1);
+}
+
+// Runs the kernel once to verify the result against `refC`, then runs it SGEMM_BENCHMARK_LOOP_COUNT times in one submission for timing.
+static VkResult RunAndMeasureSgemm(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer,
+    VkPipeline pipeline, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet, const struct SgemmPushConstants* pArgs,
+    uint32_t groupCountX, uint32_t groupCountY, VkBuffer deviceC, VkBuffer hostBuffer, VkDeviceSize hostCOffset,
+    const float* hostC, const float* refC, float* pMaxError, double* pMilliseconds)
+{
+    const VkDeviceSize sizeC = (VkDeviceSize)pArgs->M * pArgs->N * sizeof(float);
+
+    VkResult result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    // Poison C with NaNs so that a kernel leaving any element untouched never passes the verification
+    vkCmdFillBuffer(commandBuffer, deviceC, 0, sizeC, 0xffffffffU);
+    RecordTransferToComputeBarrier(commandBuffer);
+
+    RecordSgemmDispatch(commandBuffer, pipeline, pipelineLayout, descriptorSet, pArgs, groupCountX, groupCountY);
+
+    RecordComputeToTransferBarrier(commandBuffer);
+
+    const VkBufferCopy copyRegion = {
+        .srcOffset = 0,
+        .dstOffset = hostCOffset,
+        .size = sizeC
+    };
+    vkCmdCopyBuffer(commandBuffer, deviceC, hostBuffer, 1, &copyRegion);
+
+    result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    float maxError = 0.0f;
+    const size_t elemCount = (size_t)pArgs->M * pArgs->N;
+    for (size_t i = 0; i < elemCount; i++)
+    {
+        const float error = fabsf(hostC[i] - refC[i]);
+        // `!(error <= maxError)` also catches NaN, which is reported as an infinite error
+        if (!(error <= maxError)) {
+            maxError = isnan(error) ? INFINITY : error;
+        }
+    }
+    *pMaxError = maxError;
+
+    result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+    for (int loop = 0; loop < SGEMM_BENCHMARK_LOOP_COUNT; loop++)
+    {
+        if (loop > 0) {
+            RecordComputeToComputeBarrier(commandBuffer);
+        }
+        RecordSgemmDispatch(commandBuffer, pipeline, pipelineLayout, descriptorSet, pArgs, groupCountX, groupCountY);
+    }
+
+    const uint64_t beginTime = HostGetTimeNanoseconds();
+    result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+    const uint64_t elapsedTime = HostGetTimeNanoseconds() - beginTime;
+
+    *pMilliseconds = (double)elapsedTime / 1000000.0 / SGEMM_BENCHMARK_LOOP_COUNT;
+
+    return result;
+}
+
+static bool IsTileConfigSupported(const struct SgemmTileConfig* pConfig, const VkPhysicalDeviceLimits* pLimits)
+{
+    const uint32_t localMemorySize = SGEMM_TILE_K * (pConfig->localSizeY * SGEMM_WPT_M + pConfig->localSizeX * SGEMM_WPT_N) * (uint32_t)sizeof(float);
+    return pConfig->localSizeX <= pLimits->maxComputeWorkGroupSize[0] &&
+        pConfig->localSizeY <= pLimits->maxComputeWorkGroupSize[1] &&
+        pConfig->localSizeX * pConfig->localSizeY <= pLimits->maxComputeWorkGroupInvocations &&
+        localMemorySize <= pLimits->maxComputeSharedMemorySize;
+}
+
+struct SgemmPipelines
+{
+    VkPipelineLayout pipelineLayout;
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkPipeline naivePipeline;
+    // VK_NULL_HANDLE for the tile configs the device does not support
+    VkPipeline tiledPipelines[SGEMM_TILE_CONFIG_COUNT];
+};
+
+static VkResult RunSgemmWithMatrixSize(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, const struct SgemmPipelines* pPipelines, uint32_t matrixSize)
+{
+    const uint32_t M = matrixSize;
+    const uint32_t N = matrixSize;
+    const uint32_t K = matrixSize;
+    const VkDeviceSize sizeA = (VkDeviceSize)M * K * sizeof(float);
+    const VkDeviceSize sizeB = (VkDeviceSize)K * N * sizeof(float);
+    const VkDeviceSize sizeC = (VkDeviceSize)M * N * sizeof(float);
+
+    printf("---- M = N = K = %u ----\n", matrixSize);
+
+    // deviceBuffers[0 ~ 2] as device local A, B and C; hostBuffer holds A, B and C in order
+    VkBuffer deviceBuffers[SGEMM_BUFFER_COUNT] = { VK_NULL_HANDLE };
+    VkDeviceMemory deviceMemories[SGEMM_BUFFER_COUNT] = { VK_NULL_HANDLE };
+    VkBuffer hostBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory hostMemory = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    float* refC = malloc(sizeC);
+    VkResult result = refC != NULL ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    do
+    {
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to allocate the reference matrix!\n");
+            break;
+        }
+
+        const VkDeviceSize deviceSizes[SGEMM_BUFFER_COUNT] = { sizeA, sizeB, sizeC };
+        for (int i = 0; i < SGEMM_BUFFER_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = CreateBufferWithMemory(device, pMemoryProperties, deviceSizes[i],
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, queueFamilyIndex, &deviceBuffers[i], &deviceMemories[i]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = CreateBufferWithMemory(device, pMemoryProperties, sizeA + sizeB + sizeC,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &hostBuffer, &hostMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        void* hostPtr = NULL;
+        result = vkMapMemory(device, hostMemory, 0, VK_WHOLE_SIZE, 0, &hostPtr);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        float* hostA = hostPtr;
+        float* hostB = hostA + (size_t)M * K;
+        const float* hostC = hostB + (size_t)K * N;
+
+        FillRandomMatrix(hostA, (size_t)M * K, 1U);
+        FillRandomMatrix(hostB, (size_t)K * N, 2U);
+
+        struct CpuSgemmContext cpuContext = { hostA, hostB, refC, M, N, K };
+        const uint64_t cpuBeginTime = HostGetTimeNanoseconds();
+        HostParallelFor(M, 1, CpuSgemmTask, &cpuContext);
+        const double cpuMilliseconds = (double)(HostGetTimeNanoseconds() - cpuBeginTime) / 1000000.0;
+        printf("%-28s %10.3f ms  %9.2f GFLOP/s\n", "CPU reference", cpuMilliseconds, ComputeGflops(M, N, K, cpuMilliseconds));
+
+        // There's no need to free `descriptorSet`, since it is destroyed together with `descriptorPool`
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        result = CreateStorageBufferDescriptorSet(device, pPipelines->descriptorSetLayout, deviceBuffers, SGEMM_BUFFER_COUNT,
+            &descriptorPool, &descriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSet failed!\n");
+            break;
+        }
+
+        // Upload A and B
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        const VkBufferCopy copyRegionA = { .srcOffset = 0, .dstOffset = 0, .size = sizeA };
+        const VkBufferCopy copyRegionB = { .srcOffset = sizeA, .dstOffset = 0, .size = sizeB };
+        vkCmdCopyBuffer(commandBuffer, hostBuffer, deviceBuffers[0], 1, &copyRegionA);
+        vkCmdCopyBuffer(commandBuffer, hostBuffer, deviceBuffers[1], 1, &copyRegionB);
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) {
+            break;
+        }
+
+        const struct SgemmPushConstants args = { M, N, K, 1.0f, 0.0f };
+        // Float rounding error grows with the length of the dot products
+        const float tolerance = 1e-5f * (float)K;
+
+        float maxError = 0.0f;
+        double milliseconds = 0.0;
+        result = RunAndMeasureSgemm(device, queue, commandPool, commandBuffer, pPipelines->naivePipeline, pPipelines->pipelineLayout, descriptorSet,
+            &args, (N + SGEMM_NAIVE_WORKGROUP_SIZE - 1) / SGEMM_NAIVE_WORKGROUP_SIZE, (M + SGEMM_NAIVE_WORKGROUP_SIZE - 1) / SGEMM_NAIVE_WORKGROUP_SIZE,
+            deviceBuffers[2], hostBuffer, sizeA + sizeB, hostC, refC, &maxError, &milliseconds);
+        if (result != VK_SUCCESS) {
+            break;
+        }
+        const double naiveMilliseconds = milliseconds;
+        printf("%-28s %10.3f ms  %9.2f GFLOP/s  max error: %g%s\n", "GPU naive", milliseconds, ComputeGflops(M, N, K, milliseconds),
+            maxError, maxError <= tolerance ? "" : " (FAILED)");
+
+        for (int i = 0; i < SGEMM_TILE_CONFIG_COUNT; i++)
+        {
+            if (pPipelines->tiledPipelines[i] == VK_NULL_HANDLE) {
+                continue;
+            }
+
+            const struct SgemmTileConfig* pConfig = &s_tileConfigs[i];
+            const uint32_t tileM = pConfig->localSizeY * SGEMM_WPT_M;
+            const uint32_t tileN = pConfig->localSizeX * SGEMM_WPT_N;
+            result = RunAndMeasureSgemm(device, queue, commandPool, commandBuffer, pPipelines->tiledPipelines[i], pPipelines->pipelineLayout, descriptorSet,
+                &args, (N + tileN - 1) / tileN, (M + tileM - 1) / tileM,
+                deviceBuffers[2], hostBuffer, sizeA + sizeB, hostC, refC, &maxError, &milliseconds);
+            if (result != VK_SUCCESS) {
+                break;
+            }
+
+            char name[64];
+            snprintf(name, sizeof(name), "GPU tiled %ux%u (tile %ux%u)", pConfig->localSizeX, pConfig->localSizeY, tileM, tileN);
+            printf("%-28s %10.3f ms  %9.2f GFLOP/s  max error: %g%s, x%.2f vs naive\n", name, milliseconds, ComputeGflops(M, N, K, milliseconds),
+                maxError, maxError <= tolerance ? "" : " (FAILED)", naiveMilliseconds / milliseconds);
+        }
+
+        vkUnmapMemory(device, hostMemory);
+    } while (false);
+
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
+    }
+    DestroyBufferWithMemory(device, hostBuffer, hostMemory);
+    for (int i = 0; i < SGEMM_BUFFER_COUNT; i++) {
+        DestroyBufferWithMemory(device, deviceBuffers[i], deviceMemories[i]);
+    }
+    free(refC);
+
+    return result;
+}
+
+void SgemmComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin SGEMM test ================\n");
+
+    VkShaderModule computeShaderModule = VK_NULL_HANDLE;
+    struct SgemmPipelines pipelines = { VK_NULL_HANDLE };
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffers[1] = { VK_NULL_HANDLE };
+    uint32_t const commandBufferCount = (uint32_t)(sizeof(commandBuffers) / sizeof(commandBuffers[0]));
+
+    do
+    {
+        if (!IsShaderModuleAvailable("shaders/sgemm/sgemm.spv"))
+        {
+            puts("shaders/sgemm/sgemm.spv has not been built by shaders/sgemm/build-spv, so the test will be skipped.");
+            break;
+        }
+
+        VkResult result = CreateShaderModule(specDevice, "shaders/sgemm/sgemm.spv", &computeShaderModule);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateShaderModule failed!\n");
+            break;
+        }
+
+        result = CreateStorageBufferDescriptorSetLayout(specDevice, SGEMM_BUFFER_COUNT, &pipelines.descriptorSetLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateStorageBufferDescriptorSetLayout failed!\n");
+            break;
+        }
+
+        result = CreateComputePipelineLayout(specDevice, pipelines.descriptorSetLayout, sizeof(struct SgemmPushConstants), &pipelines.pipelineLayout);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineLayout failed!\n");
+            break;
+        }
+
+        const uint32_t naiveSpecConstants[] = { SGEMM_NAIVE_WORKGROUP_SIZE, SGEMM_NAIVE_WORKGROUP_SIZE, 1U };
+        result = CreateComputePipelineWithSpecConstants(specDevice, computeShaderModule, "SgemmNaiveKernel", pipelines.pipelineLayout,
+            naiveSpecConstants, (uint32_t)(sizeof(naiveSpecConstants) / sizeof(naiveSpecConstants[0])), &pipelines.naivePipeline);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineWithSpecConstants failed!\n");
+            break;
+        }
+
+        struct ClspvKernelReflection tiledReflection;
+        if (!LoadClspvKernelReflection("shaders/sgemm/sgemm.spv", "SgemmTiledKernel", &tiledReflection))
+        {
+            fprintf(stderr, "LoadClspvKernelReflection failed for SgemmTiledKernel!\n");
+            break;
+        }
+
+        for (int i = 0; i < SGEMM_TILE_CONFIG_COUNT && result == VK_SUCCESS; i++)
+        {
+            const struct SgemmTileConfig* pConfig = &s_tileConfigs[i];
+            if (!IsTileConfigSupported(pConfig, pLimits))
+            {
+                printf("Tile config %ux%u is not supported by the current device and will be skipped.\n", pConfig->localSizeX, pConfig->localSizeY);
+                continue;
+            }
+
+            // `tileA` and `tileB`, in bytes. Their specialization constant IDs come from the reflection information of the module.
+            const uint32_t workgroupSizes[3] = { pConfig->localSizeX, pConfig->localSizeY, 1U };
+            const uint32_t localArgumentSizes[] = {
+                SGEMM_TILE_K * pConfig->localSizeY * SGEMM_WPT_M * (uint32_t)sizeof(float),
+                SGEMM_TILE_K * pConfig->localSizeX * SGEMM_WPT_N * (uint32_t)sizeof(float)
+            };
+            uint32_t specConstants[CLSPV_MAX_SPEC_CONSTANT_COUNT];
+            uint32_t specConstantCount = 0;
+            result = GetClspvKernelSpecConstants("SgemmTiledKernel", &tiledReflection, workgroupSizes, localArgumentSizes,
+                (uint32_t)(sizeof(localArgumentSizes) / sizeof(localArgumentSizes[0])), pLimits, specConstants, &specConstantCount);
+            if (result == VK_SUCCESS)
+            {
+                result = CreateComputePipelineWithSpecConstants(specDevice, computeShaderModule, "SgemmTiledKernel", pipelines.pipelineLayout,
+                    specConstants, specConstantCount, &pipelines.tiledPipelines[i]);
+            }
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateComputePipelineWithSpecConstants failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, commandBuffers, commandBufferCount);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        for (size_t i = 0; i < sizeof(s_matrixSizes) / sizeof(s_matrixSizes[0]); i++)
+        {
+            result = RunSgemmWithMatrixSize(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffers[0],
+                &pipelines, s_matrixSizes[i]);
+            if (result != VK_SUCCESS)
+            {
+                fprintf(stderr, "RunSgemmWithMatrixSize failed!\n");
+                break;
+            }
+        }
+    } while (false);
+
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, commandBufferCount, commandBuffers);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    for (int i = 0; i < SGEMM_TILE_CONFIG_COUNT; i++)
+    {
+        if (pipelines.tiledPipelines[i] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(specDevice, pipelines.tiledPipelines[i], GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+        }
+    }
+    if (pipelines.naivePipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(specDevice, pipelines.naivePipeline, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE));
+    }
+    if (pipelines.pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(specDevice, pipelines.pipelineLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
+    }
+    if (pipelines.descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(specDevice, pipelines.descriptorSetLayout, GetHostAllocationCallbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
+    }
+    if (computeShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(specDevice, computeShaderModule, GetHostAllocationCallbacks(VK_OBJECT_TYPE_SHADER_MODULE));
+    }
+
+    puts("\n================ Complete SGEMM test ================\n");
+}
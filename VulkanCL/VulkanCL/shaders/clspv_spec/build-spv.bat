@@ -1,4 +1,5 @@
-:: Configure your own clspv.exe path here --
-set PATH=C:\Open-Source-Projects\clspv\build\bin\Release;%PATH%
+:: Set CLSPV_BIN_DIR to the directory of clspv.exe if it is not on PATH
+cd /d "%~dp0"
+if defined CLSPV_BIN_DIR set PATH=%CLSPV_BIN_DIR%;%PATH%
 clspv  clspv_spec.cl -o clspv_spec.spv --cl-std=CL1.2 --spv-version=1.3 --arch=spir64
 
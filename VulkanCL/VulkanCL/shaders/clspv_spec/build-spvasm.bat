@@ -1,2 +1,3 @@
+cd /d "%~dp0"
 %VK_SDK_PATH%\Bin\spirv-dis clspv_spec.spv  -o clspv_spec.spvasm
 
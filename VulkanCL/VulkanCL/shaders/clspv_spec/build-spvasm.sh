@@ -1,4 +1,6 @@
 #! /bin/sh
-export PATH=/Users/zenny-chen/VulkanSDK/1.3.243.0/macOS/bin:$PATH
+# VULKAN_SDK is set by the setup-env.sh of the Vulkan SDK
+cd "$(dirname "$0")" || exit 1
+if [ -n "$VULKAN_SDK" ]; then export PATH="$VULKAN_SDK/bin:$PATH"; fi
 spirv-dis clspv_spec.spv  -o clspv_spec.spvasm
 
@@ -0,0 +1,3 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis convolution.spv  -o convolution.spvasm
+
@@ -0,0 +1,104 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// Separable 2D convolution of single channel float images: a horizontal pass (rows) into an intermediate image,
+// followed by a vertical pass (columns). `weights` holds (2 * radius + 1) taps.
+// Pixels outside the image read as the border value: the image kernels get it from a sampler with
+// VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER and a custom border color, the buffer kernels from `borderValue`.
+// One work item per output pixel. Dimension 0 walks along the columns and dimension 1 along the rows.
+
+// ---- Image path ----
+// The sampler must be created with unnormalized coordinates and the nearest filter,
+// so that (x + 0.5, y + 0.5) addresses exactly the pixel (x, y).
+
+static inline float ReadPixel(read_only image2d_t src, sampler_t sampler, int x, int y)
+{
+    return read_imagef(src, sampler, (float2)((float)x + 0.5f, (float)y + 0.5f)).x;
+}
+
+// @param src: layout(set = 0, binding = 0) uniform texture2D
+// @param sampler: layout(set = 0, binding = 1) uniform sampler
+// @param dst: layout(set = 0, binding = 2) uniform writeonly image2D
+// @param weights: layout(set = 0, binding = 3, std430) buffer
+// @param width, height, radius: layout(push_constant, std430) uniform
+kernel void ConvolveRowsImageKernel(read_only image2d_t src, sampler_t sampler, write_only image2d_t dst, global const float* weights,
+    int width, int height, int radius)
+{
+    let const x = (int)get_global_id(0);
+    let const y = (int)get_global_id(1);
+    if (x >= width || y >= height) return;
+
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; i++) {
+        sum += weights[i + radius] * ReadPixel(src, sampler, x + i, y);
+    }
+    write_imagef(dst, (int2)(x, y), (float4)(sum, 0.0f, 0.0f, 1.0f));
+}
+
+// @param src: layout(set = 0, binding = 0) uniform texture2D
+// @param sampler: layout(set = 0, binding = 1) uniform sampler
+// @param dst: layout(set = 0, binding = 2) uniform writeonly image2D
+// @param weights: layout(set = 0, binding = 3, std430) buffer
+// @param width, height, radius: layout(push_constant, std430) uniform
+kernel void ConvolveColumnsImageKernel(read_only image2d_t src, sampler_t sampler, write_only image2d_t dst, global const float* weights,
+    int width, int height, int radius)
+{
+    let const x = (int)get_global_id(0);
+    let const y = (int)get_global_id(1);
+    if (x >= width || y >= height) return;
+
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; i++) {
+        sum += weights[i + radius] * ReadPixel(src, sampler, x, y + i);
+    }
+    write_imagef(dst, (int2)(x, y), (float4)(sum, 0.0f, 0.0f, 1.0f));
+}
+
+// ---- Buffer path ----
+// The same convolution over row-major buffers of width * height floats, with explicit bounds checks.
+
+static inline float LoadPixel(global const float* src, int x, int y, int width, int height, float borderValue)
+{
+    return x >= 0 && x < width && y >= 0 && y < height ? src[y * width + x] : borderValue;
+}
+
+// @param src: layout(set = 0, binding = 0, std430) buffer
+// @param dst: layout(set = 0, binding = 1, std430) buffer
+// @param weights: layout(set = 0, binding = 2, std430) buffer
+// @param width, height, radius, borderValue: layout(push_constant, std430) uniform
+kernel void ConvolveRowsBufferKernel(global const float* restrict src, global float* restrict dst, global const float* restrict weights,
+    int width, int height, int radius, float borderValue)
+{
+    let const x = (int)get_global_id(0);
+    let const y = (int)get_global_id(1);
+    if (x >= width || y >= height) return;
+
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; i++) {
+        sum += weights[i + radius] * LoadPixel(src, x + i, y, width, height, borderValue);
+    }
+    dst[y * width + x] = sum;
+}
+
+// @param src: layout(set = 0, binding = 0, std430) buffer
+// @param dst: layout(set = 0, binding = 1, std430) buffer
+// @param weights: layout(set = 0, binding = 2, std430) buffer
+// @param width, height, radius, borderValue: layout(push_constant, std430) uniform
+kernel void ConvolveColumnsBufferKernel(global const float* restrict src, global float* restrict dst, global const float* restrict weights,
+    int width, int height, int radius, float borderValue)
+{
+    let const x = (int)get_global_id(0);
+    let const y = (int)get_global_id(1);
+    if (x >= width || y >= height) return;
+
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; i++) {
+        sum += weights[i + radius] * LoadPixel(src, x, y + i, width, height, borderValue);
+    }
+    dst[y * width + x] = sum;
+}
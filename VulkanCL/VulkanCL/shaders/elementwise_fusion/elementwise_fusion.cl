@@ -0,0 +1,117 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// The kernels are compiled as C for the host backend as well (host_kernels.c). MSVC has no `__auto_type`, so they spell out their types rather than `let`.
+
+// Elementwise uint operations that can be chained and fused. Every operation takes the current value and one operand.
+// The op codes must be identical to `enum ElementwiseOp` in elementwise_fusion.h.
+#define ELEMENTWISE_OPS(X)  \
+    X(Add, 0, x + operand)  \
+    X(Mul, 1, x * operand)  \
+    X(Xor, 2, x ^ operand)  \
+    X(Min, 3, min(x, operand))  \
+    X(Max, 4, max(x, operand))
+
+#define DEFINE_APPLY_FUNCTION(name, opCode, expr)   \
+static inline uint Apply##name(uint x, uint operand) { return expr; }
+
+ELEMENTWISE_OPS(DEFINE_APPLY_FUNCTION)
+
+#define APPLY_OP_CASE(name, opCode, expr)   \
+    case opCode: return Apply##name(x, operand);
+
+static inline uint ApplyOp(uint opCode, uint x, uint operand)
+{
+    switch (opCode)
+    {
+        ELEMENTWISE_OPS(APPLY_OP_CASE)
+    default:
+        return x;
+    }
+}
+
+// All the kernels walk the elements with a grid-stride loop, so that any element count fits in a 1D dispatch.
+
+// ---- Unfused kernels: one pass through device memory per operation ----
+// @param dst: layout(set = 0, binding = 0, std430) buffer
+// @param src: layout(set = 0, binding = 1, std430) buffer; the steps after the first one run in place, with src == dst.
+// @param elemCount, operand: layout(push_constant, std430) uniform
+#define DEFINE_STEP_KERNEL(name, opCode, expr)  \
+kernel void Elementwise##name##Kernel(global uint* dst, global const uint* src, uint elemCount, uint operand)    \
+{   \
+    for (uint index = (uint)get_global_id(0); index < elemCount; index += (uint)get_global_size(0)) {   \
+        dst[index] = Apply##name(src[index], operand);  \
+    }   \
+}
+
+ELEMENTWISE_OPS(DEFINE_STEP_KERNEL)
+
+// ---- Interpreted chain: any chain of up to 8 operations in one pass ----
+// Op code k is in bits [4k, 4k + 4) of `packedOpCodes`. Operands 0 ~ 3 are in `operandsLo` and 4 ~ 7 in `operandsHi`.
+// The op codes are uniform over the dispatch, so the branches do not diverge, and the value stays in a register across the chain.
+// @param dst: layout(set = 0, binding = 0, std430) buffer
+// @param src: layout(set = 0, binding = 1, std430) buffer
+// @param elemCount, opCount, packedOpCodes, operandsLo, operandsHi: layout(push_constant, std430) uniform
+#define APPLY_CHAIN_STEP(k, operand)    \
+    if ((k) < opCount) x = ApplyOp((packedOpCodes >> ((k) * 4U)) & 15U, x, (operand))
+
+static inline uint ApplyChain(uint x, uint opCount, uint packedOpCodes, uint4 operandsLo, uint4 operandsHi)
+{
+    APPLY_CHAIN_STEP(0U, operandsLo.x);
+    APPLY_CHAIN_STEP(1U, operandsLo.y);
+    APPLY_CHAIN_STEP(2U, operandsLo.z);
+    APPLY_CHAIN_STEP(3U, operandsLo.w);
+    APPLY_CHAIN_STEP(4U, operandsHi.x);
+    APPLY_CHAIN_STEP(5U, operandsHi.y);
+    APPLY_CHAIN_STEP(6U, operandsHi.z);
+    APPLY_CHAIN_STEP(7U, operandsHi.w);
+    return x;
+}
+
+kernel void ElementwiseChainKernel(global uint* restrict dst, global const uint* restrict src, uint elemCount,
+    uint opCount, uint packedOpCodes, uint4 operandsLo, uint4 operandsHi)
+{
+    for (uint index = (uint)get_global_id(0); index < elemCount; index += (uint)get_global_size(0)) {
+        dst[index] = ApplyChain(src[index], opCount, packedOpCodes, operandsLo, operandsHi);
+    }
+}
+
+// ---- Interpreted chain over a device side element count, for vkCmdDispatchIndirect ----
+// The element count is the w component of slot `argsSlot` of the indirect args buffer, next to the workgroup counts in xyz,
+// as GroupCountKernel of indirect_dispatch.cl writes them. `elemCount` bounds it.
+// @param dst: layout(set = 0, binding = 0, std430) buffer
+// @param src: layout(set = 0, binding = 1, std430) buffer
+// @param dispatchArgs: layout(set = 0, binding = 2, std430) buffer
+// @param elemCount, opCount, packedOpCodes, argsSlot, operandsLo, operandsHi: layout(push_constant, std430) uniform
+kernel void ElementwiseChainIndirectKernel(global uint* restrict dst, global const uint* restrict src, global const uint4* dispatchArgs,
+    uint elemCount, uint opCount, uint packedOpCodes, uint argsSlot, uint4 operandsLo, uint4 operandsHi)
+{
+    uint const count = min(dispatchArgs[argsSlot].w, elemCount);
+    for (uint index = (uint)get_global_id(0); index < count; index += (uint)get_global_size(0)) {
+        dst[index] = ApplyChain(src[index], opCount, packedOpCodes, operandsLo, operandsHi);
+    }
+}
+
+// ---- Generated fused kernels: a dedicated entry point per chain, without any op code dispatch ----
+// Fused<Op0><Op1>Kernel applies Op0 and then Op1. Every instantiation must be listed in `s_fusedKernels` in elementwise_fusion.c.
+// @param dst: layout(set = 0, binding = 0, std430) buffer
+// @param src: layout(set = 0, binding = 1, std430) buffer
+// @param elemCount, operand0, operand1: layout(push_constant, std430) uniform
+#define DEFINE_FUSED_KERNEL_2(name0, name1) \
+kernel void Fused##name0##name1##Kernel(global uint* restrict dst, global const uint* restrict src, uint elemCount,  \
+    uint operand0, uint operand1)   \
+{   \
+    for (uint index = (uint)get_global_id(0); index < elemCount; index += (uint)get_global_size(0)) {   \
+        dst[index] = Apply##name1(Apply##name0(src[index], operand0), operand1);    \
+    }   \
+}
+
+// IncKernel -> DoubleKernel of the OpenCL with SPIR-V specific test
+DEFINE_FUSED_KERNEL_2(Add, Mul)
+DEFINE_FUSED_KERNEL_2(Mul, Add)
+
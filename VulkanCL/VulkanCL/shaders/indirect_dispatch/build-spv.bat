@@ -0,0 +1,5 @@
+:: Set CLSPV_BIN_DIR to the directory of clspv.exe if it is not on PATH
+cd /d "%~dp0"
+if defined CLSPV_BIN_DIR set PATH=%CLSPV_BIN_DIR%;%PATH%
+clspv  indirect_dispatch.cl -o indirect_dispatch.spv --cl-std=CL1.2 --spv-version=1.3 --arch=spir64
+
@@ -0,0 +1,3 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis indirect_dispatch.spv  -o indirect_dispatch.spvasm
+
@@ -0,0 +1,25 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// Dispatched as a single invocation between a kernel that produces an element count on the device and the indirect dispatch that consumes it.
+// Slot `argsSlot` of `dispatchArgs` receives VkDispatchIndirectCommand { ceil(count / elemsPerGroup), 1, 1 }, clamped to `maxGroupCount`
+// for the kernels with grid-stride loops, followed by the element count itself in the w component.
+//
+// @param counts: layout(set = 0, binding = 0, std430) buffer
+// @param dispatchArgs: layout(set = 0, binding = 1, std430) buffer
+// @param countIndex, argsSlot, elemsPerGroup, maxGroupCount: layout(push_constant, std430) uniform
+kernel void GroupCountKernel(global const uint* counts, global uint4* dispatchArgs, uint countIndex, uint argsSlot,
+    uint elemsPerGroup, uint maxGroupCount)
+{
+    if (get_global_id(0) != 0) return;
+
+    let const count = counts[countIndex];
+    // count + elemsPerGroup - 1 may overflow
+    let const groupCount = count / elemsPerGroup + (count % elemsPerGroup != 0 ? 1U : 0U);
+    dispatchArgs[argsSlot] = (uint4)(min(groupCount, maxGroupCount), 1U, 1U, count);
+}
@@ -0,0 +1,6 @@
+#! /bin/sh
+# Set CLSPV_BIN_DIR to the directory of clspv if it is not on PATH
+cd "$(dirname "$0")" || exit 1
+if [ -n "$CLSPV_BIN_DIR" ]; then export PATH="$CLSPV_BIN_DIR:$PATH"; fi
+clspv  iterative.cl -o iterative.spv --cl-std=CL1.2 --spv-version=1.3 --arch=spir64
+
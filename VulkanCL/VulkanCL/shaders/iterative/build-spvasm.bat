@@ -0,0 +1,3 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis iterative.spv  -o iterative.spvasm
+
@@ -0,0 +1,6 @@
+#! /bin/sh
+# VULKAN_SDK is set by the setup-env.sh of the Vulkan SDK
+cd "$(dirname "$0")" || exit 1
+if [ -n "$VULKAN_SDK" ]; then export PATH="$VULKAN_SDK/bin:$PATH"; fi
+spirv-dis iterative.spv  -o iterative.spvasm
+
@@ -0,0 +1,73 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// The kernels are compiled as C for the host backend as well (host_kernels.c). MSVC has no `__auto_type`, so they spell out their types rather than `let`.
+
+// The words of the control buffer. The indices must be identical to `enum IterativeControl` in iterative.h.
+// The largest relative change since the last convergence check, as the bits of a non-negative float
+#define ITERATIVE_CONTROL_RESIDUAL      0
+// The number of iterations that have run
+#define ITERATIVE_CONTROL_ITERATIONS    1
+// VkDispatchIndirectCommand of the iteration kernel, 16 bytes into the buffer
+#define ITERATIVE_CONTROL_DISPATCH_X    4
+
+// One Newton step of the square root of each coefficient, dst[i] = (src[i] + coefficients[i] / src[i]) / 2,
+// which the host dispatches many times, swapping `src` and `dst`.
+// The largest relative change of the dispatch is accumulated into the residual word.
+//
+// @param coefficients: layout(set = 0, binding = 0, std430) buffer, positive
+// @param src: layout(set = 0, binding = 1, std430) buffer, positive
+// @param dst: layout(set = 0, binding = 2, std430) buffer
+// @param control: layout(set = 0, binding = 3, std430) buffer
+// @param elemCount: layout(push_constant, std430) uniform
+kernel void NewtonSqrtKernel(global const float* coefficients, global const float* src, global float* dst, global uint* control, uint elemCount)
+{
+    local uint groupResidual;
+
+    uint const index = (uint)get_global_id(0);
+    uint const localID = (uint)get_local_id(0);
+
+    if (localID == 0) {
+        groupResidual = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (index < elemCount)
+    {
+        float const x = src[index];
+        float const y = 0.5f * (x + coefficients[index] / x);
+        dst[index] = y;
+
+        // Non-negative floats are ordered as their bits
+        atomic_max(&groupResidual, as_uint(fabs(y - x) / y));
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (localID == 0)
+    {
+        atomic_max(&control[ITERATIVE_CONTROL_RESIDUAL], groupResidual);
+        if (index == 0) {
+            atomic_inc(&control[ITERATIVE_CONTROL_ITERATIONS]);
+        }
+    }
+}
+
+// Dispatched as a single invocation after an iteration. Once the residual falls to `tolerance`, it zeroes the group count
+// of the indirect dispatches of the remaining iterations, so they do nothing.
+//
+// @param control: layout(set = 0, binding = 0, std430) buffer
+// @param tolerance: layout(push_constant, std430) uniform
+kernel void ConvergenceKernel(global uint* control, float tolerance)
+{
+    if (get_global_id(0) != 0) return;
+
+    if (as_float(control[ITERATIVE_CONTROL_RESIDUAL]) <= tolerance) {
+        control[ITERATIVE_CONTROL_DISPATCH_X] = 0;
+    }
+    control[ITERATIVE_CONTROL_RESIDUAL] = 0;
+}
@@ -0,0 +1,3 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis persistent_queue.spv  -o persistent_queue.spvasm
+
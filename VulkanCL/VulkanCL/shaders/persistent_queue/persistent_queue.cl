@@ -0,0 +1,100 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// The words of the control block. The indices must be identical to `enum PersistentQueueControl` in persistent_queue.c.
+// The head and the tail count the jobs ever claimed and published, and wrap around at 2^32.
+#define QUEUE_CONTROL_HEAD      0
+#define QUEUE_CONTROL_TAIL      1
+#define QUEUE_CONTROL_STOP      2
+#define QUEUE_CONTROL_ACTIVE    3
+
+#define NO_JOB  0xffffffffU
+
+// A job descriptor is (srcOffset, dstOffset, elemCount, sequence), and a job computes dst[i] = src[i] * 2 + 1.
+// When a job has been done, the sequence is written to its completion slot, which the host polls.
+//
+// Every workgroup keeps claiming jobs until the host sets the stop flag, no job arrives within `maxIdlePolls` polls in a row,
+// or it has polled `pollBudget` times in total. The budget bounds how long a dispatch runs, so that the driver watchdog never fires;
+// the host simply submits the dispatch again when all the workgroups have retired.
+// Workgroups never wait for one another, so the queue works whether or not all of them are resident at the same time.
+//
+// @param control: layout(set = 0, binding = 0, std430) buffer, host visible
+// @param jobs: layout(set = 0, binding = 1, std430) buffer, host visible, `capacity` descriptors
+// @param completions: layout(set = 0, binding = 2, std430) buffer, host visible, `capacity` words
+// @param src: layout(set = 0, binding = 3, std430) buffer
+// @param dst: layout(set = 0, binding = 4, std430) buffer
+// @param capacity: layout(push_constant, std430) uniform, a power of 2
+// @param maxIdlePolls: layout(push_constant, std430) uniform
+// @param pollBudget: layout(push_constant, std430) uniform
+kernel void PersistentQueueKernel(global uint* control, global volatile const uint4* jobs, global uint* completions,
+    global const uint* src, global uint* dst, uint capacity, uint maxIdlePolls, uint pollBudget)
+{
+    local uint sharedJob;
+
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+
+    if (localID == 0) {
+        atomic_inc(&control[QUEUE_CONTROL_ACTIVE]);
+    }
+
+    uint pollCount = 0;
+    while (true)
+    {
+        // The first invocation claims a job and shares it with the workgroup
+        if (localID == 0)
+        {
+            uint job = NO_JOB;
+            uint idlePollCount = 0;
+            while (pollCount < pollBudget && idlePollCount < maxIdlePolls)
+            {
+                pollCount++;
+                if (atomic_or(&control[QUEUE_CONTROL_STOP], 0U) != 0) break;
+
+                let const head = atomic_or(&control[QUEUE_CONTROL_HEAD], 0U);
+                let const tail = atomic_or(&control[QUEUE_CONTROL_TAIL], 0U);
+                if (head == tail)
+                {
+                    idlePollCount++;
+                    continue;
+                }
+                if (atomic_cmpxchg(&control[QUEUE_CONTROL_HEAD], head, head + 1U) == head)
+                {
+                    job = head;
+                    break;
+                }
+            }
+            sharedJob = job;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        let const job = sharedJob;
+        // No invocation may read `sharedJob` after the first one overwrites it in the next iteration
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (job == NO_JOB) break;
+
+        let const slot = job & (capacity - 1U);
+        let const descriptor = jobs[slot];
+        for (uint i = localID; i < descriptor.z; i += localSize) {
+            dst[descriptor.y + i] = src[descriptor.x + i] * 2U + 1U;
+        }
+
+        // The results must be visible before the completion
+        barrier(CLK_GLOBAL_MEM_FENCE);
+        if (localID == 0)
+        {
+            mem_fence(CLK_GLOBAL_MEM_FENCE);
+            atomic_xchg(&completions[slot], descriptor.w);
+        }
+    }
+
+    if (localID == 0) {
+        atomic_dec(&control[QUEUE_CONTROL_ACTIVE]);
+    }
+}
+
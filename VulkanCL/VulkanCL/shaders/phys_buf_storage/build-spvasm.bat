@@ -1,2 +1,3 @@
+cd /d "%~dp0"
 %VK_SDK_PATH%\Bin\spirv-dis buff_addr.spv  -o buff_addr.spvasm
 
@@ -0,0 +1,8 @@
+:: Set CLSPV_BIN_DIR to the directory of clspv.exe if it is not on PATH
+cd /d "%~dp0"
+if defined CLSPV_BIN_DIR set PATH=%CLSPV_BIN_DIR%;%PATH%
+clspv  radix_sort.cl -o radix_sort_u32_r4.spv -DRADIX_BITS=4 --cl-std=CL1.2 --spv-version=1.3 --arch=spir64 --physical-storage-buffers
+clspv  radix_sort.cl -o radix_sort_u32_r8.spv -DRADIX_BITS=8 --cl-std=CL1.2 --spv-version=1.3 --arch=spir64 --physical-storage-buffers
+clspv  radix_sort.cl -o radix_sort_u64_r4.spv -DRADIX_KEY_TYPE=ulong -DRADIX_BITS=4 --cl-std=CL1.2 --spv-version=1.3 --arch=spir64 --physical-storage-buffers
+clspv  radix_sort.cl -o radix_sort_u64_r8.spv -DRADIX_KEY_TYPE=ulong -DRADIX_BITS=8 --cl-std=CL1.2 --spv-version=1.3 --arch=spir64 --physical-storage-buffers
+
@@ -0,0 +1,6 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis radix_sort_u32_r4.spv  -o radix_sort_u32_r4.spvasm
+%VK_SDK_PATH%\Bin\spirv-dis radix_sort_u32_r8.spv  -o radix_sort_u32_r8.spvasm
+%VK_SDK_PATH%\Bin\spirv-dis radix_sort_u64_r4.spv  -o radix_sort_u64_r4.spvasm
+%VK_SDK_PATH%\Bin\spirv-dis radix_sort_u64_r8.spv  -o radix_sort_u64_r8.spvasm
+
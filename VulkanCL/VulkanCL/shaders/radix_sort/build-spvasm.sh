@@ -0,0 +1,9 @@
+#! /bin/sh
+# VULKAN_SDK is set by the setup-env.sh of the Vulkan SDK
+cd "$(dirname "$0")" || exit 1
+if [ -n "$VULKAN_SDK" ]; then export PATH="$VULKAN_SDK/bin:$PATH"; fi
+spirv-dis radix_sort_u32_r4.spv  -o radix_sort_u32_r4.spvasm
+spirv-dis radix_sort_u32_r8.spv  -o radix_sort_u32_r8.spvasm
+spirv-dis radix_sort_u64_r4.spv  -o radix_sort_u64_r4.spvasm
+spirv-dis radix_sort_u64_r8.spv  -o radix_sort_u64_r8.spvasm
+
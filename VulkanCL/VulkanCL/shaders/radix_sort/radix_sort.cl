@@ -0,0 +1,205 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+// LSD radix sort passes. Each pass sorts the keys by the RADIX_BITS bits starting from bit `shift`:
+// (1) RadixHistogramKernel counts the digits of each block of (workgroup size * RADIX_ITEMS_PER_THREAD) keys
+//     and stores the counts digit-major, i.e. histogram[digit * blockCount + blockID];
+// (2) the host scans the whole histogram exclusively (shaders/scan/scan.cl), which yields the global output offset
+//     of each digit of each block;
+// (3) RadixScatterKernel sorts each block locally by the digit with 1-bit splits, which keeps the order stable,
+//     and writes the keys (and values) to their global positions.
+// Build with -DRADIX_KEY_TYPE=ulong for 64-bit keys. Values are always 32-bit.
+// The radix width is fixed when the module is built with -DRADIX_BITS=4 or 8, so that the digit mask and the bit loop of the local sort
+// are constants. It has to divide the key width. OpenCL C has no specialization constants of its own that clspv would expose.
+// The module must be generated with `--physical-storage-buffers`, so that the global pointer arguments are
+// passed as buffer device addresses through the push constants and the host ping-pongs the buffers without descriptor updates.
+
+#ifndef RADIX_KEY_TYPE
+#define RADIX_KEY_TYPE              uint
+#endif
+
+#ifndef RADIX_BITS
+#define RADIX_BITS                  8
+#endif
+
+#define RADIX_DIGIT_COUNT           (1U << RADIX_BITS)
+
+#define RADIX_ITEMS_PER_THREAD      4
+
+// The upper bound of the workgroup size (local_size_x_id) that the host may specialize
+#define RADIX_MAX_WORKGROUP_SIZE    256
+
+typedef RADIX_KEY_TYPE  KeyType;
+
+static inline uint GetLinearGroupID(void)
+{
+    return (uint)get_group_id(1) * (uint)get_num_groups(0) + (uint)get_group_id(0);
+}
+
+static inline uint GetDigit(KeyType key, uint shift)
+{
+    return (uint)(key >> shift) & (RADIX_DIGIT_COUNT - 1U);
+}
+
+static inline uint GetBlockCount(uint elemCount)
+{
+    let const blockSize = (uint)get_local_size(0) * RADIX_ITEMS_PER_THREAD;
+    return (elemCount + blockSize - 1U) / blockSize;
+}
+
+// Returns the exclusive prefix sum of `value` over the workgroup and stores the sum of the whole workgroup to `*pTotal`.
+static inline uint WorkGroupExclusiveScan(uint value, local uint* scratch, uint* pTotal)
+{
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+
+    scratch[localID] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint offset = 1; offset < localSize; offset <<= 1)
+    {
+        let const addend = localID >= offset ? scratch[localID - offset] : 0U;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        scratch[localID] += addend;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    let const inclusive = scratch[localID];
+    *pTotal = scratch[localSize - 1U];
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    return inclusive - value;
+}
+
+// `localHistogram` is the first argument of both kernels. Its element count is RADIX_DIGIT_COUNT, and the host finds its specialization constant
+// through the ArgumentWorkgroup reflection instruction of each kernel.
+// @param localHistogram: the specialization constant of the ArgumentWorkgroup reflection instruction
+// @param keysIn, histogram, elemCount, shift: layout(push_constant, std430) uniform
+kernel void RadixHistogramKernel(local uint* localHistogram, global const KeyType* keysIn, global uint* histogram,
+    uint elemCount, uint shift)
+{
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockID = GetLinearGroupID();
+    let const blockCount = GetBlockCount(elemCount);
+    let const blockBase = blockID * localSize * RADIX_ITEMS_PER_THREAD;
+    // Uniform for the whole workgroup
+    if (blockID >= blockCount) return;
+
+    for (uint digit = localID; digit < RADIX_DIGIT_COUNT; digit += localSize) {
+        localHistogram[digit] = 0U;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+    {
+        let const index = blockBase + i * localSize + localID;
+        if (index < elemCount) {
+            atomic_inc(&localHistogram[GetDigit(keysIn[index], shift)]);
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint digit = localID; digit < RADIX_DIGIT_COUNT; digit += localSize) {
+        histogram[digit * blockCount + blockID] = localHistogram[digit];
+    }
+}
+
+// `valuesIn` and `valuesOut` are only accessed if `hasValues` is not 0, so the key only sort may pass any address for them.
+// A null test of a physical storage buffer pointer is left out on purpose: it is not a comparison clspv is known to lower faithfully.
+// `histogramOffsets` is the exclusively scanned output of RadixHistogramKernel.
+// @param localHistogram: the specialization constant of the ArgumentWorkgroup reflection instruction
+// @param keysIn, keysOut, valuesIn, valuesOut, histogramOffsets, elemCount, shift, hasValues: layout(push_constant, std430) uniform
+kernel void RadixScatterKernel(local uint* localHistogram, global const KeyType* keysIn, global KeyType* keysOut,
+    global const uint* valuesIn, global uint* valuesOut, global const uint* histogramOffsets,
+    uint elemCount, uint shift, uint hasValues)
+{
+    local KeyType localKeys[RADIX_MAX_WORKGROUP_SIZE * RADIX_ITEMS_PER_THREAD];
+    local uint localValues[RADIX_MAX_WORKGROUP_SIZE * RADIX_ITEMS_PER_THREAD];
+    local uint scratch[RADIX_MAX_WORKGROUP_SIZE];
+
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockID = GetLinearGroupID();
+    let const blockCount = GetBlockCount(elemCount);
+    let const blockSize = localSize * RADIX_ITEMS_PER_THREAD;
+    let const blockBase = blockID * blockSize;
+    if (blockID >= blockCount) return;
+
+    let const validCount = min(elemCount - blockBase, blockSize);
+
+    // Coalesced load. The keys past the end are all ones, so that they are sorted after all the valid keys of the block.
+    for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        let const valid = tileIndex < validCount;
+        localKeys[tileIndex] = valid ? keysIn[blockBase + tileIndex] : ~(KeyType)0;
+        if (hasValues) {
+            localValues[tileIndex] = valid ? valuesIn[blockBase + tileIndex] : 0U;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // Each work item owns RADIX_ITEMS_PER_THREAD consecutive elements of the block during the local sort
+    KeyType keys[RADIX_ITEMS_PER_THREAD];
+    uint values[RADIX_ITEMS_PER_THREAD];
+    let const itemBase = localID * RADIX_ITEMS_PER_THREAD;
+
+    for (uint bit = 0; bit < RADIX_BITS; bit++)
+    {
+        uint zeroCount = 0U;
+        for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+        {
+            keys[i] = localKeys[itemBase + i];
+            values[i] = hasValues ? localValues[itemBase + i] : 0U;
+            zeroCount += ((keys[i] >> (shift + bit)) & 1U) == 0 ? 1U : 0U;
+        }
+
+        // The barriers in the scan also guarantee that all the work items have read their elements before any of them is overwritten
+        uint totalZeroCount;
+        let const zerosBefore = WorkGroupExclusiveScan(zeroCount, scratch, &totalZeroCount);
+
+        uint zeroIndex = zerosBefore;
+        for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+        {
+            let const isZero = ((keys[i] >> (shift + bit)) & 1U) == 0;
+            // The elements with a one bit before this one are (itemBase + i - zeroIndex)
+            let const position = isZero ? zeroIndex : totalZeroCount + (itemBase + i - zeroIndex);
+            localKeys[position] = keys[i];
+            if (hasValues) {
+                localValues[position] = values[i];
+            }
+            zeroIndex += isZero ? 1U : 0U;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // The block is sorted by the digit now, so the first position of each digit is where the digit changes.
+    for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        if (tileIndex >= validCount) break;
+
+        let const digit = GetDigit(localKeys[tileIndex], shift);
+        if (tileIndex == 0 || GetDigit(localKeys[tileIndex - 1U], shift) != digit) {
+            localHistogram[digit] = tileIndex;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // Consecutive work items write consecutive positions within each digit run
+    for (uint i = 0; i < RADIX_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        if (tileIndex >= validCount) break;
+
+        let const key = localKeys[tileIndex];
+        let const digit = GetDigit(key, shift);
+        let const position = histogramOffsets[digit * blockCount + blockID] + (tileIndex - localHistogram[digit]);
+        keysOut[position] = key;
+        if (hasValues) {
+            valuesOut[position] = localValues[tileIndex];
+        }
+    }
+}
@@ -0,0 +1,6 @@
+:: Set CLSPV_BIN_DIR to the directory of clspv.exe if it is not on PATH
+cd /d "%~dp0"
+if defined CLSPV_BIN_DIR set PATH=%CLSPV_BIN_DIR%;%PATH%
+clspv  scan.cl -o scan.spv --cl-std=CL1.2 --spv-version=1.3 --arch=spir64
+clspv  scan.cl -o scan_subgroup.spv -DSCAN_USE_SUBGROUPS --cl-std=CL2.0 --uniform-workgroup-size --spv-version=1.3 --arch=spir64
+
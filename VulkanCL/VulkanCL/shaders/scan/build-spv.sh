@@ -0,0 +1,7 @@
+#! /bin/sh
+# Set CLSPV_BIN_DIR to the directory of clspv if it is not on PATH
+cd "$(dirname "$0")" || exit 1
+if [ -n "$CLSPV_BIN_DIR" ]; then export PATH="$CLSPV_BIN_DIR:$PATH"; fi
+clspv  scan.cl -o scan.spv --cl-std=CL1.2 --spv-version=1.3 --arch=spir64
+clspv  scan.cl -o scan_subgroup.spv -DSCAN_USE_SUBGROUPS --cl-std=CL2.0 --uniform-workgroup-size --spv-version=1.3 --arch=spir64
+
@@ -0,0 +1,4 @@
+cd /d "%~dp0"
+%VK_SDK_PATH%\Bin\spirv-dis scan.spv  -o scan.spvasm
+%VK_SDK_PATH%\Bin\spirv-dis scan_subgroup.spv  -o scan_subgroup.spvasm
+
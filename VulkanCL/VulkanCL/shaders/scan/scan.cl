@@ -0,0 +1,263 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// Reduce-then-scan device-wide prefix sum over uint elements.
+// A block of (workgroup size * SCAN_ITEMS_PER_THREAD) elements is handled by one workgroup:
+// (1) ScanReduceKernel writes the sum of each block;
+// (2) the block sums are scanned exclusively in place, recursively with the same kernels when they span more than one block;
+// (3) ScanDownsweepKernel (or CompactScatterKernel) scans each block again and adds the offset of the block.
+// Build with -DSCAN_USE_SUBGROUPS to perform the workgroup level scan with subgroup operations.
+// That variant needs --cl-std=CL2.0, and --uniform-workgroup-size with it, since clspv otherwise supports non-uniform NDRanges
+// through push constants placed in front of the kernel arguments. The host dispatches it only with full subgroups.
+
+#ifdef SCAN_USE_SUBGROUPS
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#endif
+
+#ifndef SCAN_ITEMS_PER_THREAD
+#define SCAN_ITEMS_PER_THREAD       8
+#endif
+
+// The upper bound of the workgroup size (local_size_x_id) that the host may specialize
+#ifndef SCAN_MAX_WORKGROUP_SIZE
+#define SCAN_MAX_WORKGROUP_SIZE     256
+#endif
+
+// Scan the inclusive prefix sum instead of the exclusive one
+#define SCAN_FLAG_INCLUSIVE         1U
+// Scan (src[i] >= threshold ? 1 : 0) instead of src[i]
+#define SCAN_FLAG_PREDICATE         2U
+// The whole input fits in one block so that there are no block offsets to add
+#define SCAN_FLAG_NO_BLOCK_OFFSETS  4U
+
+// Large inputs need more workgroups than maxComputeWorkGroupCount[0], so the host spreads them over the Y dimension as well.
+static inline uint GetLinearGroupID(void)
+{
+    return (uint)get_group_id(1) * (uint)get_num_groups(0) + (uint)get_group_id(0);
+}
+
+static inline uint LoadValue(global const uint* src, uint index, uint elemCount, uint flags, uint threshold)
+{
+    if (index >= elemCount) return 0U;
+
+    let const value = src[index];
+    if ((flags & SCAN_FLAG_PREDICATE) != 0) {
+        return value >= threshold ? 1U : 0U;
+    }
+    return value;
+}
+
+// Returns the exclusive prefix sum of `value` over the workgroup and stores the sum of the whole workgroup to `*pTotal`.
+// `scratch` must hold at least one element per work item.
+static inline uint WorkGroupExclusiveScan(uint value, local uint* scratch, uint* pTotal)
+{
+#ifdef SCAN_USE_SUBGROUPS
+    // The host guarantees that the subgroup count does not exceed the subgroup size,
+    // so that the first subgroup is able to scan the totals of all the subgroups.
+    let const subgroupID = (uint)get_sub_group_id();
+    let const subgroupLocalID = (uint)get_sub_group_local_id();
+    let const subgroupCount = (uint)get_num_sub_groups();
+
+    let const inclusive = sub_group_scan_inclusive_add(value);
+    if (subgroupLocalID == (uint)get_sub_group_size() - 1U) {
+        scratch[subgroupID] = inclusive;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (subgroupID == 0)
+    {
+        let const subgroupTotal = subgroupLocalID < subgroupCount ? scratch[subgroupLocalID] : 0U;
+        let const subgroupPrefix = sub_group_scan_inclusive_add(subgroupTotal);
+        if (subgroupLocalID < subgroupCount) {
+            scratch[subgroupLocalID] = subgroupPrefix;
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    let const result = inclusive - value + (subgroupID > 0 ? scratch[subgroupID - 1U] : 0U);
+    *pTotal = scratch[subgroupCount - 1U];
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    return result;
+#else
+    // Hillis-Steele scan in local memory
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+
+    scratch[localID] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint offset = 1; offset < localSize; offset <<= 1)
+    {
+        let const addend = localID >= offset ? scratch[localID - offset] : 0U;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        scratch[localID] += addend;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    let const inclusive = scratch[localID];
+    *pTotal = scratch[localSize - 1U];
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    return inclusive - value;
+#endif // SCAN_USE_SUBGROUPS
+}
+
+// Loads the block beginning at `blockBase` into `tile` and replaces each element with its exclusive prefix sum inside the block.
+// The block is read with coalesced accesses, then each work item scans SCAN_ITEMS_PER_THREAD consecutive elements.
+static inline void BlockExclusiveScan(global const uint* src, local uint* tile, local uint* scratch,
+    uint blockBase, uint elemCount, uint flags, uint threshold)
+{
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        tile[tileIndex] = LoadValue(src, blockBase + tileIndex, elemCount, flags, threshold);
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint threadSum = 0U;
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = localID * SCAN_ITEMS_PER_THREAD + i;
+        let const value = tile[tileIndex];
+        tile[tileIndex] = threadSum;
+        threadSum += value;
+    }
+
+    uint blockTotal;
+    let const threadPrefix = WorkGroupExclusiveScan(threadSum, scratch, &blockTotal);
+
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++) {
+        tile[localID * SCAN_ITEMS_PER_THREAD + i] += threadPrefix;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+// All the scan kernels share the same push constants so that they can share the same pipeline layout shape.
+// @param elemCount, flags, threshold: layout(push_constant, std430) uniform
+
+// @param src: layout(set = 0, binding = 0, std430) buffer
+// @param blockSums: layout(set = 0, binding = 1, std430) buffer
+kernel void ScanReduceKernel(global const uint* src, global uint* blockSums, uint elemCount, uint flags, uint threshold)
+{
+    local uint scratch[SCAN_MAX_WORKGROUP_SIZE];
+
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockID = GetLinearGroupID();
+    let const blockBase = blockID * localSize * SCAN_ITEMS_PER_THREAD;
+    // Uniform for the whole workgroup
+    if (blockBase >= elemCount) return;
+
+    uint threadSum = 0U;
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++) {
+        threadSum += LoadValue(src, blockBase + i * localSize + localID, elemCount, flags, threshold);
+    }
+
+    uint blockTotal;
+    WorkGroupExclusiveScan(threadSum, scratch, &blockTotal);
+
+    if (localID == 0) {
+        blockSums[blockID] = blockTotal;
+    }
+}
+
+// `src` and `dst` may be the same buffer.
+// @param src: layout(set = 0, binding = 0, std430) buffer
+// @param dst: layout(set = 0, binding = 1, std430) buffer
+// @param blockOffsets: layout(set = 0, binding = 2, std430) buffer -- not accessed with SCAN_FLAG_NO_BLOCK_OFFSETS
+kernel void ScanDownsweepKernel(global const uint* src, global uint* dst, global const uint* blockOffsets, uint elemCount, uint flags, uint threshold)
+{
+    local uint tile[SCAN_MAX_WORKGROUP_SIZE * SCAN_ITEMS_PER_THREAD];
+    local uint scratch[SCAN_MAX_WORKGROUP_SIZE];
+
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockID = GetLinearGroupID();
+    let const blockBase = blockID * localSize * SCAN_ITEMS_PER_THREAD;
+    if (blockBase >= elemCount) return;
+
+    BlockExclusiveScan(src, tile, scratch, blockBase, elemCount, flags, threshold);
+
+    let const blockOffset = (flags & SCAN_FLAG_NO_BLOCK_OFFSETS) != 0 ? 0U : blockOffsets[blockID];
+    let const inclusive = (flags & SCAN_FLAG_INCLUSIVE) != 0;
+
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        let const index = blockBase + tileIndex;
+        if (index >= elemCount) break;
+
+        uint result = tile[tileIndex] + blockOffset;
+        if (inclusive) {
+            result += LoadValue(src, index, elemCount, flags, threshold);
+        }
+        dst[index] = result;
+    }
+}
+
+// Writes all the elements that are not less than `threshold` to `dst` contiguously, keeping their order,
+// and the number of them to pCount[0].
+// @param src: layout(set = 0, binding = 0, std430) buffer
+// @param dst: layout(set = 0, binding = 1, std430) buffer
+// @param blockOffsets: layout(set = 0, binding = 2, std430) buffer -- not accessed with SCAN_FLAG_NO_BLOCK_OFFSETS
+// @param pCount: layout(set = 0, binding = 3, std430) buffer
+kernel void CompactScatterKernel(global const uint* src, global uint* dst, global const uint* blockOffsets, global uint* pCount,
+    uint elemCount, uint flags, uint threshold)
+{
+    local uint tile[SCAN_MAX_WORKGROUP_SIZE * SCAN_ITEMS_PER_THREAD];
+    local uint scratch[SCAN_MAX_WORKGROUP_SIZE];
+
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockID = GetLinearGroupID();
+    let const blockBase = blockID * localSize * SCAN_ITEMS_PER_THREAD;
+    if (blockBase >= elemCount) return;
+
+    BlockExclusiveScan(src, tile, scratch, blockBase, elemCount, flags | SCAN_FLAG_PREDICATE, threshold);
+
+    let const blockOffset = (flags & SCAN_FLAG_NO_BLOCK_OFFSETS) != 0 ? 0U : blockOffsets[blockID];
+
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++)
+    {
+        let const tileIndex = i * localSize + localID;
+        let const index = blockBase + tileIndex;
+        if (index >= elemCount) break;
+
+        let const value = src[index];
+        let const selected = value >= threshold;
+        let const position = tile[tileIndex] + blockOffset;
+        if (selected) {
+            dst[position] = value;
+        }
+        if (index == elemCount - 1U) {
+            pCount[0] = position + (selected ? 1U : 0U);
+        }
+    }
+}
+
+// Generates the deterministic test input dst[i] = (i * 2654435761) >> 24 that is used by the benchmarks.
+// @param dst: layout(set = 0, binding = 0, std430) buffer
+kernel void ScanFillPatternKernel(global uint* dst, uint elemCount, uint flags, uint threshold)
+{
+    let const localID = (uint)get_local_id(0);
+    let const localSize = (uint)get_local_size(0);
+    let const blockBase = GetLinearGroupID() * localSize * SCAN_ITEMS_PER_THREAD;
+
+    for (uint i = 0; i < SCAN_ITEMS_PER_THREAD; i++)
+    {
+        let const index = blockBase + i * localSize + localID;
+        if (index < elemCount) {
+            dst[index] = (index * 2654435761U) >> 24;
+        }
+    }
+}
+
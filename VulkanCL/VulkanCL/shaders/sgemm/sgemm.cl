@@ -0,0 +1,134 @@
+#ifndef let
+#define let __auto_type
+#endif
+
+#ifndef NULL
+#define NULL    (void*)0
+#endif
+
+// Register blocking factors -- each work item computes SGEMM_WPT_M x SGEMM_WPT_N elements of C.
+// They size private arrays so that they have to be known at compile time.
+#ifndef SGEMM_WPT_M
+#define SGEMM_WPT_M     4
+#endif
+
+#ifndef SGEMM_WPT_N
+#define SGEMM_WPT_N     4
+#endif
+
+// The depth of a tile along the K dimension
+#ifndef SGEMM_TILE_K
+#define SGEMM_TILE_K    16
+#endif
+
+// All the matrices are row-major: A is M x K, B is K x N and C is M x N.
+// C = alpha * A * B + beta * C
+
+// One work item per element of C. Dimension 0 walks along the columns (N) and dimension 1 along the rows (M).
+// @param A: layout(set = 0, binding = 0, std430) buffer
+// @param B: layout(set = 0, binding = 1, std430) buffer
+// @param C: layout(set = 0, binding = 2, std430) buffer
+// @param M, N, K, alpha, beta: layout(push_constant, std430) uniform
+kernel void SgemmNaiveKernel(global const float* restrict A, global const float* restrict B, global float* restrict C,
+    uint M, uint N, uint K, float alpha, float beta)
+{
+    let const col = (uint)get_global_id(0);
+    let const row = (uint)get_global_id(1);
+    if (row >= M || col >= N) return;
+
+    float acc = 0.0f;
+    for (uint k = 0; k < K; k++) {
+        acc += A[row * K + k] * B[k * N + col];
+    }
+
+    let const index = row * N + col;
+    C[index] = beta == 0.0f ? alpha * acc : alpha * acc + beta * C[index];
+}
+
+// The workgroup size (local_size_x_id = 0, local_size_y_id = 1) is specialized by the host, which determines the tile size:
+// a workgroup of (RTSN, RTSM) work items computes a tile of (RTSM * SGEMM_WPT_M) x (RTSN * SGEMM_WPT_N) elements of C.
+// @param A: layout(set = 0, binding = 0, std430) buffer
+// @param B: layout(set = 0, binding = 1, std430) buffer
+// @param C: layout(set = 0, binding = 2, std430) buffer
+// @param tileA: SGEMM_TILE_K x TSM floats, stored K-major -- layout(constant_id = 3) const uint
+// @param tileB: SGEMM_TILE_K x TSN floats, stored K-major -- layout(constant_id = 4) const uint
+// @param M, N, K, alpha, beta: layout(push_constant, std430) uniform
+kernel void SgemmTiledKernel(global const float* restrict A, global const float* restrict B, global float* restrict C,
+    local float* restrict tileA, local float* restrict tileB,
+    uint M, uint N, uint K, float alpha, float beta)
+{
+    let const localCol = (uint)get_local_id(0);
+    let const localRow = (uint)get_local_id(1);
+    let const RTSN = (uint)get_local_size(0);
+    let const RTSM = (uint)get_local_size(1);
+    let const TSN = RTSN * SGEMM_WPT_N;
+    let const TSM = RTSM * SGEMM_WPT_M;
+    let const localSize = RTSN * RTSM;
+    let const localIndex = localRow * RTSN + localCol;
+
+    let const tileRow = (uint)get_group_id(1) * TSM;
+    let const tileCol = (uint)get_group_id(0) * TSN;
+
+    float acc[SGEMM_WPT_M][SGEMM_WPT_N];
+    for (uint r = 0; r < SGEMM_WPT_M; r++)
+    {
+        for (uint c = 0; c < SGEMM_WPT_N; c++) {
+            acc[r][c] = 0.0f;
+        }
+    }
+
+    for (uint k0 = 0; k0 < K; k0 += SGEMM_TILE_K)
+    {
+        // Cooperatively load the A tile. Adjacent work items read adjacent elements of a row of A.
+        for (uint i = localIndex; i < SGEMM_TILE_K * TSM; i += localSize)
+        {
+            let const kk = i % SGEMM_TILE_K;
+            let const m = i / SGEMM_TILE_K;
+            let const globalRow = tileRow + m;
+            let const globalK = k0 + kk;
+            tileA[kk * TSM + m] = globalRow < M && globalK < K ? A[globalRow * K + globalK] : 0.0f;
+        }
+        // Cooperatively load the B tile. Adjacent work items read adjacent elements of a row of B.
+        for (uint i = localIndex; i < SGEMM_TILE_K * TSN; i += localSize)
+        {
+            let const n = i % TSN;
+            let const kk = i / TSN;
+            let const globalCol = tileCol + n;
+            let const globalK = k0 + kk;
+            tileB[kk * TSN + n] = globalCol < N && globalK < K ? B[globalK * N + globalCol] : 0.0f;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (uint kk = 0; kk < SGEMM_TILE_K; kk++)
+        {
+            float bReg[SGEMM_WPT_N];
+            for (uint c = 0; c < SGEMM_WPT_N; c++) {
+                bReg[c] = tileB[kk * TSN + localCol + c * RTSN];
+            }
+            for (uint r = 0; r < SGEMM_WPT_M; r++)
+            {
+                let const aReg = tileA[kk * TSM + localRow + r * RTSM];
+                for (uint c = 0; c < SGEMM_WPT_N; c++) {
+                    acc[r][c] = mad(aReg, bReg[c], acc[r][c]);
+                }
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    for (uint r = 0; r < SGEMM_WPT_M; r++)
+    {
+        let const globalRow = tileRow + localRow + r * RTSM;
+        if (globalRow >= M) break;
+
+        for (uint c = 0; c < SGEMM_WPT_N; c++)
+        {
+            let const globalCol = tileCol + localCol + c * RTSN;
+            if (globalCol >= N) break;
+
+            let const index = globalRow * N + globalCol;
+            C[index] = beta == 0.0f ? alpha * acc[r][c] : alpha * acc[r][c] + beta * C[index];
+        }
+    }
+}
+
@@ -1,6 +1,7 @@
 #! /bin/sh
-# Configure your own VulkanSDK path here --
-export PATH=/Users/zenny-chen/VulkanSDK/1.3.243.0/macOS/bin:$PATH
+# VULKAN_SDK is set by the setup-env.sh of the Vulkan SDK
+cd "$(dirname "$0")" || exit 1
+if [ -n "$VULKAN_SDK" ]; then export PATH="$VULKAN_SDK/bin:$PATH"; fi
 spirv-dis simple.spv  -o simple.spvasm
 spirv-cross  --vulkan-semantics  --output simple.comp.glsl  simple.spv
 
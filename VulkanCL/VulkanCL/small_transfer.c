@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "small_transfer.h"
+
+enum
+{
+    SMALL_TRANSFER_TEST_ROUND_COUNT = 200
+};
+
+struct ResultSlab
+{
+    VkDevice device;
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    uint8_t* pHostData;
+    struct HostLock* pLock;
+    uint32_t blockCount;
+    // Bit i is set while block i belongs to an acquired range
+    uint64_t usedBlockMask;
+};
+
+static void RecordMemoryBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+    VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = srcAccessMask,
+        .dstAccessMask = dstAccessMask
+    };
+    vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 1, &memoryBarrier, 0, NULL, 0, NULL);
+}
+
+bool RecordSmallBufferUpload(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size)
+{
+    if (!IsSmallTransferSize(size) || (dstOffset & 3) != 0) {
+        return false;
+    }
+    vkCmdUpdateBuffer(commandBuffer, dstBuffer, dstOffset, size, pData);
+    return true;
+}
+
+// MARK: Result slab
+
+VkResult CreateResultSlab(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkDeviceSize size, struct ResultSlab** ppSlab)
+{
+    const VkDeviceSize blockCount = (size + RESULT_SLAB_BLOCK_SIZE - 1) / RESULT_SLAB_BLOCK_SIZE;
+    if (blockCount == 0 || blockCount > RESULT_SLAB_MAX_BLOCK_COUNT)
+    {
+        fprintf(stderr, "A result slab of %llu bytes is not supported!\n", (unsigned long long)size);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct ResultSlab* pSlab = calloc(1, sizeof(*pSlab));
+    if (pSlab == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pSlab->device = device;
+    pSlab->blockCount = (uint32_t)blockCount;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        pSlab->pLock = HostLockCreate();
+        if (pSlab->pLock == NULL)
+        {
+            result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            break;
+        }
+
+        // The host reads the results, so cached memory is preferred
+        VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        if (FindMemoryTypeIndex(pMemoryProperties, UINT32_MAX, memoryFlags | VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != UINT32_MAX) {
+            memoryFlags |= VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        }
+
+        result = CreateBufferWithMemory(device, pMemoryProperties, blockCount * RESULT_SLAB_BLOCK_SIZE,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, memoryFlags, queueFamilyIndex, &pSlab->buffer, &pSlab->memory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        void* pHostData = NULL;
+        result = vkMapMemory(device, pSlab->memory, 0, VK_WHOLE_SIZE, 0, &pHostData);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        pSlab->pHostData = pHostData;
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroyResultSlab(pSlab);
+        return result;
+    }
+
+    *ppSlab = pSlab;
+    return VK_SUCCESS;
+}
+
+void DestroyResultSlab(struct ResultSlab* pSlab)
+{
+    if (pSlab == NULL) return;
+
+    // Freeing the memory unmaps it implicitly
+    DestroyBufferWithMemory(pSlab->device, pSlab->buffer, pSlab->memory);
+    if (pSlab->pLock != NULL) {
+        HostLockDestroy(pSlab->pLock);
+    }
+    free(pSlab);
+}
+
+VkBuffer GetResultSlabBuffer(const struct ResultSlab* pSlab)
+{
+    return pSlab->buffer;
+}
+
+VkResult AcquireResultSlabRange(struct ResultSlab* pSlab, VkDeviceSize size, struct ResultSlabRange* pRange)
+{
+    memset(pRange, 0, sizeof(*pRange));
+
+    const VkDeviceSize neededBlockCount = (size + RESULT_SLAB_BLOCK_SIZE - 1) / RESULT_SLAB_BLOCK_SIZE;
+    if (neededBlockCount == 0 || neededBlockCount > pSlab->blockCount) {
+        return VK_NOT_READY;
+    }
+    const uint64_t rangeMask = neededBlockCount == 64 ? UINT64_MAX : (1ULL << neededBlockCount) - 1ULL;
+
+    VkResult result = VK_NOT_READY;
+    HostLockAcquire(pSlab->pLock);
+    // First fit
+    for (uint32_t firstBlock = 0; firstBlock + neededBlockCount <= pSlab->blockCount; firstBlock++)
+    {
+        if ((pSlab->usedBlockMask & (rangeMask << firstBlock)) == 0)
+        {
+            pSlab->usedBlockMask |= rangeMask << firstBlock;
+            pRange->offset = (VkDeviceSize)firstBlock * RESULT_SLAB_BLOCK_SIZE;
+            pRange->size = size;
+            pRange->pHostData = pSlab->pHostData + pRange->offset;
+            result = VK_SUCCESS;
+            break;
+        }
+    }
+    HostLockRelease(pSlab->pLock);
+
+    return result;
+}
+
+void ReleaseResultSlabRange(struct ResultSlab* pSlab, struct ResultSlabRange* pRange)
+{
+    if (pRange->pHostData == NULL) return;
+
+    const VkDeviceSize blockCount = (pRange->size + RESULT_SLAB_BLOCK_SIZE - 1) / RESULT_SLAB_BLOCK_SIZE;
+    const uint64_t rangeMask = blockCount == 64 ? UINT64_MAX : (1ULL << blockCount) - 1ULL;
+    const uint32_t firstBlock = (uint32_t)(pRange->offset / RESULT_SLAB_BLOCK_SIZE);
+
+    HostLockAcquire(pSlab->pLock);
+    pSlab->usedBlockMask &= ~(rangeMask << firstBlock);
+    HostLockRelease(pSlab->pLock);
+
+    memset(pRange, 0, sizeof(*pRange));
+}
+
+void RecordResultSlabReadback(VkCommandBuffer commandBuffer, const struct ResultSlab* pSlab, const struct ResultSlabRange* pRange,
+    VkBuffer srcBuffer, VkDeviceSize srcOffset)
+{
+    RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+    const VkBufferCopy copyRegion = {
+        .srcOffset = srcOffset,
+        .dstOffset = pRange->offset,
+        .size = pRange->size
+    };
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, pSlab->buffer, 1, &copyRegion);
+
+    RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+// MARK: Test
+
+// A round trip through a host visible staging buffer allocated for the job, as the compute tests used to do
+static VkResult RunStagingRoundTrip(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkBuffer deviceBuffer, const int* src, uint32_t elemCount, int startValue)
+{
+    const VkDeviceSize size = elemCount * sizeof(int);
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    VkResult result;
+
+    do
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, queueFamilyIndex, &stagingBuffer, &stagingMemory);
+        if (result != VK_SUCCESS) break;
+
+        void* hostBuffer = NULL;
+        result = vkMapMemory(device, stagingMemory, 0, size, 0, &hostBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        memcpy(hostBuffer, src, size);
+        vkUnmapMemory(device, stagingMemory);
+
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const VkBufferCopy copyRegion = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = size
+        };
+        vkCmdCopyBuffer(commandBuffer, stagingBuffer, deviceBuffer, 1, &copyRegion);
+        RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+        vkCmdCopyBuffer(commandBuffer, deviceBuffer, stagingBuffer, 1, &copyRegion);
+        RecordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        result = vkMapMemory(device, stagingMemory, 0, size, 0, &hostBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkMapMemory failed: %d\n", result);
+            break;
+        }
+        const size_t errIndex = HostParallelFindMismatch(hostBuffer, elemCount, startValue, 1);
+        if (errIndex != SIZE_MAX)
+        {
+            fprintf(stderr, "Staging result error @ %zu: %d\n", errIndex, ((const int*)hostBuffer)[errIndex]);
+            result = VK_ERROR_UNKNOWN;
+        }
+        vkUnmapMemory(device, stagingMemory);
+    } while (false);
+
+    DestroyBufferWithMemory(device, stagingBuffer, stagingMemory);
+    return result;
+}
+
+static VkResult RunSmallRoundTrip(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkBuffer deviceBuffer,
+    struct ResultSlab* pSlab, const int* src, uint32_t elemCount, int startValue)
+{
+    const VkDeviceSize size = elemCount * sizeof(int);
+    struct ResultSlabRange range;
+    VkResult result = AcquireResultSlabRange(pSlab, size, &range);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "AcquireResultSlabRange failed: %d\n", result);
+        return result;
+    }
+
+    do
+    {
+        result = BeginOneTimeCommandBuffer(device, commandPool, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        RecordSmallBufferUpload(commandBuffer, deviceBuffer, 0, src, size);
+        RecordResultSlabReadback(commandBuffer, pSlab, &range, deviceBuffer, 0);
+
+        result = EndAndSubmitCommandBuffer(device, queue, commandBuffer);
+        if (result != VK_SUCCESS) break;
+
+        const size_t errIndex = HostParallelFindMismatch(range.pHostData, elemCount, startValue, 1);
+        if (errIndex != SIZE_MAX)
+        {
+            fprintf(stderr, "Small transfer result error @ %zu: %d\n", errIndex, ((const int*)range.pHostData)[errIndex]);
+            result = VK_ERROR_UNKNOWN;
+        }
+    } while (false);
+
+    ReleaseResultSlabRange(pSlab, &range);
+    return result;
+}
+
+void SmallTransferTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    struct ResultSlab* pSlab)
+{
+    puts("\n================ Begin small transfer test ================\n");
+
+    VkBuffer deviceBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory deviceMemory = VK_NULL_HANDLE;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    int* src = NULL;
+
+    do
+    {
+        if (pSlab == NULL)
+        {
+            fprintf(stderr, "No result slab!\n");
+            break;
+        }
+
+        VkResult result = CreateBufferWithMemory(specDevice, pMemoryProperties, SMALL_TRANSFER_MAX_UPDATE_SIZE,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, specQueueFamilyIndex, &deviceBuffer, &deviceMemory);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateBufferWithMemory failed!\n");
+            break;
+        }
+
+        result = InitializeCommandBuffer(specQueueFamilyIndex, specDevice, &commandPool, &commandBuffer, 1);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "InitializeCommandBuffer failed!\n");
+            break;
+        }
+
+        src = malloc(SMALL_TRANSFER_MAX_UPDATE_SIZE);
+        if (src == NULL)
+        {
+            fprintf(stderr, "Lack of system memory!\n");
+            break;
+        }
+
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        const uint32_t sizes[] = { 1024, 32 * 1024, SMALL_TRANSFER_MAX_UPDATE_SIZE };
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]) && result == VK_SUCCESS; i++)
+        {
+            const uint32_t elemCount = sizes[i] / sizeof(int);
+
+            uint64_t stagingTime = 0;
+            uint64_t smallTime = 0;
+            for (int round = 0; round < SMALL_TRANSFER_TEST_ROUND_COUNT; round++)
+            {
+                HostParallelFillSequence(src, elemCount, round);
+
+                uint64_t beginTime = HostGetTimeNanoseconds();
+                result = RunStagingRoundTrip(specDevice, pMemoryProperties, specQueueFamilyIndex, queue, commandPool, commandBuffer,
+                    deviceBuffer, src, elemCount, round);
+                stagingTime += HostGetTimeNanoseconds() - beginTime;
+                if (result != VK_SUCCESS) break;
+
+                beginTime = HostGetTimeNanoseconds();
+                result = RunSmallRoundTrip(specDevice, queue, commandPool, commandBuffer, deviceBuffer, pSlab, src, elemCount, round);
+                smallTime += HostGetTimeNanoseconds() - beginTime;
+                if (result != VK_SUCCESS) break;
+            }
+            if (result != VK_SUCCESS) break;
+
+            printf("%6u bytes round trip -- staging buffer per job: %8.2f us, vkCmdUpdateBuffer + result slab: %8.2f us\n", sizes[i],
+                (double)stagingTime / (1000.0 * SMALL_TRANSFER_TEST_ROUND_COUNT), (double)smallTime / (1000.0 * SMALL_TRANSFER_TEST_ROUND_COUNT));
+        }
+    } while (false);
+
+    free(src);
+    if (commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(specDevice, commandPool, 1, &commandBuffer);
+        vkDestroyCommandPool(specDevice, commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+    DestroyBufferWithMemory(specDevice, deviceBuffer, deviceMemory);
+
+    puts("\n================ Complete small transfer test ================\n");
+}
@@ -0,0 +1,74 @@
+#ifndef SMALL_TRANSFER_H
+#define SMALL_TRANSFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Small transfers without a staging buffer of their own.
+// An upload of at most SMALL_TRANSFER_MAX_UPDATE_SIZE bytes is recorded inline in the command buffer by vkCmdUpdateBuffer,
+// and a small result is copied into a range of a result slab, a host visible buffer that stays mapped for its whole lifetime,
+// so a small job neither allocates device memory nor maps it.
+// The kernel arguments of clspv are storage buffers, and only their POD arguments are in push constants,
+// so the buffer contents of a kernel go through vkCmdUpdateBuffer rather than push constants.
+
+enum
+{
+    // The limit of vkCmdUpdateBuffer
+    SMALL_TRANSFER_MAX_UPDATE_SIZE = 65536,
+
+    // The granularity of the result slab ranges
+    RESULT_SLAB_BLOCK_SIZE = 4096,
+    RESULT_SLAB_MAX_BLOCK_COUNT = 64
+};
+
+// vkCmdUpdateBuffer requires the size to be a multiple of 4.
+static inline bool IsSmallTransferSize(VkDeviceSize size)
+{
+    return size > 0 && size <= SMALL_TRANSFER_MAX_UPDATE_SIZE && (size & 3) == 0;
+}
+
+// Records vkCmdUpdateBuffer of `size` bytes from `pData`, which are copied into the command buffer at once.
+// `dstBuffer` must be created with VK_BUFFER_USAGE_TRANSFER_DST_BIT, and `dstOffset` must be a multiple of 4.
+// Returns false without recording anything if the size is not a small transfer size.
+// The caller records RecordTransferToComputeBarrier before the kernels read the data.
+extern bool RecordSmallBufferUpload(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size);
+
+struct ResultSlab;
+
+struct ResultSlabRange
+{
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    // The mapped address of `offset`, NULL for a range that has not been acquired
+    void* pHostData;
+};
+
+// @param size: rounded up to RESULT_SLAB_BLOCK_SIZE, and no more than RESULT_SLAB_BLOCK_SIZE * RESULT_SLAB_MAX_BLOCK_COUNT
+extern VkResult CreateResultSlab(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    VkDeviceSize size, struct ResultSlab** ppSlab);
+// The device must not use any range of the slab.
+extern void DestroyResultSlab(struct ResultSlab* pSlab);
+
+// The slab buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+// so that a kernel may write a result into its range directly as well
+extern VkBuffer GetResultSlabBuffer(const struct ResultSlab* pSlab);
+
+// Returns VK_NOT_READY if no free range is large enough, in which case the caller takes the staging path.
+// It may be called from several threads concurrently.
+extern VkResult AcquireResultSlabRange(struct ResultSlab* pSlab, VkDeviceSize size, struct ResultSlabRange* pRange);
+// The device must have completed the readback into the range. Releasing a range that has not been acquired does nothing.
+extern void ReleaseResultSlabRange(struct ResultSlab* pSlab, struct ResultSlabRange* pRange);
+
+// Makes the preceding shader or transfer writes of `srcBuffer` available, copies `pRange->size` bytes from `srcOffset` into the range,
+// and makes them visible to the host reads through `pRange->pHostData` after the fence wait.
+extern void RecordResultSlabReadback(VkCommandBuffer commandBuffer, const struct ResultSlab* pSlab, const struct ResultSlabRange* pRange,
+    VkBuffer srcBuffer, VkDeviceSize srcOffset);
+
+// Compares round trips of 1 KB, 32 KB and 64 KB through a staging buffer allocated per job against vkCmdUpdateBuffer and `pSlab`.
+extern void SmallTransferTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    struct ResultSlab* pSlab);
+
+#endif // !SMALL_TRANSFER_H
@@ -0,0 +1,725 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <vulkan/vulkan.h>
+
+#include "host_parallel.h"
+#include "vk_common.h"
+#include "host_allocator.h"
+#include "elementwise_fusion.h"
+#include "object_pool.h"
+#include "submission_queue.h"
+
+enum
+{
+    // How long the idle submitter parks at a time
+    SUBMISSION_QUEUE_IDLE_TIMEOUT_NANOSECONDS = 1000000000,
+
+    SUBMISSION_TEST_ELEM_COUNT = 4096,
+    // The jobs each thread keeps in flight, each on a command buffer and a destination buffer of its own
+    SUBMISSION_TEST_SLOT_COUNT = 4,
+    SUBMISSION_TEST_JOB_COUNT = 2048,
+    SUBMISSION_TEST_MAX_THREAD_COUNT = 8
+};
+
+struct SubmissionBatch
+{
+    VkFence fence;
+    uint32_t jobCount;
+    struct SubmissionJob* jobs[SUBMISSION_QUEUE_MAX_BATCH_SIZE];
+    VkCommandBuffer commandBuffers[SUBMISSION_QUEUE_MAX_BATCH_SIZE];
+};
+
+struct SubmissionQueue
+{
+    VkDevice device;
+    VkQueue queue;
+    uint32_t maxBatchSize;
+    struct JobQueue* pJobQueue;
+    // Pushed by DestroySubmissionQueue behind the last job
+    struct JobQueueNode stopNode;
+    struct HostThread* pThread;
+    // The shared fence pool, which the fences of the batches come from
+    struct FencePool* pFencePool;
+
+    // Only accessed by the submitter thread: the ring of the batches in flight, from the oldest one
+    struct SubmissionBatch batches[SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT];
+    uint32_t firstBatchIndex;
+    uint32_t inFlightBatchCount;
+
+    // Woken once per retired batch, for the threads waiting for any of its jobs
+    struct HostLock* pCompletionLock;
+
+    struct SubmissionQueueStats stats;
+};
+
+// MARK: Submitter
+
+static void CompleteSubmissionJobs(struct SubmissionQueue* pQueue, struct SubmissionJob* const jobs[], uint32_t jobCount, VkResult result)
+{
+    const uint64_t completeTime = HostGetTimeNanoseconds();
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        jobs[i]->completeTime = completeTime;
+        jobs[i]->result = result;
+        // The job belongs to its thread again from here on
+        HostAtomicStoreUInt32(&jobs[i]->completed, 1);
+    }
+
+    // A waiter checks the flag under the lock before it sleeps, so it cannot miss this broadcast
+    HostLockAcquire(pQueue->pCompletionLock);
+    HostLockWakeAll(pQueue->pCompletionLock);
+    HostLockRelease(pQueue->pCompletionLock);
+}
+
+static void RetireOldestSubmissionBatch(struct SubmissionQueue* pQueue)
+{
+    struct SubmissionBatch* const pBatch = &pQueue->batches[pQueue->firstBatchIndex];
+    VkResult result = vkWaitForFences(pQueue->device, 1, &pBatch->fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+        ReplacePooledFence(pQueue->pFencePool, &pBatch->fence);
+    }
+    else {
+        vkResetFences(pQueue->device, 1, &pBatch->fence);
+    }
+
+    CompleteSubmissionJobs(pQueue, pBatch->jobs, pBatch->jobCount, result);
+    pQueue->firstBatchIndex = (pQueue->firstBatchIndex + 1) % SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT;
+    pQueue->inFlightBatchCount--;
+}
+
+// Retires the batches the device has already finished, without blocking
+static void RetireCompletedSubmissionBatches(struct SubmissionQueue* pQueue)
+{
+    while (pQueue->inFlightBatchCount > 0 &&
+        vkGetFenceStatus(pQueue->device, pQueue->batches[pQueue->firstBatchIndex].fence) == VK_SUCCESS) {
+        RetireOldestSubmissionBatch(pQueue);
+    }
+}
+
+static void SubmitSubmissionBatch(struct SubmissionQueue* pQueue, struct SubmissionJob* const jobs[], uint32_t jobCount)
+{
+    if (pQueue->inFlightBatchCount == SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT)
+    {
+        pQueue->stats.fullRingWaitCount++;
+        RetireOldestSubmissionBatch(pQueue);
+    }
+
+    struct SubmissionBatch* const pBatch =
+        &pQueue->batches[(pQueue->firstBatchIndex + pQueue->inFlightBatchCount) % SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT];
+    const uint64_t submitTime = HostGetTimeNanoseconds();
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        jobs[i]->submitTime = submitTime;
+        pBatch->jobs[i] = jobs[i];
+        pBatch->commandBuffers[i] = jobs[i]->commandBuffer;
+    }
+    pBatch->jobCount = jobCount;
+
+    // A failed wait may have left the batch without a fence
+    if (pBatch->fence == VK_NULL_HANDLE)
+    {
+        const VkResult result = AcquirePooledFence(pQueue->pFencePool, &pBatch->fence);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
+            CompleteSubmissionJobs(pQueue, jobs, jobCount, result);
+            return;
+        }
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = jobCount,
+        .pCommandBuffers = pBatch->commandBuffers,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    const VkResult result = vkQueueSubmit(pQueue->queue, 1, &submitInfo, pBatch->fence);
+    if (result != VK_SUCCESS)
+    {
+        // Nothing has been submitted, and the fence will not be signaled
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+        CompleteSubmissionJobs(pQueue, jobs, jobCount, result);
+        return;
+    }
+
+    pQueue->inFlightBatchCount++;
+    pQueue->stats.submitCount++;
+    pQueue->stats.jobCount += jobCount;
+    if (jobCount > pQueue->stats.maxBatchJobCount) {
+        pQueue->stats.maxBatchJobCount = jobCount;
+    }
+}
+
+static void SubmitterLoop(void* context)
+{
+    struct SubmissionQueue* pQueue = context;
+    struct SubmissionJob* jobs[SUBMISSION_QUEUE_MAX_BATCH_SIZE];
+    bool stopping = false;
+
+    while (!stopping || pQueue->inFlightBatchCount > 0)
+    {
+        if (stopping)
+        {
+            RetireOldestSubmissionBatch(pQueue);
+            continue;
+        }
+
+        // Parks only when there is nothing to retire either
+        struct JobQueueNode* pNode = pQueue->inFlightBatchCount == 0 ?
+            WaitJobQueueNode(pQueue->pJobQueue, SUBMISSION_QUEUE_IDLE_TIMEOUT_NANOSECONDS) : PopJobQueueNode(pQueue->pJobQueue);
+        uint32_t jobCount = 0;
+        while (pNode != NULL)
+        {
+            if (pNode == &pQueue->stopNode)
+            {
+                stopping = true;
+                break;
+            }
+            jobs[jobCount++] = (struct SubmissionJob*)pNode;
+            if (jobCount == pQueue->maxBatchSize) break;
+            pNode = PopJobQueueNode(pQueue->pJobQueue);
+        }
+
+        if (jobCount > 0)
+        {
+            SubmitSubmissionBatch(pQueue, jobs, jobCount);
+            RetireCompletedSubmissionBatches(pQueue);
+        }
+        else if (pQueue->inFlightBatchCount > 0 && !stopping)
+        {
+            // The jobs pushed while the device runs the oldest batch make up the next batch
+            RetireOldestSubmissionBatch(pQueue);
+        }
+    }
+}
+
+// MARK: Queue
+
+VkResult CreateSubmissionQueue(VkDevice device, VkQueue queue, uint32_t maxBatchSize, struct SubmissionQueue** ppQueue)
+{
+    if (maxBatchSize == 0 || maxBatchSize > SUBMISSION_QUEUE_MAX_BATCH_SIZE) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    struct SubmissionQueue* pQueue = calloc(1, sizeof(*pQueue));
+    if (pQueue == NULL) {
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    pQueue->device = device;
+    pQueue->queue = queue;
+    pQueue->maxBatchSize = maxBatchSize;
+
+    VkResult result = VK_SUCCESS;
+    do
+    {
+        pQueue->pCompletionLock = HostLockCreate();
+        pQueue->pJobQueue = CreateJobQueue();
+        if (pQueue->pCompletionLock == NULL || pQueue->pJobQueue == NULL)
+        {
+            result = VK_ERROR_OUT_OF_HOST_MEMORY;
+            break;
+        }
+
+        pQueue->pFencePool = GetSharedFencePool();
+        if (pQueue->pFencePool == NULL || GetFencePoolDevice(pQueue->pFencePool) != device)
+        {
+            fprintf(stderr, "The shared fence pool does not belong to the device of the submission queue!\n");
+            result = VK_ERROR_INITIALIZATION_FAILED;
+            break;
+        }
+        for (uint32_t i = 0; i < SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT && result == VK_SUCCESS; i++)
+        {
+            result = AcquirePooledFence(pQueue->pFencePool, &pQueue->batches[i].fence);
+            if (result != VK_SUCCESS) {
+                fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
+            }
+        }
+        if (result != VK_SUCCESS) break;
+
+        pQueue->pThread = HostThreadCreate(SubmitterLoop, pQueue);
+        if (pQueue->pThread == NULL)
+        {
+            fprintf(stderr, "Failed to create the submitter thread!\n");
+            result = VK_ERROR_INITIALIZATION_FAILED;
+        }
+    } while (false);
+
+    if (result != VK_SUCCESS)
+    {
+        DestroySubmissionQueue(pQueue);
+        return result;
+    }
+
+    *ppQueue = pQueue;
+    return VK_SUCCESS;
+}
+
+void DestroySubmissionQueue(struct SubmissionQueue* pQueue)
+{
+    if (pQueue == NULL) {
+        return;
+    }
+
+    if (pQueue->pThread != NULL)
+    {
+        PushJobQueueNode(pQueue->pJobQueue, &pQueue->stopNode);
+        HostThreadJoin(pQueue->pThread);
+    }
+
+    // The submitter has retired every batch, so none of the fences is pending
+    for (uint32_t i = 0; i < SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT; i++) {
+        ReleasePooledFence(pQueue->pFencePool, pQueue->batches[i].fence);
+    }
+    DestroyJobQueue(pQueue->pJobQueue);
+    HostLockDestroy(pQueue->pCompletionLock);
+    free(pQueue);
+}
+
+void EnqueueSubmission(struct SubmissionQueue* pQueue, struct SubmissionJob* pJob, VkCommandBuffer commandBuffer)
+{
+    pJob->commandBuffer = commandBuffer;
+    pJob->submitTime = 0;
+    pJob->completeTime = 0;
+    pJob->result = VK_NOT_READY;
+    pJob->completed = 0;
+    pJob->enqueueTime = HostGetTimeNanoseconds();
+    PushJobQueueNode(pQueue->pJobQueue, &pJob->node);
+}
+
+VkResult WaitSubmission(struct SubmissionQueue* pQueue, struct SubmissionJob* pJob)
+{
+    if (HostAtomicLoadUInt32(&pJob->completed) == 0)
+    {
+        HostLockAcquire(pQueue->pCompletionLock);
+        while (HostAtomicLoadUInt32(&pJob->completed) == 0) {
+            HostLockWait(pQueue->pCompletionLock, UINT64_MAX);
+        }
+        HostLockRelease(pQueue->pCompletionLock);
+    }
+    return pJob->result;
+}
+
+bool IsSubmissionCompleted(const struct SubmissionJob* pJob)
+{
+    return HostAtomicLoadUInt32((volatile uint32_t*)&pJob->completed) != 0;
+}
+
+void GetSubmissionQueueStats(const struct SubmissionQueue* pQueue, struct SubmissionQueueStats* pStats)
+{
+    *pStats = pQueue->stats;
+}
+
+// MARK: Test
+
+enum SubmissionTestMode
+{
+    // Every thread calls vkQueueSubmit itself, under a lock of the queue
+    SUBMISSION_TEST_MODE_LOCKED,
+    // The submitter thread with a batch size of 1
+    SUBMISSION_TEST_MODE_SUBMITTER,
+    // The submitter thread with SUBMISSION_QUEUE_MAX_BATCH_SIZE
+    SUBMISSION_TEST_MODE_COALESCED,
+    SUBMISSION_TEST_MODE_COUNT
+};
+
+static const char* const s_modeNames[SUBMISSION_TEST_MODE_COUNT] = {
+    "Locked vkQueueSubmit",
+    "Submitter, batch size 1",
+    "Submitter, coalesced"
+};
+
+struct SubmissionTestProducer
+{
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffers[SUBMISSION_TEST_SLOT_COUNT];
+    VkBuffer srcBuffer;
+    VkDeviceMemory srcMemory;
+    VkBuffer dstBuffers[SUBMISSION_TEST_SLOT_COUNT];
+    VkDeviceMemory dstMemories[SUBMISSION_TEST_SLOT_COUNT];
+    struct ElementwiseChainPlan* pPlans[SUBMISSION_TEST_SLOT_COUNT];
+    // Used by SUBMISSION_TEST_MODE_LOCKED, from the shared fence pool
+    VkFence fences[SUBMISSION_TEST_SLOT_COUNT];
+    uint64_t issueTimes[SUBMISSION_TEST_SLOT_COUNT];
+    // Used by the submitter modes
+    struct SubmissionJob jobs[SUBMISSION_TEST_SLOT_COUNT];
+
+    // SUBMISSION_TEST_JOB_COUNT entries
+    uint64_t* latencies;
+    VkResult result;
+};
+
+struct SubmissionTestContext
+{
+    VkDevice device;
+    VkQueue queue;
+    enum SubmissionTestMode mode;
+    struct HostLock* pQueueLock;
+    struct SubmissionQueue* pSubmissionQueue;
+    struct SubmissionTestProducer* producers;
+};
+
+static int CompareLatency(const void* a, const void* b)
+{
+    const uint64_t lhs = *(const uint64_t*)a;
+    const uint64_t rhs = *(const uint64_t*)b;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+// Sorts `latencies` and prints the percentiles in microseconds.
+static void PrintLatencyPercentiles(const char* title, uint64_t latencies[], uint32_t count)
+{
+    if (count == 0) return;
+
+    qsort(latencies, count, sizeof(latencies[0]), CompareLatency);
+    const double p50 = (double)latencies[(count - 1) * 50 / 100] / 1000.0;
+    const double p90 = (double)latencies[(count - 1) * 90 / 100] / 1000.0;
+    const double p99 = (double)latencies[(count - 1) * 99 / 100] / 1000.0;
+    const double maximum = (double)latencies[count - 1] / 1000.0;
+    printf("%-24s p50: %9.2f us, p90: %9.2f us, p99: %9.2f us, max: %9.2f us\n", title, p50, p90, p99, maximum);
+}
+
+static VkResult IssueSubmissionTestJob(struct SubmissionTestContext* pContext, struct SubmissionTestProducer* pProducer, uint32_t slot)
+{
+    if (pContext->mode != SUBMISSION_TEST_MODE_LOCKED)
+    {
+        EnqueueSubmission(pContext->pSubmissionQueue, &pProducer->jobs[slot], pProducer->commandBuffers[slot]);
+        return VK_SUCCESS;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pProducer->commandBuffers[slot],
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    // The time waiting for the lock counts, as the time in the queue of the submitter does
+    pProducer->issueTimes[slot] = HostGetTimeNanoseconds();
+    HostLockAcquire(pContext->pQueueLock);
+    const VkResult result = vkQueueSubmit(pContext->queue, 1, &submitInfo, pProducer->fences[slot]);
+    HostLockRelease(pContext->pQueueLock);
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "vkQueueSubmit failed: %d\n", result);
+    }
+    return result;
+}
+
+// Returns the latency of the job of `slot`
+static uint64_t WaitSubmissionTestJob(struct SubmissionTestContext* pContext, struct SubmissionTestProducer* pProducer, uint32_t slot)
+{
+    if (pContext->mode != SUBMISSION_TEST_MODE_LOCKED)
+    {
+        const VkResult result = WaitSubmission(pContext->pSubmissionQueue, &pProducer->jobs[slot]);
+        if (result != VK_SUCCESS) {
+            pProducer->result = result;
+        }
+        return HostGetTimeNanoseconds() - pProducer->jobs[slot].enqueueTime;
+    }
+
+    const VkResult result = vkWaitForFences(pContext->device, 1, &pProducer->fences[slot], VK_TRUE, UINT64_MAX);
+    const uint64_t latency = HostGetTimeNanoseconds() - pProducer->issueTimes[slot];
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkWaitForFences failed: %d\n", result);
+        pProducer->result = result;
+        ReplacePooledFence(GetSharedFencePool(), &pProducer->fences[slot]);
+    }
+    else {
+        vkResetFences(pContext->device, 1, &pProducer->fences[slot]);
+    }
+    return latency;
+}
+
+// Keeps SUBMISSION_TEST_SLOT_COUNT jobs in flight, and waits for the oldest one before reusing its command buffer
+static void SubmissionTestProducerTask(void* context, size_t begin, size_t end)
+{
+    struct SubmissionTestContext* const pContext = context;
+    for (size_t p = begin; p < end; p++)
+    {
+        struct SubmissionTestProducer* const pProducer = &pContext->producers[p];
+        pProducer->result = VK_SUCCESS;
+
+        uint32_t issuedCount = 0;
+        for (uint32_t j = 0; j < SUBMISSION_TEST_JOB_COUNT + SUBMISSION_TEST_SLOT_COUNT; j++)
+        {
+            const uint32_t slot = j % SUBMISSION_TEST_SLOT_COUNT;
+            if (j >= SUBMISSION_TEST_SLOT_COUNT && j - SUBMISSION_TEST_SLOT_COUNT < issuedCount) {
+                pProducer->latencies[j - SUBMISSION_TEST_SLOT_COUNT] = WaitSubmissionTestJob(pContext, pProducer, slot);
+            }
+            if (j < SUBMISSION_TEST_JOB_COUNT && pProducer->result == VK_SUCCESS)
+            {
+                const VkResult result = IssueSubmissionTestJob(pContext, pProducer, slot);
+                if (result != VK_SUCCESS)
+                {
+                    pProducer->result = result;
+                    continue;
+                }
+                issuedCount++;
+            }
+        }
+    }
+}
+
+static void DestroySubmissionTestProducer(VkDevice device, struct SubmissionTestProducer* pProducer)
+{
+    for (uint32_t s = 0; s < SUBMISSION_TEST_SLOT_COUNT; s++)
+    {
+        ReleasePooledFence(GetSharedFencePool(), pProducer->fences[s]);
+        DestroyElementwiseChainPlan(pProducer->pPlans[s]);
+        DestroyBufferWithMemory(device, pProducer->dstBuffers[s], pProducer->dstMemories[s]);
+    }
+    DestroyBufferWithMemory(device, pProducer->srcBuffer, pProducer->srcMemory);
+    if (pProducer->commandPool != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(device, pProducer->commandPool, SUBMISSION_TEST_SLOT_COUNT, pProducer->commandBuffers);
+        vkDestroyCommandPool(device, pProducer->commandPool, GetHostAllocationCallbacks(VK_OBJECT_TYPE_COMMAND_POOL));
+    }
+}
+
+// Creates the buffers, the plans and the fences of the producer, and records its command buffers once for all the runs
+static VkResult CreateSubmissionTestProducer(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t queueFamilyIndex,
+    struct ElementwiseContext* pElementwiseContext, const struct ElementwiseChain* pChain, uint32_t producerIndex, struct SubmissionTestProducer* pProducer)
+{
+    const VkDeviceSize bufferSize = SUBMISSION_TEST_ELEM_COUNT * sizeof(uint32_t);
+    const VkMemoryPropertyFlags hostMemoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    VkResult result = InitializeCommandBuffer(queueFamilyIndex, device, &pProducer->commandPool, pProducer->commandBuffers, SUBMISSION_TEST_SLOT_COUNT);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemoryFlags, queueFamilyIndex,
+        &pProducer->srcBuffer, &pProducer->srcMemory);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+    uint32_t* srcPtr = NULL;
+    result = vkMapMemory(device, pProducer->srcMemory, 0, VK_WHOLE_SIZE, 0, (void**)&srcPtr);
+    if (result != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkMapMemory failed: %d\n", result);
+        return result;
+    }
+    HostParallelFillSequence((int*)srcPtr, SUBMISSION_TEST_ELEM_COUNT, (int)(producerIndex * SUBMISSION_TEST_ELEM_COUNT));
+    vkUnmapMemory(device, pProducer->srcMemory);
+
+    struct FencePool* const pFencePool = GetSharedFencePool();
+    if (pFencePool == NULL || GetFencePoolDevice(pFencePool) != device)
+    {
+        fprintf(stderr, "The shared fence pool does not belong to the device of the producer!\n");
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        // Submitted again and again, though never while it is pending
+        .flags = 0,
+        .pInheritanceInfo = NULL
+    };
+    for (uint32_t s = 0; s < SUBMISSION_TEST_SLOT_COUNT; s++)
+    {
+        result = CreateBufferWithMemory(device, pMemoryProperties, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemoryFlags, queueFamilyIndex,
+            &pProducer->dstBuffers[s], &pProducer->dstMemories[s]);
+        if (result != VK_SUCCESS) break;
+
+        result = CreateElementwiseChainPlan(pElementwiseContext, pChain, ELEMENTWISE_FUSION_AUTO, pProducer->srcBuffer, pProducer->dstBuffers[s],
+            &pProducer->pPlans[s]);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseChainPlan failed!\n");
+            break;
+        }
+
+        result = AcquirePooledFence(pFencePool, &pProducer->fences[s]);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "AcquirePooledFence failed: %d\n", result);
+            break;
+        }
+
+        const VkCommandBuffer commandBuffer = pProducer->commandBuffers[s];
+        result = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkBeginCommandBuffer failed: %d\n", result);
+            break;
+        }
+        RecordElementwiseChain(commandBuffer, pProducer->pPlans[s], SUBMISSION_TEST_ELEM_COUNT);
+        RecordComputeToHostBarrier(commandBuffer);
+        result = vkEndCommandBuffer(commandBuffer);
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "vkEndCommandBuffer failed: %d\n", result);
+            break;
+        }
+    }
+    return result;
+}
+
+static bool VerifySubmissionTestProducer(VkDevice device, const struct ElementwiseChain* pChain, uint32_t producerIndex,
+    const struct SubmissionTestProducer* pProducer)
+{
+    bool verified = true;
+    for (uint32_t s = 0; s < SUBMISSION_TEST_SLOT_COUNT && verified; s++)
+    {
+        const uint32_t* dstPtr = NULL;
+        if (vkMapMemory(device, pProducer->dstMemories[s], 0, VK_WHOLE_SIZE, 0, (void**)&dstPtr) != VK_SUCCESS) {
+            return false;
+        }
+        for (uint32_t i = 0; i < SUBMISSION_TEST_ELEM_COUNT; i++)
+        {
+            if (dstPtr[i] != ApplyElementwiseChainOnHost(pChain, producerIndex * SUBMISSION_TEST_ELEM_COUNT + i))
+            {
+                fprintf(stderr, "Producer %u, slot %u: result mismatch @%u\n", producerIndex, s, i);
+                verified = false;
+                break;
+            }
+        }
+        vkUnmapMemory(device, pProducer->dstMemories[s]);
+    }
+    return verified;
+}
+
+void SubmissionQueueComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits)
+{
+    puts("\n================ Begin submission queue test ================\n");
+
+    struct SubmissionTestProducer producers[SUBMISSION_TEST_MAX_THREAD_COUNT];
+    memset(producers, 0, sizeof(producers));
+    struct ElementwiseContext* pElementwiseContext = NULL;
+    struct HostLock* pQueueLock = NULL;
+    uint64_t* latencies = NULL;
+
+    const struct ElementwiseChain chain = {
+        3, { ELEMENTWISE_OP_MUL, ELEMENTWISE_OP_ADD, ELEMENTWISE_OP_XOR }, { 3, 7, 0x5a5aU }
+    };
+
+    do
+    {
+        VkQueue queue = VK_NULL_HANDLE;
+        vkGetDeviceQueue(specDevice, specQueueFamilyIndex, 0, &queue);
+
+        latencies = malloc(sizeof(*latencies) * SUBMISSION_TEST_MAX_THREAD_COUNT * SUBMISSION_TEST_JOB_COUNT);
+        pQueueLock = HostLockCreate();
+        if (latencies == NULL || pQueueLock == NULL) break;
+
+        if (CreateElementwiseContext(specDevice, pLimits, &pElementwiseContext) != VK_SUCCESS)
+        {
+            fprintf(stderr, "CreateElementwiseContext failed!\n");
+            break;
+        }
+
+        VkResult result = VK_SUCCESS;
+        for (uint32_t p = 0; p < SUBMISSION_TEST_MAX_THREAD_COUNT && result == VK_SUCCESS; p++)
+        {
+            producers[p].latencies = latencies + (size_t)p * SUBMISSION_TEST_JOB_COUNT;
+            result = CreateSubmissionTestProducer(specDevice, pMemoryProperties, specQueueFamilyIndex, pElementwiseContext, &chain, p, &producers[p]);
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "Failed to create the producers: %d\n", result);
+            break;
+        }
+
+        // Excludes the first submission of the pipeline from the measurement
+        if (SubmitCommandBufferAndWait(specDevice, queue, producers[0].commandBuffers[0]) != VK_SUCCESS) break;
+
+        printf("Each thread keeps %d jobs of %d elements in flight, %d jobs in all.\n", SUBMISSION_TEST_SLOT_COUNT, SUBMISSION_TEST_ELEM_COUNT,
+            SUBMISSION_TEST_JOB_COUNT);
+
+        const uint32_t maxThreadCount = HostParallelGetThreadCount();
+        uint32_t usedProducerCount = 0;
+        for (uint32_t threadCount = 1; threadCount <= SUBMISSION_TEST_MAX_THREAD_COUNT && result == VK_SUCCESS; threadCount *= 2)
+        {
+            if (threadCount > maxThreadCount)
+            {
+                printf("%u threads exceed the %u threads of the host thread pool.\n", threadCount, maxThreadCount);
+                break;
+            }
+
+            for (int mode = 0; mode < SUBMISSION_TEST_MODE_COUNT && result == VK_SUCCESS; mode++)
+            {
+                struct SubmissionTestContext context = {
+                    .device = specDevice,
+                    .queue = queue,
+                    .mode = (enum SubmissionTestMode)mode,
+                    .pQueueLock = pQueueLock,
+                    .pSubmissionQueue = NULL,
+                    .producers = producers
+                };
+                if (mode != SUBMISSION_TEST_MODE_LOCKED)
+                {
+                    result = CreateSubmissionQueue(specDevice, queue, mode == SUBMISSION_TEST_MODE_COALESCED ? SUBMISSION_QUEUE_MAX_BATCH_SIZE : 1,
+                        &context.pSubmissionQueue);
+                    if (result != VK_SUCCESS)
+                    {
+                        fprintf(stderr, "CreateSubmissionQueue failed: %d\n", result);
+                        break;
+                    }
+                }
+
+                usedProducerCount = threadCount;
+                const uint64_t beginTime = HostGetTimeNanoseconds();
+                HostParallelForEach(threadCount, threadCount, SubmissionTestProducerTask, &context);
+                const double seconds = (double)(HostGetTimeNanoseconds() - beginTime) / 1000000000.0;
+
+                const uint32_t jobCount = threadCount * SUBMISSION_TEST_JOB_COUNT;
+                struct SubmissionQueueStats stats = { .jobCount = jobCount, .submitCount = jobCount, .maxBatchJobCount = 1 };
+                if (context.pSubmissionQueue != NULL)
+                {
+                    // The queue is idle, since every job has been waited for
+                    GetSubmissionQueueStats(context.pSubmissionQueue, &stats);
+                    DestroySubmissionQueue(context.pSubmissionQueue);
+                }
+                for (uint32_t p = 0; p < threadCount; p++)
+                {
+                    if (producers[p].result != VK_SUCCESS) {
+                        result = producers[p].result;
+                    }
+                }
+
+                printf("%u thread(s), %-24s %9.0f jobs/s, %9.0f vkQueueSubmit/s, %5.2f jobs per submit (max %u), %llu full ring waits\n",
+                    threadCount, s_modeNames[mode], (double)jobCount / seconds, (double)stats.submitCount / seconds,
+                    stats.submitCount > 0 ? (double)stats.jobCount / (double)stats.submitCount : 0.0, stats.maxBatchJobCount,
+                    (unsigned long long)stats.fullRingWaitCount);
+                PrintLatencyPercentiles("    Job latency", latencies, jobCount);
+            }
+        }
+        if (result != VK_SUCCESS)
+        {
+            fprintf(stderr, "The submission queue test failed: %d\n", result);
+            break;
+        }
+
+        bool verified = true;
+        for (uint32_t p = 0; p < usedProducerCount; p++) {
+            verified = verified && VerifySubmissionTestProducer(specDevice, &chain, p, &producers[p]);
+        }
+        printf("Submission queue results: %s\n", verified ? "verify OK" : "verify FAILED");
+    } while (false);
+
+    for (uint32_t p = 0; p < SUBMISSION_TEST_MAX_THREAD_COUNT; p++) {
+        DestroySubmissionTestProducer(specDevice, &producers[p]);
+    }
+    DestroyElementwiseContext(pElementwiseContext);
+    HostLockDestroy(pQueueLock);
+    free(latencies);
+
+    puts("\n================ Complete submission queue test ================\n");
+}
@@ -0,0 +1,76 @@
+#ifndef SUBMISSION_QUEUE_H
+#define SUBMISSION_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+#include "job_queue.h"
+
+// A thread-safe submission layer of a VkQueue, which any number of application threads enqueue their recorded command buffers into.
+// The jobs go through the lock-free MPSC queue of job_queue.h to a single submitter thread, which is the only thread that calls
+// vkQueueSubmit on the queue, so the external synchronization the queue requires holds without a lock around it.
+// The submitter drains whatever has been pushed, up to `maxBatchSize` jobs, into a single VkSubmitInfo, and submits it with one vkQueueSubmit
+// and a fence from a small ring of batches in flight. While the device runs a batch, the jobs pushed meanwhile accumulate into the next one,
+// so the number of submits falls as the contention rises. The jobs of a retired batch are marked completed together.
+//
+// The command buffers of a batch run in the order of their jobs. The jobs of one thread keep their order, and the jobs of different threads
+// are in the order they were pushed.
+
+enum
+{
+    SUBMISSION_QUEUE_MAX_BATCH_SIZE = 64,
+    // The batches whose fence has not been seen signaled yet
+    SUBMISSION_QUEUE_MAX_IN_FLIGHT_BATCH_COUNT = 4
+};
+
+// A job is owned by the thread that enqueues it, which must not modify nor free it until WaitSubmission returns.
+struct SubmissionJob
+{
+    struct JobQueueNode node;
+    VkCommandBuffer commandBuffer;
+
+    // Set by EnqueueSubmission
+    uint64_t enqueueTime;
+    // Set by the submitter thread
+    uint64_t submitTime;
+    uint64_t completeTime;
+    VkResult result;
+    volatile uint32_t completed;
+};
+
+struct SubmissionQueueStats
+{
+    uint64_t jobCount;
+    uint64_t submitCount;
+    uint32_t maxBatchJobCount;
+    // The times the submitter had to wait for the oldest batch because the ring of batches in flight was full
+    uint64_t fullRingWaitCount;
+};
+
+struct SubmissionQueue;
+
+// Starts the submitter thread, which owns `queue` until the submission queue is destroyed. No other thread may use `queue` meanwhile.
+// @param maxBatchSize: the most command buffers of one vkQueueSubmit, 1 ~ SUBMISSION_QUEUE_MAX_BATCH_SIZE. 1 submits every job on its own.
+extern VkResult CreateSubmissionQueue(VkDevice device, VkQueue queue, uint32_t maxBatchSize, struct SubmissionQueue** ppQueue);
+// Completes the jobs that have been enqueued and stops the submitter thread. No job may be enqueued concurrently.
+extern void DestroySubmissionQueue(struct SubmissionQueue* pQueue);
+
+// Any thread. The command buffer must have been recorded, and must not be pending in another job unless it allows simultaneous use.
+extern void EnqueueSubmission(struct SubmissionQueue* pQueue, struct SubmissionJob* pJob, VkCommandBuffer commandBuffer);
+// Blocks until the command buffer of the job has completed on the device, and returns the result of its submission.
+extern VkResult WaitSubmission(struct SubmissionQueue* pQueue, struct SubmissionJob* pJob);
+// Whether the command buffer of the job has completed on the device
+extern bool IsSubmissionCompleted(const struct SubmissionJob* pJob);
+
+// A consistent snapshot is only guaranteed when no job is in progress.
+extern void GetSubmissionQueueStats(const struct SubmissionQueue* pQueue, struct SubmissionQueueStats* pStats);
+
+// Compares the submitter thread with and without coalescing against the threads submitting on their own under a lock,
+// with 1 ~ 8 threads, and reports the vkQueueSubmit calls per second and the tail latency of the jobs.
+extern void SubmissionQueueComputeTest(VkDevice specDevice, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t specQueueFamilyIndex,
+    const VkPhysicalDeviceLimits* pLimits);
+
+#endif // !SUBMISSION_QUEUE_H
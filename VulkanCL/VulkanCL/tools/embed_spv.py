@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+# Embeds the SPIR-V modules under shaders/ into embedded_spv.c and embedded_spv.h,
+# so that CreateShaderModule creates the shader modules straight from read-only memory without any file I/O.
+#
+# The clspv command lines are taken from shaders/<name>/build-spv.sh. When clspv is available
+# (the CLSPV environment variable, clspv in CLSPV_BIN_DIR, or clspv on PATH), the .cl sources are compiled first;
+# otherwise the checked-in .spv files are embedded as they are. Modules without a .spv file are skipped,
+# and CreateShaderModule still loads them from the file system.
+# Every skipped module is reported as a warning in the "origin : warning CODE : text" format, which MSBuild shows in the error list,
+# and with --strict as an error that fails the build.
+#
+# Usage: python3 tools/embed_spv.py [--no-clspv] [--strict] [--project-dir DIR]
+
+import argparse
+import os
+import shlex
+import shutil
+import subprocess
+import sys
+
+SPIRV_MAGIC = 0x07230203
+OP_ENTRY_POINT = 15
+OP_EXECUTION_MODE = 16
+EXECUTION_MODE_LOCAL_SIZE = 17
+WORDS_PER_LINE = 8
+
+
+def parse_clspv_commands(script_path):
+    """Returns the argument lists of the clspv command lines in a build-spv.sh script."""
+    commands = []
+    with open(script_path, encoding="utf-8") as script:
+        for line in script:
+            tokens = shlex.split(line, comments=True)
+            if len(tokens) > 0 and tokens[0] == "clspv":
+                commands.append(tokens[1:])
+    return commands
+
+
+def get_output_name(arguments):
+    for index, argument in enumerate(arguments[:-1]):
+        if argument == "-o":
+            return arguments[index + 1]
+    return None
+
+
+def find_clspv(no_clspv):
+    if no_clspv:
+        return None
+    clspv = os.environ.get("CLSPV")
+    if clspv:
+        return clspv if os.path.isfile(clspv) else shutil.which(clspv)
+    # The same variable as the build-spv scripts
+    bin_dir = os.environ.get("CLSPV_BIN_DIR")
+    return shutil.which("clspv", path=bin_dir + os.pathsep + os.environ.get("PATH", "") if bin_dir else None)
+
+
+def decode_string(words):
+    data = b"".join(word.to_bytes(4, "little") for word in words)
+    return data[:data.index(b"\0")].decode("utf-8")
+
+
+def parse_spirv(path):
+    """Returns the code words and the entry points [(name, localSize or None)] of a SPIR-V module."""
+    with open(path, "rb") as spv:
+        data = spv.read()
+    if len(data) < 20 or len(data) % 4 != 0:
+        raise ValueError(f"{path} is not a SPIR-V module")
+    words = [int.from_bytes(data[i:i + 4], "little") for i in range(0, len(data), 4)]
+    if words[0] != SPIRV_MAGIC:
+        raise ValueError(f"{path} has a wrong magic number 0x{words[0]:08x}")
+
+    entry_points = {}
+    local_sizes = {}
+    index = 5
+    while index < len(words):
+        word_count = words[index] >> 16
+        opcode = words[index] & 0xffff
+        if word_count == 0:
+            raise ValueError(f"{path} has a zero-length instruction at word {index}")
+        operands = words[index + 1:index + word_count]
+        if opcode == OP_ENTRY_POINT:
+            entry_points[operands[1]] = decode_string(operands[2:])
+        elif opcode == OP_EXECUTION_MODE and operands[1] == EXECUTION_MODE_LOCAL_SIZE:
+            local_sizes[operands[0]] = tuple(operands[2:5])
+        index += word_count
+
+    return words, [(name, local_sizes.get(function_id)) for function_id, name in entry_points.items()]
+
+
+def report(origin, code, message, is_error=False):
+    """Prints a diagnostic in the canonical format of MSBuild, so that the pre-build event does not hide it in the build output."""
+    print(f"{origin} : {'error' if is_error else 'warning'} {code} : {message}", file=sys.stderr)
+
+
+def collect_modules(project_dir, clspv, strict):
+    """Returns [(relative path, words, entry points)] sorted by path, and the relative paths of the modules that are not embedded."""
+    shaders_dir = os.path.join(project_dir, "shaders")
+    modules = []
+    missing_paths = []
+    for shader_name in sorted(os.listdir(shaders_dir)):
+        shader_dir = os.path.join(shaders_dir, shader_name)
+        script_path = os.path.join(shader_dir, "build-spv.sh")
+        if not os.path.isfile(script_path):
+            continue
+
+        for arguments in parse_clspv_commands(script_path):
+            output_name = get_output_name(arguments)
+            if output_name is None:
+                continue
+            output_path = os.path.join(shader_dir, output_name)
+
+            if clspv is not None:
+                completed = subprocess.run([clspv] + arguments, cwd=shader_dir)
+                if completed.returncode != 0:
+                    report(script_path, "EMBEDSPV002", f"clspv failed for shaders/{shader_name}/{output_name}, using the checked-in module",
+                           strict)
+
+            if not os.path.isfile(output_path):
+                report(script_path, "EMBEDSPV001", f"shaders/{shader_name}/{output_name} has not been generated, so it is not embedded "
+                       "and has to be present at runtime", strict)
+                missing_paths.append(f"shaders/{shader_name}/{output_name}")
+                continue
+
+            words, entry_points = parse_spirv(output_path)
+            modules.append((f"shaders/{shader_name}/{output_name}", words, entry_points))
+    return modules, missing_paths
+
+
+def generate_missing_comment(missing_paths):
+    """Lists the modules of the build-spv.sh scripts that had no .spv file, which CreateShaderModule loads from the file system."""
+    if len(missing_paths) == 0:
+        return []
+    return ["// Not embedded since they had not been generated, and loaded from the file system at runtime:"] + \
+        [f"//   {path}" for path in missing_paths] + [""]
+
+
+def get_identifier(relative_path):
+    name = os.path.splitext(relative_path[len("shaders/"):])[0]
+    return "".join(c if c.isalnum() else "_" for c in name).upper()
+
+
+def generate_header(modules, missing_paths):
+    lines = [
+        "// Generated by tools/embed_spv.py. Do not edit.",
+        "",
+    ]
+    lines += generate_missing_comment(missing_paths)
+    lines += [
+        "#ifndef EMBEDDED_SPV_H",
+        "#define EMBEDDED_SPV_H",
+        "",
+        "#include <stdint.h>",
+        "#include <stddef.h>",
+        "",
+        "struct EmbeddedSpirvEntryPoint",
+        "{",
+        "    const char* name;",
+        "    // The LocalSize execution mode, or all 0s if the workgroup size is only given by the specialization constants",
+        "    uint32_t localSize[3];",
+        "};",
+        "",
+        "struct EmbeddedSpirvModule",
+        "{",
+        "    // The path relative to the project directory, as passed to CreateShaderModule",
+        "    const char* fileName;",
+        "    const uint32_t* code;",
+        "    size_t codeSize;",
+        "    const struct EmbeddedSpirvEntryPoint* entryPoints;",
+        "    uint32_t entryPointCount;",
+        "};",
+        "",
+        "enum EmbeddedSpirvModuleIndex",
+        "{",
+    ]
+    lines += [f"    EMBEDDED_SPIRV_{get_identifier(path)}," for path, _, _ in modules]
+    lines += [
+        "    EMBEDDED_SPIRV_MODULE_COUNT",
+        "};",
+        "",
+    ]
+    for path, _, entry_points in modules:
+        identifier = get_identifier(path)
+        lines.append(f"// {path}")
+        lines.append(f"#define EMBEDDED_SPIRV_{identifier}_ENTRY_POINT_COUNT    {len(entry_points)}")
+        for name, _ in entry_points:
+            lines.append(f"#define EMBEDDED_SPIRV_{identifier}_HAS_{name.upper()}    1")
+        lines.append("")
+    lines += [
+        "// Indexed by `enum EmbeddedSpirvModuleIndex`. The code of every module is 16-byte aligned.",
+        "extern const struct EmbeddedSpirvModule g_embeddedSpirvModules[EMBEDDED_SPIRV_MODULE_COUNT > 0 ? EMBEDDED_SPIRV_MODULE_COUNT : 1];",
+        "",
+        "#endif // !EMBEDDED_SPV_H",
+        "",
+    ]
+    return "\n".join(lines) + "\n"
+
+
+def generate_source(modules):
+    lines = [
+        "// Generated by tools/embed_spv.py. Do not edit.",
+        "",
+        "#include \"embedded_spv.h\"",
+        "",
+        "#ifdef _MSC_VER",
+        "#define EMBEDDED_SPIRV_ALIGN   __declspec(align(16))",
+        "#else",
+        "#define EMBEDDED_SPIRV_ALIGN   __attribute__((aligned(16)))",
+        "#endif // _MSC_VER",
+        "",
+    ]
+    for path, words, entry_points in modules:
+        identifier = get_identifier(path).lower()
+        lines.append(f"// {path}: {len(words)} words")
+        lines.append(f"EMBEDDED_SPIRV_ALIGN static const uint32_t s_{identifier}_code[{len(words)}] = {{")
+        for i in range(0, len(words), WORDS_PER_LINE):
+            lines.append("    " + ", ".join(f"0x{word:08x}U" for word in words[i:i + WORDS_PER_LINE]) + ",")
+        lines.append("};")
+        lines.append("")
+        lines.append(f"static const struct EmbeddedSpirvEntryPoint s_{identifier}_entryPoints[{max(len(entry_points), 1)}] = {{")
+        for name, local_size in entry_points:
+            x, y, z = local_size if local_size is not None else (0, 0, 0)
+            lines.append(f"    {{ \"{name}\", {{ {x}U, {y}U, {z}U }} }},")
+        if len(entry_points) == 0:
+            lines.append("    { NULL, { 0U, 0U, 0U } }")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("const struct EmbeddedSpirvModule g_embeddedSpirvModules[EMBEDDED_SPIRV_MODULE_COUNT > 0 ? EMBEDDED_SPIRV_MODULE_COUNT : 1] = {")
+    for path, _, entry_points in modules:
+        identifier = get_identifier(path).lower()
+        lines.append(f"    {{ \"{path}\", s_{identifier}_code, sizeof(s_{identifier}_code), s_{identifier}_entryPoints, {len(entry_points)}U }},")
+    if len(modules) == 0:
+        lines.append("    { NULL, NULL, 0, NULL, 0U }")
+    lines.append("};")
+    lines.append("")
+    return "\n".join(lines) + "\n"
+
+
+def write_if_changed(path, content):
+    """Leaves the file untouched if its content is the same, so that the build does not recompile it."""
+    if os.path.isfile(path):
+        with open(path, encoding="utf-8", newline="") as existing:
+            if existing.read() == content:
+                return False
+    with open(path, "w", encoding="utf-8", newline="\n") as output:
+        output.write(content)
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Embed the SPIR-V modules under shaders/ into C sources.")
+    parser.add_argument("--no-clspv", action="store_true", help="embed the checked-in .spv files without compiling the .cl sources")
+    parser.add_argument("--strict", action="store_true", help="fail if a module cannot be compiled or has no .spv file")
+    parser.add_argument("--project-dir", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir),
+                        help="the directory that contains shaders/ (default: the parent directory of this script)")
+    args = parser.parse_args()
+
+    project_dir = os.path.normpath(args.project_dir)
+    clspv = find_clspv(args.no_clspv)
+    print(f"clspv: {clspv if clspv is not None else 'not found, using the checked-in SPIR-V modules'}")
+
+    modules, missing_paths = collect_modules(project_dir, clspv, args.strict)
+    for path, words, entry_points in modules:
+        print(f"{path}: {len(words) * 4} bytes, entry points: {', '.join(name for name, _ in entry_points)}")
+    if len(missing_paths) > 0:
+        report(os.path.abspath(__file__), "EMBEDSPV001", f"{len(missing_paths)} of {len(modules) + len(missing_paths)} modules are not embedded",
+               args.strict)
+        if args.strict:
+            return 1
+
+    write_if_changed(os.path.join(project_dir, "embedded_spv.h"), generate_header(modules, missing_paths))
+    write_if_changed(os.path.join(project_dir, "embedded_spv.c"), generate_source(modules))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,97 @@
+#ifndef VK_COMMON_H
+#define VK_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Vulkan helper routines shared by all the compute tests. They are implemented in main.c.
+
+// The pipeline cache of the device, shared by all the compute pipelines. vkCreateComputePipelines may use it from several threads.
+extern VkPipelineCache GetSharedPipelineCache(void);
+// The pipeline variant cache of the device (pipeline_variants.h)
+extern struct PipelineVariantCache* GetSharedPipelineVariantCache(void);
+// The fence pool of the device (object_pool.h), from which SubmitCommandBufferAndWait takes its fences
+extern struct FencePool* GetSharedFencePool(void);
+
+// The command pool is owned by the caller for the whole test and is reset by BeginOneTimeCommandBuffer between recordings;
+// the pools of object_pool.h are for the per-job fences and command buffers of the long-lived workers, not for these pools.
+extern VkResult InitializeCommandBuffer(uint32_t queueFamilyIndex, VkDevice device, VkCommandPool* pCommandPool,
+    VkCommandBuffer commandBuffers[], uint32_t commandBufferCount);
+// InitializeCommandBuffer with the flags of the pool, such as VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT that lets a command buffer
+// be begun again on its own, or VK_COMMAND_POOL_CREATE_TRANSIENT_BIT for a pool reset every frame, and the level of the command buffers.
+extern VkResult InitializeCommandBufferWithFlags(uint32_t queueFamilyIndex, VkDevice device, VkCommandPoolCreateFlags poolFlags,
+    VkCommandBufferLevel level, VkCommandPool* pCommandPool, VkCommandBuffer commandBuffers[], uint32_t commandBufferCount);
+
+extern void SyncAndReadBuffer(VkCommandBuffer commandBuffer, uint32_t queueFamilyIndex, VkBuffer dstHostBuffer, VkBuffer srcDeviceBuffer, size_t size);
+
+// `fileName` is the path relative to the project directory, such as "shaders/simple/simple.spv".
+// The modules embedded by tools/embed_spv.py (embedded_spv.c) are created from memory; the others are loaded from the file.
+extern VkResult CreateShaderModule(VkDevice device, const char* fileName, VkShaderModule* pShaderModule);
+// Returns a copy of the SPIR-V words of `fileName`, which the caller frees with free(), or NULL if the module is not available.
+extern uint32_t* LoadSpirvCode(const char* fileName, size_t* pCodeSize);
+// Whether `fileName` is embedded or has been built, so that a test whose module has not been generated by clspv is skipped rather than failed.
+extern bool IsShaderModuleAvailable(const char* fileName);
+
+// Returns the index of the first memory type that is allowed by `memoryTypeBits` and has all the `requiredFlags`,
+// or UINT32_MAX if there's no such memory type.
+extern uint32_t FindMemoryTypeIndex(const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t memoryTypeBits,
+    VkMemoryPropertyFlags requiredFlags);
+
+// Creates a buffer together with its own dedicated device memory.
+// The memory is allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT if `usage` contains VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+extern VkResult CreateBufferWithMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags memoryFlags, uint32_t queueFamilyIndex, VkBuffer* pBuffer, VkDeviceMemory* pMemory);
+extern void DestroyBufferWithMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory);
+// `buffer` must be created with VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT.
+extern VkDeviceAddress GetBufferDeviceAddress(VkDevice device, VkBuffer buffer);
+
+// Creates a single mip level, single layer 2D image with optimal tiling in device local memory, and a color view of it.
+// The image is in VK_IMAGE_LAYOUT_UNDEFINED.
+extern VkResult CreateImage2DWithMemory(VkDevice device, const VkPhysicalDeviceMemoryProperties* pMemoryProperties, uint32_t width, uint32_t height,
+    VkFormat format, VkImageUsageFlags usage, uint32_t queueFamilyIndex, VkImage* pImage, VkDeviceMemory* pMemory, VkImageView* pImageView);
+extern void DestroyImage2DWithMemory(VkDevice device, VkImage image, VkDeviceMemory memory, VkImageView imageView);
+
+// Storage buffer bindings 0 ~ (bindingCount - 1), as clspv assigns them to the global pointer kernel arguments in order.
+extern VkResult CreateStorageBufferDescriptorSetLayout(VkDevice device, uint32_t bindingCount, VkDescriptorSetLayout* pDescLayout);
+extern VkResult AllocateStorageBufferDescriptorSet(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSetLayout descLayout,
+    const VkBuffer buffers[], uint32_t bufferCount, VkDescriptorSet* pDescSet);
+// Creates a descriptor pool just for this descriptor set.
+extern VkResult CreateStorageBufferDescriptorSet(VkDevice device, VkDescriptorSetLayout descLayout, const VkBuffer buffers[], uint32_t bufferCount,
+    VkDescriptorPool* pDescriptorPool, VkDescriptorSet* pDescSet);
+
+// `descLayout` may be VK_NULL_HANDLE and `pushConstantSize` may be 0.
+extern VkResult CreateComputePipelineLayout(VkDevice device, VkDescriptorSetLayout descLayout, uint32_t pushConstantSize, VkPipelineLayout* pPipelineLayout);
+
+// specConstants[i] is assigned to the 32-bit specialization constant whose constantID is i.
+// For clspv generated modules, IDs 0 ~ 2 are the workgroup size and IDs from 3 are the element counts of the local pointer arguments.
+extern VkResult CreateComputePipelineWithSpecConstants(VkDevice device, VkShaderModule computeShaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipeline* pComputePipeline);
+// CreateComputePipelineWithSpecConstants with the flags of the shader stage, such as VK_PIPELINE_SHADER_STAGE_CREATE_REQUIRE_FULL_SUBGROUPS_BIT_EXT,
+// and the subgroup size the stage requires through VK_EXT_subgroup_size_control, or 0 to leave the subgroup size to the implementation.
+extern VkResult CreateComputePipelineWithStageFlags(VkDevice device, VkShaderModule computeShaderModule, const char* entryName,
+    VkPipelineLayout pipelineLayout, const uint32_t specConstants[], uint32_t specConstantCount, VkPipelineShaderStageCreateFlags stageFlags,
+    uint32_t requiredSubgroupSize, VkPipeline* pComputePipeline);
+
+extern void RecordComputeToComputeBarrier(VkCommandBuffer commandBuffer);
+extern void RecordComputeToTransferBarrier(VkCommandBuffer commandBuffer);
+extern void RecordTransferToComputeBarrier(VkCommandBuffer commandBuffer);
+// Makes the shader writes visible to the host reads of mapped memory after the fence wait
+extern void RecordComputeToHostBarrier(VkCommandBuffer commandBuffer);
+// Transitions the whole color subresource of an image created by CreateImage2DWithMemory.
+extern void RecordImageLayoutTransition(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+
+// Submits the command buffer and blocks until its execution has been completed.
+extern VkResult SubmitCommandBufferAndWait(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer);
+
+// Resets `commandPool`, which must not be created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+// and begins recording `commandBuffer` allocated from it for one time submit.
+extern VkResult BeginOneTimeCommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBuffer commandBuffer);
+// Ends `commandBuffer`, submits it and waits for its completion.
+extern VkResult EndAndSubmitCommandBuffer(VkDevice device, VkQueue queue, VkCommandBuffer commandBuffer);
+
+#endif // !VK_COMMON_H
+